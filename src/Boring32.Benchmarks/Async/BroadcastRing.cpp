@@ -0,0 +1,168 @@
+#include <Windows.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/BroadcastRingPublisher.hpp"
+#include "../../Boring32/include/Async/BroadcastRingSubscriber.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr int MessageCount = 5000;
+		constexpr size_t MessageSize = 64;
+
+		LONGLONG Now()
+		{
+			LARGE_INTEGER now{ 0 };
+			QueryPerformanceCounter(&now);
+			return now.QuadPart;
+		}
+
+		// A blocking message-mode pipe to one subscriber, as the baseline
+		struct PipeSubscriber
+		{
+			PipeSubscriber(const std::wstring& name)
+			{
+				Server = CreateNamedPipeW(
+					name.c_str(),
+					PIPE_ACCESS_OUTBOUND,
+					PIPE_TYPE_MESSAGE | PIPE_WAIT,
+					PIPE_UNLIMITED_INSTANCES,
+					64 * 1024,
+					64 * 1024,
+					0,
+					nullptr
+				);
+				Client = CreateFileW(name.c_str(), GENERIC_READ | FILE_WRITE_ATTRIBUTES, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+				DWORD mode = PIPE_READMODE_MESSAGE;
+				SetNamedPipeHandleState(Client, &mode, nullptr, nullptr);
+			}
+
+			~PipeSubscriber()
+			{
+				CloseHandle(Client);
+				CloseHandle(Server);
+			}
+
+			HANDLE Server;
+			HANDLE Client;
+		};
+
+		// Publishes timestamped messages one at a time, waiting for every
+		// subscriber to receive each before the next, and reports how
+		// long delivery took across all subscribers.
+		template<typename TPublish, typename TReceive>
+		void Measure(
+			const std::wstring& name,
+			const int subscriberCount,
+			const TPublish& publish,
+			const TReceive& receive
+		)
+		{
+			LARGE_INTEGER frequency{ 0 };
+			QueryPerformanceFrequency(&frequency);
+			std::atomic<int> received = 0;
+			std::vector<std::vector<double>> latencies(subscriberCount);
+			std::vector<std::thread> subscribers;
+			for (int i = 0; i < subscriberCount; i++)
+			{
+				subscribers.emplace_back(
+					[&, i]()
+					{
+						std::vector<std::byte> message(MessageSize);
+						latencies[i].reserve(MessageCount);
+						for (int j = 0; j < MessageCount; j++)
+						{
+							receive(i, message);
+							const LONGLONG end = Now();
+							LONGLONG start = 0;
+							std::memcpy(&start, message.data(), sizeof(start));
+							latencies[i].push_back(static_cast<double>(end - start) * 1e6 / frequency.QuadPart);
+							received.fetch_add(1, std::memory_order_release);
+						}
+					});
+			}
+
+			std::vector<std::byte> message(MessageSize);
+			for (int j = 0; j < MessageCount; j++)
+			{
+				const LONGLONG start = Now();
+				std::memcpy(message.data(), &start, sizeof(start));
+				publish(message);
+				while (received.load(std::memory_order_acquire) < (j + 1) * subscriberCount)
+					YieldProcessor();
+			}
+			for (std::thread& subscriber : subscribers)
+				subscriber.join();
+
+			std::vector<double> all;
+			for (const std::vector<double>& subscriberLatencies : latencies)
+				all.insert(all.end(), subscriberLatencies.begin(), subscriberLatencies.end());
+			std::sort(all.begin(), all.end());
+			Report(name, L"delivery p50", all[all.size() / 2], L"us");
+			Report(name, L"delivery p99", all[all.size() * 99 / 100], L"us");
+		}
+
+		void MeasureRing(const int subscriberCount)
+		{
+			const std::wstring ringName =
+				L"Boring32.Benchmarks.BroadcastRing." + std::to_wstring(GetCurrentProcessId());
+			Boring32::Async::BroadcastRingPublisher publisher(ringName, { .MaxSubscribers = 64 });
+			std::vector<std::unique_ptr<Boring32::Async::BroadcastRingSubscriber>> subscribers;
+			for (int i = 0; i < subscriberCount; i++)
+				subscribers.push_back(std::make_unique<Boring32::Async::BroadcastRingSubscriber>(ringName));
+
+			Measure(
+				L"BroadcastRing x" + std::to_wstring(subscriberCount),
+				subscriberCount,
+				[&publisher](const std::vector<std::byte>& message)
+				{
+					publisher.Publish(message);
+				},
+				[&subscribers](const int subscriber, std::vector<std::byte>& message)
+				{
+					subscribers[subscriber]->Receive(message, INFINITE);
+				});
+		}
+
+		void MeasurePipes(const int subscriberCount)
+		{
+			const std::wstring pipeName =
+				L"\\\\.\\pipe\\Boring32.Benchmarks.BroadcastRing." + std::to_wstring(GetCurrentProcessId());
+			std::vector<std::unique_ptr<PipeSubscriber>> pipes;
+			for (int i = 0; i < subscriberCount; i++)
+				pipes.push_back(std::make_unique<PipeSubscriber>(pipeName));
+
+			Measure(
+				L"Pipe per subscriber x" + std::to_wstring(subscriberCount),
+				subscriberCount,
+				[&pipes](const std::vector<std::byte>& message)
+				{
+					for (const std::unique_ptr<PipeSubscriber>& pipe : pipes)
+					{
+						DWORD bytesWritten = 0;
+						WriteFile(pipe->Server, message.data(), (DWORD)message.size(), &bytesWritten, nullptr);
+					}
+				},
+				[&pipes](const int subscriber, std::vector<std::byte>& message)
+				{
+					DWORD bytesRead = 0;
+					ReadFile(pipes[subscriber]->Client, message.data(), (DWORD)message.size(), &bytesRead, nullptr);
+				});
+		}
+	}
+
+	void BroadcastRingLatency()
+	{
+		for (const int subscriberCount : { 1, 16, 64 })
+		{
+			MeasureRing(subscriberCount);
+			MeasurePipes(subscriberCount);
+		}
+	}
+}
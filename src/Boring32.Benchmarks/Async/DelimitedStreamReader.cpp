@@ -0,0 +1,98 @@
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <span>
+#include <thread>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/Pipes/AnonymousPipe.hpp"
+#include "../../Boring32/include/Async/Pipes/DelimitedStreamReader.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr size_t StreamSize = 256 * 1024 * 1024;
+
+		// Writes StreamSize bytes of newline-terminated messages of the
+		// given size to the pipe from another thread, then closes it.
+		std::thread StartWriter(Boring32::Async::AnonymousPipe& pipe, const size_t messageSize)
+		{
+			return std::thread(
+				[&pipe, messageSize]()
+				{
+					// Fill a block with whole messages and write it repeatedly
+					std::string message(messageSize - 1, 'x');
+					message.push_back('\n');
+					std::string block;
+					while (block.size() + message.size() <= 1024 * 1024)
+						block += message;
+					for (size_t written = 0; written < StreamSize; written += block.size())
+					{
+						DWORD bytesWritten = 0;
+						WriteFile(pipe.GetWrite(), block.data(), (DWORD)block.size(), &bytesWritten, nullptr);
+					}
+					pipe.CloseWrite();
+				}
+			);
+		}
+
+		// The approach this replaces: accumulate reads into a string and
+		// copy each message out of it.
+		UINT64 ReadByCopying(const HANDLE readHandle)
+		{
+			UINT64 messages = 0;
+			std::string pending;
+			std::vector<char> buffer(64 * 1024);
+			DWORD bytesRead = 0;
+			while (ReadFile(readHandle, buffer.data(), (DWORD)buffer.size(), &bytesRead, nullptr) && bytesRead > 0)
+			{
+				pending.append(buffer.data(), bytesRead);
+				size_t start = 0;
+				size_t found = 0;
+				while ((found = pending.find('\n', start)) != std::string::npos)
+				{
+					std::string message = pending.substr(start, found - start);
+					messages += message.empty() ? 0 : 1;
+					start = found + 1;
+				}
+				pending.erase(0, start);
+			}
+			return messages;
+		}
+
+		UINT64 ReadWithReader(const HANDLE readHandle)
+		{
+			const char delimiter[] = { '\n' };
+			Boring32::Async::DelimitedStreamReader reader(readHandle, std::as_bytes(std::span(delimiter)));
+			std::span<const std::byte> message;
+			UINT64 messages = 0;
+			while (reader.Next(message))
+				messages += message.empty() ? 0 : 1;
+			return messages;
+		}
+
+		template<typename TReader>
+		void Measure(const std::wstring& name, const size_t messageSize, TReader read)
+		{
+			Boring32::Async::AnonymousPipe pipe(false, 1024 * 1024, L"");
+			Stopwatch stopwatch;
+			std::thread writer = StartWriter(pipe, messageSize);
+			const UINT64 messages = read(pipe.GetRead());
+			const double elapsed = stopwatch.ElapsedSeconds();
+			writer.join();
+
+			Report(name, L"throughput", StreamSize / elapsed / (1024 * 1024), L"MB/sec");
+			Report(name, L"messages", messages / elapsed, L"msgs/sec");
+		}
+	}
+
+	void DelimitedStreamReaderThroughput()
+	{
+		for (const size_t messageSize : { (size_t)100, (size_t)4096 })
+		{
+			const std::wstring size = std::to_wstring(messageSize) + L"B messages";
+			Measure(L"Copying reader " + size, messageSize, ReadByCopying);
+			Measure(L"DelimitedStreamReader " + size, messageSize, ReadWithReader);
+		}
+	}
+}
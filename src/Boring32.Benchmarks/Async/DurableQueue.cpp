@@ -0,0 +1,123 @@
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/Job.hpp"
+#include "../../Boring32/include/Async/Process.hpp"
+#include "../../Boring32/include/Async/DurableQueueProducer.hpp"
+#include "../../Boring32/include/Async/DurableQueueConsumer.hpp"
+#include "../../Boring32/include/Util/Util.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr size_t RecordSize = 256;
+		constexpr int Records = 1000000;
+		constexpr int DurableRecords = 2000;
+
+		std::wstring UniqueDirectory()
+		{
+			static int counter = 0;
+			wchar_t tempPath[MAX_PATH + 1]{ 0 };
+			GetTempPathW(MAX_PATH, tempPath);
+			return std::wstring(tempPath)
+				+ L"Boring32.Benchmarks.DurableQueue."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ L"."
+				+ std::to_wstring(counter++);
+		}
+
+		void DeleteQueue(const std::wstring& directory)
+		{
+			for (const UINT64 index : Boring32::Async::DurableQueueSegment::GetSegments(directory))
+				DeleteFileW(Boring32::Async::DurableQueueSegment::GetSegmentPath(directory, index).c_str());
+			for (const std::wstring& name : Boring32::Async::DurableQueueConsumer::GetConsumers(directory))
+				Boring32::Async::DurableQueueConsumer::Remove(directory, name);
+			RemoveDirectoryW(directory.c_str());
+		}
+
+		void MeasureThroughput(
+			const std::wstring& name,
+			const Boring32::Async::DurableQueueDurability durability,
+			const int records
+		)
+		{
+			const std::wstring directory = UniqueDirectory();
+			const Boring32::Async::DurableQueueSettings settings{ .Durability = durability };
+			const std::vector<std::byte> record(RecordSize, std::byte{ 0x51 });
+			{
+				Boring32::Async::DurableQueueProducer producer(directory, settings);
+				Boring32::Async::DurableQueueConsumer consumer(directory, L"benchmark", settings);
+
+				Stopwatch stopwatch;
+				for (int i = 0; i < records; i++)
+					producer.Enqueue(record);
+				producer.Flush();
+				Report(name, L"enqueue", records / stopwatch.ElapsedSeconds(), L"records/sec");
+
+				std::vector<std::byte> received;
+				stopwatch.Restart();
+				int count = 0;
+				while (consumer.TryDequeue(received))
+					count++;
+				consumer.Commit();
+				Report(name, L"dequeue", count / stopwatch.ElapsedSeconds(), L"records/sec");
+			}
+			DeleteQueue(directory);
+		}
+
+		// Kills a TestProcess producer part way through writing, then
+		// times how long the queue takes to reopen and to drain
+		void MeasureRecovery()
+		{
+			const std::wstring directory = UniqueDirectory();
+			const std::wstring executableDirectory = Boring32::Util::GetCurrentExecutableDirectory();
+			{
+				Boring32::Async::Job job(false);
+				STARTUPINFO startupInfo{ 0 };
+				Boring32::Async::Process process(
+					executableDirectory + L"\\TestProcess.exe",
+					L"TestProcess.exe 8 " + directory + L" " + std::to_wstring(RecordSize),
+					executableDirectory,
+					false,
+					CREATE_NO_WINDOW,
+					startupInfo
+				);
+				process.Start();
+				job.AssignProcessToThisJob(process.GetProcessHandle());
+				Sleep(2000);
+				TerminateProcess(process.GetProcessHandle(), 1);
+				WaitForSingleObject(process.GetProcessHandle(), INFINITE);
+			}
+
+			Stopwatch stopwatch;
+			{
+				Boring32::Async::DurableQueueProducer producer(directory);
+				Report(L"DurableQueue 256B crash", L"producer recovery", stopwatch.ElapsedSeconds() * 1000, L"ms");
+			}
+
+			{
+				stopwatch.Restart();
+				Boring32::Async::DurableQueueConsumer consumer(directory, L"benchmark");
+				std::vector<std::byte> received;
+				int count = 0;
+				while (consumer.TryDequeue(received))
+					count++;
+				const double elapsed = stopwatch.ElapsedSeconds();
+				Report(L"DurableQueue 256B crash", L"records recovered", count, L"records");
+				Report(L"DurableQueue 256B crash", L"drain", elapsed * 1000, L"ms");
+			}
+			DeleteQueue(directory);
+		}
+	}
+
+	// The recovery run uses TestProcess, so build that project too
+	void DurableQueueThroughput()
+	{
+		MeasureThroughput(L"DurableQueue 256B no flush", Boring32::Async::DurableQueueDurability::None, Records);
+		MeasureThroughput(L"DurableQueue 256B group commit", Boring32::Async::DurableQueueDurability::GroupCommit, Records);
+		MeasureThroughput(L"DurableQueue 256B every record", Boring32::Async::DurableQueueDurability::EveryRecord, DurableRecords);
+		MeasureRecovery();
+	}
+}
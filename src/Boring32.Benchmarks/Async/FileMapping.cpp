@@ -0,0 +1,226 @@
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <cstdint>
+#include <vector>
+#include <span>
+#include <random>
+#include <cstring>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/FileMapping.hpp"
+#include "../../Boring32/include/Async/SlidingFileView.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr std::uint64_t FileSize = 512ull * 1024 * 1024;
+		constexpr size_t ChunkSize = 1024 * 1024;
+		constexpr size_t RecordSize = 4096;
+		constexpr int RandomReads = 200000;
+
+#ifdef _WIN32
+		std::wstring CreateTestFile()
+		{
+			wchar_t tempPath[MAX_PATH + 1]{ 0 };
+			GetTempPathW(MAX_PATH, tempPath);
+			const std::wstring path = std::wstring(tempPath)
+				+ L"Boring32.Benchmarks.FileMapping."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ L".bin";
+
+			HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			std::vector<std::byte> chunk(ChunkSize);
+			for (size_t i = 0; i < chunk.size(); i++)
+				chunk[i] = static_cast<std::byte>(i % 251);
+			for (std::uint64_t written = 0; written < FileSize; written += ChunkSize)
+			{
+				DWORD bytesWritten = 0;
+				WriteFile(file, chunk.data(), (DWORD)chunk.size(), &bytesWritten, nullptr);
+			}
+			CloseHandle(file);
+			return path;
+		}
+#else
+		// Paths here are ASCII
+		std::string ToNarrow(const std::wstring& path)
+		{
+			return std::string(path.begin(), path.end());
+		}
+
+		std::wstring CreateTestFile()
+		{
+			const std::wstring path = L"/tmp/Boring32.Benchmarks.FileMapping." + std::to_wstring(getpid()) + L".bin";
+			const int file = open(ToNarrow(path).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			std::vector<std::byte> chunk(ChunkSize);
+			for (size_t i = 0; i < chunk.size(); i++)
+				chunk[i] = static_cast<std::byte>(i % 251);
+			for (std::uint64_t written = 0; written < FileSize; written += ChunkSize)
+			{
+				if (write(file, chunk.data(), chunk.size()) != (ssize_t)chunk.size())
+					break;
+			}
+			close(file);
+			return path;
+		}
+#endif
+
+		// Keeps the checksums from being optimised away
+		volatile std::uint64_t Sink = 0;
+
+		// Touches every 8 bytes so that mapped pages are actually faulted in
+		std::uint64_t Checksum(const std::span<const std::byte> data)
+		{
+			std::uint64_t sum = 0;
+			for (size_t i = 0; i + sizeof(std::uint64_t) <= data.size(); i += sizeof(std::uint64_t))
+			{
+				std::uint64_t value = 0;
+				std::memcpy(&value, data.data() + i, sizeof(value));
+				sum += value;
+			}
+			return sum;
+		}
+
+		std::vector<std::uint64_t> RandomOffsets()
+		{
+			std::mt19937_64 random(42);
+			std::uniform_int_distribution<std::uint64_t> distribution(0, FileSize / RecordSize - 1);
+			std::vector<std::uint64_t> offsets(RandomReads);
+			for (std::uint64_t& offset : offsets)
+				offset = distribution(random) * RecordSize;
+			return offsets;
+		}
+
+#ifdef _WIN32
+		void SequentialReadFile(const std::wstring& path)
+		{
+			HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			std::vector<std::byte> buffer(ChunkSize);
+			Stopwatch stopwatch;
+			std::uint64_t sum = 0;
+			DWORD bytesRead = 0;
+			while (ReadFile(file, buffer.data(), (DWORD)buffer.size(), &bytesRead, nullptr) && bytesRead > 0)
+				sum += Checksum({ buffer.data(), bytesRead });
+			const double elapsed = stopwatch.ElapsedSeconds();
+			Sink = sum;
+			CloseHandle(file);
+			Report(L"ReadFile sequential 1MB", L"throughput", FileSize / elapsed / (1024 * 1024), L"MB/s");
+		}
+#else
+		void SequentialReadFile(const std::wstring& path)
+		{
+			const int file = open(ToNarrow(path).c_str(), O_RDONLY);
+			posix_fadvise(file, 0, 0, POSIX_FADV_SEQUENTIAL);
+			std::vector<std::byte> buffer(ChunkSize);
+			Stopwatch stopwatch;
+			std::uint64_t sum = 0;
+			ssize_t bytesRead = 0;
+			while ((bytesRead = read(file, buffer.data(), buffer.size())) > 0)
+				sum += Checksum({ buffer.data(), (size_t)bytesRead });
+			const double elapsed = stopwatch.ElapsedSeconds();
+			Sink = sum;
+			close(file);
+			Report(L"read() sequential 1MB", L"throughput", FileSize / elapsed / (1024 * 1024), L"MB/s");
+		}
+#endif
+
+		void SequentialMapped(const std::wstring& path, const std::wstring& name, const Boring32::Async::SlidingFileViewSettings& settings)
+		{
+			Boring32::Async::FileMapping mapping(path, false);
+			Boring32::Async::SlidingFileView view(mapping, settings);
+			Stopwatch stopwatch;
+			std::uint64_t sum = 0;
+			for (std::uint64_t offset = 0; offset < FileSize; offset += ChunkSize)
+				sum += Checksum(view.At(offset, ChunkSize));
+			const double elapsed = stopwatch.ElapsedSeconds();
+			Sink = sum;
+			Report(name, L"throughput", FileSize / elapsed / (1024 * 1024), L"MB/s");
+		}
+
+#ifdef _WIN32
+		void RandomReadFile(const std::wstring& path, const std::vector<std::uint64_t>& offsets)
+		{
+			HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+			std::vector<std::byte> buffer(RecordSize);
+			Stopwatch stopwatch;
+			std::uint64_t sum = 0;
+			for (const std::uint64_t offset : offsets)
+			{
+				OVERLAPPED position{ 0 };
+				position.Offset = static_cast<DWORD>(offset);
+				position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+				DWORD bytesRead = 0;
+				ReadFile(file, buffer.data(), (DWORD)buffer.size(), &bytesRead, &position);
+				sum += Checksum({ buffer.data(), bytesRead });
+			}
+			const double elapsed = stopwatch.ElapsedSeconds();
+			Sink = sum;
+			CloseHandle(file);
+			Report(L"ReadFile random 4KB", L"reads", offsets.size() / elapsed, L"reads/sec");
+		}
+#else
+		void RandomReadFile(const std::wstring& path, const std::vector<std::uint64_t>& offsets)
+		{
+			const int file = open(ToNarrow(path).c_str(), O_RDONLY);
+			posix_fadvise(file, 0, 0, POSIX_FADV_RANDOM);
+			std::vector<std::byte> buffer(RecordSize);
+			Stopwatch stopwatch;
+			std::uint64_t sum = 0;
+			for (const std::uint64_t offset : offsets)
+			{
+				const ssize_t bytesRead = pread(file, buffer.data(), buffer.size(), static_cast<off_t>(offset));
+				sum += Checksum({ buffer.data(), bytesRead > 0 ? (size_t)bytesRead : 0 });
+			}
+			const double elapsed = stopwatch.ElapsedSeconds();
+			Sink = sum;
+			close(file);
+			Report(L"pread() random 4KB", L"reads", offsets.size() / elapsed, L"reads/sec");
+		}
+#endif
+
+		void RandomMapped(const std::wstring& path, const std::wstring& name, const std::vector<std::uint64_t>& offsets, const size_t windowSize)
+		{
+			Boring32::Async::FileMapping mapping(path, false);
+			Boring32::Async::SlidingFileView view(
+				mapping,
+				{ .WindowSize = windowSize, .MaxResidentBytes = 256 * 1024 * 1024 }
+			);
+			Stopwatch stopwatch;
+			std::uint64_t sum = 0;
+			for (const std::uint64_t offset : offsets)
+				sum += Checksum(view.At(offset, RecordSize));
+			const double elapsed = stopwatch.ElapsedSeconds();
+			Sink = sum;
+			Report(name, L"reads", offsets.size() / elapsed, L"reads/sec");
+			Report(name, L"windows mapped", static_cast<double>(view.GetMappedWindowCount()), L"");
+		}
+	}
+
+	// The file is written just before it is read, so these measure reads
+	// served from the file cache rather than from disk.
+	void FileMappingScan()
+	{
+		const std::wstring path = CreateTestFile();
+		SequentialReadFile(path);
+		SequentialMapped(path, L"SlidingFileView sequential 1MB", {});
+		SequentialMapped(path, L"SlidingFileView sequential 1MB prefetch", { .PrefetchNext = true });
+		SequentialMapped(
+			path,
+			L"SlidingFileView sequential 1MB 8MB windows",
+			{ .WindowSize = 8 * 1024 * 1024, .MaxResidentBytes = 32 * 1024 * 1024 }
+		);
+
+		const std::vector<std::uint64_t> offsets = RandomOffsets();
+		RandomReadFile(path, offsets);
+		RandomMapped(path, L"SlidingFileView random 4KB 64MB windows", offsets, 64 * 1024 * 1024);
+		RandomMapped(path, L"SlidingFileView random 4KB 1MB windows", offsets, 1024 * 1024);
+#ifdef _WIN32
+		DeleteFileW(path.c_str());
+#else
+		unlink(ToNarrow(path).c_str());
+#endif
+	}
+}
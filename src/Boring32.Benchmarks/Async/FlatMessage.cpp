@@ -0,0 +1,134 @@
+#include <Windows.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/FlatMessageBuilder.hpp"
+#include "../../Boring32/include/Async/FlatMessageView.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr int Iterations = 1000000;
+
+		enum Field : UINT16
+		{
+			Id,
+			Price,
+			Quantity,
+			Symbol,
+			Note,
+			FieldCount
+		};
+
+		// Keeps the results from being optimised away
+		volatile double Sink = 0;
+
+		// The key=value;key=value wstring format that the pipes carry today
+		std::wstring EncodeText(const UINT64 id, const double price, const UINT32 quantity)
+		{
+			return L"id=" + std::to_wstring(id)
+				+ L";price=" + std::to_wstring(price)
+				+ L";quantity=" + std::to_wstring(quantity)
+				+ L";symbol=MSFT"
+				+ L";note=limit order, good until cancelled";
+		}
+
+		// Finds the value of key by scanning the message, as a reader of
+		// the text format must
+		std::wstring_view FindText(const std::wstring_view message, const std::wstring_view key)
+		{
+			size_t start = 0;
+			while (start < message.size())
+			{
+				size_t end = message.find(L';', start);
+				if (end == std::wstring_view::npos)
+					end = message.size();
+				const std::wstring_view pair = message.substr(start, end - start);
+				const size_t equals = pair.find(L'=');
+				if (pair.substr(0, equals) == key)
+					return pair.substr(equals + 1);
+				start = end + 1;
+			}
+			return {};
+		}
+
+		double DecodeText(const std::wstring& message)
+		{
+			const UINT64 id = std::stoull(std::wstring(FindText(message, L"id")));
+			const double price = std::stod(std::wstring(FindText(message, L"price")));
+			const UINT32 quantity = std::stoul(std::wstring(FindText(message, L"quantity")));
+			return id + price + quantity + FindText(message, L"symbol").size() + FindText(message, L"note").size();
+		}
+
+		void EncodeFlat(
+			Boring32::Async::FlatMessageBuilder& builder,
+			const UINT64 id,
+			const double price,
+			const UINT32 quantity
+		)
+		{
+			builder.Reset();
+			builder.Add(Id, id);
+			builder.Add(Price, price);
+			builder.Add(Quantity, quantity);
+			builder.AddString(Symbol, std::wstring_view(L"MSFT"));
+			builder.AddString(Note, std::wstring_view(L"limit order, good until cancelled"));
+			builder.Finish();
+		}
+
+		double DecodeFlat(const std::span<const std::byte> message)
+		{
+			const Boring32::Async::FlatMessageView view(message);
+			return *view.Get<UINT64>(Id)
+				+ *view.Get<double>(Price)
+				+ *view.Get<UINT32>(Quantity)
+				+ view.GetWideString(Symbol).size()
+				+ view.GetWideString(Note).size();
+		}
+	}
+
+	void FlatMessageEncoding()
+	{
+		Stopwatch stopwatch;
+		size_t textSize = 0;
+		for (int i = 0; i < Iterations; i++)
+			textSize += EncodeText(i, i * 0.25, i % 1000).size();
+		Report(L"wstring key=value", L"encode", stopwatch.ElapsedSeconds() * 1e9 / Iterations, L"ns/msg");
+
+		const std::wstring text = EncodeText(12345, 9.75, 100);
+		double sum = 0;
+		stopwatch.Restart();
+		for (int i = 0; i < Iterations; i++)
+			sum += DecodeText(text);
+		Report(L"wstring key=value", L"access all fields", stopwatch.ElapsedSeconds() * 1e9 / Iterations, L"ns/msg");
+		stopwatch.Restart();
+		for (int i = 0; i < Iterations; i++)
+			sum += std::stod(std::wstring(FindText(text, L"price")));
+		Report(L"wstring key=value", L"access one field", stopwatch.ElapsedSeconds() * 1e9 / Iterations, L"ns/msg");
+		Report(L"wstring key=value", L"size", static_cast<double>(text.size() * sizeof(wchar_t)), L"bytes");
+
+		// The builder writes into one buffer for the whole run
+		std::vector<UINT64> storage(64);
+		Boring32::Async::FlatMessageBuilder builder(std::as_writable_bytes(std::span(storage)), FieldCount);
+		stopwatch.Restart();
+		for (int i = 0; i < Iterations; i++)
+			EncodeFlat(builder, i, i * 0.25, i % 1000);
+		Report(L"FlatMessage", L"encode", stopwatch.ElapsedSeconds() * 1e9 / Iterations, L"ns/msg");
+
+		EncodeFlat(builder, 12345, 9.75, 100);
+		const std::span<const std::byte> message = builder.Finish();
+		stopwatch.Restart();
+		for (int i = 0; i < Iterations; i++)
+			sum += DecodeFlat(message);
+		Report(L"FlatMessage", L"access all fields", stopwatch.ElapsedSeconds() * 1e9 / Iterations, L"ns/msg");
+		stopwatch.Restart();
+		for (int i = 0; i < Iterations; i++)
+			sum += *Boring32::Async::FlatMessageView(message).Get<double>(Price);
+		Report(L"FlatMessage", L"access one field", stopwatch.ElapsedSeconds() * 1e9 / Iterations, L"ns/msg");
+		Report(L"FlatMessage", L"size", static_cast<double>(message.size()), L"bytes");
+
+		Sink = sum + textSize;
+	}
+}
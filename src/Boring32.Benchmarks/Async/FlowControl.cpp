@@ -0,0 +1,83 @@
+#include <Windows.h>
+#include <vector>
+#include <thread>
+#include <memory>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/Event.hpp"
+#include "../../Boring32/include/Async/Pipes/PooledNamedPipeServer.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr int MessageCount = 20000;
+		constexpr size_t MessageSize = 4096;
+
+		// Busy-waits, as Sleep() is too coarse to pace the consumer
+		void Spin(const double microseconds)
+		{
+			Stopwatch stopwatch;
+			while (stopwatch.ElapsedSeconds() * 1e6 < microseconds)
+				YieldProcessor();
+		}
+
+		// A producer writes as fast as the session lets it while the client
+		// reads slowly, and reports how much the session queued.
+		void MeasureSlowConsumer(const std::wstring& name, const Boring32::Async::FlowControlSettings& limits)
+		{
+			const std::wstring pipeName =
+				L"\\\\.\\pipe\\Boring32.Benchmarks.FlowControl." + std::to_wstring(GetCurrentProcessId());
+			std::shared_ptr<Boring32::Async::PipeSession> session;
+			Boring32::Async::Event connected(false, true, false);
+			Boring32::Async::PooledNamedPipeServer server(
+				pipeName,
+				Boring32::Async::PooledNamedPipeServerSettings{ .WriteLimits = limits },
+				Boring32::Async::PipeSessionHandlers{
+					.OnConnected = [&](const std::shared_ptr<Boring32::Async::PipeSession>& connectedSession)
+					{
+						session = connectedSession;
+						connected.Signal();
+					}
+				}
+			);
+
+			HANDLE client = CreateFileW(pipeName.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+			DWORD mode = PIPE_READMODE_MESSAGE;
+			SetNamedPipeHandleState(client, &mode, nullptr, nullptr);
+			connected.WaitOnEvent(INFINITE, false);
+
+			Stopwatch stopwatch;
+			std::thread producer(
+				[&session]()
+				{
+					const std::vector<std::byte> message(MessageSize, std::byte{ 0x42 });
+					for (int i = 0; i < MessageCount; i++)
+						session->Write(message);
+				});
+			std::vector<char> buffer(MessageSize);
+			for (int i = 0; i < MessageCount; i++)
+			{
+				DWORD bytesRead = 0;
+				ReadFile(client, buffer.data(), (DWORD)buffer.size(), &bytesRead, nullptr);
+				Spin(20);
+			}
+			const double elapsed = stopwatch.ElapsedSeconds();
+			producer.join();
+
+			const Boring32::Async::FlowControlStats stats = session->GetWriteStats();
+			Report(name, L"peak queued", stats.PeakBytes / 1024.0, L"KB");
+			Report(name, L"peak queued messages", (double)stats.PeakMessages, L"msgs");
+			Report(name, L"producer stalled", stats.StalledMicroseconds / 1000.0, L"ms");
+			Report(name, L"throughput", MessageCount / elapsed, L"msgs/sec");
+			session = nullptr;
+			CloseHandle(client);
+		}
+	}
+
+	void FlowControlSlowConsumer()
+	{
+		MeasureSlowConsumer(L"Unlimited queue", Boring32::Async::FlowControlSettings{});
+		MeasureSlowConsumer(L"1MB queue limit", Boring32::Async::FlowControlSettings{ .MaxBytes = 1024 * 1024 });
+		MeasureSlowConsumer(L"64 message limit", Boring32::Async::FlowControlSettings{ .MaxMessages = 64 });
+	}
+}
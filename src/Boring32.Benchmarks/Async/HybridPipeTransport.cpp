@@ -0,0 +1,100 @@
+#include <Windows.h>
+#include <vector>
+#include <span>
+#include <string>
+#include <thread>
+#include <algorithm>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/Pipes/OverlappedNamedPipeServer.hpp"
+#include "../../Boring32/include/Async/Pipes/OverlappedNamedPipeClient.hpp"
+#include "../../Boring32/include/Async/Pipes/PipeFrameChannel.hpp"
+#include "../../Boring32/include/Async/Pipes/HybridPipeTransport.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		// Each size is sent until this much data has been transferred
+		constexpr size_t BytesPerSize = 512 * 1024 * 1024;
+
+		// Streams payloads from a client thread to the server, over a plain
+		// pipe channel or the hybrid transport, and reports the rate at
+		// which the server receives them.
+		template<typename TChannel, typename... TArgs>
+		void Measure(const std::wstring& name, const size_t payloadSize, const TArgs&... args)
+		{
+			const std::wstring pipeName =
+				L"Boring32.Benchmarks.HybridPipeTransport." + std::to_wstring(GetCurrentProcessId());
+			Boring32::Async::OverlappedNamedPipeServer serverPipe(pipeName, 64 * 1024, 1, L"", false, true);
+			Boring32::Async::OverlappedNamedPipeClient clientPipe(pipeName);
+			Boring32::Async::OverlappedOp connectOp;
+			serverPipe.Connect(connectOp);
+			clientPipe.Connect(0);
+			if (connectOp.LastError() != ERROR_PIPE_CONNECTED)
+				connectOp.WaitForCompletion(INFINITE);
+
+			TChannel server(serverPipe, args...);
+			TChannel client(clientPipe, args...);
+			const std::vector<std::byte> payload(payloadSize, std::byte{ 0x42 });
+			const size_t messageCount = (std::max)(BytesPerSize / payloadSize, (size_t)4);
+
+			Stopwatch stopwatch;
+			std::thread sender(
+				[&client, &payload, messageCount]()
+				{
+					for (size_t i = 0; i < messageCount; i++)
+						client.Send(payload);
+				});
+			UINT64 bytesReceived = 0;
+			volatile std::byte checksum{ 0 };
+			for (size_t i = 0; i < messageCount; i++)
+			{
+				auto message = server.Receive(INFINITE);
+				// Read a byte from each page, as a consumer would touch
+				// the payload
+				const std::span<const std::byte> data = message.GetData();
+				for (size_t offset = 0; offset < data.size(); offset += 4096)
+					checksum = checksum ^ data[offset];
+				bytesReceived += data.size();
+			}
+			const double elapsed = stopwatch.ElapsedSeconds();
+			sender.join();
+
+			Report(name, L"messages", messageCount / elapsed, L"msgs/sec");
+			Report(name, L"throughput", bytesReceived / elapsed / (1024 * 1024), L"MB/s");
+		}
+	}
+
+	void HybridPipeTransportThroughput()
+	{
+		const struct { const wchar_t* Name; size_t Size; } sizes[] = {
+			{ L"64KB", 64 * 1024 },
+			{ L"1MB", 1024 * 1024 },
+			{ L"16MB", 16 * 1024 * 1024 },
+			{ L"64MB", 64 * 1024 * 1024 }
+		};
+		for (const auto& size : sizes)
+		{
+			// The plain channel needs a receive buffer that holds a whole
+			// payload. The hybrid transport's threshold is lowered so every
+			// size goes through shared memory, which holds two payloads.
+			Measure<Boring32::Async::PipeFrameChannel>(
+				std::wstring(L"Plain pipe ") + size.Name,
+				size.Size,
+				Boring32::Async::PipeFrameChannelSettings{
+					.BufferSize = (DWORD)(size.Size + 64 * 1024),
+					.MaxBuffers = 2
+				}
+			);
+			Measure<Boring32::Async::HybridPipeTransport>(
+				std::wstring(L"Hybrid pipe ") + size.Name,
+				size.Size,
+				L"Boring32.Benchmarks.HybridPipeTransport." + std::to_wstring(GetCurrentProcessId()),
+				Boring32::Async::HybridPipeTransportSettings{
+					.InlineThreshold = 32 * 1024,
+					.SharedMemorySize = (UINT)(std::max)(size.Size * 2, (size_t)32 * 1024 * 1024)
+				}
+			);
+		}
+	}
+}
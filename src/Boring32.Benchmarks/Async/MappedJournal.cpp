@@ -0,0 +1,186 @@
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/Job.hpp"
+#include "../../Boring32/include/Async/Event.hpp"
+#include "../../Boring32/include/Async/Process.hpp"
+#include "../../Boring32/include/Async/MappedJournalWriter.hpp"
+#include "../../Boring32/include/Async/MappedJournalSegment.hpp"
+#include "../../Boring32/include/Util/Util.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr size_t RecordSize = 64;
+		constexpr int RecordsPerWriter = 500000;
+		constexpr int DurableRecords = 2000;
+
+		std::wstring UniquePath()
+		{
+			static int counter = 0;
+			wchar_t tempPath[MAX_PATH + 1]{ 0 };
+			GetTempPathW(MAX_PATH, tempPath);
+			return std::wstring(tempPath)
+				+ L"Boring32.Benchmarks.MappedJournal."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ L"."
+				+ std::to_wstring(counter++);
+		}
+
+		void DeleteJournal(const std::wstring& path)
+		{
+			for (UINT64 i = 0; Boring32::Async::MappedJournalSegment::Exists(path, i); i++)
+				DeleteFileW(Boring32::Async::MappedJournalSegment::GetSegmentPath(path, i).c_str());
+		}
+
+		HANDLE OpenAppendFile(const std::wstring& path)
+		{
+			return CreateFileW(
+				path.c_str(),
+				FILE_APPEND_DATA,
+				FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+				nullptr,
+				OPEN_ALWAYS,
+				FILE_ATTRIBUTE_NORMAL,
+				nullptr
+			);
+		}
+
+		template<typename TAppend>
+		double RunThreads(const int threadCount, const int records, TAppend&& append)
+		{
+			std::vector<std::thread> threads;
+			Stopwatch stopwatch;
+			for (int t = 0; t < threadCount; t++)
+				threads.emplace_back([&append, records]() { append(records); });
+			for (std::thread& thread : threads)
+				thread.join();
+			return threadCount * records / stopwatch.ElapsedSeconds();
+		}
+
+		void MeasureThreads(const int threadCount)
+		{
+			const std::vector<std::byte> record(RecordSize, std::byte{ 0x4A });
+			const std::wstring suffix = L" " + std::to_wstring(threadCount) + L" threads";
+
+			const std::wstring journalPath = UniquePath();
+			const double journalRate = RunThreads(
+				threadCount,
+				RecordsPerWriter,
+				[&journalPath, &record](const int records)
+				{
+					Boring32::Async::MappedJournalWriter writer(journalPath);
+					for (int i = 0; i < records; i++)
+						writer.Append(record);
+				});
+			DeleteJournal(journalPath);
+			Report(L"MappedJournal 64B" + suffix, L"appends", journalRate, L"appends/sec");
+
+			const std::wstring filePath = UniquePath();
+			HANDLE file = OpenAppendFile(filePath);
+			const double fileRate = RunThreads(
+				threadCount,
+				RecordsPerWriter,
+				[file, &record](const int records)
+				{
+					for (int i = 0; i < records; i++)
+					{
+						DWORD bytesWritten = 0;
+						WriteFile(file, record.data(), (DWORD)record.size(), &bytesWritten, nullptr);
+					}
+				});
+			CloseHandle(file);
+			DeleteFileW(filePath.c_str());
+			Report(L"WriteFile 64B" + suffix, L"appends", fileRate, L"appends/sec");
+		}
+
+		void MeasureDurable()
+		{
+			const std::vector<std::byte> record(RecordSize, std::byte{ 0x4A });
+
+			const std::wstring journalPath = UniquePath();
+			{
+				Boring32::Async::MappedJournalWriter writer(journalPath, { .Durable = true });
+				Stopwatch stopwatch;
+				for (int i = 0; i < DurableRecords; i++)
+					writer.Append(record);
+				Report(L"MappedJournal 64B durable", L"appends", DurableRecords / stopwatch.ElapsedSeconds(), L"appends/sec");
+			}
+			DeleteJournal(journalPath);
+
+			const std::wstring filePath = UniquePath();
+			HANDLE file = OpenAppendFile(filePath);
+			Stopwatch stopwatch;
+			for (int i = 0; i < DurableRecords; i++)
+			{
+				DWORD bytesWritten = 0;
+				WriteFile(file, record.data(), (DWORD)record.size(), &bytesWritten, nullptr);
+				FlushFileBuffers(file);
+			}
+			Report(L"WriteFile 64B durable", L"appends", DurableRecords / stopwatch.ElapsedSeconds(), L"appends/sec");
+			CloseHandle(file);
+			DeleteFileW(filePath.c_str());
+		}
+
+		// Starts TestProcess appenders, which wait on a shared event so
+		// that process start-up is not measured
+		double RunProcesses(const std::wstring& target, const std::wstring& path, const int processCount)
+		{
+			const std::wstring directory = Boring32::Util::GetCurrentExecutableDirectory();
+			const std::wstring eventName = L"Boring32.Benchmarks.MappedJournal.Start." + std::to_wstring(GetCurrentProcessId());
+			Boring32::Async::Event start(false, true, false, eventName);
+			Boring32::Async::Job job(false);
+			std::vector<Boring32::Async::Process> processes;
+			for (int i = 0; i < processCount; i++)
+			{
+				STARTUPINFO startupInfo{ 0 };
+				Boring32::Async::Process process(
+					directory + L"\\TestProcess.exe",
+					L"TestProcess.exe 7 " + target + L" " + path + L" " + std::to_wstring(RecordsPerWriter) + L" " + eventName,
+					directory,
+					false,
+					CREATE_NO_WINDOW,
+					startupInfo
+				);
+				process.Start();
+				job.AssignProcessToThisJob(process.GetProcessHandle());
+				processes.push_back(std::move(process));
+			}
+			// Give the processes time to open their journal or file
+			Sleep(1000);
+
+			std::vector<HANDLE> handles;
+			for (Boring32::Async::Process& process : processes)
+				handles.push_back(process.GetProcessHandle());
+			Stopwatch stopwatch;
+			start.Signal();
+			WaitForMultipleObjects((DWORD)handles.size(), handles.data(), true, INFINITE);
+			return processCount * RecordsPerWriter / stopwatch.ElapsedSeconds();
+		}
+
+		void MeasureProcesses(const int processCount)
+		{
+			const std::wstring suffix = L" " + std::to_wstring(processCount) + L" processes";
+
+			const std::wstring journalPath = UniquePath();
+			Report(L"MappedJournal 64B" + suffix, L"appends", RunProcesses(L"journal", journalPath, processCount), L"appends/sec");
+			DeleteJournal(journalPath);
+
+			const std::wstring filePath = UniquePath();
+			Report(L"WriteFile 64B" + suffix, L"appends", RunProcesses(L"writefile", filePath, processCount), L"appends/sec");
+			DeleteFileW(filePath.c_str());
+		}
+	}
+
+	// The cross-process runs use TestProcess, so build that project too
+	void MappedJournalAppend()
+	{
+		MeasureThreads(1);
+		MeasureThreads(4);
+		MeasureDurable();
+		MeasureProcesses(4);
+	}
+}
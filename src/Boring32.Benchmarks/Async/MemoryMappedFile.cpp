@@ -0,0 +1,65 @@
+#include <Windows.h>
+#include <string>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/MemoryMappedFile.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr UINT SegmentSize = 512 * 1024 * 1024;
+		constexpr int Accesses = 20000000;
+
+		// Keeps the reads from being optimised away
+		volatile UINT64 Sink = 0;
+
+		// Reads 8 bytes at pseudo-random offsets spread over the whole
+		// segment, so nearly every access touches a page whose
+		// translation is not cached in the TLB when using 4KB pages.
+		double RandomAccessNanoseconds(const void* view, const UINT size)
+		{
+			const UINT64* words = static_cast<const UINT64*>(view);
+			const UINT64 wordCount = size / sizeof(UINT64);
+			UINT64 state = 0x9E3779B97F4A7C15ull;
+			UINT64 sum = 0;
+			Stopwatch stopwatch;
+			for (int i = 0; i < Accesses; i++)
+			{
+				state = state * 6364136223846793005ull + 1442695040888963407ull;
+				sum += words[(state >> 17) % wordCount];
+			}
+			const double elapsed = stopwatch.ElapsedSeconds();
+			Sink = sum;
+			return elapsed * 1e9 / Accesses;
+		}
+
+		void Measure(const std::wstring& name, const Boring32::Async::MemoryMappedFileOptions& options)
+		{
+			Stopwatch stopwatch;
+			Boring32::Async::MemoryMappedFile mmf(
+				L"Boring32.Benchmarks.MemoryMappedFile." + std::to_wstring(GetCurrentProcessId()),
+				SegmentSize,
+				false,
+				options
+			);
+			Report(name, L"create", stopwatch.ElapsedSeconds() * 1000, L"ms");
+			if (options.LargePages && !mmf.UsesLargePages())
+			{
+				Report(name, L"large pages unavailable", 0, L"");
+				return;
+			}
+			// The first pass includes any page faults not taken up front
+			Report(name, L"random read first pass", RandomAccessNanoseconds(mmf.GetViewPointer(), mmf.GetSize()), L"ns");
+			Report(name, L"random read", RandomAccessNanoseconds(mmf.GetViewPointer(), mmf.GetSize()), L"ns");
+		}
+	}
+
+	// There is no portable way to read the TLB miss counters from user
+	// mode, so the effect of page size is shown as random access latency.
+	void MemoryMappedFilePageSize()
+	{
+		Measure(L"MemoryMappedFile 512MB 4KB pages", {});
+		Measure(L"MemoryMappedFile 512MB 4KB pages prefaulted", { .Prefault = true });
+		Measure(L"MemoryMappedFile 512MB large pages", { .LargePages = true, .FallbackToSmallPages = true });
+	}
+}
@@ -0,0 +1,116 @@
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/MemoryMappedVector.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr size_t RecordCount = 10000000;
+
+		struct Record
+		{
+			UINT64 Id;
+			double Value;
+			UINT32 Flags;
+		};
+
+		// Keeps the sums from being optimised away
+		volatile double Sink = 0;
+
+		std::wstring MakePath(const std::wstring& extension)
+		{
+			wchar_t tempPath[MAX_PATH + 1]{ 0 };
+			GetTempPathW(MAX_PATH, tempPath);
+			return std::wstring(tempPath)
+				+ L"Boring32.Benchmarks.MemoryMappedVector."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ extension;
+		}
+
+		Record MakeRecord(const size_t i)
+		{
+			return { i, i * 0.5, static_cast<UINT32>(i % 7) };
+		}
+
+		double Sum(const std::span<const Record> records)
+		{
+			double sum = 0;
+			for (const Record& record : records)
+				sum += record.Value + record.Flags;
+			return sum;
+		}
+
+		void WriteFiles(const std::wstring& vectorPath, const std::wstring& binaryPath, const std::wstring& textPath)
+		{
+			std::vector<Record> records;
+			records.reserve(RecordCount);
+			for (size_t i = 0; i < RecordCount; i++)
+				records.push_back(MakeRecord(i));
+
+			Boring32::Async::MemoryMappedVector<Record> vector(vectorPath, { .InitialCapacity = RecordCount });
+			vector.Append(records);
+			vector.Flush();
+
+			HANDLE file = CreateFileW(binaryPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			DWORD bytesWritten = 0;
+			WriteFile(file, records.data(), static_cast<DWORD>(records.size() * sizeof(Record)), &bytesWritten, nullptr);
+			CloseHandle(file);
+
+			std::ofstream text(textPath);
+			for (const Record& record : records)
+				text << record.Id << ',' << record.Value << ',' << record.Flags << '\n';
+		}
+	}
+
+	// The files are written just before they are loaded, so these measure
+	// loads served from the file cache, as on a warm restart.
+	void MemoryMappedVectorLoad()
+	{
+		const std::wstring vectorPath = MakePath(L".vector");
+		const std::wstring binaryPath = MakePath(L".bin");
+		const std::wstring textPath = MakePath(L".csv");
+		WriteFiles(vectorPath, binaryPath, textPath);
+
+		{
+			Stopwatch stopwatch;
+			Boring32::Async::MemoryMappedVector<Record> vector(vectorPath, { .ReadOnly = true });
+			Report(L"MemoryMappedVector", L"open", stopwatch.ElapsedSeconds() * 1000, L"ms");
+			Sink = Sum(vector.GetData());
+			Report(L"MemoryMappedVector", L"open and scan", stopwatch.ElapsedSeconds() * 1000, L"ms");
+		}
+
+		{
+			Stopwatch stopwatch;
+			HANDLE file = CreateFileW(binaryPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			std::vector<Record> records(RecordCount);
+			DWORD bytesRead = 0;
+			ReadFile(file, records.data(), static_cast<DWORD>(records.size() * sizeof(Record)), &bytesRead, nullptr);
+			CloseHandle(file);
+			Report(L"ReadFile binary", L"load", stopwatch.ElapsedSeconds() * 1000, L"ms");
+			Sink = Sum(records);
+			Report(L"ReadFile binary", L"load and scan", stopwatch.ElapsedSeconds() * 1000, L"ms");
+		}
+
+		{
+			Stopwatch stopwatch;
+			std::ifstream text(textPath);
+			std::vector<Record> records;
+			records.reserve(RecordCount);
+			Record record{};
+			char separator = 0;
+			while (text >> record.Id >> separator >> record.Value >> separator >> record.Flags)
+				records.push_back(record);
+			Report(L"Text parse", L"load", stopwatch.ElapsedSeconds() * 1000, L"ms");
+			Sink = Sum(records);
+			Report(L"Text parse", L"load and scan", stopwatch.ElapsedSeconds() * 1000, L"ms");
+		}
+
+		DeleteFileW(vectorPath.c_str());
+		DeleteFileW(binaryPath.c_str());
+		DeleteFileW(textPath.c_str());
+	}
+}
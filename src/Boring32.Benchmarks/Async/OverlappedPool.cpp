@@ -0,0 +1,62 @@
+#include <Windows.h>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/OverlappedIo.hpp"
+#include "../../Boring32/include/Async/OverlappedPool.hpp"
+#include "../../Boring32/include/Async/Pipes/OverlappedNamedPipeServer.hpp"
+#include "../../Boring32/include/Async/Pipes/OverlappedNamedPipeClient.hpp"
+
+namespace Benchmarks
+{
+	// Compares creating an OverlappedIo per operation with leasing a
+	// pooled OVERLAPPED, alone and around a pipe write and read.
+	void OverlappedPoolOverhead()
+	{
+		constexpr int iterations = 200000;
+
+		Stopwatch stopwatch;
+		for (int i = 0; i < iterations; i++)
+			Boring32::Async::OverlappedIo oio;
+		Report(L"OverlappedIo", L"create+destroy", stopwatch.ElapsedSeconds() * 1e9 / iterations, L"ns/op");
+
+		Boring32::Async::OverlappedPool pool(4);
+		stopwatch.Restart();
+		for (int i = 0; i < iterations; i++)
+			Boring32::Async::OverlappedLease lease = pool.Acquire();
+		Report(L"OverlappedPool", L"acquire+release", stopwatch.ElapsedSeconds() * 1e9 / iterations, L"ns/op");
+
+		const std::wstring pipeName = L"Boring32.Benchmarks.OverlappedPool." + std::to_wstring(GetCurrentProcessId());
+		Boring32::Async::OverlappedNamedPipeServer server(pipeName, 4096, 1, L"", false, true);
+		Boring32::Async::OverlappedNamedPipeClient client(pipeName);
+		Boring32::Async::OverlappedOp connectOp;
+		server.Connect(connectOp);
+		client.Connect(0);
+		if (connectOp.LastError() != ERROR_PIPE_CONNECTED)
+			connectOp.WaitForCompletion(INFINITE);
+		const std::wstring message(32, L'x');
+
+		stopwatch.Restart();
+		for (int i = 0; i < iterations; i++)
+		{
+			Boring32::Async::OverlappedIo writeOp;
+			client.Write(message, writeOp);
+			Boring32::Async::OverlappedIo readOp;
+			server.Read((DWORD)message.size(), readOp);
+			readOp.WaitForCompletion(INFINITE);
+			writeOp.WaitForCompletion(INFINITE);
+		}
+		Report(L"OverlappedIo", L"pipe write+read", stopwatch.ElapsedSeconds() * 1e9 / iterations, L"ns/op");
+
+		std::wstring buffer(message.size(), L'\0');
+		stopwatch.Restart();
+		for (int i = 0; i < iterations; i++)
+		{
+			Boring32::Async::OverlappedLease writeLease = pool.Acquire();
+			client.Write(message, writeLease);
+			Boring32::Async::OverlappedLease readLease = pool.Acquire();
+			server.Read(buffer, readLease);
+			readLease.WaitForCompletion(INFINITE);
+			writeLease.WaitForCompletion(INFINITE);
+		}
+		Report(L"OverlappedPool", L"pipe write+read", stopwatch.ElapsedSeconds() * 1e9 / iterations, L"ns/op");
+	}
+}
@@ -0,0 +1,71 @@
+#include <Windows.h>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/Pipes/OverlappedNamedPipeServer.hpp"
+#include "../../Boring32/include/Async/Pipes/OverlappedNamedPipeClient.hpp"
+#include "../../Boring32/include/Async/Pipes/PipeFrameChannel.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		// Streams messages from a client thread to the server and reports
+		// the rate at which the server receives them, along with how many
+		// writes the client needed per message.
+		void MeasureFrames(
+			const std::wstring& name,
+			const size_t messageSize,
+			const int messageCount,
+			const DWORD batchSize = 0
+		)
+		{
+			const std::wstring pipeName =
+				L"Boring32.Benchmarks.PipeFrameChannel." + std::to_wstring(GetCurrentProcessId());
+			Boring32::Async::OverlappedNamedPipeServer serverPipe(pipeName, 64 * 1024, 1, L"", false, true);
+			Boring32::Async::OverlappedNamedPipeClient clientPipe(pipeName);
+			Boring32::Async::OverlappedOp connectOp;
+			serverPipe.Connect(connectOp);
+			clientPipe.Connect(0);
+			if (connectOp.LastError() != ERROR_PIPE_CONNECTED)
+				connectOp.WaitForCompletion(INFINITE);
+
+			Boring32::Async::PipeFrameChannelSettings settings{
+				.BufferSize = (DWORD)(std::max)((size_t)256 * 1024, messageSize * 2 + Boring32::Async::PipeFrameChannel::HeaderSize),
+				.MaxBuffers = 4
+			};
+			Boring32::Async::PipeFrameChannel server(serverPipe, settings);
+			settings.BatchSize = batchSize;
+			Boring32::Async::PipeFrameChannel client(clientPipe, settings);
+			const std::vector<std::byte> payload(messageSize, std::byte{ 0x42 });
+
+			Stopwatch stopwatch;
+			std::thread sender(
+				[&client, &payload, messageCount]()
+				{
+					for (int i = 0; i < messageCount; i++)
+						client.Send(payload);
+					client.Flush();
+				});
+			UINT64 bytesReceived = 0;
+			for (int i = 0; i < messageCount; i++)
+				bytesReceived += server.Receive(INFINITE).GetSize();
+			const double elapsed = stopwatch.ElapsedSeconds();
+			sender.join();
+
+			Report(name, L"messages", messageCount / elapsed, L"msgs/sec");
+			Report(name, L"throughput", bytesReceived / elapsed / (1024 * 1024), L"MB/s");
+			Report(name, L"writes", (double)client.GetWriteCalls() / client.GetFramesSent(), L"syscalls/msg");
+		}
+	}
+
+	void PipeFrameChannelThroughput()
+	{
+		MeasureFrames(L"PipeFrameChannel 64B", 64, 500000);
+		MeasureFrames(L"PipeFrameChannel 4KB", 4 * 1024, 100000);
+		MeasureFrames(L"PipeFrameChannel 1MB", 1024 * 1024, 1000);
+		MeasureFrames(L"PipeFrameChannel 64B batched 16KB", 64, 500000, 16 * 1024);
+		MeasureFrames(L"PipeFrameChannel 512B batched 16KB", 512, 500000, 16 * 1024);
+	}
+}
@@ -0,0 +1,368 @@
+#include <Windows.h>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/Job.hpp"
+#include "../../Boring32/include/Async/Event.hpp"
+#include "../../Boring32/include/Async/Process.hpp"
+#include "../../Boring32/include/Async/MemoryMappedFile.hpp"
+#include "../../Boring32/include/Async/OverlappedIo.hpp"
+#include "../../Boring32/include/Async/Pipes/AnonymousPipe.hpp"
+#include "../../Boring32/include/Async/Pipes/DelimitedStreamReader.hpp"
+#include "../../Boring32/include/Async/Pipes/BlockingNamedPipeServer.hpp"
+#include "../../Boring32/include/Async/Pipes/OverlappedNamedPipeServer.hpp"
+#include "../../Boring32/include/Util/Util.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr DWORD PipeSize = 1024 * 1024;
+		// Streaming keeps at most this many bytes in flight per peer, so
+		// neither direction fills its pipe and blocks the other
+		constexpr size_t StreamWindowBytes = 256 * 1024;
+		// Large enough for the biggest message and its length
+		constexpr UINT SharedMemorySize = 256 * 1024;
+		constexpr size_t SharedMemoryDataOffset = 8;
+
+		std::wstring UniqueName()
+		{
+			static int counter = 0;
+			return L"Boring32.Benchmarks.PipeIpcSuite."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ L"."
+				+ std::to_wstring(counter++);
+		}
+
+		// Starts TestProcess as an echo peer using the given transport
+		Boring32::Async::Process StartPeer(
+			Boring32::Async::Job& job,
+			const std::wstring& arguments,
+			const bool inheritHandles
+		)
+		{
+			const std::wstring directory = Boring32::Util::GetCurrentExecutableDirectory();
+			STARTUPINFO startupInfo{ 0 };
+			Boring32::Async::Process process(
+				directory + L"\\TestProcess.exe",
+				L"TestProcess.exe 6 " + arguments,
+				directory,
+				inheritHandles,
+				CREATE_NO_WINDOW,
+				startupInfo
+			);
+			process.Start();
+			job.AssignProcessToThisJob(process.GetProcessHandle());
+			return process;
+		}
+
+		// One connection to an echoing TestProcess peer
+		class Peer
+		{
+			public:
+				virtual ~Peer() = default;
+				virtual void Send(const std::wstring& msg) = 0;
+				// Waits for the next echo and returns its size in bytes
+				virtual size_t Receive() = 0;
+				// Returns how many bytes can be sent ahead of their echoes,
+				// or 0 if only one message can be in flight
+				virtual size_t GetWindowBytes() const noexcept { return StreamWindowBytes; }
+		};
+
+		class AnonymousPipePeer : public Peer
+		{
+			public:
+				AnonymousPipePeer(Boring32::Async::Job& job)
+				:	m_toPeer(true, PipeSize, L"||"),
+					m_fromPeer(true, PipeSize, L"||"),
+					m_reader(m_fromPeer)
+				{
+					m_process = StartPeer(
+						job,
+						L"anon "
+							+ std::to_wstring((UINT64)(UINT_PTR)m_toPeer.GetRead())
+							+ L" "
+							+ std::to_wstring((UINT64)(UINT_PTR)m_fromPeer.GetWrite()),
+						true
+					);
+				}
+
+				void Send(const std::wstring& msg) override
+				{
+					m_toPeer.DelimitedWrite(msg);
+				}
+
+				size_t Receive() override
+				{
+					std::wstring_view msg;
+					if (m_reader.Next(msg) == false)
+						throw std::runtime_error("AnonymousPipePeer: the peer closed the pipe");
+					return msg.size() * sizeof(wchar_t);
+				}
+
+			private:
+				Boring32::Async::AnonymousPipe m_toPeer;
+				Boring32::Async::AnonymousPipe m_fromPeer;
+				Boring32::Async::DelimitedStreamReader m_reader;
+				Boring32::Async::Process m_process;
+		};
+
+		class BlockingPipePeer : public Peer
+		{
+			public:
+				BlockingPipePeer(Boring32::Async::Job& job)
+				:	m_name(UniqueName()),
+					m_pipe(m_name, PipeSize, 1, L"", false, true)
+				{
+					m_process = StartPeer(job, L"blocking " + m_name, false);
+					m_pipe.Connect();
+				}
+
+				void Send(const std::wstring& msg) override
+				{
+					m_pipe.Write(msg);
+				}
+
+				size_t Receive() override
+				{
+					return m_pipe.Read().size() * sizeof(wchar_t);
+				}
+
+			private:
+				std::wstring m_name;
+				Boring32::Async::BlockingNamedPipeServer m_pipe;
+				Boring32::Async::Process m_process;
+		};
+
+		class OverlappedPipePeer : public Peer
+		{
+			public:
+				OverlappedPipePeer(Boring32::Async::Job& job)
+				:	m_name(UniqueName()),
+					m_pipe(m_name, PipeSize, 1, L"", false, true)
+				{
+					Boring32::Async::OverlappedOp connectOp;
+					m_pipe.Connect(connectOp);
+					m_process = StartPeer(job, L"overlapped " + m_name, false);
+					if (connectOp.LastError() != ERROR_PIPE_CONNECTED)
+						connectOp.WaitForCompletion(INFINITE);
+				}
+
+				void Send(const std::wstring& msg) override
+				{
+					Boring32::Async::OverlappedIo writeOp;
+					m_pipe.Write(msg, writeOp);
+					writeOp.WaitForCompletion(INFINITE);
+				}
+
+				size_t Receive() override
+				{
+					Boring32::Async::OverlappedIo readOp;
+					m_pipe.Read(64 * 1024, readOp);
+					readOp.WaitForCompletion(INFINITE);
+					if (readOp.IsSuccessful() == false)
+						throw std::runtime_error("OverlappedPipePeer: read failed");
+					return readOp.GetBytesTransferred();
+				}
+
+			private:
+				std::wstring m_name;
+				Boring32::Async::OverlappedNamedPipeServer m_pipe;
+				Boring32::Async::Process m_process;
+		};
+
+		// Exchanges messages through a shared section, signalling each
+		// direction with a named Event
+		class MemoryMappedFilePeer : public Peer
+		{
+			public:
+				MemoryMappedFilePeer(Boring32::Async::Job& job)
+				:	m_name(UniqueName()),
+					m_shared(m_name, SharedMemorySize, false),
+					m_request(false, false, false, m_name + L".Request"),
+					m_response(false, false, false, m_name + L".Response")
+				{
+					m_process = StartPeer(
+						job,
+						L"mmf " + m_name + L" " + std::to_wstring(SharedMemorySize),
+						false
+					);
+				}
+
+				void Send(const std::wstring& msg) override
+				{
+					std::byte* view = static_cast<std::byte*>(m_shared.GetViewPointer());
+					const UINT32 length = (UINT32)(msg.size() * sizeof(wchar_t));
+					memcpy(view, &length, sizeof(length));
+					memcpy(view + SharedMemoryDataOffset, msg.data(), length);
+					m_request.Signal();
+				}
+
+				size_t Receive() override
+				{
+					m_response.WaitOnEvent();
+					const std::byte* view = static_cast<std::byte*>(m_shared.GetViewPointer());
+					UINT32 length = 0;
+					memcpy(&length, view, sizeof(length));
+					m_received.resize(length / sizeof(wchar_t));
+					memcpy(m_received.data(), view + SharedMemoryDataOffset, length);
+					return length;
+				}
+
+				size_t GetWindowBytes() const noexcept override
+				{
+					return 0;
+				}
+
+			private:
+				std::wstring m_name;
+				Boring32::Async::MemoryMappedFile m_shared;
+				Boring32::Async::Event m_request;
+				Boring32::Async::Event m_response;
+				Boring32::Async::Process m_process;
+				std::wstring m_received;
+		};
+
+		// Runs work for every peer on its own thread, rethrowing the first
+		// failure once all have finished
+		void RunOnPeers(
+			std::vector<std::unique_ptr<Peer>>& peers,
+			const std::function<void(Peer&, const size_t index)>& work
+		)
+		{
+			std::vector<std::exception_ptr> errors(peers.size());
+			std::vector<std::thread> threads;
+			for (size_t i = 0; i < peers.size(); i++)
+			{
+				threads.emplace_back(
+					[&peers, &work, &errors, i]()
+					{
+						try
+						{
+							work(*peers[i], i);
+						}
+						catch (...)
+						{
+							errors[i] = std::current_exception();
+						}
+					});
+			}
+			for (std::thread& thread : threads)
+				thread.join();
+			for (const std::exception_ptr& error : errors)
+			{
+				if (error != nullptr)
+					std::rethrow_exception(error);
+			}
+		}
+
+		std::wstring SizeLabel(const size_t size)
+		{
+			return size >= 1024
+				? std::to_wstring(size / 1024) + L"KB"
+				: std::to_wstring(size) + L"B";
+		}
+
+		template<typename TPeer>
+		void Measure(const std::wstring& transport, const size_t messageSize, const size_t concurrency)
+		{
+			const std::wstring name =
+				L"IPC " + transport + L" " + SizeLabel(messageSize) + L" x" + std::to_wstring(concurrency);
+			const std::wstring msg(messageSize / sizeof(wchar_t), L'x');
+			const int roundTrips = messageSize >= 64 * 1024 ? 2000 : 20000;
+			const int streamMessages = (int)(std::min)((size_t)200000, (size_t)256 * 1024 * 1024 / messageSize);
+
+			// The Job kills the peers once the measurement is done
+			Boring32::Async::Job job(false);
+			JOBOBJECT_EXTENDED_LIMIT_INFORMATION jeli{ 0 };
+			jeli.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+			job.SetInformation(jeli);
+
+			std::vector<std::unique_ptr<Peer>> peers;
+			for (size_t i = 0; i < concurrency; i++)
+				peers.push_back(std::make_unique<TPeer>(job));
+
+			LARGE_INTEGER frequency{ 0 };
+			QueryPerformanceFrequency(&frequency);
+			std::vector<std::vector<double>> latencies(concurrency);
+			Stopwatch stopwatch;
+			RunOnPeers(
+				peers,
+				[&](Peer& peer, const size_t index)
+				{
+					latencies[index].reserve(roundTrips);
+					for (int i = 0; i < roundTrips; i++)
+					{
+						LARGE_INTEGER start{ 0 };
+						LARGE_INTEGER end{ 0 };
+						QueryPerformanceCounter(&start);
+						peer.Send(msg);
+						peer.Receive();
+						QueryPerformanceCounter(&end);
+						latencies[index].push_back(
+							static_cast<double>(end.QuadPart - start.QuadPart) * 1e6 / frequency.QuadPart
+						);
+					}
+				});
+			double elapsed = stopwatch.ElapsedSeconds();
+
+			std::vector<double> all;
+			for (const std::vector<double>& peerLatencies : latencies)
+				all.insert(all.end(), peerLatencies.begin(), peerLatencies.end());
+			std::sort(all.begin(), all.end());
+			Report(name, L"round trip p50", all[all.size() / 2], L"us");
+			Report(name, L"round trip p99", all[all.size() * 99 / 100], L"us");
+			Report(name, L"round trip p99.9", all[all.size() * 999 / 1000], L"us");
+			Report(name, L"round trips", all.size() / elapsed, L"ops/sec");
+
+			// Streaming sends ahead of the echoes, up to each peer's window
+			stopwatch.Restart();
+			RunOnPeers(
+				peers,
+				[&](Peer& peer, const size_t)
+				{
+					const int window = (int)(std::max)((size_t)1, peer.GetWindowBytes() / messageSize);
+					int sent = 0;
+					int received = 0;
+					while (received < streamMessages)
+					{
+						while (sent < streamMessages && sent - received < window)
+						{
+							peer.Send(msg);
+							sent++;
+						}
+						peer.Receive();
+						received++;
+					}
+				});
+			elapsed = stopwatch.ElapsedSeconds();
+			const double totalMessages = (double)streamMessages * concurrency;
+			Report(name, L"stream messages", totalMessages / elapsed, L"msgs/sec");
+			Report(name, L"stream throughput", totalMessages * messageSize / elapsed / (1024 * 1024), L"MB/s");
+		}
+
+		template<typename TPeer>
+		void MeasureTransport(const std::wstring& transport)
+		{
+			for (const size_t concurrency : { 1, 4 })
+			{
+				for (const size_t messageSize : { 64, 4 * 1024, 64 * 1024 })
+					Measure<TPeer>(transport, messageSize, concurrency);
+			}
+		}
+	}
+
+	// Uses TestProcess as an echo peer in a separate process. Each
+	// concurrent peer has its own process, connection and thread here.
+	void PipeIpcSuite()
+	{
+		MeasureTransport<AnonymousPipePeer>(L"AnonymousPipe");
+		MeasureTransport<BlockingPipePeer>(L"BlockingNamedPipe");
+		MeasureTransport<OverlappedPipePeer>(L"OverlappedNamedPipe");
+		MeasureTransport<MemoryMappedFilePeer>(L"MemoryMappedFile");
+	}
+}
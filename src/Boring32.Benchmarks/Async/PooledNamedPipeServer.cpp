@@ -0,0 +1,123 @@
+#include <Windows.h>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/Pipes/PooledNamedPipeServer.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		HANDLE ConnectClient(const std::wstring& pipeName)
+		{
+			while (true)
+			{
+				HANDLE pipe = CreateFileW(
+					pipeName.c_str(),
+					GENERIC_READ | GENERIC_WRITE,
+					0,
+					nullptr,
+					OPEN_EXISTING,
+					0,
+					nullptr
+				);
+				if (pipe != INVALID_HANDLE_VALUE)
+				{
+					DWORD mode = PIPE_READMODE_MESSAGE;
+					SetNamedPipeHandleState(pipe, &mode, nullptr, nullptr);
+					return pipe;
+				}
+				if (GetLastError() != ERROR_PIPE_BUSY)
+					return nullptr;
+				WaitNamedPipeW(pipeName.c_str(), 1000);
+			}
+		}
+	}
+
+	// Connects 1000 clients from 8 threads, then has every client make
+	// echo round trips while all of them stay connected.
+	void PooledNamedPipeServerConcurrency()
+	{
+		constexpr int clientCount = 1000;
+		constexpr int threadCount = 8;
+		constexpr int roundsPerClient = 100;
+		const std::wstring pipeName =
+			L"\\\\.\\pipe\\Boring32.Benchmarks.PooledNamedPipeServer." + std::to_wstring(GetCurrentProcessId());
+
+		Boring32::Async::PooledNamedPipeServer server(
+			pipeName,
+			Boring32::Async::PooledNamedPipeServerSettings{ .PendingInstances = 16 },
+			Boring32::Async::PipeSessionHandlers{
+				.OnMessage = [](const std::shared_ptr<Boring32::Async::PipeSession>& session, const std::span<const std::byte> message)
+				{
+					session->Write(message);
+				}
+			}
+		);
+
+		std::vector<HANDLE> clients(clientCount);
+		Stopwatch stopwatch;
+		std::vector<std::thread> threads;
+		for (int t = 0; t < threadCount; t++)
+		{
+			threads.emplace_back(
+				[&clients, &pipeName, t]()
+				{
+					for (int i = t; i < clientCount; i += threadCount)
+						clients[i] = ConnectClient(pipeName);
+				});
+		}
+		for (std::thread& thread : threads)
+			thread.join();
+		Report(L"PooledNamedPipeServer", L"connects", clientCount / stopwatch.ElapsedSeconds(), L"connects/sec");
+		if (std::count(clients.begin(), clients.end(), nullptr) > 0)
+		{
+			Report(L"PooledNamedPipeServer", L"failed connects", (double)std::count(clients.begin(), clients.end(), nullptr), L"clients");
+			return;
+		}
+
+		LARGE_INTEGER frequency{ 0 };
+		QueryPerformanceFrequency(&frequency);
+		std::vector<std::vector<double>> latencies(threadCount);
+		threads.clear();
+		stopwatch.Restart();
+		for (int t = 0; t < threadCount; t++)
+		{
+			threads.emplace_back(
+				[&clients, &latencies, &frequency, t]()
+				{
+					char request[64] = "ping";
+					char response[64];
+					for (int round = 0; round < roundsPerClient; round++)
+					{
+						for (int i = t; i < clientCount; i += threadCount)
+						{
+							LARGE_INTEGER start{ 0 };
+							LARGE_INTEGER end{ 0 };
+							DWORD bytesRead = 0;
+							QueryPerformanceCounter(&start);
+							TransactNamedPipe(clients[i], request, sizeof(request), response, sizeof(response), &bytesRead, nullptr);
+							QueryPerformanceCounter(&end);
+							latencies[t].push_back(static_cast<double>(end.QuadPart - start.QuadPart) * 1e6 / frequency.QuadPart);
+						}
+					}
+				});
+		}
+		for (std::thread& thread : threads)
+			thread.join();
+		const double elapsed = stopwatch.ElapsedSeconds();
+
+		std::vector<double> all;
+		for (const std::vector<double>& threadLatencies : latencies)
+			all.insert(all.end(), threadLatencies.begin(), threadLatencies.end());
+		std::sort(all.begin(), all.end());
+		Report(L"PooledNamedPipeServer", L"round trips", all.size() / elapsed, L"msgs/sec");
+		Report(L"PooledNamedPipeServer", L"round trip p50", all[all.size() / 2], L"us");
+		Report(L"PooledNamedPipeServer", L"round trip p99", all[all.size() * 99 / 100], L"us");
+		Report(L"PooledNamedPipeServer", L"instances", (double)server.GetInstanceCount(), L"instances");
+
+		for (HANDLE client : clients)
+			CloseHandle(client);
+	}
+}
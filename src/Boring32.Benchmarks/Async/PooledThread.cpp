@@ -0,0 +1,66 @@
+#include <Windows.h>
+#include <vector>
+#include <algorithm>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/Thread.hpp"
+#include "../../Boring32/include/Async/PooledThread.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		LARGE_INTEGER g_ranAt{ 0 };
+
+		int StampAndReturn(void*)
+		{
+			QueryPerformanceCounter(&g_ranAt);
+			return 0;
+		}
+
+		// Starts and joins threads one at a time, recording the median
+		// time from calling Start() until the function begins executing.
+		template<typename TFactory>
+		void MeasureStarts(const std::wstring& name, TFactory createThread)
+		{
+			constexpr int iterations = 5000;
+			LARGE_INTEGER frequency{ 0 };
+			QueryPerformanceFrequency(&frequency);
+
+			std::vector<double> latencies;
+			latencies.reserve(iterations);
+			Stopwatch total;
+			for (int i = 0; i < iterations; i++)
+			{
+				auto thread = createThread();
+				LARGE_INTEGER startedAt{ 0 };
+				QueryPerformanceCounter(&startedAt);
+				thread.Start(StampAndReturn);
+				thread.Join(INFINITE);
+				latencies.push_back(
+					static_cast<double>(g_ranAt.QuadPart - startedAt.QuadPart) * 1e6 / frequency.QuadPart
+				);
+			}
+			const double elapsed = total.ElapsedSeconds();
+
+			std::sort(latencies.begin(), latencies.end());
+			Report(name, L"start-to-run p50", latencies[iterations / 2], L"us");
+			Report(name, L"start-to-run p99", latencies[iterations * 99 / 100], L"us");
+			Report(name, L"start+join throughput", iterations / elapsed, L"threads/sec");
+		}
+	}
+
+	void PooledThreadStart()
+	{
+		MeasureStarts(
+			L"Thread",
+			[]() { return Boring32::Async::Thread(); }
+		);
+
+		Boring32::Async::ThreadCache cache(16, INFINITE);
+		cache.Prespawn(1);
+		MeasureStarts(
+			L"PooledThread",
+			[&cache]() { return Boring32::Async::PooledThread(cache); }
+		);
+	}
+}
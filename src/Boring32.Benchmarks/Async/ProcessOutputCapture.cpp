@@ -0,0 +1,42 @@
+#include <Windows.h>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/Process.hpp"
+#include "../../Boring32/include/Async/ProcessOutputCapture.hpp"
+#include "../../Boring32/include/Util/Util.hpp"
+
+#pragma comment(lib, "Pathcch.lib")
+
+namespace Benchmarks
+{
+	// Captures 512MB of 100 byte lines written by TestProcess.
+	void ProcessOutputCaptureThroughput()
+	{
+		constexpr int megabytes = 512;
+		const std::wstring directory = Boring32::Util::GetCurrentExecutableDirectory();
+
+		Boring32::Async::ProcessOutputCapture capture;
+		Boring32::Async::Process process(
+			directory + L"\\TestProcess.exe",
+			L"TestProcess.exe 5 " + std::to_wstring(megabytes),
+			directory,
+			true,
+			CREATE_NO_WINDOW,
+			capture.GetStartupInfo()
+		);
+
+		Stopwatch stopwatch;
+		process.Start();
+		capture.Start();
+		UINT64 lines = 0;
+		capture.Run(
+			[&lines](const Boring32::Async::OutputStream, const std::string_view line)
+			{
+				lines++;
+			});
+		const double elapsed = stopwatch.ElapsedSeconds();
+
+		const UINT64 totalBytes = capture.GetBytesRead(Boring32::Async::OutputStream::StdOut);
+		Report(L"ProcessOutputCapture", L"throughput", totalBytes / elapsed / (1024 * 1024), L"MB/s");
+		Report(L"ProcessOutputCapture", L"lines", lines / elapsed, L"lines/sec");
+	}
+}
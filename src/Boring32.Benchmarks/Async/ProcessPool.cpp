@@ -0,0 +1,91 @@
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>
+#include <climits>
+#include <stdexcept>
+#endif
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/ProcessPool.hpp"
+#ifdef _WIN32
+#include "../../Boring32/include/Util/Util.hpp"
+
+#pragma comment(lib, "Pathcch.lib")
+#else
+#include "../../Boring32/include/Async/ProcessPoolWorker.hpp"
+#endif
+
+namespace Benchmarks
+{
+	namespace
+	{
+		void MeasureJobs(const std::wstring& name, Boring32::Async::ProcessPool& pool, const int jobs)
+		{
+			const std::wstring request = L"ping";
+			Stopwatch stopwatch;
+			for (int i = 0; i < jobs; i++)
+				pool.Submit(request, 10000);
+			const double elapsed = stopwatch.ElapsedSeconds();
+			Report(name, L"throughput", jobs / elapsed, L"jobs/sec");
+			Report(name, L"mean latency", elapsed * 1e6 / jobs, L"us");
+		}
+	}
+
+#ifdef _WIN32
+	// Uses TestProcess in echo worker mode. Recycling the worker after every
+	// job makes each job pay for a full process start, which gives the cold
+	// start baseline.
+	void ProcessPoolThroughput()
+	{
+		const std::wstring directory = Boring32::Util::GetCurrentExecutableDirectory();
+		const std::wstring filePath = directory + L"\\TestProcess.exe";
+		const std::wstring commandLine = L"TestProcess.exe 4";
+
+		Boring32::Async::ProcessPool cold(
+			filePath,
+			commandLine,
+			directory,
+			1,
+			1,
+			CREATE_NO_WINDOW,
+			JOBOBJECT_EXTENDED_LIMIT_INFORMATION{ 0 }
+		);
+		MeasureJobs(L"ProcessPool (cold start)", cold, 200);
+
+		Boring32::Async::ProcessPool warm(
+			filePath,
+			commandLine,
+			directory,
+			1,
+			0,
+			CREATE_NO_WINDOW,
+			JOBOBJECT_EXTENDED_LIMIT_INFORMATION{ 0 }
+		);
+		MeasureJobs(L"ProcessPool (warm)", warm, 20000);
+	}
+#else
+	// TestProcess is Windows-only, so on Linux the benchmark driver is its
+	// own echo worker; see ProcessPoolWorkerMain()
+	void ProcessPoolThroughput()
+	{
+		char path[PATH_MAX + 1]{ 0 };
+		if (readlink("/proc/self/exe", path, PATH_MAX) == -1)
+			throw std::runtime_error("ProcessPoolThroughput(): readlink() failed");
+		const std::string narrowPath = path;
+		const std::wstring filePath(narrowPath.begin(), narrowPath.end());
+		const std::wstring commandLine = L"Boring32.Benchmarks " + std::wstring(ProcessPoolWorkerArgument);
+
+		Boring32::Async::ProcessPool cold(filePath, commandLine, L"", 1, 1);
+		MeasureJobs(L"ProcessPool (cold start)", cold, 200);
+
+		Boring32::Async::ProcessPool warm(filePath, commandLine, L"", 1, 0);
+		MeasureJobs(L"ProcessPool (warm)", warm, 20000);
+	}
+
+	void ProcessPoolWorkerMain(const std::wstring& channelPath)
+	{
+		Boring32::Async::ProcessPoolWorker worker(channelPath);
+		worker.Run([](const std::wstring& request) { return request; });
+	}
+#endif
+}
@@ -0,0 +1,47 @@
+#include <Windows.h>
+#include <vector>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/AsyncFuncs.hpp"
+#include "../../Boring32/include/Async/ProcessSnapshot.hpp"
+
+namespace Benchmarks
+{
+	// Compares a scan per lookup with refreshing an indexed snapshot, for a
+	// watchdog that checks on 50 processes at a time.
+	void ProcessSnapshotLookup()
+	{
+		constexpr int rounds = 20;
+		std::vector<std::wstring> names;
+		names.push_back(L"explorer.exe");
+		names.push_back(L"svchost.exe");
+		for (int i = 0; i < 48; i++)
+			names.push_back(L"missing-" + std::to_wstring(i) + L".exe");
+
+		Stopwatch stopwatch;
+		for (int round = 0; round < rounds; round++)
+		{
+			for (const std::wstring& name : names)
+			{
+				DWORD processId = 0;
+				Boring32::Async::GetProcessIdByName(name, 0, processId);
+			}
+		}
+		const double scanElapsed = stopwatch.ElapsedSeconds();
+		Report(L"GetProcessIdByName", L"50 lookups", scanElapsed * 1e3 / rounds, L"ms");
+
+		Boring32::Async::ProcessSnapshot snapshot;
+		stopwatch.Restart();
+		for (int round = 0; round < rounds; round++)
+		{
+			snapshot.Refresh();
+			snapshot.FindByNames(names);
+		}
+		const double snapshotElapsed = stopwatch.ElapsedSeconds();
+		Report(L"ProcessSnapshot", L"refresh + 50 lookups", snapshotElapsed * 1e3 / rounds, L"ms");
+
+		stopwatch.Restart();
+		for (int round = 0; round < rounds * 100; round++)
+			snapshot.FindByNames(names);
+		Report(L"ProcessSnapshot", L"50 lookups", stopwatch.ElapsedSeconds() * 1e3 / (rounds * 100), L"ms");
+	}
+}
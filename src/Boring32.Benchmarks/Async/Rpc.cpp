@@ -0,0 +1,172 @@
+#include <Windows.h>
+#include <vector>
+#include <span>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/Pipes/OverlappedNamedPipeServer.hpp"
+#include "../../Boring32/include/Async/Pipes/OverlappedNamedPipeClient.hpp"
+#include "../../Boring32/include/Async/Pipes/RpcClient.hpp"
+#include "../../Boring32/include/Async/Pipes/RpcServer.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr int TotalCalls = 200000;
+		constexpr size_t PayloadSize = 64;
+
+		// A blocking message-mode pipe pair, as the baseline transport
+		struct PipePair
+		{
+			PipePair(const std::wstring& name, const DWORD instances)
+			{
+				Server = CreateNamedPipeW(
+					name.c_str(),
+					PIPE_ACCESS_DUPLEX,
+					PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT,
+					instances,
+					64 * 1024,
+					64 * 1024,
+					0,
+					nullptr
+				);
+				Client = CreateFileW(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+				DWORD mode = PIPE_READMODE_MESSAGE;
+				SetNamedPipeHandleState(Client, &mode, nullptr, nullptr);
+				// Echoes each message until the client closes its end
+				Echo = std::thread(
+					[this]()
+					{
+						std::vector<std::byte> buffer(64 * 1024);
+						DWORD bytesRead = 0;
+						DWORD bytesWritten = 0;
+						while (ReadFile(Server, buffer.data(), (DWORD)buffer.size(), &bytesRead, nullptr))
+							WriteFile(Server, buffer.data(), bytesRead, &bytesWritten, nullptr);
+					});
+			}
+
+			~PipePair()
+			{
+				CloseHandle(Client);
+				Echo.join();
+				CloseHandle(Server);
+			}
+
+			void Call(const std::span<const std::byte> request, std::vector<std::byte>& response)
+			{
+				DWORD bytesWritten = 0;
+				DWORD bytesRead = 0;
+				WriteFile(Client, request.data(), (DWORD)request.size(), &bytesWritten, nullptr);
+				ReadFile(Client, response.data(), (DWORD)response.size(), &bytesRead, nullptr);
+			}
+
+			HANDLE Server;
+			HANDLE Client;
+			std::thread Echo;
+		};
+
+		std::wstring MakePipeName(const std::wstring& name)
+		{
+			return L"\\\\.\\pipe\\Boring32.Benchmarks.Rpc."
+				+ name
+				+ L"."
+				+ std::to_wstring(GetCurrentProcessId());
+		}
+
+		// Splits TotalCalls across callerCount threads and reports the
+		// rate at which they complete.
+		template<typename TCall>
+		void RunCallers(const std::wstring& name, const int callerCount, const TCall& call)
+		{
+			const int callsPerCaller = TotalCalls / callerCount;
+			std::vector<std::thread> callers;
+			Stopwatch stopwatch;
+			for (int i = 0; i < callerCount; i++)
+			{
+				callers.emplace_back(
+					[&call, i, callsPerCaller]()
+					{
+						for (int j = 0; j < callsPerCaller; j++)
+							call(i);
+					});
+			}
+			for (std::thread& caller : callers)
+				caller.join();
+			const double elapsed = stopwatch.ElapsedSeconds();
+			Report(name, L"calls", callsPerCaller * callerCount / elapsed, L"calls/sec");
+		}
+
+		void MeasureRpc(const int callerCount)
+		{
+			const std::wstring pipeName = L"Boring32.Benchmarks.Rpc." + std::to_wstring(GetCurrentProcessId());
+			Boring32::Async::OverlappedNamedPipeServer serverPipe(pipeName, 64 * 1024, 1, L"", false, true);
+			Boring32::Async::OverlappedNamedPipeClient clientPipe(pipeName);
+			Boring32::Async::OverlappedOp connectOp;
+			serverPipe.Connect(connectOp);
+			clientPipe.Connect(0);
+			if (connectOp.LastError() != ERROR_PIPE_CONNECTED)
+				connectOp.WaitForCompletion(INFINITE);
+
+			Boring32::Async::RpcServer server(
+				serverPipe,
+				[](const UINT32, const std::span<const std::byte> request)
+				{
+					return std::vector<std::byte>(request.begin(), request.end());
+				});
+			Boring32::Async::RpcClient client(clientPipe);
+			const std::vector<std::byte> payload(PayloadSize, std::byte{ 0x42 });
+			RunCallers(
+				L"RpcClient x" + std::to_wstring(callerCount),
+				callerCount,
+				[&client, &payload](const int)
+				{
+					client.Call(1, payload).Result.get();
+				});
+		}
+
+		void MeasureSharedPipe(const int callerCount)
+		{
+			PipePair pair(MakePipeName(L"Shared"), 1);
+			std::mutex mutex;
+			const std::vector<std::byte> payload(PayloadSize, std::byte{ 0x42 });
+			RunCallers(
+				L"Shared pipe x" + std::to_wstring(callerCount),
+				callerCount,
+				[&pair, &mutex, &payload](const int)
+				{
+					std::vector<std::byte> response(PayloadSize);
+					std::scoped_lock lock(mutex);
+					pair.Call(payload, response);
+				});
+		}
+
+		void MeasurePipePerCaller(const int callerCount)
+		{
+			const std::wstring name = MakePipeName(L"PerCaller");
+			std::vector<std::unique_ptr<PipePair>> pairs;
+			for (int i = 0; i < callerCount; i++)
+				pairs.push_back(std::make_unique<PipePair>(name, PIPE_UNLIMITED_INSTANCES));
+			const std::vector<std::byte> payload(PayloadSize, std::byte{ 0x42 });
+			RunCallers(
+				L"Pipe per caller x" + std::to_wstring(callerCount),
+				callerCount,
+				[&pairs, &payload](const int caller)
+				{
+					std::vector<std::byte> response(PayloadSize);
+					pairs[caller]->Call(payload, response);
+				});
+		}
+	}
+
+	void RpcMultiplexing()
+	{
+		for (const int callerCount : { 1, 16, 256 })
+		{
+			MeasureRpc(callerCount);
+			MeasureSharedPipe(callerCount);
+			MeasurePipePerCaller(callerCount);
+		}
+	}
+}
@@ -0,0 +1,143 @@
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <memory_resource>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/SharedHeap.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr UINT HeapSize = 1024 * 1024 * 1024;
+		constexpr int OperationsPerThread = 2000000;
+		constexpr size_t LiveBlocks = 4096;
+
+		std::wstring UniqueName()
+		{
+			static int counter = 0;
+			return L"Boring32.Benchmarks.SharedHeap."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ L"."
+				+ std::to_wstring(counter++);
+		}
+
+		// Replaces a random live block with a new one of a random size
+		// between 16 and 1024 bytes on every operation, so the allocator
+		// sees a steady mix of allocations and frees
+		template<typename TAllocate, typename TFree>
+		void Churn(const int seed, TAllocate&& allocate, TFree&& release)
+		{
+			std::mt19937 random(seed);
+			std::uniform_int_distribution<size_t> sizes(16, 1024);
+			std::uniform_int_distribution<size_t> slots(0, LiveBlocks - 1);
+			std::vector<std::pair<void*, size_t>> live(LiveBlocks, { nullptr, 0 });
+			for (int i = 0; i < OperationsPerThread; i++)
+			{
+				auto& slot = live[slots(random)];
+				if (slot.first)
+					release(slot.first, slot.second);
+				slot.second = sizes(random);
+				slot.first = allocate(slot.second);
+			}
+			for (auto& slot : live)
+				if (slot.first)
+					release(slot.first, slot.second);
+		}
+
+		template<typename TAllocate, typename TFree>
+		void Measure(const std::wstring& name, const int threadCount, TAllocate&& allocate, TFree&& release)
+		{
+			std::vector<std::thread> threads;
+			Stopwatch stopwatch;
+			for (int t = 0; t < threadCount; t++)
+				threads.emplace_back([t, &allocate, &release]() { Churn(t, allocate, release); });
+			for (std::thread& thread : threads)
+				thread.join();
+			Report(
+				name + L" " + std::to_wstring(threadCount) + L" threads",
+				L"operations",
+				threadCount * OperationsPerThread / stopwatch.ElapsedSeconds(),
+				L"ops/sec"
+			);
+		}
+
+		void MeasureThroughput(const int threadCount)
+		{
+			Boring32::Async::SharedHeap heap(UniqueName(), HeapSize, true);
+			Measure(
+				L"SharedHeap",
+				threadCount,
+				[&heap](const size_t size) { return heap.GetPointer(heap.Allocate(size)); },
+				[&heap](void* pointer, const size_t size) { heap.Deallocate(heap.GetOffset(pointer), size); }
+			);
+			Measure(
+				L"malloc",
+				threadCount,
+				[](const size_t size) { return std::malloc(size); },
+				[](void* pointer, const size_t) { std::free(pointer); }
+			);
+			std::pmr::synchronized_pool_resource pool;
+			Measure(
+				L"synchronized_pool_resource",
+				threadCount,
+				[&pool](const size_t size) { return pool.allocate(size); },
+				[&pool](void* pointer, const size_t size) { pool.deallocate(pointer, size); }
+			);
+		}
+
+		void MeasureFragmentation()
+		{
+			Boring32::Async::SharedHeap heap(UniqueName(), HeapSize, true);
+			size_t requested = 0;
+			size_t peakRequested = 0;
+			Churn(
+				0,
+				[&](const size_t size)
+				{
+					requested += size;
+					peakRequested = (std::max)(peakRequested, requested);
+					return heap.GetPointer(heap.Allocate(size));
+				},
+				[&](void* pointer, const size_t size)
+				{
+					requested -= size;
+					heap.Deallocate(heap.GetOffset(pointer), size);
+				}
+			);
+
+			// Internal fragmentation is measured with a working set live
+			std::mt19937 random(1);
+			std::uniform_int_distribution<size_t> sizes(16, 1024);
+			size_t liveRequested = 0;
+			size_t liveBlocks = 0;
+			for (size_t i = 0; i < LiveBlocks; i++)
+			{
+				const size_t size = sizes(random);
+				liveRequested += size;
+				liveBlocks += Boring32::Async::SharedHeap::GetBlockSize(size, alignof(std::max_align_t));
+				heap.Allocate(size);
+			}
+			Report(L"SharedHeap fragmentation", L"internal", 100.0 * (liveBlocks - liveRequested) / liveBlocks, L"%");
+			Report(L"SharedHeap fragmentation", L"peak live bytes", static_cast<double>(peakRequested), L"bytes");
+			Report(L"SharedHeap fragmentation", L"reserved bytes", static_cast<double>(heap.GetReservedBytes()), L"bytes");
+			Report(
+				L"SharedHeap fragmentation",
+				L"reserved per peak live byte",
+				static_cast<double>(heap.GetReservedBytes()) / peakRequested,
+				L"x"
+			);
+		}
+	}
+
+	void SharedHeapAllocation()
+	{
+		MeasureThroughput(1);
+		MeasureThroughput(4);
+		MeasureFragmentation();
+	}
+}
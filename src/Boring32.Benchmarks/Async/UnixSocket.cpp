@@ -0,0 +1,241 @@
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <span>
+#include <thread>
+#include <algorithm>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/Pipes/UnixSocketServer.hpp"
+#include "../../Boring32/include/Async/Pipes/UnixSocketClient.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		constexpr int RoundTrips = 50000;
+
+#ifdef _WIN32
+		// A duplex message-mode pipe pair, used blocking, as the baseline
+		struct PipePair
+		{
+			PipePair()
+			{
+				const std::wstring name =
+					L"\\\\.\\pipe\\Boring32.Benchmarks.UnixSocket." + std::to_wstring(GetCurrentProcessId());
+				Server = CreateNamedPipeW(
+					name.c_str(),
+					PIPE_ACCESS_DUPLEX,
+					PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT,
+					1,
+					1024 * 1024,
+					1024 * 1024,
+					0,
+					nullptr
+				);
+				Client = CreateFileW(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+				DWORD mode = PIPE_READMODE_MESSAGE;
+				SetNamedPipeHandleState(Client, &mode, nullptr, nullptr);
+			}
+
+			~PipePair()
+			{
+				CloseHandle(Client);
+				CloseHandle(Server);
+			}
+
+			void ServerWrite(const std::span<const std::byte> data)
+			{
+				DWORD bytesWritten = 0;
+				WriteFile(Server, data.data(), (DWORD)data.size(), &bytesWritten, nullptr);
+			}
+
+			void ClientWrite(const std::span<const std::byte> data)
+			{
+				DWORD bytesWritten = 0;
+				WriteFile(Client, data.data(), (DWORD)data.size(), &bytesWritten, nullptr);
+			}
+
+			size_t ServerRead()
+			{
+				DWORD bytesRead = 0;
+				ReadFile(Server, Buffer.data(), (DWORD)Buffer.size(), &bytesRead, nullptr);
+				return bytesRead;
+			}
+
+			size_t ClientRead()
+			{
+				DWORD bytesRead = 0;
+				ReadFile(Client, Buffer.data(), (DWORD)Buffer.size(), &bytesRead, nullptr);
+				return bytesRead;
+			}
+
+			HANDLE Server;
+			HANDLE Client;
+			std::vector<std::byte> Buffer = std::vector<std::byte>(1024 * 1024);
+		};
+#endif
+
+		struct SocketPair
+		{
+			SocketPair()
+			:	Server(MakePath(), 1),
+				Client(Server.GetPath())
+			{
+				Client.Connect();
+				Server.Connect();
+			}
+
+			static std::wstring MakePath()
+			{
+#ifdef _WIN32
+				wchar_t tempPath[MAX_PATH + 1]{ 0 };
+				GetTempPathW(MAX_PATH, tempPath);
+				return std::wstring(tempPath)
+					+ L"Boring32.Benchmarks."
+					+ std::to_wstring(GetCurrentProcessId())
+					+ L".sock";
+#else
+				return L"/tmp/Boring32.Benchmarks." + std::to_wstring(getpid()) + L".sock";
+#endif
+			}
+
+			void ServerWrite(const std::span<const std::byte> data) { Server.Write(data); }
+			void ClientWrite(const std::span<const std::byte> data) { Client.Write(data); }
+			size_t ServerRead() { return Server.ReadBytes().size(); }
+			size_t ClientRead() { return Client.ReadBytes().size(); }
+
+			Boring32::Async::UnixSocketServer Server;
+			Boring32::Async::UnixSocketClient Client;
+		};
+
+		// Bounces a message between the client and an echoing server
+		// thread, then streams messages one way.
+		template<typename TPair>
+		void Measure(const std::wstring& name, const size_t messageSize, const int messageCount)
+		{
+			TPair pair;
+			const std::vector<std::byte> payload(messageSize, std::byte{ 0x42 });
+
+			std::thread echo(
+				[&pair, &payload]()
+				{
+					for (int i = 0; i < RoundTrips; i++)
+					{
+						pair.ServerRead();
+						pair.ServerWrite(payload);
+					}
+				});
+			std::vector<double> latencies;
+			latencies.reserve(RoundTrips);
+			for (int i = 0; i < RoundTrips; i++)
+			{
+				const Stopwatch roundTrip;
+				pair.ClientWrite(payload);
+				pair.ClientRead();
+				latencies.push_back(roundTrip.ElapsedSeconds() * 1e6);
+			}
+			echo.join();
+			std::sort(latencies.begin(), latencies.end());
+			Report(name, L"round trip p50", latencies[RoundTrips / 2], L"us");
+			Report(name, L"round trip p99", latencies[RoundTrips * 99 / 100], L"us");
+
+			Stopwatch stopwatch;
+			std::thread sender(
+				[&pair, &payload, messageCount]()
+				{
+					for (int i = 0; i < messageCount; i++)
+						pair.ClientWrite(payload);
+				});
+			std::uint64_t bytesReceived = 0;
+			for (int i = 0; i < messageCount; i++)
+				bytesReceived += pair.ServerRead();
+			const double elapsed = stopwatch.ElapsedSeconds();
+			sender.join();
+			Report(name, L"messages", messageCount / elapsed, L"msgs/sec");
+			Report(name, L"throughput", bytesReceived / elapsed / (1024 * 1024), L"MB/s");
+		}
+
+		// Streams header + payload + trailer messages one way. They are
+		// either concatenated into a new buffer, sent with Write() and
+		// split back apart after ReadBytes(), or sent with WriteGather()
+		// and received straight into the three parts with ReadScatter().
+		void MeasureGather(const std::wstring& name, const bool gather, const size_t payloadSize, const int messageCount)
+		{
+			SocketPair pair;
+			const std::vector<std::byte> header(16, std::byte{ 0x01 });
+			const std::vector<std::byte> payload(payloadSize, std::byte{ 0x42 });
+			const std::vector<std::byte> trailer(8, std::byte{ 0x02 });
+
+			Stopwatch stopwatch;
+			std::thread sender(
+				[&pair, &header, &payload, &trailer, gather, messageCount]()
+				{
+					for (int i = 0; i < messageCount; i++)
+					{
+						if (gather)
+						{
+							const std::span<const std::byte> pieces[] = { header, payload, trailer };
+							pair.Client.WriteGather(pieces);
+							continue;
+						}
+						std::vector<std::byte> message;
+						message.reserve(header.size() + payload.size() + trailer.size());
+						message.insert(message.end(), header.begin(), header.end());
+						message.insert(message.end(), payload.begin(), payload.end());
+						message.insert(message.end(), trailer.begin(), trailer.end());
+						pair.Client.Write(message);
+					}
+				});
+
+			std::vector<std::byte> headerIn(header.size());
+			std::vector<std::byte> payloadIn(payload.size());
+			std::vector<std::byte> trailerIn(trailer.size());
+			std::uint64_t bytesReceived = 0;
+			for (int i = 0; i < messageCount; i++)
+			{
+				if (gather)
+				{
+					const std::span<std::byte> pieces[] = { headerIn, payloadIn, trailerIn };
+					bytesReceived += pair.Server.ReadScatter(pieces);
+					continue;
+				}
+				const std::vector<std::byte> message = pair.Server.ReadBytes();
+				const std::byte* next = message.data();
+				std::copy_n(next, headerIn.size(), headerIn.begin());
+				next += headerIn.size();
+				std::copy_n(next, payloadIn.size(), payloadIn.begin());
+				next += payloadIn.size();
+				std::copy_n(next, trailerIn.size(), trailerIn.begin());
+				bytesReceived += message.size();
+			}
+			const double elapsed = stopwatch.ElapsedSeconds();
+			sender.join();
+			Report(name, L"messages", messageCount / elapsed, L"msgs/sec");
+			Report(name, L"throughput", bytesReceived / elapsed / (1024 * 1024), L"MB/s");
+		}
+	}
+
+	void UnixSocketThroughput()
+	{
+		// Named pipes are the baseline on Windows. On Linux this measures
+		// the SOCK_SEQPACKET backend alone.
+#ifdef _WIN32
+		Measure<PipePair>(L"Named pipe 64B", 64, 500000);
+#endif
+		Measure<SocketPair>(L"UnixSocket 64B", 64, 500000);
+#ifdef _WIN32
+		Measure<PipePair>(L"Named pipe 64KB", 64 * 1024, 20000);
+#endif
+		Measure<SocketPair>(L"UnixSocket 64KB", 64 * 1024, 20000);
+
+		MeasureGather(L"UnixSocket concatenate 64B", false, 64, 500000);
+		MeasureGather(L"UnixSocket gather 64B", true, 64, 500000);
+		MeasureGather(L"UnixSocket concatenate 64KB", false, 64 * 1024, 20000);
+		MeasureGather(L"UnixSocket gather 64KB", true, 64 * 1024, 20000);
+	}
+}
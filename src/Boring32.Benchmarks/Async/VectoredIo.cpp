@@ -0,0 +1,117 @@
+#include <Windows.h>
+#include <vector>
+#include <span>
+#include <thread>
+#include "../Benchmarks.hpp"
+#include "../../Boring32/include/Async/VectoredIo.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		struct PipePair
+		{
+			~PipePair()
+			{
+				if (Server != INVALID_HANDLE_VALUE)
+					CloseHandle(Server);
+				if (Client != INVALID_HANDLE_VALUE)
+					CloseHandle(Client);
+			}
+
+			HANDLE Server = INVALID_HANDLE_VALUE;
+			HANDLE Client = INVALID_HANDLE_VALUE;
+		};
+
+		void CreatePipes(PipePair& pipes, const bool messageMode)
+		{
+			const std::wstring name =
+				L"\\\\.\\pipe\\Boring32.Benchmarks.VectoredIo." + std::to_wstring(GetCurrentProcessId());
+			const DWORD mode = messageMode
+				? PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE
+				: PIPE_TYPE_BYTE | PIPE_READMODE_BYTE;
+			pipes.Server = CreateNamedPipeW(name.c_str(), PIPE_ACCESS_INBOUND, mode | PIPE_WAIT, 1, 0, 1024 * 1024, 0, nullptr);
+			pipes.Client = CreateFileW(name.c_str(), GENERIC_WRITE | FILE_READ_ATTRIBUTES, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+		}
+
+		enum class WriteMethod
+		{
+			Concatenate,
+			Gather,
+			// Gathers with the handle's traits queried once up front
+			GatherCachedTraits
+		};
+
+		// Writes header + payload + trailer messageCount times, either by
+		// concatenating them into a new buffer or by gathering them, while
+		// a thread drains the pipe.
+		double Measure(const bool messageMode, const WriteMethod method, const size_t payloadSize, const int messageCount)
+		{
+			PipePair pipes;
+			CreatePipes(pipes, messageMode);
+
+			std::thread reader(
+				[&pipes]()
+				{
+					std::vector<std::byte> buffer(1024 * 1024);
+					DWORD bytesRead = 0;
+					while (ReadFile(pipes.Server, buffer.data(), (DWORD)buffer.size(), &bytesRead, nullptr)
+						|| GetLastError() == ERROR_MORE_DATA);
+				}
+			);
+
+			const std::vector<std::byte> header(16, std::byte{ 0x01 });
+			const std::vector<std::byte> payload(payloadSize, std::byte{ 0x42 });
+			const std::vector<std::byte> trailer(8, std::byte{ 0x02 });
+
+			Stopwatch stopwatch;
+			const Boring32::Async::VectoredIoTraits traits = Boring32::Async::GetVectoredIoTraits(pipes.Client);
+			for (int i = 0; i < messageCount; i++)
+			{
+				if (method == WriteMethod::Gather)
+				{
+					const std::span<const std::byte> pieces[] = { header, payload, trailer };
+					Boring32::Async::WriteGather(pipes.Client, pieces);
+					continue;
+				}
+				if (method == WriteMethod::GatherCachedTraits)
+				{
+					const std::span<const std::byte> pieces[] = { header, payload, trailer };
+					Boring32::Async::WriteGather(pipes.Client, traits, pieces);
+					continue;
+				}
+				std::vector<std::byte> message;
+				message.reserve(header.size() + payload.size() + trailer.size());
+				message.insert(message.end(), header.begin(), header.end());
+				message.insert(message.end(), payload.begin(), payload.end());
+				message.insert(message.end(), trailer.begin(), trailer.end());
+				DWORD bytesWritten = 0;
+				WriteFile(pipes.Client, message.data(), (DWORD)message.size(), &bytesWritten, nullptr);
+			}
+			CloseHandle(pipes.Client);
+			pipes.Client = INVALID_HANDLE_VALUE;
+			reader.join();
+			return messageCount / stopwatch.ElapsedSeconds();
+		}
+	}
+
+	void VectoredIoThroughput()
+	{
+		const struct { const wchar_t* Name; size_t Size; int Count; } sizes[] = {
+			{ L"64B", 64, 200000 },
+			{ L"4KB", 4096, 50000 },
+			{ L"1MB", 1024 * 1024, 500 }
+		};
+		for (const bool messageMode : { true, false })
+		{
+			const std::wstring pipeType = messageMode ? L"message pipe " : L"byte pipe ";
+			for (const auto& size : sizes)
+			{
+				const std::wstring name = L"VectoredIo " + pipeType + size.Name;
+				Report(name, L"concatenate+write", Measure(messageMode, WriteMethod::Concatenate, size.Size, size.Count), L"msgs/sec");
+				Report(name, L"gather write", Measure(messageMode, WriteMethod::Gather, size.Size, size.Count), L"msgs/sec");
+				Report(name, L"gather write, cached traits", Measure(messageMode, WriteMethod::GatherCachedTraits, size.Size, size.Count), L"msgs/sec");
+			}
+		}
+	}
+}
@@ -0,0 +1,115 @@
+#pragma once
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <chrono>
+#endif
+#include <string>
+#include <functional>
+
+namespace Benchmarks
+{
+#ifdef _WIN32
+	/// <summary>
+	///		A high resolution stopwatch based on QueryPerformanceCounter().
+	/// </summary>
+	class Stopwatch
+	{
+		public:
+			Stopwatch()
+			:	m_frequency{ 0 },
+				m_start{ 0 }
+			{
+				QueryPerformanceFrequency(&m_frequency);
+				Restart();
+			}
+
+			void Restart() noexcept
+			{
+				QueryPerformanceCounter(&m_start);
+			}
+
+			double ElapsedSeconds() const noexcept
+			{
+				LARGE_INTEGER now{ 0 };
+				QueryPerformanceCounter(&now);
+				return static_cast<double>(now.QuadPart - m_start.QuadPart) / m_frequency.QuadPart;
+			}
+
+		private:
+			LARGE_INTEGER m_frequency;
+			LARGE_INTEGER m_start;
+	};
+#else
+	/// <summary>
+	///		A high resolution stopwatch based on steady_clock.
+	/// </summary>
+	class Stopwatch
+	{
+		public:
+			Stopwatch()
+			{
+				Restart();
+			}
+
+			void Restart() noexcept
+			{
+				m_start = std::chrono::steady_clock::now();
+			}
+
+			double ElapsedSeconds() const noexcept
+			{
+				return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+			}
+
+		private:
+			std::chrono::steady_clock::time_point m_start;
+	};
+#endif
+
+	/// <summary>
+	///		Records a single measurement.
+	/// </summary>
+	void Report(
+		const std::wstring& benchmark,
+		const std::wstring& metric,
+		const double value,
+		const std::wstring& unit
+	);
+
+	// Async
+	void RateLimiterOverhead();
+	void RateLimiterAccuracy();
+	void PooledThreadStart();
+	void ProcessPoolThroughput();
+	void ProcessOutputCaptureThroughput();
+	void ProcessSnapshotLookup();
+	void PipeFrameChannelThroughput();
+	void PooledNamedPipeServerConcurrency();
+	void OverlappedPoolOverhead();
+	void VectoredIoThroughput();
+	void DelimitedStreamReaderThroughput();
+	void HybridPipeTransportThroughput();
+	void FlowControlSlowConsumer();
+	void UnixSocketThroughput();
+	void PipeIpcSuite();
+	void FileMappingScan();
+	void MemoryMappedFilePageSize();
+	void MappedJournalAppend();
+	void SharedHeapAllocation();
+	void SharedHashTableStartup();
+	void MemoryMappedVectorLoad();
+	void DurableQueueThroughput();
+	void FlatMessageEncoding();
+	void RpcMultiplexing();
+	void BroadcastRingLatency();
+
+#ifndef _WIN32
+	/// <summary>
+	///		Passed by ProcessPoolThroughput() to run the driver as a pool
+	///		worker, followed by the channel path.
+	/// </summary>
+	constexpr const wchar_t* ProcessPoolWorkerArgument = L"--process-pool-worker";
+	void ProcessPoolWorkerMain(const std::wstring& channelPath);
+#endif
+}
@@ -0,0 +1,253 @@
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <filesystem>
+#include <map>
+#include <vector>
+#include "Benchmarks.hpp"
+
+namespace Benchmarks
+{
+	namespace
+	{
+		struct Result
+		{
+			std::wstring Benchmark;
+			std::wstring Metric;
+			double Value;
+			std::wstring Unit;
+		};
+
+		std::vector<Result> g_results;
+
+		std::string ToUtf8(const std::wstring& str)
+		{
+#ifdef _WIN32
+			if (str.empty())
+				return "";
+			const int size = WideCharToMultiByte(CP_UTF8, 0, str.c_str(), (int)str.size(), nullptr, 0, nullptr, nullptr);
+			std::string utf8(size, '\0');
+			WideCharToMultiByte(CP_UTF8, 0, str.c_str(), (int)str.size(), utf8.data(), size, nullptr, nullptr);
+			return utf8;
+#else
+			// wchar_t holds UTF-32 elsewhere
+			std::string utf8;
+			for (const wchar_t c : str)
+			{
+				const unsigned codePoint = static_cast<unsigned>(c);
+				if (codePoint < 0x80)
+				{
+					utf8 += (char)codePoint;
+					continue;
+				}
+				constexpr unsigned char leadBytes[] = { 0, 0xC0, 0xE0, 0xF0 };
+				const int continuations = codePoint < 0x800 ? 1 : codePoint < 0x10000 ? 2 : 3;
+				utf8 += (char)(leadBytes[continuations] | (codePoint >> (6 * continuations)));
+				for (int i = continuations - 1; i >= 0; i--)
+					utf8 += (char)(0x80 | ((codePoint >> (6 * i)) & 0x3F));
+			}
+			return utf8;
+#endif
+		}
+
+		std::string Quote(const std::wstring& str, const bool forJson)
+		{
+			std::string quoted = "\"";
+			for (const char c : ToUtf8(str))
+			{
+				if (c == '"')
+					quoted += forJson ? "\\\"" : "\"\"";
+				else if (c == '\\' && forJson)
+					quoted += "\\\\";
+				else
+					quoted += c;
+			}
+			return quoted + "\"";
+		}
+
+		void WriteCsv(const std::wstring& path)
+		{
+			std::ofstream file(std::filesystem::path(path), std::ios::trunc);
+			if (file.is_open() == false)
+				throw std::runtime_error("Failed to open the CSV output file");
+			file << "benchmark,metric,value,unit\n";
+			for (const Result& result : g_results)
+			{
+				file
+					<< Quote(result.Benchmark, false) << ","
+					<< Quote(result.Metric, false) << ","
+					<< std::setprecision(6) << result.Value << ","
+					<< Quote(result.Unit, false) << "\n";
+			}
+		}
+
+		void WriteJson(const std::wstring& path)
+		{
+			std::ofstream file(std::filesystem::path(path), std::ios::trunc);
+			if (file.is_open() == false)
+				throw std::runtime_error("Failed to open the JSON output file");
+			file << "[\n";
+			for (size_t i = 0; i < g_results.size(); i++)
+			{
+				const Result& result = g_results[i];
+				file
+					<< "  { \"benchmark\": " << Quote(result.Benchmark, true)
+					<< ", \"metric\": " << Quote(result.Metric, true)
+					<< ", \"value\": " << std::setprecision(6) << result.Value
+					<< ", \"unit\": " << Quote(result.Unit, true)
+					<< (i + 1 < g_results.size() ? " },\n" : " }\n");
+			}
+			file << "]\n";
+		}
+	}
+
+	void Report(
+		const std::wstring& benchmark,
+		const std::wstring& metric,
+		const double value,
+		const std::wstring& unit
+	)
+	{
+		g_results.push_back({ benchmark, metric, value, unit });
+		std::wcout
+			<< std::left << std::setw(40) << benchmark
+			<< std::setw(28) << metric
+			<< std::right << std::setw(16) << std::fixed << std::setprecision(2) << value
+			<< L" " << unit
+			<< std::endl;
+	}
+}
+
+namespace
+{
+	int Run(const std::vector<std::wstring>& args)
+	{
+		const std::map<std::wstring, std::function<void()>> benchmarks{
+#ifdef _WIN32
+			{ L"RateLimiterOverhead", Benchmarks::RateLimiterOverhead },
+			{ L"RateLimiterAccuracy", Benchmarks::RateLimiterAccuracy },
+			{ L"PooledThreadStart", Benchmarks::PooledThreadStart },
+#endif
+			{ L"ProcessPoolThroughput", Benchmarks::ProcessPoolThroughput },
+#ifdef _WIN32
+			{ L"ProcessOutputCaptureThroughput", Benchmarks::ProcessOutputCaptureThroughput },
+			{ L"ProcessSnapshotLookup", Benchmarks::ProcessSnapshotLookup },
+			{ L"PipeFrameChannelThroughput", Benchmarks::PipeFrameChannelThroughput },
+			{ L"PooledNamedPipeServerConcurrency", Benchmarks::PooledNamedPipeServerConcurrency },
+			{ L"OverlappedPoolOverhead", Benchmarks::OverlappedPoolOverhead },
+			{ L"VectoredIoThroughput", Benchmarks::VectoredIoThroughput },
+			{ L"DelimitedStreamReaderThroughput", Benchmarks::DelimitedStreamReaderThroughput },
+			{ L"HybridPipeTransportThroughput", Benchmarks::HybridPipeTransportThroughput },
+			{ L"FlowControlSlowConsumer", Benchmarks::FlowControlSlowConsumer },
+#endif
+			// This, ProcessPoolThroughput and FileMappingScan are the only
+			// benchmarks with a POSIX backend, so the only ones built on Linux
+			{ L"UnixSocketThroughput", Benchmarks::UnixSocketThroughput },
+#ifdef _WIN32
+			{ L"PipeIpcSuite", Benchmarks::PipeIpcSuite },
+#endif
+			{ L"FileMappingScan", Benchmarks::FileMappingScan },
+#ifdef _WIN32
+			{ L"MemoryMappedFilePageSize", Benchmarks::MemoryMappedFilePageSize },
+			{ L"MappedJournalAppend", Benchmarks::MappedJournalAppend },
+			{ L"SharedHeapAllocation", Benchmarks::SharedHeapAllocation },
+			{ L"SharedHashTableStartup", Benchmarks::SharedHashTableStartup },
+			{ L"MemoryMappedVectorLoad", Benchmarks::MemoryMappedVectorLoad },
+			{ L"DurableQueueThroughput", Benchmarks::DurableQueueThroughput },
+			{ L"FlatMessageEncoding", Benchmarks::FlatMessageEncoding },
+			{ L"RpcMultiplexing", Benchmarks::RpcMultiplexing },
+			{ L"BroadcastRingLatency", Benchmarks::BroadcastRingLatency },
+#endif
+		};
+
+		try
+		{
+			std::wstring csvPath;
+			std::wstring jsonPath;
+			std::vector<std::wstring> names;
+			for (const std::wstring& arg : args)
+			{
+				if (arg.starts_with(L"--csv="))
+					csvPath = arg.substr(6);
+				else if (arg.starts_with(L"--json="))
+					jsonPath = arg.substr(7);
+				else
+					names.push_back(arg);
+			}
+
+			for (const std::wstring& name : names)
+			{
+				if (benchmarks.contains(name) == false)
+				{
+					std::wcerr << L"Unknown benchmark: " << name << std::endl;
+					return 1;
+				}
+			}
+
+			if (names.empty())
+			{
+				for (const auto& [name, benchmark] : benchmarks)
+					benchmark();
+			}
+			for (const std::wstring& name : names)
+				benchmarks.at(name)();
+
+			if (csvPath.empty() == false)
+				Benchmarks::WriteCsv(csvPath);
+			if (jsonPath.empty() == false)
+				Benchmarks::WriteJson(jsonPath);
+			return 0;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr << ex.what() << std::endl;
+			return 1;
+		}
+	}
+}
+
+// Usage: Boring32.Benchmarks.exe [--csv=<path>] [--json=<path>] [benchmark-name...]
+// Runs every benchmark if no names are given. The --csv and --json options
+// also write every result to the given file, for tracking regressions.
+#ifdef _WIN32
+int wmain(int argc, wchar_t** args)
+{
+	return Run(std::vector<std::wstring>(args + 1, args + argc));
+}
+#else
+// On Linux, only UnixSocketThroughput, ProcessPoolThroughput and
+// FileMappingScan are built, from this file, their sources under Async,
+// the Posix directories under Boring32/src/Async and the shared
+// SlidingFileView.cpp, e.g.
+// g++ -std=c++20 -O2 -pthread -I../Boring32 Boring32.Benchmarks.cpp
+//     Async/UnixSocket.cpp Async/ProcessPool.cpp Async/FileMapping.cpp
+//     ../Boring32/src/Async/Posix/*.cpp ../Boring32/src/Async/Pipes/Posix/*.cpp
+//     ../Boring32/src/Async/SlidingFileView.cpp
+int main(int argc, char** args)
+{
+	// Arguments are ASCII benchmark names and paths
+	std::vector<std::wstring> arguments;
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string arg = args[i];
+		arguments.emplace_back(arg.begin(), arg.end());
+	}
+	if (arguments.size() == 2 && arguments[0] == Benchmarks::ProcessPoolWorkerArgument)
+	{
+		try
+		{
+			Benchmarks::ProcessPoolWorkerMain(arguments[1]);
+			return 0;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr << ex.what() << std::endl;
+			return 1;
+		}
+	}
+	return Run(arguments);
+}
+#endif
@@ -0,0 +1,114 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <atomic>
+#include "Boring32/include/Async/Pipes/BlockingNamedPipeServer.hpp"
+#include "Boring32/include/Async/Pipes/BlockingNamedPipeClient.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(BlockingNamedPipe)
+	{
+		// The pipe classes recreate the pipe when moved, so these are
+		// constructed in place. The buffer is large enough that writes
+		// in these tests never block waiting for the reader.
+		struct ConnectedPipes
+		{
+			ConnectedPipes(const std::wstring& name)
+			:	Server(name, 64 * 1024, 1, L"", false, true),
+				Client(name)
+			{ }
+
+			Boring32::Async::BlockingNamedPipeServer Server;
+			Boring32::Async::BlockingNamedPipeClient Client;
+		};
+
+		static std::unique_ptr<ConnectedPipes> Connect()
+		{
+			static std::atomic<int> counter = 0;
+			const std::wstring name =
+				L"Boring32.UnitTests.BlockingNamedPipe."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ L"."
+				+ std::to_wstring(counter++);
+
+			// The client connects first so the server's Connect() does
+			// not block; it then sees ERROR_PIPE_CONNECTED
+			auto pipes = std::make_unique<ConnectedPipes>(name);
+			pipes->Client.Connect(0);
+			pipes->Server.Connect();
+			pipes->Client.SetMode(PIPE_READMODE_MESSAGE);
+			return pipes;
+		}
+
+		static std::wstring MakeMessage(const size_t size)
+		{
+			std::wstring msg(size, L'\0');
+			for (size_t i = 0; i < size; i++)
+				msg[i] = (wchar_t)(L'a' + i % 26);
+			return msg;
+		}
+
+		public:
+			TEST_METHOD(TestServerConnectAfterClient)
+			{
+				static std::atomic<int> counter = 0;
+				const std::wstring name =
+					L"Boring32.UnitTests.BlockingNamedPipe.Connect."
+					+ std::to_wstring(GetCurrentProcessId())
+					+ L"."
+					+ std::to_wstring(counter++);
+
+				ConnectedPipes pipes(name);
+				pipes.Client.Connect(0);
+				pipes.Server.Connect();
+			}
+
+			TEST_METHOD(TestClientWriteSendsWholeMessage)
+			{
+				auto pipes = Connect();
+				const std::wstring msg = L"hello world";
+				pipes->Client.Write(msg);
+				Assert::IsTrue(pipes->Server.Read() == msg);
+			}
+
+			TEST_METHOD(TestServerWriteSendsWholeMessage)
+			{
+				auto pipes = Connect();
+				const std::wstring msg = L"hello world";
+				pipes->Server.Write(msg);
+				Assert::IsTrue(pipes->Client.Read() == msg);
+			}
+
+			TEST_METHOD(TestServerReadLargeMessage)
+			{
+				// Larger than the 1024 character read block, so the read
+				// has to continue after ERROR_MORE_DATA
+				auto pipes = Connect();
+				const std::wstring msg = MakeMessage(3000);
+				pipes->Client.Write(msg);
+				Assert::IsTrue(pipes->Server.Read() == msg);
+			}
+
+			TEST_METHOD(TestClientReadLargeMessage)
+			{
+				auto pipes = Connect();
+				const std::wstring msg = MakeMessage(3000);
+				pipes->Server.Write(msg);
+				Assert::IsTrue(pipes->Client.Read() == msg);
+			}
+
+			TEST_METHOD(TestSequentialMessages)
+			{
+				auto pipes = Connect();
+				const std::wstring first = MakeMessage(1500);
+				const std::wstring second = L"second";
+				pipes->Client.Write(first);
+				pipes->Client.Write(second);
+				Assert::IsTrue(pipes->Server.Read() == first);
+				Assert::IsTrue(pipes->Server.Read() == second);
+			}
+	};
+}
@@ -0,0 +1,189 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include "Boring32/include/Async/BroadcastRingPublisher.hpp"
+#include "Boring32/include/Async/BroadcastRingSubscriber.hpp"
+#include "Boring32/include/Async/BroadcastRingLayout.hpp"
+#include "Boring32/include/Async/MemoryMappedFile.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(BroadcastRing)
+	{
+		static std::wstring MakeName()
+		{
+			static std::atomic<int> counter = 0;
+			return L"Boring32.UnitTests.BroadcastRing."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ L"."
+				+ std::to_wstring(counter++);
+		}
+
+		static std::vector<std::byte> ToBytes(const UINT32 value)
+		{
+			std::vector<std::byte> bytes(sizeof(value));
+			std::memcpy(bytes.data(), &value, sizeof(value));
+			return bytes;
+		}
+
+		static UINT32 FromBytes(const std::vector<std::byte>& bytes)
+		{
+			UINT32 value = 0;
+			std::memcpy(&value, bytes.data(), sizeof(value));
+			return value;
+		}
+
+		public:
+			TEST_METHOD(TestPublishReceive)
+			{
+				const std::wstring name = MakeName();
+				Boring32::Async::BroadcastRingPublisher publisher(name);
+				Boring32::Async::BroadcastRingSubscriber first(name);
+				Boring32::Async::BroadcastRingSubscriber second(name);
+				Assert::AreEqual(2u, publisher.GetSubscriberCount());
+
+				for (UINT32 i = 0; i < 10; i++)
+					Assert::AreEqual(UINT64(i), publisher.Publish(ToBytes(i)));
+
+				std::vector<std::byte> message;
+				for (Boring32::Async::BroadcastRingSubscriber* subscriber : { &first, &second })
+				{
+					Assert::AreEqual(UINT64(10), subscriber->GetBacklog());
+					for (UINT32 i = 0; i < 10; i++)
+					{
+						Assert::IsTrue(subscriber->TryReceive(message) == Boring32::Async::BroadcastReceiveResult::Message);
+						Assert::AreEqual(i, FromBytes(message));
+					}
+					Assert::IsTrue(subscriber->TryReceive(message) == Boring32::Async::BroadcastReceiveResult::Empty);
+				}
+
+				publisher.Publish({});
+				Assert::IsTrue(first.TryReceive(message) == Boring32::Async::BroadcastReceiveResult::Message);
+				Assert::IsTrue(message.empty());
+			}
+
+			TEST_METHOD(TestJoinPosition)
+			{
+				const std::wstring name = MakeName();
+				Boring32::Async::BroadcastRingPublisher publisher(name, { .SlotCount = 4 });
+				for (UINT32 i = 0; i < 6; i++)
+					publisher.Publish(ToBytes(i));
+
+				std::vector<std::byte> message;
+				Boring32::Async::BroadcastRingSubscriber latest(name);
+				Assert::IsTrue(latest.TryReceive(message) == Boring32::Async::BroadcastReceiveResult::Empty);
+
+				// Only the last SlotCount messages are still in the ring
+				Boring32::Async::BroadcastRingSubscriber oldest(
+					name,
+					{ .Start = Boring32::Async::BroadcastRingStart::Oldest }
+				);
+				Assert::AreEqual(UINT64(2), oldest.GetCursor());
+				Assert::IsTrue(oldest.TryReceive(message) == Boring32::Async::BroadcastReceiveResult::Message);
+				Assert::AreEqual(2u, FromBytes(message));
+
+				publisher.Publish(ToBytes(6));
+				Assert::IsTrue(latest.TryReceive(message) == Boring32::Async::BroadcastReceiveResult::Message);
+				Assert::AreEqual(6u, FromBytes(message));
+			}
+
+			TEST_METHOD(TestLapped)
+			{
+				const std::wstring name = MakeName();
+				Boring32::Async::BroadcastRingPublisher publisher(name, { .SlotCount = 8 });
+				Boring32::Async::BroadcastRingSubscriber subscriber(name);
+				for (UINT32 i = 0; i < 20; i++)
+					publisher.Publish(ToBytes(i));
+
+				std::vector<std::byte> message;
+				Assert::IsTrue(subscriber.TryReceive(message) == Boring32::Async::BroadcastReceiveResult::Lapped);
+				Assert::AreEqual(UINT64(16), subscriber.GetLostCount());
+				for (UINT32 i = 16; i < 20; i++)
+				{
+					Assert::IsTrue(subscriber.TryReceive(message) == Boring32::Async::BroadcastReceiveResult::Message);
+					Assert::AreEqual(i, FromBytes(message));
+				}
+				Assert::IsTrue(subscriber.TryReceive(message) == Boring32::Async::BroadcastReceiveResult::Empty);
+			}
+
+			TEST_METHOD(TestReceiveWaits)
+			{
+				const std::wstring name = MakeName();
+				Boring32::Async::BroadcastRingPublisher publisher(name);
+				Boring32::Async::BroadcastRingSubscriber subscriber(name, { .SpinCount = 0 });
+
+				std::vector<std::byte> message;
+				Assert::IsTrue(subscriber.Receive(message, 10) == Boring32::Async::BroadcastReceiveResult::Empty);
+
+				std::thread publishing(
+					[&publisher]()
+					{
+						Sleep(50);
+						publisher.Publish(ToBytes(42));
+					});
+				Assert::IsTrue(subscriber.Receive(message, INFINITE) == Boring32::Async::BroadcastReceiveResult::Message);
+				publishing.join();
+				Assert::AreEqual(42u, FromBytes(message));
+			}
+
+			TEST_METHOD(TestSubscriberLimit)
+			{
+				const std::wstring name = MakeName();
+				Boring32::Async::BroadcastRingPublisher publisher(name, { .MaxSubscribers = 1 });
+				Boring32::Async::BroadcastRingSubscriber first(name);
+				Assert::ExpectException<std::runtime_error>([&name]() { Boring32::Async::BroadcastRingSubscriber second(name); });
+				first.Close();
+				Boring32::Async::BroadcastRingSubscriber third(name);
+				Assert::AreEqual(1u, publisher.GetSubscriberCount());
+			}
+
+			TEST_METHOD(TestReclaimDeadSubscriber)
+			{
+				const std::wstring name = MakeName();
+				Boring32::Async::BroadcastRingPublisher publisher(name, { .MaxSubscribers = 1 });
+
+				// Holding the exited process's handle stops its ID being reused
+				STARTUPINFOW startupInfo{ .cb = sizeof(startupInfo) };
+				PROCESS_INFORMATION processInfo{ 0 };
+				std::wstring commandLine = L"cmd.exe /c exit";
+				Assert::IsTrue(CreateProcessW(nullptr, commandLine.data(), nullptr, nullptr, false, CREATE_NO_WINDOW, nullptr, nullptr, &startupInfo, &processInfo));
+				CloseHandle(processInfo.hThread);
+				WaitForSingleObject(processInfo.hProcess, INFINITE);
+
+				// Leave the only entry as a subscriber that died while
+				// waiting would
+				Boring32::Async::MemoryMappedFile memory(name, 0, false, FILE_MAP_ALL_ACCESS);
+				auto header = static_cast<Boring32::Async::BroadcastRingHeader*>(memory.GetViewPointer());
+				Boring32::Async::BroadcastRingSubscriberEntry* entry = Boring32::Async::GetBroadcastRingSubscriber(header, 0);
+				entry->State = 1;
+				entry->ProcessId = processInfo.dwProcessId;
+				entry->Waiting = 1;
+				header->WaiterCount = 1;
+
+				Boring32::Async::BroadcastRingSubscriber subscriber(name);
+				Assert::AreEqual(static_cast<UINT32>(GetCurrentProcessId()), entry->ProcessId);
+				Assert::AreEqual(0u, entry->Waiting);
+				Assert::AreEqual(0u, header->WaiterCount);
+				Assert::ExpectException<std::runtime_error>([&name]() { Boring32::Async::BroadcastRingSubscriber second(name); });
+				CloseHandle(processInfo.hProcess);
+			}
+
+			TEST_METHOD(TestInvalidArguments)
+			{
+				Assert::ExpectException<std::invalid_argument>([]() { Boring32::Async::BroadcastRingPublisher invalid(MakeName(), { .SlotCount = 3 }); });
+				Assert::ExpectException<std::invalid_argument>([]() { Boring32::Async::BroadcastRingPublisher invalid(MakeName(), { .SlotSize = 100 }); });
+
+				const std::wstring name = MakeName();
+				Boring32::Async::BroadcastRingPublisher publisher(name);
+				const std::vector<std::byte> tooLarge(publisher.GetMaxMessageSize() + 1);
+				Assert::ExpectException<std::invalid_argument>([&publisher, &tooLarge]() { publisher.Publish(tooLarge); });
+				Assert::ExpectException<std::runtime_error>([&name]() { Boring32::Async::BroadcastRingPublisher duplicate(name); });
+			}
+	};
+}
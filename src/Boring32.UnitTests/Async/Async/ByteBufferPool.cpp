@@ -0,0 +1,68 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "Boring32/include/Async/ByteBufferPool.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(ByteBufferPool)
+	{
+		public:
+			TEST_METHOD(TestInvalidConstructor)
+			{
+				Assert::ExpectException<std::invalid_argument>(
+					[]()
+					{
+						Boring32::Async::ByteBufferPool pool(0, 1);
+					});
+				Assert::ExpectException<std::invalid_argument>(
+					[]()
+					{
+						Boring32::Async::ByteBufferPool pool(1, 0);
+					});
+			}
+
+			TEST_METHOD(TestAcquireUpToMax)
+			{
+				Boring32::Async::ByteBufferPool pool(64, 2);
+				Assert::IsTrue(pool.GetAvailableCount() == 2);
+				std::byte* first = pool.Acquire(0);
+				std::byte* second = pool.Acquire(0);
+				Assert::IsNotNull(first);
+				Assert::IsNotNull(second);
+				Assert::IsTrue(first != second);
+				Assert::IsNull(pool.Acquire(0));
+				Assert::IsTrue(pool.GetAvailableCount() == 0);
+			}
+
+			TEST_METHOD(TestReleasedBufferIsReused)
+			{
+				Boring32::Async::ByteBufferPool pool(64, 1);
+				std::byte* buffer = pool.Acquire(0);
+				pool.Release(buffer);
+				Assert::IsTrue(pool.Acquire(0) == buffer);
+			}
+
+			TEST_METHOD(TestReleaseForeignBuffer)
+			{
+				Boring32::Async::ByteBufferPool pool(64, 1);
+				std::byte foreign[64]{};
+				Assert::ExpectException<std::invalid_argument>([&pool, &foreign]() { pool.Release(foreign); });
+
+				std::byte* buffer = pool.Acquire(0);
+				pool.Release(buffer);
+				Assert::ExpectException<std::invalid_argument>([&pool, buffer]() { pool.Release(buffer); });
+				Assert::IsTrue(pool.GetAvailableCount() == 1);
+			}
+
+			TEST_METHOD(TestAcquireTimesOut)
+			{
+				Boring32::Async::ByteBufferPool pool(64, 1);
+				pool.Acquire(0);
+				const ULONGLONG startedAt = GetTickCount64();
+				Assert::IsNull(pool.Acquire(50));
+				Assert::IsTrue(GetTickCount64() - startedAt >= 40);
+			}
+	};
+}
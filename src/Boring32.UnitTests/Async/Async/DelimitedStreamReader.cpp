@@ -0,0 +1,135 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include "Boring32/include/Async/Pipes/AnonymousPipe.hpp"
+#include "Boring32/include/Async/Pipes/DelimitedStreamReader.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(DelimitedStreamReader)
+	{
+		static void WriteBytes(const HANDLE handle, const std::string_view data)
+		{
+			DWORD bytesWritten = 0;
+			Assert::IsTrue(WriteFile(handle, data.data(), (DWORD)data.size(), &bytesWritten, nullptr));
+		}
+
+		static std::string ToString(const std::span<const std::byte> message)
+		{
+			return std::string(reinterpret_cast<const char*>(message.data()), message.size());
+		}
+
+		public:
+			TEST_METHOD(TestReadsAnonymousPipeMessages)
+			{
+				Boring32::Async::AnonymousPipe pipe(false, 4096, L"||");
+				pipe.DelimitedWrite(L"first message");
+				pipe.DelimitedWrite(L"second");
+				pipe.DelimitedWrite(L"a third, longer message");
+				pipe.CloseWrite();
+
+				// A small buffer means messages straddle several reads
+				Boring32::Async::DelimitedStreamReader reader(
+					pipe,
+					Boring32::Async::DelimitedStreamReaderSettings{ .BufferSize = 16 }
+				);
+				std::wstring_view message;
+				Assert::IsTrue(reader.Next(message));
+				Assert::AreEqual(std::wstring(L"first message"), std::wstring(message));
+				Assert::IsTrue(reader.Next(message));
+				Assert::AreEqual(std::wstring(L"second"), std::wstring(message));
+				Assert::IsTrue(reader.Next(message));
+				Assert::AreEqual(std::wstring(L"a third, longer message"), std::wstring(message));
+				Assert::IsFalse(reader.Next(message));
+				Assert::AreEqual((UINT64)3, reader.GetMessagesRead());
+			}
+
+			TEST_METHOD(TestDelimiterSplitAcrossWrites)
+			{
+				Boring32::Async::AnonymousPipe pipe(false, 4096, L"");
+				WriteBytes(pipe.GetWrite(), "alpha\r");
+				WriteBytes(pipe.GetWrite(), "\nbeta\r\n\r\ngam");
+				WriteBytes(pipe.GetWrite(), "ma");
+				pipe.CloseWrite();
+
+				const char delimiter[] = { '\r', '\n' };
+				Boring32::Async::DelimitedStreamReader reader(
+					pipe.GetRead(),
+					std::as_bytes(std::span(delimiter)),
+					Boring32::Async::DelimitedStreamReaderSettings{ .BufferSize = 8 }
+				);
+				std::span<const std::byte> message;
+				Assert::IsTrue(reader.Next(message));
+				Assert::AreEqual(std::string("alpha"), ToString(message));
+				Assert::IsTrue(reader.Next(message));
+				Assert::AreEqual(std::string("beta"), ToString(message));
+				Assert::IsTrue(reader.Next(message));
+				Assert::AreEqual(std::string(""), ToString(message));
+				// The data after the last delimiter is the final message
+				Assert::IsTrue(reader.Next(message));
+				Assert::AreEqual(std::string("gamma"), ToString(message));
+				Assert::IsFalse(reader.Next(message));
+				Assert::AreEqual((UINT64)20, reader.GetBytesRead());
+			}
+
+			TEST_METHOD(TestZeroLengthWriteIsNotEnd)
+			{
+				Boring32::Async::AnonymousPipe pipe(false, 4096, L"");
+				WriteBytes(pipe.GetWrite(), "alpha\n");
+				// The reader gets a successful read of no bytes for this
+				WriteBytes(pipe.GetWrite(), "");
+				WriteBytes(pipe.GetWrite(), "beta\n");
+				pipe.CloseWrite();
+
+				const char delimiter[] = { '\n' };
+				Boring32::Async::DelimitedStreamReader reader(
+					pipe.GetRead(),
+					std::as_bytes(std::span(delimiter)),
+					Boring32::Async::DelimitedStreamReaderSettings{ .BufferSize = 8 }
+				);
+				std::span<const std::byte> message;
+				Assert::IsTrue(reader.Next(message));
+				Assert::AreEqual(std::string("alpha"), ToString(message));
+				Assert::IsTrue(reader.Next(message));
+				Assert::AreEqual(std::string("beta"), ToString(message));
+				Assert::IsFalse(reader.Next(message));
+			}
+
+			TEST_METHOD(TestAlignedMatchesOnly)
+			{
+				// The bytes of L'|' (7C 00) occur at an odd offset in this
+				// message, spanning two characters, which must not match
+				Boring32::Async::AnonymousPipe pipe(false, 4096, L"|");
+				const std::wstring payload = L"\x7C41\x4100";
+				pipe.DelimitedWrite(payload);
+				pipe.CloseWrite();
+
+				Boring32::Async::DelimitedStreamReader reader(pipe);
+				std::wstring_view message;
+				Assert::IsTrue(reader.Next(message));
+				Assert::AreEqual(payload, std::wstring(message));
+				Assert::IsFalse(reader.Next(message));
+			}
+
+			TEST_METHOD(TestMaxMessageSize)
+			{
+				Boring32::Async::AnonymousPipe pipe(false, 4096, L"");
+				WriteBytes(pipe.GetWrite(), std::string(100, 'x'));
+				pipe.CloseWrite();
+
+				const char delimiter[] = { '\n' };
+				Boring32::Async::DelimitedStreamReader reader(
+					pipe.GetRead(),
+					std::as_bytes(std::span(delimiter)),
+					Boring32::Async::DelimitedStreamReaderSettings{ .BufferSize = 16, .MaxMessageSize = 64 }
+				);
+				std::span<const std::byte> message;
+				Assert::ExpectException<std::runtime_error>([&reader, &message]() { reader.Next(message); });
+			}
+	};
+}
@@ -0,0 +1,170 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <vector>
+#include <cstring>
+#include "Boring32/include/Async/FileMapping.hpp"
+#include "Boring32/include/Async/DurableQueueProducer.hpp"
+#include "Boring32/include/Async/DurableQueueConsumer.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(DurableQueue)
+	{
+		std::wstring m_directory;
+
+		static std::vector<std::byte> ToBytes(const std::string& value)
+		{
+			std::vector<std::byte> bytes(value.size());
+			std::memcpy(bytes.data(), value.data(), value.size());
+			return bytes;
+		}
+
+		public:
+			TEST_METHOD_INITIALIZE(Initialize)
+			{
+				static int counter = 0;
+				wchar_t tempPath[MAX_PATH + 1]{ 0 };
+				GetTempPathW(MAX_PATH, tempPath);
+				m_directory = std::wstring(tempPath)
+					+ L"Boring32.UnitTests.DurableQueue."
+					+ std::to_wstring(GetCurrentProcessId())
+					+ L"."
+					+ std::to_wstring(counter++);
+			}
+
+			TEST_METHOD_CLEANUP(Cleanup)
+			{
+				for (const UINT64 index : Boring32::Async::DurableQueueSegment::GetSegments(m_directory))
+					DeleteFileW(Boring32::Async::DurableQueueSegment::GetSegmentPath(m_directory, index).c_str());
+				for (const std::wstring& name : Boring32::Async::DurableQueueConsumer::GetConsumers(m_directory))
+					Boring32::Async::DurableQueueConsumer::Remove(m_directory, name);
+				RemoveDirectoryW(m_directory.c_str());
+			}
+
+			TEST_METHOD(TestEnqueueAndDequeue)
+			{
+				Boring32::Async::DurableQueueProducer producer(m_directory);
+				Boring32::Async::DurableQueueConsumer consumer(m_directory, L"consumer");
+				std::vector<std::byte> record;
+				Assert::IsFalse(consumer.TryDequeue(record));
+
+				producer.Enqueue(ToBytes("first"));
+				producer.Enqueue(ToBytes(""));
+				producer.Enqueue(ToBytes("third"));
+				Assert::IsTrue(consumer.TryDequeue(record));
+				Assert::IsTrue(record == ToBytes("first"));
+				Assert::IsTrue(consumer.TryDequeue(record));
+				Assert::IsTrue(record.empty());
+				Assert::IsTrue(consumer.TryDequeue(record));
+				Assert::IsTrue(record == ToBytes("third"));
+				Assert::IsFalse(consumer.TryDequeue(record));
+			}
+
+			TEST_METHOD(TestConsumerOffsets)
+			{
+				Boring32::Async::DurableQueueProducer producer(m_directory);
+				for (int i = 0; i < 3; i++)
+					producer.Enqueue(ToBytes(std::to_string(i)));
+
+				std::vector<std::byte> record;
+				{
+					Boring32::Async::DurableQueueConsumer consumer(m_directory, L"a");
+					Assert::IsTrue(consumer.TryDequeue(record));
+					consumer.Commit();
+					// Read but not committed, so read again after a restart
+					Assert::IsTrue(consumer.TryDequeue(record));
+				}
+
+				Boring32::Async::DurableQueueConsumer resumed(m_directory, L"a");
+				Assert::IsTrue(resumed.TryDequeue(record));
+				Assert::IsTrue(record == ToBytes("1"));
+
+				// Other consumers keep their own position
+				Boring32::Async::DurableQueueConsumer other(m_directory, L"b");
+				Assert::IsTrue(other.TryDequeue(record));
+				Assert::IsTrue(record == ToBytes("0"));
+				Assert::AreEqual(size_t(2), Boring32::Async::DurableQueueConsumer::GetConsumers(m_directory).size());
+			}
+
+			TEST_METHOD(TestRecoveryDiscardsTornRecord)
+			{
+				Boring32::Async::DurableQueuePosition torn;
+				{
+					Boring32::Async::DurableQueueProducer producer(m_directory);
+					producer.Enqueue(ToBytes("kept"));
+					torn = producer.GetPosition();
+					producer.Enqueue(ToBytes("torn"));
+				}
+
+				// Corrupt the second record's payload, as if the process
+				// died while writing it
+				{
+					Boring32::Async::FileMapping file(
+						Boring32::Async::DurableQueueSegment::GetSegmentPath(m_directory, torn.Segment),
+						true
+					);
+					Boring32::Async::FileMappingView view = file.MapView(
+						torn.Offset + Boring32::Async::DurableQueueSegment::RecordHeaderSize,
+						1
+					);
+					view.GetData()[0] = std::byte{ 'X' };
+				}
+
+				Boring32::Async::DurableQueueProducer producer(m_directory);
+				Assert::AreEqual(torn.Offset, producer.GetPosition().Offset);
+				Boring32::Async::DurableQueueConsumer consumer(m_directory, L"consumer");
+				std::vector<std::byte> record;
+				Assert::IsTrue(consumer.TryDequeue(record));
+				Assert::IsTrue(record == ToBytes("kept"));
+				Assert::IsFalse(consumer.TryDequeue(record));
+
+				producer.Enqueue(ToBytes("replacement"));
+				Assert::IsTrue(consumer.TryDequeue(record));
+				Assert::IsTrue(record == ToBytes("replacement"));
+			}
+
+			TEST_METHOD(TestSegmentRecycling)
+			{
+				const Boring32::Async::DurableQueueSettings settings{
+					.SegmentSize = 4096,
+					.Durability = Boring32::Async::DurableQueueDurability::EveryRecord
+				};
+				Boring32::Async::DurableQueueProducer producer(m_directory, settings);
+				Boring32::Async::DurableQueueConsumer consumer(m_directory, L"consumer", settings);
+				std::vector<std::byte> record;
+				for (int i = 0; i < 100; i++)
+				{
+					producer.Enqueue(std::vector<std::byte>(1000, static_cast<std::byte>(i)));
+					Assert::IsTrue(consumer.TryDequeue(record));
+					Assert::IsTrue(record == std::vector<std::byte>(1000, static_cast<std::byte>(i)));
+					consumer.Commit();
+				}
+				Assert::IsTrue(producer.GetPosition().Segment >= 24);
+				// Consumed segments are reused rather than left behind
+				Assert::IsTrue(Boring32::Async::DurableQueueSegment::GetSegments(m_directory).size() <= 2);
+				Assert::ExpectException<std::invalid_argument>(
+					[&producer]() { producer.Enqueue(std::vector<std::byte>(producer.GetMaxRecordSize() + 1)); }
+				);
+			}
+
+			TEST_METHOD(TestSegmentsKeptForLaggingConsumer)
+			{
+				const Boring32::Async::DurableQueueSettings settings{ .SegmentSize = 4096 };
+				Boring32::Async::DurableQueueProducer producer(m_directory, settings);
+				Boring32::Async::DurableQueueConsumer consumer(m_directory, L"consumer", settings);
+				for (int i = 0; i < 20; i++)
+					producer.Enqueue(std::vector<std::byte>(1000, static_cast<std::byte>(i)));
+
+				std::vector<std::byte> record;
+				for (int i = 0; i < 20; i++)
+				{
+					Assert::IsTrue(consumer.TryDequeue(record));
+					Assert::IsTrue(record[0] == static_cast<std::byte>(i));
+				}
+				Assert::IsFalse(consumer.TryDequeue(record));
+			}
+	};
+}
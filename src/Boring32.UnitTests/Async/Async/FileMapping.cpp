@@ -0,0 +1,100 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include "Boring32/include/Async/FileMapping.hpp"
+#include "Boring32/include/Async/SlidingFileView.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(FileMapping)
+	{
+		static constexpr UINT64 FileSize = 1024 * 1024;
+		static constexpr size_t WindowSize = 64 * 1024;
+
+		std::wstring m_path;
+
+		static std::byte PatternAt(const UINT64 offset)
+		{
+			return static_cast<std::byte>((offset * 7) % 251);
+		}
+
+		public:
+			TEST_METHOD_INITIALIZE(Initialize)
+			{
+				wchar_t tempPath[MAX_PATH + 1]{ 0 };
+				GetTempPathW(MAX_PATH, tempPath);
+				m_path = std::wstring(tempPath)
+					+ L"Boring32.UnitTests.FileMapping."
+					+ std::to_wstring(GetCurrentProcessId())
+					+ L".bin";
+
+				Boring32::Async::FileMapping mapping(m_path, true, FileSize);
+				Boring32::Async::FileMappingView view = mapping.MapView(0, 0);
+				std::span<std::byte> data = view.GetData();
+				for (size_t i = 0; i < data.size(); i++)
+					data[i] = PatternAt(i);
+				view.Flush();
+			}
+
+			TEST_METHOD_CLEANUP(Cleanup)
+			{
+				DeleteFileW(m_path.c_str());
+			}
+
+			TEST_METHOD(TestMapUnalignedView)
+			{
+				Boring32::Async::FileMapping mapping(m_path, false);
+				Assert::AreEqual(FileSize, mapping.GetSize());
+				Boring32::Async::FileMappingView view = mapping.MapView(100003, 5000);
+				Assert::AreEqual(size_t(5000), view.GetData().size());
+				Assert::IsTrue(view.GetData()[0] == PatternAt(100003));
+				Assert::IsTrue(view.GetData()[4999] == PatternAt(105002));
+				Assert::IsTrue(view.Contains(100003, 5000));
+				Assert::IsFalse(view.Contains(100002, 10));
+				Assert::ExpectException<std::out_of_range>([&mapping]() { mapping.MapView(FileSize - 10, 11); });
+			}
+
+			TEST_METHOD(TestReadOnlyCannotExtend)
+			{
+				Assert::ExpectException<std::invalid_argument>(
+					[this]() { Boring32::Async::FileMapping(m_path, false, FileSize * 2); }
+				);
+			}
+
+			TEST_METHOD(TestSlidingScanStaysUnderCap)
+			{
+				Boring32::Async::FileMapping mapping(m_path, false);
+				Boring32::Async::SlidingFileView view(
+					mapping,
+					{ .WindowSize = WindowSize, .MaxResidentBytes = WindowSize * 3, .PrefetchNext = true }
+				);
+				for (UINT64 offset = 0; offset < FileSize; offset += 4096)
+				{
+					const std::span<std::byte> data = view.At(offset, 4096);
+					Assert::IsTrue(data[0] == PatternAt(offset));
+					Assert::IsTrue(data[4095] == PatternAt(offset + 4095));
+					Assert::IsTrue(view.GetResidentBytes() <= WindowSize * 3);
+				}
+				Assert::IsTrue(view.GetMappedWindowCount() <= 3);
+				view.Release();
+				Assert::AreEqual(size_t(0), view.GetResidentBytes());
+			}
+
+			TEST_METHOD(TestRangeAcrossWindowBoundary)
+			{
+				Boring32::Async::FileMapping mapping(m_path, false);
+				Boring32::Async::SlidingFileView view(
+					mapping,
+					{ .WindowSize = WindowSize, .MaxResidentBytes = WindowSize * 4 }
+				);
+				view.At(0, 16);
+				const std::span<std::byte> data = view.At(WindowSize - 100, 200);
+				Assert::AreEqual(size_t(200), data.size());
+				for (size_t i = 0; i < data.size(); i++)
+					Assert::IsTrue(data[i] == PatternAt(WindowSize - 100 + i));
+				Assert::ExpectException<std::out_of_range>([&view]() { view.At(FileSize - 1, 2); });
+			}
+	};
+}
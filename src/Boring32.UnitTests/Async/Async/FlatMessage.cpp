@@ -0,0 +1,131 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "Boring32/include/Async/FlatMessageBuilder.hpp"
+#include "Boring32/include/Async/FlatMessageView.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(FlatMessage)
+	{
+		enum Field : UINT16
+		{
+			Id,
+			Price,
+			Flag,
+			Name,
+			Values,
+			Nested,
+			FieldCount
+		};
+
+		// UINT64 elements keep the buffer 8 byte aligned
+		static std::span<std::byte> AsBuffer(std::vector<UINT64>& storage)
+		{
+			return std::as_writable_bytes(std::span(storage));
+		}
+
+		public:
+			TEST_METHOD(TestRoundTrip)
+			{
+				std::vector<UINT64> storage(64);
+				Boring32::Async::FlatMessageBuilder builder(AsBuffer(storage), FieldCount);
+				builder.AddString(Name, std::wstring_view(L"widget"));
+				builder.Add(Flag, static_cast<BYTE>(7));
+				builder.Add(Id, static_cast<UINT64>(12345));
+				builder.Add(Price, 9.5);
+				const std::vector<UINT32> values{ 1, 2, 3 };
+				builder.AddArray(Values, std::span<const UINT32>(values));
+
+				const Boring32::Async::FlatMessageView view(builder.Finish());
+				Assert::AreEqual(static_cast<UINT64>(12345), *view.Get<UINT64>(Id));
+				Assert::AreEqual(9.5, *view.Get<double>(Price));
+				Assert::AreEqual(static_cast<BYTE>(7), *view.Get<BYTE>(Flag));
+				Assert::IsTrue(view.GetWideString(Name) == L"widget");
+				const std::span<const UINT32> read = view.GetArray<UINT32>(Values);
+				Assert::IsTrue(std::equal(read.begin(), read.end(), values.begin(), values.end()));
+				// Arrays are read in place rather than copied
+				Assert::IsTrue(reinterpret_cast<const std::byte*>(read.data()) > view.GetData().data());
+				Assert::IsTrue(reinterpret_cast<const std::byte*>(read.data()) < view.GetData().data() + view.GetData().size());
+				Assert::AreEqual(size_t(0), view.GetData().size() % 8);
+			}
+
+			TEST_METHOD(TestOptionalFields)
+			{
+				std::vector<UINT64> storage(16);
+				Boring32::Async::FlatMessageBuilder builder(AsBuffer(storage), 2);
+				builder.Add(static_cast<UINT16>(1), 42);
+
+				const Boring32::Async::FlatMessageView view(builder.Finish());
+				Assert::IsFalse(view.Has(0));
+				Assert::IsTrue(view.Has(1));
+				Assert::IsFalse(view.Get<int>(0).has_value());
+				Assert::AreEqual(-1, view.Get<int>(0, -1));
+				// Fields beyond the writer's vtable, such as ones added in
+				// a later version, read as absent
+				Assert::IsFalse(view.Has(Nested));
+				Assert::IsTrue(view.GetString(Name).empty());
+				Assert::IsTrue(view.GetArray<UINT32>(Values).empty());
+				Assert::IsFalse(view.GetNested(Nested).IsValid());
+			}
+
+			TEST_METHOD(TestNestedMessage)
+			{
+				std::vector<UINT64> innerStorage(16);
+				Boring32::Async::FlatMessageBuilder inner(AsBuffer(innerStorage), 1);
+				inner.AddString(0, std::string_view("inner"));
+				const Boring32::Async::FlatMessageView innerView(inner.Finish());
+
+				std::vector<UINT64> storage(32);
+				Boring32::Async::FlatMessageBuilder outer(AsBuffer(storage), FieldCount);
+				outer.AddNested(Nested, innerView);
+				const Boring32::Async::FlatMessageView view(outer.Finish());
+				Assert::IsTrue(view.GetNested(Nested).GetString(0) == "inner");
+			}
+
+			TEST_METHOD(TestBufferTooSmall)
+			{
+				std::vector<UINT64> storage(6);
+				Boring32::Async::FlatMessageBuilder builder(AsBuffer(storage), FieldCount);
+				builder.Add(Id, static_cast<UINT64>(1));
+				Assert::ExpectException<std::length_error>(
+					[&builder]() { builder.AddString(Name, std::string_view("this string does not fit")); }
+				);
+				Assert::ExpectException<std::out_of_range>(
+					[&builder]() { builder.Add(FieldCount, 1); }
+				);
+
+				// Fields added before the failure are kept
+				const Boring32::Async::FlatMessageView view(builder.Finish());
+				Assert::AreEqual(static_cast<UINT64>(1), *view.Get<UINT64>(Id));
+				Assert::IsFalse(view.Has(Name));
+			}
+
+			TEST_METHOD(TestInvalidBuffers)
+			{
+				std::vector<UINT64> storage(16);
+				Boring32::Async::FlatMessageBuilder builder(AsBuffer(storage), FieldCount);
+				builder.AddString(Name, std::string_view("truncated"));
+				const std::span<std::byte> message = builder.Finish();
+
+				Assert::ExpectException<std::invalid_argument>(
+					[&message]() { Boring32::Async::FlatMessageView view(message.first(message.size() - 8)); }
+				);
+				Assert::ExpectException<std::invalid_argument>(
+					[&message]() { Boring32::Async::FlatMessageView view(message.subspan(8)); }
+				);
+
+				// A corrupt array length is caught when the field is read
+				const Boring32::Async::FlatMessageView view(message);
+				const UINT32 offset = *reinterpret_cast<const UINT32*>(
+					message.data() + sizeof(Boring32::Async::FlatMessageHeader) + Name * sizeof(UINT32)
+				);
+				*reinterpret_cast<UINT32*>(message.data() + offset) = 100000;
+				Assert::ExpectException<std::out_of_range>([&view]() { view.GetString(Name); });
+			}
+	};
+}
@@ -0,0 +1,108 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <thread>
+#include <atomic>
+#include "Boring32/include/Async/FlowControl.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(FlowControl)
+	{
+		public:
+			TEST_METHOD(TestUnlimited)
+			{
+				Boring32::Async::FlowControl flowControl;
+				for (int i = 0; i < 100; i++)
+					Assert::IsTrue(flowControl.TryAcquire(1024 * 1024));
+				Assert::AreEqual((UINT64)100, flowControl.GetMessagesInFlight());
+				Assert::AreEqual((UINT64)100 * 1024 * 1024, flowControl.GetStats().PeakBytes);
+			}
+
+			TEST_METHOD(TestMessageLimit)
+			{
+				std::atomic<int> notified = 0;
+				Boring32::Async::FlowControl flowControl(
+					Boring32::Async::FlowControlSettings{ .MaxMessages = 2 },
+					[&notified]() { notified++; }
+				);
+				Assert::IsTrue(flowControl.TryAcquire(10));
+				Assert::IsTrue(flowControl.TryAcquire(10));
+				Assert::IsFalse(flowControl.TryAcquire(10));
+				Assert::AreEqual(0, notified.load());
+
+				flowControl.Release(10);
+				Assert::AreEqual(1, notified.load());
+				Assert::IsTrue(flowControl.TryAcquire(10));
+				// Only a refusal arms the notification
+				flowControl.Release(10);
+				Assert::AreEqual(1, notified.load());
+			}
+
+			TEST_METHOD(TestByteLimit)
+			{
+				Boring32::Async::FlowControl flowControl(
+					Boring32::Async::FlowControlSettings{ .MaxBytes = 100 }
+				);
+				Assert::IsTrue(flowControl.TryAcquire(60));
+				Assert::IsFalse(flowControl.TryAcquire(60));
+				Assert::IsTrue(flowControl.TryAcquire(40));
+				flowControl.Release(60);
+				flowControl.Release(40);
+
+				// An oversized message goes through once nothing is in flight
+				Assert::IsTrue(flowControl.TryAcquire(500));
+				Assert::IsFalse(flowControl.TryAcquire(1));
+				Assert::AreEqual((UINT64)500, flowControl.GetBytesInFlight());
+			}
+
+			TEST_METHOD(TestAcquireWaitsForRelease)
+			{
+				Boring32::Async::FlowControl flowControl(
+					Boring32::Async::FlowControlSettings{ .MaxMessages = 1 }
+				);
+				Assert::IsTrue(flowControl.Acquire(1, 0));
+				std::thread releaser(
+					[&flowControl]()
+					{
+						Sleep(50);
+						flowControl.Release(1);
+					});
+				Assert::IsTrue(flowControl.Acquire(1, INFINITE));
+				releaser.join();
+
+				const Boring32::Async::FlowControlStats stats = flowControl.GetStats();
+				Assert::AreEqual((UINT64)1, stats.Stalls);
+				Assert::IsTrue(stats.StalledMicroseconds >= 30 * 1000);
+			}
+
+			TEST_METHOD(TestAcquireTimesOut)
+			{
+				Boring32::Async::FlowControl flowControl(
+					Boring32::Async::FlowControlSettings{ .MaxMessages = 1 }
+				);
+				Assert::IsTrue(flowControl.Acquire(1, 0));
+				Assert::IsFalse(flowControl.Acquire(1, 20));
+				Assert::AreEqual((UINT64)1, flowControl.GetMessagesInFlight());
+			}
+
+			TEST_METHOD(TestCancelWakesWaiters)
+			{
+				Boring32::Async::FlowControl flowControl(
+					Boring32::Async::FlowControlSettings{ .MaxMessages = 1 }
+				);
+				Assert::IsTrue(flowControl.Acquire(1, 0));
+				std::thread canceller(
+					[&flowControl]()
+					{
+						Sleep(20);
+						flowControl.Cancel();
+					});
+				Assert::IsFalse(flowControl.Acquire(1, INFINITE));
+				canceller.join();
+				Assert::IsTrue(flowControl.IsCancelled());
+				Assert::IsFalse(flowControl.TryAcquire(1));
+			}
+	};
+}
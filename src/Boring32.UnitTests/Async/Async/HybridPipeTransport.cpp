@@ -0,0 +1,150 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include "Boring32/include/Async/Pipes/OverlappedNamedPipeServer.hpp"
+#include "Boring32/include/Async/Pipes/OverlappedNamedPipeClient.hpp"
+#include "Boring32/include/Async/Pipes/HybridPipeTransport.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(HybridPipeTransport)
+	{
+		// The pipe classes recreate the pipe when moved, so these are
+		// constructed in place
+		struct ConnectedPipes
+		{
+			ConnectedPipes(const std::wstring& name)
+			:	Server(name, 64 * 1024, 1, L"", false, true),
+				Client(name),
+				SharedMemoryName(L"Boring32.UnitTests.HybridPipeTransport." + name)
+			{ }
+
+			Boring32::Async::OverlappedNamedPipeServer Server;
+			Boring32::Async::OverlappedNamedPipeClient Client;
+			std::wstring SharedMemoryName;
+		};
+
+		static std::unique_ptr<ConnectedPipes> Connect()
+		{
+			static std::atomic<int> counter = 0;
+			const std::wstring name =
+				L"Boring32.UnitTests.HybridPipeTransport."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ L"."
+				+ std::to_wstring(counter++);
+
+			auto pipes = std::make_unique<ConnectedPipes>(name);
+			Boring32::Async::OverlappedOp connectOp;
+			pipes->Server.Connect(connectOp);
+			pipes->Client.Connect(0);
+			if (connectOp.LastError() != ERROR_PIPE_CONNECTED)
+				connectOp.WaitForCompletion(INFINITE);
+			return pipes;
+		}
+
+		static std::vector<std::byte> MakePayload(const size_t size, const int seed)
+		{
+			std::vector<std::byte> payload(size);
+			for (size_t i = 0; i < size; i++)
+				payload[i] = (std::byte)((i + seed) & 0xFF);
+			return payload;
+		}
+
+		static bool Matches(const Boring32::Async::HybridPipeMessage& message, const std::vector<std::byte>& expected)
+		{
+			return message.IsValid()
+				&& message.GetSize() == expected.size()
+				&& std::equal(expected.begin(), expected.end(), message.GetData().begin());
+		}
+
+		public:
+			TEST_METHOD(TestSmallPayloadIsInline)
+			{
+				auto pipes = Connect();
+				Boring32::Async::HybridPipeTransport server(pipes->Server, pipes->SharedMemoryName);
+				Boring32::Async::HybridPipeTransport client(pipes->Client, pipes->SharedMemoryName);
+
+				const std::vector<std::byte> payload = MakePayload(1000, 1);
+				client.Send(payload);
+				Boring32::Async::HybridPipeMessage message = server.Receive(INFINITE);
+				Assert::IsTrue(Matches(message, payload));
+				Assert::IsFalse(message.IsShared());
+			}
+
+			TEST_METHOD(TestLargePayloadIsShared)
+			{
+				auto pipes = Connect();
+				Boring32::Async::HybridPipeTransport server(pipes->Server, pipes->SharedMemoryName);
+				Boring32::Async::HybridPipeTransport client(pipes->Client, pipes->SharedMemoryName);
+
+				const std::vector<std::byte> payload = MakePayload(1024 * 1024 + 1, 2);
+				client.Send(payload);
+				Assert::AreEqual(client.GetSlabCount() - 17, client.GetFreeSlabCount());
+
+				Boring32::Async::HybridPipeMessage message = server.Receive(INFINITE);
+				Assert::IsTrue(Matches(message, payload));
+				Assert::IsTrue(message.IsShared());
+				message.Release();
+				Assert::IsFalse(message.IsValid());
+
+				// The client picks up the returned slabs when it next reads
+				Assert::IsFalse(client.Receive(100).IsValid());
+				Assert::AreEqual(client.GetSlabCount(), client.GetFreeSlabCount());
+			}
+
+			TEST_METHOD(TestSenderWaitsForSlabs)
+			{
+				auto pipes = Connect();
+				const Boring32::Async::HybridPipeTransportSettings settings{
+					.SharedMemorySize = 1024 * 1024
+				};
+				Boring32::Async::HybridPipeTransport server(pipes->Server, pipes->SharedMemoryName, settings);
+				Boring32::Async::HybridPipeTransport client(pipes->Client, pipes->SharedMemoryName, settings);
+
+				// Only one payload fits in shared memory at a time, so each
+				// send after the first waits for the previous to be released
+				const std::vector<std::vector<std::byte>> payloads{
+					MakePayload(600 * 1024, 3),
+					MakePayload(600 * 1024, 4),
+					MakePayload(600 * 1024, 5)
+				};
+				std::atomic<bool> sendsSucceeded = true;
+				std::thread sender(
+					[&client, &payloads, &sendsSucceeded]()
+					{
+						for (const std::vector<std::byte>& payload : payloads)
+							if (client.Send(payload, std::nothrow) == false)
+								sendsSucceeded = false;
+					});
+				for (const std::vector<std::byte>& payload : payloads)
+				{
+					Boring32::Async::HybridPipeMessage message = server.Receive(INFINITE);
+					Assert::IsTrue(Matches(message, payload));
+				}
+				sender.join();
+				Assert::IsTrue(sendsSucceeded);
+			}
+
+			TEST_METHOD(TestOversizedSendThrows)
+			{
+				auto pipes = Connect();
+				const Boring32::Async::HybridPipeTransportSettings settings{
+					.SharedMemorySize = 1024 * 1024
+				};
+				Boring32::Async::HybridPipeTransport server(pipes->Server, pipes->SharedMemoryName, settings);
+				Boring32::Async::HybridPipeTransport client(pipes->Client, pipes->SharedMemoryName, settings);
+				const std::vector<std::byte> payload = MakePayload(2 * 1024 * 1024, 0);
+				Assert::ExpectException<std::invalid_argument>(
+					[&client, &payload]()
+					{
+						client.Send(payload);
+					});
+			}
+	};
+}
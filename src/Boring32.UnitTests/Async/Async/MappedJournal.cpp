@@ -0,0 +1,163 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstring>
+#include "Boring32/include/Async/MappedJournalWriter.hpp"
+#include "Boring32/include/Async/MappedJournalReader.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(MappedJournal)
+	{
+		std::wstring m_path;
+
+		static std::vector<std::byte> ToBytes(const std::string& value)
+		{
+			std::vector<std::byte> bytes(value.size());
+			std::memcpy(bytes.data(), value.data(), value.size());
+			return bytes;
+		}
+
+		public:
+			TEST_METHOD_INITIALIZE(Initialize)
+			{
+				static int counter = 0;
+				wchar_t tempPath[MAX_PATH + 1]{ 0 };
+				GetTempPathW(MAX_PATH, tempPath);
+				m_path = std::wstring(tempPath)
+					+ L"Boring32.UnitTests.MappedJournal."
+					+ std::to_wstring(GetCurrentProcessId())
+					+ L"."
+					+ std::to_wstring(counter++);
+			}
+
+			TEST_METHOD_CLEANUP(Cleanup)
+			{
+				for (UINT64 i = 0; Boring32::Async::MappedJournalSegment::Exists(m_path, i); i++)
+					DeleteFileW(Boring32::Async::MappedJournalSegment::GetSegmentPath(m_path, i).c_str());
+			}
+
+			TEST_METHOD(TestAppendAndRead)
+			{
+				Boring32::Async::MappedJournalWriter writer(m_path);
+				Boring32::Async::MappedJournalReader reader(m_path);
+				std::vector<std::byte> record;
+				Assert::IsFalse(reader.TryRead(record));
+
+				writer.Append(ToBytes("first"));
+				writer.Append(ToBytes(""));
+				writer.Append(ToBytes("third"));
+				Assert::IsTrue(reader.TryRead(record));
+				Assert::IsTrue(record == ToBytes("first"));
+				Assert::IsTrue(reader.TryRead(record));
+				Assert::IsTrue(record.empty());
+				Assert::IsTrue(reader.TryRead(record));
+				Assert::IsTrue(record == ToBytes("third"));
+				Assert::IsFalse(reader.TryRead(record));
+			}
+
+			TEST_METHOD(TestAbandonedRecordIsSkipped)
+			{
+				const Boring32::Async::MappedJournalSettings settings{ .CommitTimeout = 100 };
+				Boring32::Async::MappedJournalWriter writer(m_path, settings);
+				Boring32::Async::MappedJournalReader reader(m_path, settings);
+				// Stands in for a writer that dies after reserving a record
+				Boring32::Async::MappedJournalSegment abandoned(m_path, 0, settings.SegmentSize, true);
+
+				writer.Append(ToBytes("first"));
+				Assert::IsTrue(abandoned.Reserve(6).has_value());
+				writer.Append(ToBytes("third"));
+
+				std::vector<std::byte> record;
+				Assert::IsTrue(reader.TryRead(record));
+				Assert::IsTrue(record == ToBytes("first"));
+				Assert::IsFalse(reader.TryRead(record));
+				Sleep(200);
+				Assert::IsTrue(reader.TryRead(record));
+				Assert::IsTrue(record == ToBytes("third"));
+				Assert::IsFalse(reader.TryRead(record));
+			}
+
+			TEST_METHOD(TestCorruptLengthThrows)
+			{
+				Boring32::Async::MappedJournalSegment segment(m_path, 0, Boring32::Async::MappedJournalSettings{}.SegmentSize, true);
+				const std::optional<UINT64> offset = segment.Reserve(5);
+				Assert::IsTrue(offset.has_value());
+				segment.Commit(*offset, 0x7FFFFFFF);
+
+				Boring32::Async::MappedJournalReader reader(m_path);
+				std::vector<std::byte> record;
+				Assert::ExpectException<std::runtime_error>(
+					[&reader, &record]() { reader.TryRead(record); }
+				);
+			}
+
+			TEST_METHOD(TestSegmentRollover)
+			{
+				const Boring32::Async::MappedJournalSettings settings{ .SegmentSize = 4096, .Durable = true };
+				Boring32::Async::MappedJournalWriter writer(m_path, settings);
+				for (int i = 0; i < 20; i++)
+					writer.Append(std::vector<std::byte>(1000, static_cast<std::byte>(i)));
+				Assert::IsTrue(writer.GetSegmentIndex() >= 5);
+				Assert::ExpectException<std::invalid_argument>(
+					[&writer]() { writer.Append(std::vector<std::byte>(writer.GetMaxRecordSize() + 1)); }
+				);
+
+				// A new writer continues from the last segment
+				Boring32::Async::MappedJournalWriter second(m_path, settings);
+				Assert::AreEqual(writer.GetSegmentIndex(), second.GetSegmentIndex());
+				second.Append(std::vector<std::byte>(1000, std::byte{ 20 }));
+
+				Boring32::Async::MappedJournalReader reader(m_path, settings);
+				std::vector<std::byte> record;
+				for (int i = 0; i < 21; i++)
+				{
+					Assert::IsTrue(reader.TryRead(record));
+					Assert::IsTrue(record == std::vector<std::byte>(1000, static_cast<std::byte>(i)));
+				}
+				Assert::IsFalse(reader.TryRead(record));
+			}
+
+			TEST_METHOD(TestConcurrentWriters)
+			{
+				constexpr int Threads = 4;
+				constexpr int RecordsPerThread = 2000;
+				const Boring32::Async::MappedJournalSettings settings{ .SegmentSize = 16 * 1024 };
+
+				std::vector<std::thread> threads;
+				for (int t = 0; t < Threads; t++)
+				{
+					threads.emplace_back(
+						[this, t, &settings]()
+						{
+							Boring32::Async::MappedJournalWriter writer(m_path, settings);
+							for (int i = 0; i < RecordsPerThread; i++)
+							{
+								const int value[2]{ t, i };
+								writer.Append(std::as_bytes(std::span(value)));
+							}
+						});
+				}
+				for (std::thread& thread : threads)
+					thread.join();
+
+				Boring32::Async::MappedJournalReader reader(m_path, settings);
+				std::vector<int> next(Threads, 0);
+				std::vector<std::byte> record;
+				while (reader.TryRead(record))
+				{
+					Assert::AreEqual(sizeof(int) * 2, record.size());
+					int value[2]{ 0 };
+					std::memcpy(value, record.data(), sizeof(value));
+					// Each writer's records appear in the order it appended them
+					Assert::AreEqual(next[value[0]]++, value[1]);
+				}
+				for (const int count : next)
+					Assert::AreEqual(RecordsPerThread, count);
+			}
+	};
+}
@@ -0,0 +1,62 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <cstring>
+#include "Boring32/include/Async/MemoryMappedFile.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(MemoryMappedFile)
+	{
+		static std::wstring MakeName()
+		{
+			static int counter = 0;
+			return L"Boring32.UnitTests.MemoryMappedFile."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ L"."
+				+ std::to_wstring(counter++);
+		}
+
+		public:
+			TEST_METHOD(TestPrefaultAndHints)
+			{
+				Boring32::Async::MemoryMappedFile mmf(
+					MakeName(),
+					1024 * 1024,
+					false,
+					Boring32::Async::MemoryMappedFileOptions{ .Prefault = true }
+				);
+				Assert::AreEqual(1024u * 1024u, mmf.GetSize());
+				Assert::IsFalse(mmf.UsesLargePages());
+
+				std::memset(mmf.GetViewPointer(), 0x7F, mmf.GetSize());
+				mmf.Evict(0, mmf.GetSize());
+				Assert::IsTrue(mmf.Prefetch(0, mmf.GetSize(), std::nothrow));
+				Assert::AreEqual(0x7F, (int)static_cast<unsigned char*>(mmf.GetViewPointer())[mmf.GetSize() - 1]);
+				Assert::ExpectException<std::out_of_range>([&mmf]() { mmf.Prefetch(1, mmf.GetSize()); });
+			}
+
+			TEST_METHOD(TestLargePagesFallback)
+			{
+				// Whether large pages are granted depends on the account, so
+				// only check that fallback always yields a usable view.
+				Boring32::Async::MemoryMappedFile mmf(
+					MakeName(),
+					4096,
+					false,
+					Boring32::Async::MemoryMappedFileOptions{ .LargePages = true }
+				);
+				Assert::IsNotNull(mmf.GetViewPointer());
+				if (mmf.UsesLargePages())
+					Assert::IsTrue(mmf.GetSize() % GetLargePageMinimum() == 0);
+				else
+					Assert::AreEqual(4096u, mmf.GetSize());
+
+				Boring32::Async::MemoryMappedFile copy(mmf);
+				static_cast<char*>(mmf.GetViewPointer())[0] = 'x';
+				Assert::AreEqual('x', static_cast<char*>(copy.GetViewPointer())[0]);
+			}
+	};
+}
@@ -0,0 +1,109 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <vector>
+#include "Boring32/include/Async/MemoryMappedVector.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(MemoryMappedVector)
+	{
+		struct Point
+		{
+			int X;
+			int Y;
+		};
+
+		std::wstring m_path;
+
+		public:
+			TEST_METHOD_INITIALIZE(Initialize)
+			{
+				static int counter = 0;
+				wchar_t tempPath[MAX_PATH + 1]{ 0 };
+				GetTempPathW(MAX_PATH, tempPath);
+				m_path = std::wstring(tempPath)
+					+ L"Boring32.UnitTests.MemoryMappedVector."
+					+ std::to_wstring(GetCurrentProcessId())
+					+ L"."
+					+ std::to_wstring(counter++)
+					+ L".bin";
+			}
+
+			TEST_METHOD_CLEANUP(Cleanup)
+			{
+				DeleteFileW(m_path.c_str());
+			}
+
+			TEST_METHOD(TestAppendGrowsAndPersists)
+			{
+				{
+					Boring32::Async::MemoryMappedVector<Point> points(m_path, { .InitialCapacity = 4 });
+					Assert::IsTrue(points.IsEmpty());
+					points.Append({ 1, 2 });
+					std::vector<Point> more;
+					for (int i = 0; i < 100; i++)
+						more.push_back({ i, -i });
+					points.Append(more);
+					Assert::AreEqual(size_t(101), points.GetSize());
+					Assert::IsTrue(points.GetCapacity() >= 101);
+					points.Flush();
+				}
+
+				Boring32::Async::MemoryMappedVector<Point> reopened(m_path);
+				Assert::AreEqual(size_t(101), reopened.GetSize());
+				Assert::AreEqual(1, reopened[0].X);
+				Assert::AreEqual(-99, reopened.GetData().back().Y);
+				reopened.Clear();
+				Assert::IsTrue(reopened.IsEmpty());
+			}
+
+			TEST_METHOD(TestReadOnly)
+			{
+				{
+					Boring32::Async::MemoryMappedVector<int> values(m_path);
+					values.Append(42);
+				}
+				Boring32::Async::MemoryMappedVector<int> readOnly(m_path, { .ReadOnly = true });
+				Assert::AreEqual(42, readOnly.GetData()[0]);
+				Assert::ExpectException<std::runtime_error>([&readOnly]() { readOnly.Append(1); });
+			}
+
+			TEST_METHOD(TestReaderWhileWriterGrows)
+			{
+				Boring32::Async::MemoryMappedVector<int> writer(m_path, { .InitialCapacity = 4 });
+				writer.Append(1);
+				writer.Append(2);
+				Boring32::Async::MemoryMappedVector<int> reader(m_path, { .ReadOnly = true });
+				Assert::AreEqual(size_t(2), reader.GetSize());
+				Assert::IsFalse(reader.Refresh());
+
+				// The writer outgrows the reader's view, which only exposes
+				// what it has mapped until it is refreshed
+				std::vector<int> more(1000);
+				for (int i = 0; i < 1000; i++)
+					more[i] = i + 3;
+				writer.Append(more);
+				Assert::AreEqual(size_t(4), reader.GetSize());
+				Assert::AreEqual(4, reader.GetData().back());
+
+				Assert::IsTrue(reader.Refresh());
+				Assert::AreEqual(size_t(1002), reader.GetSize());
+				Assert::AreEqual(1002, reader.GetData().back());
+				Assert::AreEqual(500, reader[499]);
+			}
+
+			TEST_METHOD(TestTypeMismatch)
+			{
+				{
+					Boring32::Async::MemoryMappedVector<int> values(m_path);
+					values.Append(1);
+				}
+				Assert::ExpectException<std::runtime_error>(
+					[this]() { Boring32::Async::MemoryMappedVector<Point> points(m_path); }
+				);
+			}
+	};
+}
@@ -0,0 +1,188 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include "Boring32/include/Async/OverlappedPool.hpp"
+#include "Boring32/include/Async/Pipes/OverlappedNamedPipeServer.hpp"
+#include "Boring32/include/Async/Pipes/OverlappedNamedPipeClient.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(OverlappedPool)
+	{
+		// The pipe classes recreate the pipe when moved, so these are
+		// constructed in place
+		struct Pipes
+		{
+			Pipes(const std::wstring& name)
+			:	Server(name, 4096, 1, L"", false, true),
+				Client(name)
+			{ }
+
+			Boring32::Async::OverlappedNamedPipeServer Server;
+			Boring32::Async::OverlappedNamedPipeClient Client;
+		};
+
+		static std::unique_ptr<Pipes> MakePipes()
+		{
+			static std::atomic<int> counter = 0;
+			return std::make_unique<Pipes>(
+				L"Boring32.UnitTests.OverlappedPool."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ L"."
+				+ std::to_wstring(counter++)
+			);
+		}
+
+		static std::wstring ReadMessage(
+			Boring32::Async::OverlappedLease& lease,
+			std::wstring& buffer
+		)
+		{
+			Assert::IsTrue(lease.WaitForCompletion(5000));
+			Assert::IsTrue(lease.IsSuccessful());
+			return buffer.substr(0, (size_t)lease.GetBytesTransferred() / sizeof(wchar_t));
+		}
+
+		public:
+			TEST_METHOD(TestInitialCount)
+			{
+				Boring32::Async::OverlappedPool pool(4);
+				Assert::IsTrue(pool.GetAllocatedCount() == 4);
+				Assert::IsTrue(pool.GetAvailableCount() == 4);
+			}
+
+			TEST_METHOD(TestAcquireReusesSlots)
+			{
+				Boring32::Async::OverlappedPool pool(1);
+				OVERLAPPED* first = nullptr;
+				{
+					Boring32::Async::OverlappedLease lease = pool.Acquire();
+					Assert::IsTrue(pool.GetAvailableCount() == 0);
+					first = lease.GetOverlapped();
+				}
+				Assert::IsTrue(pool.GetAvailableCount() == 1);
+				Boring32::Async::OverlappedLease lease = pool.Acquire();
+				Assert::IsTrue(lease.GetOverlapped() == first);
+				Assert::IsTrue(pool.GetAllocatedCount() == 1);
+			}
+
+			TEST_METHOD(TestAcquireGrowsPool)
+			{
+				Boring32::Async::OverlappedPool pool(1);
+				Boring32::Async::OverlappedLease first = pool.Acquire();
+				Boring32::Async::OverlappedLease second = pool.Acquire();
+				Assert::IsTrue(first.GetOverlapped() != second.GetOverlapped());
+				Assert::IsTrue(pool.GetAllocatedCount() == 2);
+			}
+
+			TEST_METHOD(TestLeaseIsReset)
+			{
+				Boring32::Async::OverlappedPool pool(1);
+				{
+					Boring32::Async::OverlappedLease lease = pool.Acquire();
+					lease.GetOverlapped()->Internal = 1234;
+					lease.GetOverlapped()->InternalHigh = 5678;
+					SetEvent(lease.GetWaitableHandle());
+				}
+				Boring32::Async::OverlappedLease lease = pool.Acquire();
+				Assert::IsTrue(lease.GetOverlapped()->Internal == 0);
+				Assert::IsTrue(lease.GetBytesTransferred() == 0);
+				Assert::IsTrue(lease.GetOverlapped()->hEvent == lease.GetWaitableHandle());
+				Assert::IsFalse(lease.WaitForCompletion(0));
+			}
+
+			TEST_METHOD(TestMoveAndRelease)
+			{
+				Boring32::Async::OverlappedPool pool(1);
+				Boring32::Async::OverlappedLease first = pool.Acquire();
+				Boring32::Async::OverlappedLease second(std::move(first));
+				Assert::IsFalse(first.IsValid());
+				Assert::IsTrue(second.IsValid());
+				Assert::IsTrue(pool.GetAvailableCount() == 0);
+				second.Release();
+				Assert::IsFalse(second.IsValid());
+				Assert::IsTrue(pool.GetAvailableCount() == 1);
+				Assert::ExpectException<std::runtime_error>([&second]() { second.GetOverlapped(); });
+			}
+
+			TEST_METHOD(TestConcurrentAcquire)
+			{
+				Boring32::Async::OverlappedPool pool(2);
+				std::vector<std::thread> threads;
+				for (int t = 0; t < 4; t++)
+				{
+					threads.emplace_back(
+						[&pool]()
+						{
+							for (int i = 0; i < 10000; i++)
+								Boring32::Async::OverlappedLease lease = pool.Acquire();
+						});
+				}
+				for (std::thread& thread : threads)
+					thread.join();
+				Assert::IsTrue(pool.GetAllocatedCount() <= 4);
+				Assert::IsTrue(pool.GetAvailableCount() == pool.GetAllocatedCount());
+			}
+
+			TEST_METHOD(TestLeaseConnectBeforeClient)
+			{
+				Boring32::Async::OverlappedPool pool(1);
+				auto pipes = MakePipes();
+				Boring32::Async::OverlappedLease lease = pool.Acquire();
+				pipes->Server.Connect(lease);
+				Assert::IsTrue(lease.LastError() == ERROR_IO_PENDING);
+				Assert::IsFalse(lease.WaitForCompletion(0));
+				pipes->Client.Connect(0);
+				Assert::IsTrue(lease.WaitForCompletion(5000));
+				Assert::IsTrue(lease.IsSuccessful());
+			}
+
+			TEST_METHOD(TestLeaseConnectAfterClient)
+			{
+				// The client connecting first completes the connect
+				// immediately, which must still signal the lease
+				Boring32::Async::OverlappedPool pool(1);
+				auto pipes = MakePipes();
+				pipes->Client.Connect(0);
+				Boring32::Async::OverlappedLease lease = pool.Acquire();
+				pipes->Server.Connect(lease);
+				Assert::IsTrue(lease.LastError() == ERROR_PIPE_CONNECTED);
+				Assert::IsTrue(lease.WaitForCompletion(0));
+				Assert::IsTrue(lease.IsSuccessful());
+			}
+
+			TEST_METHOD(TestLeaseWriteReadRoundTrip)
+			{
+				Boring32::Async::OverlappedPool pool(2);
+				auto pipes = MakePipes();
+				pipes->Client.Connect(0);
+				Boring32::Async::OverlappedLease connectLease = pool.Acquire();
+				pipes->Server.Connect(connectLease);
+				Assert::IsTrue(connectLease.WaitForCompletion(5000));
+				connectLease.Release();
+
+				Boring32::Async::OverlappedLease writeLease = pool.Acquire();
+				Boring32::Async::OverlappedLease readLease = pool.Acquire();
+				std::wstring buffer(64, L'\0');
+
+				pipes->Server.Write(L"to the client", writeLease);
+				pipes->Client.Read(buffer, readLease);
+				Assert::IsTrue(writeLease.WaitForCompletion(5000));
+				Assert::IsTrue(writeLease.IsSuccessful());
+				Assert::IsTrue(ReadMessage(readLease, buffer) == L"to the client");
+
+				// The same leases are reused for the other direction
+				pipes->Client.Write(L"to the server", writeLease);
+				pipes->Server.Read(buffer, readLease);
+				Assert::IsTrue(writeLease.WaitForCompletion(5000));
+				Assert::IsTrue(writeLease.IsSuccessful());
+				Assert::IsTrue(ReadMessage(readLease, buffer) == L"to the server");
+				Assert::IsTrue(pool.GetAllocatedCount() == 2);
+			}
+	};
+}
@@ -0,0 +1,253 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include "Boring32/include/Async/Pipes/OverlappedNamedPipeServer.hpp"
+#include "Boring32/include/Async/Pipes/OverlappedNamedPipeClient.hpp"
+#include "Boring32/include/Async/Pipes/PipeFrameChannel.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(PipeFrameChannel)
+	{
+		// The pipe classes recreate the pipe when moved, so these are
+		// constructed in place
+		struct ConnectedPipes
+		{
+			ConnectedPipes(const std::wstring& name)
+			:	Server(name, 4096, 1, L"", false, true),
+				Client(name)
+			{ }
+
+			Boring32::Async::OverlappedNamedPipeServer Server;
+			Boring32::Async::OverlappedNamedPipeClient Client;
+		};
+
+		static std::unique_ptr<ConnectedPipes> Connect()
+		{
+			static std::atomic<int> counter = 0;
+			const std::wstring name =
+				L"Boring32.UnitTests.PipeFrameChannel."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ L"."
+				+ std::to_wstring(counter++);
+
+			auto pipes = std::make_unique<ConnectedPipes>(name);
+			Boring32::Async::OverlappedOp connectOp;
+			pipes->Server.Connect(connectOp);
+			pipes->Client.Connect(0);
+			if (connectOp.LastError() != ERROR_PIPE_CONNECTED)
+				connectOp.WaitForCompletion(INFINITE);
+			return pipes;
+		}
+
+		static std::vector<std::byte> MakePayload(const size_t size, const int seed)
+		{
+			std::vector<std::byte> payload(size);
+			for (size_t i = 0; i < size; i++)
+				payload[i] = (std::byte)((i + seed) & 0xFF);
+			return payload;
+		}
+
+		static bool Matches(const Boring32::Async::PipeFrame& frame, const std::vector<std::byte>& expected)
+		{
+			return frame.IsValid()
+				&& frame.GetSize() == expected.size()
+				&& std::equal(expected.begin(), expected.end(), frame.GetData().begin());
+		}
+
+		public:
+			TEST_METHOD(TestSendReceive)
+			{
+				auto pipes = Connect();
+				Boring32::Async::PipeFrameChannel server(pipes->Server);
+				Boring32::Async::PipeFrameChannel client(pipes->Client);
+
+				const std::vector<std::byte> empty;
+				const std::vector<std::byte> small = MakePayload(10, 1);
+				const std::vector<std::byte> medium = MakePayload(1000, 2);
+				client.Send(empty);
+				client.Send(small);
+				client.Send(medium);
+
+				Boring32::Async::PipeFrame first = server.Receive(INFINITE);
+				Boring32::Async::PipeFrame second = server.Receive(INFINITE);
+				Boring32::Async::PipeFrame third = server.Receive(INFINITE);
+				Assert::IsTrue(Matches(first, empty));
+				Assert::IsTrue(Matches(second, small));
+				Assert::IsTrue(Matches(third, medium));
+			}
+
+			TEST_METHOD(TestLargeFrame)
+			{
+				auto pipes = Connect();
+				Boring32::Async::PipeFrameChannelSettings settings{
+					.BufferSize = 256 * 1024,
+					.MaxBuffers = 2
+				};
+				Boring32::Async::PipeFrameChannel server(pipes->Server, settings);
+				Boring32::Async::PipeFrameChannel client(pipes->Client, settings);
+
+				// Larger than the pipe's buffer, so it has to be sent and
+				// received concurrently
+				const std::vector<std::byte> payload = MakePayload(200 * 1024, 3);
+				std::thread sender([&client, &payload]() { client.Send(payload); });
+				Boring32::Async::PipeFrame frame = server.Receive(INFINITE);
+				sender.join();
+				Assert::IsTrue(Matches(frame, payload));
+			}
+
+			TEST_METHOD(TestFrameHoldsBufferUntilReleased)
+			{
+				auto pipes = Connect();
+				Boring32::Async::PipeFrameChannelSettings settings{
+					.BufferSize = 64,
+					.MaxBuffers = 1
+				};
+				Boring32::Async::PipeFrameChannel server(pipes->Server, settings);
+				Boring32::Async::PipeFrameChannel client(pipes->Client, settings);
+
+				const std::vector<std::byte> first = MakePayload(40, 4);
+				const std::vector<std::byte> second = MakePayload(40, 5);
+				client.Send(first);
+				client.Send(second);
+
+				// The second frame doesn't fit behind the first, and the only
+				// buffer is held by the first frame
+				Boring32::Async::PipeFrame firstFrame = server.Receive(INFINITE);
+				Assert::IsTrue(Matches(firstFrame, first));
+				Assert::IsFalse(server.Receive(50).IsValid());
+				Assert::IsTrue(server.IsConnected());
+
+				firstFrame.Release();
+				Assert::IsFalse(firstFrame.IsValid());
+				Assert::IsTrue(Matches(server.Receive(INFINITE), second));
+			}
+
+			TEST_METHOD(TestReceiveTimesOut)
+			{
+				auto pipes = Connect();
+				Boring32::Async::PipeFrameChannel server(pipes->Server);
+				Assert::IsFalse(server.Receive(10).IsValid());
+				Assert::IsTrue(server.IsConnected());
+			}
+
+			TEST_METHOD(TestReceiveAfterDisconnect)
+			{
+				auto pipes = Connect();
+				Boring32::Async::PipeFrameChannel server(pipes->Server);
+				pipes->Client.Close();
+				Assert::IsFalse(server.Receive(INFINITE).IsValid());
+				Assert::IsFalse(server.IsConnected());
+			}
+
+			TEST_METHOD(TestOversizedSendThrows)
+			{
+				auto pipes = Connect();
+				Boring32::Async::PipeFrameChannelSettings settings{ .BufferSize = 64 };
+				Boring32::Async::PipeFrameChannel client(pipes->Client, settings);
+				const std::vector<std::byte> payload = MakePayload(client.GetMaxFrameSize() + 1, 0);
+				Assert::ExpectException<std::invalid_argument>(
+					[&client, &payload]()
+					{
+						client.Send(payload);
+					});
+			}
+
+			TEST_METHOD(TestBatchedFramesAreSplit)
+			{
+				auto pipes = Connect();
+				Boring32::Async::PipeFrameChannelSettings settings{
+					.BatchSize = 1024,
+					.BatchDelayMicroseconds = 0
+				};
+				Boring32::Async::PipeFrameChannel server(pipes->Server);
+				Boring32::Async::PipeFrameChannel client(pipes->Client, settings);
+
+				std::vector<std::vector<std::byte>> payloads;
+				for (int i = 0; i < 100; i++)
+					payloads.push_back(MakePayload(i % 20, i));
+				for (const std::vector<std::byte>& payload : payloads)
+					client.Send(payload);
+				// With no delay, the last partial batch waits for Flush()
+				Assert::IsFalse(server.Receive(10).IsValid());
+				client.Flush();
+
+				for (const std::vector<std::byte>& payload : payloads)
+					Assert::IsTrue(Matches(server.Receive(INFINITE), payload));
+				Assert::AreEqual(100ull, client.GetFramesSent());
+				Assert::IsTrue(client.GetWriteCalls() < 10);
+			}
+
+			TEST_METHOD(TestBatchDelayFlushes)
+			{
+				auto pipes = Connect();
+				Boring32::Async::PipeFrameChannelSettings settings{
+					.BatchSize = 16 * 1024,
+					.BatchDelayMicroseconds = 200
+				};
+				Boring32::Async::PipeFrameChannel server(pipes->Server);
+				Boring32::Async::PipeFrameChannel client(pipes->Client, settings);
+
+				const std::vector<std::byte> payload = MakePayload(10, 6);
+				client.Send(payload);
+				Assert::IsTrue(Matches(server.Receive(1000), payload));
+			}
+
+			TEST_METHOD(TestBatchDelayDoesNotBlockSend)
+			{
+				auto pipes = Connect();
+				Boring32::Async::PipeFrameChannelSettings settings{
+					.BatchSize = 16 * 1024,
+					.BatchDelayMicroseconds = 200
+				};
+				Boring32::Async::PipeFrameChannel server(pipes->Server);
+				Boring32::Async::PipeFrameChannel client(pipes->Client, settings);
+
+				// The batch is larger than the pipe's buffer, so with nothing
+				// reading the pipe, the timer's write can't complete
+				const std::vector<std::byte> large = MakePayload(8000, 9);
+				const std::vector<std::byte> small = MakePayload(10, 10);
+				client.Send(large);
+				Sleep(100);
+
+				// A frame that only needs batching mustn't wait for it
+				std::atomic<bool> sent = false;
+				std::thread sender(
+					[&client, &small, &sent]()
+					{
+						client.Send(small);
+						sent = true;
+					});
+				Sleep(500);
+				const bool sentPromptly = sent;
+				Assert::IsTrue(Matches(server.Receive(INFINITE), large));
+				sender.join();
+				Assert::IsTrue(Matches(server.Receive(1000), small));
+				Assert::IsTrue(sentPromptly);
+			}
+
+			TEST_METHOD(TestLargeFrameFlushesBatch)
+			{
+				auto pipes = Connect();
+				Boring32::Async::PipeFrameChannelSettings settings{
+					.BatchSize = 256,
+					.BatchDelayMicroseconds = 0
+				};
+				Boring32::Async::PipeFrameChannel server(pipes->Server);
+				Boring32::Async::PipeFrameChannel client(pipes->Client, settings);
+
+				const std::vector<std::byte> small = MakePayload(10, 7);
+				const std::vector<std::byte> large = MakePayload(1000, 8);
+				client.Send(small);
+				client.Send(large);
+				Assert::IsTrue(Matches(server.Receive(INFINITE), small));
+				Assert::IsTrue(Matches(server.Receive(INFINITE), large));
+			}
+	};
+}
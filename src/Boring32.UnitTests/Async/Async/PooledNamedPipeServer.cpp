@@ -0,0 +1,316 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include "Boring32/include/Async/Event.hpp"
+#include "Boring32/include/Async/Pipes/PooledNamedPipeServer.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(PooledNamedPipeServer)
+	{
+		static std::wstring MakePipeName()
+		{
+			static std::atomic<int> counter = 0;
+			return L"\\\\.\\pipe\\Boring32.UnitTests.PooledNamedPipeServer."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ L"."
+				+ std::to_wstring(counter++);
+		}
+
+		static Boring32::Async::PipeSessionHandlers EchoHandlers()
+		{
+			return Boring32::Async::PipeSessionHandlers{
+				.OnMessage = [](const std::shared_ptr<Boring32::Async::PipeSession>& session, const std::span<const std::byte> message)
+				{
+					session->Write(message);
+				}
+			};
+		}
+
+		static HANDLE ConnectClient(const std::wstring& pipeName)
+		{
+			while (true)
+			{
+				HANDLE pipe = CreateFileW(
+					pipeName.c_str(),
+					GENERIC_READ | GENERIC_WRITE,
+					0,
+					nullptr,
+					OPEN_EXISTING,
+					0,
+					nullptr
+				);
+				if (pipe != INVALID_HANDLE_VALUE)
+				{
+					DWORD mode = PIPE_READMODE_MESSAGE;
+					SetNamedPipeHandleState(pipe, &mode, nullptr, nullptr);
+					return pipe;
+				}
+				Assert::IsTrue(GetLastError() == ERROR_PIPE_BUSY);
+				WaitNamedPipeW(pipeName.c_str(), 1000);
+			}
+		}
+
+		static std::string Transact(const HANDLE pipe, const std::string& request, const size_t responseSize)
+		{
+			std::string response(responseSize, '\0');
+			DWORD bytesRead = 0;
+			Assert::IsTrue(TransactNamedPipe(
+				pipe,
+				(void*)request.data(),
+				(DWORD)request.size(),
+				response.data(),
+				(DWORD)response.size(),
+				&bytesRead,
+				nullptr
+			));
+			response.resize(bytesRead);
+			return response;
+		}
+
+		public:
+			TEST_METHOD(TestInvalidSettings)
+			{
+				Assert::ExpectException<std::invalid_argument>(
+					[]()
+					{
+						Boring32::Async::PooledNamedPipeServer server(
+							MakePipeName(),
+							Boring32::Async::PooledNamedPipeServerSettings{ .PendingInstances = 0 },
+							Boring32::Async::PipeSessionHandlers{}
+						);
+					});
+				Assert::ExpectException<std::invalid_argument>(
+					[]()
+					{
+						Boring32::Async::PooledNamedPipeServer server(
+							MakePipeName(),
+							Boring32::Async::PooledNamedPipeServerSettings{ .PendingInstances = 4, .MaxInstances = 2 },
+							Boring32::Async::PipeSessionHandlers{}
+						);
+					});
+			}
+
+			TEST_METHOD(TestEcho)
+			{
+				const std::wstring pipeName = MakePipeName();
+				Boring32::Async::PooledNamedPipeServer server(pipeName, {}, EchoHandlers());
+				HANDLE client = ConnectClient(pipeName);
+				Assert::IsTrue(Transact(client, "hello", 64) == "hello");
+				Assert::IsTrue(Transact(client, "world", 64) == "world");
+				CloseHandle(client);
+			}
+
+			TEST_METHOD(TestMessageLargerThanBuffer)
+			{
+				const std::wstring pipeName = MakePipeName();
+				Boring32::Async::PooledNamedPipeServer server(pipeName, {}, EchoHandlers());
+				HANDLE client = ConnectClient(pipeName);
+				const std::string request(100 * 1024, 'x');
+				Assert::IsTrue(Transact(client, request, request.size()) == request);
+				CloseHandle(client);
+			}
+
+			TEST_METHOD(TestManyClients)
+			{
+				const std::wstring pipeName = MakePipeName();
+				Boring32::Async::PooledNamedPipeServer server(
+					pipeName,
+					Boring32::Async::PooledNamedPipeServerSettings{ .PendingInstances = 2 },
+					EchoHandlers()
+				);
+
+				std::vector<HANDLE> clients;
+				for (int i = 0; i < 50; i++)
+					clients.push_back(ConnectClient(pipeName));
+				for (int i = 0; i < 50; i++)
+				{
+					const std::string request = std::to_string(i);
+					Assert::IsTrue(Transact(clients[i], request, 64) == request);
+				}
+				Assert::IsTrue(server.GetConnectedCount() == 50);
+				Assert::IsTrue(server.GetInstanceCount() >= 52);
+
+				for (HANDLE client : clients)
+					CloseHandle(client);
+			}
+
+			TEST_METHOD(TestCloseWhileClientsChurn)
+			{
+				// Instances are recycled while Close() runs, which must wait
+				// for them rather than free them with a connect pending
+				for (int round = 0; round < 20; round++)
+				{
+					const std::wstring pipeName = MakePipeName();
+					auto server = std::make_unique<Boring32::Async::PooledNamedPipeServer>(
+						pipeName,
+						Boring32::Async::PooledNamedPipeServerSettings{ .PendingInstances = 2, .WorkerThreads = 2 },
+						EchoHandlers()
+					);
+
+					std::atomic<bool> stop = false;
+					std::vector<std::thread> clients;
+					for (int t = 0; t < 4; t++)
+					{
+						clients.emplace_back(
+							[&pipeName, &stop]()
+							{
+								while (stop == false)
+								{
+									HANDLE pipe = CreateFileW(
+										pipeName.c_str(),
+										GENERIC_READ | GENERIC_WRITE,
+										0,
+										nullptr,
+										OPEN_EXISTING,
+										0,
+										nullptr
+									);
+									if (pipe == INVALID_HANDLE_VALUE)
+									{
+										WaitNamedPipeW(pipeName.c_str(), 10);
+										continue;
+									}
+									DWORD mode = PIPE_READMODE_MESSAGE;
+									SetNamedPipeHandleState(pipe, &mode, nullptr, nullptr);
+									// Fails once the server closes, which is expected
+									char response[16];
+									DWORD bytesRead = 0;
+									TransactNamedPipe(pipe, (void*)"ping", 4, response, sizeof(response), &bytesRead, nullptr);
+									CloseHandle(pipe);
+								}
+							});
+					}
+
+					Sleep(20);
+					server->Close();
+					Assert::IsTrue(server->GetConnectedCount() == 0);
+					server = nullptr;
+					stop = true;
+					for (std::thread& client : clients)
+						client.join();
+				}
+			}
+
+			TEST_METHOD(TestMaxInstances)
+			{
+				const std::wstring pipeName = MakePipeName();
+				Boring32::Async::PooledNamedPipeServer server(
+					pipeName,
+					Boring32::Async::PooledNamedPipeServerSettings{ .PendingInstances = 1, .MaxInstances = 2 },
+					EchoHandlers()
+				);
+				HANDLE first = ConnectClient(pipeName);
+				HANDLE second = ConnectClient(pipeName);
+				Assert::IsFalse(WaitNamedPipeW(pipeName.c_str(), 100));
+
+				// Disconnecting a client returns its instance to the pool
+				CloseHandle(first);
+				HANDLE third = ConnectClient(pipeName);
+				Assert::IsTrue(Transact(third, "third", 64) == "third");
+				Assert::IsTrue(server.GetInstanceCount() == 2);
+				CloseHandle(second);
+				CloseHandle(third);
+			}
+
+			TEST_METHOD(TestSessionLifecycle)
+			{
+				// Handlers run on worker threads, so results are checked here
+				const std::wstring pipeName = MakePipeName();
+				std::atomic<int> connected = 0;
+				std::atomic<int> disconnected = 0;
+				std::atomic<DWORD> clientProcessId = 0;
+				std::atomic<bool> connectedAfterClose = true;
+				Boring32::Async::Event disconnectedEvent(false, true, false);
+				Boring32::Async::PooledNamedPipeServer server(
+					pipeName,
+					{},
+					Boring32::Async::PipeSessionHandlers{
+						.OnConnected = [&](const std::shared_ptr<Boring32::Async::PipeSession>& session)
+						{
+							connected++;
+							clientProcessId = session->GetClientProcessId();
+							session->Close();
+						},
+						.OnDisconnected = [&](const std::shared_ptr<Boring32::Async::PipeSession>& session)
+						{
+							disconnected++;
+							connectedAfterClose = session->IsConnected();
+							disconnectedEvent.Signal();
+						}
+					}
+				);
+
+				HANDLE client = ConnectClient(pipeName);
+				Assert::IsTrue(disconnectedEvent.WaitOnEvent(5000, false));
+				char buffer[16];
+				DWORD bytesRead = 0;
+				Assert::IsFalse(ReadFile(client, buffer, sizeof(buffer), &bytesRead, nullptr));
+				CloseHandle(client);
+				Assert::IsTrue(connected == 1);
+				Assert::IsTrue(disconnected == 1);
+				Assert::IsTrue(clientProcessId == GetCurrentProcessId());
+				Assert::IsFalse(connectedAfterClose);
+			}
+
+			TEST_METHOD(TestWriteLimits)
+			{
+				const std::wstring pipeName = MakePipeName();
+				std::shared_ptr<Boring32::Async::PipeSession> session;
+				std::atomic<int> writable = 0;
+				Boring32::Async::Event connectedEvent(false, true, false);
+				Boring32::Async::Event writableEvent(false, true, false);
+				Boring32::Async::PooledNamedPipeServer server(
+					pipeName,
+					Boring32::Async::PooledNamedPipeServerSettings{
+						.WriteLimits = { .MaxBytes = 16 * 1024 }
+					},
+					Boring32::Async::PipeSessionHandlers{
+						.OnConnected = [&](const std::shared_ptr<Boring32::Async::PipeSession>& connected)
+						{
+							session = connected;
+							connectedEvent.Signal();
+						},
+						.OnWritable = [&](const std::shared_ptr<Boring32::Async::PipeSession>&)
+						{
+							writable++;
+							writableEvent.Signal();
+						}
+					}
+				);
+				HANDLE client = ConnectClient(pipeName);
+				Assert::IsTrue(connectedEvent.WaitOnEvent(5000, false));
+
+				// The client isn't reading, so writes back up until the
+				// session's queue reaches its limit
+				const std::vector<std::byte> message(4096, std::byte{ 0x42 });
+				int written = 0;
+				while (written < 100 && session->Write(message, 0))
+					written++;
+				Assert::IsTrue(written < 100);
+				Assert::IsTrue(session->GetQueuedBytes() <= 16 * 1024);
+				Assert::IsFalse(session->TryWrite(message));
+				Assert::IsTrue(session->GetWriteStats().Stalls >= 1);
+
+				// Reading returns the credit
+				std::vector<char> buffer(8192);
+				for (int i = 0; i < written; i++)
+				{
+					DWORD bytesRead = 0;
+					Assert::IsTrue(ReadFile(client, buffer.data(), (DWORD)buffer.size(), &bytesRead, nullptr));
+					Assert::AreEqual((DWORD)4096, bytesRead);
+				}
+				Assert::IsTrue(writableEvent.WaitOnEvent(5000, false));
+				Assert::IsTrue(writable == 1);
+				Assert::IsTrue(session->TryWrite(message));
+				session = nullptr;
+				CloseHandle(client);
+			}
+	};
+}
@@ -0,0 +1,126 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "Boring32/include/Async/PooledThread.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(PooledThread)
+	{
+		public:
+			TEST_METHOD(TestStartAndJoin)
+			{
+				Boring32::Async::ThreadCache cache(4, INFINITE);
+				Boring32::Async::PooledThread thread(cache);
+				Assert::IsTrue(thread == Boring32::Async::ThreadStatus::Ready);
+				thread.Start(+[](void*) { return 5; });
+				Assert::IsTrue(thread.WaitToStart(1000));
+				Assert::IsTrue(thread.Join(1000));
+				Assert::IsTrue(thread == Boring32::Async::ThreadStatus::Finished);
+				Assert::IsTrue(thread.GetExitCode() == 5);
+			}
+
+			TEST_METHOD(TestParam)
+			{
+				int value = 0;
+				Boring32::Async::ThreadCache cache(4, INFINITE);
+				Boring32::Async::PooledThread thread(cache, &value);
+				thread.Start(+[](void* param) { *static_cast<int*>(param) = 7; return 0; });
+				Assert::IsTrue(thread.Join(1000));
+				Assert::IsTrue(value == 7);
+			}
+
+			TEST_METHOD(TestExitCodeWhileRunning)
+			{
+				Boring32::Async::Event release(false, true, false);
+				Boring32::Async::ThreadCache cache(4, INFINITE);
+				Boring32::Async::PooledThread thread(cache, &release);
+				thread.Start(
+					+[](void* param)
+					{
+						static_cast<Boring32::Async::Event*>(param)->WaitOnEvent();
+						return 1;
+					});
+				Assert::IsTrue(thread.WaitToStart(1000));
+				Assert::IsTrue(thread.GetExitCode() == STILL_ACTIVE);
+				Assert::IsFalse(thread.Join(0));
+				release.Signal();
+				Assert::IsTrue(thread.Join(1000));
+				Assert::IsTrue(thread.GetExitCode() == 1);
+			}
+
+			TEST_METHOD(TestThreadIsReused)
+			{
+				Boring32::Async::ThreadCache cache(4, INFINITE);
+				for (int i = 0; i < 10; i++)
+				{
+					Boring32::Async::PooledThread thread(cache);
+					thread.Start(+[](void*) { return 0; });
+					Assert::IsTrue(thread.Join(1000));
+					// Give the worker a moment to park itself again
+					for (int j = 0; j < 100 && cache.GetIdleCount() == 0; j++)
+						Sleep(1);
+				}
+				Assert::IsTrue(cache.GetThreadCount() == 1);
+			}
+
+			TEST_METHOD(TestPrespawn)
+			{
+				Boring32::Async::ThreadCache cache(4, INFINITE);
+				cache.Prespawn(8);
+				Assert::IsTrue(cache.GetIdleCount() == 4);
+				Assert::IsTrue(cache.GetThreadCount() == 4);
+			}
+
+			TEST_METHOD(TestJoinBeforeStart)
+			{
+				Assert::ExpectException<std::runtime_error>(
+					[]()
+					{
+						Boring32::Async::ThreadCache cache(4, INFINITE);
+						Boring32::Async::PooledThread thread(cache);
+						thread.Join(0);
+					});
+			}
+
+			TEST_METHOD(TestTerminateRemovesWorker)
+			{
+				Boring32::Async::Event release(false, true, false);
+				Boring32::Async::ThreadCache cache(4, INFINITE);
+				Boring32::Async::PooledThread thread(cache, &release);
+				thread.Start(
+					+[](void* param)
+					{
+						static_cast<Boring32::Async::Event*>(param)->WaitOnEvent();
+						return 0;
+					});
+				Assert::IsTrue(thread.WaitToStart(1000));
+				thread.Terminate(3);
+				Assert::IsTrue(thread.Join(1000));
+				Assert::IsTrue(thread == Boring32::Async::ThreadStatus::Terminated);
+				Assert::IsTrue(thread.GetExitCode() == 3);
+				// The terminated thread is never handed more work
+				Assert::IsTrue(cache.GetThreadCount() == 0);
+				Assert::IsTrue(cache.GetIdleCount() == 0);
+
+				Boring32::Async::PooledThread next(cache);
+				next.Start(+[](void*) { return 4; });
+				Assert::IsTrue(next.Join(1000));
+				Assert::IsTrue(next.GetExitCode() == 4);
+			}
+
+			TEST_METHOD(TestTerminateAfterFinishThrows)
+			{
+				Boring32::Async::ThreadCache cache(4, INFINITE);
+				Boring32::Async::PooledThread thread(cache);
+				thread.Start(+[](void*) { return 0; });
+				Assert::IsTrue(thread.Join(1000));
+				Assert::ExpectException<std::runtime_error>([&thread]() { thread.Terminate(1); });
+				Assert::ExpectException<std::runtime_error>([&thread]() { thread.Suspend(); });
+				// The worker that ran the job is left alone
+				Assert::IsTrue(cache.GetThreadCount() == 1);
+				Assert::IsTrue(thread.GetExitCode() == 0);
+			}
+	};
+}
@@ -0,0 +1,126 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <vector>
+#include <string>
+#include "Boring32/include/Async/Process.hpp"
+#include "Boring32/include/Async/ProcessOutputCapture.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(ProcessOutputCapture)
+	{
+		public:
+			TEST_METHOD(TestCapturesBothStreams)
+			{
+				Boring32::Async::ProcessOutputCapture capture;
+				Boring32::Async::Process process(
+					L"",
+					L"cmd.exe /c \"echo one& echo two& echo three 1>&2\"",
+					L"",
+					true,
+					CREATE_NO_WINDOW,
+					capture.GetStartupInfo()
+				);
+				process.Start();
+				capture.Start();
+
+				std::vector<std::string> out;
+				std::vector<std::string> err;
+				capture.Run(
+					[&out, &err](const Boring32::Async::OutputStream stream, const std::string_view line)
+					{
+						if (stream == Boring32::Async::OutputStream::StdOut)
+							out.emplace_back(line);
+						else
+							err.emplace_back(line);
+					});
+
+				Assert::IsTrue(out.size() == 2);
+				Assert::IsTrue(out[0] == "one");
+				Assert::IsTrue(out[1] == "two");
+				Assert::IsTrue(err.size() == 1);
+				Assert::IsTrue(err[0] == "three ");
+			}
+
+			TEST_METHOD(TestLinesSpanningReads)
+			{
+				// A tiny buffer forces most lines to straddle reads
+				Boring32::Async::ProcessOutputCapture capture(
+					Boring32::Async::ProcessOutputCaptureSettings{
+						.BufferSize = 4,
+						.MaxBuffers = 2
+					}
+				);
+				Boring32::Async::Process process(
+					L"",
+					L"cmd.exe /c \"echo abcdefghij& echo klm\"",
+					L"",
+					true,
+					CREATE_NO_WINDOW,
+					capture.GetStartupInfo()
+				);
+				process.Start();
+				capture.Start();
+
+				std::vector<std::string> lines;
+				capture.Run(
+					[&lines](const Boring32::Async::OutputStream, const std::string_view line)
+					{
+						lines.emplace_back(line);
+					});
+
+				Assert::IsTrue(lines.size() == 2);
+				Assert::IsTrue(lines[0] == "abcdefghij");
+				Assert::IsTrue(lines[1] == "klm");
+				Assert::IsTrue(capture.GetDroppedBytes(Boring32::Async::OutputStream::StdOut) == 0);
+			}
+
+			TEST_METHOD(TestLongLinesAreSplit)
+			{
+				// The line never fits in the carried partial line, so it is
+				// delivered in MaxLineLength pieces
+				Boring32::Async::ProcessOutputCapture capture(
+					Boring32::Async::ProcessOutputCaptureSettings{
+						.BufferSize = 4,
+						.MaxBuffers = 2,
+						.MaxLineLength = 4
+					}
+				);
+				Boring32::Async::Process process(
+					L"",
+					L"cmd.exe /c \"echo abcdefghij& echo klm\"",
+					L"",
+					true,
+					CREATE_NO_WINDOW,
+					capture.GetStartupInfo()
+				);
+				process.Start();
+				capture.Start();
+
+				std::vector<std::string> lines;
+				capture.Run(
+					[&lines](const Boring32::Async::OutputStream, const std::string_view line)
+					{
+						lines.emplace_back(line);
+					});
+
+				Assert::IsTrue(lines.size() == 4);
+				Assert::IsTrue(lines[0] == "abcd");
+				Assert::IsTrue(lines[1] == "efgh");
+				Assert::IsTrue(lines[2] == "ij");
+				Assert::IsTrue(lines[3] == "klm");
+			}
+
+			TEST_METHOD(TestPumpBeforeStart)
+			{
+				Assert::ExpectException<std::runtime_error>(
+					[]()
+					{
+						Boring32::Async::ProcessOutputCapture capture;
+						capture.Pump([](auto, auto) {}, 0);
+					});
+			}
+	};
+}
@@ -0,0 +1,100 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <thread>
+#include "Boring32/include/Async/ProcessPool.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(ProcessPool)
+	{
+		// TestProcess.exe is built to the same directory as this module;
+		// mode 4 runs it as an echo worker
+		static std::wstring GetBuildDirectory()
+		{
+			HMODULE module = nullptr;
+			GetModuleHandleExW(
+				GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+				reinterpret_cast<LPCWSTR>(&GetBuildDirectory),
+				&module
+			);
+			wchar_t path[MAX_PATH + 1]{ 0 };
+			GetModuleFileNameW(module, path, MAX_PATH);
+			const std::wstring modulePath(path);
+			return modulePath.substr(0, modulePath.find_last_of(L'\\'));
+		}
+
+		static Boring32::Async::ProcessPool CreatePool(const DWORD workerCount, const DWORD maxJobsPerWorker)
+		{
+			const std::wstring directory = GetBuildDirectory();
+			return Boring32::Async::ProcessPool(
+				directory + L"\\TestProcess.exe",
+				L"TestProcess.exe 4",
+				directory,
+				workerCount,
+				maxJobsPerWorker
+			);
+		}
+
+		public:
+			TEST_METHOD(TestWorkersAreReused)
+			{
+				Boring32::Async::ProcessPool pool = CreatePool(2, 0);
+				Assert::AreEqual(size_t(2), pool.GetIdleCount());
+				for (int i = 0; i < 10; i++)
+				{
+					const std::wstring request = L"Job " + std::to_wstring(i);
+					Assert::AreEqual(request, pool.Submit(request, 5000));
+				}
+				Assert::AreEqual(UINT64(2), pool.GetSpawnCount());
+				Assert::AreEqual(size_t(2), pool.GetIdleCount());
+			}
+
+			TEST_METHOD(TestWorkersAreRecycled)
+			{
+				Boring32::Async::ProcessPool pool = CreatePool(1, 3);
+				for (int i = 0; i < 7; i++)
+					Assert::AreEqual(std::wstring(L"Job"), pool.Submit(L"Job", 5000));
+				// Jobs 1-3, 4-6 and 7 each ran on a different worker
+				Assert::AreEqual(UINT64(3), pool.GetSpawnCount());
+			}
+
+			TEST_METHOD(TestCrashedWorkerIsReplaced)
+			{
+				Boring32::Async::ProcessPool pool = CreatePool(1, 0);
+				Assert::ExpectException<std::runtime_error>([&pool]() { pool.Submit(L"crash", 5000); });
+				Assert::AreEqual(std::wstring(L"after"), pool.Submit(L"after", 5000));
+				Assert::AreEqual(UINT64(2), pool.GetSpawnCount());
+			}
+
+			TEST_METHOD(TestSubmitTimeout)
+			{
+				Boring32::Async::ProcessPool pool = CreatePool(1, 0);
+				const ULONGLONG start = GetTickCount64();
+				Assert::ExpectException<std::runtime_error>([&pool]() { pool.Submit(L"sleep:5000", 100); });
+				Assert::IsTrue(GetTickCount64() - start < 2000);
+
+				// The hung worker was killed and replaced
+				Assert::AreEqual(std::wstring(L"after"), pool.Submit(L"after", 5000));
+				Assert::AreEqual(UINT64(2), pool.GetSpawnCount());
+
+				std::wstring response;
+				Assert::IsFalse(pool.Submit(L"sleep:5000", 100, response, std::nothrow));
+			}
+
+			TEST_METHOD(TestSubmitTimesOutWaitingForWorker)
+			{
+				Boring32::Async::ProcessPool pool = CreatePool(1, 0);
+				std::thread busy([&pool]() { pool.Submit(L"sleep:1000", 5000); });
+				// Wait for the only worker to be taken
+				while (pool.GetIdleCount() > 0)
+					Sleep(1);
+				Assert::ExpectException<std::runtime_error>([&pool]() { pool.Submit(L"Job", 50); });
+				busy.join();
+				// Waiting for a worker does not cost one
+				Assert::AreEqual(UINT64(1), pool.GetSpawnCount());
+			}
+	};
+}
@@ -0,0 +1,134 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <algorithm>
+#include <Shlwapi.h>
+#include "Boring32/include/Async/ProcessSnapshot.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(ProcessSnapshot)
+	{
+		static std::wstring GetCurrentProcessName()
+		{
+			std::wstring path(MAX_PATH, '\0');
+			path.resize(GetModuleFileNameW(nullptr, path.data(), (DWORD)path.size()));
+			return PathFindFileNameW(path.c_str());
+		}
+
+		static DWORD GetCurrentSessionId()
+		{
+			DWORD sessionId = 0;
+			ProcessIdToSessionId(GetCurrentProcessId(), &sessionId);
+			return sessionId;
+		}
+
+		static bool Contains(const std::vector<DWORD>& processIds, const DWORD processId)
+		{
+			return std::find(processIds.begin(), processIds.end(), processId) != processIds.end();
+		}
+
+		public:
+			TEST_METHOD(TestFindsCurrentProcess)
+			{
+				Boring32::Async::ProcessSnapshot snapshot;
+				Assert::IsTrue(snapshot.GetCount() > 0);
+				Assert::IsTrue(Contains(snapshot.FindByName(GetCurrentProcessName()), GetCurrentProcessId()));
+			}
+
+			TEST_METHOD(TestNameIsCaseInsensitive)
+			{
+				std::wstring name = GetCurrentProcessName();
+				CharUpperBuffW(name.data(), (DWORD)name.size());
+				Boring32::Async::ProcessSnapshot snapshot;
+				Assert::IsTrue(Contains(snapshot.FindByName(name), GetCurrentProcessId()));
+			}
+
+			TEST_METHOD(TestFindBySession)
+			{
+				Boring32::Async::ProcessSnapshot snapshot;
+				const std::wstring name = GetCurrentProcessName();
+				const DWORD sessionId = GetCurrentSessionId();
+				Assert::IsTrue(Contains(snapshot.FindByName(name, sessionId), GetCurrentProcessId()));
+				Assert::IsFalse(Contains(snapshot.FindByName(name, sessionId + 1), GetCurrentProcessId()));
+			}
+
+			TEST_METHOD(TestFindByNames)
+			{
+				Boring32::Async::ProcessSnapshot snapshot;
+				const std::wstring name = GetCurrentProcessName();
+				auto results = snapshot.FindByNames({ name, L"no-such-process.exe" });
+				Assert::IsTrue(results.size() == 2);
+				Assert::IsTrue(Contains(results[name], GetCurrentProcessId()));
+				Assert::IsTrue(results[L"no-such-process.exe"].empty());
+			}
+
+			TEST_METHOD(TestGetById)
+			{
+				Boring32::Async::ProcessSnapshot snapshot;
+				const Boring32::Async::ProcessEntry* entry = snapshot.GetById(GetCurrentProcessId());
+				Assert::IsNotNull(entry);
+				Assert::IsTrue(entry->SessionId == GetCurrentSessionId());
+			}
+
+			TEST_METHOD(TestCreationTime)
+			{
+				// Reused process IDs are told apart by creation time, so it
+				// must agree with GetProcessTimes()
+				FILETIME creation{ 0 };
+				FILETIME exit{ 0 };
+				FILETIME kernel{ 0 };
+				FILETIME user{ 0 };
+				Assert::IsTrue(GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user));
+				ULARGE_INTEGER expected{ 0 };
+				expected.LowPart = creation.dwLowDateTime;
+				expected.HighPart = creation.dwHighDateTime;
+
+				Boring32::Async::ProcessSnapshot snapshot;
+				const Boring32::Async::ProcessEntry* entry = snapshot.GetById(GetCurrentProcessId());
+				Assert::IsNotNull(entry);
+				Assert::AreEqual(expected.QuadPart, entry->CreationTime);
+			}
+
+			TEST_METHOD(TestRefreshSeesNewProcess)
+			{
+				Boring32::Async::ProcessSnapshot snapshot;
+				STARTUPINFOW startupInfo{ .cb = sizeof(startupInfo) };
+				PROCESS_INFORMATION processInfo{ 0 };
+				std::wstring commandLine = L"cmd.exe /c pause";
+				Assert::IsTrue(CreateProcessW(
+					nullptr,
+					commandLine.data(),
+					nullptr,
+					nullptr,
+					false,
+					CREATE_NO_WINDOW | CREATE_SUSPENDED,
+					nullptr,
+					nullptr,
+					&startupInfo,
+					&processInfo
+				));
+				Assert::IsNull(snapshot.GetById(processInfo.dwProcessId));
+				snapshot.Refresh();
+				Assert::IsNotNull(snapshot.GetById(processInfo.dwProcessId));
+
+				TerminateProcess(processInfo.hProcess, 0);
+				WaitForSingleObject(processInfo.hProcess, INFINITE);
+				CloseHandle(processInfo.hThread);
+				CloseHandle(processInfo.hProcess);
+				snapshot.Refresh();
+				Assert::IsNull(snapshot.GetById(processInfo.dwProcessId));
+			}
+
+			TEST_METHOD(TestGetProcessIdByName)
+			{
+				Boring32::Async::ProcessSnapshot snapshot;
+				DWORD result = 0;
+				Assert::IsTrue(snapshot.GetProcessIdByName(GetCurrentProcessName(), -1, result));
+				Assert::IsTrue(snapshot.GetById(result) != nullptr);
+				Assert::IsFalse(snapshot.GetProcessIdByName(L"no-such-process.exe", -1, result));
+			}
+	};
+}
@@ -0,0 +1,153 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <coroutine>
+#include <atomic>
+#include <vector>
+#include "Boring32/include/Async/RateLimiter.hpp"
+#include "Boring32/include/Async/KeyedRateLimiter.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(RateLimiter)
+	{
+		// A coroutine that starts eagerly and is not awaited
+		struct FireAndForget
+		{
+			struct promise_type
+			{
+				FireAndForget get_return_object() noexcept { return {}; }
+				std::suspend_never initial_suspend() noexcept { return {}; }
+				std::suspend_never final_suspend() noexcept { return {}; }
+				void return_void() noexcept { }
+				void unhandled_exception() noexcept { std::terminate(); }
+			};
+		};
+
+		static FireAndForget AcquireAndSignal(
+			Boring32::Async::RateLimiter& limiter,
+			const UINT tokens,
+			std::atomic<DWORD>& threadId,
+			HANDLE done
+		)
+		{
+			co_await limiter.AcquireAsync(tokens);
+			threadId = GetCurrentThreadId();
+			SetEvent(done);
+		}
+
+		public:
+			TEST_METHOD(TestInvalidConstructor)
+			{
+				Assert::ExpectException<std::invalid_argument>(
+					[]()
+					{
+						Boring32::Async::RateLimiter limiter(0, 1);
+					});
+				Assert::ExpectException<std::invalid_argument>(
+					[]()
+					{
+						Boring32::Async::RateLimiter limiter(1, 0);
+					});
+			}
+
+			TEST_METHOD(TestBurstIsAvailable)
+			{
+				Boring32::Async::RateLimiter limiter(1, 5);
+				Assert::IsTrue(limiter.GetAvailableTokens() == 5);
+				for (int i = 0; i < 5; i++)
+					Assert::IsTrue(limiter.TryAcquire(1));
+				Assert::IsFalse(limiter.TryAcquire(1));
+			}
+
+			TEST_METHOD(TestTryAcquireMoreThanBurst)
+			{
+				Boring32::Async::RateLimiter limiter(1, 5);
+				Assert::IsFalse(limiter.TryAcquire(6));
+				Assert::IsTrue(limiter.GetAvailableTokens() == 5);
+			}
+
+			TEST_METHOD(TestAcquireTimesOut)
+			{
+				Boring32::Async::RateLimiter limiter(1, 1);
+				Assert::IsTrue(limiter.Acquire(1, 0));
+				Assert::IsFalse(limiter.Acquire(1, 100));
+			}
+
+			TEST_METHOD(TestAcquireWaits)
+			{
+				Boring32::Async::RateLimiter limiter(20, 1);
+				Assert::IsTrue(limiter.TryAcquire(1));
+				const ULONGLONG start = GetTickCount64();
+				Assert::IsTrue(limiter.Acquire(1, 1000));
+				Assert::IsTrue(GetTickCount64() - start >= 30);
+			}
+
+			TEST_METHOD(TestReserve)
+			{
+				Boring32::Async::RateLimiter limiter(10, 1);
+				Assert::IsTrue(limiter.Reserve(1) == 0);
+				// Next token is due in 100ms, i.e. 1,000,000 100ns intervals
+				Assert::IsTrue(limiter.Reserve(1) > 900000);
+			}
+
+			TEST_METHOD(TestAcquireAsyncAvailable)
+			{
+				// Available tokens complete the await without suspending
+				Boring32::Async::RateLimiter limiter(1, 1);
+				std::atomic<DWORD> threadId = 0;
+				HANDLE done = CreateEventW(nullptr, true, false, nullptr);
+				AcquireAndSignal(limiter, 1, threadId, done);
+				Assert::IsTrue(WaitForSingleObject(done, 0) == WAIT_OBJECT_0);
+				Assert::AreEqual(GetCurrentThreadId(), threadId.load());
+				Assert::IsFalse(limiter.TryAcquire(1));
+				CloseHandle(done);
+			}
+
+			TEST_METHOD(TestAcquireAsyncWaits)
+			{
+				Boring32::Async::RateLimiter limiter(20, 1);
+				Assert::IsTrue(limiter.TryAcquire(1));
+				std::atomic<DWORD> threadId = 0;
+				HANDLE done = CreateEventW(nullptr, true, false, nullptr);
+				const ULONGLONG start = GetTickCount64();
+				AcquireAndSignal(limiter, 1, threadId, done);
+				Assert::IsTrue(WaitForSingleObject(done, 1000) == WAIT_OBJECT_0);
+				Assert::IsTrue(GetTickCount64() - start >= 30);
+				Assert::AreNotEqual(GetCurrentThreadId(), threadId.load());
+				CloseHandle(done);
+			}
+
+			TEST_METHOD(TestAcquireAsyncMany)
+			{
+				// Short waits often fire before the wait is registered, which
+				// must neither lose the resumption nor leak the wait
+				Boring32::Async::RateLimiter limiter(100000, 1);
+				constexpr int Count = 200;
+				std::vector<HANDLE> done;
+				std::vector<std::atomic<DWORD>> threadIds(Count);
+				for (int i = 0; i < Count; i++)
+				{
+					done.push_back(CreateEventW(nullptr, true, false, nullptr));
+					AcquireAndSignal(limiter, 1, threadIds[i], done.back());
+				}
+				for (HANDLE event : done)
+				{
+					Assert::IsTrue(WaitForSingleObject(event, 5000) == WAIT_OBJECT_0);
+					CloseHandle(event);
+				}
+			}
+
+			TEST_METHOD(TestKeyedLimitersAreIndependent)
+			{
+				Boring32::Async::KeyedRateLimiter<std::wstring> limiter(1, 1);
+				Assert::IsTrue(limiter.TryAcquire(L"a", 1));
+				Assert::IsFalse(limiter.TryAcquire(L"a", 1));
+				Assert::IsTrue(limiter.TryAcquire(L"b", 1));
+				Assert::IsTrue(limiter.Size() == 2);
+				Assert::IsTrue(limiter.Erase(L"a"));
+				Assert::IsTrue(limiter.TryAcquire(L"a", 1));
+			}
+	};
+}
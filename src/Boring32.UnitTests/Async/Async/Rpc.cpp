@@ -0,0 +1,202 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include "Boring32/include/Async/Event.hpp"
+#include "Boring32/include/Async/Pipes/OverlappedNamedPipeServer.hpp"
+#include "Boring32/include/Async/Pipes/OverlappedNamedPipeClient.hpp"
+#include "Boring32/include/Async/Pipes/RpcClient.hpp"
+#include "Boring32/include/Async/Pipes/RpcServer.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(Rpc)
+	{
+		// The pipe classes recreate the pipe when moved, so these are
+		// constructed in place
+		struct ConnectedPipes
+		{
+			ConnectedPipes(const std::wstring& name)
+			:	Server(name, 4096, 1, L"", false, true),
+				Client(name)
+			{ }
+
+			Boring32::Async::OverlappedNamedPipeServer Server;
+			Boring32::Async::OverlappedNamedPipeClient Client;
+		};
+
+		static std::unique_ptr<ConnectedPipes> Connect()
+		{
+			static std::atomic<int> counter = 0;
+			const std::wstring name =
+				L"Boring32.UnitTests.Rpc."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ L"."
+				+ std::to_wstring(counter++);
+
+			auto pipes = std::make_unique<ConnectedPipes>(name);
+			Boring32::Async::OverlappedOp connectOp;
+			pipes->Server.Connect(connectOp);
+			pipes->Client.Connect(0);
+			if (connectOp.LastError() != ERROR_PIPE_CONNECTED)
+				connectOp.WaitForCompletion(INFINITE);
+			return pipes;
+		}
+
+		static std::vector<std::byte> ToBytes(const std::string& value)
+		{
+			const std::span<const std::byte> bytes = std::as_bytes(std::span(value));
+			return { bytes.begin(), bytes.end() };
+		}
+
+		static Boring32::Async::RpcErrorCode GetErrorCode(std::future<std::vector<std::byte>>& result)
+		{
+			try
+			{
+				result.get();
+			}
+			catch (const Boring32::Async::RpcError& ex)
+			{
+				return ex.GetCode();
+			}
+			Assert::Fail(L"The call did not fail");
+			return Boring32::Async::RpcErrorCode::Remote;
+		}
+
+		public:
+			TEST_METHOD(TestCall)
+			{
+				auto pipes = Connect();
+				Boring32::Async::RpcServer server(
+					pipes->Server,
+					[](const UINT32 method, const std::span<const std::byte> request)
+					{
+						std::vector<std::byte> response(request.begin(), request.end());
+						response.push_back(static_cast<std::byte>(method));
+						return response;
+					});
+				Boring32::Async::RpcClient client(pipes->Client);
+
+				Boring32::Async::RpcCall call = client.Call(7, ToBytes("echo"));
+				std::vector<std::byte> expected = ToBytes("echo");
+				expected.push_back(std::byte{ 7 });
+				Assert::IsTrue(call.Result.get() == expected);
+				Assert::IsTrue(client.Call(1, {}).Result.get() == std::vector<std::byte>{ std::byte{ 1 } });
+				Assert::AreEqual(size_t(0), client.GetPendingCount());
+			}
+
+			TEST_METHOD(TestResponsesOutOfOrder)
+			{
+				auto pipes = Connect();
+				Boring32::Async::Event release(false, true, false);
+				Boring32::Async::RpcServer server(
+					pipes->Server,
+					[&release](const UINT32 method, const std::span<const std::byte>)
+					{
+						if (method == 1)
+							release.WaitOnEvent(INFINITE, false);
+						return std::vector<std::byte>{ static_cast<std::byte>(method) };
+					},
+					{ .WorkerThreads = 2 });
+				Boring32::Async::RpcClient client(pipes->Client);
+
+				// The fast call completes while the slow one is still
+				// outstanding on the same connection
+				Boring32::Async::RpcCall slow = client.Call(1, {});
+				Boring32::Async::RpcCall fast = client.Call(2, {});
+				Assert::IsTrue(fast.Result.get()[0] == std::byte{ 2 });
+				Assert::IsTrue(slow.Result.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+				release.Signal();
+				Assert::IsTrue(slow.Result.get()[0] == std::byte{ 1 });
+			}
+
+			TEST_METHOD(TestRemoteError)
+			{
+				auto pipes = Connect();
+				Boring32::Async::RpcServer server(
+					pipes->Server,
+					[](const UINT32, const std::span<const std::byte>) -> std::vector<std::byte>
+					{
+						throw std::runtime_error("handler failed");
+					});
+				Boring32::Async::RpcClient client(pipes->Client);
+
+				Boring32::Async::RpcCall call = client.Call(1, {});
+				try
+				{
+					call.Result.get();
+					Assert::Fail(L"The call did not fail");
+				}
+				catch (const Boring32::Async::RpcError& ex)
+				{
+					Assert::IsTrue(ex.GetCode() == Boring32::Async::RpcErrorCode::Remote);
+					Assert::AreEqual(std::string("handler failed"), std::string(ex.what()));
+				}
+			}
+
+			TEST_METHOD(TestTimeout)
+			{
+				auto pipes = Connect();
+				Boring32::Async::Event release(false, true, false);
+				Boring32::Async::RpcServer server(
+					pipes->Server,
+					[&release](const UINT32, const std::span<const std::byte>)
+					{
+						release.WaitOnEvent(INFINITE, false);
+						return std::vector<std::byte>{};
+					});
+				Boring32::Async::RpcClient client(pipes->Client, { .TimerResolutionMillis = 10 });
+
+				Boring32::Async::RpcCall call = client.Call(1, {}, 50);
+				Assert::IsTrue(GetErrorCode(call.Result) == Boring32::Async::RpcErrorCode::Timeout);
+				Assert::AreEqual(size_t(0), client.GetPendingCount());
+				release.Signal();
+			}
+
+			TEST_METHOD(TestCancel)
+			{
+				auto pipes = Connect();
+				Boring32::Async::Event release(false, true, false);
+				std::atomic<int> handled = 0;
+				Boring32::Async::RpcServer server(
+					pipes->Server,
+					[&release, &handled](const UINT32 method, const std::span<const std::byte>)
+					{
+						if (method == 1)
+							release.WaitOnEvent(INFINITE, false);
+						handled++;
+						return std::vector<std::byte>{};
+					},
+					{ .WorkerThreads = 1 });
+				Boring32::Async::RpcClient client(pipes->Client);
+
+				// The first call occupies the only worker, so the second is
+				// still queued when it is cancelled and is never handled
+				Boring32::Async::RpcCall blocking = client.Call(1, {});
+				Boring32::Async::RpcCall queued = client.Call(2, {});
+				Assert::IsTrue(client.Cancel(queued.Id));
+				Assert::IsFalse(client.Cancel(queued.Id));
+				Assert::IsTrue(GetErrorCode(queued.Result) == Boring32::Async::RpcErrorCode::Cancelled);
+
+				release.Signal();
+				blocking.Result.get();
+				client.Call(3, {}).Result.get();
+				Assert::AreEqual(2, handled.load());
+			}
+
+			TEST_METHOD(TestDisconnect)
+			{
+				auto pipes = Connect();
+				Boring32::Async::RpcClient client(pipes->Client);
+				Boring32::Async::RpcCall call = client.Call(1, {});
+				pipes->Server.Disconnect();
+				Assert::IsTrue(GetErrorCode(call.Result) == Boring32::Async::RpcErrorCode::Disconnected);
+				Assert::ExpectException<Boring32::Async::RpcError>([&client]() { client.Call(1, {}); });
+			}
+	};
+}
@@ -0,0 +1,103 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include "Boring32/include/Async/SharedHashTable.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(SharedHashTable)
+	{
+		using Table = Boring32::Async::SharedHashTable<UINT64, UINT64>;
+
+		// Leaves a bucket locked as a writer that died mid-write would
+		struct BrokenTable : Table
+		{
+			using Table::Table;
+
+			void LockBucket(const UINT64 key)
+			{
+				m_buckets[GetHome(key)].Sequence |= 1;
+			}
+		};
+
+		static std::wstring MakeName()
+		{
+			static int counter = 0;
+			return L"Boring32.UnitTests.SharedHashTable."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ L"."
+				+ std::to_wstring(counter++);
+		}
+
+		public:
+			TEST_METHOD(TestInsertAndFind)
+			{
+				Table table(MakeName(), { .Capacity = 1000 });
+				Assert::IsTrue(table.GetBucketCount() >= 1500);
+				for (UINT64 i = 0; i < 1000; i++)
+					Assert::IsTrue(table.Insert(i, i * 10));
+				Assert::AreEqual(1000u, table.GetCount());
+				for (UINT64 i = 0; i < 1000; i++)
+					Assert::AreEqual(i * 10, table.Find(i).value());
+				Assert::IsFalse(table.Contains(1000));
+
+				Assert::IsFalse(table.Insert(5, 55));
+				Assert::AreEqual(55ull, table.Find(5).value());
+				Assert::ExpectException<std::length_error>([&table]() { table.Insert(1000, 0); });
+			}
+
+			TEST_METHOD(TestAttachReadOnly)
+			{
+				const std::wstring name = MakeName();
+				Table builder(name, { .Capacity = 100 });
+				builder.Insert(42, 4242);
+
+				Table reader(name, FILE_MAP_READ);
+				Assert::AreEqual(100u, reader.GetCapacity());
+				Assert::AreEqual(4242ull, reader.Find(42).value());
+				// Writes by the builder are visible to attached readers
+				builder.Insert(43, 4343);
+				Assert::AreEqual(4343ull, reader.Find(43).value());
+				Assert::ExpectException<std::runtime_error>([&name]() { Table(name, { .Capacity = 100 }); });
+			}
+
+			TEST_METHOD(TestLockedBucketTimesOut)
+			{
+				BrokenTable table(MakeName(), { .Capacity = 10, .WriteTimeout = 100 });
+				table.Insert(7, 70);
+				table.LockBucket(7);
+				Assert::ExpectException<std::runtime_error>([&table]() { table.Find(7); });
+				Assert::ExpectException<std::runtime_error>([&table]() { table.Insert(7, 71); });
+			}
+
+			TEST_METHOD(TestConcurrentWriters)
+			{
+				constexpr UINT64 Threads = 4;
+				constexpr UINT64 KeysPerThread = 10000;
+				const std::wstring name = MakeName();
+				Table table(name, { .Capacity = static_cast<UINT32>(Threads * KeysPerThread) });
+
+				std::vector<std::thread> threads;
+				for (UINT64 t = 0; t < Threads; t++)
+				{
+					threads.emplace_back(
+						[&name, t]()
+						{
+							Table writer(name, FILE_MAP_ALL_ACCESS);
+							for (UINT64 i = 0; i < KeysPerThread; i++)
+								writer.Insert(t * KeysPerThread + i, i);
+						});
+				}
+				for (std::thread& thread : threads)
+					thread.join();
+
+				Assert::AreEqual(static_cast<UINT32>(Threads * KeysPerThread), table.GetCount());
+				for (UINT64 key = 0; key < Threads * KeysPerThread; key++)
+					Assert::AreEqual(key % KeysPerThread, table.Find(key).value());
+			}
+	};
+}
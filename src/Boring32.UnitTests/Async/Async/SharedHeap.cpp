@@ -0,0 +1,182 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <memory_resource>
+#include <atomic>
+#include <memory>
+#include "Boring32/include/Async/SharedHeap.hpp"
+#include "Boring32/include/Async/SharedHeapResource.hpp"
+#include "Boring32/include/Async/OffsetPtr.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(SharedHeap)
+	{
+		static constexpr UINT HeapSize = 16 * 1024 * 1024;
+
+		struct Node
+		{
+			int Value;
+			Boring32::Async::OffsetPtr<Node> Next;
+		};
+
+		static std::wstring MakeName()
+		{
+			static int counter = 0;
+			return L"Boring32.UnitTests.SharedHeap."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ L"."
+				+ std::to_wstring(counter++);
+		}
+
+		public:
+			TEST_METHOD(TestAllocateReusesFreedBlocks)
+			{
+				Boring32::Async::SharedHeap heap(MakeName(), HeapSize, true);
+				const Boring32::Async::SharedHeap::Offset first = heap.Allocate(100);
+				Assert::AreNotEqual(0u, first);
+				heap.Deallocate(first, 100);
+				Assert::AreEqual(first, heap.Allocate(100));
+				Assert::AreEqual(size_t(112), Boring32::Async::SharedHeap::GetBlockSize(100, 16));
+				Assert::AreEqual(size_t(320), Boring32::Async::SharedHeap::GetBlockSize(300, 16));
+
+				const Boring32::Async::SharedHeap::Offset aligned = heap.Allocate(10, 256);
+				Assert::AreEqual(size_t(0), reinterpret_cast<size_t>(heap.GetPointer(aligned)) % 256);
+				Assert::ExpectException<std::invalid_argument>([&heap]() { heap.Allocate(10, 3); });
+			}
+
+			TEST_METHOD(TestExhaustion)
+			{
+				Boring32::Async::SharedHeap heap(MakeName(), 256 * 1024, true);
+				Assert::ExpectException<std::bad_alloc>(
+					[&heap]()
+					{
+						while (true)
+							heap.Allocate(1000);
+					});
+				Assert::ExpectException<std::bad_alloc>([&heap]() { heap.Allocate(HeapSize); });
+			}
+
+			TEST_METHOD(TestAttachSeesOffsetLinkedList)
+			{
+				const std::wstring name = MakeName();
+				Boring32::Async::SharedHeap creator(name, HeapSize, true);
+				Node* head = nullptr;
+				for (int i = 0; i < 100; i++)
+				{
+					Node* node = creator.Get<Node>(creator.Allocate(sizeof(Node)));
+					node->Value = i;
+					node->Next = head;
+					head = node;
+				}
+				creator.SetRoot(0, creator.GetOffset(head));
+
+				// The second view is mapped at a different address
+				Boring32::Async::SharedHeap attached(name, HeapSize, false);
+				Assert::IsTrue(creator.GetPointer(creator.GetRoot(0)) != attached.GetPointer(attached.GetRoot(0)));
+				int expected = 99;
+				for (Node* node = attached.Get<Node>(attached.GetRoot(0)); node; node = node->Next.Get())
+					Assert::AreEqual(expected--, node->Value);
+				Assert::AreEqual(-1, expected);
+			}
+
+			TEST_METHOD(TestPmrContainer)
+			{
+				Boring32::Async::SharedHeap heap(MakeName(), HeapSize, true);
+				Boring32::Async::SharedHeapResource resource(heap);
+				std::pmr::vector<int> values(&resource);
+				for (int i = 0; i < 10000; i++)
+					values.push_back(i);
+				Assert::IsTrue(heap.GetOffset(values.data()) > 0);
+				Assert::IsTrue(heap.GetOffset(values.data()) < heap.GetSize());
+				Assert::AreEqual(9999, values.back());
+			}
+
+			TEST_METHOD(TestConcurrentAllocation)
+			{
+				constexpr int Threads = 4;
+				constexpr int Blocks = 2000;
+				Boring32::Async::SharedHeap heap(MakeName(), HeapSize, true);
+				std::vector<int> failures(Threads, 0);
+				std::vector<std::thread> threads;
+				for (int t = 0; t < Threads; t++)
+				{
+					threads.emplace_back(
+						[&heap, &failures, t]()
+						{
+							for (int round = 0; round < 10; round++)
+							{
+								std::vector<Boring32::Async::SharedHeap::Offset> offsets;
+								for (int i = 0; i < Blocks; i++)
+								{
+									offsets.push_back(heap.Allocate(64));
+									std::fill_n(heap.Get<int>(offsets.back()), 16, t);
+								}
+								for (const Boring32::Async::SharedHeap::Offset offset : offsets)
+								{
+									// A block handed to two threads would be overwritten
+									if (heap.Get<int>(offset)[15] != t)
+										failures[t]++;
+									heap.Deallocate(offset, 64);
+								}
+							}
+						});
+				}
+				for (std::thread& thread : threads)
+					thread.join();
+				for (const int count : failures)
+					Assert::AreEqual(0, count);
+			}
+
+			TEST_METHOD(TestAttachWithSmallerSize)
+			{
+				const std::wstring name = MakeName();
+				Boring32::Async::SharedHeap heap(name, HeapSize, true);
+				Assert::ExpectException<std::runtime_error>(
+					[&name]() { Boring32::Async::SharedHeap attached(name, HeapSize / 2, false); }
+				);
+				Boring32::Async::SharedHeap attached(name, HeapSize, false);
+			}
+
+			TEST_METHOD(TestConcurrentCreators)
+			{
+				constexpr int Threads = 8;
+				constexpr int Blocks = 100;
+				const std::wstring name = MakeName();
+				// Every heap stays open until the end so the section is
+				// shared by all of them
+				std::vector<std::unique_ptr<Boring32::Async::SharedHeap>> heaps(Threads);
+				std::vector<std::vector<Boring32::Async::SharedHeap::Offset>> offsets(Threads);
+				std::atomic<bool> start = false;
+				std::vector<std::thread> threads;
+				for (int t = 0; t < Threads; t++)
+				{
+					threads.emplace_back(
+						[&, t]()
+						{
+							while (!start)
+								std::this_thread::yield();
+							heaps[t] = std::make_unique<Boring32::Async::SharedHeap>(name, HeapSize, true);
+							for (int i = 0; i < Blocks; i++)
+								offsets[t].push_back(heaps[t]->Allocate(64));
+						});
+				}
+				start = true;
+				for (std::thread& thread : threads)
+					thread.join();
+
+				// A creator that reset the heap would hand out blocks
+				// another creator already had
+				std::vector<Boring32::Async::SharedHeap::Offset> all;
+				for (const auto& threadOffsets : offsets)
+					all.insert(all.end(), threadOffsets.begin(), threadOffsets.end());
+				std::sort(all.begin(), all.end());
+				Assert::IsTrue(std::adjacent_find(all.begin(), all.end()) == all.end());
+			}
+	};
+}
@@ -0,0 +1,172 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <vector>
+#include <atomic>
+#include "Boring32/include/Async/Pipes/UnixSocketServer.hpp"
+#include "Boring32/include/Async/Pipes/UnixSocketClient.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(UnixSocket)
+	{
+		static std::wstring MakePath()
+		{
+			static std::atomic<int> counter = 0;
+			wchar_t tempPath[MAX_PATH + 1]{ 0 };
+			GetTempPathW(MAX_PATH, tempPath);
+			return std::wstring(tempPath)
+				+ L"Boring32.UnitTests."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ L"."
+				+ std::to_wstring(counter++)
+				+ L".sock";
+		}
+
+		public:
+			TEST_METHOD(TestWriteRead)
+			{
+				const std::wstring path = MakePath();
+				Boring32::Async::UnixSocketServer server(path, 1);
+				Boring32::Async::UnixSocketClient client(path);
+				client.Connect();
+				server.Connect();
+
+				client.Write(L"hello");
+				client.Write(L"");
+				client.Write(L"world");
+				Assert::AreEqual(std::wstring(L"hello"), server.Read());
+				Assert::AreEqual(std::wstring(L""), server.Read());
+				Assert::AreEqual(std::wstring(L"world"), server.Read());
+
+				const std::vector<std::byte> payload(100000, std::byte{ 0x5A });
+				server.Write(payload);
+				Assert::IsTrue(client.ReadBytes() == payload);
+			}
+
+			TEST_METHOD(TestWriteGatherReadScatter)
+			{
+				const std::wstring path = MakePath();
+				Boring32::Async::UnixSocketServer server(path, 1);
+				Boring32::Async::UnixSocketClient client(path);
+				client.Connect();
+				server.Connect();
+
+				const std::vector<std::byte> header(3, std::byte{ 0x01 });
+				const std::vector<std::byte> empty;
+				const std::vector<std::byte> body(5, std::byte{ 0x02 });
+				const std::span<const std::byte> pieces[] = { header, empty, body };
+				client.WriteGather(pieces);
+				client.WriteGather(pieces);
+
+				// Gathered pieces arrive as one message
+				std::vector<std::byte> expected = header;
+				expected.insert(expected.end(), body.begin(), body.end());
+				Assert::IsTrue(server.ReadBytes() == expected);
+
+				std::vector<std::byte> first(2);
+				std::vector<std::byte> second(10);
+				const std::span<std::byte> buffers[] = { first, second };
+				Assert::AreEqual((size_t)8, server.ReadScatter(buffers));
+				Assert::IsTrue(first == std::vector<std::byte>(2, std::byte{ 0x01 }));
+				Assert::IsTrue(second[0] == std::byte{ 0x01 });
+				Assert::IsTrue(second[1] == std::byte{ 0x02 });
+			}
+
+			TEST_METHOD(TestReadScatterTooSmall)
+			{
+				const std::wstring path = MakePath();
+				Boring32::Async::UnixSocketServer server(path, 1);
+				Boring32::Async::UnixSocketClient client(path);
+				client.Connect();
+				server.Connect();
+
+				client.Write(std::vector<std::byte>(10, std::byte{ 0x01 }));
+				client.Write(L"next");
+				std::vector<std::byte> buffer(4);
+				const std::span<std::byte> buffers[] = { buffer };
+				Assert::ExpectException<std::runtime_error>([&server, &buffers]() { server.ReadScatter(buffers); });
+				// The oversized message is discarded, not left half read
+				Assert::AreEqual(std::wstring(L"next"), server.Read());
+			}
+
+			TEST_METHOD(TestMultipleInstances)
+			{
+				const std::wstring path = MakePath();
+				Boring32::Async::UnixSocketServer first(path, 2);
+				Boring32::Async::UnixSocketServer second = first.CreateInstance();
+				Assert::AreEqual(2u, first.GetInstanceCount());
+				Assert::ExpectException<std::runtime_error>([&first]() { first.CreateInstance(); });
+
+				Boring32::Async::UnixSocketClient clientA(path);
+				Boring32::Async::UnixSocketClient clientB(path);
+				clientA.Connect();
+				first.Connect();
+				clientB.Connect();
+				second.Connect();
+
+				clientA.Write(L"A");
+				clientB.Write(L"B");
+				Assert::AreEqual(std::wstring(L"A"), first.Read());
+				Assert::AreEqual(std::wstring(L"B"), second.Read());
+			}
+
+			TEST_METHOD(TestConnectTimeout)
+			{
+				Boring32::Async::UnixSocketServer server(MakePath(), 1);
+				Assert::IsFalse(server.Connect(10));
+				Assert::IsFalse(server.IsConnected());
+			}
+
+			TEST_METHOD(TestWaitForRead)
+			{
+				const std::wstring path = MakePath();
+				Boring32::Async::UnixSocketServer server(path, 1);
+				Boring32::Async::UnixSocketClient client(path);
+				client.Connect();
+				server.Connect();
+
+				Assert::IsFalse(server.WaitForRead(10));
+				client.Write(L"ready");
+				Assert::IsTrue(server.WaitForRead(INFINITE));
+				Assert::AreEqual(std::wstring(L"ready"), server.Read());
+			}
+
+			TEST_METHOD(TestReadAfterClose)
+			{
+				const std::wstring path = MakePath();
+				Boring32::Async::UnixSocketServer server(path, 1);
+				Boring32::Async::UnixSocketClient client(path);
+				client.Connect();
+				server.Connect();
+
+				client.Write(L"last");
+				client.Close();
+				Assert::AreEqual(std::wstring(L"last"), server.Read());
+				std::wstring out;
+				Assert::IsFalse(server.Read(out, std::nothrow));
+			}
+
+			TEST_METHOD(TestMaxMessageSize)
+			{
+				const std::wstring path = MakePath();
+				Boring32::Async::UnixSocketServer server(path, 1);
+				Boring32::Async::UnixSocketClient client(path);
+				client.Connect();
+				server.Connect();
+				server.SetMaxMessageSize(16);
+
+				client.Write(std::vector<std::byte>(16, std::byte{ 0x01 }));
+				Assert::AreEqual((size_t)16, server.ReadBytes().size());
+
+				// The size is rejected from the prefix, before the message
+				// is allocated or read. A stream can't skip the message, so
+				// the connection is closed.
+				client.Write(std::vector<std::byte>(17, std::byte{ 0x02 }));
+				Assert::ExpectException<std::runtime_error>([&server]() { server.ReadBytes(); });
+				Assert::IsFalse(server.IsConnected());
+			}
+	};
+}
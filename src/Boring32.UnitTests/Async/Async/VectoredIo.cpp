@@ -0,0 +1,233 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+#include <string>
+#include <vector>
+#include <span>
+#include <atomic>
+#include <algorithm>
+#include "Boring32/include/Async/VectoredIo.hpp"
+#include "Boring32/include/Async/Pipes/OverlappedNamedPipeServer.hpp"
+#include "Boring32/include/Async/Pipes/OverlappedNamedPipeClient.hpp"
+#include "Boring32/include/Async/Pipes/AnonymousPipe.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace Async
+{
+	TEST_CLASS(VectoredIo)
+	{
+		// The pipe classes recreate the pipe when moved, so these are
+		// constructed in place
+		struct ConnectedPipes
+		{
+			ConnectedPipes(const std::wstring& name)
+			:	Server(name, 4096, 1, L"", false, true),
+				Client(name)
+			{ }
+
+			Boring32::Async::OverlappedNamedPipeServer Server;
+			Boring32::Async::OverlappedNamedPipeClient Client;
+		};
+
+		static std::unique_ptr<ConnectedPipes> Connect()
+		{
+			static std::atomic<int> counter = 0;
+			const std::wstring name =
+				L"Boring32.UnitTests.VectoredIo."
+				+ std::to_wstring(GetCurrentProcessId())
+				+ L"."
+				+ std::to_wstring(counter++);
+
+			auto pipes = std::make_unique<ConnectedPipes>(name);
+			Boring32::Async::OverlappedOp connectOp;
+			pipes->Server.Connect(connectOp);
+			pipes->Client.Connect(0);
+			pipes->Client.SetMode(PIPE_READMODE_MESSAGE);
+			if (connectOp.LastError() != ERROR_PIPE_CONNECTED)
+				connectOp.WaitForCompletion(INFINITE);
+			return pipes;
+		}
+
+		static std::vector<std::byte> MakePayload(const size_t size, const int seed)
+		{
+			std::vector<std::byte> payload(size);
+			for (size_t i = 0; i < size; i++)
+				payload[i] = (std::byte)((i + seed) & 0xFF);
+			return payload;
+		}
+
+		static std::vector<std::byte> Concatenate(const std::vector<std::vector<std::byte>>& parts)
+		{
+			std::vector<std::byte> result;
+			for (const std::vector<std::byte>& part : parts)
+				result.insert(result.end(), part.begin(), part.end());
+			return result;
+		}
+
+		public:
+			TEST_METHOD(TestGatherWriteIsOneMessage)
+			{
+				auto pipes = Connect();
+				const std::vector<std::vector<std::byte>> parts{
+					MakePayload(16, 1),
+					MakePayload(1000, 2),
+					MakePayload(8, 3)
+				};
+				const std::span<const std::byte> pieces[] = { parts[0], parts[1], parts[2] };
+				Assert::AreEqual(
+					(UINT64)1024,
+					pipes->Client.WriteGather(pieces)
+				);
+
+				// The message arrives whole, so one read returns all of it
+				std::vector<std::byte> received(2048);
+				const std::span<std::byte> targets[] = { received };
+				const Boring32::Async::ScatterReadResult result = pipes->Server.ReadScatter(targets);
+
+				const std::vector<std::byte> expected = Concatenate(parts);
+				Assert::AreEqual((UINT64)expected.size(), result.BytesRead);
+				Assert::IsFalse(result.MoreData);
+				Assert::IsTrue(std::equal(expected.begin(), expected.end(), received.begin()));
+			}
+
+			TEST_METHOD(TestScatterReadSplitsMessage)
+			{
+				auto pipes = Connect();
+				const std::vector<std::byte> message = MakePayload(100, 4);
+				const std::span<const std::byte> pieces[] = { message };
+				pipes->Server.WriteGather(pieces);
+
+				std::vector<std::byte> header(16);
+				std::vector<std::byte> body(200);
+				const std::span<std::byte> targets[] = { header, body };
+				const Boring32::Async::ScatterReadResult result = pipes->Client.ReadScatter(targets);
+
+				Assert::AreEqual((UINT64)100, result.BytesRead);
+				Assert::IsFalse(result.MoreData);
+				Assert::IsTrue(std::equal(header.begin(), header.end(), message.begin()));
+				Assert::IsTrue(std::equal(message.begin() + 16, message.end(), body.begin()));
+			}
+
+			TEST_METHOD(TestScatterReadReportsMoreData)
+			{
+				auto pipes = Connect();
+				const std::vector<std::byte> message = MakePayload(100, 5);
+				const std::span<const std::byte> pieces[] = { message };
+				pipes->Server.WriteGather(pieces);
+
+				std::vector<std::byte> first(30);
+				std::vector<std::byte> second(30);
+				const std::span<std::byte> targets[] = { first, second };
+				Boring32::Async::ScatterReadResult result = pipes->Client.ReadScatter(targets);
+				Assert::AreEqual((UINT64)60, result.BytesRead);
+				Assert::IsTrue(result.MoreData);
+
+				// The rest of the message comes from the next read
+				std::vector<std::byte> rest(100);
+				const std::span<std::byte> restTarget[] = { rest };
+				result = pipes->Client.ReadScatter(restTarget);
+				Assert::AreEqual((UINT64)40, result.BytesRead);
+				Assert::IsFalse(result.MoreData);
+				Assert::IsTrue(std::equal(message.begin() + 60, message.end(), rest.begin()));
+			}
+
+			TEST_METHOD(TestGetVectoredIoTraits)
+			{
+				auto pipes = Connect();
+				const Boring32::Async::VectoredIoTraits traits =
+					Boring32::Async::GetVectoredIoTraits(pipes->Client.GetInternalHandle().GetHandle());
+				Assert::IsTrue(traits.IsPipe);
+				Assert::IsTrue(traits.IsMessagePipe);
+				Assert::IsTrue(traits.IsMessageReadMode);
+				Assert::IsTrue(traits.IsOverlapped);
+			}
+
+			TEST_METHOD(TestCachedTraitsFollowReadMode)
+			{
+				auto pipes = Connect();
+				const std::vector<std::byte> first = MakePayload(10, 13);
+				const std::vector<std::byte> second = MakePayload(10, 14);
+				const std::span<const std::byte> firstPieces[] = { first };
+				const std::span<const std::byte> secondPieces[] = { second };
+				pipes->Server.WriteGather(firstPieces);
+				pipes->Server.WriteGather(secondPieces);
+
+				// In byte-read mode, a read carries on past the end of a
+				// message, which it would not if the client still used
+				// the traits it queried when connecting
+				pipes->Client.SetMode(PIPE_READMODE_BYTE);
+				std::vector<std::byte> received(20);
+				const std::span<std::byte> targets[] = { received };
+				const Boring32::Async::ScatterReadResult result = pipes->Client.ReadScatter(targets);
+
+				Assert::AreEqual((UINT64)20, result.BytesRead);
+				Assert::IsTrue(std::equal(first.begin(), first.end(), received.begin()));
+				Assert::IsTrue(std::equal(second.begin(), second.end(), received.begin() + 10));
+			}
+
+			TEST_METHOD(TestByteModePipe)
+			{
+				Boring32::Async::AnonymousPipe pipe(false, 16384, L"");
+				const std::vector<std::vector<std::byte>> parts{
+					MakePayload(10, 6),
+					MakePayload(5000, 7),
+					MakePayload(20, 8)
+				};
+				const std::span<const std::byte> pieces[] = { parts[0], parts[1], parts[2] };
+				Boring32::Async::WriteGather(pipe.GetWrite(), pieces);
+				pipe.CloseWrite();
+
+				// Reads fill every piece, stopping when the pipe is closed
+				std::vector<std::byte> first(3000);
+				std::vector<std::byte> second(3000);
+				const std::span<std::byte> targets[] = { first, second };
+				const Boring32::Async::ScatterReadResult result = Boring32::Async::ReadScatter(pipe.GetRead(), targets);
+
+				const std::vector<std::byte> expected = Concatenate(parts);
+				Assert::AreEqual((UINT64)expected.size(), result.BytesRead);
+				Assert::IsTrue(std::equal(expected.begin(), expected.begin() + 3000, first.begin()));
+				Assert::IsTrue(std::equal(expected.begin() + 3000, expected.end(), second.begin()));
+			}
+
+			TEST_METHOD(TestFileRoundTrip)
+			{
+				wchar_t directory[MAX_PATH]{ 0 };
+				wchar_t path[MAX_PATH]{ 0 };
+				GetTempPathW(MAX_PATH, directory);
+				Assert::AreNotEqual((UINT)0, GetTempFileNameW(directory, L"b32", 0, path));
+				HANDLE file = CreateFileW(
+					path,
+					GENERIC_READ | GENERIC_WRITE,
+					0,
+					nullptr,
+					CREATE_ALWAYS,
+					FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE,
+					nullptr
+				);
+				Assert::IsTrue(file != INVALID_HANDLE_VALUE);
+
+				const std::vector<std::vector<std::byte>> parts{
+					MakePayload(100, 9),
+					MakePayload(64 * 1024, 10),
+					MakePayload(3, 11),
+					MakePayload(7, 12)
+				};
+				const std::span<const std::byte> pieces[] = { parts[0], parts[1], parts[2], parts[3] };
+				Assert::AreEqual((UINT64)65646, Boring32::Async::WriteGather(file, pieces));
+				SetFilePointer(file, 0, nullptr, FILE_BEGIN);
+
+				// The last piece is larger than what remains, so the read
+				// stops at the end of the file
+				std::vector<std::byte> first(65000);
+				std::vector<std::byte> second(1000);
+				const std::span<std::byte> targets[] = { first, second };
+				const Boring32::Async::ScatterReadResult result = Boring32::Async::ReadScatter(file, targets);
+				CloseHandle(file);
+
+				const std::vector<std::byte> expected = Concatenate(parts);
+				Assert::AreEqual((UINT64)expected.size(), result.BytesRead);
+				Assert::IsTrue(std::equal(expected.begin(), expected.begin() + 65000, first.begin()));
+				Assert::IsTrue(std::equal(expected.begin() + 65000, expected.end(), second.begin()));
+			}
+	};
+}
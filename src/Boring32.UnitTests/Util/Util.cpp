@@ -40,5 +40,18 @@ namespace Util
 				Boring32::Util::ByteVectorToString(byteVector, result);
 				Assert::IsTrue(string == result);
 			}
+
+			TEST_METHOD(TestCrc32c)
+			{
+				const std::string check = "123456789";
+				const std::span<const std::byte> bytes = std::as_bytes(std::span(check));
+				Assert::AreEqual(0xE3069283u, Boring32::Util::Crc32c(bytes));
+				Assert::AreEqual(0u, Boring32::Util::Crc32c({}));
+				// Checksumming in parts gives the same result
+				Assert::AreEqual(
+					Boring32::Util::Crc32c(bytes),
+					Boring32::Util::Crc32c(bytes.subspan(4), Boring32::Util::Crc32c(bytes.first(4)))
+				);
+			}
 	};
 }
\ No newline at end of file
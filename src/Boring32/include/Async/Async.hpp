@@ -19,4 +19,35 @@
 #include "SynchronizationBarrier.hpp"
 #include "ThreadPool.hpp"
 #include "EventLoop.hpp"
-#include "AsyncFuncs.hpp"
\ No newline at end of file
+#include "AsyncFuncs.hpp"
+#include "RateLimiter.hpp"
+#include "KeyedRateLimiter.hpp"
+#include "ThreadCache.hpp"
+#include "PooledThread.hpp"
+#include "ProcessPool.hpp"
+#include "ProcessPoolWorker.hpp"
+#include "ByteBufferPool.hpp"
+#include "ProcessOutputCapture.hpp"
+#include "ProcessSnapshot.hpp"
+#include "OverlappedPool.hpp"
+#include "VectoredIo.hpp"
+#include "FlowControl.hpp"
+#include "FileMappingView.hpp"
+#include "FileMapping.hpp"
+#include "SlidingFileView.hpp"
+#include "MappedJournalSegment.hpp"
+#include "MappedJournalWriter.hpp"
+#include "MappedJournalReader.hpp"
+#include "OffsetPtr.hpp"
+#include "SharedHeap.hpp"
+#include "SharedHeapResource.hpp"
+#include "SharedHashTable.hpp"
+#include "MemoryMappedVector.hpp"
+#include "DurableQueueSegment.hpp"
+#include "DurableQueueProducer.hpp"
+#include "DurableQueueConsumer.hpp"
+#include "FlatMessageView.hpp"
+#include "FlatMessageBuilder.hpp"
+#include "BroadcastRingLayout.hpp"
+#include "BroadcastRingPublisher.hpp"
+#include "BroadcastRingSubscriber.hpp"
\ No newline at end of file
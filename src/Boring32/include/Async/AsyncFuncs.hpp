@@ -51,7 +51,9 @@ namespace Boring32::Async
 	);
 
 	/// <summary>
-	///		Find a process' ID by its name.
+	///		Find a process' ID by its name. This takes a new snapshot
+	///		of the process table on every call; use ProcessSnapshot
+	///		when looking up processes repeatedly.
 	/// </summary>
 	/// <param name="processName">
 	///		The name of the process to search for.
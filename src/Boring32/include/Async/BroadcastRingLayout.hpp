@@ -0,0 +1,100 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <cstddef>
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		The header at the start of a broadcast ring's section. It is
+	///		followed by MaxSubscribers subscriber entries, then SlotCount
+	///		slots of SlotSize bytes. Fields written by different parties
+	///		are on separate cache lines.
+	/// </summary>
+	struct BroadcastRingHeader
+	{
+		static constexpr UINT32 CurrentMagic = 0x52424232; // "2BBR"
+		static constexpr UINT32 CurrentVersion = 1;
+
+		UINT32 Magic;
+		UINT32 Version;
+		UINT32 SlotCount;
+		UINT32 SlotSize;
+		UINT32 MaxSubscribers;
+		UINT32 Reserved;
+		// The number of messages published, which is the sequence of
+		// the next message
+		alignas(64) UINT64 Published;
+		// The number of subscribers blocked, or about to block, in a
+		// wait, so the publisher only looks for them when there are some
+		alignas(64) UINT32 WaiterCount;
+	};
+
+	/// <summary>
+	///		A subscriber's entry, which claims one of the ring's wake-up
+	///		events while the subscriber is attached.
+	/// </summary>
+	struct alignas(64) BroadcastRingSubscriberEntry
+	{
+		// 0 when free and 1 when claimed
+		UINT32 State;
+		// The claiming process, so entries left by processes that exited
+		// without detaching can be reclaimed
+		UINT32 ProcessId;
+		// 1 while the subscriber is waiting on its event. Whoever sets it
+		// back to 0 decrements the header's WaiterCount.
+		UINT32 Waiting;
+	};
+
+	/// <summary>
+	///		The header of a slot, followed by the message. Sequence is
+	///		2 * (s + 1) once message s is written, and odd while a message
+	///		is being written, so readers can tell when a slot they copied
+	///		was overwritten.
+	/// </summary>
+	struct BroadcastRingSlotHeader
+	{
+		UINT64 Sequence;
+		UINT32 Size;
+		UINT32 Reserved;
+	};
+
+	constexpr UINT64 GetBroadcastRingSize(
+		const UINT32 slotCount,
+		const UINT32 slotSize,
+		const UINT32 maxSubscribers
+	) noexcept
+	{
+		return sizeof(BroadcastRingHeader)
+			+ static_cast<UINT64>(maxSubscribers) * sizeof(BroadcastRingSubscriberEntry)
+			+ static_cast<UINT64>(slotCount) * slotSize;
+	}
+
+	inline BroadcastRingSubscriberEntry* GetBroadcastRingSubscriber(
+		BroadcastRingHeader* header,
+		const UINT32 index
+	) noexcept
+	{
+		return reinterpret_cast<BroadcastRingSubscriberEntry*>(header + 1) + index;
+	}
+
+	inline BroadcastRingSlotHeader* GetBroadcastRingSlot(
+		BroadcastRingHeader* header,
+		const UINT64 sequence
+	) noexcept
+	{
+		std::byte* slots = reinterpret_cast<std::byte*>(GetBroadcastRingSubscriber(header, header->MaxSubscribers));
+		return reinterpret_cast<BroadcastRingSlotHeader*>(
+			slots + (sequence & (header->SlotCount - 1)) * header->SlotSize
+		);
+	}
+
+	/// <summary>
+	///		Returns the name of the auto-reset event that wakes the
+	///		subscriber holding entry index.
+	/// </summary>
+	inline std::wstring GetBroadcastRingEventName(const std::wstring& ringName, const UINT32 index)
+	{
+		return ringName + L".Subscriber." + std::to_wstring(index);
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <span>
+#include <vector>
+#include <cstddef>
+#include "MemoryMappedFile.hpp"
+#include "Event.hpp"
+#include "BroadcastRingLayout.hpp"
+
+namespace Boring32::Async
+{
+	struct BroadcastRingSettings
+	{
+		/// <summary>
+		///		The number of messages the ring holds, which must be a
+		///		power of two. Subscribers that fall further behind than
+		///		this are lapped and lose messages.
+		/// </summary>
+		UINT32 SlotCount = 4096;
+		/// <summary>
+		///		The size of each slot, a multiple of 64 bytes. Messages can
+		///		be up to SlotSize - sizeof(BroadcastRingSlotHeader) bytes.
+		/// </summary>
+		UINT32 SlotSize = 256;
+		/// <summary>
+		///		The number of subscribers that can attach at once.
+		/// </summary>
+		UINT32 MaxSubscribers = 64;
+		/// <summary>
+		///		Options for the underlying MemoryMappedFile.
+		/// </summary>
+		MemoryMappedFileOptions Mapping;
+	};
+
+	/// <summary>
+	///		Publishes messages to a ring in a named MemoryMappedFile that
+	///		any number of BroadcastRingSubscribers, in any process, read
+	///		from. Each message is written once, however many subscribers
+	///		there are, and the publisher never waits for subscribers:
+	///		those that fall a full ring behind are lapped and skip ahead.
+	///		Subscribers that block waiting for messages are woken through
+	///		their own named event. There must be only one publisher.
+	/// </summary>
+	class BroadcastRingPublisher
+	{
+		public:
+			virtual ~BroadcastRingPublisher();
+			BroadcastRingPublisher();
+			/// <summary>
+			///		Creates a ring. Throws if a ring with this name exists.
+			/// </summary>
+			BroadcastRingPublisher(std::wstring name);
+			BroadcastRingPublisher(std::wstring name, const BroadcastRingSettings& settings);
+
+		// Non-copyable, movable
+		public:
+			BroadcastRingPublisher(const BroadcastRingPublisher&) = delete;
+			virtual BroadcastRingPublisher& operator=(const BroadcastRingPublisher&) = delete;
+			BroadcastRingPublisher(BroadcastRingPublisher&& other) noexcept;
+			virtual BroadcastRingPublisher& operator=(BroadcastRingPublisher&& other) noexcept;
+
+		public:
+			/// <summary>
+			///		Publishes a message and wakes any waiting subscribers.
+			///		Throws std::invalid_argument if the message does not
+			///		fit in a slot.
+			/// </summary>
+			/// <returns>The message's sequence number.</returns>
+			virtual UINT64 Publish(const std::span<const std::byte> message);
+
+			/// <summary>
+			///		Returns the number of messages published, including
+			///		those published before this object was created.
+			/// </summary>
+			virtual UINT64 GetPublishedCount() const noexcept;
+			virtual UINT32 GetSubscriberCount() const noexcept;
+			virtual size_t GetMaxMessageSize() const noexcept;
+			virtual const std::wstring& GetName() const noexcept;
+			virtual void Close();
+
+		protected:
+			virtual void WakeSubscribers();
+			virtual void Move(BroadcastRingPublisher& other) noexcept;
+
+		protected:
+			std::wstring m_name;
+			MemoryMappedFile m_memory;
+			BroadcastRingHeader* m_header;
+			std::vector<Event> m_events;
+	};
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "MemoryMappedFile.hpp"
+#include "Event.hpp"
+#include "BroadcastRingLayout.hpp"
+
+namespace Boring32::Async
+{
+	enum class BroadcastRingStart
+	{
+		/// <summary>
+		///		Receive only messages published after joining.
+		/// </summary>
+		Latest,
+		/// <summary>
+		///		Receive the messages still in the ring, then new ones.
+		/// </summary>
+		Oldest
+	};
+
+	struct BroadcastRingSubscriberSettings
+	{
+		BroadcastRingStart Start = BroadcastRingStart::Latest;
+		/// <summary>
+		///		How many times Receive() checks for a message before
+		///		blocking on its event. Spinning cuts latency when messages
+		///		arrive often, at the cost of CPU time.
+		/// </summary>
+		DWORD SpinCount = 64;
+	};
+
+	enum class BroadcastReceiveResult
+	{
+		/// <summary>
+		///		No message was published in time.
+		/// </summary>
+		Empty,
+		Message,
+		/// <summary>
+		///		The publisher overwrote messages before they were read.
+		///		The subscriber has skipped ahead, and GetLostCount() has
+		///		been increased by the number of messages skipped.
+		/// </summary>
+		Lapped
+	};
+
+	/// <summary>
+	///		Reads the messages published to a BroadcastRingPublisher's
+	///		ring. Each subscriber has its own cursor, so subscribers read
+	///		at their own pace and do not affect the publisher or each
+	///		other. Not thread safe; use one subscriber per thread.
+	/// </summary>
+	class BroadcastRingSubscriber
+	{
+		public:
+			virtual ~BroadcastRingSubscriber();
+			BroadcastRingSubscriber();
+			/// <summary>
+			///		Attaches to an existing ring. Throws if it has
+			///		MaxSubscribers subscribers already.
+			/// </summary>
+			BroadcastRingSubscriber(std::wstring name);
+			BroadcastRingSubscriber(std::wstring name, const BroadcastRingSubscriberSettings& settings);
+
+		// Non-copyable, movable
+		public:
+			BroadcastRingSubscriber(const BroadcastRingSubscriber&) = delete;
+			virtual BroadcastRingSubscriber& operator=(const BroadcastRingSubscriber&) = delete;
+			BroadcastRingSubscriber(BroadcastRingSubscriber&& other) noexcept;
+			virtual BroadcastRingSubscriber& operator=(BroadcastRingSubscriber&& other) noexcept;
+
+		public:
+			/// <summary>
+			///		Copies the next message into message without waiting.
+			/// </summary>
+			virtual BroadcastReceiveResult TryReceive(std::vector<std::byte>& message);
+
+			/// <summary>
+			///		Copies the next message into message, waiting up to
+			///		timeoutMillis for one to be published.
+			/// </summary>
+			virtual BroadcastReceiveResult Receive(std::vector<std::byte>& message, const DWORD timeoutMillis);
+
+			/// <summary>
+			///		Returns the sequence number of the next message to read.
+			/// </summary>
+			virtual UINT64 GetCursor() const noexcept;
+			/// <summary>
+			///		Returns the number of messages this subscriber has
+			///		missed by being lapped.
+			/// </summary>
+			virtual UINT64 GetLostCount() const noexcept;
+			/// <summary>
+			///		Returns the number of published messages not yet read,
+			///		which can exceed the ring's size if lapped.
+			/// </summary>
+			virtual UINT64 GetBacklog() const noexcept;
+			virtual const std::wstring& GetName() const noexcept;
+			/// <summary>
+			///		Detaches from the ring, freeing this subscriber's entry.
+			/// </summary>
+			virtual void Close();
+
+		protected:
+			virtual void Join(const BroadcastRingStart start);
+			/// <summary>
+			///		Skips ahead after being lapped, to halfway back through
+			///		the ring so the next read is not immediately lapped too.
+			/// </summary>
+			virtual void SkipAhead();
+			/// <summary>
+			///		Blocks on this subscriber's event until a message is
+			///		published or millis elapses.
+			/// </summary>
+			virtual void Wait(const DWORD millis);
+			/// <summary>
+			///		Clears an entry's waiting flag, removing it from the
+			///		ring's waiter count if it was set.
+			/// </summary>
+			virtual void ClearWaiting(BroadcastRingSubscriberEntry* entry) noexcept;
+			virtual void Move(BroadcastRingSubscriber& other) noexcept;
+
+		protected:
+			std::wstring m_name;
+			BroadcastRingSubscriberSettings m_settings;
+			MemoryMappedFile m_memory;
+			BroadcastRingHeader* m_header;
+			BroadcastRingSubscriberEntry* m_entry;
+			Event m_event;
+			UINT64 m_cursor;
+			UINT64 m_lost;
+	};
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <Windows.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "Event.hpp"
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		A thread-safe pool of fixed-size byte buffers. Buffers are
+	///		allocated on demand up to maxBuffers and are reused after
+	///		being released, so steady-state I/O does not allocate.
+	/// </summary>
+	class ByteBufferPool
+	{
+		public:
+			virtual ~ByteBufferPool();
+			ByteBufferPool(const size_t bufferSize, const size_t maxBuffers);
+
+		// Non-copyable, non-movable
+		public:
+			ByteBufferPool(const ByteBufferPool&) = delete;
+			virtual ByteBufferPool& operator=(const ByteBufferPool&) = delete;
+			ByteBufferPool(ByteBufferPool&&) noexcept = delete;
+			virtual ByteBufferPool& operator=(ByteBufferPool&&) noexcept = delete;
+
+		public:
+			/// <summary>
+			///		Returns a buffer of GetBufferSize() bytes, waiting up to
+			///		waitMillis for one to be released if all maxBuffers are
+			///		in use. Returns nullptr if the wait times out.
+			/// </summary>
+			virtual std::byte* Acquire(const DWORD waitMillis);
+
+			/// <summary>
+			///		Returns a buffer obtained from Acquire() to the pool.
+			///		Throws std::invalid_argument if the buffer is not from
+			///		this pool or has already been released.
+			/// </summary>
+			virtual void Release(std::byte* buffer);
+
+			virtual size_t GetBufferSize() const noexcept;
+			virtual size_t GetMaxBuffers() const noexcept;
+			/// <summary>
+			///		The number of buffers that can be acquired without waiting.
+			/// </summary>
+			virtual size_t GetAvailableCount();
+			/// <summary>
+			///		An auto-reset event that is signalled when a buffer is
+			///		released, for callers that wait on other objects too.
+			/// </summary>
+			virtual HANDLE GetReleasedHandle() const noexcept;
+
+		protected:
+			size_t m_bufferSize;
+			size_t m_maxBuffers;
+			std::vector<std::unique_ptr<std::byte[]>> m_buffers;
+			std::vector<std::byte*> m_free;
+			Event m_released;
+			CRITICAL_SECTION m_cs;
+	};
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <optional>
+#include <cstddef>
+#include "FileMapping.hpp"
+#include "FileMappingView.hpp"
+#include "DurableQueueSegment.hpp"
+#include "DurableQueueProducer.hpp"
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		Reads the records of a DurableQueue in order, following the
+	///		producer as it appends and moves to new segments. Each consumer
+	///		has a name and keeps its own position in a file in the queue's
+	///		directory, so consumers do not affect each other and resume
+	///		where they left off. Records read since the last Commit() are
+	///		read again after a restart, so delivery is at least once. The
+	///		producer only recycles segments that every consumer has passed.
+	/// </summary>
+	class DurableQueueConsumer
+	{
+		public:
+			virtual ~DurableQueueConsumer();
+			/// <summary>
+			///		Opens or registers the consumer called name. A new
+			///		consumer starts at the oldest record in the queue.
+			/// </summary>
+			DurableQueueConsumer(std::wstring directory, std::wstring name);
+			DurableQueueConsumer(
+				std::wstring directory,
+				std::wstring name,
+				const DurableQueueSettings& settings
+			);
+
+		// Non-copyable, movable
+		public:
+			DurableQueueConsumer(const DurableQueueConsumer&) = delete;
+			virtual DurableQueueConsumer& operator=(const DurableQueueConsumer&) = delete;
+			DurableQueueConsumer(DurableQueueConsumer&&) noexcept = default;
+			virtual DurableQueueConsumer& operator=(DurableQueueConsumer&&) noexcept = default;
+
+		public:
+			/// <summary>
+			///		Reads the next record if one has been written.
+			/// </summary>
+			/// <returns>True if a record was read, false if the consumer has caught up with the producer.</returns>
+			virtual bool TryDequeue(std::vector<std::byte>& record);
+
+			/// <summary>
+			///		Saves the consumer's position, so that records read so
+			///		far are not read again, and the segments they were in
+			///		can be recycled. The position is flushed to disk unless
+			///		Durability is None.
+			/// </summary>
+			virtual void Commit();
+			virtual bool Commit(std::nothrow_t) noexcept;
+
+			/// <summary>
+			///		Returns the position of the next record to read.
+			/// </summary>
+			virtual DurableQueuePosition GetPosition() const noexcept;
+			virtual const std::wstring& GetName() const noexcept;
+			virtual const std::wstring& GetDirectory() const noexcept;
+
+		public:
+			/// <summary>
+			///		Returns the names of the consumers registered with the
+			///		queue in directory.
+			/// </summary>
+			static std::vector<std::wstring> GetConsumers(const std::wstring& directory);
+			/// <summary>
+			///		Returns the last committed position of a consumer, or
+			///		nothing if it has not committed one.
+			/// </summary>
+			static std::optional<DurableQueuePosition> LoadPosition(
+				const std::wstring& directory,
+				const std::wstring& name
+			);
+			/// <summary>
+			///		Unregisters a consumer, so that it no longer holds back
+			///		segment recycling. The consumer must not be open.
+			/// </summary>
+			static void Remove(const std::wstring& directory, const std::wstring& name);
+
+		protected:
+			virtual bool OpenSegment();
+
+		protected:
+			std::wstring m_directory;
+			std::wstring m_name;
+			DurableQueueSettings m_settings;
+			DurableQueueSegment m_segment;
+			DurableQueuePosition m_position;
+			UINT64 m_sequence;
+			FileMapping m_positionFile;
+			FileMappingView m_positionView;
+	};
+}
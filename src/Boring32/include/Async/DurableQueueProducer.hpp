@@ -0,0 +1,127 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <span>
+#include <optional>
+#include <cstddef>
+#include "DurableQueueSegment.hpp"
+
+namespace Boring32::Async
+{
+	enum class DurableQueueDurability
+	{
+		/// <summary>
+		///		Records reach the disk when the system writes back the
+		///		mapped pages, or when Flush() is called. They survive the
+		///		process crashing, but not the system.
+		/// </summary>
+		None,
+		/// <summary>
+		///		Records are flushed to disk in batches, bounded by
+		///		GroupCommitRecords and GroupCommitBytes.
+		/// </summary>
+		GroupCommit,
+		/// <summary>
+		///		Every record is flushed to disk before Enqueue() returns.
+		/// </summary>
+		EveryRecord
+	};
+
+	struct DurableQueueSettings
+	{
+		/// <summary>
+		///		The size of each segment file, which bounds the largest
+		///		record. The producer and consumers of a queue must agree.
+		/// </summary>
+		UINT64 SegmentSize = 64 * 1024 * 1024;
+		DurableQueueDurability Durability = DurableQueueDurability::GroupCommit;
+		/// <summary>
+		///		With GroupCommit, flush once this many records are pending.
+		/// </summary>
+		UINT32 GroupCommitRecords = 256;
+		/// <summary>
+		///		With GroupCommit, flush once this many bytes are pending.
+		/// </summary>
+		UINT64 GroupCommitBytes = 1024 * 1024;
+		/// <summary>
+		///		Reuse segment files that every consumer has finished with,
+		///		rather than creating new ones. Consumed segments are kept
+		///		if no consumers are registered.
+		/// </summary>
+		bool RecycleSegments = true;
+	};
+
+	/// <summary>
+	///		Appends records to a crash-safe FIFO queue of memory mapped
+	///		segment files in a directory, for DurableQueueConsumers in any
+	///		process to read. Records are checksummed, so a record torn by a
+	///		crash is discarded when the producer next opens the queue, and
+	///		is never seen by consumers. A queue has a single producer, and
+	///		a producer is not thread-safe.
+	/// </summary>
+	class DurableQueueProducer
+	{
+		public:
+			/// <summary>
+			///		Flushes pending records unless Durability is None.
+			/// </summary>
+			virtual ~DurableQueueProducer();
+			/// <summary>
+			///		Opens the queue in directory, creating the directory if
+			///		it does not exist, and recovers its write position by
+			///		validating the records of its last segment.
+			/// </summary>
+			DurableQueueProducer(std::wstring directory);
+			DurableQueueProducer(std::wstring directory, const DurableQueueSettings& settings);
+
+		// Non-copyable, movable
+		public:
+			DurableQueueProducer(const DurableQueueProducer&) = delete;
+			virtual DurableQueueProducer& operator=(const DurableQueueProducer&) = delete;
+			DurableQueueProducer(DurableQueueProducer&&) noexcept = default;
+			virtual DurableQueueProducer& operator=(DurableQueueProducer&&) noexcept = default;
+
+		public:
+			virtual void Enqueue(const std::span<const std::byte> record);
+			virtual bool Enqueue(const std::span<const std::byte> record, std::nothrow_t) noexcept;
+
+			/// <summary>
+			///		Writes pending records to disk and waits for the disk's
+			///		cache, regardless of Durability.
+			/// </summary>
+			virtual void Flush();
+			virtual bool Flush(std::nothrow_t) noexcept;
+
+			/// <summary>
+			///		Returns the position the next record will be written at.
+			/// </summary>
+			virtual DurableQueuePosition GetPosition() const noexcept;
+			/// <summary>
+			///		Returns the largest record that fits in a segment.
+			/// </summary>
+			virtual size_t GetMaxRecordSize() const noexcept;
+			virtual const std::wstring& GetDirectory() const noexcept;
+			virtual const DurableQueueSettings& GetSettings() const noexcept;
+
+		protected:
+			virtual void Recover();
+			/// <summary>
+			///		Finishes the current segment and moves to the next,
+			///		recycling a consumed segment's file if one is free.
+			/// </summary>
+			virtual void OpenNextSegment();
+			/// <summary>
+			///		Returns the oldest segment that every consumer has
+			///		moved past, if there is one.
+			/// </summary>
+			virtual std::optional<UINT64> GetRecyclableSegment(const UINT64 next) const;
+
+		protected:
+			std::wstring m_directory;
+			DurableQueueSettings m_settings;
+			DurableQueueSegment m_segment;
+			UINT64 m_offset;
+			UINT64 m_flushedOffset;
+			UINT32 m_pendingRecords;
+	};
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <span>
+#include <vector>
+#include <cstddef>
+#include "FileMapping.hpp"
+#include "FileMappingView.hpp"
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		A position in a DurableQueue: a segment index and the offset
+	///		of a record within that segment.
+	/// </summary>
+	struct DurableQueuePosition
+	{
+		UINT64 Segment = 0;
+		UINT64 Offset = 0;
+	};
+
+	/// <summary>
+	///		One fixed-size file of a DurableQueue. The file starts with a
+	///		header, followed by records. Each record is an 8 byte header,
+	///		holding the payload's length and a CRC-32C checksum, followed
+	///		by the payload, padded to a multiple of 8 bytes. The checksum
+	///		covers the segment's index, so that records left in a recycled
+	///		file, or torn by a crash, read as not yet written.
+	/// </summary>
+	class DurableQueueSegment
+	{
+		public:
+			enum class ReadResult
+			{
+				/// <summary>
+				///		No valid record has been written at the offset yet.
+				/// </summary>
+				NotReady,
+				Record,
+				/// <summary>
+				///		No more records fit; continue in the next segment.
+				/// </summary>
+				End
+			};
+
+			static constexpr UINT64 HeaderSize = 64;
+			static constexpr UINT64 RecordHeaderSize = 8;
+
+		public:
+			virtual ~DurableQueueSegment();
+			DurableQueueSegment();
+			/// <summary>
+			///		Opens segment index of the queue in directory. A writable
+			///		segment is created if it does not exist, and its header
+			///		is claimed for index. A read-only segment that the
+			///		producer has not finished creating or recycling is left
+			///		closed; check IsOpen().
+			/// </summary>
+			DurableQueueSegment(
+				const std::wstring& directory,
+				const UINT64 index,
+				const UINT64 size,
+				const bool writable
+			);
+
+		// Non-copyable, movable
+		public:
+			DurableQueueSegment(const DurableQueueSegment&) = delete;
+			virtual DurableQueueSegment& operator=(const DurableQueueSegment&) = delete;
+			DurableQueueSegment(DurableQueueSegment&& other) noexcept;
+			virtual DurableQueueSegment& operator=(DurableQueueSegment&& other) noexcept;
+
+		public:
+			/// <summary>
+			///		Writes a record at offset. If the record does not fit,
+			///		an end marker is written instead.
+			/// </summary>
+			/// <returns>True if the record was written, false if the segment is full.</returns>
+			virtual bool Write(const UINT64 offset, const std::span<const std::byte> payload);
+
+			/// <summary>
+			///		Reads and validates the record at offset. On success,
+			///		payload refers to the record's bytes in the mapping.
+			/// </summary>
+			virtual ReadResult Read(const UINT64 offset, std::span<const std::byte>& payload) const;
+
+			/// <summary>
+			///		Writes a range of the segment to disk, and waits for the
+			///		disk's cache if durable is true. Pass a length of 0 to
+			///		flush to the end of the segment.
+			/// </summary>
+			virtual void Flush(const UINT64 offset, const size_t length, const bool durable);
+
+			virtual bool IsOpen() const noexcept;
+			virtual UINT64 GetIndex() const noexcept;
+			virtual UINT64 GetSize() const noexcept;
+
+		public:
+			static std::wstring GetSegmentPath(const std::wstring& directory, const UINT64 index);
+			/// <summary>
+			///		Returns the indexes of the segments in directory, in
+			///		ascending order.
+			/// </summary>
+			static std::vector<UINT64> GetSegments(const std::wstring& directory);
+			/// <summary>
+			///		Renames segment from to segment to, so that its file can
+			///		be reused without allocating new disk space. Fails if
+			///		the file is open.
+			/// </summary>
+			static bool Recycle(const std::wstring& directory, const UINT64 from, const UINT64 to);
+			static UINT64 GetRecordSize(const size_t length) noexcept;
+
+		protected:
+			virtual void Move(DurableQueueSegment& other) noexcept;
+
+		protected:
+			FileMapping m_mapping;
+			FileMappingView m_view;
+			UINT64 m_index;
+			UINT64 m_size;
+	};
+}
@@ -0,0 +1,88 @@
+#pragma once
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+#include <cstdint>
+#include <string>
+#ifdef _WIN32
+#include "../Raii/Win32Handle.hpp"
+#endif
+#include "FileMappingView.hpp"
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		A file-backed section with a 64-bit size, for working with
+	///		files too large to map in one view. Unlike MemoryMappedFile,
+	///		which maps one pagefile-backed view of the whole section, this
+	///		maps nothing by itself: ranges are mapped on demand with
+	///		MapView(), or through a SlidingFileView. On Linux there is no
+	///		section object: this holds the open file, and each view maps
+	///		it with mmap().
+	/// </summary>
+	class FileMapping
+	{
+		public:
+			virtual ~FileMapping();
+			FileMapping();
+
+			/// <summary>
+			///		Maps an existing file at its current size.
+			/// </summary>
+			FileMapping(const std::wstring& path, const bool writable);
+
+			/// <summary>
+			///		Maps a file, which is created if it does not exist when
+			///		writable is true. Files smaller than size are extended
+			///		to it, which requires writable to be true. Pass a size
+			///		of 0 to map the file at its current size.
+			/// </summary>
+			FileMapping(const std::wstring& path, const bool writable, const std::uint64_t size);
+
+		// Non-copyable, movable
+		public:
+			FileMapping(const FileMapping&) = delete;
+			virtual FileMapping& operator=(const FileMapping&) = delete;
+			FileMapping(FileMapping&& other) noexcept;
+			virtual FileMapping& operator=(FileMapping&& other) noexcept;
+
+		public:
+			/// <summary>
+			///		Maps length bytes starting at offset. Pass a length of 0
+			///		to map to the end of the file.
+			/// </summary>
+			virtual FileMappingView MapView(const std::uint64_t offset, const size_t length) const;
+
+			virtual void Close();
+			virtual std::uint64_t GetSize() const noexcept;
+			virtual bool IsWritable() const noexcept;
+			virtual const std::wstring& GetPath() const noexcept;
+#ifdef _WIN32
+			virtual HANDLE GetMappingHandle() const noexcept;
+			virtual HANDLE GetFileHandle() const noexcept;
+#else
+			virtual int GetFileDescriptor() const noexcept;
+#endif
+
+		public:
+			/// <summary>
+			///		Returns the alignment required of view offsets, which
+			///		is usually 64KB on Windows and the page size on Linux.
+			/// </summary>
+			static std::uint32_t GetAllocationGranularity() noexcept;
+
+		protected:
+			virtual void Move(FileMapping& other) noexcept;
+
+		protected:
+			std::wstring m_path;
+#ifdef _WIN32
+			Raii::Win32Handle m_file;
+			Raii::Win32Handle m_mapping;
+#else
+			int m_file;
+#endif
+			std::uint64_t m_size;
+			bool m_writable;
+	};
+}
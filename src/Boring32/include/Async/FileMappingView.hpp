@@ -0,0 +1,74 @@
+#pragma once
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+#include <cstdint>
+#include <span>
+#include <cstddef>
+
+namespace Boring32::Async
+{
+	class FileMapping;
+
+	/// <summary>
+	///		A view of part of a FileMapping, unmapped when this object is
+	///		destroyed. Offsets do not need to be aligned: the view is
+	///		mapped from the allocation granularity boundary below the
+	///		offset, and GetData() covers exactly the requested range.
+	/// </summary>
+	class FileMappingView
+	{
+		public:
+			virtual ~FileMappingView();
+			FileMappingView();
+			/// <summary>
+			///		Maps length bytes of mapping starting at offset. The
+			///		mapping must remain open while the view is in use.
+			/// </summary>
+			FileMappingView(const FileMapping& mapping, const std::uint64_t offset, const size_t length);
+
+		// Non-copyable, movable
+		public:
+			FileMappingView(const FileMappingView&) = delete;
+			virtual FileMappingView& operator=(const FileMappingView&) = delete;
+			FileMappingView(FileMappingView&& other) noexcept;
+			virtual FileMappingView& operator=(FileMappingView&& other) noexcept;
+
+		public:
+			virtual std::span<std::byte> GetData() const noexcept;
+			virtual std::uint64_t GetOffset() const noexcept;
+			virtual size_t GetSize() const noexcept;
+			/// <summary>
+			///		Returns the address space taken by the view, including
+			///		the alignment slack before the requested offset.
+			/// </summary>
+			virtual size_t GetMappedSize() const noexcept;
+			virtual bool Contains(const std::uint64_t offset, const size_t length) const noexcept;
+			virtual bool IsValid() const noexcept;
+
+			/// <summary>
+			///		Writes modified pages in the view to the file. This does
+			///		not flush the file's metadata or the disk's cache.
+			/// </summary>
+			virtual void Flush();
+
+			/// <summary>
+			///		Asks the system to read the view's pages in ahead of
+			///		use, in large I/Os rather than one page fault at a time.
+			/// </summary>
+			virtual void Prefetch();
+			virtual bool Prefetch(std::nothrow_t) noexcept;
+
+			virtual void Close() noexcept;
+
+		protected:
+			virtual void Move(FileMappingView& other) noexcept;
+
+		protected:
+			void* m_base;
+			std::byte* m_data;
+			std::uint64_t m_offset;
+			size_t m_size;
+			size_t m_mappedSize;
+	};
+}
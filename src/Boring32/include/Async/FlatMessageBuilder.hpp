@@ -0,0 +1,133 @@
+#pragma once
+#include <Windows.h>
+#include <span>
+#include <string_view>
+#include <stdexcept>
+#include <type_traits>
+#include <cstring>
+#include <cstddef>
+#include "FlatMessageView.hpp"
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		Writes a message, readable in place with a FlatMessageView, into
+	///		a buffer supplied by the caller. The builder never allocates:
+	///		fields are appended to the buffer as they are added, and adding
+	///		a field that does not fit throws std::length_error, leaving the
+	///		fields added so far intact. Fields may be added in any order,
+	///		and fields that are not added read as absent. Adding a field
+	///		again replaces it, but the space taken by the old value is not
+	///		reclaimed.
+	/// </summary>
+	class FlatMessageBuilder
+	{
+		public:
+			static constexpr size_t ArrayHeaderSize = 8;
+			static constexpr size_t MaxAlignment = 8;
+
+		public:
+			virtual ~FlatMessageBuilder();
+			/// <summary>
+			///		Starts a message with room in its vtable for fieldCount
+			///		fields. The buffer must be 8 byte aligned.
+			/// </summary>
+			FlatMessageBuilder(const std::span<std::byte> buffer, const UINT16 fieldCount);
+
+		// Non-copyable, movable
+		public:
+			FlatMessageBuilder(const FlatMessageBuilder&) = delete;
+			virtual FlatMessageBuilder& operator=(const FlatMessageBuilder&) = delete;
+			FlatMessageBuilder(FlatMessageBuilder&&) noexcept = default;
+			virtual FlatMessageBuilder& operator=(FlatMessageBuilder&&) noexcept = default;
+
+		public:
+			template<typename T> requires std::is_trivially_copyable_v<T> && (alignof(T) <= MaxAlignment)
+			void Add(const UINT16 field, const T& value)
+			{
+				const UINT32 offset = Allocate(field, sizeof(T), alignof(T));
+				std::memcpy(m_buffer.data() + offset, &value, sizeof(T));
+				SetFieldOffset(field, offset);
+			}
+
+			template<typename T> requires std::is_trivially_copyable_v<T> && (alignof(T) <= MaxAlignment)
+			void AddArray(const UINT16 field, const std::span<const T> values)
+			{
+				const std::span<std::byte> bytes = AllocateArray(field, values.size(), sizeof(T));
+				if (!values.empty())
+					std::memcpy(bytes.data(), values.data(), values.size_bytes());
+			}
+
+			/// <summary>
+			///		Adds an array field of count elements and returns them,
+			///		so that they can be written in place. The elements are
+			///		zeroed.
+			/// </summary>
+			template<typename T> requires std::is_trivially_copyable_v<T> && (alignof(T) <= MaxAlignment)
+			std::span<T> ReserveArray(const UINT16 field, const size_t count)
+			{
+				const std::span<std::byte> bytes = AllocateArray(field, count, sizeof(T));
+				std::memset(bytes.data(), 0, bytes.size());
+				return { reinterpret_cast<T*>(bytes.data()), count };
+			}
+
+			virtual void AddString(const UINT16 field, const std::string_view value);
+			virtual void AddString(const UINT16 field, const std::wstring_view value);
+			/// <summary>
+			///		Adds a finished message as a field, which readers can
+			///		view in place with FlatMessageView::GetNested().
+			/// </summary>
+			virtual void AddNested(const UINT16 field, const FlatMessageView& message);
+
+			/// <summary>
+			///		Completes the message and returns its bytes, which
+			///		start at the beginning of the buffer. Fields can still
+			///		be added afterwards, after which Finish() must be called
+			///		again.
+			/// </summary>
+			virtual std::span<std::byte> Finish();
+
+			/// <summary>
+			///		Discards the fields added so far, and starts a new
+			///		message in the same buffer.
+			/// </summary>
+			virtual void Reset();
+
+			virtual size_t GetSize() const noexcept;
+			virtual size_t GetCapacity() const noexcept;
+			virtual UINT16 GetFieldCount() const noexcept;
+
+		public:
+			/// <summary>
+			///		Returns the size of the header and vtable of a message
+			///		with fieldCount fields, which is the smallest message.
+			/// </summary>
+			static constexpr size_t GetHeaderSize(const UINT16 fieldCount) noexcept
+			{
+				return AlignUp(sizeof(FlatMessageHeader) + fieldCount * sizeof(UINT32), MaxAlignment);
+			}
+
+		protected:
+			static constexpr size_t AlignUp(const size_t value, const size_t alignment) noexcept
+			{
+				return (value + alignment - 1) / alignment * alignment;
+			}
+
+			/// <summary>
+			///		Reserves length bytes at the given alignment for a
+			///		field and returns their offset.
+			/// </summary>
+			virtual UINT32 Allocate(const UINT16 field, const size_t length, const size_t alignment);
+			virtual std::span<std::byte> AllocateArray(
+				const UINT16 field,
+				const size_t count,
+				const size_t elementSize
+			);
+			virtual void SetFieldOffset(const UINT16 field, const UINT32 offset) noexcept;
+
+		protected:
+			std::span<std::byte> m_buffer;
+			size_t m_size;
+			UINT16 m_fieldCount;
+	};
+}
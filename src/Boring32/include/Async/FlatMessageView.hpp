@@ -0,0 +1,126 @@
+#pragma once
+#include <Windows.h>
+#include <span>
+#include <string_view>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <cstring>
+#include <cstddef>
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		The start of every FlatMessage. The header is followed by the
+	///		vtable, one UINT32 per field holding the field's offset from the
+	///		start of the message, or 0 if the field is absent, and then by
+	///		the fields themselves. Scalars are stored at their natural
+	///		alignment. Arrays and strings are stored as a UINT32 element
+	///		count, padded to 8 bytes, followed by the elements.
+	/// </summary>
+	struct FlatMessageHeader
+	{
+		static constexpr UINT32 MagicValue = 0x4D32424D; // "MB2M"
+		static constexpr UINT16 CurrentVersion = 1;
+
+		UINT32 Magic;
+		UINT16 Version;
+		UINT16 FieldCount;
+		/// <summary>
+		///		The size of the whole message, a multiple of 8.
+		/// </summary>
+		UINT32 Size;
+		UINT32 Reserved;
+	};
+
+	/// <summary>
+	///		Reads a message written by a FlatMessageBuilder in place, in a
+	///		received buffer or a mapped view, with no decode step: fields
+	///		are located through the vtable and read directly. The view
+	///		does not own the buffer, which must outlive it. Construction
+	///		validates the header and vtable, and every access is bounds
+	///		checked, so a view over untrusted bytes throws rather than
+	///		reading outside them. The format is schema-light: fields are
+	///		identified by index, and reader and writer must agree on their
+	///		types. A field that a writer did not set, or that an older
+	///		writer did not know about, reads as absent.
+	/// </summary>
+	class FlatMessageView
+	{
+		public:
+			virtual ~FlatMessageView();
+			FlatMessageView();
+			/// <summary>
+			///		Views the message at the start of buffer, which must be
+			///		8 byte aligned.
+			/// </summary>
+			FlatMessageView(const std::span<const std::byte> buffer);
+
+		public:
+			FlatMessageView(const FlatMessageView&) = default;
+			virtual FlatMessageView& operator=(const FlatMessageView&) = default;
+
+		public:
+			virtual bool Has(const UINT16 field) const noexcept;
+
+			template<typename T> requires std::is_trivially_copyable_v<T> && (alignof(T) <= 8)
+			std::optional<T> Get(const UINT16 field) const
+			{
+				const UINT32 offset = GetFieldOffset(field);
+				if (!offset)
+					return std::nullopt;
+				CheckRange(offset, sizeof(T), alignof(T));
+				T value;
+				std::memcpy(&value, m_data + offset, sizeof(T));
+				return value;
+			}
+
+			template<typename T> requires std::is_trivially_copyable_v<T> && (alignof(T) <= 8)
+			T Get(const UINT16 field, const T& defaultValue) const
+			{
+				const std::optional<T> value = Get<T>(field);
+				return value ? *value : defaultValue;
+			}
+
+			/// <summary>
+			///		Returns the elements of an array field, in place, or an
+			///		empty span if the field is absent.
+			/// </summary>
+			template<typename T> requires std::is_trivially_copyable_v<T> && (alignof(T) <= 8)
+			std::span<const T> GetArray(const UINT16 field) const
+			{
+				const std::span<const std::byte> bytes = GetArrayBytes(field, sizeof(T), alignof(T));
+				return { reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T) };
+			}
+
+			virtual std::string_view GetString(const UINT16 field) const;
+			virtual std::wstring_view GetWideString(const UINT16 field) const;
+			/// <summary>
+			///		Returns a message that was added as a field with
+			///		FlatMessageBuilder::AddNested(), or an empty view if the
+			///		field is absent.
+			/// </summary>
+			virtual FlatMessageView GetNested(const UINT16 field) const;
+
+			virtual UINT16 GetFieldCount() const noexcept;
+			virtual bool IsValid() const noexcept;
+			/// <summary>
+			///		Returns the bytes of the whole message.
+			/// </summary>
+			virtual std::span<const std::byte> GetData() const noexcept;
+
+		protected:
+			virtual UINT32 GetFieldOffset(const UINT16 field) const noexcept;
+			virtual void CheckRange(const UINT64 offset, const UINT64 length, const size_t alignment) const;
+			virtual std::span<const std::byte> GetArrayBytes(
+				const UINT16 field,
+				const size_t elementSize,
+				const size_t alignment
+			) const;
+
+		protected:
+			const std::byte* m_data;
+			UINT32 m_size;
+			UINT16 m_fieldCount;
+	};
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <Windows.h>
+#include <functional>
+
+namespace Boring32::Async
+{
+	struct FlowControlSettings
+	{
+		/// <summary>
+		///		The maximum number of messages in flight, or 0 for no limit.
+		/// </summary>
+		DWORD MaxMessages = 0;
+		/// <summary>
+		///		The maximum number of bytes in flight, or 0 for no limit. A
+		///		message larger than this is let through once nothing else
+		///		is in flight.
+		/// </summary>
+		UINT64 MaxBytes = 0;
+	};
+
+	struct FlowControlStats
+	{
+		/// <summary>
+		///		The number of times writers ran out of credit.
+		/// </summary>
+		UINT64 Stalls = 0;
+		/// <summary>
+		///		The total time from writers running out of credit until a
+		///		writer was next granted credit.
+		/// </summary>
+		UINT64 StalledMicroseconds = 0;
+		UINT64 PeakMessages = 0;
+		UINT64 PeakBytes = 0;
+	};
+
+	/// <summary>
+	///		Credit-based flow control for a stream of messages. Writers
+	///		acquire credit for each message before queuing it, blocking or
+	///		being refused when the limits on messages or bytes in flight are
+	///		reached, and the credit is released as each message is consumed.
+	///		A writer that is refused can be notified when credit returns.
+	///		Without limits, only the statistics are kept.
+	/// </summary>
+	class FlowControl
+	{
+		public:
+			/// <summary>
+			///		Invoked when credit is released after TryAcquire() was
+			///		refused, on the thread releasing it.
+			/// </summary>
+			using CreditHandler = std::function<void()>;
+
+		public:
+			virtual ~FlowControl();
+			FlowControl();
+			FlowControl(const FlowControlSettings& settings);
+			FlowControl(const FlowControlSettings& settings, CreditHandler onCreditAvailable);
+
+		// Non-copyable, non-movable
+		public:
+			FlowControl(const FlowControl&) = delete;
+			virtual FlowControl& operator=(const FlowControl&) = delete;
+			FlowControl(FlowControl&&) noexcept = delete;
+			virtual FlowControl& operator=(FlowControl&&) noexcept = delete;
+
+		public:
+			/// <summary>
+			///		Takes credit for one message of the given size if it is
+			///		available. If not, returns false and invokes the credit
+			///		handler once credit is next released.
+			/// </summary>
+			virtual bool TryAcquire(const UINT64 bytes);
+
+			/// <summary>
+			///		Takes credit for one message of the given size, waiting
+			///		up to timeoutMillis for it. Returns false if the wait
+			///		times out or Cancel() is called.
+			/// </summary>
+			virtual bool Acquire(const UINT64 bytes, const DWORD timeoutMillis);
+
+			/// <summary>
+			///		Returns the credit taken for one message of the given
+			///		size, waking writers waiting for credit.
+			/// </summary>
+			virtual void Release(const UINT64 bytes);
+
+			/// <summary>
+			///		Fails current and future acquisitions, and stops the
+			///		credit handler being invoked. Credit can still be released.
+			/// </summary>
+			virtual void Cancel();
+
+			virtual bool IsCancelled();
+			virtual UINT64 GetMessagesInFlight();
+			virtual UINT64 GetBytesInFlight();
+			virtual FlowControlStats GetStats();
+			virtual const FlowControlSettings& GetSettings() const noexcept;
+
+		protected:
+			// These expect m_cs to be held
+			virtual bool HasCredit(const UINT64 bytes) const noexcept;
+			virtual void Take(const UINT64 bytes);
+			virtual void BeginStall();
+
+		protected:
+			FlowControlSettings m_settings;
+			CreditHandler m_onCreditAvailable;
+			FlowControlStats m_stats;
+			UINT64 m_messages;
+			UINT64 m_bytes;
+			LARGE_INTEGER m_frequency;
+			LARGE_INTEGER m_stallStart;
+			bool m_stalled;
+			bool m_notifyPending;
+			bool m_cancelled;
+			CRITICAL_SECTION m_cs;
+			CONDITION_VARIABLE m_creditReleased;
+	};
+}
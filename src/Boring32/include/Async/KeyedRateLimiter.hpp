@@ -0,0 +1,111 @@
+#pragma once
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include "RateLimiter.hpp"
+#include "SlimReadWriteLock.hpp"
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		Maintains an independent RateLimiter per key, for example one
+	///		per tenant or per remote host. Limiters are created on first
+	///		use with the rate and burst given to the constructor. Lookups
+	///		of existing keys take a shared lock only.
+	/// </summary>
+	template<typename TKey, typename THash = std::hash<TKey>>
+	class KeyedRateLimiter
+	{
+		public:
+			virtual ~KeyedRateLimiter() {}
+
+			KeyedRateLimiter(const double tokensPerSecond, const UINT burst)
+			:	m_tokensPerSecond(tokensPerSecond),
+				m_burst(burst)
+			{
+				if (tokensPerSecond <= 0)
+					throw std::invalid_argument(__FUNCSIG__ ": tokensPerSecond must be greater than zero");
+				if (burst == 0)
+					throw std::invalid_argument(__FUNCSIG__ ": burst must be greater than zero");
+			}
+
+			KeyedRateLimiter(const KeyedRateLimiter&) = delete;
+			virtual KeyedRateLimiter& operator=(const KeyedRateLimiter&) = delete;
+
+		public:
+			virtual bool TryAcquire(const TKey& key, const UINT tokens)
+			{
+				return GetLimiter(key).TryAcquire(tokens);
+			}
+
+			virtual bool Acquire(const TKey& key, const UINT tokens, const DWORD millis)
+			{
+				return GetLimiter(key).Acquire(tokens, millis);
+			}
+
+			virtual RateLimiter::Awaitable AcquireAsync(const TKey& key, const UINT tokens)
+			{
+				return GetLimiter(key).AcquireAsync(tokens);
+			}
+
+			/// <summary>
+			///		Returns the limiter for the specified key, creating it if
+			///		it does not exist. The returned reference remains valid
+			///		until the key is erased or this object is destroyed.
+			/// </summary>
+			virtual RateLimiter& GetLimiter(const TKey& key)
+			{
+				m_lock.AcquireSharedLock();
+				auto iter = m_limiters.find(key);
+				if (iter != m_limiters.end())
+				{
+					RateLimiter& limiter = *iter->second;
+					m_lock.ReleaseSharedLock();
+					return limiter;
+				}
+				m_lock.ReleaseSharedLock();
+
+				m_lock.AcquireExclusiveLock();
+				try
+				{
+					auto& limiter = m_limiters[key];
+					if (limiter == nullptr)
+						limiter = std::make_unique<RateLimiter>(m_tokensPerSecond, m_burst);
+					RateLimiter& result = *limiter;
+					m_lock.ReleaseExclusiveLock();
+					return result;
+				}
+				catch (...)
+				{
+					m_lock.ReleaseExclusiveLock();
+					throw;
+				}
+			}
+
+			/// <summary>
+			///		Removes the limiter for the specified key. The caller must
+			///		ensure no other thread is using that limiter.
+			/// </summary>
+			virtual bool Erase(const TKey& key)
+			{
+				m_lock.AcquireExclusiveLock();
+				const bool erased = m_limiters.erase(key) > 0;
+				m_lock.ReleaseExclusiveLock();
+				return erased;
+			}
+
+			virtual size_t Size()
+			{
+				m_lock.AcquireSharedLock();
+				const size_t size = m_limiters.size();
+				m_lock.ReleaseSharedLock();
+				return size;
+			}
+
+		protected:
+			double m_tokensPerSecond;
+			UINT m_burst;
+			std::unordered_map<TKey, std::unique_ptr<RateLimiter>, THash> m_limiters;
+			SlimReadWriteLock m_lock;
+	};
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "MappedJournalSegment.hpp"
+#include "MappedJournalWriter.hpp"
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		Reads the records of a MappedJournal in order without locks,
+	///		following writers as they append and move to new segments.
+	///		Readers do not affect writers or each other. A record that stays
+	///		uncommitted for longer than the commit timeout is assumed to
+	///		belong to a dead writer and is skipped.
+	/// </summary>
+	class MappedJournalReader
+	{
+		public:
+			virtual ~MappedJournalReader();
+			/// <summary>
+			///		Reads the journal from the start of its first segment.
+			/// </summary>
+			MappedJournalReader(std::wstring journalPath);
+			MappedJournalReader(std::wstring journalPath, const MappedJournalSettings& settings);
+
+		// Non-copyable, movable
+		public:
+			MappedJournalReader(const MappedJournalReader&) = delete;
+			virtual MappedJournalReader& operator=(const MappedJournalReader&) = delete;
+			MappedJournalReader(MappedJournalReader&&) noexcept = default;
+			virtual MappedJournalReader& operator=(MappedJournalReader&&) noexcept = default;
+
+		public:
+			/// <summary>
+			///		Reads the next record if one has been committed.
+			/// </summary>
+			/// <returns>True if a record was read, false if the reader has caught up with the writers.</returns>
+			/// <exception cref="std::runtime_error">The journal is corrupt.</exception>
+			virtual bool TryRead(std::vector<std::byte>& record);
+
+			virtual UINT64 GetSegmentIndex() const noexcept;
+			/// <summary>
+			///		Returns the offset of the next record in the current segment.
+			/// </summary>
+			virtual UINT64 GetOffset() const noexcept;
+			virtual const std::wstring& GetPath() const noexcept;
+
+		protected:
+			virtual bool OpenSegment();
+			/// <summary>
+			///		Returns the length of the record at the current offset,
+			///		throwing if the record would run past the segment.
+			/// </summary>
+			virtual UINT32 GetCheckedLength() const;
+			/// <summary>
+			///		Returns whether the record at the current offset has
+			///		been waiting for a commit for longer than the timeout.
+			/// </summary>
+			virtual bool HasCommitTimedOut();
+			virtual void Advance(const UINT32 length) noexcept;
+
+		protected:
+			std::wstring m_path;
+			MappedJournalSettings m_settings;
+			MappedJournalSegment m_segment;
+			UINT64 m_segmentIndex;
+			UINT64 m_offset;
+			/// <summary>
+			///		The tick count when the reader first found the record at
+			///		the current offset uncommitted, or 0.
+			/// </summary>
+			UINT64 m_stalledSince;
+	};
+}
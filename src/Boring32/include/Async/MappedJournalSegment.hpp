@@ -0,0 +1,119 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <span>
+#include <optional>
+#include <cstddef>
+#include "FileMapping.hpp"
+#include "FileMappingView.hpp"
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		One fixed-size file of a MappedJournal. The file starts with a
+	///		header holding the shared tail, followed by records. Each record
+	///		is an 8 byte header, holding its state and payload length,
+	///		followed by the payload, padded to a multiple of 8 bytes.
+	///		Writers reserve records by atomically advancing the tail, so
+	///		records from different threads and processes never overlap.
+	/// </summary>
+	class MappedJournalSegment
+	{
+		public:
+			enum class RecordState : UINT32
+			{
+				/// <summary>
+				///		Not yet reserved, or reserved but its length not yet
+				///		recorded.
+				/// </summary>
+				Empty = 0,
+				Committed = 1,
+				/// <summary>
+				///		No more records fit; continue in the next segment.
+				/// </summary>
+				End = 2,
+				/// <summary>
+				///		Reserved but not yet committed. The length is valid,
+				///		so readers can skip the record if its writer dies.
+				/// </summary>
+				Reserved = 3
+			};
+
+			static constexpr UINT64 HeaderSize = 64;
+			static constexpr UINT64 RecordHeaderSize = 8;
+
+		public:
+			virtual ~MappedJournalSegment();
+			MappedJournalSegment();
+			/// <summary>
+			///		Opens segment index of the journal at journalPath. A
+			///		writable segment is created if it does not exist. A
+			///		read-only segment that a writer has not finished
+			///		creating is left closed; check IsOpen().
+			/// </summary>
+			MappedJournalSegment(
+				const std::wstring& journalPath,
+				const UINT64 index,
+				const UINT64 size,
+				const bool writable
+			);
+
+		// Non-copyable, movable
+		public:
+			MappedJournalSegment(const MappedJournalSegment&) = delete;
+			virtual MappedJournalSegment& operator=(const MappedJournalSegment&) = delete;
+			MappedJournalSegment(MappedJournalSegment&& other) noexcept;
+			virtual MappedJournalSegment& operator=(MappedJournalSegment&& other) noexcept;
+
+		public:
+			/// <summary>
+			///		Reserves a record for a payload of the given length, and
+			///		returns the record's offset, or nothing if the segment is
+			///		full. The record must be committed with Commit().
+			/// </summary>
+			virtual std::optional<UINT64> Reserve(const size_t length);
+			virtual std::span<std::byte> GetPayload(const UINT64 offset, const size_t length) const;
+			/// <summary>
+			///		Publishes a reserved record to readers.
+			/// </summary>
+			virtual void Commit(const UINT64 offset, const size_t length);
+			virtual RecordState GetState(const UINT64 offset) const;
+			virtual UINT32 GetLength(const UINT64 offset) const;
+			/// <summary>
+			///		Returns the offset just past the last reserved record.
+			///		This passes the end of the segment once it fills.
+			/// </summary>
+			virtual UINT64 GetReservedEnd() const;
+
+			/// <summary>
+			///		Writes a range of the segment to disk, and the file's
+			///		metadata if durable is true. Pass a length of 0 to
+			///		flush the whole segment.
+			/// </summary>
+			virtual void Flush(const UINT64 offset, const size_t length, const bool durable);
+
+			virtual bool IsOpen() const noexcept;
+			virtual UINT64 GetIndex() const noexcept;
+			virtual UINT64 GetSize() const noexcept;
+
+		public:
+			static std::wstring GetSegmentPath(const std::wstring& journalPath, const UINT64 index);
+			static bool Exists(const std::wstring& journalPath, const UINT64 index);
+			/// <summary>
+			///		Returns the space taken by a record with a payload of
+			///		the given length.
+			/// </summary>
+			static UINT64 GetRecordSize(const size_t length) noexcept;
+
+		protected:
+			virtual void Move(MappedJournalSegment& other) noexcept;
+			virtual UINT64& GetTail() const noexcept;
+			virtual UINT32& GetStateField(const UINT64 offset) const noexcept;
+
+		protected:
+			FileMapping m_mapping;
+			FileMappingView m_view;
+			UINT64 m_index;
+			UINT64 m_size;
+	};
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <span>
+#include <cstddef>
+#include "MappedJournalSegment.hpp"
+
+namespace Boring32::Async
+{
+	struct MappedJournalSettings
+	{
+		/// <summary>
+		///		The size of each segment file, which bounds the largest
+		///		record. All writers and readers of a journal must agree.
+		/// </summary>
+		UINT64 SegmentSize = 64 * 1024 * 1024;
+		/// <summary>
+		///		Flush every record to disk before Append() returns. Without
+		///		this, records reach the disk when the system writes back
+		///		the mapped pages, or when Flush() is called.
+		/// </summary>
+		bool Durable = false;
+		/// <summary>
+		///		How long, in milliseconds, a reader waits for a reserved
+		///		record to be committed before it treats the writer as dead
+		///		and skips the record. Writers ignore this.
+		/// </summary>
+		DWORD CommitTimeout = 10000;
+	};
+
+	/// <summary>
+	///		Appends records to a journal of memory mapped segment files
+	///		shared by any number of writers in any number of processes.
+	///		Writers reserve space with an atomic add on the segment's shared
+	///		tail, copy their record in, and then publish it, so appends do
+	///		not take locks. When a segment fills, writers move on to the
+	///		next one. A writer is not thread-safe: give each thread its own.
+	/// </summary>
+	class MappedJournalWriter
+	{
+		public:
+			virtual ~MappedJournalWriter();
+			/// <summary>
+			///		Opens the journal whose segments are named journalPath.0,
+			///		journalPath.1 and so on, and continues from its last
+			///		segment, creating the first if none exist.
+			/// </summary>
+			MappedJournalWriter(std::wstring journalPath);
+			MappedJournalWriter(std::wstring journalPath, const MappedJournalSettings& settings);
+
+		// Non-copyable, movable
+		public:
+			MappedJournalWriter(const MappedJournalWriter&) = delete;
+			virtual MappedJournalWriter& operator=(const MappedJournalWriter&) = delete;
+			MappedJournalWriter(MappedJournalWriter&&) noexcept = default;
+			virtual MappedJournalWriter& operator=(MappedJournalWriter&&) noexcept = default;
+
+		public:
+			virtual void Append(const std::span<const std::byte> record);
+			virtual bool Append(const std::span<const std::byte> record, std::nothrow_t) noexcept;
+
+			/// <summary>
+			///		Writes the current segment to disk, including the file's
+			///		metadata.
+			/// </summary>
+			virtual void Flush();
+
+			/// <summary>
+			///		Returns the largest record that fits in a segment.
+			/// </summary>
+			virtual size_t GetMaxRecordSize() const noexcept;
+			virtual UINT64 GetSegmentIndex() const noexcept;
+			virtual const std::wstring& GetPath() const noexcept;
+			virtual const MappedJournalSettings& GetSettings() const noexcept;
+
+		protected:
+			std::wstring m_path;
+			MappedJournalSettings m_settings;
+			MappedJournalSegment m_segment;
+	};
+}
@@ -5,6 +5,37 @@
 
 namespace Boring32::Async
 {
+	struct MemoryMappedFileOptions
+	{
+		/// <summary>
+		///		Back the section with large pages, reducing TLB misses when
+		///		accessing large segments. The size is rounded up to a
+		///		multiple of GetLargePageMinimum(). This requires the
+		///		account to hold SeLockMemoryPrivilege, which is enabled
+		///		on the process token. Large pages are always resident.
+		/// </summary>
+		bool LargePages = false;
+		/// <summary>
+		///		Use normal pages if large pages cannot be allocated, rather
+		///		than throwing. Large pages can fail even when permitted
+		///		if physical memory is too fragmented.
+		/// </summary>
+		bool FallbackToSmallPages = true;
+		/// <summary>
+		///		Fault in every page of the view on creation, so that first
+		///		accesses do not incur page faults.
+		/// </summary>
+		bool Prefault = false;
+		/// <summary>
+		///		Map the view at this address rather than one chosen by the
+		///		system, so that raw pointers into the view are valid in
+		///		every process that maps it at the same address. It must be
+		///		a multiple of the allocation granularity, and mapping fails
+		///		if the range is already in use.
+		/// </summary>
+		void* BaseAddress = nullptr;
+	};
+
 	/// <summary>
 	///		Represents a <a href="https://docs.microsoft.com/en-us/dotnet/standard/io/memory-mapped-files">Win32 memory-mapped file</a>,
 	///		which allows processes to share memory. This is a copyable
@@ -65,6 +96,59 @@ namespace Boring32::Async
 				const DWORD desiredAccess
 			);
 
+			/// <summary>
+			///		Creates a new memory mapped file with the specified
+			///		options. Unlike the other constructors, this does not
+			///		zero the view, as new sections are zero-filled and an
+			///		existing section's contents are preserved.
+			/// </summary>
+			/// <param name="name">
+			///		The name of the memory mapped file to create or open.
+			/// </param>
+			/// <param name="maxSize">
+			///		The maximum size of the memory mapped file.
+			/// </param>
+			/// <param name="inheritable">
+			///		Whether the acquired handle can be inherited by child processes.
+			/// </param>
+			/// <param name="options">
+			///		Page size and prefaulting options.
+			/// </param>
+			MemoryMappedFile(
+				std::wstring name,
+				const UINT maxSize,
+				const bool inheritable,
+				const MemoryMappedFileOptions& options
+			);
+
+			/// <summary>
+			///		Opens a memory mapped file with the specified options.
+			///		Set LargePages if the section was created with large
+			///		pages; FallbackToSmallPages is ignored.
+			/// </summary>
+			/// <param name="name">
+			///		The name of the memory mapped file to open.
+			/// </param>
+			/// <param name="maxSize">
+			///		The maximum size of the memory mapped file.
+			/// </param>
+			/// <param name="inheritable">
+			///		Whether the acquired handle can be inherited by child processes.
+			/// </param>
+			/// <param name="desiredAccess">
+			///		The desired access to open the file. See: https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-mapviewoffile
+			/// </param>
+			/// <param name="options">
+			///		Page size, prefaulting and address options.
+			/// </param>
+			MemoryMappedFile(
+				std::wstring name,
+				const UINT maxSize,
+				const bool inheritable,
+				const DWORD desiredAccess,
+				const MemoryMappedFileOptions& options
+			);
+
 			/// <summary>
 			///		Duplicates the specified MemoryMappedFile.
 			/// </summary>
@@ -112,6 +196,41 @@ namespace Boring32::Async
 			/// <returns></returns>
 			virtual bool IsInheritable() const;
 
+			/// <summary>
+			///		Gets the size of the view, which may have been rounded
+			///		up from the requested size for large pages.
+			/// </summary>
+			virtual UINT GetSize() const noexcept;
+
+			/// <summary>
+			///		Gets whether the section is backed by large pages.
+			/// </summary>
+			virtual bool UsesLargePages() const noexcept;
+
+			/// <summary>
+			///		Faults in every page of the view by touching it. This
+			///		does nothing for large pages, which are always resident.
+			/// </summary>
+			virtual void Prefault();
+
+			/// <summary>
+			///		Hints that a range will be needed soon, asking the system
+			///		to bring it into the working set in large I/Os.
+			/// </summary>
+			/// <param name="offset">The offset of the range in the view.</param>
+			/// <param name="length">The length of the range.</param>
+			virtual void Prefetch(const UINT offset, const UINT length);
+			virtual bool Prefetch(const UINT offset, const UINT length, std::nothrow_t) noexcept;
+
+			/// <summary>
+			///		Hints that a range will not be needed soon, removing its
+			///		pages from the working set. Its contents are preserved.
+			///		This does nothing for large pages.
+			/// </summary>
+			/// <param name="offset">The offset of the range in the view.</param>
+			/// <param name="length">The length of the range.</param>
+			virtual void Evict(const UINT offset, const UINT length);
+
 		protected:
 			/// <summary>
 			///		Unlocks the mutex if it is currently owned, releases the 
@@ -131,10 +250,33 @@ namespace Boring32::Async
 			/// <param name="other">The MemoryMappedFile to duplicate.</param>
 			virtual void Copy(const MemoryMappedFile& other);
 
+			/// <summary>
+			///		Creates the section with m_maxSize and maps a view of it.
+			/// </summary>
+			/// <param name="protection">The page protection and section attributes.</param>
+			/// <param name="viewAccess">The access for the view.</param>
+			/// <param name="inheritable">Whether the handle can be inherited.</param>
+			/// <param name="baseAddress">The address to map the view at, or nullptr.</param>
+			virtual void Create(
+				const DWORD protection,
+				const DWORD viewAccess,
+				const bool inheritable,
+				void* baseAddress
+			);
+
+			/// <summary>
+			///		Creates a large page section, rounding m_maxSize up to
+			///		the large page size.
+			/// </summary>
+			virtual void CreateLargePages(const bool inheritable, void* baseAddress);
+
+			virtual void CheckRange(const UINT offset, const UINT length) const;
+
 		protected:
 			std::wstring m_name;
 			UINT m_maxSize;
 			Raii::Win32Handle m_mapFile;
 			void* m_view;
+			bool m_largePages;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,266 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <span>
+#include <atomic>
+#include <stdexcept>
+#include <type_traits>
+#include <cstring>
+#include <algorithm>
+#include "../Error/Win32Error.hpp"
+#include "FileMapping.hpp"
+#include "FileMappingView.hpp"
+
+namespace Boring32::Async
+{
+	struct MemoryMappedVectorSettings
+	{
+		/// <summary>
+		///		The capacity of a new vector. The capacity doubles whenever
+		///		an append does not fit.
+		/// </summary>
+		size_t InitialCapacity = 4096;
+		/// <summary>
+		///		Open an existing vector without the ability to modify it.
+		/// </summary>
+		bool ReadOnly = false;
+	};
+
+	/// <summary>
+	///		A growable array of trivially copyable T kept in a memory
+	///		mapped file, so that a process can reopen it and use its
+	///		elements in place rather than loading and parsing them. The
+	///		file holds a header with the size and capacity, followed by the
+	///		elements. Growing remaps the file, which invalidates spans and
+	///		pointers previously obtained from the vector. Elements must not
+	///		contain pointers, as they are not valid after reopening. One
+	///		writer and any number of ReadOnly instances may have the file
+	///		open at once; readers see at most the elements that fit in
+	///		their own view until Refresh() maps the writer's growth. Two
+	///		writers at once are not supported.
+	/// </summary>
+	template<typename T>
+		requires std::is_trivially_copyable_v<T>
+	class MemoryMappedVector
+	{
+		public:
+			/// <summary>
+			///		Opens the vector in the file at path, creating it if it
+			///		does not exist.
+			/// </summary>
+			MemoryMappedVector(std::wstring path)
+			:	MemoryMappedVector(std::move(path), MemoryMappedVectorSettings{})
+			{ }
+
+			MemoryMappedVector(std::wstring path, const MemoryMappedVectorSettings& settings)
+			:	m_path(std::move(path)),
+				m_settings(settings),
+				m_header(nullptr),
+				m_data(nullptr),
+				m_mappedCapacity(0)
+			{
+				if (m_settings.InitialCapacity == 0)
+					throw std::invalid_argument(__FUNCSIG__ ": InitialCapacity must be greater than 0");
+
+				m_mapping = FileMapping(m_path, !m_settings.ReadOnly);
+				if (m_mapping.GetSize() == 0)
+				{
+					if (m_settings.ReadOnly)
+						throw std::runtime_error(__FUNCSIG__ ": the file is empty");
+					Remap(m_settings.InitialCapacity);
+					m_header->ElementSize = sizeof(T);
+					m_header->Size = 0;
+					m_header->Capacity = m_settings.InitialCapacity;
+					std::atomic_ref(m_header->Magic).store(Magic, std::memory_order_release);
+					return;
+				}
+
+				if (m_mapping.GetSize() < sizeof(Header))
+					throw std::runtime_error(__FUNCSIG__ ": the file is not a vector");
+				Map();
+				if (m_header->Magic != Magic || m_header->ElementSize != sizeof(T))
+					throw std::runtime_error(__FUNCSIG__ ": the file does not hold a vector of this type");
+				if (sizeof(Header) + m_header->Capacity * sizeof(T) > m_mapping.GetSize())
+					throw std::runtime_error(__FUNCSIG__ ": the file is truncated");
+			}
+
+		// Non-copyable, movable
+		public:
+			MemoryMappedVector(const MemoryMappedVector&) = delete;
+			MemoryMappedVector& operator=(const MemoryMappedVector&) = delete;
+			MemoryMappedVector(MemoryMappedVector&&) noexcept = default;
+			MemoryMappedVector& operator=(MemoryMappedVector&&) noexcept = default;
+
+		public:
+			void Append(const T& value)
+			{
+				Append(std::span<const T>(&value, 1));
+			}
+
+			/// <summary>
+			///		Appends values with a single copy. The size is updated
+			///		after the values are written, so a crash never exposes
+			///		a partly written append.
+			/// </summary>
+			void Append(const std::span<const T> values)
+			{
+				CheckWritable();
+				const UINT64 size = m_header->Size;
+				if (size + values.size() > m_header->Capacity)
+					Reserve((std::max)(size + values.size(), m_header->Capacity * 2));
+				if (!values.empty())
+					std::memcpy(m_data + size, values.data(), values.size_bytes());
+				std::atomic_ref(m_header->Size).store(size + values.size(), std::memory_order_release);
+			}
+
+			/// <summary>
+			///		Grows the file to hold at least capacity elements.
+			/// </summary>
+			void Reserve(const size_t capacity)
+			{
+				CheckWritable();
+				if (capacity <= m_header->Capacity)
+					return;
+				Remap(capacity);
+				// Released after the file has grown, so a reader that sees
+				// the new capacity can map it
+				std::atomic_ref(m_header->Capacity).store(capacity, std::memory_order_release);
+			}
+
+			/// <summary>
+			///		Maps the elements added since this instance's view was
+			///		last mapped, if another instance has grown the file.
+			/// </summary>
+			/// <returns>True if the view was remapped.</returns>
+			bool Refresh()
+			{
+				const UINT64 capacity = std::atomic_ref(m_header->Capacity).load(std::memory_order_acquire);
+				if (capacity <= m_mappedCapacity)
+					return false;
+				FileMapping mapping(m_path, !m_settings.ReadOnly);
+				if (sizeof(Header) + capacity * sizeof(T) > mapping.GetSize())
+					throw std::runtime_error(__FUNCSIG__ ": the file is truncated");
+				FileMappingView view = mapping.MapView(0, 0);
+				m_view = std::move(view);
+				m_mapping = std::move(mapping);
+				UpdatePointers();
+				return true;
+			}
+
+			void Clear()
+			{
+				CheckWritable();
+				std::atomic_ref(m_header->Size).store(0, std::memory_order_release);
+			}
+
+			/// <summary>
+			///		Writes the header and elements to disk.
+			/// </summary>
+			void Flush()
+			{
+				m_view.Flush();
+				if (!FlushFileBuffers(m_mapping.GetFileHandle()))
+					throw Error::Win32Error(__FUNCSIG__ ": FlushFileBuffers() failed", GetLastError());
+			}
+
+			/// <summary>
+			///		Returns the elements, in place in the mapped file.
+			/// </summary>
+			std::span<T> GetData() const noexcept
+			{
+				return { m_data, GetSize() };
+			}
+
+			/// <summary>
+			///		Returns an element. index must be less than GetSize().
+			/// </summary>
+			T& operator[](const size_t index) const noexcept
+			{
+				return m_data[index];
+			}
+
+			/// <summary>
+			///		Returns the number of elements, limited to those within
+			///		this instance's view if another instance has grown the
+			///		file since; see Refresh().
+			/// </summary>
+			size_t GetSize() const noexcept
+			{
+				const UINT64 size = std::atomic_ref(m_header->Size).load(std::memory_order_acquire);
+				return static_cast<size_t>((std::min)(size, m_mappedCapacity));
+			}
+
+			size_t GetCapacity() const noexcept
+			{
+				return static_cast<size_t>(m_header->Capacity);
+			}
+
+			bool IsEmpty() const noexcept
+			{
+				return GetSize() == 0;
+			}
+
+			const std::wstring& GetPath() const noexcept
+			{
+				return m_path;
+			}
+
+		protected:
+			static constexpr UINT32 Magic = 0x56424232; // "2BBV"
+			static_assert(alignof(T) <= 64, "T must not need more than 64 byte alignment");
+
+			struct alignas(64) Header
+			{
+				UINT32 Magic;
+				UINT32 ElementSize;
+				UINT64 Size;
+				UINT64 Capacity;
+			};
+
+		protected:
+			void Map()
+			{
+				m_view = m_mapping.MapView(0, 0);
+				UpdatePointers();
+			}
+
+			void UpdatePointers() noexcept
+			{
+				m_header = reinterpret_cast<Header*>(m_view.GetData().data());
+				m_data = reinterpret_cast<T*>(m_view.GetData().data() + sizeof(Header));
+				m_mappedCapacity = (m_view.GetSize() - sizeof(Header)) / sizeof(T);
+			}
+
+			void Remap(const size_t capacity)
+			{
+				// Build the new mapping and view before replacing the current
+				// ones, so that a failure, such as the disk being full, leaves
+				// the vector usable at its old capacity
+				FileMapping mapping(m_path, true, sizeof(Header) + static_cast<UINT64>(capacity) * sizeof(T));
+				FileMappingView view = mapping.MapView(0, 0);
+				m_view = std::move(view);
+				m_mapping = std::move(mapping);
+				UpdatePointers();
+			}
+
+			void CheckWritable() const
+			{
+				if (m_settings.ReadOnly)
+					throw std::runtime_error(__FUNCSIG__ ": the vector is read-only");
+			}
+
+		protected:
+			std::wstring m_path;
+			MemoryMappedVectorSettings m_settings;
+			FileMapping m_mapping;
+			FileMappingView m_view;
+			Header* m_header;
+			T* m_data;
+			/// <summary>
+			///		The number of elements this instance's view covers,
+			///		which lags the header's capacity if another instance
+			///		has grown the file.
+			/// </summary>
+			UINT64 m_mappedCapacity;
+	};
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		A pointer that stores the distance from itself to its target
+	///		rather than an address. When both the pointer and its target
+	///		live in the same shared memory, it stays valid in every process
+	///		however the memory is mapped, so it can link structures built
+	///		in a SharedHeap.
+	/// </summary>
+	template<typename T>
+	class OffsetPtr
+	{
+		public:
+			OffsetPtr() noexcept
+			:	m_offset(NullOffset)
+			{ }
+
+			OffsetPtr(std::nullptr_t) noexcept
+			:	m_offset(NullOffset)
+			{ }
+
+			OffsetPtr(T* pointer) noexcept
+			{
+				Set(pointer);
+			}
+
+			// The offset is relative to this object, so copies must be
+			// recalculated for their own address
+			OffsetPtr(const OffsetPtr& other) noexcept
+			{
+				Set(other.Get());
+			}
+
+			OffsetPtr& operator=(const OffsetPtr& other) noexcept
+			{
+				Set(other.Get());
+				return *this;
+			}
+
+			OffsetPtr& operator=(T* pointer) noexcept
+			{
+				Set(pointer);
+				return *this;
+			}
+
+		public:
+			T* Get() const noexcept
+			{
+				if (m_offset == NullOffset)
+					return nullptr;
+				return reinterpret_cast<T*>(reinterpret_cast<std::intptr_t>(this) + m_offset);
+			}
+
+			T* operator->() const noexcept { return Get(); }
+			T& operator*() const noexcept { return *Get(); }
+			T& operator[](const std::size_t index) const noexcept { return Get()[index]; }
+			explicit operator bool() const noexcept { return m_offset != NullOffset; }
+			bool operator==(const OffsetPtr& other) const noexcept { return Get() == other.Get(); }
+			bool operator==(const T* pointer) const noexcept { return Get() == pointer; }
+
+		protected:
+			void Set(T* pointer) noexcept
+			{
+				m_offset = pointer
+					? reinterpret_cast<std::intptr_t>(pointer) - reinterpret_cast<std::intptr_t>(this)
+					: NullOffset;
+			}
+
+		protected:
+			// 0 would make a pointer to itself null, and 1 can never be
+			// the distance to a suitably aligned T
+			static constexpr std::intptr_t NullOffset = 1;
+			std::intptr_t m_offset;
+	};
+}
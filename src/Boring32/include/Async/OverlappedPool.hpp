@@ -0,0 +1,130 @@
+#pragma once
+#include <Windows.h>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include "Event.hpp"
+
+namespace Boring32::Async
+{
+	class OverlappedPool;
+
+	/// <summary>
+	///		An OVERLAPPED and manual-reset Event borrowed from an
+	///		OverlappedPool, and returned to it when the lease is released
+	///		or destroyed. The OVERLAPPED's hEvent is already set to the
+	///		Event. The lease must not be released while an I/O operation
+	///		using it is in progress, and the pool must outlive the lease.
+	/// </summary>
+	class
+		[[nodiscard("This object must remain live while the I/O operation is in progress")]]
+		OverlappedLease
+	{
+		public:
+			virtual ~OverlappedLease();
+			/// <summary>
+			///		Creates an empty lease.
+			/// </summary>
+			OverlappedLease();
+
+		// Non-copyable, movable
+		public:
+			OverlappedLease(const OverlappedLease&) = delete;
+			virtual OverlappedLease& operator=(const OverlappedLease&) = delete;
+			OverlappedLease(OverlappedLease&& other) noexcept;
+			virtual OverlappedLease& operator=(OverlappedLease&& other) noexcept;
+
+		public:
+			/// <summary>
+			///		Clears the OVERLAPPED and resets the Event so the lease
+			///		can be used for another operation without returning it
+			///		to the pool.
+			/// </summary>
+			virtual void Reset();
+			virtual bool WaitForCompletion(const DWORD timeout);
+			/// <summary>
+			///		Signals or resets the Event, for operations that
+			///		complete without the system signalling it.
+			/// </summary>
+			virtual void SetEvent(const bool signaled);
+			virtual OVERLAPPED* GetOverlapped();
+			virtual HANDLE GetWaitableHandle() const;
+			virtual uint64_t GetBytesTransferred() const;
+			virtual bool IsComplete() const;
+			virtual bool IsSuccessful() const;
+			virtual bool IsPartial() const;
+			virtual DWORD LastError() const noexcept;
+			virtual void LastError(const DWORD lastError) noexcept;
+			virtual bool IsValid() const noexcept;
+			/// <summary>
+			///		Returns the OVERLAPPED and Event to the pool, leaving
+			///		this lease empty.
+			/// </summary>
+			virtual void Release() noexcept;
+
+		protected:
+			friend class OverlappedPool;
+
+			struct alignas(MEMORY_ALLOCATION_ALIGNMENT) Slot
+			{
+				// Must be first, as the pool's free list links slots through it
+				SLIST_ENTRY Entry;
+				OVERLAPPED Overlapped;
+				Event IoEvent;
+			};
+
+		protected:
+			OverlappedLease(OverlappedPool* pool, Slot* slot);
+			virtual void Move(OverlappedLease& other) noexcept;
+			virtual Slot& GetSlot() const;
+
+		protected:
+			OverlappedPool* m_pool;
+			Slot* m_slot;
+			DWORD m_lastError;
+	};
+
+	/// <summary>
+	///		A pool of OVERLAPPED structures paired with manual-reset Events,
+	///		so that frequent overlapped operations don't create and destroy
+	///		a kernel Event each time, as OverlappedOp does. Acquiring and
+	///		releasing use a lock-free interlocked list; a lock is only
+	///		taken when the pool has to grow.
+	/// </summary>
+	class OverlappedPool
+	{
+		public:
+			virtual ~OverlappedPool();
+			OverlappedPool();
+			/// <summary>
+			///		Creates a pool with initialCount slots ready to use.
+			/// </summary>
+			OverlappedPool(const size_t initialCount);
+
+		// Non-copyable, non-movable
+		public:
+			OverlappedPool(const OverlappedPool&) = delete;
+			virtual OverlappedPool& operator=(const OverlappedPool&) = delete;
+			OverlappedPool(OverlappedPool&&) noexcept = delete;
+			virtual OverlappedPool& operator=(OverlappedPool&&) noexcept = delete;
+
+		public:
+			/// <summary>
+			///		Returns a lease on a cleared OVERLAPPED and unsignalled
+			///		Event, allocating a new pair if none are free.
+			/// </summary>
+			virtual OverlappedLease Acquire();
+			virtual size_t GetAllocatedCount();
+			virtual size_t GetAvailableCount() noexcept;
+
+		protected:
+			friend class OverlappedLease;
+			virtual OverlappedLease::Slot* Allocate();
+			virtual void Release(OverlappedLease::Slot* slot) noexcept;
+
+		protected:
+			SLIST_HEADER m_free;
+			std::vector<std::unique_ptr<OverlappedLease::Slot>> m_slots;
+			CRITICAL_SECTION m_cs;
+	};
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <Windows.h>
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "AnonymousPipe.hpp"
+
+namespace Boring32::Async
+{
+	struct DelimitedStreamReaderSettings
+	{
+		/// <summary>
+		///		The initial size of the read buffer.
+		/// </summary>
+		DWORD BufferSize = 64 * 1024;
+		/// <summary>
+		///		The largest message that can be read. The buffer grows up to
+		///		this size to hold a message that does not fit in it.
+		/// </summary>
+		DWORD MaxMessageSize = 16 * 1024 * 1024;
+		/// <summary>
+		///		Delimiters are only matched at offsets from the start of a
+		///		message that are a multiple of this. Use sizeof(wchar_t) for
+		///		wide string payloads, so a delimiter can't be matched across
+		///		two characters.
+		/// </summary>
+		DWORD Alignment = 1;
+		/// <summary>
+		///		Whether to skip empty messages, such as between two
+		///		adjacent delimiters.
+		/// </summary>
+		bool SkipEmpty = false;
+	};
+
+	/// <summary>
+	///		Splits a byte stream read from a pipe or file into messages
+	///		separated by a delimiter. Bytes left over after the last
+	///		delimiter are kept for the next read, so messages that straddle
+	///		reads are returned whole. Messages are returned as views into
+	///		the read buffer without being copied. The handle is not owned
+	///		and must outlive the reader.
+	/// </summary>
+	class DelimitedStreamReader
+	{
+		public:
+			virtual ~DelimitedStreamReader();
+			DelimitedStreamReader(const HANDLE readHandle, const std::span<const std::byte> delimiter);
+			DelimitedStreamReader(
+				const HANDLE readHandle,
+				const std::span<const std::byte> delimiter,
+				const DelimitedStreamReaderSettings& settings
+			);
+			/// <summary>
+			///		Reads messages written by AnonymousPipe::DelimitedWrite(),
+			///		which surrounds each message with the pipe's delimiter.
+			/// </summary>
+			DelimitedStreamReader(AnonymousPipe& pipe);
+			DelimitedStreamReader(AnonymousPipe& pipe, const DelimitedStreamReaderSettings& settings);
+
+		// Non-copyable, non-movable
+		public:
+			DelimitedStreamReader(const DelimitedStreamReader&) = delete;
+			virtual DelimitedStreamReader& operator=(const DelimitedStreamReader&) = delete;
+			DelimitedStreamReader(DelimitedStreamReader&&) noexcept = delete;
+			virtual DelimitedStreamReader& operator=(DelimitedStreamReader&&) noexcept = delete;
+
+		public:
+			/// <summary>
+			///		Reads until the next message is complete and returns a
+			///		view of it, without its delimiter. Returns false at the
+			///		end of the stream. Data after the last delimiter is
+			///		returned as a final message. The view is invalidated by
+			///		the next call.
+			/// </summary>
+			virtual bool Next(std::span<const std::byte>& message);
+
+			/// <summary>
+			///		As above, for wide string payloads. Throws if the
+			///		message is not a whole number of characters.
+			/// </summary>
+			virtual bool Next(std::wstring_view& message);
+
+			virtual UINT64 GetBytesRead() const noexcept;
+			virtual UINT64 GetMessagesRead() const noexcept;
+			virtual const DelimitedStreamReaderSettings& GetSettings() const noexcept;
+
+		protected:
+			virtual bool TryTakeMessage(std::span<const std::byte>& message);
+			virtual void ReadMore();
+			virtual size_t FindDelimiter(const size_t from) const noexcept;
+
+		protected:
+			HANDLE m_readHandle;
+			// A read of no bytes from a pipe is a zero-length write, not
+			// the end of the stream
+			bool m_isPipe;
+			std::vector<std::byte> m_delimiter;
+			DelimitedStreamReaderSettings m_settings;
+			std::vector<std::byte> m_buffer;
+			// The unconsumed bytes are [m_start, m_end), and the delimiter
+			// has already been searched for up to m_scanned
+			size_t m_start;
+			size_t m_end;
+			size_t m_scanned;
+			bool m_ended;
+			UINT64 m_bytesRead;
+			UINT64 m_messagesRead;
+	};
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <Windows.h>
+#include <cstddef>
+#include <span>
+#include "PipeFrame.hpp"
+
+namespace Boring32::Async
+{
+	class HybridPipeTransport;
+
+	/// <summary>
+	///		A message received by a HybridPipeTransport. Small payloads are
+	///		a view into the pipe frame that carried them; large payloads
+	///		are a view into the sender's shared memory, whose slabs the
+	///		sender reuses once the message is released. Release messages
+	///		promptly, as unreleased messages stop the sender sending large
+	///		payloads once its shared memory is full. A message must not
+	///		outlive the transport that produced it.
+	/// </summary>
+	class HybridPipeMessage
+	{
+		public:
+			/// <summary>
+			///		Releases the message.
+			/// </summary>
+			virtual ~HybridPipeMessage();
+			/// <summary>
+			///		Creates an invalid message.
+			/// </summary>
+			HybridPipeMessage();
+			/// <summary>
+			///		Creates a message carried inline by a pipe frame.
+			/// </summary>
+			HybridPipeMessage(PipeFrame frame, const std::span<const std::byte> data);
+			/// <summary>
+			///		Creates a message held in shared memory slabs, which are
+			///		handed back to the transport when released.
+			/// </summary>
+			HybridPipeMessage(
+				HybridPipeTransport& transport,
+				const UINT32 firstSlab,
+				const UINT32 slabCount,
+				const std::span<const std::byte> data
+			);
+
+		// Non-copyable, movable
+		public:
+			HybridPipeMessage(const HybridPipeMessage&) = delete;
+			virtual HybridPipeMessage& operator=(const HybridPipeMessage&) = delete;
+			HybridPipeMessage(HybridPipeMessage&& other) noexcept;
+			virtual HybridPipeMessage& operator=(HybridPipeMessage&& other) noexcept;
+
+		public:
+			/// <summary>
+			///		Returns the payload. The view is valid until the message
+			///		is released or destroyed.
+			/// </summary>
+			virtual std::span<const std::byte> GetData() const noexcept;
+			virtual size_t GetSize() const noexcept;
+			/// <summary>
+			///		Returns false for messages returned when a receive
+			///		times out or the pipe is closed.
+			/// </summary>
+			virtual bool IsValid() const noexcept;
+			/// <summary>
+			///		Returns true if the payload is in shared memory.
+			/// </summary>
+			virtual bool IsShared() const noexcept;
+			/// <summary>
+			///		Releases the message's frame or shared memory slabs,
+			///		leaving it invalid.
+			/// </summary>
+			virtual void Release() noexcept;
+
+		protected:
+			virtual void Move(HybridPipeMessage& other) noexcept;
+
+		protected:
+			PipeFrame m_frame;
+			HybridPipeTransport* m_transport;
+			UINT32 m_firstSlab;
+			UINT32 m_slabCount;
+			std::span<const std::byte> m_data;
+			bool m_isValid;
+	};
+}
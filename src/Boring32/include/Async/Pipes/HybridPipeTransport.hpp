@@ -0,0 +1,148 @@
+#pragma once
+#include <Windows.h>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+#include <deque>
+#include "../Event.hpp"
+#include "../MemoryMappedFile.hpp"
+#include "NamedPipeServerBase.hpp"
+#include "NamedPipeClientBase.hpp"
+#include "PipeFrameChannel.hpp"
+#include "HybridPipeMessage.hpp"
+
+namespace Boring32::Async
+{
+	struct HybridPipeTransportSettings
+	{
+		/// <summary>
+		///		Payloads up to this size are sent through the pipe. Larger
+		///		payloads are sent through shared memory.
+		/// </summary>
+		DWORD InlineThreshold = 64 * 1024;
+		/// <summary>
+		///		The size of each direction's shared memory, which bounds the
+		///		largest payload and how much can be in flight at once.
+		/// </summary>
+		UINT SharedMemorySize = 32 * 1024 * 1024;
+		/// <summary>
+		///		The unit shared memory is allocated in. Each payload takes
+		///		a contiguous run of slabs.
+		/// </summary>
+		DWORD SlabSize = 64 * 1024;
+	};
+
+	/// <summary>
+	///		Sends binary messages over a connected named pipe, moving
+	///		payloads larger than a threshold through shared memory instead
+	///		of the pipe's kernel buffers. Each direction has a shared
+	///		memory region, written by the sender and carved into slabs;
+	///		the pipe carries a descriptor of the slabs holding a payload,
+	///		and the receiver sends them back when it releases the message
+	///		so they can be reused. Both ends must use the same settings and
+	///		shared memory name. The server end creates the shared memory,
+	///		so must be constructed before the client end. Send() and
+	///		Receive() can be called concurrently with each other, but not
+	///		with themselves.
+	/// </summary>
+	class HybridPipeTransport
+	{
+		public:
+			virtual ~HybridPipeTransport();
+			HybridPipeTransport(NamedPipeServerBase& server, const std::wstring& sharedMemoryName);
+			HybridPipeTransport(
+				NamedPipeServerBase& server,
+				const std::wstring& sharedMemoryName,
+				const HybridPipeTransportSettings& settings
+			);
+			HybridPipeTransport(NamedPipeClientBase& client, const std::wstring& sharedMemoryName);
+			HybridPipeTransport(
+				NamedPipeClientBase& client,
+				const std::wstring& sharedMemoryName,
+				const HybridPipeTransportSettings& settings
+			);
+
+		// Non-copyable, non-movable
+		public:
+			HybridPipeTransport(const HybridPipeTransport&) = delete;
+			virtual HybridPipeTransport& operator=(const HybridPipeTransport&) = delete;
+			HybridPipeTransport(HybridPipeTransport&&) noexcept = delete;
+			virtual HybridPipeTransport& operator=(HybridPipeTransport&&) noexcept = delete;
+
+		public:
+			/// <summary>
+			///		Sends data as one message. Payloads above the inline
+			///		threshold are copied into shared memory, waiting for
+			///		the receiver to release earlier messages if it is full.
+			/// </summary>
+			virtual void Send(const std::span<const std::byte> data);
+			virtual bool Send(const std::span<const std::byte> data, std::nothrow_t) noexcept;
+
+			/// <summary>
+			///		Returns the next message, waiting up to timeoutMillis
+			///		for it to arrive. Returns an invalid message if the wait
+			///		times out or the other end closed the pipe. Timeouts are
+			///		only honoured for pipes opened for overlapped I/O.
+			/// </summary>
+			virtual HybridPipeMessage Receive(const DWORD timeoutMillis);
+
+			virtual bool IsConnected() const noexcept;
+			virtual const HybridPipeTransportSettings& GetSettings() const noexcept;
+			virtual UINT32 GetSlabCount() const noexcept;
+			/// <summary>
+			///		Returns the number of this end's outbound slabs that are
+			///		not held by messages in flight.
+			/// </summary>
+			virtual UINT32 GetFreeSlabCount();
+
+		protected:
+			friend HybridPipeMessage;
+
+			enum class FrameType : UINT32
+			{
+				Inline = 1,
+				Shared = 2,
+				Release = 3
+			};
+
+			struct FrameHeader
+			{
+				FrameType Type;
+				UINT32 FirstSlab;
+				UINT32 SlabCount;
+				UINT32 Reserved;
+				UINT64 Length;
+			};
+
+		protected:
+			virtual void Create(const std::wstring& sharedMemoryName, const bool isServer);
+			virtual UINT32 AcquireSlabs(const UINT32 count);
+			virtual bool TryAcquireSlabs(const UINT32 count, UINT32& firstSlab);
+			virtual void FreeSlabs(const UINT32 firstSlab, const UINT32 count);
+			virtual bool ReturnSlabs(const UINT32 firstSlab, const UINT32 count, std::nothrow_t) noexcept;
+			virtual void SendFrame(const FrameHeader& header, const std::span<const std::byte> payload);
+			virtual bool ReceiveFrame(const DWORD timeoutMillis);
+			virtual HybridPipeMessage ToMessage(PipeFrame frame);
+			static PipeFrameChannelSettings ToChannelSettings(const HybridPipeTransportSettings& settings);
+
+		protected:
+			HybridPipeTransportSettings m_settings;
+			PipeFrameChannel m_channel;
+			MemoryMappedFile m_outbound;
+			MemoryMappedFile m_inbound;
+			UINT32 m_slabCount;
+			// Which outbound slabs are in flight, and where to start looking
+			// for free ones
+			std::vector<bool> m_slabInUse;
+			UINT32 m_freeSlabs;
+			UINT32 m_nextSlab;
+			// Messages read while waiting for slabs to be returned
+			std::deque<PipeFrame> m_pending;
+			std::vector<std::byte> m_sendBuffer;
+			Event m_slabsFreed;
+			CRITICAL_SECTION m_sendCs;
+			CRITICAL_SECTION m_receiveCs;
+			CRITICAL_SECTION m_slabCs;
+	};
+}
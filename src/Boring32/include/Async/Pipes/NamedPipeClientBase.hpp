@@ -1,6 +1,10 @@
 #pragma once
 #include <string>
+#include <span>
+#include <cstddef>
+#include <optional>
 #include "../../Raii/Raii.hpp"
+#include "../VectoredIo.hpp"
 
 namespace Boring32::Async
 {
@@ -25,6 +29,18 @@ namespace Boring32::Async
 			virtual void Close();
 			virtual DWORD UnreadCharactersRemaining() const;
 			virtual void Flush();
+			virtual Raii::Win32Handle& GetInternalHandle();
+			/// <summary>
+			///		Writes the pieces as one message, or one contiguous
+			///		sequence of bytes, without concatenating them first.
+			///		See Async::WriteGather().
+			/// </summary>
+			virtual UINT64 WriteGather(const std::span<const std::span<const std::byte>> pieces);
+			/// <summary>
+			///		Reads one message, or as many bytes as the pieces hold,
+			///		into the pieces in order. See Async::ReadScatter().
+			/// </summary>
+			virtual ScatterReadResult ReadScatter(const std::span<const std::span<std::byte>> pieces);
 			virtual void CancelCurrentThreadIo();
 			virtual bool CancelCurrentThreadIo(std::nothrow_t)  noexcept;
 			virtual void CancelCurrentProcessIo(OVERLAPPED* overlapped);
@@ -38,5 +54,8 @@ namespace Boring32::Async
 			Raii::Win32Handle m_handle;
 			std::wstring m_pipeName;
 			DWORD m_fileAttributes;
+			// Queried when the pipe is connected or its mode changes, so
+			// that WriteGather() and ReadScatter() need not on every call
+			std::optional<VectoredIoTraits> m_vectoredIoTraits;
 	};
 }
\ No newline at end of file
@@ -1,7 +1,11 @@
 #pragma once
 #include <string>
 #include <memory>
+#include <span>
+#include <cstddef>
+#include <optional>
 #include "../../Raii/Raii.hpp"
+#include "../VectoredIo.hpp"
 
 namespace Boring32::Async
 {
@@ -40,6 +44,17 @@ namespace Boring32::Async
 			virtual void Disconnect();
 			virtual void Flush();
 			virtual Raii::Win32Handle& GetInternalHandle();
+			/// <summary>
+			///		Writes the pieces as one message, or one contiguous
+			///		sequence of bytes, without concatenating them first.
+			///		See Async::WriteGather().
+			/// </summary>
+			virtual UINT64 WriteGather(const std::span<const std::span<const std::byte>> pieces);
+			/// <summary>
+			///		Reads one message, or as many bytes as the pieces hold,
+			///		into the pieces in order. See Async::ReadScatter().
+			/// </summary>
+			virtual ScatterReadResult ReadScatter(const std::span<const std::span<std::byte>> pieces);
 			virtual std::wstring GetName() const;
 			virtual DWORD GetSize() const;
 			virtual DWORD GetMaxInstances() const;
@@ -67,5 +82,8 @@ namespace Boring32::Async
 			bool m_isInheritable;
 			DWORD m_pipeMode;
 			DWORD m_openMode;
+			// Queried when the pipe is created, so that WriteGather() and
+			// ReadScatter() need not on every call
+			std::optional<VectoredIoTraits> m_vectoredIoTraits;
 	};
 }
@@ -3,6 +3,7 @@
 #include "../../Raii/Raii.hpp"
 #include "../Event.hpp"
 #include "../OverlappedIo.hpp"
+#include "../OverlappedPool.hpp"
 #include "NamedPipeServerBase.hpp"
 
 namespace Boring32::Async
@@ -44,6 +45,20 @@ namespace Boring32::Async
 			virtual void Read(const DWORD noOfCharacters, OverlappedIo& oio);
 			virtual bool Read(const DWORD noOfCharacters, OverlappedIo& oio, std::nothrow_t) noexcept;
 
+			/// <summary>
+			///		Overloads that use a pooled OVERLAPPED and Event, which
+			///		is reset in place rather than recreated. The message and
+			///		buffer must remain valid until the operation completes.
+			///		Read() reads up to buffer.size() characters; the number
+			///		of bytes read is reported by the lease.
+			/// </summary>
+			virtual void Connect(OverlappedLease& lease);
+			virtual bool Connect(OverlappedLease& lease, std::nothrow_t) noexcept;
+			virtual void Write(const std::wstring& msg, OverlappedLease& lease);
+			virtual bool Write(const std::wstring& msg, OverlappedLease& lease, std::nothrow_t) noexcept;
+			virtual void Read(std::wstring& buffer, OverlappedLease& lease);
+			virtual bool Read(std::wstring& buffer, OverlappedLease& lease, std::nothrow_t) noexcept;
+
 		protected:
 			virtual void InternalWrite(const std::wstring& msg, OverlappedIo& oio);
 			virtual void InternalRead(const DWORD noOfCharacters, OverlappedIo& oio);
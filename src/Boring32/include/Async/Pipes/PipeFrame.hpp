@@ -0,0 +1,61 @@
+#pragma once
+#include <Windows.h>
+#include <cstddef>
+#include <memory>
+#include <span>
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		A frame received by a PipeFrameChannel. The payload is a view
+	///		into one of the channel's pooled receive buffers, which is
+	///		returned to the pool once every frame read into it has been
+	///		released. A frame may outlive the channel that produced it.
+	/// </summary>
+	class PipeFrame
+	{
+		public:
+			/// <summary>
+			///		Releases the frame's hold on its receive buffer.
+			/// </summary>
+			virtual ~PipeFrame();
+			/// <summary>
+			///		Creates an invalid frame.
+			/// </summary>
+			PipeFrame();
+			PipeFrame(std::shared_ptr<std::byte> buffer, const std::span<const std::byte> data);
+
+		// Non-copyable, movable
+		public:
+			PipeFrame(const PipeFrame&) = delete;
+			virtual PipeFrame& operator=(const PipeFrame&) = delete;
+			PipeFrame(PipeFrame&& other) noexcept;
+			virtual PipeFrame& operator=(PipeFrame&& other) noexcept;
+
+		public:
+			/// <summary>
+			///		Returns the payload. The view is valid until the frame
+			///		is released or destroyed.
+			/// </summary>
+			virtual std::span<const std::byte> GetData() const noexcept;
+			virtual size_t GetSize() const noexcept;
+			/// <summary>
+			///		Returns false for frames that hold no payload, including
+			///		empty frames returned when a receive times out. Frames
+			///		with a zero-length payload are valid.
+			/// </summary>
+			virtual bool IsValid() const noexcept;
+			/// <summary>
+			///		Releases the frame's hold on its receive buffer, leaving
+			///		it invalid.
+			/// </summary>
+			virtual void Release() noexcept;
+
+		protected:
+			virtual void Move(PipeFrame& other) noexcept;
+
+		protected:
+			std::shared_ptr<std::byte> m_buffer;
+			std::span<const std::byte> m_data;
+	};
+}
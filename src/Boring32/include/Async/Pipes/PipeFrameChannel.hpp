@@ -0,0 +1,195 @@
+#pragma once
+#include <Windows.h>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+#include <atomic>
+#include <string>
+#include "../Event.hpp"
+#include "../ByteBufferPool.hpp"
+#include "NamedPipeServerBase.hpp"
+#include "NamedPipeClientBase.hpp"
+#include "PipeFrame.hpp"
+
+namespace Boring32::Async
+{
+	struct PipeFrameChannelSettings
+	{
+		/// <summary>
+		///		The size of each pooled receive buffer. A frame and its
+		///		length prefix must fit within one buffer.
+		/// </summary>
+		DWORD BufferSize = 64 * 1024;
+		/// <summary>
+		///		The maximum number of receive buffers, which bounds how
+		///		much received data can be held by unreleased frames.
+		/// </summary>
+		DWORD MaxBuffers = 8;
+		/// <summary>
+		///		Payloads up to this size are copied behind their length
+		///		prefix and sent in a single write. Larger payloads are
+		///		written directly after the prefix, without being copied.
+		/// </summary>
+		DWORD CoalesceLimit = 16 * 1024;
+		/// <summary>
+		///		When non-zero, frames that fit are gathered into batches
+		///		of up to this many bytes, including their length prefixes,
+		///		and each batch is sent with a single write. The receiving
+		///		channel splits batches back into frames, so batching only
+		///		needs to be enabled on the sending side. Disabled by default.
+		/// </summary>
+		DWORD BatchSize = 0;
+		/// <summary>
+		///		The longest a batched frame is held before its batch is
+		///		sent. Pass 0 to only send batches once they are full or
+		///		Flush() is called. The timer that enforces this is subject
+		///		to the system timer resolution, which is usually coarser.
+		///		It starts the batch's write without waiting for it, so for
+		///		pipes opened for overlapped I/O it never blocks a sender.
+		/// </summary>
+		DWORD BatchDelayMicroseconds = 200;
+	};
+
+	/// <summary>
+	///		Sends and receives length-prefixed binary frames over a connected
+	///		named pipe. Received frames are views into pooled buffers, so
+	///		several frames read together share a buffer and steady-state
+	///		receiving does not allocate. The pipe object must outlive the
+	///		channel. Send() and Receive() can be called concurrently with
+	///		each other, but not with themselves.
+	/// </summary>
+	class PipeFrameChannel
+	{
+		public:
+			/// <summary>
+			///		The size of the length prefix preceding each frame.
+			/// </summary>
+			static constexpr DWORD HeaderSize = sizeof(UINT32);
+
+		public:
+			virtual ~PipeFrameChannel();
+			PipeFrameChannel(NamedPipeServerBase& server);
+			PipeFrameChannel(NamedPipeServerBase& server, const PipeFrameChannelSettings& settings);
+			PipeFrameChannel(NamedPipeClientBase& client);
+			PipeFrameChannel(NamedPipeClientBase& client, const PipeFrameChannelSettings& settings);
+
+		// Non-copyable, non-movable
+		public:
+			PipeFrameChannel(const PipeFrameChannel&) = delete;
+			virtual PipeFrameChannel& operator=(const PipeFrameChannel&) = delete;
+			PipeFrameChannel(PipeFrameChannel&&) noexcept = delete;
+			virtual PipeFrameChannel& operator=(PipeFrameChannel&&) noexcept = delete;
+
+		public:
+			/// <summary>
+			///		Sends data as a single frame, blocking until it has been
+			///		written to the pipe. With batching enabled, a frame that
+			///		fits in a batch is only copied into the current batch,
+			///		which is written once it is full or its delay expires.
+			///		Errors writing a batch in the background are thrown by
+			///		the next call to Send() or Flush().
+			/// </summary>
+			virtual void Send(const std::span<const std::byte> data);
+			virtual bool Send(const std::span<const std::byte> data, std::nothrow_t) noexcept;
+
+			/// <summary>
+			///		Writes any batched frames to the pipe now. Call this at
+			///		points where the receiver must see everything sent so
+			///		far, such as before waiting for a reply.
+			/// </summary>
+			virtual void Flush();
+			virtual bool Flush(std::nothrow_t) noexcept;
+
+			/// <summary>
+			///		Returns the next frame, waiting up to timeoutMillis for
+			///		it to arrive. Returns an invalid frame if the wait times
+			///		out or the other end closed the pipe, which IsConnected()
+			///		distinguishes. Timeouts are only honoured for pipes that
+			///		were opened for overlapped I/O. Also waits for a receive
+			///		buffer if every buffer is held by unreleased frames.
+			/// </summary>
+			virtual PipeFrame Receive(const DWORD timeoutMillis);
+
+			/// <summary>
+			///		Returns false once the other end has closed the pipe.
+			/// </summary>
+			virtual bool IsConnected() const noexcept;
+			virtual DWORD GetMaxFrameSize() const noexcept;
+			virtual const PipeFrameChannelSettings& GetSettings() const noexcept;
+			/// <summary>
+			///		Returns the number of frames sent, including batched
+			///		frames that have not been written yet.
+			/// </summary>
+			virtual UINT64 GetFramesSent() const noexcept;
+			/// <summary>
+			///		Returns the number of WriteFile() calls made, which with
+			///		GetFramesSent() gives the writes per frame.
+			/// </summary>
+			virtual UINT64 GetWriteCalls() const noexcept;
+
+		protected:
+			PipeFrameChannel(const HANDLE pipe, const PipeFrameChannelSettings& settings);
+			virtual void WriteAll(const std::byte* data, const DWORD size);
+			virtual bool ReadMore(const UINT64 deadline);
+			virtual bool MakeRoom(const DWORD required, const UINT64 deadline);
+			virtual bool TryTakeFrame(PipeFrame& frame);
+			virtual void Batch(const std::span<const std::byte> data);
+			virtual void FlushBatch();
+			virtual void ArmFlushTimer(const UINT64 dueMicroseconds);
+			virtual void OnFlushTimer();
+			/// <summary>
+			///		Starts writing the batch without waiting for the write
+			///		to complete.
+			/// </summary>
+			virtual void StartFlush();
+			/// <summary>
+			///		Completes a write started by StartFlush(), recording
+			///		any error for ThrowIfFlushFailed(). Returns false if
+			///		the write is still in progress and wait is false.
+			/// </summary>
+			virtual bool CompletePendingFlush(const bool wait);
+			virtual void ThrowIfFlushFailed();
+			virtual UINT64 GetBatchAgeMicroseconds() const noexcept;
+
+		protected:
+			static void CALLBACK FlushTimerCallback(
+				PTP_CALLBACK_INSTANCE instance,
+				void* context,
+				PTP_TIMER timer
+			);
+
+		protected:
+			HANDLE m_pipe;
+			PipeFrameChannelSettings m_settings;
+			std::shared_ptr<ByteBufferPool> m_pool;
+			// The buffer being received into, and the unconsumed bytes in it
+			std::shared_ptr<std::byte> m_receiveBuffer;
+			DWORD m_readPosition;
+			DWORD m_writePosition;
+			std::vector<std::byte> m_sendBuffer;
+			Event m_readDone;
+			Event m_writeDone;
+			OVERLAPPED m_readOverlapped;
+			OVERLAPPED m_writeOverlapped;
+			std::atomic<bool> m_connected;
+			std::atomic<UINT64> m_framesSent;
+			std::atomic<UINT64> m_writeCalls;
+			// Batching state, guarded by m_sendCs as the flush timer
+			// writes batches from the thread pool
+			std::vector<std::byte> m_batch;
+			LARGE_INTEGER m_batchStarted;
+			LARGE_INTEGER m_frequency;
+			PTP_TIMER m_flushTimer;
+			bool m_flushTimerArmed;
+			// Set by the destructor so the timer stops re-arming itself
+			bool m_stopping;
+			std::string m_flushError;
+			// The batch the flush timer is writing
+			std::vector<std::byte> m_flushBatch;
+			Event m_flushDone;
+			OVERLAPPED m_flushOverlapped;
+			bool m_flushPending;
+			CRITICAL_SECTION m_sendCs;
+	};
+}
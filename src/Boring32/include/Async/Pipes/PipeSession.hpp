@@ -0,0 +1,157 @@
+#pragma once
+#include <Windows.h>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+#include "../FlowControl.hpp"
+#include "OverlappedNamedPipeServer.hpp"
+
+namespace Boring32::Async
+{
+	class PipeSession;
+
+	/// <summary>
+	///		Callbacks invoked by a PooledNamedPipeServer on its worker
+	///		threads. Calls for one session never overlap, except for
+	///		OnWritable, but calls for different sessions run concurrently.
+	///		Any of them may be empty.
+	/// </summary>
+	struct PipeSessionHandlers
+	{
+		std::function<void(const std::shared_ptr<PipeSession>& session)> OnConnected;
+		/// <summary>
+		///		Receives one complete message. The view is only valid for
+		///		the duration of the call.
+		/// </summary>
+		std::function<void(const std::shared_ptr<PipeSession>& session, const std::span<const std::byte> message)> OnMessage;
+		std::function<void(const std::shared_ptr<PipeSession>& session)> OnDisconnected;
+		/// <summary>
+		///		Invoked when write credit is returned after TryWrite() was
+		///		refused. It runs on the thread completing a write, so it
+		///		can overlap OnMessage for the same session.
+		/// </summary>
+		std::function<void(const std::shared_ptr<PipeSession>& session)> OnWritable;
+	};
+
+	/// <summary>
+	///		A client connection accepted by a PooledNamedPipeServer. The
+	///		session object can be kept after the client disconnects, but
+	///		it can no longer be written to; a later connection on the same
+	///		pipe instance gets a new session.
+	/// </summary>
+	class PipeSession : public std::enable_shared_from_this<PipeSession>
+	{
+		public:
+			virtual ~PipeSession();
+
+		// Non-copyable, non-movable
+		public:
+			PipeSession(const PipeSession&) = delete;
+			virtual PipeSession& operator=(const PipeSession&) = delete;
+			PipeSession(PipeSession&&) noexcept = delete;
+			virtual PipeSession& operator=(PipeSession&&) noexcept = delete;
+
+		public:
+			/// <summary>
+			///		Returns an ID that is unique within the server.
+			/// </summary>
+			virtual UINT64 GetId() const noexcept;
+			virtual DWORD GetClientProcessId();
+			virtual bool IsConnected();
+
+			/// <summary>
+			///		Queues message to be sent to the client and returns
+			///		without waiting for it to be written. Messages are sent
+			///		in the order they are queued. If the server limits
+			///		queued writes, waits for the queue to drain below the
+			///		limits, so don't call this from a handler; use TryWrite()
+			///		instead.
+			/// </summary>
+			virtual void Write(const std::span<const std::byte> message);
+			virtual bool Write(const std::span<const std::byte> message, std::nothrow_t) noexcept;
+
+			/// <summary>
+			///		As Write(), but waits at most timeoutMillis for the
+			///		queue to drain, returning false if it doesn't.
+			/// </summary>
+			virtual bool Write(const std::span<const std::byte> message, const DWORD timeoutMillis);
+
+			/// <summary>
+			///		Queues message if the queue is within the server's
+			///		limits. Otherwise returns false without queuing it, and
+			///		OnWritable is invoked once the queue drains.
+			/// </summary>
+			virtual bool TryWrite(const std::span<const std::byte> message);
+
+			/// <summary>
+			///		Returns statistics on the queued writes, including how
+			///		long writers were stalled by the server's limits.
+			/// </summary>
+			virtual FlowControlStats GetWriteStats();
+			virtual UINT64 GetQueuedBytes();
+
+			/// <summary>
+			///		Disconnects the client, discarding any queued writes.
+			///		OnDisconnected is invoked once outstanding I/O ends.
+			/// </summary>
+			virtual void Close();
+
+		protected:
+			friend class PooledNamedPipeServer;
+
+			enum class Operation
+			{
+				Connect,
+				Read,
+				Write
+			};
+
+			struct IoContext
+			{
+				OVERLAPPED Overlapped;
+				Operation Type;
+				PipeSession* Session;
+			};
+
+		protected:
+			PipeSession(
+				std::unique_ptr<OverlappedNamedPipeServer> pipe,
+				const UINT64 id,
+				const DWORD bufferSize,
+				const FlowControlSettings& writeLimits,
+				std::function<void(PipeSession& session)> onWritable
+			);
+			virtual HANDLE GetPipeHandle() const noexcept;
+			virtual void Enqueue(const std::span<const std::byte> message);
+			// These expect m_cs to be held
+			virtual void IssueRead();
+			virtual bool IssueWrite();
+			virtual void BeginClose();
+			virtual void ClearWriteQueue();
+			virtual void CompleteWrite(const DWORD error);
+
+		protected:
+			std::unique_ptr<OverlappedNamedPipeServer> m_pipe;
+			UINT64 m_id;
+			IoContext m_connectContext;
+			IoContext m_readContext;
+			IoContext m_writeContext;
+			// Only touched by the thread completing the outstanding read
+			std::vector<std::byte> m_receiveBuffer;
+			DWORD m_received;
+			std::deque<std::vector<std::byte>> m_writeQueue;
+			std::vector<std::vector<std::byte>> m_spareBuffers;
+			std::function<void(PipeSession& session)> m_onWritable;
+			// Credit is taken as each write is queued, and returned when
+			// it completes or is discarded
+			FlowControl m_writeCredit;
+			// Includes a completion that is being handled
+			DWORD m_pendingOps;
+			bool m_connected;
+			bool m_closing;
+			CRITICAL_SECTION m_cs;
+	};
+}
@@ -6,3 +6,18 @@
 #include "OverlappedNamedPipeClient.hpp"
 #include "BlockingNamedPipeServer.hpp"
 #include "BlockingNamedPipeClient.hpp"
+
+#include "PipeFrame.hpp"
+#include "PipeFrameChannel.hpp"
+#include "PipeSession.hpp"
+#include "PooledNamedPipeServer.hpp"
+#include "DelimitedStreamReader.hpp"
+#include "HybridPipeMessage.hpp"
+#include "HybridPipeTransport.hpp"
+#include "UnixSocketConnection.hpp"
+#include "UnixSocketServer.hpp"
+#include "UnixSocketClient.hpp"
+#include "RpcProtocol.hpp"
+#include "RpcError.hpp"
+#include "RpcClient.hpp"
+#include "RpcServer.hpp"
\ No newline at end of file
@@ -0,0 +1,133 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <unordered_map>
+#include "../../Raii/Raii.hpp"
+#include "../Event.hpp"
+#include "../Thread.hpp"
+#include "OverlappedNamedPipeServer.hpp"
+#include "PipeSession.hpp"
+
+namespace Boring32::Async
+{
+	struct PooledNamedPipeServerSettings
+	{
+		/// <summary>
+		///		The size of the pipe buffers, and the initial size of each
+		///		session's receive buffer. Larger messages grow the buffer.
+		/// </summary>
+		DWORD BufferSize = 4096;
+		/// <summary>
+		///		The number of instances kept waiting for clients to connect.
+		/// </summary>
+		DWORD PendingInstances = 4;
+		/// <summary>
+		///		The maximum number of instances, connected or pending. Once
+		///		reached, clients wait until a connected client disconnects.
+		///		PIPE_UNLIMITED_INSTANCES leaves this to system resources.
+		/// </summary>
+		DWORD MaxInstances = PIPE_UNLIMITED_INSTANCES;
+		/// <summary>
+		///		The number of threads handling completions and running the
+		///		session handlers.
+		/// </summary>
+		DWORD WorkerThreads = 4;
+		/// <summary>
+		///		Limits on each session's queued writes. Writers wait, or
+		///		TryWrite() is refused, while a session is at its limits,
+		///		so a client that reads slowly can't grow the queue without
+		///		bound. Unlimited by default.
+		/// </summary>
+		FlowControlSettings WriteLimits;
+		std::wstring Sid;
+		bool IsLocalPipe = true;
+	};
+
+	/// <summary>
+	///		A message-mode named pipe server that serves many clients with
+	///		a handful of threads. It keeps a pool of pipe instances waiting
+	///		for clients, adding instances as clients connect, up to the
+	///		maximum. Connects, reads and writes are overlapped and their
+	///		completions are dispatched through an I/O completion port to
+	///		the worker threads, which run the session handlers. When a
+	///		client disconnects, its instance goes back to waiting for
+	///		clients rather than being closed.
+	/// </summary>
+	class PooledNamedPipeServer
+	{
+		public:
+			/// <summary>
+			///		Disconnects all clients and waits for the handlers to
+			///		finish.
+			/// </summary>
+			virtual ~PooledNamedPipeServer();
+			PooledNamedPipeServer(
+				const std::wstring& pipeName,
+				const PooledNamedPipeServerSettings& settings,
+				const PipeSessionHandlers& handlers
+			);
+
+		// Non-copyable, non-movable
+		public:
+			PooledNamedPipeServer(const PooledNamedPipeServer&) = delete;
+			virtual PooledNamedPipeServer& operator=(const PooledNamedPipeServer&) = delete;
+			PooledNamedPipeServer(PooledNamedPipeServer&&) noexcept = delete;
+			virtual PooledNamedPipeServer& operator=(PooledNamedPipeServer&&) noexcept = delete;
+
+		public:
+			/// <summary>
+			///		Disconnects all clients, closes all instances, and
+			///		waits for OnDisconnected to be invoked for every
+			///		connected session. Must not be called from a handler.
+			/// </summary>
+			virtual void Close();
+			virtual std::wstring GetName() const;
+			virtual const PooledNamedPipeServerSettings& GetSettings() const noexcept;
+			virtual size_t GetConnectedCount() const noexcept;
+			virtual size_t GetPendingCount();
+			virtual size_t GetInstanceCount();
+
+		protected:
+			virtual std::unique_ptr<OverlappedNamedPipeServer> CreateInstance(const bool isFirst);
+			virtual void StartAccept(std::unique_ptr<OverlappedNamedPipeServer> pipe);
+			virtual void ReplenishPending();
+			virtual UINT WorkerLoop();
+			virtual void CompleteConnect(PipeSession& session, const DWORD error);
+			virtual void CompleteRead(PipeSession& session, const DWORD bytesRead, const DWORD error);
+			virtual void ReleaseOp(PipeSession& session);
+			virtual void Recycle(PipeSession& session);
+			/// <summary>
+			///		Ends an accept counted in m_startingCount, once its
+			///		session is in m_sessions or it has failed.
+			/// </summary>
+			virtual void FinishStarting();
+			template<typename TFunc>
+			void InvokeHandler(PipeSession& session, const TFunc& invoke);
+
+		protected:
+			static constexpr ULONG_PTR ShutdownKey = 1;
+
+		protected:
+			std::wstring m_pipeName;
+			PooledNamedPipeServerSettings m_settings;
+			PipeSessionHandlers m_handlers;
+			Raii::Win32Handle m_port;
+			std::vector<std::unique_ptr<Thread>> m_workers;
+			std::unordered_map<UINT64, std::shared_ptr<PipeSession>> m_sessions;
+			UINT64 m_nextId;
+			size_t m_pendingCount;
+			size_t m_instanceCount;
+			/// <summary>
+			///		Accepts that have been decided on but whose sessions
+			///		are not yet in m_sessions. Close() waits for these too.
+			/// </summary>
+			size_t m_startingCount;
+			std::atomic<size_t> m_connectedCount;
+			std::atomic<bool> m_stopping;
+			Event m_drained;
+			CRITICAL_SECTION m_cs;
+	};
+}
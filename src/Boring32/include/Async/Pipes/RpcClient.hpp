@@ -0,0 +1,132 @@
+#pragma once
+#include <Windows.h>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include <future>
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include "../Thread.hpp"
+#include "NamedPipeClientBase.hpp"
+#include "PipeFrameChannel.hpp"
+#include "RpcProtocol.hpp"
+#include "RpcError.hpp"
+
+namespace Boring32::Async
+{
+	struct RpcClientSettings
+	{
+		PipeFrameChannelSettings Channel;
+		/// <summary>
+		///		The timeout of calls made without one.
+		/// </summary>
+		DWORD TimeoutMillis = INFINITE;
+		/// <summary>
+		///		How often the receiving thread checks for calls that have
+		///		timed out, which is the granularity of timeouts.
+		/// </summary>
+		DWORD TimerResolutionMillis = 50;
+	};
+
+	/// <summary>
+	///		A call made with RpcClient::Call(). The future holds the
+	///		response, or an RpcError if the call failed, timed out or was
+	///		cancelled. The id identifies the call to Cancel().
+	/// </summary>
+	struct RpcCall
+	{
+		UINT64 Id = 0;
+		std::future<std::vector<std::byte>> Result;
+	};
+
+	/// <summary>
+	///		Makes calls to an RpcServer over one connected pipe, which must
+	///		have been opened for overlapped I/O. Each request is tagged with
+	///		a correlation id, so any number of calls from any number of
+	///		threads can be outstanding at once; a thread owned by the client
+	///		receives the responses, in whatever order the server finishes
+	///		them, and completes the matching futures. The pipe object must
+	///		outlive the client.
+	/// </summary>
+	class RpcClient
+	{
+		public:
+			/// <summary>
+			///		Stops receiving and fails outstanding calls.
+			/// </summary>
+			virtual ~RpcClient();
+			RpcClient(NamedPipeClientBase& client);
+			RpcClient(NamedPipeClientBase& client, const RpcClientSettings& settings);
+
+		// Non-copyable, non-movable
+		public:
+			RpcClient(const RpcClient&) = delete;
+			virtual RpcClient& operator=(const RpcClient&) = delete;
+			RpcClient(RpcClient&&) noexcept = delete;
+			virtual RpcClient& operator=(RpcClient&&) noexcept = delete;
+
+		public:
+			/// <summary>
+			///		Sends a request for method and returns without waiting
+			///		for the response. Throws RpcError if the client has been
+			///		closed or disconnected.
+			/// </summary>
+			virtual RpcCall Call(const UINT32 method, const std::span<const std::byte> request);
+			virtual RpcCall Call(
+				const UINT32 method,
+				const std::span<const std::byte> request,
+				const DWORD timeoutMillis
+			);
+
+			/// <summary>
+			///		Fails the call with RpcErrorCode::Cancelled, and asks the
+			///		server to drop the request if it has not started it.
+			/// </summary>
+			/// <returns>False if the call had already completed.</returns>
+			virtual bool Cancel(const UINT64 id);
+
+			/// <summary>
+			///		Stops receiving, and fails outstanding calls with
+			///		RpcErrorCode::Cancelled.
+			/// </summary>
+			virtual void Close();
+			virtual bool IsConnected() const noexcept;
+			virtual size_t GetPendingCount();
+			/// <summary>
+			///		Returns the largest request payload that fits in a frame.
+			/// </summary>
+			virtual size_t GetMaxRequestSize() const noexcept;
+			virtual const RpcClientSettings& GetSettings() const noexcept;
+
+		protected:
+			struct PendingCall
+			{
+				std::promise<std::vector<std::byte>> Promise;
+				UINT64 Deadline = 0;
+			};
+
+		protected:
+			virtual UINT ReceiveLoop();
+			virtual void Complete(const PipeFrame& frame);
+			virtual void ExpireCalls();
+			/// <summary>
+			///		Fails every outstanding call, and stops new calls being
+			///		made.
+			/// </summary>
+			virtual void FailAll(const RpcErrorCode code, const std::string& message);
+			virtual void Send(const RpcHeader& header, const std::span<const std::byte> payload);
+
+		protected:
+			RpcClientSettings m_settings;
+			PipeFrameChannel m_channel;
+			std::unordered_map<UINT64, PendingCall> m_pending;
+			std::atomic<UINT64> m_nextId;
+			std::atomic<bool> m_stopping;
+			bool m_open;
+			std::vector<std::byte> m_sendBuffer;
+			Thread m_receiver;
+			CRITICAL_SECTION m_cs;
+			CRITICAL_SECTION m_sendCs;
+	};
+}
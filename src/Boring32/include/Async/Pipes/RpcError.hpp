@@ -0,0 +1,38 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <stdexcept>
+
+namespace Boring32::Async
+{
+	enum class RpcErrorCode
+	{
+		Timeout,
+		Cancelled,
+		/// <summary>
+		///		The pipe was closed before the response arrived.
+		/// </summary>
+		Disconnected,
+		/// <summary>
+		///		The server's handler threw; the message is its error.
+		/// </summary>
+		Remote
+	};
+
+	/// <summary>
+	///		The exception an RpcClient stores in the future of a call that
+	///		did not get a response.
+	/// </summary>
+	class RpcError : public std::runtime_error
+	{
+		public:
+			virtual ~RpcError();
+			RpcError(const RpcErrorCode code, const std::string& message);
+
+		public:
+			virtual RpcErrorCode GetCode() const noexcept;
+
+		protected:
+			RpcErrorCode m_code;
+	};
+}
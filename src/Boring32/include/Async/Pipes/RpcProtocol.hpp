@@ -0,0 +1,33 @@
+#pragma once
+#include <Windows.h>
+
+namespace Boring32::Async
+{
+	enum class RpcMessageKind : UINT16
+	{
+		Request = 1,
+		Response = 2,
+		/// <summary>
+		///		A failed request. The payload is the error message.
+		/// </summary>
+		Error = 3,
+		/// <summary>
+		///		Asks the server to drop a request it has not started.
+		/// </summary>
+		Cancel = 4
+	};
+
+	/// <summary>
+	///		Precedes the payload of every frame exchanged by an RpcClient
+	///		and an RpcServer. Responses carry the correlation id of their
+	///		request, so they can be returned in any order.
+	/// </summary>
+	struct RpcHeader
+	{
+		UINT64 CorrelationId;
+		UINT32 Method;
+		RpcMessageKind Kind;
+		UINT16 Reserved;
+	};
+	static_assert(sizeof(RpcHeader) == 16);
+}
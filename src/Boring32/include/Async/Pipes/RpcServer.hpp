@@ -0,0 +1,107 @@
+#pragma once
+#include <Windows.h>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <unordered_set>
+#include "../../Raii/Win32Handle.hpp"
+#include "../Thread.hpp"
+#include "NamedPipeServerBase.hpp"
+#include "PipeFrameChannel.hpp"
+#include "RpcProtocol.hpp"
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		Handles one request and returns the response payload. Exceptions
+	///		are returned to the caller as RpcErrorCode::Remote errors.
+	/// </summary>
+	using RpcHandler = std::function<
+		std::vector<std::byte>(const UINT32 method, const std::span<const std::byte> request)
+	>;
+
+	struct RpcServerSettings
+	{
+		PipeFrameChannelSettings Channel;
+		/// <summary>
+		///		The number of requests handled at once. Responses are sent
+		///		as requests finish, so a slow request does not hold up
+		///		the others.
+		/// </summary>
+		DWORD WorkerThreads = 4;
+	};
+
+	/// <summary>
+	///		Serves calls from an RpcClient over one connected pipe, which
+	///		must have been opened for overlapped I/O. A thread owned by the
+	///		server receives requests and queues them to a pool of worker
+	///		threads, which run the handler and send each response tagged
+	///		with its request's correlation id. The pipe object must outlive
+	///		the server.
+	/// </summary>
+	class RpcServer
+	{
+		public:
+			/// <summary>
+			///		Stops receiving and waits for queued requests to finish.
+			/// </summary>
+			virtual ~RpcServer();
+			RpcServer(NamedPipeServerBase& server, RpcHandler handler);
+			RpcServer(NamedPipeServerBase& server, RpcHandler handler, const RpcServerSettings& settings);
+
+		// Non-copyable, non-movable
+		public:
+			RpcServer(const RpcServer&) = delete;
+			virtual RpcServer& operator=(const RpcServer&) = delete;
+			RpcServer(RpcServer&&) noexcept = delete;
+			virtual RpcServer& operator=(RpcServer&&) noexcept = delete;
+
+		public:
+			/// <summary>
+			///		Stops receiving requests, and waits for the requests
+			///		already received to be handled.
+			/// </summary>
+			virtual void Close();
+			virtual bool IsConnected() const noexcept;
+			virtual UINT64 GetRequestCount() const noexcept;
+			virtual const RpcServerSettings& GetSettings() const noexcept;
+
+		protected:
+			struct PendingRequest
+			{
+				RpcHeader Header;
+				PipeFrame Frame;
+			};
+
+		protected:
+			virtual UINT ReceiveLoop();
+			virtual UINT WorkerLoop();
+			virtual void Dispatch(PipeFrame frame);
+			virtual void Handle(PendingRequest& request);
+			virtual void Send(const RpcHeader& header, const std::span<const std::byte> payload);
+
+		protected:
+			static constexpr ULONG_PTR ShutdownKey = 1;
+
+		protected:
+			RpcServerSettings m_settings;
+			RpcHandler m_handler;
+			PipeFrameChannel m_channel;
+			Raii::Win32Handle m_port;
+			Thread m_receiver;
+			std::vector<std::unique_ptr<Thread>> m_workers;
+			// Requests queued or running, and those the client has since
+			// cancelled, so that cancels for finished requests are ignored
+			std::unordered_set<UINT64> m_inFlight;
+			std::unordered_set<UINT64> m_cancelled;
+			std::atomic<UINT64> m_requestCount;
+			std::atomic<bool> m_stopping;
+			bool m_closed;
+			std::vector<std::byte> m_sendBuffer;
+			CRITICAL_SECTION m_cs;
+			CRITICAL_SECTION m_sendCs;
+	};
+}
@@ -0,0 +1,36 @@
+#pragma once
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+#include <string>
+#include "UnixSocketConnection.hpp"
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		The AF_UNIX counterpart of a message-mode named pipe client.
+	/// </summary>
+	class UnixSocketClient : public UnixSocketConnection
+	{
+		public:
+			virtual ~UnixSocketClient();
+			UnixSocketClient();
+			UnixSocketClient(const std::wstring& path);
+
+		// Non-copyable, movable
+		public:
+			UnixSocketClient(const UnixSocketClient&) = delete;
+			virtual UnixSocketClient& operator=(const UnixSocketClient&) = delete;
+			UnixSocketClient(UnixSocketClient&& other) noexcept;
+			virtual UnixSocketClient& operator=(UnixSocketClient&& other) noexcept;
+
+		public:
+			/// <summary>
+			///		Connects to the server listening on the path. This
+			///		succeeds as soon as the connection is queued, before
+			///		a server instance calls Connect() to accept it.
+			/// </summary>
+			virtual void Connect();
+			virtual bool Connect(std::nothrow_t) noexcept;
+	};
+}
@@ -0,0 +1,175 @@
+#pragma once
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <span>
+#include <cstddef>
+
+struct sockaddr_un;
+
+namespace Boring32::Async
+{
+#ifdef _WIN32
+	/// <summary>
+	///		A SOCKET, held as an integer so that the headers do not depend
+	///		on Winsock.
+	/// </summary>
+	using UnixSocketHandle = std::uintptr_t;
+#else
+	using UnixSocketHandle = int;
+#endif
+
+	/// <summary>
+	///		A connected AF_UNIX socket with the same message semantics as a
+	///		message-mode named pipe. This is the common base of
+	///		UnixSocketServer and UnixSocketClient, in the way that
+	///		NamedPipeServerBase and NamedPipeClientBase are for pipes.
+	///		Every message is sent behind a UINT32 length prefix. Windows
+	///		only supports SOCK_STREAM for AF_UNIX, so there the prefix is
+	///		what delimits messages, and waits use WSAPoll(). On Linux each
+	///		message is one SOCK_SEQPACKET packet, whose prefix lets an
+	///		empty message be told apart from the connection closing, and
+	///		waits use epoll. A packet must fit in the socket's send buffer,
+	///		which limits messages there to around 200KB by default.
+	///		Write() and Read() can be called concurrently with each other,
+	///		but not with themselves.
+	/// </summary>
+	class UnixSocketConnection
+	{
+		public:
+			/// <summary>
+			///		The size of the length prefix preceding each message.
+			/// </summary>
+			static constexpr std::uint32_t HeaderSize = sizeof(std::uint32_t);
+			/// <summary>
+			///		The largest message Read() accepts unless changed with
+			///		SetMaxMessageSize().
+			/// </summary>
+			static constexpr std::uint32_t DefaultMaxMessageSize = 16 * 1024 * 1024;
+			/// <summary>
+			///		Waits without a timeout. The same value as INFINITE.
+			/// </summary>
+			static constexpr std::uint32_t Infinite = 0xFFFFFFFF;
+
+		public:
+			virtual ~UnixSocketConnection();
+			UnixSocketConnection();
+			UnixSocketConnection(const std::wstring& path);
+
+		// Non-copyable, movable
+		public:
+			UnixSocketConnection(const UnixSocketConnection&) = delete;
+			virtual UnixSocketConnection& operator=(const UnixSocketConnection&) = delete;
+			UnixSocketConnection(UnixSocketConnection&& other) noexcept;
+			virtual UnixSocketConnection& operator=(UnixSocketConnection&& other) noexcept;
+
+		public:
+			/// <summary>
+			///		Sends msg as a single message.
+			/// </summary>
+			virtual void Write(const std::wstring& msg);
+			virtual bool Write(const std::wstring& msg, std::nothrow_t) noexcept;
+			virtual void Write(const std::span<const std::byte> data);
+			virtual bool Write(const std::span<const std::byte> data, std::nothrow_t) noexcept;
+
+			/// <summary>
+			///		Sends pieces, in order, as a single message, without the
+			///		caller concatenating them first. On Linux this is one
+			///		sendmsg() call with an iovec per piece, which limits
+			///		pieces to IOV_MAX - 1.
+			/// </summary>
+			virtual void WriteGather(const std::span<const std::span<const std::byte>> pieces);
+
+			/// <summary>
+			///		Blocks until a whole message has arrived and returns it.
+			///		Throws if the other end closes the connection, or if the
+			///		message is larger than the maximum message size, which
+			///		is checked before any memory is allocated for it. On
+			///		Windows a stream can't skip an oversized message, so the
+			///		connection is closed; on Linux the message is discarded.
+			/// </summary>
+			virtual std::wstring Read();
+			virtual bool Read(std::wstring& out, std::nothrow_t) noexcept;
+			virtual std::vector<std::byte> ReadBytes();
+
+			/// <summary>
+			///		Reads one message into pieces, filling each in turn, and
+			///		returns its size. A message larger than the pieces
+			///		combined is discarded and an exception thrown, leaving
+			///		the connection usable. On Linux this is one recvmsg()
+			///		call with an iovec per piece.
+			/// </summary>
+			virtual size_t ReadScatter(const std::span<const std::span<std::byte>> pieces);
+
+			/// <summary>
+			///		Waits up to timeoutMillis for a message to start arriving
+			///		or for the other end to close the connection, returning
+			///		false on timeout. This is the completion wait that the
+			///		overlapped pipe classes expose through their events.
+			/// </summary>
+			virtual bool WaitForRead(const std::uint32_t timeoutMillis);
+
+			/// <summary>
+			///		Closes the connection. Pending reads on the other end
+			///		fail once any messages already sent have been read.
+			/// </summary>
+			virtual void Close();
+			virtual bool IsConnected() const noexcept;
+			virtual const std::wstring& GetPath() const noexcept;
+			virtual UnixSocketHandle GetSocket() const noexcept;
+			virtual void SetMaxMessageSize(const std::uint32_t maxMessageSize);
+			virtual std::uint32_t GetMaxMessageSize() const noexcept;
+
+		protected:
+			virtual void SendFrame(const void* data, const size_t size);
+			/// <summary>
+			///		Sends pieces as one message behind a single prefix.
+			/// </summary>
+			virtual void SendFrame(const std::span<const std::span<const std::byte>> pieces);
+			/// <summary>
+			///		Returns the size of the next message, throwing if it is
+			///		larger than the maximum message size.
+			/// </summary>
+			virtual std::uint32_t ReceiveHeader();
+			/// <summary>
+			///		Reads the message whose size ReceiveHeader() returned.
+			/// </summary>
+			virtual void ReceiveExact(void* buffer, const size_t size);
+			virtual void Move(UnixSocketConnection& other) noexcept;
+#ifndef _WIN32
+			/// <summary>
+			///		Registers m_socket with m_epoll, creating it if needed.
+			/// </summary>
+			virtual void WatchSocket();
+#endif
+
+		protected:
+#ifdef _WIN32
+			/// <summary>
+			///		Initialises Winsock once per process, throwing if it
+			///		cannot be started.
+			/// </summary>
+			static void Startup();
+#endif
+			static UnixSocketHandle CreateSocket();
+			static void ToAddress(const std::wstring& path, sockaddr_un& address);
+
+		protected:
+#ifdef _WIN32
+			static constexpr UnixSocketHandle InvalidSocket = ~(UnixSocketHandle)0;
+#else
+			static constexpr UnixSocketHandle InvalidSocket = -1;
+#endif
+
+		protected:
+			std::wstring m_path;
+			UnixSocketHandle m_socket;
+			std::uint32_t m_maxMessageSize;
+#ifndef _WIN32
+			int m_epoll;
+#endif
+	};
+}
@@ -0,0 +1,99 @@
+#pragma once
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+#include <cstdint>
+#include <string>
+#include <memory>
+#include <atomic>
+#include "UnixSocketConnection.hpp"
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		The AF_UNIX counterpart of a message-mode named pipe server.
+	///		Each object is one instance: Connect() waits for a client and
+	///		Write() and Read() then exchange messages with it. Further
+	///		instances are created with CreateInstance() and share this
+	///		one's listening socket, so several clients can be served at
+	///		once on the same path.
+	/// </summary>
+	class UnixSocketServer : public UnixSocketConnection
+	{
+		public:
+			virtual ~UnixSocketServer();
+			UnixSocketServer();
+			/// <summary>
+			///		Starts listening on path, replacing any socket file left
+			///		behind by an earlier server.
+			/// </summary>
+			/// <param name="maxInstances">
+			///		The maximum number of instances, including this one,
+			///		that can exist on this path. Also bounds the number of
+			///		clients that can be waiting to be connected.
+			/// </param>
+			UnixSocketServer(const std::wstring& path, const std::uint32_t maxInstances);
+
+		// Non-copyable, movable
+		public:
+			UnixSocketServer(const UnixSocketServer&) = delete;
+			virtual UnixSocketServer& operator=(const UnixSocketServer&) = delete;
+			UnixSocketServer(UnixSocketServer&& other) noexcept;
+			virtual UnixSocketServer& operator=(UnixSocketServer&& other) noexcept;
+
+		public:
+			/// <summary>
+			///		Creates another instance on the same path, with this
+			///		one's maximum message size. Throws if maxInstances
+			///		instances already exist.
+			/// </summary>
+			virtual UnixSocketServer CreateInstance();
+
+			/// <summary>
+			///		Blocks until a client connects to this instance.
+			/// </summary>
+			virtual void Connect();
+
+			/// <summary>
+			///		Waits up to timeoutMillis for a client to connect,
+			///		returning false on timeout.
+			/// </summary>
+			virtual bool Connect(const std::uint32_t timeoutMillis);
+
+			/// <summary>
+			///		Closes the connection to the current client, so the
+			///		instance can be connected to another one.
+			/// </summary>
+			virtual void Disconnect();
+
+			/// <summary>
+			///		Disconnects and releases the instance. The socket file
+			///		is removed when the last instance is closed.
+			/// </summary>
+			virtual void Close() override;
+
+			virtual std::uint32_t GetMaxInstances() const noexcept;
+			virtual std::uint32_t GetInstanceCount() const noexcept;
+
+		protected:
+			struct Listener
+			{
+				~Listener();
+				std::wstring Path;
+				UnixSocketHandle Socket = InvalidSocket;
+#ifndef _WIN32
+				// Instances waiting in Connect() share this, so that a
+				// client arriving wakes one of them
+				int Epoll = -1;
+#endif
+				std::uint32_t MaxInstances = 0;
+				std::atomic<std::uint32_t> Instances = 0;
+			};
+
+		protected:
+			UnixSocketServer(std::shared_ptr<Listener> listener);
+
+		protected:
+			std::shared_ptr<Listener> m_listener;
+	};
+}
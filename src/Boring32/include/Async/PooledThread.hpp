@@ -0,0 +1,60 @@
+#pragma once
+#include <memory>
+#include "Thread.hpp"
+#include "ThreadCache.hpp"
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		A Thread that runs its function on a thread borrowed from a
+	///		ThreadCache instead of creating a new OS thread. Start(), Join(),
+	///		GetExitCode(), WaitToStart() and GetStatus() behave as they do
+	///		for Thread, except that Join() waits for the function to return
+	///		rather than for the OS thread to exit. The ThreadCache must
+	///		outlive this object.
+	/// </summary>
+	class PooledThread : public Thread
+	{
+		// Movable, not copyable
+		public:
+			virtual ~PooledThread();
+			PooledThread(ThreadCache& cache);
+			PooledThread(ThreadCache& cache, void* param);
+			PooledThread(PooledThread&& other) noexcept;
+			PooledThread(const PooledThread&) = delete;
+
+		public:
+			virtual PooledThread& operator=(const PooledThread&) = delete;
+			virtual PooledThread& operator=(PooledThread&& other) noexcept;
+			virtual bool operator==(const ThreadStatus status) const noexcept override;
+
+		public:
+			/// <summary>
+			///		Terminates the underlying OS thread. The thread is removed
+			///		from the cache, and the same caveats as Thread::Terminate()
+			///		apply.
+			/// </summary>
+			virtual void Terminate(const DWORD exitCode) override;
+			virtual void Suspend() override;
+			virtual void Resume() override;
+			virtual bool Join(const DWORD waitTime) override;
+			virtual void Close() override;
+			virtual ThreadStatus GetStatus() const noexcept override;
+			virtual UINT GetExitCode() const override;
+			/// <summary>
+			///		Returns a duplicate of the handle of the OS thread running
+			///		the function, or a null handle if the function is not running.
+			/// </summary>
+			virtual Raii::Win32Handle GetHandle() noexcept override;
+			virtual bool WaitToStart(const DWORD millis) override;
+
+		protected:
+			virtual void InternalStart() override;
+			virtual void Move(PooledThread& other) noexcept;
+			virtual std::shared_ptr<const Raii::Win32Handle> GetRunningThread() const;
+
+		protected:
+			ThreadCache* m_cache;
+			std::shared_ptr<PooledThreadJob> m_job;
+	};
+}
@@ -0,0 +1,186 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <vector>
+#include <atomic>
+#include "../Raii/Win32Handle.hpp"
+#include "Event.hpp"
+#include "Thread.hpp"
+#include "ByteBufferPool.hpp"
+
+namespace Boring32::Async
+{
+	enum class OutputStream
+	{
+		StdOut = 0,
+		StdErr = 1
+	};
+
+	enum class OutputBackpressure
+	{
+		/// <summary>
+		///		Stop reading when every buffer is waiting to be pumped, so
+		///		a child that outpaces the consumer blocks on its full pipe.
+		///		No output is lost.
+		/// </summary>
+		Block,
+		/// <summary>
+		///		Keep draining the child when every buffer is waiting to be
+		///		pumped, discarding what cannot be buffered. The partial
+		///		line interrupted by a gap is discarded too.
+		/// </summary>
+		Drop
+	};
+
+	struct ProcessOutputCaptureSettings
+	{
+		/// <summary>
+		///		The size of each pooled read buffer and of the pipe buffers.
+		/// </summary>
+		DWORD BufferSize = 64 * 1024;
+		/// <summary>
+		///		The maximum number of buffers shared by both streams,
+		///		which bounds how much output is held between pumps.
+		/// </summary>
+		DWORD MaxBuffers = 16;
+		OutputBackpressure Backpressure = OutputBackpressure::Block;
+		/// <summary>
+		///		The longest line delivered in one piece. Longer lines are
+		///		delivered in pieces of this many bytes, so a child that
+		///		never writes a newline cannot grow the buffered partial
+		///		line without bound.
+		/// </summary>
+		DWORD MaxLineLength = 1024 * 1024;
+	};
+
+	/// <summary>
+	///		Captures a child process's stdout and stderr through a pair of
+	///		overlapped pipes read concurrently by a background thread into
+	///		pooled buffers. Output is split into lines on the pumping
+	///		thread; lines that fall within one read are handed out as
+	///		views into the pooled buffer without being copied.
+	/// </summary>
+	class ProcessOutputCapture
+	{
+		public:
+			/// <summary>
+			///		Receives one line, without its line terminator. The view
+			///		is only valid for the duration of the call.
+			/// </summary>
+			using LineHandler = std::function<void(const OutputStream stream, const std::string_view line)>;
+
+		public:
+			virtual ~ProcessOutputCapture();
+			ProcessOutputCapture();
+			ProcessOutputCapture(const ProcessOutputCaptureSettings& settings);
+
+		// Non-copyable, non-movable
+		public:
+			ProcessOutputCapture(const ProcessOutputCapture&) = delete;
+			virtual ProcessOutputCapture& operator=(const ProcessOutputCapture&) = delete;
+			ProcessOutputCapture(ProcessOutputCapture&&) noexcept = delete;
+			virtual ProcessOutputCapture& operator=(ProcessOutputCapture&&) noexcept = delete;
+
+		public:
+			/// <summary>
+			///		Returns a STARTUPINFO that redirects the child's stdout
+			///		and stderr to this object. Pass it to a Process that is
+			///		created with canInheritHandles set to true.
+			/// </summary>
+			virtual STARTUPINFO GetStartupInfo() const noexcept;
+
+			/// <summary>
+			///		Starts reading. Call this once the child has started;
+			///		it closes this process's copies of the child's ends of
+			///		the pipes so that the streams end when the child exits.
+			/// </summary>
+			virtual void Start();
+
+			/// <summary>
+			///		Delivers all output read so far to handler, first waiting
+			///		up to timeoutMillis if there is none. Returns false once
+			///		both streams have ended and all output was delivered.
+			/// </summary>
+			virtual bool Pump(const LineHandler& handler, const DWORD timeoutMillis);
+
+			/// <summary>
+			///		Pumps until both streams have ended.
+			/// </summary>
+			virtual void Run(const LineHandler& handler);
+
+			virtual UINT64 GetBytesRead(const OutputStream stream) const noexcept;
+			virtual UINT64 GetDroppedBytes(const OutputStream stream) const noexcept;
+
+		protected:
+			struct Chunk
+			{
+				OutputStream Stream;
+				std::byte* Buffer;
+				DWORD Length;
+				// Output was dropped between this chunk and the previous one
+				bool FollowsGap;
+				bool EndOfStream;
+			};
+
+			struct StreamState
+			{
+				Raii::Win32Handle Read;
+				Raii::Win32Handle ChildWrite;
+				OVERLAPPED Overlapped{ 0 };
+				Event ReadDone{ false, true, false };
+				std::byte* Buffer = nullptr;
+				std::unique_ptr<std::byte[]> Discard;
+				bool ReadPending = false;
+				bool IsDiscarding = false;
+				bool GapPending = false;
+				bool Ended = false;
+				std::atomic<UINT64> BytesRead = 0;
+				std::atomic<UINT64> DroppedBytes = 0;
+				// Consumer side: the start of a line split across reads
+				std::string Carry;
+				bool ConsumerEnded = false;
+			};
+
+		protected:
+			virtual void CreateStreamPipe(StreamState& state, const std::wstring& suffix);
+			virtual UINT ReaderLoop();
+			virtual bool IssueRead(const OutputStream stream);
+			virtual void CompleteRead(const OutputStream stream);
+			virtual void EndStream(const OutputStream stream);
+			virtual void Enqueue(const Chunk& chunk);
+			virtual void ReleaseChunk(const Chunk& chunk);
+			virtual void SplitLines(const Chunk& chunk, const LineHandler& handler);
+			/// <summary>
+			///		Delivers a complete line, in pieces if it is longer than
+			///		MaxLineLength.
+			/// </summary>
+			virtual void DeliverLine(const OutputStream stream, std::string_view line, const LineHandler& handler);
+			/// <summary>
+			///		Appends to the stream's partial line, delivering pieces
+			///		of MaxLineLength bytes as it grows past that.
+			/// </summary>
+			virtual void AppendCarry(
+				StreamState& state,
+				const OutputStream stream,
+				const std::string_view data,
+				const LineHandler& handler
+			);
+			virtual StreamState& GetState(const OutputStream stream) noexcept;
+
+		protected:
+			ProcessOutputCaptureSettings m_settings;
+			ByteBufferPool m_pool;
+			StreamState m_streams[2];
+			std::vector<Chunk> m_ready;
+			std::vector<Chunk> m_pumping;
+			Event m_chunksReady;
+			Event m_stop;
+			Thread m_reader;
+			bool m_started;
+			bool m_readerDone;
+			std::string m_readerError;
+			CRITICAL_SECTION m_cs;
+	};
+}
@@ -0,0 +1,199 @@
+#pragma once
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/types.h>
+#include <mutex>
+#include <semaphore>
+#endif
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#ifdef _WIN32
+#include "Process.hpp"
+#include "Job.hpp"
+#include "Semaphore.hpp"
+#include "OverlappedOp.hpp"
+#include "Pipes/OverlappedNamedPipeServer.hpp"
+#else
+#include "Pipes/UnixSocketServer.hpp"
+#endif
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		Keeps a set of warm worker processes and hands requests to
+	///		them over a per-worker channel, avoiding the cost of starting
+	///		a process for each unit of work. Each worker is started with
+	///		the channel name appended to commandLine and is expected to
+	///		serve requests with a ProcessPoolWorker. Workers are replaced
+	///		after crashing, timing out or completing maxJobsPerWorker
+	///		requests.
+	///		On Windows the channel is a named pipe, and workers run in a
+	///		Job that is killed when the pool is destroyed. On Linux the
+	///		channel is a UnixSocketServer, workers are started with fork()
+	///		and execv(), and commandLine is split on whitespace into the
+	///		worker's argv, without quoting. A worker there exits when its
+	///		channel closes, including when the pool's process dies.
+	/// </summary>
+	class ProcessPool
+	{
+		public:
+			/// <summary>
+			///		Waits without a timeout. The same value as INFINITE.
+			/// </summary>
+			static constexpr std::uint32_t Infinite = 0xFFFFFFFF;
+
+		public:
+			/// <summary>
+			///		Closes all worker channels and kills any remaining
+			///		worker processes.
+			/// </summary>
+			virtual ~ProcessPool();
+
+			/// <summary>
+			///		Creates a pool and starts workerCount workers.
+			/// </summary>
+			/// <param name="maxJobsPerWorker">
+			///		The number of requests a worker serves before it is
+			///		replaced. Pass 0 to never recycle workers.
+			/// </param>
+			ProcessPool(
+				std::wstring executablePath,
+				std::wstring commandLine,
+				std::wstring startingDirectory,
+				const std::uint32_t workerCount,
+				const std::uint32_t maxJobsPerWorker
+			);
+
+#ifdef _WIN32
+			/// <summary>
+			///		Creates a pool whose workers are started with the given
+			///		creation flags and constrained by the given Job limits.
+			///		JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE is always added.
+			/// </summary>
+			ProcessPool(
+				std::wstring executablePath,
+				std::wstring commandLine,
+				std::wstring startingDirectory,
+				const std::uint32_t workerCount,
+				const std::uint32_t maxJobsPerWorker,
+				const DWORD creationFlags,
+				const JOBOBJECT_EXTENDED_LIMIT_INFORMATION& limits
+			);
+#endif
+
+		// Non-copyable, non-movable
+		public:
+			ProcessPool(const ProcessPool&) = delete;
+			virtual ProcessPool& operator=(const ProcessPool&) = delete;
+			ProcessPool(ProcessPool&&) noexcept = delete;
+			virtual ProcessPool& operator=(ProcessPool&&) noexcept = delete;
+
+		public:
+			/// <summary>
+			///		Sends request to an idle worker and returns its response,
+			///		waiting for a worker to become idle if all are busy. If
+			///		the worker exits or does not respond within timeoutMillis,
+			///		it is killed and replaced, and an exception is thrown.
+			///		Requests are not retried, as they may not be idempotent.
+			/// </summary>
+			virtual std::wstring Submit(const std::wstring& request, const std::uint32_t timeoutMillis);
+			virtual bool Submit(
+				const std::wstring& request,
+				const std::uint32_t timeoutMillis,
+				std::wstring& response,
+				std::nothrow_t
+			) noexcept;
+
+			virtual std::uint32_t GetWorkerCount() const noexcept;
+			virtual std::uint32_t GetMaxJobsPerWorker() const noexcept;
+			virtual size_t GetIdleCount();
+			/// <summary>
+			///		Returns the number of worker processes started so far,
+			///		including replacements.
+			/// </summary>
+			virtual std::uint64_t GetSpawnCount() const noexcept;
+#ifdef _WIN32
+			virtual Job& GetJob() noexcept;
+#endif
+
+		protected:
+			struct Worker
+			{
+#ifdef _WIN32
+				Process WorkerProcess;
+				std::unique_ptr<OverlappedNamedPipeServer> Pipe;
+#else
+				pid_t ProcessId = -1;
+				std::unique_ptr<UnixSocketServer> Channel;
+#endif
+				std::uint32_t JobsCompleted = 0;
+			};
+
+		protected:
+#ifdef _WIN32
+			virtual void Create(const JOBOBJECT_EXTENDED_LIMIT_INFORMATION& limits);
+#else
+			virtual void Create();
+#endif
+			virtual std::unique_ptr<Worker> CreateWorker();
+			virtual std::unique_ptr<Worker> AcquireWorker(const std::uint32_t timeoutMillis);
+			virtual void ReleaseWorker(std::unique_ptr<Worker> worker);
+			virtual void KillWorker(std::unique_ptr<Worker> worker);
+			virtual std::wstring Exchange(Worker& worker, const std::wstring& request, const std::uint32_t timeoutMillis);
+#ifdef _WIN32
+			virtual void WaitForIo(Worker& worker, OverlappedOp& op, const UINT64 deadline);
+			virtual void CancelIo(Worker& worker, OverlappedOp& op) noexcept;
+#else
+			/// <summary>
+			///		Forks and execs a worker with channelPath as its final
+			///		argument, returning its process ID.
+			/// </summary>
+			virtual pid_t StartProcess(const std::wstring& channelPath);
+			/// <summary>
+			///		Kills a worker process and waits for it to exit.
+			/// </summary>
+			virtual void KillProcess(const pid_t processId) noexcept;
+			/// <summary>
+			///		Reaps recycled workers that have since exited.
+			/// </summary>
+			virtual void ReapExited();
+			/// <summary>
+			///		Kills every worker the pool still owns, as closing the
+			///		Job does on Windows.
+			/// </summary>
+			virtual void KillAll() noexcept;
+#endif
+
+		protected:
+			static constexpr std::uint32_t PipeBufferSize = 4096;
+			static constexpr std::uint32_t StartupTimeoutMillis = 10000;
+
+		protected:
+			std::wstring m_executablePath;
+			std::wstring m_commandLine;
+			std::wstring m_startingDirectory;
+			std::uint32_t m_workerCount;
+			std::uint32_t m_maxJobsPerWorker;
+#ifdef _WIN32
+			DWORD m_creationFlags;
+			Job m_job;
+			Semaphore m_available;
+#else
+			std::counting_semaphore<> m_available;
+			// Recycled workers, whose channels are closed, that have not
+			// been reaped yet
+			std::vector<pid_t> m_exiting;
+#endif
+			std::vector<std::unique_ptr<Worker>> m_idle;
+			std::atomic<std::uint64_t> m_spawnCount;
+#ifdef _WIN32
+			CRITICAL_SECTION m_cs;
+#else
+			std::mutex m_mutex;
+#endif
+	};
+}
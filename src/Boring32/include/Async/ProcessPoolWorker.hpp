@@ -0,0 +1,58 @@
+#pragma once
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+#include <string>
+#include <functional>
+#ifdef _WIN32
+#include "../Raii/Win32Handle.hpp"
+#else
+#include "Pipes/UnixSocketClient.hpp"
+#endif
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		The worker side of a ProcessPool. A worker process constructs
+	///		this with the pipe name the pool appended as the final
+	///		argument of its command line, then calls Run(). On Linux the
+	///		name is the path of the pool's UnixSocketServer.
+	/// </summary>
+	class ProcessPoolWorker
+	{
+		public:
+			virtual ~ProcessPoolWorker();
+			ProcessPoolWorker(std::wstring pipeName);
+
+		// Non-copyable, non-movable
+		public:
+			ProcessPoolWorker(const ProcessPoolWorker&) = delete;
+			virtual ProcessPoolWorker& operator=(const ProcessPoolWorker&) = delete;
+			ProcessPoolWorker(ProcessPoolWorker&&) noexcept = delete;
+			virtual ProcessPoolWorker& operator=(ProcessPoolWorker&&) noexcept = delete;
+
+		public:
+			/// <summary>
+			///		Connects to the pool and passes each request to handler,
+			///		sending back its return value as the response. Returns
+			///		when the pool closes the channel, which happens when
+			///		this worker is recycled or the pool is destroyed.
+			/// </summary>
+			virtual void Run(const std::function<std::wstring(const std::wstring&)>& handler);
+			virtual const std::wstring& GetPipeName() const noexcept;
+
+		protected:
+			virtual void Connect();
+			virtual bool ReadRequest(std::wstring& request);
+			virtual void WriteResponse(const std::wstring& response);
+
+		protected:
+			std::wstring m_pipeName;
+#ifdef _WIN32
+			Raii::Win32Handle m_pipe;
+			std::wstring m_buffer;
+#else
+			UnixSocketClient m_channel;
+#endif
+	};
+}
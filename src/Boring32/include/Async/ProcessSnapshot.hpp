@@ -0,0 +1,133 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+namespace Boring32::Async
+{
+	struct ProcessEntry
+	{
+		DWORD ProcessId = 0;
+		DWORD SessionId = 0;
+		/// <summary>
+		///		The time the process was created, as a FILETIME value. This
+		///		is what GetProcessTimes() reports, and tells a process
+		///		apart from an earlier one that had the same ID.
+		/// </summary>
+		UINT64 CreationTime = 0;
+		/// <summary>
+		///		The image name, as reported by the system.
+		/// </summary>
+		std::wstring Name;
+		/// <summary>
+		///		The image name, lower-cased for lookups.
+		/// </summary>
+		std::wstring NormalisedName;
+	};
+
+	/// <summary>
+	///		An indexed snapshot of the system's process table, for callers
+	///		that look processes up by name repeatedly. The table is read
+	///		with a single NtQuerySystemInformation() call, which also
+	///		supplies each process's session, and names are normalised once
+	///		per process rather than once per comparison. Refresh() updates
+	///		the snapshot in place, only indexing processes that are new.
+	/// </summary>
+	class ProcessSnapshot
+	{
+		public:
+			virtual ~ProcessSnapshot();
+			/// <summary>
+			///		Captures the current process table.
+			/// </summary>
+			ProcessSnapshot();
+
+		// Copyable, movable
+		public:
+			ProcessSnapshot(const ProcessSnapshot& other);
+			virtual ProcessSnapshot& operator=(const ProcessSnapshot& other);
+			ProcessSnapshot(ProcessSnapshot&& other) noexcept;
+			virtual ProcessSnapshot& operator=(ProcessSnapshot&& other) noexcept;
+
+		public:
+			/// <summary>
+			///		Brings the snapshot up to date. Processes that are
+			///		unchanged keep their entries, processes that exited are
+			///		removed, and new processes are added to the index. A
+			///		process whose ID was reused is recognised by its
+			///		creation time, and its entry is replaced.
+			/// </summary>
+			virtual void Refresh();
+
+			/// <summary>
+			///		Returns the IDs of all processes with the given name,
+			///		which is matched case-insensitively.
+			/// </summary>
+			virtual std::vector<DWORD> FindByName(const std::wstring& name) const;
+
+			/// <summary>
+			///		Returns the IDs of all processes with the given name
+			///		that are running in the given session.
+			/// </summary>
+			virtual std::vector<DWORD> FindByName(const std::wstring& name, const DWORD sessionId) const;
+
+			/// <summary>
+			///		Looks up several names at once, returning the matching
+			///		process IDs keyed by each name as passed in. Names with
+			///		no running processes map to an empty vector.
+			/// </summary>
+			virtual std::unordered_map<std::wstring, std::vector<DWORD>> FindByNames(
+				const std::vector<std::wstring>& names
+			) const;
+
+			/// <summary>
+			///		Finds a process ID by name, with the same semantics as
+			///		GetProcessIdByName(): pass a negative sessionIdToMatch
+			///		to match any session, and outResult is only modified if
+			///		a match is found.
+			/// </summary>
+			virtual bool GetProcessIdByName(
+				const std::wstring& name,
+				const int sessionIdToMatch,
+				DWORD& outResult
+			) const;
+
+			/// <summary>
+			///		Returns the entry for the given process ID, or nullptr if
+			///		the process was not running when last refreshed. The
+			///		pointer is invalidated by Refresh().
+			/// </summary>
+			virtual const ProcessEntry* GetById(const DWORD processId) const;
+
+			virtual size_t GetCount() const noexcept;
+
+		protected:
+			struct IndexedProcess
+			{
+				DWORD ProcessId;
+				DWORD SessionId;
+			};
+
+			struct TrackedEntry
+			{
+				ProcessEntry Entry;
+				UINT64 Generation;
+			};
+
+		protected:
+			virtual void QueryProcesses();
+			virtual void AddToIndex(const ProcessEntry& entry);
+			virtual void RemoveFromIndex(const ProcessEntry& entry);
+			virtual void Copy(const ProcessSnapshot& other);
+			virtual void Move(ProcessSnapshot& other) noexcept;
+			static std::wstring Normalise(std::wstring name);
+
+		protected:
+			std::unordered_map<DWORD, TrackedEntry> m_entries;
+			std::unordered_map<std::wstring, std::vector<IndexedProcess>> m_byName;
+			std::vector<std::byte> m_buffer;
+			UINT64 m_generation;
+	};
+}
@@ -0,0 +1,152 @@
+#pragma once
+#include <Windows.h>
+#include <atomic>
+#include <coroutine>
+#include "WaitableTimer.hpp"
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		A token bucket rate limiter. The bucket holds up to burst tokens
+	///		and refills at tokensPerSecond. Acquiring tokens that are available
+	///		is a single lock-free compare-and-swap; callers that need to wait
+	///		can block on, or co_await, a WaitableTimer.
+	/// </summary>
+	class RateLimiter
+	{
+		public:
+			/// <summary>
+			///		Awaitable returned by AcquireAsync(). Completes immediately
+			///		if the tokens are available, otherwise reserves the tokens
+			///		and resumes the coroutine on a thread pool thread once the
+			///		reservation falls due. The coroutine is resumed only once
+			///		both the timer has fired and the wait has been registered,
+			///		so the wait handle is always valid when it is released.
+			/// </summary>
+			class [[nodiscard]] Awaitable
+			{
+				public:
+					virtual ~Awaitable();
+					Awaitable(RateLimiter& limiter, const UINT tokens);
+
+					Awaitable(const Awaitable&) = delete;
+					Awaitable& operator=(const Awaitable&) = delete;
+
+				public:
+					bool await_ready();
+					bool await_suspend(std::coroutine_handle<> handle);
+					void await_resume() const noexcept;
+
+				protected:
+					static void CALLBACK OnTimer(void* param, BOOLEAN timedOut);
+
+				protected:
+					RateLimiter& m_limiter;
+					UINT m_tokens;
+					WaitableTimer m_timer;
+					HANDLE m_wait;
+					std::coroutine_handle<> m_handle;
+					// Incremented by await_suspend() once the wait is
+					// registered and by OnTimer(); whichever comes second
+					// continues the coroutine
+					std::atomic<UINT> m_arrivals;
+			};
+
+		// Non-copyable, non-movable
+		public:
+			virtual ~RateLimiter();
+
+			/// <summary>
+			///		Creates a full token bucket.
+			/// </summary>
+			/// <param name="tokensPerSecond">
+			///		The rate at which tokens are replenished. Must be greater than zero.
+			/// </param>
+			/// <param name="burst">
+			///		The capacity of the bucket, i.e. the maximum number of tokens that
+			///		can be acquired at once. Must be greater than zero.
+			/// </param>
+			RateLimiter(const double tokensPerSecond, const UINT burst);
+
+			RateLimiter(const RateLimiter&) = delete;
+			virtual RateLimiter& operator=(const RateLimiter&) = delete;
+			RateLimiter(RateLimiter&&) noexcept = delete;
+			virtual RateLimiter& operator=(RateLimiter&&) noexcept = delete;
+
+		public:
+			/// <summary>
+			///		Attempts to take the specified number of tokens without waiting.
+			/// </summary>
+			/// <returns>True if the tokens were taken, false otherwise.</returns>
+			virtual bool TryAcquire(const UINT tokens) noexcept;
+
+			/// <summary>
+			///		Takes the specified number of tokens, blocking the calling thread
+			///		on a WaitableTimer until they become available.
+			/// </summary>
+			/// <param name="tokens">
+			///		The number of tokens to take. Must not exceed the burst size.
+			///	</param>
+			/// <param name="millis">
+			///		The maximum time to wait, or INFINITE. If the tokens cannot become
+			///		available within this time, no tokens are taken and this function
+			///		returns immediately.
+			/// </param>
+			/// <returns>True if the tokens were taken, false otherwise.</returns>
+			virtual bool Acquire(const UINT tokens, const DWORD millis);
+
+			/// <summary>
+			///		Takes the specified number of tokens, borrowing from future
+			///		refills if necessary.
+			/// </summary>
+			/// <returns>
+			///		The time, in 100-nanosecond intervals, the caller must wait
+			///		before using the tokens. This is zero if the tokens were
+			///		available immediately.
+			/// </returns>
+			virtual int64_t Reserve(const UINT tokens);
+
+			/// <summary>
+			///		Returns an object that can be co_awaited to take the specified
+			///		number of tokens.
+			/// </summary>
+			virtual Awaitable AcquireAsync(const UINT tokens);
+
+			/// <summary>
+			///		Returns the number of tokens that could be acquired right now.
+			///		This is a snapshot and may be stale by the time it is used.
+			/// </summary>
+			virtual UINT GetAvailableTokens() const noexcept;
+			virtual double GetTokensPerSecond() const noexcept;
+			virtual UINT GetBurst() const noexcept;
+
+		protected:
+			virtual int64_t Now() const noexcept;
+			virtual void ValidateTokens(const UINT tokens) const;
+			virtual bool InternalReserve(
+				const UINT tokens,
+				const int64_t maxWait,
+				int64_t& outWait
+			) noexcept;
+			/// <summary>
+			///		Returns tokens taken by a reservation that will not be
+			///		used, such as when scheduling the wait for them failed.
+			/// </summary>
+			virtual void InternalRelease(const UINT tokens) noexcept;
+			virtual int64_t ToHundredNanoseconds(const int64_t ticks) const noexcept;
+
+		protected:
+			// Time is kept in QueryPerformanceCounter() ticks relative to m_epoch,
+			// scaled by 2^FractionalBits so that high rates do not lose precision.
+			static constexpr int FractionalBits = 8;
+			double m_tokensPerSecond;
+			UINT m_burst;
+			int64_t m_frequency;
+			int64_t m_epoch;
+			int64_t m_interval;
+			int64_t m_tolerance;
+			// The theoretical arrival time of the next token (GCRA). The bucket
+			// is full when this is at or before the current time.
+			std::atomic<int64_t> m_theoreticalArrival;
+	};
+}
@@ -0,0 +1,306 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <atomic>
+#include <optional>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <bit>
+#include <cstring>
+#include "MemoryMappedFile.hpp"
+
+namespace Boring32::Async
+{
+	struct SharedHashTableSettings
+	{
+		/// <summary>
+		///		The maximum number of entries. The table has at least half
+		///		as many buckets again, so probes stay short when full.
+		/// </summary>
+		UINT32 Capacity = 1024;
+		/// <summary>
+		///		Whether the handle can be inherited by child processes.
+		/// </summary>
+		bool Inheritable = false;
+		/// <summary>
+		///		Options for the underlying MemoryMappedFile, such as large
+		///		pages for big tables.
+		/// </summary>
+		MemoryMappedFileOptions Mapping;
+		/// <summary>
+		///		How long, in milliseconds, an operation waits for another
+		///		writer to finish writing a bucket before assuming that the
+		///		writer died and throwing. Stored in the table, so it applies
+		///		to every process that attaches.
+		/// </summary>
+		UINT32 WriteTimeout = 5000;
+	};
+
+	/// <summary>
+	///		A fixed-capacity, open-addressing hash table that lives entirely
+	///		inside a named MemoryMappedFile, so that one process can build
+	///		a table that other processes attach to without copying it. The
+	///		layout holds no pointers. Each bucket has a sequence number that
+	///		writers make odd while they write it, so readers take no locks
+	///		and retry if a value changed while they copied it. Entries
+	///		cannot be removed. TKey and TValue must be trivially copyable,
+	///		and THash must give the same results in every process. Keys
+	///		are compared bytewise, so TKey must have no padding. A writer
+	///		that dies while writing a bucket leaves it locked, and
+	///		operations that reach the bucket throw std::runtime_error
+	///		once the write timeout passes.
+	/// </summary>
+	template<typename TKey, typename TValue, typename THash = std::hash<TKey>>
+		requires std::is_trivially_copyable_v<TKey>
+			&& std::has_unique_object_representations_v<TKey>
+			&& std::is_trivially_copyable_v<TValue>
+	class SharedHashTable
+	{
+		public:
+			/// <summary>
+			///		Creates a table.
+			/// </summary>
+			SharedHashTable(std::wstring name, const SharedHashTableSettings& settings)
+			:	m_header(nullptr),
+				m_buckets(nullptr),
+				m_mask(0)
+			{
+				if (settings.Capacity == 0)
+					throw std::invalid_argument(__FUNCSIG__ ": capacity must be greater than 0");
+				const UINT64 bucketCount = std::bit_ceil(static_cast<UINT64>(settings.Capacity) * 3 / 2 + 1);
+				const UINT64 size = sizeof(Header) + bucketCount * sizeof(Bucket);
+				if (size > MAXUINT)
+					throw std::invalid_argument(__FUNCSIG__ ": capacity is too large");
+
+				m_memory = MemoryMappedFile(
+					std::move(name),
+					static_cast<UINT>(size),
+					settings.Inheritable,
+					settings.Mapping
+				);
+				m_header = static_cast<Header*>(m_memory.GetViewPointer());
+				if (std::atomic_ref(m_header->Magic).load(std::memory_order_acquire) == Magic)
+					throw std::runtime_error(__FUNCSIG__ ": a table with this name already exists");
+				m_header->Version = Version;
+				m_header->KeySize = sizeof(TKey);
+				m_header->ValueSize = sizeof(TValue);
+				m_header->Capacity = settings.Capacity;
+				m_header->BucketCount = bucketCount;
+				m_header->WriteTimeout = settings.WriteTimeout;
+				std::atomic_ref(m_header->Magic).store(Magic, std::memory_order_release);
+				Attach();
+			}
+
+			/// <summary>
+			///		Attaches to a table created by another process. Pass
+			///		FILE_MAP_READ to attach read-only, or FILE_MAP_ALL_ACCESS
+			///		to also insert.
+			/// </summary>
+			SharedHashTable(std::wstring name, const DWORD desiredAccess)
+			:	m_header(nullptr),
+				m_buckets(nullptr),
+				m_mask(0)
+			{
+				// A size of 0 maps the whole section, whose size is only
+				// known from the header
+				m_memory = MemoryMappedFile(std::move(name), 0, false, desiredAccess);
+				m_header = static_cast<Header*>(m_memory.GetViewPointer());
+				if (std::atomic_ref(m_header->Magic).load(std::memory_order_acquire) != Magic)
+					throw std::runtime_error(__FUNCSIG__ ": the table has not been initialised");
+				if (m_header->Version != Version
+					|| m_header->KeySize != sizeof(TKey)
+					|| m_header->ValueSize != sizeof(TValue))
+					throw std::runtime_error(__FUNCSIG__ ": the table's layout does not match");
+				Attach();
+			}
+
+		// Non-copyable, movable
+		public:
+			SharedHashTable(const SharedHashTable&) = delete;
+			SharedHashTable& operator=(const SharedHashTable&) = delete;
+			SharedHashTable(SharedHashTable&&) noexcept = default;
+			SharedHashTable& operator=(SharedHashTable&&) noexcept = default;
+
+		public:
+			/// <summary>
+			///		Inserts the key, or replaces its value if present. Throws
+			///		std::length_error if a new key would exceed the capacity,
+			///		and std::runtime_error if a bucket stays locked past the
+			///		write timeout.
+			/// </summary>
+			/// <returns>True if the key was inserted, false if its value was replaced.</returns>
+			bool Insert(const TKey& key, const TValue& value)
+			{
+				for (UINT64 index = GetHome(key); ; index = (index + 1) & m_mask)
+				{
+					Bucket& bucket = m_buckets[index];
+					std::atomic_ref sequence(bucket.Sequence);
+					UINT64 current = sequence.load(std::memory_order_acquire);
+					if (current == 0)
+					{
+						if (std::atomic_ref(m_header->Count).fetch_add(1, std::memory_order_relaxed) >= m_header->Capacity)
+						{
+							std::atomic_ref(m_header->Count).fetch_sub(1, std::memory_order_relaxed);
+							throw std::length_error(__FUNCSIG__ ": the table is full");
+						}
+						if (sequence.compare_exchange_strong(current, 1, std::memory_order_acquire))
+						{
+							std::memcpy(&bucket.Key, &key, sizeof(TKey));
+							std::memcpy(&bucket.Value, &value, sizeof(TValue));
+							sequence.store(2, std::memory_order_release);
+							return true;
+						}
+						// Another writer claimed the bucket; it may be for
+						// this key, so look at it again once it is written
+						std::atomic_ref(m_header->Count).fetch_sub(1, std::memory_order_relaxed);
+					}
+					current = WaitForWritten(sequence);
+					if (std::memcmp(&bucket.Key, &key, sizeof(TKey)) != 0)
+						continue;
+
+					// Replace the value, making the sequence odd meanwhile
+					while (true)
+					{
+						if (sequence.compare_exchange_weak(current, current + 1, std::memory_order_acquire))
+						{
+							std::memcpy(&bucket.Value, &value, sizeof(TValue));
+							sequence.store(current + 2, std::memory_order_release);
+							return false;
+						}
+						current = WaitForWritten(sequence);
+					}
+				}
+			}
+
+			/// <summary>
+			///		Looks up a key without taking locks. Throws
+			///		std::runtime_error if a bucket stays locked past the
+			///		write timeout.
+			/// </summary>
+			std::optional<TValue> Find(const TKey& key) const
+			{
+				for (UINT64 index = GetHome(key); ; index = (index + 1) & m_mask)
+				{
+					const Bucket& bucket = m_buckets[index];
+					std::atomic_ref sequence(const_cast<UINT64&>(bucket.Sequence));
+					UINT64 before = sequence.load(std::memory_order_acquire);
+					if (before == 0)
+						return std::nullopt;
+					before = WaitForWritten(sequence);
+					// Keys never change once written
+					if (std::memcmp(&bucket.Key, &key, sizeof(TKey)) != 0)
+						continue;
+
+					while (true)
+					{
+						TValue value;
+						std::memcpy(&value, &bucket.Value, sizeof(TValue));
+						std::atomic_thread_fence(std::memory_order_acquire);
+						const UINT64 after = sequence.load(std::memory_order_relaxed);
+						if (before == after)
+							return value;
+						before = WaitForWritten(sequence);
+					}
+				}
+			}
+
+			bool Contains(const TKey& key) const
+			{
+				return Find(key).has_value();
+			}
+
+			UINT32 GetCount() const noexcept
+			{
+				return std::atomic_ref(m_header->Count).load(std::memory_order_relaxed);
+			}
+
+			UINT32 GetCapacity() const noexcept
+			{
+				return m_header->Capacity;
+			}
+
+			UINT64 GetBucketCount() const noexcept
+			{
+				return m_header->BucketCount;
+			}
+
+			/// <summary>
+			///		Returns the size of the shared memory holding the table.
+			/// </summary>
+			size_t GetSizeInBytes() const noexcept
+			{
+				return static_cast<size_t>(sizeof(Header) + m_header->BucketCount * sizeof(Bucket));
+			}
+
+		protected:
+			static constexpr UINT32 Magic = 0x54484232; // "2BHT"
+			static constexpr UINT32 Version = 2;
+
+			struct Header
+			{
+				UINT32 Magic;
+				UINT32 Version;
+				UINT32 KeySize;
+				UINT32 ValueSize;
+				UINT32 Capacity;
+				UINT32 Count;
+				UINT64 BucketCount;
+				UINT32 WriteTimeout;
+			};
+
+			struct Bucket
+			{
+				// 0 while empty, odd while being written, and even and
+				// incremented on every write once written
+				UINT64 Sequence;
+				TKey Key;
+				TValue Value;
+			};
+
+		protected:
+			void Attach()
+			{
+				m_buckets = reinterpret_cast<Bucket*>(reinterpret_cast<std::byte*>(m_header) + sizeof(Header));
+				m_mask = m_header->BucketCount - 1;
+			}
+
+			UINT64 GetHome(const TKey& key) const
+			{
+				// Spread the hash, as std::hash is the identity for integers
+				// with some implementations
+				const UINT64 hash = static_cast<UINT64>(THash{}(key)) * 0x9E3779B97F4A7C15ull;
+				return (hash >> 32 ^ hash) & m_mask;
+			}
+
+			UINT64 WaitForWritten(const std::atomic_ref<UINT64>& sequence) const
+			{
+				// Writes are short, so spin briefly before checking the
+				// clock
+				UINT64 current = sequence.load(std::memory_order_acquire);
+				for (int i = 0; (current & 1) && i < 1024; i++)
+				{
+					YieldProcessor();
+					current = sequence.load(std::memory_order_acquire);
+				}
+				if (!(current & 1))
+					return current;
+
+				const UINT64 deadline = GetTickCount64() + m_header->WriteTimeout;
+				while (current & 1)
+				{
+					if (GetTickCount64() >= deadline)
+						throw std::runtime_error(__FUNCSIG__ ": a bucket stayed locked past the write timeout; its writer may have died");
+					SwitchToThread();
+					current = sequence.load(std::memory_order_acquire);
+				}
+				return current;
+			}
+
+		protected:
+			MemoryMappedFile m_memory;
+			Header* m_header;
+			Bucket* m_buckets;
+			UINT64 m_mask;
+	};
+}
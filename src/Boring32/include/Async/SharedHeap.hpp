@@ -0,0 +1,125 @@
+#pragma once
+#include <Windows.h>
+#include <string>
+#include <cstddef>
+#include "MemoryMappedFile.hpp"
+
+namespace Boring32::Async
+{
+	struct SharedHeapHeader;
+
+	struct SharedHeapSettings
+	{
+		/// <summary>
+		///		Options for the underlying MemoryMappedFile. Set BaseAddress
+		///		to the same value in every process to use raw pointers, and
+		///		so std::pmr containers, in the heap.
+		/// </summary>
+		MemoryMappedFileOptions Mapping;
+		/// <summary>
+		///		How long, in milliseconds, to wait for another process
+		///		that is initialising the heap to finish.
+		/// </summary>
+		DWORD InitialiseTimeout = 5000;
+	};
+
+	/// <summary>
+	///		A heap inside a named MemoryMappedFile that any number of
+	///		processes can allocate from and free to concurrently. Blocks
+	///		are identified by their offset from the start of the heap,
+	///		which is the same in every process. Requests are rounded up to
+	///		one of a set of size classes, each with a lock-free free list
+	///		in the heap's header, so allocation and deallocation do not
+	///		take locks. Blocks carry no header: the size must be passed to
+	///		Deallocate(), as std::pmr does.
+	/// </summary>
+	class SharedHeap
+	{
+		public:
+			/// <summary>
+			///		The offset of a block, which is never 0.
+			/// </summary>
+			using Offset = UINT32;
+
+			static constexpr size_t MaxAlignment = 4096;
+			static constexpr UINT32 RootCount = 16;
+
+		public:
+			virtual ~SharedHeap();
+			/// <summary>
+			///		Creates a heap of the specified size, or attaches to an
+			///		existing one if create is false.
+			/// </summary>
+			SharedHeap(std::wstring name, const UINT size, const bool create);
+			SharedHeap(std::wstring name, const UINT size, const bool create, const SharedHeapSettings& settings);
+
+		// Non-copyable, movable
+		public:
+			SharedHeap(const SharedHeap&) = delete;
+			virtual SharedHeap& operator=(const SharedHeap&) = delete;
+			SharedHeap(SharedHeap&& other) noexcept;
+			virtual SharedHeap& operator=(SharedHeap&& other) noexcept;
+
+		public:
+			/// <summary>
+			///		Allocates a block of at least size bytes, aligned to
+			///		alignment, which must be a power of two no greater than
+			///		MaxAlignment. Throws std::bad_alloc if the heap is full.
+			/// </summary>
+			virtual Offset Allocate(const size_t size);
+			virtual Offset Allocate(const size_t size, const size_t alignment);
+
+			/// <summary>
+			///		Frees a block. size and alignment must be those it was
+			///		allocated with.
+			/// </summary>
+			virtual void Deallocate(const Offset offset, const size_t size);
+			virtual void Deallocate(const Offset offset, const size_t size, const size_t alignment);
+
+			virtual void* GetPointer(const Offset offset) const noexcept;
+			virtual Offset GetOffset(const void* pointer) const noexcept;
+
+			template<typename T>
+			T* Get(const Offset offset) const noexcept
+			{
+				return static_cast<T*>(GetPointer(offset));
+			}
+
+			/// <summary>
+			///		Sets one of RootCount shared slots, so that other
+			///		processes can find the structures built in the heap.
+			/// </summary>
+			virtual void SetRoot(const UINT32 index, const Offset offset);
+			virtual Offset GetRoot(const UINT32 index) const;
+
+			/// <summary>
+			///		Returns the bytes carved from the heap so far, whether
+			///		allocated or held in free lists.
+			/// </summary>
+			virtual size_t GetReservedBytes() const noexcept;
+			virtual size_t GetSize() const noexcept;
+			virtual const std::wstring& GetName() const noexcept;
+
+		public:
+			/// <summary>
+			///		Returns the size of the block used for a request, to
+			///		measure internal fragmentation.
+			/// </summary>
+			static size_t GetBlockSize(const size_t size, const size_t alignment);
+
+		protected:
+			virtual Offset Pop(const UINT32 sizeClass) noexcept;
+			virtual void Push(const UINT32 sizeClass, const Offset first, const Offset last) noexcept;
+			/// <summary>
+			///		Carves a chunk of blocks of the size class from the
+			///		unused part of the heap, returns one and frees the rest.
+			/// </summary>
+			virtual Offset Refill(const UINT32 sizeClass);
+			virtual SharedHeapHeader* GetHeader() const noexcept;
+
+		protected:
+			std::wstring m_name;
+			MemoryMappedFile m_memory;
+			std::byte* m_base;
+	};
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <memory_resource>
+#include "SharedHeap.hpp"
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		A std::pmr::memory_resource that allocates from a SharedHeap,
+	///		so that std::pmr containers keep their elements in shared
+	///		memory. std::pmr containers hold raw pointers, and a pointer to
+	///		their memory resource, so a container placed in the heap can
+	///		only be used by processes that map the heap at the same
+	///		BaseAddress and have a resource at the same address. Otherwise,
+	///		link shared structures with OffsetPtr.
+	/// </summary>
+	class SharedHeapResource : public std::pmr::memory_resource
+	{
+		public:
+			virtual ~SharedHeapResource();
+			/// <summary>
+			///		The heap must outlive this object.
+			/// </summary>
+			SharedHeapResource(SharedHeap& heap);
+
+		public:
+			virtual SharedHeap& GetHeap() const noexcept;
+
+		protected:
+			void* do_allocate(const size_t bytes, const size_t alignment) override;
+			void do_deallocate(void* pointer, const size_t bytes, const size_t alignment) override;
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+		protected:
+			SharedHeap* m_heap;
+	};
+}
@@ -0,0 +1,116 @@
+#pragma once
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <cstddef>
+#include "FileMapping.hpp"
+#include "FileMappingView.hpp"
+
+namespace Boring32::Async
+{
+	struct SlidingFileViewSettings
+	{
+		/// <summary>
+		///		The size of each window mapped on demand. Ranges larger than
+		///		this get a window of their own size.
+		/// </summary>
+		size_t WindowSize = 64 * 1024 * 1024;
+		/// <summary>
+		///		The most address space the mapped windows may take. The
+		///		least recently used windows are unmapped to stay under it.
+		///		A single range larger than this is still mapped.
+		/// </summary>
+		size_t MaxResidentBytes = 256 * 1024 * 1024;
+		/// <summary>
+		///		When a range is read from the second half of a window, map
+		///		the following window and prefetch it, so a sequential scan
+		///		does not stall on page faults when it crosses over.
+		/// </summary>
+		bool PrefetchNext = false;
+	};
+
+	/// <summary>
+	///		Gives access to any range of a FileMapping through a bounded set
+	///		of windowed views, so files larger than the address space that
+	///		can be spared can be scanned or randomly accessed.
+	/// </summary>
+	class SlidingFileView
+	{
+		public:
+			virtual ~SlidingFileView();
+			/// <summary>
+			///		The mapping must outlive this object.
+			/// </summary>
+			SlidingFileView(const FileMapping& mapping);
+			SlidingFileView(const FileMapping& mapping, const SlidingFileViewSettings& settings);
+
+		// Non-copyable, movable
+		public:
+			SlidingFileView(const SlidingFileView&) = delete;
+			virtual SlidingFileView& operator=(const SlidingFileView&) = delete;
+			SlidingFileView(SlidingFileView&& other) noexcept;
+			virtual SlidingFileView& operator=(SlidingFileView&& other) noexcept;
+
+		public:
+			/// <summary>
+			///		Returns length bytes of the file starting at offset,
+			///		mapping a window over them if none is mapped. The span
+			///		remains valid until a later call to At(), Prefetch() or
+			///		Release() unmaps its window.
+			/// </summary>
+			virtual std::span<std::byte> At(const std::uint64_t offset, const size_t length);
+
+			/// <summary>
+			///		Maps the window for offset, if needed, and asks the
+			///		system to read it in ahead of use.
+			/// </summary>
+			virtual void Prefetch(const std::uint64_t offset);
+
+			/// <summary>
+			///		Writes modified pages in all mapped windows to the file.
+			/// </summary>
+			virtual void Flush();
+
+			/// <summary>
+			///		Unmaps all windows.
+			/// </summary>
+			virtual void Release() noexcept;
+
+			virtual size_t GetMappedWindowCount() const noexcept;
+			virtual size_t GetResidentBytes() const noexcept;
+			virtual const SlidingFileViewSettings& GetSettings() const noexcept;
+
+		protected:
+			struct Window
+			{
+				FileMappingView View;
+				std::uint64_t LastUse = 0;
+				bool NextPrefetched = false;
+			};
+
+		protected:
+			/// <summary>
+			///		Returns the index of a window containing the range, or
+			///		the number of windows if none does.
+			/// </summary>
+			virtual size_t FindWindow(const std::uint64_t offset, const size_t length) const noexcept;
+			virtual size_t MapWindow(const std::uint64_t offset, const size_t length, const std::byte* pinned);
+			/// <summary>
+			///		Unmaps least recently used windows, other than the one
+			///		whose data starts at pinned, until bytes more can be
+			///		mapped without exceeding MaxResidentBytes.
+			/// </summary>
+			virtual void EvictFor(const size_t bytes, const std::byte* pinned) noexcept;
+			virtual void PrefetchAfter(const size_t index);
+
+		protected:
+			const FileMapping* m_mapping;
+			SlidingFileViewSettings m_settings;
+			std::vector<Window> m_windows;
+			size_t m_residentBytes;
+			std::uint64_t m_useCounter;
+	};
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <Windows.h>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include "../Raii/Win32Handle.hpp"
+#include "Event.hpp"
+#include "ThreadStatus.hpp"
+
+namespace Boring32::Async
+{
+	/// <summary>
+	///		The state of a single unit of work run on a cached thread.
+	///		This is shared between the PooledThread that submitted the
+	///		work and the worker running it, so either may outlive the other.
+	/// </summary>
+	struct PooledThreadJob
+	{
+		~PooledThreadJob();
+		PooledThreadJob(std::function<int(void*)> func, void* param);
+		PooledThreadJob(const PooledThreadJob&) = delete;
+		PooledThreadJob& operator=(const PooledThreadJob&) = delete;
+
+		std::function<int(void*)> Func;
+		void* Param;
+		std::atomic<ThreadStatus> Status;
+		UINT ExitCode;
+		Event Started;
+		Event Finished;
+		// The handle of the thread running this job, set while it runs
+		std::atomic<std::shared_ptr<const Raii::Win32Handle>> Thread;
+		// Held by the worker while it records that the job finished, and
+		// by anything acting on the running thread, so that the thread
+		// cannot move on to other work in between
+		CRITICAL_SECTION Lock;
+	};
+
+	/// <summary>
+	///		A cache of parked OS threads. Borrowing an idle thread avoids
+	///		the cost of _beginthreadex() for short-lived work. Threads are
+	///		created on demand, returned to the cache when their work
+	///		completes, and exit after being idle for idleTimeoutMillis or
+	///		if the cache already holds maxIdleThreads idle threads.
+	/// </summary>
+	class ThreadCache
+	{
+		public:
+			/// <summary>
+			///		Signals all cached threads to exit and waits for them
+			///		to finish, including any that are still running work.
+			/// </summary>
+			virtual ~ThreadCache();
+
+			ThreadCache(const DWORD maxIdleThreads, const DWORD idleTimeoutMillis);
+
+		// Non-copyable, non-movable
+		public:
+			ThreadCache(const ThreadCache&) = delete;
+			virtual ThreadCache& operator=(const ThreadCache&) = delete;
+			ThreadCache(ThreadCache&&) noexcept = delete;
+			virtual ThreadCache& operator=(ThreadCache&&) noexcept = delete;
+
+		public:
+			/// <summary>
+			///		Creates threads until the cache holds count idle threads,
+			///		or maxIdleThreads, whichever is lower.
+			/// </summary>
+			virtual void Prespawn(const DWORD count);
+
+			/// <summary>
+			///		Runs the job on an idle thread, creating a new thread if
+			///		none are idle.
+			/// </summary>
+			virtual void Submit(const std::shared_ptr<PooledThreadJob>& job);
+
+			/// <summary>
+			///		Terminates the thread running the job, which must be
+			///		running or suspended. The thread is removed from the
+			///		cache first so it is never handed more work, and the
+			///		job is marked terminated. The thread's resources are
+			///		leaked, as with TerminateThread() generally.
+			/// </summary>
+			virtual void Terminate(const std::shared_ptr<PooledThreadJob>& job, const DWORD exitCode);
+
+			virtual size_t GetIdleCount();
+			virtual size_t GetThreadCount();
+			virtual DWORD GetMaxIdleThreads() const noexcept;
+			virtual DWORD GetIdleTimeout() const noexcept;
+
+		protected:
+			struct Worker
+			{
+				Worker(ThreadCache& cache);
+
+				ThreadCache& Cache;
+				Raii::Win32Handle Handle;
+				Event Wake;
+				std::shared_ptr<PooledThreadJob> Job;
+				bool Exit;
+			};
+
+		protected:
+			virtual std::shared_ptr<Worker> CreateWorker();
+			virtual void RunJob(Worker& worker);
+			virtual bool ReturnWorker(const std::shared_ptr<Worker>& worker);
+			virtual bool RetireWorker(const std::shared_ptr<Worker>& worker);
+			static UINT WINAPI WorkerProc(void* param);
+
+		protected:
+			DWORD m_maxIdleThreads;
+			DWORD m_idleTimeout;
+			bool m_shuttingDown;
+			std::vector<std::shared_ptr<Worker>> m_idle;
+			std::vector<std::shared_ptr<Worker>> m_all;
+			CRITICAL_SECTION m_cs;
+	};
+}
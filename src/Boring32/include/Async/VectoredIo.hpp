@@ -0,0 +1,83 @@
+#pragma once
+#include <Windows.h>
+#include <cstddef>
+#include <span>
+
+namespace Boring32::Async
+{
+	struct ScatterReadResult
+	{
+		UINT64 BytesRead = 0;
+		/// <summary>
+		///		Set when reading a message from a message-mode pipe that
+		///		was larger than the pieces. The rest of the message is
+		///		returned by the next read.
+		/// </summary>
+		bool MoreData = false;
+	};
+
+	/// <summary>
+	///		What WriteGather() and ReadScatter() need to know about a
+	///		handle. Finding these out takes several system calls, so
+	///		callers making repeated transfers on one handle should get
+	///		them once with GetVectoredIoTraits() and pass them in.
+	/// </summary>
+	struct VectoredIoTraits
+	{
+		bool IsPipe = false;
+		bool IsMessagePipe = false;
+		bool IsMessageReadMode = false;
+		bool IsOverlapped = false;
+	};
+
+	/// <summary>
+	///		Queries the traits of a pipe or file handle. These must be
+	///		queried again if the handle's pipe read mode is changed.
+	/// </summary>
+	VectoredIoTraits GetVectoredIoTraits(const HANDLE handle);
+
+	/// <summary>
+	///		Writes pieces to a pipe or file handle, in order, as one
+	///		logical write, without the caller concatenating them first.
+	///		Message-mode pipes need a message to be written in one call,
+	///		so pieces are staged in a reused per-thread buffer; other
+	///		handles have small pieces coalesced and large pieces written
+	///		directly from the caller's memory. Handles opened for
+	///		overlapped I/O are supported for pipes only, as files would
+	///		need an explicit offset. Returns the number of bytes written.
+	/// </summary>
+	UINT64 WriteGather(
+		const HANDLE handle,
+		const std::span<const std::span<const std::byte>> pieces
+	);
+
+	/// <summary>
+	///		As above, using traits previously queried for the handle.
+	/// </summary>
+	UINT64 WriteGather(
+		const HANDLE handle,
+		const VectoredIoTraits& traits,
+		const std::span<const std::span<const std::byte>> pieces
+	);
+
+	/// <summary>
+	///		Reads from a pipe or file handle into pieces, filling each in
+	///		turn. From a pipe in message-read mode, reads one message and
+	///		stops at its end. Otherwise reads until every piece is full,
+	///		or the end of the file or the pipe is closed. Handles opened
+	///		for overlapped I/O are supported for pipes only.
+	/// </summary>
+	ScatterReadResult ReadScatter(
+		const HANDLE handle,
+		const std::span<const std::span<std::byte>> pieces
+	);
+
+	/// <summary>
+	///		As above, using traits previously queried for the handle.
+	/// </summary>
+	ScatterReadResult ReadScatter(
+		const HANDLE handle,
+		const VectoredIoTraits& traits,
+		const std::span<const std::span<std::byte>> pieces
+	);
+}
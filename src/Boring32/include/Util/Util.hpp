@@ -2,6 +2,8 @@
 #include <string>
 #include <stdexcept>
 #include <vector>
+#include <span>
+#include <cstddef>
 #include <Windows.h>
 
 #define colconc(str1,str2) #str1 ": " #str2
@@ -19,6 +21,14 @@ namespace Boring32::Util
 	std::vector<std::byte> StringToByteVector(const std::wstring& str);
 	std::vector<std::byte> StringToByteVector(const std::string& str);
 
+	/// <summary>
+	///		Computes the CRC-32C (Castagnoli) checksum of data. Pass the
+	///		checksum of the preceding bytes as previous to checksum data
+	///		held in several buffers.
+	/// </summary>
+	UINT32 Crc32c(const std::span<const std::byte> data) noexcept;
+	UINT32 Crc32c(const std::span<const std::byte> data, const UINT32 previous) noexcept;
+
 	// based on https://stackoverflow.com/questions/45172052/correct-way-to-initialize-a-container-of-stdbyte
 	template<typename... Ts>
 	std::vector<std::byte> ToByteVector(Ts&&... args) noexcept 
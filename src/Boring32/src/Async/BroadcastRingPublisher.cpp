@@ -0,0 +1,152 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include "include/Async/BroadcastRingPublisher.hpp"
+
+namespace Boring32::Async
+{
+	BroadcastRingPublisher::~BroadcastRingPublisher() { }
+
+	BroadcastRingPublisher::BroadcastRingPublisher()
+	:	m_header(nullptr)
+	{ }
+
+	BroadcastRingPublisher::BroadcastRingPublisher(std::wstring name)
+	:	BroadcastRingPublisher(std::move(name), BroadcastRingSettings{})
+	{ }
+
+	BroadcastRingPublisher::BroadcastRingPublisher(std::wstring name, const BroadcastRingSettings& settings)
+	:	m_name(std::move(name)),
+		m_header(nullptr)
+	{
+		if (m_name.empty())
+			throw std::invalid_argument(__FUNCSIG__ ": name cannot be empty");
+		if (!std::has_single_bit(settings.SlotCount))
+			throw std::invalid_argument(__FUNCSIG__ ": SlotCount must be a power of two");
+		if (settings.SlotSize <= sizeof(BroadcastRingSlotHeader) || settings.SlotSize % 64 != 0)
+			throw std::invalid_argument(__FUNCSIG__ ": SlotSize must be a multiple of 64 bytes");
+		if (settings.MaxSubscribers == 0)
+			throw std::invalid_argument(__FUNCSIG__ ": MaxSubscribers must be greater than 0");
+		const UINT64 size = GetBroadcastRingSize(settings.SlotCount, settings.SlotSize, settings.MaxSubscribers);
+		if (size > MAXUINT)
+			throw std::invalid_argument(__FUNCSIG__ ": the ring is too large");
+
+		m_memory = MemoryMappedFile(m_name, static_cast<UINT>(size), false, settings.Mapping);
+		m_header = static_cast<BroadcastRingHeader*>(m_memory.GetViewPointer());
+		if (std::atomic_ref(m_header->Magic).load(std::memory_order_acquire) == BroadcastRingHeader::CurrentMagic)
+			throw std::runtime_error(__FUNCSIG__ ": a ring with this name already exists");
+
+		// The events are created up front, so waking a subscriber never
+		// has to open one
+		m_events.reserve(settings.MaxSubscribers);
+		for (UINT32 i = 0; i < settings.MaxSubscribers; i++)
+			m_events.emplace_back(false, false, false, GetBroadcastRingEventName(m_name, i));
+
+		m_header->Version = BroadcastRingHeader::CurrentVersion;
+		m_header->SlotCount = settings.SlotCount;
+		m_header->SlotSize = settings.SlotSize;
+		m_header->MaxSubscribers = settings.MaxSubscribers;
+		std::atomic_ref(m_header->Magic).store(BroadcastRingHeader::CurrentMagic, std::memory_order_release);
+	}
+
+	BroadcastRingPublisher::BroadcastRingPublisher(BroadcastRingPublisher&& other) noexcept
+	:	m_header(nullptr)
+	{
+		Move(other);
+	}
+
+	BroadcastRingPublisher& BroadcastRingPublisher::operator=(BroadcastRingPublisher&& other) noexcept
+	{
+		Move(other);
+		return *this;
+	}
+
+	void BroadcastRingPublisher::Move(BroadcastRingPublisher& other) noexcept
+	{
+		m_name = std::move(other.m_name);
+		m_memory = std::move(other.m_memory);
+		m_events = std::move(other.m_events);
+		m_header = other.m_header;
+		other.m_header = nullptr;
+	}
+
+	UINT64 BroadcastRingPublisher::Publish(const std::span<const std::byte> message)
+	{
+		if (m_header == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": the publisher is closed");
+		if (message.size() > GetMaxMessageSize())
+			throw std::invalid_argument(__FUNCSIG__ ": message is larger than a slot");
+
+		// There is one publisher, so only it changes Published
+		const UINT64 sequence = std::atomic_ref(m_header->Published).load(std::memory_order_relaxed);
+		BroadcastRingSlotHeader* slot = GetBroadcastRingSlot(m_header, sequence);
+		std::atomic_ref slotSequence(slot->Sequence);
+		slotSequence.store(2 * sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot->Size = static_cast<UINT32>(message.size());
+		if (!message.empty())
+			std::memcpy(slot + 1, message.data(), message.size());
+		slotSequence.store(2 * sequence + 2, std::memory_order_release);
+
+		// Sequentially consistent with the subscribers' registration as
+		// waiters, so either they see the message or this sees them
+		std::atomic_ref(m_header->Published).store(sequence + 1, std::memory_order_seq_cst);
+		if (std::atomic_ref(m_header->WaiterCount).load(std::memory_order_seq_cst) > 0)
+			WakeSubscribers();
+		return sequence;
+	}
+
+	void BroadcastRingPublisher::WakeSubscribers()
+	{
+		for (UINT32 i = 0; i < m_header->MaxSubscribers; i++)
+		{
+			UINT32& waiting = GetBroadcastRingSubscriber(m_header, i)->Waiting;
+			if (std::atomic_ref(waiting).load(std::memory_order_relaxed) == 0)
+				continue;
+			// Whoever clears the flag removes the waiter from the count
+			if (std::atomic_ref(waiting).exchange(0, std::memory_order_acq_rel) == 1)
+			{
+				std::atomic_ref(m_header->WaiterCount).fetch_sub(1, std::memory_order_relaxed);
+				m_events[i].Signal();
+			}
+		}
+	}
+
+	UINT64 BroadcastRingPublisher::GetPublishedCount() const noexcept
+	{
+		if (m_header == nullptr)
+			return 0;
+		return std::atomic_ref(m_header->Published).load(std::memory_order_relaxed);
+	}
+
+	UINT32 BroadcastRingPublisher::GetSubscriberCount() const noexcept
+	{
+		if (m_header == nullptr)
+			return 0;
+		UINT32 count = 0;
+		for (UINT32 i = 0; i < m_header->MaxSubscribers; i++)
+			count += std::atomic_ref(GetBroadcastRingSubscriber(m_header, i)->State).load(std::memory_order_relaxed);
+		return count;
+	}
+
+	size_t BroadcastRingPublisher::GetMaxMessageSize() const noexcept
+	{
+		if (m_header == nullptr)
+			return 0;
+		return m_header->SlotSize - sizeof(BroadcastRingSlotHeader);
+	}
+
+	const std::wstring& BroadcastRingPublisher::GetName() const noexcept
+	{
+		return m_name;
+	}
+
+	void BroadcastRingPublisher::Close()
+	{
+		m_header = nullptr;
+		m_events.clear();
+		m_memory = MemoryMappedFile();
+	}
+}
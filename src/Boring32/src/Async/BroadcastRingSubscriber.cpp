@@ -0,0 +1,262 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <atomic>
+#include <algorithm>
+#include "include/Async/BroadcastRingSubscriber.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		bool IsProcessRunning(const DWORD processId)
+		{
+			HANDLE process = OpenProcess(SYNCHRONIZE, false, processId);
+			if (process == nullptr)
+				return GetLastError() != ERROR_INVALID_PARAMETER;
+			const bool running = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+			CloseHandle(process);
+			return running;
+		}
+	}
+
+	BroadcastRingSubscriber::~BroadcastRingSubscriber()
+	{
+		Close();
+	}
+
+	BroadcastRingSubscriber::BroadcastRingSubscriber()
+	:	m_header(nullptr),
+		m_entry(nullptr),
+		m_cursor(0),
+		m_lost(0)
+	{ }
+
+	BroadcastRingSubscriber::BroadcastRingSubscriber(std::wstring name)
+	:	BroadcastRingSubscriber(std::move(name), BroadcastRingSubscriberSettings{})
+	{ }
+
+	BroadcastRingSubscriber::BroadcastRingSubscriber(
+		std::wstring name,
+		const BroadcastRingSubscriberSettings& settings
+	)
+	:	m_name(std::move(name)),
+		m_settings(settings),
+		m_header(nullptr),
+		m_entry(nullptr),
+		m_cursor(0),
+		m_lost(0)
+	{
+		if (m_name.empty())
+			throw std::invalid_argument(__FUNCSIG__ ": name cannot be empty");
+
+		// A size of 0 maps the whole section, whose size is only known
+		// from the header
+		m_memory = MemoryMappedFile(m_name, 0, false, FILE_MAP_ALL_ACCESS);
+		m_header = static_cast<BroadcastRingHeader*>(m_memory.GetViewPointer());
+		if (std::atomic_ref(m_header->Magic).load(std::memory_order_acquire) != BroadcastRingHeader::CurrentMagic)
+			throw std::runtime_error(__FUNCSIG__ ": the ring has not been initialised");
+		if (m_header->Version != BroadcastRingHeader::CurrentVersion)
+			throw std::runtime_error(__FUNCSIG__ ": the ring has an unsupported version");
+		Join(m_settings.Start);
+	}
+
+	BroadcastRingSubscriber::BroadcastRingSubscriber(BroadcastRingSubscriber&& other) noexcept
+	:	m_header(nullptr),
+		m_entry(nullptr),
+		m_cursor(0),
+		m_lost(0)
+	{
+		Move(other);
+	}
+
+	BroadcastRingSubscriber& BroadcastRingSubscriber::operator=(BroadcastRingSubscriber&& other) noexcept
+	{
+		Close();
+		Move(other);
+		return *this;
+	}
+
+	void BroadcastRingSubscriber::Move(BroadcastRingSubscriber& other) noexcept
+	{
+		m_name = std::move(other.m_name);
+		m_settings = other.m_settings;
+		m_memory = std::move(other.m_memory);
+		m_event = std::move(other.m_event);
+		m_header = other.m_header;
+		m_entry = other.m_entry;
+		m_cursor = other.m_cursor;
+		m_lost = other.m_lost;
+		other.m_header = nullptr;
+		other.m_entry = nullptr;
+	}
+
+	void BroadcastRingSubscriber::Join(const BroadcastRingStart start)
+	{
+		// Claim a free entry, or failing that one left by a process that
+		// exited without detaching
+		for (int pass = 0; pass < 2 && m_entry == nullptr; pass++)
+		{
+			for (UINT32 i = 0; i < m_header->MaxSubscribers; i++)
+			{
+				BroadcastRingSubscriberEntry* entry = GetBroadcastRingSubscriber(m_header, i);
+				if (pass == 0)
+				{
+					UINT32 expected = 0;
+					if (!std::atomic_ref(entry->State).compare_exchange_strong(expected, 1, std::memory_order_acquire))
+						continue;
+					std::atomic_ref(entry->ProcessId).store(GetCurrentProcessId(), std::memory_order_relaxed);
+				}
+				else
+				{
+					// Only the process that swaps the dead process's ID for
+					// its own takes the entry over
+					UINT32 processId = std::atomic_ref(entry->ProcessId).load(std::memory_order_relaxed);
+					if (processId == 0 || IsProcessRunning(processId))
+						continue;
+					if (!std::atomic_ref(entry->ProcessId).compare_exchange_strong(processId, GetCurrentProcessId(), std::memory_order_acquire))
+						continue;
+				}
+				// A dead subscriber may have been counted as a waiter
+				ClearWaiting(entry);
+				m_event = Event(false, false, false, GetBroadcastRingEventName(m_name, i));
+				m_entry = entry;
+				break;
+			}
+		}
+		if (m_entry == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": the ring has no free subscriber entries");
+
+		const UINT64 published = std::atomic_ref(m_header->Published).load(std::memory_order_acquire);
+		if (start == BroadcastRingStart::Latest)
+			m_cursor = published;
+		else
+			m_cursor = published > m_header->SlotCount ? published - m_header->SlotCount : 0;
+	}
+
+	BroadcastReceiveResult BroadcastRingSubscriber::TryReceive(std::vector<std::byte>& message)
+	{
+		if (m_header == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": the subscriber is closed");
+
+		const UINT64 published = std::atomic_ref(m_header->Published).load(std::memory_order_acquire);
+		if (m_cursor >= published)
+			return BroadcastReceiveResult::Empty;
+		if (published - m_cursor > m_header->SlotCount)
+		{
+			SkipAhead();
+			return BroadcastReceiveResult::Lapped;
+		}
+
+		// The publisher may overwrite the slot while it is copied, which
+		// changes its sequence
+		BroadcastRingSlotHeader* slot = GetBroadcastRingSlot(m_header, m_cursor);
+		std::atomic_ref slotSequence(slot->Sequence);
+		const UINT64 sequence = slotSequence.load(std::memory_order_acquire);
+		if (sequence != 2 * m_cursor + 2)
+		{
+			SkipAhead();
+			return BroadcastReceiveResult::Lapped;
+		}
+		const size_t size = (std::min)(
+			static_cast<size_t>(slot->Size),
+			m_header->SlotSize - sizeof(BroadcastRingSlotHeader)
+		);
+		const std::byte* data = reinterpret_cast<const std::byte*>(slot + 1);
+		message.assign(data, data + size);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slotSequence.load(std::memory_order_relaxed) != sequence)
+		{
+			SkipAhead();
+			return BroadcastReceiveResult::Lapped;
+		}
+		m_cursor++;
+		return BroadcastReceiveResult::Message;
+	}
+
+	BroadcastReceiveResult BroadcastRingSubscriber::Receive(std::vector<std::byte>& message, const DWORD timeoutMillis)
+	{
+		const ULONGLONG start = GetTickCount64();
+		for (DWORD spin = 0; ; spin++)
+		{
+			const BroadcastReceiveResult result = TryReceive(message);
+			if (result != BroadcastReceiveResult::Empty)
+				return result;
+			if (spin < m_settings.SpinCount)
+			{
+				YieldProcessor();
+				continue;
+			}
+
+			const ULONGLONG elapsed = GetTickCount64() - start;
+			if (timeoutMillis != INFINITE && elapsed >= timeoutMillis)
+				return BroadcastReceiveResult::Empty;
+			Wait(timeoutMillis == INFINITE ? INFINITE : static_cast<DWORD>(timeoutMillis - elapsed));
+		}
+	}
+
+	void BroadcastRingSubscriber::Wait(const DWORD millis)
+	{
+		// Registering as a waiter is sequentially consistent with the
+		// publisher's update of Published, so either the check below sees
+		// a new message or the publisher sees this waiter and signals it.
+		// Whoever clears the flag removes the waiter from the count.
+		std::atomic_ref(m_header->WaiterCount).fetch_add(1, std::memory_order_seq_cst);
+		std::atomic_ref(m_entry->Waiting).store(1, std::memory_order_seq_cst);
+		if (std::atomic_ref(m_header->Published).load(std::memory_order_seq_cst) <= m_cursor)
+			m_event.WaitOnEvent(millis, false);
+		// If the publisher already cleared the flag its signal may arrive
+		// after this; the next wait then returns early and checks again
+		ClearWaiting(m_entry);
+	}
+
+	void BroadcastRingSubscriber::ClearWaiting(BroadcastRingSubscriberEntry* entry) noexcept
+	{
+		if (std::atomic_ref(entry->Waiting).exchange(0, std::memory_order_acq_rel) == 1)
+			std::atomic_ref(m_header->WaiterCount).fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	void BroadcastRingSubscriber::SkipAhead()
+	{
+		const UINT64 published = std::atomic_ref(m_header->Published).load(std::memory_order_acquire);
+		const UINT64 halfway = published - m_header->SlotCount / 2;
+		const UINT64 next = (std::max)(m_cursor + 1, halfway);
+		m_lost += next - m_cursor;
+		m_cursor = next;
+	}
+
+	UINT64 BroadcastRingSubscriber::GetCursor() const noexcept
+	{
+		return m_cursor;
+	}
+
+	UINT64 BroadcastRingSubscriber::GetLostCount() const noexcept
+	{
+		return m_lost;
+	}
+
+	UINT64 BroadcastRingSubscriber::GetBacklog() const noexcept
+	{
+		if (m_header == nullptr)
+			return 0;
+		return std::atomic_ref(m_header->Published).load(std::memory_order_relaxed) - m_cursor;
+	}
+
+	const std::wstring& BroadcastRingSubscriber::GetName() const noexcept
+	{
+		return m_name;
+	}
+
+	void BroadcastRingSubscriber::Close()
+	{
+		if (m_entry != nullptr)
+		{
+			ClearWaiting(m_entry);
+			std::atomic_ref(m_entry->ProcessId).store(0, std::memory_order_relaxed);
+			std::atomic_ref(m_entry->State).store(0, std::memory_order_release);
+			m_entry = nullptr;
+		}
+		m_header = nullptr;
+		m_event = Event();
+		m_memory = MemoryMappedFile();
+	}
+}
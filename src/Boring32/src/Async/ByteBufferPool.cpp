@@ -0,0 +1,101 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include "include/Async/CriticalSectionLock.hpp"
+#include "include/Async/ByteBufferPool.hpp"
+
+namespace Boring32::Async
+{
+	ByteBufferPool::~ByteBufferPool()
+	{
+		DeleteCriticalSection(&m_cs);
+	}
+
+	ByteBufferPool::ByteBufferPool(const size_t bufferSize, const size_t maxBuffers)
+	:	m_bufferSize(bufferSize),
+		m_maxBuffers(maxBuffers),
+		m_released(false, false, false)
+	{
+		if (bufferSize == 0)
+			throw std::invalid_argument(__FUNCSIG__ ": bufferSize must be greater than 0");
+		if (maxBuffers == 0)
+			throw std::invalid_argument(__FUNCSIG__ ": maxBuffers must be greater than 0");
+		m_buffers.reserve(maxBuffers);
+		m_free.reserve(maxBuffers);
+		InitializeCriticalSection(&m_cs);
+	}
+
+	std::byte* ByteBufferPool::Acquire(const DWORD waitMillis)
+	{
+		const UINT64 startedAt = GetTickCount64();
+		while (true)
+		{
+			{
+				CriticalSectionLock cs(m_cs);
+				if (m_free.empty() == false)
+				{
+					std::byte* buffer = m_free.back();
+					m_free.pop_back();
+					return buffer;
+				}
+				if (m_buffers.size() < m_maxBuffers)
+				{
+					m_buffers.push_back(std::make_unique<std::byte[]>(m_bufferSize));
+					return m_buffers.back().get();
+				}
+			}
+
+			DWORD remaining = INFINITE;
+			if (waitMillis != INFINITE)
+			{
+				const UINT64 elapsed = GetTickCount64() - startedAt;
+				if (elapsed >= waitMillis)
+					return nullptr;
+				remaining = (DWORD)(waitMillis - elapsed);
+			}
+			if (m_released.WaitOnEvent(remaining, false) == false)
+				return nullptr;
+		}
+	}
+
+	void ByteBufferPool::Release(std::byte* buffer)
+	{
+		if (buffer == nullptr)
+			throw std::invalid_argument(__FUNCSIG__ ": buffer is nullptr");
+		{
+			CriticalSectionLock cs(m_cs);
+			const bool owned = std::any_of(
+				m_buffers.begin(),
+				m_buffers.end(),
+				[buffer](const std::unique_ptr<std::byte[]>& candidate) { return candidate.get() == buffer; }
+			);
+			if (owned == false)
+				throw std::invalid_argument(__FUNCSIG__ ": buffer is not from this pool");
+			if (std::find(m_free.begin(), m_free.end(), buffer) != m_free.end())
+				throw std::invalid_argument(__FUNCSIG__ ": buffer has already been released");
+			m_free.push_back(buffer);
+		}
+		m_released.Signal();
+	}
+
+	size_t ByteBufferPool::GetBufferSize() const noexcept
+	{
+		return m_bufferSize;
+	}
+
+	size_t ByteBufferPool::GetMaxBuffers() const noexcept
+	{
+		return m_maxBuffers;
+	}
+
+	size_t ByteBufferPool::GetAvailableCount()
+	{
+		CriticalSectionLock cs(m_cs);
+		return m_free.size() + (m_maxBuffers - m_buffers.size());
+	}
+
+	HANDLE ByteBufferPool::GetReleasedHandle() const noexcept
+	{
+		return m_released.GetHandle();
+	}
+}
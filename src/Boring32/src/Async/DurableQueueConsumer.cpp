@@ -0,0 +1,263 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include "include/Error/Win32Error.hpp"
+#include "include/Util/Util.hpp"
+#include "include/Async/DurableQueueConsumer.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		constexpr wchar_t ConsumerPrefix[] = L"consumer.";
+
+		// The position file holds two slots that are written alternately,
+		// so a torn write, or a producer reading while a consumer commits,
+		// always leaves the previous position intact in the other slot.
+		struct PositionSlot
+		{
+			UINT64 Sequence;
+			UINT64 Segment;
+			UINT64 Offset;
+			UINT32 Checksum;
+			UINT32 Reserved;
+		};
+		constexpr UINT64 PositionFileSize = 2 * sizeof(PositionSlot);
+
+		struct SavedPosition
+		{
+			UINT64 Sequence = 0;
+			DurableQueuePosition Position;
+		};
+
+		UINT32 Checksum(const PositionSlot& slot) noexcept
+		{
+			const UINT64 fields[] = { slot.Sequence, slot.Segment, slot.Offset };
+			return Util::Crc32c(std::as_bytes(std::span(fields)));
+		}
+
+		std::wstring GetPositionPath(const std::wstring& directory, const std::wstring& name)
+		{
+			return directory + L"\\" + ConsumerPrefix + name;
+		}
+
+		std::optional<SavedPosition> ReadPosition(const std::span<const std::byte> file) noexcept
+		{
+			std::optional<SavedPosition> latest;
+			for (size_t i = 0; i < 2; i++)
+			{
+				PositionSlot slot;
+				std::memcpy(&slot, file.data() + i * sizeof(PositionSlot), sizeof(slot));
+				if (slot.Sequence == 0 || slot.Checksum != Checksum(slot))
+					continue;
+				if (!latest || slot.Sequence > latest->Sequence)
+					latest = SavedPosition{
+						.Sequence = slot.Sequence,
+						.Position = { .Segment = slot.Segment, .Offset = slot.Offset }
+					};
+			}
+			return latest;
+		}
+	}
+
+	DurableQueueConsumer::~DurableQueueConsumer() { }
+
+	DurableQueueConsumer::DurableQueueConsumer(std::wstring directory, std::wstring name)
+	:	DurableQueueConsumer(std::move(directory), std::move(name), DurableQueueSettings{})
+	{ }
+
+	DurableQueueConsumer::DurableQueueConsumer(
+		std::wstring directory,
+		std::wstring name,
+		const DurableQueueSettings& settings
+	)
+	:	m_directory(std::move(directory)),
+		m_name(std::move(name)),
+		m_settings(settings),
+		m_sequence(0)
+	{
+		if (m_directory.empty())
+			throw std::invalid_argument(__FUNCSIG__ ": directory cannot be empty");
+		if (m_name.empty())
+			throw std::invalid_argument(__FUNCSIG__ ": name cannot be empty");
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-createdirectoryw
+		if (!CreateDirectoryW(m_directory.c_str(), nullptr) && GetLastError() != ERROR_ALREADY_EXISTS)
+			throw Error::Win32Error(__FUNCSIG__ ": CreateDirectoryW() failed", GetLastError());
+
+		m_positionFile = FileMapping(GetPositionPath(m_directory, m_name), true, PositionFileSize);
+		m_positionView = m_positionFile.MapView(0, static_cast<size_t>(PositionFileSize));
+		if (const std::optional<SavedPosition> saved = ReadPosition(m_positionView.GetData()))
+		{
+			m_sequence = saved->Sequence;
+			m_position = saved->Position;
+			return;
+		}
+
+		const std::vector<UINT64> segments = DurableQueueSegment::GetSegments(m_directory);
+		m_position = {
+			.Segment = segments.empty() ? 0 : segments.front(),
+			.Offset = DurableQueueSegment::HeaderSize
+		};
+		// Registers the starting position with the producer straight away
+		Commit();
+	}
+
+	bool DurableQueueConsumer::TryDequeue(std::vector<std::byte>& record)
+	{
+		while (true)
+		{
+			if (!m_segment.IsOpen() && !OpenSegment())
+				return false;
+
+			std::span<const std::byte> payload;
+			switch (m_segment.Read(m_position.Offset, payload))
+			{
+				case DurableQueueSegment::ReadResult::NotReady:
+					return false;
+
+				case DurableQueueSegment::ReadResult::Record:
+					record.assign(payload.begin(), payload.end());
+					m_position.Offset += DurableQueueSegment::GetRecordSize(payload.size());
+					return true;
+
+				default:
+					break;
+			}
+
+			// The segment is finished; continue with the next one
+			m_segment = DurableQueueSegment();
+			m_position = {
+				.Segment = m_position.Segment + 1,
+				.Offset = DurableQueueSegment::HeaderSize
+			};
+		}
+	}
+
+	void DurableQueueConsumer::Commit()
+	{
+		if (!m_positionView.IsValid())
+			throw std::runtime_error(__FUNCSIG__ ": consumer is not open");
+
+		PositionSlot slot{
+			.Sequence = m_sequence + 1,
+			.Segment = m_position.Segment,
+			.Offset = m_position.Offset,
+			.Checksum = 0,
+			.Reserved = 0
+		};
+		slot.Checksum = Checksum(slot);
+		const size_t slotOffset = static_cast<size_t>(slot.Sequence % 2) * sizeof(PositionSlot);
+		std::memcpy(m_positionView.GetData().data() + slotOffset, &slot, sizeof(slot));
+		m_sequence = slot.Sequence;
+
+		if (m_settings.Durability == DurableQueueDurability::None)
+			return;
+		m_positionView.Flush();
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-flushfilebuffers
+		if (!FlushFileBuffers(m_positionFile.GetFileHandle()))
+			throw Error::Win32Error(__FUNCSIG__ ": FlushFileBuffers() failed", GetLastError());
+	}
+
+	bool DurableQueueConsumer::Commit(std::nothrow_t) noexcept
+	{
+		try
+		{
+			Commit();
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Commit() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	DurableQueuePosition DurableQueueConsumer::GetPosition() const noexcept
+	{
+		return m_position;
+	}
+
+	const std::wstring& DurableQueueConsumer::GetName() const noexcept
+	{
+		return m_name;
+	}
+
+	const std::wstring& DurableQueueConsumer::GetDirectory() const noexcept
+	{
+		return m_directory;
+	}
+
+	bool DurableQueueConsumer::OpenSegment()
+	{
+		const std::wstring path = DurableQueueSegment::GetSegmentPath(m_directory, m_position.Segment);
+		if (GetFileAttributesW(path.c_str()) == INVALID_FILE_ATTRIBUTES)
+		{
+			// The segment may have been recycled before this consumer
+			// registered; if so, skip to the oldest one that remains
+			const std::vector<UINT64> segments = DurableQueueSegment::GetSegments(m_directory);
+			const auto next = std::upper_bound(segments.begin(), segments.end(), m_position.Segment);
+			if (next == segments.end())
+				return false;
+			m_position = { .Segment = *next, .Offset = DurableQueueSegment::HeaderSize };
+		}
+		m_segment = DurableQueueSegment(m_directory, m_position.Segment, m_settings.SegmentSize, false);
+		return m_segment.IsOpen();
+	}
+
+	std::vector<std::wstring> DurableQueueConsumer::GetConsumers(const std::wstring& directory)
+	{
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-findfirstfilew
+		WIN32_FIND_DATAW data{ 0 };
+		const std::wstring pattern = directory + L"\\" + ConsumerPrefix + L"*";
+		HANDLE find = FindFirstFileW(pattern.c_str(), &data);
+		if (find == INVALID_HANDLE_VALUE)
+		{
+			const DWORD lastError = GetLastError();
+			if (lastError == ERROR_FILE_NOT_FOUND || lastError == ERROR_PATH_NOT_FOUND)
+				return {};
+			throw Error::Win32Error(__FUNCSIG__ ": FindFirstFileW() failed", lastError);
+		}
+
+		std::vector<std::wstring> consumers;
+		do
+		{
+			consumers.emplace_back(data.cFileName + std::size(ConsumerPrefix) - 1);
+		} while (FindNextFileW(find, &data));
+		const DWORD lastError = GetLastError();
+		FindClose(find);
+		if (lastError != ERROR_NO_MORE_FILES)
+			throw Error::Win32Error(__FUNCSIG__ ": FindNextFileW() failed", lastError);
+		return consumers;
+	}
+
+	std::optional<DurableQueuePosition> DurableQueueConsumer::LoadPosition(
+		const std::wstring& directory,
+		const std::wstring& name
+	)
+	{
+		// The consumer may have been removed since it was listed
+		const std::wstring path = GetPositionPath(directory, name);
+		if (GetFileAttributesW(path.c_str()) == INVALID_FILE_ATTRIBUTES)
+			return std::nullopt;
+		const FileMapping file(path, false);
+		if (file.GetSize() < PositionFileSize)
+			return std::nullopt;
+		const FileMappingView view = file.MapView(0, static_cast<size_t>(PositionFileSize));
+		if (const std::optional<SavedPosition> saved = ReadPosition(view.GetData()))
+			return saved->Position;
+		return std::nullopt;
+	}
+
+	void DurableQueueConsumer::Remove(const std::wstring& directory, const std::wstring& name)
+	{
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-deletefilew
+		if (!DeleteFileW(GetPositionPath(directory, name).c_str()) && GetLastError() != ERROR_FILE_NOT_FOUND)
+			throw Error::Win32Error(__FUNCSIG__ ": DeleteFileW() failed", GetLastError());
+	}
+}
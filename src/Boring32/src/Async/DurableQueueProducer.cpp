@@ -0,0 +1,210 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <iostream>
+#include <algorithm>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/DurableQueueProducer.hpp"
+#include "include/Async/DurableQueueConsumer.hpp"
+
+namespace Boring32::Async
+{
+	DurableQueueProducer::~DurableQueueProducer()
+	{
+		if (m_settings.Durability != DurableQueueDurability::None)
+			Flush(std::nothrow);
+	}
+
+	DurableQueueProducer::DurableQueueProducer(std::wstring directory)
+	:	DurableQueueProducer(std::move(directory), DurableQueueSettings{})
+	{ }
+
+	DurableQueueProducer::DurableQueueProducer(std::wstring directory, const DurableQueueSettings& settings)
+	:	m_directory(std::move(directory)),
+		m_settings(settings),
+		m_offset(DurableQueueSegment::HeaderSize),
+		m_flushedOffset(DurableQueueSegment::HeaderSize),
+		m_pendingRecords(0)
+	{
+		if (m_directory.empty())
+			throw std::invalid_argument(__FUNCSIG__ ": directory cannot be empty");
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-createdirectoryw
+		if (!CreateDirectoryW(m_directory.c_str(), nullptr) && GetLastError() != ERROR_ALREADY_EXISTS)
+			throw Error::Win32Error(__FUNCSIG__ ": CreateDirectoryW() failed", GetLastError());
+		Recover();
+	}
+
+	void DurableQueueProducer::Recover()
+	{
+		const std::vector<UINT64> segments = DurableQueueSegment::GetSegments(m_directory);
+		const UINT64 index = segments.empty() ? 0 : segments.back();
+		m_segment = DurableQueueSegment(m_directory, index, m_settings.SegmentSize, true);
+
+		// Everything up to the first record that fails validation was
+		// written completely. Anything after it is left over from a crash
+		// or a recycled file, and is overwritten by the next records.
+		std::span<const std::byte> payload;
+		m_offset = DurableQueueSegment::HeaderSize;
+		while (true)
+		{
+			const DurableQueueSegment::ReadResult result = m_segment.Read(m_offset, payload);
+			if (result == DurableQueueSegment::ReadResult::Record)
+			{
+				m_offset += DurableQueueSegment::GetRecordSize(payload.size());
+				continue;
+			}
+			if (result == DurableQueueSegment::ReadResult::End)
+			{
+				m_flushedOffset = m_offset;
+				OpenNextSegment();
+			}
+			break;
+		}
+		m_flushedOffset = m_offset;
+		m_pendingRecords = 0;
+	}
+
+	void DurableQueueProducer::Enqueue(const std::span<const std::byte> record)
+	{
+		if (record.size() > GetMaxRecordSize())
+			throw std::invalid_argument(__FUNCSIG__ ": record is larger than a segment");
+
+		while (!m_segment.Write(m_offset, record))
+			OpenNextSegment();
+		m_offset += DurableQueueSegment::GetRecordSize(record.size());
+		m_pendingRecords++;
+
+		switch (m_settings.Durability)
+		{
+			case DurableQueueDurability::EveryRecord:
+				Flush();
+				break;
+
+			case DurableQueueDurability::GroupCommit:
+				if (m_pendingRecords >= m_settings.GroupCommitRecords
+					|| m_offset - m_flushedOffset >= m_settings.GroupCommitBytes)
+				{
+					Flush();
+				}
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	bool DurableQueueProducer::Enqueue(const std::span<const std::byte> record, std::nothrow_t) noexcept
+	{
+		try
+		{
+			Enqueue(record);
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Enqueue() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	void DurableQueueProducer::Flush()
+	{
+		if (!m_segment.IsOpen() || m_offset == m_flushedOffset)
+			return;
+		// One flush covers every record written since the last, which is
+		// what makes group commit cheaper than flushing each record
+		m_segment.Flush(m_flushedOffset, static_cast<size_t>(m_offset - m_flushedOffset), true);
+		m_flushedOffset = m_offset;
+		m_pendingRecords = 0;
+	}
+
+	bool DurableQueueProducer::Flush(std::nothrow_t) noexcept
+	{
+		try
+		{
+			Flush();
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Flush() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	void DurableQueueProducer::OpenNextSegment()
+	{
+		// The end marker follows the last flushed record
+		if (m_settings.Durability != DurableQueueDurability::None)
+			m_segment.Flush(m_flushedOffset, 0, true);
+
+		const UINT64 next = m_segment.GetIndex() + 1;
+		m_segment = DurableQueueSegment();
+		if (m_settings.RecycleSegments)
+		{
+			// If the rename fails, for example because a consumer that has
+			// just registered still has the file open, a new file is made
+			if (const std::optional<UINT64> free = GetRecyclableSegment(next))
+				DurableQueueSegment::Recycle(m_directory, *free, next);
+		}
+		m_segment = DurableQueueSegment(m_directory, next, m_settings.SegmentSize, true);
+		m_offset = DurableQueueSegment::HeaderSize;
+		m_flushedOffset = DurableQueueSegment::HeaderSize;
+		m_pendingRecords = 0;
+	}
+
+	std::optional<UINT64> DurableQueueProducer::GetRecyclableSegment(const UINT64 next) const
+	{
+		const std::vector<std::wstring> consumers = DurableQueueConsumer::GetConsumers(m_directory);
+		if (consumers.empty())
+			return std::nullopt;
+
+		UINT64 lowest = next;
+		for (const std::wstring& name : consumers)
+		{
+			const std::optional<DurableQueuePosition> position =
+				DurableQueueConsumer::LoadPosition(m_directory, name);
+			// A consumer that has not saved a position yet may still read
+			// from any segment
+			if (!position)
+				return std::nullopt;
+			lowest = (std::min)(lowest, position->Segment);
+		}
+
+		const std::vector<UINT64> segments = DurableQueueSegment::GetSegments(m_directory);
+		if (!segments.empty() && segments.front() < lowest)
+			return segments.front();
+		return std::nullopt;
+	}
+
+	DurableQueuePosition DurableQueueProducer::GetPosition() const noexcept
+	{
+		return { .Segment = m_segment.GetIndex(), .Offset = m_offset };
+	}
+
+	size_t DurableQueueProducer::GetMaxRecordSize() const noexcept
+	{
+		return static_cast<size_t>(
+			m_settings.SegmentSize
+			- DurableQueueSegment::HeaderSize
+			- DurableQueueSegment::RecordHeaderSize
+		);
+	}
+
+	const std::wstring& DurableQueueProducer::GetDirectory() const noexcept
+	{
+		return m_directory;
+	}
+
+	const DurableQueueSettings& DurableQueueProducer::GetSettings() const noexcept
+	{
+		return m_settings;
+	}
+}
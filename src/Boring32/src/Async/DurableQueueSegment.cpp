@@ -0,0 +1,268 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cwctype>
+#include "include/Error/Win32Error.hpp"
+#include "include/Util/Util.hpp"
+#include "include/Async/DurableQueueSegment.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		constexpr UINT32 Magic = 0x5132424D; // "MB2Q"
+		constexpr UINT32 Version = 1;
+		constexpr UINT32 EndMarker = 0xFFFFFFFF;
+		constexpr wchar_t SegmentPrefix[] = L"segment.";
+
+		struct SegmentHeader
+		{
+			UINT32 Magic;
+			UINT32 Version;
+			UINT64 SegmentSize;
+			// Written last, so readers can tell a recycled file that is
+			// still being claimed from the segment they asked for
+			UINT64 Index;
+		};
+		static_assert(sizeof(SegmentHeader) <= DurableQueueSegment::HeaderSize);
+
+		struct RecordHeader
+		{
+			// The payload's length plus one, or EndMarker, so that zero
+			// means nothing has been written
+			UINT32 Size;
+			UINT32 Checksum;
+		};
+		static_assert(sizeof(RecordHeader) == DurableQueueSegment::RecordHeaderSize);
+
+		UINT32 Checksum(const UINT64 index, const UINT32 size, const std::span<const std::byte> payload) noexcept
+		{
+			const UINT64 seed[] = { index, size };
+			return Util::Crc32c(payload, Util::Crc32c(std::as_bytes(std::span(seed))));
+		}
+	}
+
+	DurableQueueSegment::~DurableQueueSegment() { }
+
+	DurableQueueSegment::DurableQueueSegment()
+	:	m_index(0),
+		m_size(0)
+	{ }
+
+	DurableQueueSegment::DurableQueueSegment(
+		const std::wstring& directory,
+		const UINT64 index,
+		const UINT64 size,
+		const bool writable
+	)
+	:	m_index(index),
+		m_size(size)
+	{
+		if (m_size <= HeaderSize + RecordHeaderSize || m_size % RecordHeaderSize)
+			throw std::invalid_argument(__FUNCSIG__ ": size must be a multiple of 8 larger than the headers");
+
+		m_mapping = FileMapping(GetSegmentPath(directory, index), writable, writable ? m_size : 0);
+		if (m_mapping.GetSize() < m_size)
+		{
+			// The producer creating the file has not extended it yet
+			m_mapping.Close();
+			return;
+		}
+		if (m_mapping.GetSize() > m_size)
+			throw std::invalid_argument(__FUNCSIG__ ": the segment is larger than the configured size");
+		m_view = m_mapping.MapView(0, static_cast<size_t>(m_size));
+
+		SegmentHeader* header = reinterpret_cast<SegmentHeader*>(m_view.GetData().data());
+		if (writable)
+		{
+			header->Magic = Magic;
+			header->Version = Version;
+			header->SegmentSize = m_size;
+			std::atomic_ref(header->Index).store(m_index, std::memory_order_release);
+			return;
+		}
+
+		if (std::atomic_ref(header->Index).load(std::memory_order_acquire) != m_index
+			|| header->Magic != Magic)
+		{
+			m_view.Close();
+			m_mapping.Close();
+			return;
+		}
+		if (header->Version != Version || header->SegmentSize != m_size)
+			throw std::runtime_error(__FUNCSIG__ ": the segment's format does not match");
+	}
+
+	DurableQueueSegment::DurableQueueSegment(DurableQueueSegment&& other) noexcept
+	:	m_index(0),
+		m_size(0)
+	{
+		Move(other);
+	}
+
+	DurableQueueSegment& DurableQueueSegment::operator=(DurableQueueSegment&& other) noexcept
+	{
+		Move(other);
+		return *this;
+	}
+
+	void DurableQueueSegment::Move(DurableQueueSegment& other) noexcept
+	{
+		// The view must be unmapped before its mapping is released
+		m_view = std::move(other.m_view);
+		m_mapping = std::move(other.m_mapping);
+		m_index = other.m_index;
+		m_size = other.m_size;
+	}
+
+	bool DurableQueueSegment::Write(const UINT64 offset, const std::span<const std::byte> payload)
+	{
+		if (!IsOpen())
+			throw std::runtime_error(__FUNCSIG__ ": segment is not open");
+		if (offset < HeaderSize || offset % RecordHeaderSize)
+			throw std::invalid_argument(__FUNCSIG__ ": offset is not a record boundary");
+		const UINT64 recordSize = GetRecordSize(payload.size());
+		if (recordSize > m_size - HeaderSize)
+			throw std::invalid_argument(__FUNCSIG__ ": record is larger than a segment");
+
+		std::byte* record = m_view.GetData().data() + offset;
+		if (offset + recordSize > m_size)
+		{
+			if (offset + RecordHeaderSize <= m_size)
+			{
+				RecordHeader* header = reinterpret_cast<RecordHeader*>(record);
+				header->Checksum = Checksum(m_index, EndMarker, {});
+				std::atomic_ref(header->Size).store(EndMarker, std::memory_order_release);
+			}
+			return false;
+		}
+
+		const UINT32 size = static_cast<UINT32>(payload.size() + 1);
+		if (!payload.empty())
+			std::memcpy(record + RecordHeaderSize, payload.data(), payload.size());
+		RecordHeader* header = reinterpret_cast<RecordHeader*>(record);
+		header->Checksum = Checksum(m_index, size, payload);
+		// Release orders the payload and checksum before the size, so a
+		// consumer in another process that sees the size sees the record
+		std::atomic_ref(header->Size).store(size, std::memory_order_release);
+		return true;
+	}
+
+	DurableQueueSegment::ReadResult DurableQueueSegment::Read(
+		const UINT64 offset,
+		std::span<const std::byte>& payload
+	) const
+	{
+		if (!IsOpen())
+			throw std::runtime_error(__FUNCSIG__ ": segment is not open");
+		// A record that ends exactly at the end of the segment leaves no
+		// room for an end marker
+		if (offset + RecordHeaderSize > m_size)
+			return ReadResult::End;
+
+		std::byte* record = m_view.GetData().data() + offset;
+		RecordHeader* header = reinterpret_cast<RecordHeader*>(record);
+		const UINT32 size = std::atomic_ref(header->Size).load(std::memory_order_acquire);
+		if (size == 0)
+			return ReadResult::NotReady;
+		if (size == EndMarker)
+			return header->Checksum == Checksum(m_index, EndMarker, {})
+				? ReadResult::End
+				: ReadResult::NotReady;
+
+		// Anything else may be left over from a recycled file or a torn
+		// write, so the length is only trusted once the checksum matches
+		const UINT64 length = size - 1;
+		if (offset + RecordHeaderSize + length > m_size)
+			return ReadResult::NotReady;
+		const std::span<const std::byte> candidate(record + RecordHeaderSize, static_cast<size_t>(length));
+		if (header->Checksum != Checksum(m_index, size, candidate))
+			return ReadResult::NotReady;
+		payload = candidate;
+		return ReadResult::Record;
+	}
+
+	void DurableQueueSegment::Flush(const UINT64 offset, const size_t length, const bool durable)
+	{
+		if (!IsOpen())
+			throw std::runtime_error(__FUNCSIG__ ": segment is not open");
+		// https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-flushviewoffile
+		const size_t flushLength = length ? length : static_cast<size_t>(m_size - offset);
+		if (!FlushViewOfFile(m_view.GetData().data() + offset, flushLength))
+			throw Error::Win32Error(__FUNCSIG__ ": FlushViewOfFile() failed", GetLastError());
+		if (durable && !FlushFileBuffers(m_mapping.GetFileHandle()))
+			throw Error::Win32Error(__FUNCSIG__ ": FlushFileBuffers() failed", GetLastError());
+	}
+
+	bool DurableQueueSegment::IsOpen() const noexcept
+	{
+		return m_view.IsValid();
+	}
+
+	UINT64 DurableQueueSegment::GetIndex() const noexcept
+	{
+		return m_index;
+	}
+
+	UINT64 DurableQueueSegment::GetSize() const noexcept
+	{
+		return m_size;
+	}
+
+	std::wstring DurableQueueSegment::GetSegmentPath(const std::wstring& directory, const UINT64 index)
+	{
+		return directory + L"\\" + SegmentPrefix + std::to_wstring(index);
+	}
+
+	std::vector<UINT64> DurableQueueSegment::GetSegments(const std::wstring& directory)
+	{
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-findfirstfilew
+		WIN32_FIND_DATAW data{ 0 };
+		const std::wstring pattern = directory + L"\\" + SegmentPrefix + L"*";
+		HANDLE find = FindFirstFileW(pattern.c_str(), &data);
+		if (find == INVALID_HANDLE_VALUE)
+		{
+			const DWORD lastError = GetLastError();
+			if (lastError == ERROR_FILE_NOT_FOUND || lastError == ERROR_PATH_NOT_FOUND)
+				return {};
+			throw Error::Win32Error(__FUNCSIG__ ": FindFirstFileW() failed", lastError);
+		}
+
+		std::vector<UINT64> segments;
+		do
+		{
+			const std::wstring suffix = data.cFileName + std::size(SegmentPrefix) - 1;
+			const bool isIndex = !suffix.empty() && std::all_of(
+				suffix.begin(),
+				suffix.end(),
+				[](const wchar_t c) { return std::iswdigit(c); }
+			);
+			if (isIndex)
+				segments.push_back(std::stoull(suffix));
+		} while (FindNextFileW(find, &data));
+		const DWORD lastError = GetLastError();
+		FindClose(find);
+		if (lastError != ERROR_NO_MORE_FILES)
+			throw Error::Win32Error(__FUNCSIG__ ": FindNextFileW() failed", lastError);
+
+		std::sort(segments.begin(), segments.end());
+		return segments;
+	}
+
+	bool DurableQueueSegment::Recycle(const std::wstring& directory, const UINT64 from, const UINT64 to)
+	{
+		// https://docs.microsoft.com/en-us/windows/win32/api/winbase/nf-winbase-movefileexw
+		return MoveFileExW(
+			GetSegmentPath(directory, from).c_str(),
+			GetSegmentPath(directory, to).c_str(),
+			MOVEFILE_WRITE_THROUGH
+		);
+	}
+
+	UINT64 DurableQueueSegment::GetRecordSize(const size_t length) noexcept
+	{
+		return (RecordHeaderSize + length + RecordHeaderSize - 1) / RecordHeaderSize * RecordHeaderSize;
+	}
+}
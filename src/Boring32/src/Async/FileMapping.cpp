@@ -0,0 +1,143 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/FileMapping.hpp"
+
+namespace Boring32::Async
+{
+	FileMapping::~FileMapping()
+	{
+		Close();
+	}
+
+	FileMapping::FileMapping()
+	:	m_size(0),
+		m_writable(false)
+	{ }
+
+	FileMapping::FileMapping(const std::wstring& path, const bool writable)
+	:	FileMapping(path, writable, 0)
+	{ }
+
+	FileMapping::FileMapping(const std::wstring& path, const bool writable, const std::uint64_t size)
+	:	m_path(path),
+		m_size(0),
+		m_writable(writable)
+	{
+		if (m_path.empty())
+			throw std::invalid_argument(__FUNCSIG__ ": path cannot be empty");
+
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-createfilew
+		m_file = CreateFileW(
+			m_path.c_str(),
+			m_writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+			FILE_SHARE_READ | FILE_SHARE_WRITE,
+			nullptr,
+			m_writable ? OPEN_ALWAYS : OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL,
+			nullptr
+		);
+		if (!m_file)
+			throw Error::Win32Error(__FUNCSIG__ ": CreateFileW() failed", GetLastError());
+
+		LARGE_INTEGER fileSize{ 0 };
+		if (!GetFileSizeEx(m_file.GetHandle(), &fileSize))
+			throw Error::Win32Error(__FUNCSIG__ ": GetFileSizeEx() failed", GetLastError());
+		m_size = fileSize.QuadPart;
+		if (size > m_size)
+		{
+			if (!m_writable)
+				throw std::invalid_argument(__FUNCSIG__ ": a read-only file cannot be extended");
+			m_size = size;
+		}
+
+		// A section cannot be created over an empty file, so there is
+		// nothing to map until the file has contents.
+		if (m_size == 0)
+			return;
+
+		// https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-createfilemappingw
+		// The file is extended to the section's size if it is smaller.
+		m_mapping = CreateFileMappingW(
+			m_file.GetHandle(),
+			nullptr,
+			m_writable ? PAGE_READWRITE : PAGE_READONLY,
+			static_cast<DWORD>(m_size >> 32),
+			static_cast<DWORD>(m_size),
+			nullptr
+		);
+		if (!m_mapping)
+			throw Error::Win32Error(__FUNCSIG__ ": CreateFileMappingW() failed", GetLastError());
+	}
+
+	FileMapping::FileMapping(FileMapping&& other) noexcept
+	:	m_size(0),
+		m_writable(false)
+	{
+		Move(other);
+	}
+
+	FileMapping& FileMapping::operator=(FileMapping&& other) noexcept
+	{
+		Move(other);
+		return *this;
+	}
+
+	void FileMapping::Move(FileMapping& other) noexcept
+	{
+		m_path = std::move(other.m_path);
+		m_mapping = std::move(other.m_mapping);
+		m_file = std::move(other.m_file);
+		m_size = other.m_size;
+		m_writable = other.m_writable;
+		other.m_size = 0;
+	}
+
+	FileMappingView FileMapping::MapView(const std::uint64_t offset, const size_t length) const
+	{
+		return FileMappingView(*this, offset, length);
+	}
+
+	void FileMapping::Close()
+	{
+		m_mapping = nullptr;
+		m_file = nullptr;
+		m_size = 0;
+	}
+
+	std::uint64_t FileMapping::GetSize() const noexcept
+	{
+		return m_size;
+	}
+
+	bool FileMapping::IsWritable() const noexcept
+	{
+		return m_writable;
+	}
+
+	const std::wstring& FileMapping::GetPath() const noexcept
+	{
+		return m_path;
+	}
+
+	HANDLE FileMapping::GetMappingHandle() const noexcept
+	{
+		return m_mapping.GetHandle();
+	}
+
+	HANDLE FileMapping::GetFileHandle() const noexcept
+	{
+		return m_file.GetHandle();
+	}
+
+	std::uint32_t FileMapping::GetAllocationGranularity() noexcept
+	{
+		static const std::uint32_t granularity =
+			[]() {
+				SYSTEM_INFO info{ 0 };
+				GetSystemInfo(&info);
+				return info.dwAllocationGranularity;
+			}();
+		return granularity;
+	}
+}
@@ -0,0 +1,181 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <cstdint>
+#include <iostream>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/FileMapping.hpp"
+#include "include/Async/FileMappingView.hpp"
+
+namespace Boring32::Async
+{
+	FileMappingView::~FileMappingView()
+	{
+		Close();
+	}
+
+	FileMappingView::FileMappingView()
+	:	m_base(nullptr),
+		m_data(nullptr),
+		m_offset(0),
+		m_size(0),
+		m_mappedSize(0)
+	{ }
+
+	FileMappingView::FileMappingView(
+		const FileMapping& mapping,
+		const std::uint64_t offset,
+		const size_t length
+	)
+	:	m_base(nullptr),
+		m_data(nullptr),
+		m_offset(offset),
+		m_size(length),
+		m_mappedSize(0)
+	{
+		if (!mapping.GetMappingHandle())
+			throw std::runtime_error(__FUNCSIG__ ": mapping is not open");
+		if (offset >= mapping.GetSize())
+			throw std::out_of_range(__FUNCSIG__ ": offset is beyond the end of the mapping");
+		const UINT64 available = mapping.GetSize() - offset;
+		if (m_size > available)
+			throw std::out_of_range(__FUNCSIG__ ": range is beyond the end of the mapping");
+		if (m_size == 0)
+		{
+			// On 32-bit builds the remainder of a large file may not
+			// fit in the address space
+			if (available > SIZE_MAX)
+				throw std::out_of_range(__FUNCSIG__ ": remainder of the mapping is too large to view");
+			m_size = static_cast<size_t>(available);
+		}
+
+		// View offsets must be a multiple of the allocation granularity
+		const UINT64 alignedOffset = offset - (offset % FileMapping::GetAllocationGranularity());
+		const size_t slack = static_cast<size_t>(offset - alignedOffset);
+		if (m_size > SIZE_MAX - slack)
+			throw std::out_of_range(__FUNCSIG__ ": range is too large to view");
+		m_mappedSize = slack + m_size;
+
+		// https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-mapviewoffile
+		m_base = MapViewOfFile(
+			mapping.GetMappingHandle(),
+			mapping.IsWritable() ? FILE_MAP_READ | FILE_MAP_WRITE : FILE_MAP_READ,
+			static_cast<DWORD>(alignedOffset >> 32),
+			static_cast<DWORD>(alignedOffset),
+			m_mappedSize
+		);
+		if (!m_base)
+			throw Error::Win32Error(__FUNCSIG__ ": MapViewOfFile() failed", GetLastError());
+		m_data = static_cast<std::byte*>(m_base) + slack;
+	}
+
+	FileMappingView::FileMappingView(FileMappingView&& other) noexcept
+	:	m_base(nullptr),
+		m_data(nullptr),
+		m_offset(0),
+		m_size(0),
+		m_mappedSize(0)
+	{
+		Move(other);
+	}
+
+	FileMappingView& FileMappingView::operator=(FileMappingView&& other) noexcept
+	{
+		Move(other);
+		return *this;
+	}
+
+	void FileMappingView::Move(FileMappingView& other) noexcept
+	{
+		Close();
+		m_base = other.m_base;
+		m_data = other.m_data;
+		m_offset = other.m_offset;
+		m_size = other.m_size;
+		m_mappedSize = other.m_mappedSize;
+		other.m_base = nullptr;
+		other.m_data = nullptr;
+		other.m_offset = 0;
+		other.m_size = 0;
+		other.m_mappedSize = 0;
+	}
+
+	std::span<std::byte> FileMappingView::GetData() const noexcept
+	{
+		return { m_data, m_data ? m_size : 0 };
+	}
+
+	std::uint64_t FileMappingView::GetOffset() const noexcept
+	{
+		return m_offset;
+	}
+
+	size_t FileMappingView::GetSize() const noexcept
+	{
+		return m_size;
+	}
+
+	size_t FileMappingView::GetMappedSize() const noexcept
+	{
+		return m_mappedSize;
+	}
+
+	bool FileMappingView::Contains(const std::uint64_t offset, const size_t length) const noexcept
+	{
+		return m_base
+			&& offset >= m_offset
+			&& offset - m_offset <= m_size
+			&& length <= m_size - (offset - m_offset);
+	}
+
+	bool FileMappingView::IsValid() const noexcept
+	{
+		return m_base != nullptr;
+	}
+
+	void FileMappingView::Flush()
+	{
+		if (!m_base)
+			throw std::runtime_error(__FUNCSIG__ ": view is not mapped");
+		// https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-flushviewoffile
+		if (!FlushViewOfFile(m_base, m_mappedSize))
+			throw Error::Win32Error(__FUNCSIG__ ": FlushViewOfFile() failed", GetLastError());
+	}
+
+	void FileMappingView::Prefetch()
+	{
+		if (!m_base)
+			throw std::runtime_error(__FUNCSIG__ ": view is not mapped");
+		// https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-prefetchvirtualmemory
+		WIN32_MEMORY_RANGE_ENTRY range{ .VirtualAddress = m_data, .NumberOfBytes = m_size };
+		if (!PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0))
+			throw Error::Win32Error(__FUNCSIG__ ": PrefetchVirtualMemory() failed", GetLastError());
+	}
+
+	bool FileMappingView::Prefetch(std::nothrow_t) noexcept
+	{
+		try
+		{
+			Prefetch();
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Prefetch() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	void FileMappingView::Close() noexcept
+	{
+		if (m_base)
+		{
+			UnmapViewOfFile(m_base);
+			m_base = nullptr;
+			m_data = nullptr;
+		}
+	}
+}
@@ -0,0 +1,114 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include "include/Async/FlatMessageBuilder.hpp"
+
+namespace Boring32::Async
+{
+	FlatMessageBuilder::~FlatMessageBuilder() { }
+
+	FlatMessageBuilder::FlatMessageBuilder(const std::span<std::byte> buffer, const UINT16 fieldCount)
+	:	m_buffer(buffer),
+		m_size(0),
+		m_fieldCount(fieldCount)
+	{
+		if (reinterpret_cast<UINT_PTR>(buffer.data()) % MaxAlignment)
+			throw std::invalid_argument(__FUNCSIG__ ": buffer must be 8 byte aligned");
+		if (buffer.size() > MAXUINT32)
+			m_buffer = buffer.first(MAXUINT32 / MaxAlignment * MaxAlignment);
+		if (m_buffer.size() < GetHeaderSize(fieldCount))
+			throw std::length_error(__FUNCSIG__ ": buffer is too small for the header");
+		Reset();
+	}
+
+	void FlatMessageBuilder::AddString(const UINT16 field, const std::string_view value)
+	{
+		AddArray(field, std::span<const char>(value));
+	}
+
+	void FlatMessageBuilder::AddString(const UINT16 field, const std::wstring_view value)
+	{
+		AddArray(field, std::span<const wchar_t>(value));
+	}
+
+	void FlatMessageBuilder::AddNested(const UINT16 field, const FlatMessageView& message)
+	{
+		AddArray(field, message.GetData());
+	}
+
+	std::span<std::byte> FlatMessageBuilder::Finish()
+	{
+		reinterpret_cast<FlatMessageHeader*>(m_buffer.data())->Size = static_cast<UINT32>(m_size);
+		return m_buffer.first(m_size);
+	}
+
+	void FlatMessageBuilder::Reset()
+	{
+		m_size = GetHeaderSize(m_fieldCount);
+		// Clears the vtable, so every field starts absent
+		std::memset(m_buffer.data(), 0, m_size);
+		FlatMessageHeader* header = reinterpret_cast<FlatMessageHeader*>(m_buffer.data());
+		header->Magic = FlatMessageHeader::MagicValue;
+		header->Version = FlatMessageHeader::CurrentVersion;
+		header->FieldCount = m_fieldCount;
+		header->Size = 0;
+	}
+
+	size_t FlatMessageBuilder::GetSize() const noexcept
+	{
+		return m_size;
+	}
+
+	size_t FlatMessageBuilder::GetCapacity() const noexcept
+	{
+		return m_buffer.size();
+	}
+
+	UINT16 FlatMessageBuilder::GetFieldCount() const noexcept
+	{
+		return m_fieldCount;
+	}
+
+	UINT32 FlatMessageBuilder::Allocate(const UINT16 field, const size_t length, const size_t alignment)
+	{
+		if (field >= m_fieldCount)
+			throw std::out_of_range(__FUNCSIG__ ": field is outside the vtable");
+		const size_t offset = AlignUp(m_size, alignment);
+		// Keeps the message a multiple of 8 bytes, so messages can be
+		// placed back to back or nested without realigning
+		const size_t end = AlignUp(offset + length, MaxAlignment);
+		if (length > m_buffer.size() || end > m_buffer.size())
+			throw std::length_error(__FUNCSIG__ ": the field does not fit in the buffer");
+
+		// Padding is zeroed so that stale buffer contents are not sent
+		std::memset(m_buffer.data() + m_size, 0, offset - m_size);
+		std::memset(m_buffer.data() + offset + length, 0, end - offset - length);
+		m_size = end;
+		return static_cast<UINT32>(offset);
+	}
+
+	std::span<std::byte> FlatMessageBuilder::AllocateArray(
+		const UINT16 field,
+		const size_t count,
+		const size_t elementSize
+	)
+	{
+		if (count > MAXUINT32 || count > m_buffer.size() / elementSize)
+			throw std::length_error(__FUNCSIG__ ": the field does not fit in the buffer");
+		const size_t length = count * elementSize;
+		const UINT32 offset = Allocate(field, ArrayHeaderSize + length, MaxAlignment);
+		const UINT32 elementCount = static_cast<UINT32>(count);
+		std::memcpy(m_buffer.data() + offset, &elementCount, sizeof(elementCount));
+		std::memset(m_buffer.data() + offset + sizeof(elementCount), 0, ArrayHeaderSize - sizeof(elementCount));
+		SetFieldOffset(field, offset);
+		return m_buffer.subspan(offset + ArrayHeaderSize, length);
+	}
+
+	void FlatMessageBuilder::SetFieldOffset(const UINT16 field, const UINT32 offset) noexcept
+	{
+		std::memcpy(
+			m_buffer.data() + sizeof(FlatMessageHeader) + field * sizeof(UINT32),
+			&offset,
+			sizeof(offset)
+		);
+	}
+}
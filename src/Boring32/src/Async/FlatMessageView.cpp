@@ -0,0 +1,113 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include "include/Async/FlatMessageView.hpp"
+#include "include/Async/FlatMessageBuilder.hpp"
+
+namespace Boring32::Async
+{
+	FlatMessageView::~FlatMessageView() { }
+
+	FlatMessageView::FlatMessageView()
+	:	m_data(nullptr),
+		m_size(0),
+		m_fieldCount(0)
+	{ }
+
+	FlatMessageView::FlatMessageView(const std::span<const std::byte> buffer)
+	:	m_data(buffer.data()),
+		m_size(0),
+		m_fieldCount(0)
+	{
+		if (reinterpret_cast<UINT_PTR>(buffer.data()) % alignof(UINT64))
+			throw std::invalid_argument(__FUNCSIG__ ": buffer must be 8 byte aligned");
+		if (buffer.size() < sizeof(FlatMessageHeader))
+			throw std::invalid_argument(__FUNCSIG__ ": buffer is too small to hold a message");
+
+		const FlatMessageHeader* header = reinterpret_cast<const FlatMessageHeader*>(buffer.data());
+		if (header->Magic != FlatMessageHeader::MagicValue)
+			throw std::invalid_argument(__FUNCSIG__ ": buffer does not hold a message");
+		if (header->Version != FlatMessageHeader::CurrentVersion)
+			throw std::invalid_argument(__FUNCSIG__ ": unsupported message version");
+		if (header->Size > buffer.size()
+			|| header->Size < FlatMessageBuilder::GetHeaderSize(header->FieldCount))
+		{
+			throw std::invalid_argument(__FUNCSIG__ ": message size is invalid");
+		}
+		m_size = header->Size;
+		m_fieldCount = header->FieldCount;
+	}
+
+	bool FlatMessageView::Has(const UINT16 field) const noexcept
+	{
+		return GetFieldOffset(field) != 0;
+	}
+
+	std::string_view FlatMessageView::GetString(const UINT16 field) const
+	{
+		const std::span<const std::byte> bytes = GetArrayBytes(field, sizeof(char), alignof(char));
+		return { reinterpret_cast<const char*>(bytes.data()), bytes.size() };
+	}
+
+	std::wstring_view FlatMessageView::GetWideString(const UINT16 field) const
+	{
+		const std::span<const std::byte> bytes = GetArrayBytes(field, sizeof(wchar_t), alignof(wchar_t));
+		return { reinterpret_cast<const wchar_t*>(bytes.data()), bytes.size() / sizeof(wchar_t) };
+	}
+
+	FlatMessageView FlatMessageView::GetNested(const UINT16 field) const
+	{
+		const std::span<const std::byte> bytes = GetArrayBytes(field, 1, alignof(UINT64));
+		return bytes.empty() ? FlatMessageView() : FlatMessageView(bytes);
+	}
+
+	UINT16 FlatMessageView::GetFieldCount() const noexcept
+	{
+		return m_fieldCount;
+	}
+
+	bool FlatMessageView::IsValid() const noexcept
+	{
+		return m_data && m_size;
+	}
+
+	std::span<const std::byte> FlatMessageView::GetData() const noexcept
+	{
+		return { m_data, m_size };
+	}
+
+	UINT32 FlatMessageView::GetFieldOffset(const UINT16 field) const noexcept
+	{
+		if (field >= m_fieldCount)
+			return 0;
+		UINT32 offset;
+		std::memcpy(
+			&offset,
+			m_data + sizeof(FlatMessageHeader) + field * sizeof(UINT32),
+			sizeof(offset)
+		);
+		return offset;
+	}
+
+	void FlatMessageView::CheckRange(const UINT64 offset, const UINT64 length, const size_t alignment) const
+	{
+		if (offset % alignment || offset + length > m_size)
+			throw std::out_of_range(__FUNCSIG__ ": field lies outside the message");
+	}
+
+	std::span<const std::byte> FlatMessageView::GetArrayBytes(
+		const UINT16 field,
+		const size_t elementSize,
+		const size_t alignment
+	) const
+	{
+		const UINT32 offset = GetFieldOffset(field);
+		if (!offset)
+			return {};
+		CheckRange(offset, FlatMessageBuilder::ArrayHeaderSize, alignof(UINT64));
+		UINT32 count;
+		std::memcpy(&count, m_data + offset, sizeof(count));
+		const UINT64 length = static_cast<UINT64>(count) * elementSize;
+		CheckRange(offset + FlatMessageBuilder::ArrayHeaderSize, length, alignment);
+		return { m_data + offset + FlatMessageBuilder::ArrayHeaderSize, static_cast<size_t>(length) };
+	}
+}
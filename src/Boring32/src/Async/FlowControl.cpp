@@ -0,0 +1,193 @@
+#include "pch.hpp"
+#include "include/Async/CriticalSectionLock.hpp"
+#include "include/Async/FlowControl.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		constexpr UINT64 NoDeadline = MAXUINT64;
+
+		UINT64 ToDeadline(const DWORD timeoutMillis)
+		{
+			return timeoutMillis == INFINITE
+				? NoDeadline
+				: GetTickCount64() + timeoutMillis;
+		}
+
+		DWORD RemainingMillis(const UINT64 deadline)
+		{
+			if (deadline == NoDeadline)
+				return INFINITE;
+			const UINT64 now = GetTickCount64();
+			return deadline > now ? (DWORD)(deadline - now) : 0;
+		}
+	}
+
+	FlowControl::~FlowControl()
+	{
+		DeleteCriticalSection(&m_cs);
+	}
+
+	FlowControl::FlowControl()
+	:	FlowControl(FlowControlSettings{}, nullptr)
+	{ }
+
+	FlowControl::FlowControl(const FlowControlSettings& settings)
+	:	FlowControl(settings, nullptr)
+	{ }
+
+	FlowControl::FlowControl(const FlowControlSettings& settings, CreditHandler onCreditAvailable)
+	:	m_settings(settings),
+		m_onCreditAvailable(std::move(onCreditAvailable)),
+		m_messages(0),
+		m_bytes(0),
+		m_frequency{ 0 },
+		m_stallStart{ 0 },
+		m_stalled(false),
+		m_notifyPending(false),
+		m_cancelled(false)
+	{
+		QueryPerformanceFrequency(&m_frequency);
+		InitializeCriticalSection(&m_cs);
+		// https://docs.microsoft.com/en-us/windows/win32/sync/using-condition-variables
+		InitializeConditionVariable(&m_creditReleased);
+	}
+
+	bool FlowControl::TryAcquire(const UINT64 bytes)
+	{
+		CriticalSectionLock cs(m_cs);
+		if (m_cancelled)
+			return false;
+		if (HasCredit(bytes))
+		{
+			Take(bytes);
+			return true;
+		}
+		BeginStall();
+		m_notifyPending = true;
+		return false;
+	}
+
+	bool FlowControl::Acquire(const UINT64 bytes, const DWORD timeoutMillis)
+	{
+		const UINT64 deadline = ToDeadline(timeoutMillis);
+		CriticalSectionLock cs(m_cs);
+		while (m_cancelled == false)
+		{
+			if (HasCredit(bytes))
+			{
+				Take(bytes);
+				return true;
+			}
+			BeginStall();
+			const DWORD remaining = RemainingMillis(deadline);
+			if (remaining == 0)
+				return false;
+			// https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-sleepconditionvariablecs
+			SleepConditionVariableCS(&m_creditReleased, &m_cs, remaining);
+		}
+		return false;
+	}
+
+	void FlowControl::Release(const UINT64 bytes)
+	{
+		bool notify = false;
+		{
+			CriticalSectionLock cs(m_cs);
+			if (m_messages > 0)
+				m_messages--;
+			m_bytes = m_bytes > bytes ? m_bytes - bytes : 0;
+			notify = m_notifyPending && m_cancelled == false && m_onCreditAvailable != nullptr;
+			m_notifyPending = false;
+		}
+		WakeAllConditionVariable(&m_creditReleased);
+		// Outside the lock, so the handler can acquire credit
+		if (notify)
+			m_onCreditAvailable();
+	}
+
+	void FlowControl::Cancel()
+	{
+		{
+			CriticalSectionLock cs(m_cs);
+			m_cancelled = true;
+			m_notifyPending = false;
+		}
+		WakeAllConditionVariable(&m_creditReleased);
+	}
+
+	bool FlowControl::IsCancelled()
+	{
+		CriticalSectionLock cs(m_cs);
+		return m_cancelled;
+	}
+
+	UINT64 FlowControl::GetMessagesInFlight()
+	{
+		CriticalSectionLock cs(m_cs);
+		return m_messages;
+	}
+
+	UINT64 FlowControl::GetBytesInFlight()
+	{
+		CriticalSectionLock cs(m_cs);
+		return m_bytes;
+	}
+
+	FlowControlStats FlowControl::GetStats()
+	{
+		CriticalSectionLock cs(m_cs);
+		FlowControlStats stats = m_stats;
+		// Include a stall that is still going on
+		if (m_stalled)
+		{
+			LARGE_INTEGER now{ 0 };
+			QueryPerformanceCounter(&now);
+			stats.StalledMicroseconds += (now.QuadPart - m_stallStart.QuadPart) * 1000000 / m_frequency.QuadPart;
+		}
+		return stats;
+	}
+
+	const FlowControlSettings& FlowControl::GetSettings() const noexcept
+	{
+		return m_settings;
+	}
+
+	bool FlowControl::HasCredit(const UINT64 bytes) const noexcept
+	{
+		// A message that exceeds the byte limit on its own would otherwise
+		// never be sent
+		if (m_messages == 0)
+			return true;
+		if (m_settings.MaxMessages > 0 && m_messages >= m_settings.MaxMessages)
+			return false;
+		if (m_settings.MaxBytes > 0 && m_bytes + bytes > m_settings.MaxBytes)
+			return false;
+		return true;
+	}
+
+	void FlowControl::Take(const UINT64 bytes)
+	{
+		m_messages++;
+		m_bytes += bytes;
+		m_stats.PeakMessages = (std::max)(m_stats.PeakMessages, m_messages);
+		m_stats.PeakBytes = (std::max)(m_stats.PeakBytes, m_bytes);
+		if (m_stalled)
+		{
+			LARGE_INTEGER now{ 0 };
+			QueryPerformanceCounter(&now);
+			m_stats.StalledMicroseconds += (now.QuadPart - m_stallStart.QuadPart) * 1000000 / m_frequency.QuadPart;
+			m_stalled = false;
+		}
+	}
+
+	void FlowControl::BeginStall()
+	{
+		if (m_stalled)
+			return;
+		m_stalled = true;
+		m_stats.Stalls++;
+		QueryPerformanceCounter(&m_stallStart);
+	}
+}
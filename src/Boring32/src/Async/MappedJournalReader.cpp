@@ -0,0 +1,120 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include "include/Async/MappedJournalReader.hpp"
+
+namespace Boring32::Async
+{
+	MappedJournalReader::~MappedJournalReader() { }
+
+	MappedJournalReader::MappedJournalReader(std::wstring journalPath)
+	:	MappedJournalReader(std::move(journalPath), MappedJournalSettings{})
+	{ }
+
+	MappedJournalReader::MappedJournalReader(std::wstring journalPath, const MappedJournalSettings& settings)
+	:	m_path(std::move(journalPath)),
+		m_settings(settings),
+		m_segmentIndex(0),
+		m_offset(MappedJournalSegment::HeaderSize),
+		m_stalledSince(0)
+	{
+		if (m_path.empty())
+			throw std::invalid_argument(__FUNCSIG__ ": journalPath cannot be empty");
+	}
+
+	bool MappedJournalReader::TryRead(std::vector<std::byte>& record)
+	{
+		while (true)
+		{
+			if (!m_segment.IsOpen() && !OpenSegment())
+				return false;
+
+			if (m_offset + MappedJournalSegment::RecordHeaderSize <= m_segment.GetSize())
+			{
+				switch (m_segment.GetState(m_offset))
+				{
+					case MappedJournalSegment::RecordState::Empty:
+						if (m_segment.GetReservedEnd() <= m_offset || !HasCommitTimedOut())
+							return false;
+						// The writer died between reserving the record and
+						// recording its length, so the next record can't be found
+						throw std::runtime_error(__FUNCSIG__ ": a writer abandoned a record of unknown length");
+
+					case MappedJournalSegment::RecordState::Reserved:
+					{
+						const UINT32 length = GetCheckedLength();
+						if (!HasCommitTimedOut())
+							return false;
+						Advance(length);
+						continue;
+					}
+
+					case MappedJournalSegment::RecordState::Committed:
+					{
+						const UINT32 length = GetCheckedLength();
+						const std::span<std::byte> payload = m_segment.GetPayload(m_offset, length);
+						record.assign(payload.begin(), payload.end());
+						Advance(length);
+						return true;
+					}
+
+					case MappedJournalSegment::RecordState::End:
+						break;
+
+					default:
+						throw std::runtime_error(__FUNCSIG__ ": the journal is corrupt");
+				}
+			}
+
+			// The segment is finished; continue with the next one
+			m_segment = MappedJournalSegment();
+			m_segmentIndex++;
+			m_offset = MappedJournalSegment::HeaderSize;
+			m_stalledSince = 0;
+		}
+	}
+
+	UINT64 MappedJournalReader::GetSegmentIndex() const noexcept
+	{
+		return m_segmentIndex;
+	}
+
+	UINT64 MappedJournalReader::GetOffset() const noexcept
+	{
+		return m_offset;
+	}
+
+	const std::wstring& MappedJournalReader::GetPath() const noexcept
+	{
+		return m_path;
+	}
+
+	bool MappedJournalReader::OpenSegment()
+	{
+		if (!MappedJournalSegment::Exists(m_path, m_segmentIndex))
+			return false;
+		m_segment = MappedJournalSegment(m_path, m_segmentIndex, m_settings.SegmentSize, false);
+		return m_segment.IsOpen();
+	}
+
+	UINT32 MappedJournalReader::GetCheckedLength() const
+	{
+		const UINT32 length = m_segment.GetLength(m_offset);
+		if (MappedJournalSegment::GetRecordSize(length) > m_segment.GetSize() - m_offset)
+			throw std::runtime_error(__FUNCSIG__ ": the journal is corrupt");
+		return length;
+	}
+
+	bool MappedJournalReader::HasCommitTimedOut()
+	{
+		const UINT64 now = GetTickCount64();
+		if (!m_stalledSince)
+			m_stalledSince = now;
+		return now - m_stalledSince >= m_settings.CommitTimeout;
+	}
+
+	void MappedJournalReader::Advance(const UINT32 length) noexcept
+	{
+		m_offset += MappedJournalSegment::GetRecordSize(length);
+		m_stalledSince = 0;
+	}
+}
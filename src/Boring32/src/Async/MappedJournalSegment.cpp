@@ -0,0 +1,209 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <atomic>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/MappedJournalSegment.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		constexpr UINT32 Magic = 0x4A32424D; // "MB2J"
+		constexpr UINT32 Version = 2;
+
+		struct SegmentHeader
+		{
+			UINT32 Magic;
+			UINT32 Version;
+			UINT64 SegmentSize;
+			// Offset of the next record, relative to the end of the
+			// header, so that a zero-filled new file needs no setup
+			UINT64 Tail;
+		};
+		static_assert(sizeof(SegmentHeader) <= MappedJournalSegment::HeaderSize);
+	}
+
+	MappedJournalSegment::~MappedJournalSegment() { }
+
+	MappedJournalSegment::MappedJournalSegment()
+	:	m_index(0),
+		m_size(0)
+	{ }
+
+	MappedJournalSegment::MappedJournalSegment(
+		const std::wstring& journalPath,
+		const UINT64 index,
+		const UINT64 size,
+		const bool writable
+	)
+	:	m_index(index),
+		m_size(size)
+	{
+		if (m_size <= HeaderSize + RecordHeaderSize || m_size % RecordHeaderSize)
+			throw std::invalid_argument(__FUNCSIG__ ": size must be a multiple of 8 larger than the headers");
+
+		m_mapping = FileMapping(GetSegmentPath(journalPath, index), writable, writable ? m_size : 0);
+		if (m_mapping.GetSize() < m_size)
+		{
+			// The writer creating the file has not extended it yet
+			m_mapping.Close();
+			return;
+		}
+		if (m_mapping.GetSize() > m_size)
+			throw std::invalid_argument(__FUNCSIG__ ": the segment is larger than the configured size");
+		m_view = m_mapping.MapView(0, static_cast<size_t>(m_size));
+
+		SegmentHeader* header = reinterpret_cast<SegmentHeader*>(m_view.GetData().data());
+		if (writable)
+		{
+			// Every writer stores the same values, so racing is harmless
+			std::atomic_ref(header->Magic).store(Magic, std::memory_order_relaxed);
+			std::atomic_ref(header->Version).store(Version, std::memory_order_relaxed);
+			std::atomic_ref(header->SegmentSize).store(m_size, std::memory_order_relaxed);
+		}
+	}
+
+	MappedJournalSegment::MappedJournalSegment(MappedJournalSegment&& other) noexcept
+	:	m_index(0),
+		m_size(0)
+	{
+		Move(other);
+	}
+
+	MappedJournalSegment& MappedJournalSegment::operator=(MappedJournalSegment&& other) noexcept
+	{
+		Move(other);
+		return *this;
+	}
+
+	void MappedJournalSegment::Move(MappedJournalSegment& other) noexcept
+	{
+		// The view must be unmapped before its mapping is released
+		m_view = std::move(other.m_view);
+		m_mapping = std::move(other.m_mapping);
+		m_index = other.m_index;
+		m_size = other.m_size;
+	}
+
+	std::optional<UINT64> MappedJournalSegment::Reserve(const size_t length)
+	{
+		if (!IsOpen())
+			throw std::runtime_error(__FUNCSIG__ ": segment is not open");
+		const UINT64 recordSize = GetRecordSize(length);
+		if (recordSize > m_size - HeaderSize)
+			throw std::invalid_argument(__FUNCSIG__ ": record is larger than a segment");
+
+		const UINT64 offset = HeaderSize
+			+ std::atomic_ref(GetTail()).fetch_add(recordSize, std::memory_order_relaxed);
+		if (offset + recordSize <= m_size)
+		{
+			// Record the length straight away so readers can skip the
+			// record if this writer dies before committing it
+			*reinterpret_cast<UINT32*>(m_view.GetData().data() + offset + sizeof(UINT32)) = static_cast<UINT32>(length);
+			std::atomic_ref(GetStateField(offset)).store(
+				static_cast<UINT32>(RecordState::Reserved),
+				std::memory_order_release
+			);
+			return offset;
+		}
+
+		// Only the reservation that straddles the end of the segment can
+		// start within it, so only one writer writes the end marker.
+		if (offset + RecordHeaderSize <= m_size)
+			std::atomic_ref(GetStateField(offset)).store(
+				static_cast<UINT32>(RecordState::End),
+				std::memory_order_release
+			);
+		return std::nullopt;
+	}
+
+	std::span<std::byte> MappedJournalSegment::GetPayload(const UINT64 offset, const size_t length) const
+	{
+		return m_view.GetData().subspan(static_cast<size_t>(offset + RecordHeaderSize), length);
+	}
+
+	void MappedJournalSegment::Commit(const UINT64 offset, const size_t length)
+	{
+		std::byte* record = m_view.GetData().data() + offset;
+		*reinterpret_cast<UINT32*>(record + sizeof(UINT32)) = static_cast<UINT32>(length);
+		// Release orders the payload and length before the state, so a
+		// reader that sees Committed sees the whole record
+		std::atomic_ref(GetStateField(offset)).store(
+			static_cast<UINT32>(RecordState::Committed),
+			std::memory_order_release
+		);
+	}
+
+	MappedJournalSegment::RecordState MappedJournalSegment::GetState(const UINT64 offset) const
+	{
+		return static_cast<RecordState>(
+			std::atomic_ref(GetStateField(offset)).load(std::memory_order_acquire)
+		);
+	}
+
+	UINT32 MappedJournalSegment::GetLength(const UINT64 offset) const
+	{
+		return *reinterpret_cast<const UINT32*>(m_view.GetData().data() + offset + sizeof(UINT32));
+	}
+
+	UINT64 MappedJournalSegment::GetReservedEnd() const
+	{
+		if (!IsOpen())
+			throw std::runtime_error(__FUNCSIG__ ": segment is not open");
+		return HeaderSize + std::atomic_ref(GetTail()).load(std::memory_order_acquire);
+	}
+
+	void MappedJournalSegment::Flush(const UINT64 offset, const size_t length, const bool durable)
+	{
+		if (!IsOpen())
+			throw std::runtime_error(__FUNCSIG__ ": segment is not open");
+		// https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-flushviewoffile
+		const size_t flushLength = length ? length : static_cast<size_t>(m_size - offset);
+		if (!FlushViewOfFile(m_view.GetData().data() + offset, flushLength))
+			throw Error::Win32Error(__FUNCSIG__ ": FlushViewOfFile() failed", GetLastError());
+		// FlushViewOfFile() does not wait for the disk's cache or update
+		// the file's metadata
+		if (durable && !FlushFileBuffers(m_mapping.GetFileHandle()))
+			throw Error::Win32Error(__FUNCSIG__ ": FlushFileBuffers() failed", GetLastError());
+	}
+
+	bool MappedJournalSegment::IsOpen() const noexcept
+	{
+		return m_view.IsValid();
+	}
+
+	UINT64 MappedJournalSegment::GetIndex() const noexcept
+	{
+		return m_index;
+	}
+
+	UINT64 MappedJournalSegment::GetSize() const noexcept
+	{
+		return m_size;
+	}
+
+	std::wstring MappedJournalSegment::GetSegmentPath(const std::wstring& journalPath, const UINT64 index)
+	{
+		return journalPath + L"." + std::to_wstring(index);
+	}
+
+	bool MappedJournalSegment::Exists(const std::wstring& journalPath, const UINT64 index)
+	{
+		return GetFileAttributesW(GetSegmentPath(journalPath, index).c_str()) != INVALID_FILE_ATTRIBUTES;
+	}
+
+	UINT64 MappedJournalSegment::GetRecordSize(const size_t length) noexcept
+	{
+		return (RecordHeaderSize + length + RecordHeaderSize - 1) / RecordHeaderSize * RecordHeaderSize;
+	}
+
+	UINT64& MappedJournalSegment::GetTail() const noexcept
+	{
+		return reinterpret_cast<SegmentHeader*>(m_view.GetData().data())->Tail;
+	}
+
+	UINT32& MappedJournalSegment::GetStateField(const UINT64 offset) const noexcept
+	{
+		return *reinterpret_cast<UINT32*>(m_view.GetData().data() + offset);
+	}
+}
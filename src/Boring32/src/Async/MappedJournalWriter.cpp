@@ -0,0 +1,100 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <iostream>
+#include <cstring>
+#include "include/Async/MappedJournalWriter.hpp"
+
+namespace Boring32::Async
+{
+	MappedJournalWriter::~MappedJournalWriter() { }
+
+	MappedJournalWriter::MappedJournalWriter(std::wstring journalPath)
+	:	MappedJournalWriter(std::move(journalPath), MappedJournalSettings{})
+	{ }
+
+	MappedJournalWriter::MappedJournalWriter(std::wstring journalPath, const MappedJournalSettings& settings)
+	:	m_path(std::move(journalPath)),
+		m_settings(settings)
+	{
+		if (m_path.empty())
+			throw std::invalid_argument(__FUNCSIG__ ": journalPath cannot be empty");
+
+		UINT64 index = 0;
+		while (MappedJournalSegment::Exists(m_path, index + 1))
+			index++;
+		m_segment = MappedJournalSegment(m_path, index, m_settings.SegmentSize, true);
+	}
+
+	void MappedJournalWriter::Append(const std::span<const std::byte> record)
+	{
+		if (record.size() > GetMaxRecordSize())
+			throw std::invalid_argument(__FUNCSIG__ ": record is larger than a segment");
+
+		while (true)
+		{
+			if (const std::optional<UINT64> offset = m_segment.Reserve(record.size()))
+			{
+				if (!record.empty())
+					std::memcpy(m_segment.GetPayload(*offset, record.size()).data(), record.data(), record.size());
+				m_segment.Commit(*offset, record.size());
+				if (m_settings.Durable)
+					m_segment.Flush(
+						*offset,
+						static_cast<size_t>(MappedJournalSegment::GetRecordSize(record.size())),
+						true
+					);
+				return;
+			}
+			// The segment is full. The next one may already have been
+			// filled by other writers, in which case the loop moves on again.
+			m_segment = MappedJournalSegment(m_path, m_segment.GetIndex() + 1, m_settings.SegmentSize, true);
+		}
+	}
+
+	bool MappedJournalWriter::Append(const std::span<const std::byte> record, std::nothrow_t) noexcept
+	{
+		try
+		{
+			Append(record);
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Append() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	void MappedJournalWriter::Flush()
+	{
+		m_segment.Flush(0, 0, true);
+	}
+
+	size_t MappedJournalWriter::GetMaxRecordSize() const noexcept
+	{
+		return static_cast<size_t>(
+			m_settings.SegmentSize
+			- MappedJournalSegment::HeaderSize
+			- MappedJournalSegment::RecordHeaderSize
+		);
+	}
+
+	UINT64 MappedJournalWriter::GetSegmentIndex() const noexcept
+	{
+		return m_segment.GetIndex();
+	}
+
+	const std::wstring& MappedJournalWriter::GetPath() const noexcept
+	{
+		return m_path;
+	}
+
+	const MappedJournalSettings& MappedJournalWriter::GetSettings() const noexcept
+	{
+		return m_settings;
+	}
+}
@@ -1,6 +1,8 @@
 #include "pch.hpp"
 #include <stdexcept>
+#include <iostream>
 #include "include/Error/Win32Error.hpp"
+#include "include/Security/SecurityFunctions.hpp"
 #include "include/Async/MemoryMappedFile.hpp"
 
 namespace Boring32::Async
@@ -24,7 +26,8 @@ namespace Boring32::Async
 	:	m_name(L""),
 		m_maxSize(0),
 		m_mapFile(nullptr),
-		m_view(nullptr)
+		m_view(nullptr),
+		m_largePages(false)
 	{ }
 	
 	MemoryMappedFile::MemoryMappedFile(
@@ -35,7 +38,8 @@ namespace Boring32::Async
 	:	m_name(std::move(name)),
 		m_maxSize(maxSize),
 		m_mapFile(nullptr),
-		m_view(nullptr)
+		m_view(nullptr),
+		m_largePages(false)
 	{
 		m_mapFile = CreateFileMappingW(
 			INVALID_HANDLE_VALUE,		// use paging file
@@ -73,7 +77,8 @@ namespace Boring32::Async
 	:	m_name(std::move(name)),
 		m_maxSize(maxSize),
 		m_mapFile(nullptr),
-		m_view(nullptr)
+		m_view(nullptr),
+		m_largePages(false)
 	{
 		// desiredAccess: https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-mapviewoffile
 		m_mapFile = OpenFileMappingW(
@@ -98,10 +103,79 @@ namespace Boring32::Async
 		}
 	}
 
+	MemoryMappedFile::MemoryMappedFile(
+		std::wstring name,
+		const UINT maxSize,
+		const bool inheritable,
+		const MemoryMappedFileOptions& options
+	)
+	:	m_name(std::move(name)),
+		m_maxSize(maxSize),
+		m_mapFile(nullptr),
+		m_view(nullptr),
+		m_largePages(false)
+	{
+		if (options.LargePages)
+		{
+			try
+			{
+				CreateLargePages(inheritable, options.BaseAddress);
+			}
+			catch (const std::exception&)
+			{
+				if (!options.FallbackToSmallPages)
+					throw;
+				m_maxSize = maxSize;
+			}
+		}
+		if (m_view == nullptr)
+			Create(PAGE_READWRITE, FILE_MAP_ALL_ACCESS, inheritable, options.BaseAddress);
+		if (options.Prefault)
+			Prefault();
+	}
+
+	MemoryMappedFile::MemoryMappedFile(
+		std::wstring name,
+		const UINT maxSize,
+		const bool inheritable,
+		const DWORD desiredAccess,
+		const MemoryMappedFileOptions& options
+	)
+	:	m_name(std::move(name)),
+		m_maxSize(maxSize),
+		m_mapFile(nullptr),
+		m_view(nullptr),
+		m_largePages(options.LargePages)
+	{
+		m_mapFile = OpenFileMappingW(desiredAccess, inheritable, m_name.c_str());
+		if (m_mapFile == nullptr)
+			throw Error::Win32Error(__FUNCSIG__ ": OpenFileMappingW() failed", GetLastError());
+
+		// https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-mapviewoffileex
+		m_view = MapViewOfFileEx(
+			m_mapFile.GetHandle(),
+			m_largePages ? desiredAccess | FILE_MAP_LARGE_PAGES : desiredAccess,
+			0,
+			0,
+			m_maxSize,
+			options.BaseAddress
+		);
+		if (m_view == nullptr)
+		{
+			const DWORD lastError = GetLastError();
+			Close();
+			throw Error::Win32Error(__FUNCSIG__ ": MapViewOfFileEx() failed", lastError);
+		}
+		if (options.Prefault)
+			Prefault();
+	}
+
 	MemoryMappedFile::MemoryMappedFile(const MemoryMappedFile& other)
 	:	m_name(other.m_name),
 		m_maxSize(other.m_maxSize),
-		m_mapFile(nullptr)
+		m_mapFile(nullptr),
+		m_view(nullptr),
+		m_largePages(false)
 	{
 		Copy(other);
 	}
@@ -119,11 +193,14 @@ namespace Boring32::Async
 		m_name = other.m_name;
 		m_maxSize = other.m_maxSize;
 		m_mapFile = other.m_mapFile;
+		m_largePages = other.m_largePages;
 		if (m_mapFile != nullptr)
 		{
 			m_view = MapViewOfFile(
 				m_mapFile.GetHandle(),   // handle to map object
-				FILE_MAP_ALL_ACCESS, // read/write permission
+				m_largePages
+					? FILE_MAP_ALL_ACCESS | FILE_MAP_LARGE_PAGES
+					: FILE_MAP_ALL_ACCESS, // read/write permission
 				0,
 				0,
 				m_maxSize
@@ -137,6 +214,9 @@ namespace Boring32::Async
 	}
 
 	MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& other) noexcept
+	:	m_maxSize(0),
+		m_view(nullptr),
+		m_largePages(false)
 	{
 		Move(other);
 	}
@@ -154,6 +234,7 @@ namespace Boring32::Async
 		m_mapFile = std::move(other.m_mapFile);
 		m_maxSize = other.m_maxSize;
 		m_view = other.m_view;
+		m_largePages = other.m_largePages;
 		other.m_mapFile = nullptr;
 		other.m_view = nullptr;
 	}
@@ -172,4 +253,140 @@ namespace Boring32::Async
 	{
 		return m_mapFile.IsInheritable();
 	}
+
+	UINT MemoryMappedFile::GetSize() const noexcept
+	{
+		return m_maxSize;
+	}
+
+	bool MemoryMappedFile::UsesLargePages() const noexcept
+	{
+		return m_largePages;
+	}
+
+	void MemoryMappedFile::Prefault()
+	{
+		if (m_view == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": view is not mapped");
+		if (m_largePages)
+			return;
+
+		SYSTEM_INFO info{ 0 };
+		GetSystemInfo(&info);
+		// Reading is enough to fault in a page of a pagefile-backed
+		// section, and does not race with writers in other processes.
+		const volatile std::byte* view = static_cast<const volatile std::byte*>(m_view);
+		for (UINT offset = 0; offset < m_maxSize; offset += info.dwPageSize)
+			(void)view[offset];
+	}
+
+	void MemoryMappedFile::Prefetch(const UINT offset, const UINT length)
+	{
+		CheckRange(offset, length);
+		// https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-prefetchvirtualmemory
+		WIN32_MEMORY_RANGE_ENTRY range{
+			.VirtualAddress = static_cast<std::byte*>(m_view) + offset,
+			.NumberOfBytes = length
+		};
+		if (!PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0))
+			throw Error::Win32Error(__FUNCSIG__ ": PrefetchVirtualMemory() failed", GetLastError());
+	}
+
+	bool MemoryMappedFile::Prefetch(const UINT offset, const UINT length, std::nothrow_t) noexcept
+	{
+		try
+		{
+			Prefetch(offset, length);
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Prefetch() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	void MemoryMappedFile::Evict(const UINT offset, const UINT length)
+	{
+		CheckRange(offset, length);
+		if (m_largePages || length == 0)
+			return;
+		// Unlocking pages that are not locked removes them from the
+		// working set, which is the documented way to trim a range.
+		// https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-virtualunlock
+		if (!VirtualUnlock(static_cast<std::byte*>(m_view) + offset, length))
+		{
+			const DWORD lastError = GetLastError();
+			if (lastError != ERROR_NOT_LOCKED)
+				throw Error::Win32Error(__FUNCSIG__ ": VirtualUnlock() failed", lastError);
+		}
+	}
+
+	void MemoryMappedFile::Create(
+		const DWORD protection,
+		const DWORD viewAccess,
+		const bool inheritable,
+		void* baseAddress
+	)
+	{
+		// https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-createfilemappingw
+		m_mapFile = CreateFileMappingW(
+			INVALID_HANDLE_VALUE,
+			nullptr,
+			protection,
+			0,
+			m_maxSize,
+			m_name.empty() ? nullptr : m_name.c_str()
+		);
+		if (m_mapFile == nullptr)
+			throw Error::Win32Error(__FUNCSIG__ ": CreateFileMappingW() failed", GetLastError());
+
+		m_mapFile.SetInheritability(inheritable);
+		// https://docs.microsoft.com/en-us/windows/win32/api/memoryapi/nf-memoryapi-mapviewoffileex
+		m_view = MapViewOfFileEx(m_mapFile.GetHandle(), viewAccess, 0, 0, m_maxSize, baseAddress);
+		if (m_view == nullptr)
+		{
+			const DWORD lastError = GetLastError();
+			Close();
+			throw Error::Win32Error(__FUNCSIG__ ": MapViewOfFileEx() failed", lastError);
+		}
+	}
+
+	void MemoryMappedFile::CreateLargePages(const bool inheritable, void* baseAddress)
+	{
+		// https://docs.microsoft.com/en-us/windows/win32/memory/large-page-support
+		const SIZE_T largePageSize = GetLargePageMinimum();
+		if (largePageSize == 0)
+			throw std::runtime_error(__FUNCSIG__ ": large pages are not supported");
+		const UINT64 roundedSize = (static_cast<UINT64>(m_maxSize) + largePageSize - 1) / largePageSize * largePageSize;
+		if (roundedSize > MAXUINT)
+			throw std::invalid_argument(__FUNCSIG__ ": maxSize is too large to round up to large pages");
+
+		Raii::Win32Handle token = Security::GetProcessToken(
+			GetCurrentProcess(),
+			TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY
+		);
+		Security::AdjustPrivileges(token.GetHandle(), SE_LOCK_MEMORY_NAME, true);
+
+		m_maxSize = static_cast<UINT>(roundedSize);
+		Create(
+			PAGE_READWRITE | SEC_COMMIT | SEC_LARGE_PAGES,
+			FILE_MAP_ALL_ACCESS | FILE_MAP_LARGE_PAGES,
+			inheritable,
+			baseAddress
+		);
+		m_largePages = true;
+	}
+
+	void MemoryMappedFile::CheckRange(const UINT offset, const UINT length) const
+	{
+		if (m_view == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": view is not mapped");
+		if (offset > m_maxSize || length > m_maxSize - offset)
+			throw std::out_of_range(__FUNCSIG__ ": range is beyond the end of the view");
+	}
 }
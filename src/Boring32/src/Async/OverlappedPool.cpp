@@ -0,0 +1,192 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include "include/Async/CriticalSectionLock.hpp"
+#include "include/Async/OverlappedPool.hpp"
+
+namespace Boring32::Async
+{
+	OverlappedLease::~OverlappedLease()
+	{
+		Release();
+	}
+
+	OverlappedLease::OverlappedLease()
+	:	m_pool(nullptr),
+		m_slot(nullptr),
+		m_lastError(0)
+	{ }
+
+	OverlappedLease::OverlappedLease(OverlappedPool* pool, Slot* slot)
+	:	m_pool(pool),
+		m_slot(slot),
+		m_lastError(0)
+	{ }
+
+	OverlappedLease::OverlappedLease(OverlappedLease&& other) noexcept
+	:	OverlappedLease()
+	{
+		Move(other);
+	}
+
+	OverlappedLease& OverlappedLease::operator=(OverlappedLease&& other) noexcept
+	{
+		Move(other);
+		return *this;
+	}
+
+	void OverlappedLease::Move(OverlappedLease& other) noexcept
+	{
+		if (this == &other)
+			return;
+		Release();
+		m_pool = other.m_pool;
+		m_slot = other.m_slot;
+		m_lastError = other.m_lastError;
+		other.m_pool = nullptr;
+		other.m_slot = nullptr;
+	}
+
+	void OverlappedLease::Reset()
+	{
+		Slot& slot = GetSlot();
+		slot.Overlapped = OVERLAPPED{ 0 };
+		slot.Overlapped.hEvent = slot.IoEvent.GetHandle();
+		slot.IoEvent.Reset();
+		m_lastError = 0;
+	}
+
+	bool OverlappedLease::WaitForCompletion(const DWORD timeout)
+	{
+		return GetSlot().IoEvent.WaitOnEvent(timeout, true);
+	}
+
+	void OverlappedLease::SetEvent(const bool signaled)
+	{
+		if (signaled)
+			GetSlot().IoEvent.Signal();
+		else
+			GetSlot().IoEvent.Reset();
+	}
+
+	OVERLAPPED* OverlappedLease::GetOverlapped()
+	{
+		return &GetSlot().Overlapped;
+	}
+
+	HANDLE OverlappedLease::GetWaitableHandle() const
+	{
+		return GetSlot().IoEvent.GetHandle();
+	}
+
+	uint64_t OverlappedLease::GetBytesTransferred() const
+	{
+		return GetSlot().Overlapped.InternalHigh;
+	}
+
+	bool OverlappedLease::IsComplete() const
+	{
+		return GetSlot().Overlapped.Internal != STATUS_PENDING;
+	}
+
+	bool OverlappedLease::IsSuccessful() const
+	{
+		return GetSlot().Overlapped.Internal == NOERROR;
+	}
+
+	bool OverlappedLease::IsPartial() const
+	{
+		// STATUS_BUFFER_OVERFLOW; see OverlappedOp::IsSuccessful()
+		return GetSlot().Overlapped.Internal == 0x80000005L;
+	}
+
+	DWORD OverlappedLease::LastError() const noexcept
+	{
+		return m_lastError;
+	}
+
+	void OverlappedLease::LastError(const DWORD lastError) noexcept
+	{
+		m_lastError = lastError;
+	}
+
+	bool OverlappedLease::IsValid() const noexcept
+	{
+		return m_slot != nullptr;
+	}
+
+	void OverlappedLease::Release() noexcept
+	{
+		if (m_slot == nullptr)
+			return;
+		m_pool->Release(m_slot);
+		m_pool = nullptr;
+		m_slot = nullptr;
+	}
+
+	OverlappedLease::Slot& OverlappedLease::GetSlot() const
+	{
+		if (m_slot == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": the lease is empty");
+		return *m_slot;
+	}
+
+	OverlappedPool::~OverlappedPool()
+	{
+		DeleteCriticalSection(&m_cs);
+	}
+
+	OverlappedPool::OverlappedPool()
+	:	OverlappedPool(0)
+	{ }
+
+	OverlappedPool::OverlappedPool(const size_t initialCount)
+	{
+		// https://docs.microsoft.com/en-us/windows/win32/api/interlockedapi/nf-interlockedapi-initializeslisthead
+		InitializeSListHead(&m_free);
+		InitializeCriticalSection(&m_cs);
+		m_slots.reserve(initialCount);
+		for (size_t i = 0; i < initialCount; i++)
+			Release(Allocate());
+	}
+
+	OverlappedLease OverlappedPool::Acquire()
+	{
+		// https://docs.microsoft.com/en-us/windows/win32/api/interlockedapi/nf-interlockedapi-interlockedpopentryslist
+		auto slot = reinterpret_cast<OverlappedLease::Slot*>(InterlockedPopEntrySList(&m_free));
+		if (slot == nullptr)
+			slot = Allocate();
+		OverlappedLease lease(this, slot);
+		lease.Reset();
+		return lease;
+	}
+
+	size_t OverlappedPool::GetAllocatedCount()
+	{
+		CriticalSectionLock cs(m_cs);
+		return m_slots.size();
+	}
+
+	size_t OverlappedPool::GetAvailableCount() noexcept
+	{
+		return QueryDepthSList(&m_free);
+	}
+
+	OverlappedLease::Slot* OverlappedPool::Allocate()
+	{
+		auto slot = std::make_unique<OverlappedLease::Slot>(
+			SLIST_ENTRY{ 0 },
+			OVERLAPPED{ 0 },
+			Event(false, true, false)
+		);
+		slot->Overlapped.hEvent = slot->IoEvent.GetHandle();
+		CriticalSectionLock cs(m_cs);
+		m_slots.push_back(std::move(slot));
+		return m_slots.back().get();
+	}
+
+	void OverlappedPool::Release(OverlappedLease::Slot* slot) noexcept
+	{
+		// https://docs.microsoft.com/en-us/windows/win32/api/interlockedapi/nf-interlockedapi-interlockedpushentryslist
+		InterlockedPushEntrySList(&m_free, &slot->Entry);
+	}
+}
@@ -63,7 +63,7 @@ namespace Boring32::Async
 		bool successfulWrite = WriteFile(
 			m_handle.GetHandle(),   // pipe handle 
 			msg.c_str(),        // message 
-			(DWORD)msg.size(),         // message length 
+			(DWORD)(msg.size() * sizeof(wchar_t)), // message length, in bytes
 			&bytesWritten,      // bytes written 
 			nullptr);           // not overlapped 
 
@@ -106,8 +106,8 @@ namespace Boring32::Async
 			// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-readfile
 			bool successfulRead = ReadFile(
 				m_handle.GetHandle(),    // pipe handle 
-				&dataBuffer[0],    // buffer to receive reply 
-				(DWORD)(dataBuffer.size() * sizeof(TCHAR)),  // size of buffer 
+				(std::byte*)dataBuffer.data() + totalBytesRead,    // buffer to receive reply 
+				(DWORD)(dataBuffer.size() * sizeof(wchar_t) - totalBytesRead),  // space left in buffer 
 				&currentBytesRead,  // number of bytes read 
 				nullptr);    // not overlapped
 			totalBytesRead += currentBytesRead;
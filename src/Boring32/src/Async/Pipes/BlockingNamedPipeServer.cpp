@@ -86,7 +86,8 @@ namespace Boring32::Async
         if (m_pipe == nullptr)
             throw std::runtime_error("No valid pipe handle to connect");
 
-        if (ConnectNamedPipe(m_pipe.GetHandle(), nullptr) == false)
+        // ERROR_PIPE_CONNECTED means the client connected before this call
+        if (ConnectNamedPipe(m_pipe.GetHandle(), nullptr) == false && GetLastError() != ERROR_PIPE_CONNECTED)
             throw std::runtime_error("Failed to connect named pipe");
     }
 
@@ -160,8 +161,8 @@ namespace Boring32::Async
             // https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-readfile
             bool successfulRead = ReadFile(
                 m_pipe.GetHandle(),    // pipe handle 
-                &dataBuffer[0],    // buffer to receive reply 
-                (DWORD)(dataBuffer.size() * sizeof(TCHAR)),  // size of buffer 
+                (std::byte*)dataBuffer.data() + totalBytesRead,    // buffer to receive reply 
+                (DWORD)(dataBuffer.size() * sizeof(wchar_t) - totalBytesRead),  // space left in buffer 
                 &currentBytesRead,  // number of bytes read 
                 nullptr);    // not overlapped
             totalBytesRead += currentBytesRead;
@@ -0,0 +1,225 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <cstring>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/Pipes/DelimitedStreamReader.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		constexpr size_t NotFound = (size_t)-1;
+
+		std::wstring RequireDelimiter(AnonymousPipe& pipe)
+		{
+			std::wstring delimiter = pipe.GetDelimiter();
+			if (delimiter.empty())
+				throw std::invalid_argument(__FUNCSIG__ ": the pipe has no delimiter");
+			return delimiter;
+		}
+
+		DelimitedStreamReaderSettings ForAnonymousPipe(DelimitedStreamReaderSettings settings)
+		{
+			// DelimitedWrite() surrounds each message with the delimiter, so
+			// adjacent messages are separated by an empty one
+			settings.Alignment = sizeof(wchar_t);
+			settings.SkipEmpty = true;
+			return settings;
+		}
+	}
+
+	DelimitedStreamReader::~DelimitedStreamReader() { }
+
+	DelimitedStreamReader::DelimitedStreamReader(const HANDLE readHandle, const std::span<const std::byte> delimiter)
+	:	DelimitedStreamReader(readHandle, delimiter, DelimitedStreamReaderSettings{})
+	{ }
+
+	DelimitedStreamReader::DelimitedStreamReader(
+		const HANDLE readHandle,
+		const std::span<const std::byte> delimiter,
+		const DelimitedStreamReaderSettings& settings
+	)
+	:	m_readHandle(readHandle),
+		m_isPipe(false),
+		m_delimiter(delimiter.begin(), delimiter.end()),
+		m_settings(settings),
+		m_start(0),
+		m_end(0),
+		m_scanned(0),
+		m_ended(false),
+		m_bytesRead(0),
+		m_messagesRead(0)
+	{
+		if (m_readHandle == nullptr || m_readHandle == INVALID_HANDLE_VALUE)
+			throw std::invalid_argument(__FUNCSIG__ ": the handle is not valid");
+		if (m_delimiter.empty())
+			throw std::invalid_argument(__FUNCSIG__ ": the delimiter is empty");
+		if (m_settings.Alignment == 0)
+			throw std::invalid_argument(__FUNCSIG__ ": Alignment must be at least 1");
+		if (m_settings.BufferSize <= m_delimiter.size())
+			throw std::invalid_argument(__FUNCSIG__ ": BufferSize must be larger than the delimiter");
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-getfiletype
+		m_isPipe = GetFileType(m_readHandle) == FILE_TYPE_PIPE;
+		m_buffer.resize(m_settings.BufferSize);
+	}
+
+	DelimitedStreamReader::DelimitedStreamReader(AnonymousPipe& pipe)
+	:	DelimitedStreamReader(pipe, DelimitedStreamReaderSettings{})
+	{ }
+
+	DelimitedStreamReader::DelimitedStreamReader(AnonymousPipe& pipe, const DelimitedStreamReaderSettings& settings)
+	:	DelimitedStreamReader(
+			pipe.GetRead(),
+			std::as_bytes(std::span<const wchar_t>(RequireDelimiter(pipe))),
+			ForAnonymousPipe(settings)
+		)
+	{ }
+
+	bool DelimitedStreamReader::Next(std::span<const std::byte>& message)
+	{
+		while (true)
+		{
+			if (TryTakeMessage(message))
+			{
+				m_messagesRead++;
+				return true;
+			}
+			if (m_ended)
+			{
+				if (m_start == m_end)
+					return false;
+				// The stream ended without a final delimiter
+				message = std::span<const std::byte>(m_buffer.data() + m_start, m_end - m_start);
+				m_start = m_end;
+				m_messagesRead++;
+				return true;
+			}
+			ReadMore();
+		}
+	}
+
+	bool DelimitedStreamReader::Next(std::wstring_view& message)
+	{
+		std::span<const std::byte> bytes;
+		if (Next(bytes) == false)
+			return false;
+		if (bytes.size() % sizeof(wchar_t) != 0)
+			throw std::runtime_error(__FUNCSIG__ ": the message is not a whole number of characters");
+		message = std::wstring_view(
+			reinterpret_cast<const wchar_t*>(bytes.data()),
+			bytes.size() / sizeof(wchar_t)
+		);
+		return true;
+	}
+
+	UINT64 DelimitedStreamReader::GetBytesRead() const noexcept
+	{
+		return m_bytesRead;
+	}
+
+	UINT64 DelimitedStreamReader::GetMessagesRead() const noexcept
+	{
+		return m_messagesRead;
+	}
+
+	const DelimitedStreamReaderSettings& DelimitedStreamReader::GetSettings() const noexcept
+	{
+		return m_settings;
+	}
+
+	bool DelimitedStreamReader::TryTakeMessage(std::span<const std::byte>& message)
+	{
+		while (true)
+		{
+			const size_t found = FindDelimiter((std::max)(m_scanned, m_start));
+			if (found == NotFound)
+			{
+				// Only the tail that could hold the start of a delimiter
+				// needs searching again once more data arrives
+				const size_t overlap = m_delimiter.size() - 1;
+				m_scanned = (std::max)(m_start, m_end > overlap ? m_end - overlap : 0);
+				return false;
+			}
+
+			const size_t start = m_start;
+			m_start = found + m_delimiter.size();
+			m_scanned = m_start;
+			if (found == start && m_settings.SkipEmpty)
+				continue;
+			message = std::span<const std::byte>(m_buffer.data() + start, found - start);
+			return true;
+		}
+	}
+
+	size_t DelimitedStreamReader::FindDelimiter(const size_t from) const noexcept
+	{
+		const std::byte* data = m_buffer.data();
+		const size_t delimiterSize = m_delimiter.size();
+		size_t position = from;
+		while (position + delimiterSize <= m_end)
+		{
+			// memchr() is vectorised by the CRT, so candidates for the first
+			// byte are found many bytes at a time
+			const void* candidate = memchr(
+				data + position,
+				(int)m_delimiter[0],
+				m_end - position - delimiterSize + 1
+			);
+			if (candidate == nullptr)
+				return NotFound;
+			position = static_cast<const std::byte*>(candidate) - data;
+			if ((position - m_start) % m_settings.Alignment == 0
+				&& memcmp(data + position, m_delimiter.data(), delimiterSize) == 0)
+			{
+				return position;
+			}
+			position++;
+		}
+		return NotFound;
+	}
+
+	void DelimitedStreamReader::ReadMore()
+	{
+		// Move the partial message to the front, so the rest of it can be
+		// read in behind it
+		if (m_start > 0)
+		{
+			memmove(m_buffer.data(), m_buffer.data() + m_start, m_end - m_start);
+			m_end -= m_start;
+			m_scanned -= m_start;
+			m_start = 0;
+		}
+		if (m_end == m_buffer.size())
+		{
+			const size_t limit = (size_t)m_settings.MaxMessageSize + m_delimiter.size();
+			if (m_buffer.size() >= limit)
+				throw std::runtime_error(__FUNCSIG__ ": message exceeds MaxMessageSize");
+			m_buffer.resize((std::min)(m_buffer.size() * 2, limit));
+		}
+
+		DWORD bytesRead = 0;
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-readfile
+		const bool succeeded = ReadFile(
+			m_readHandle,
+			m_buffer.data() + m_end,
+			(DWORD)(std::min)(m_buffer.size() - m_end, (size_t)MAXDWORD),
+			&bytesRead,
+			nullptr
+		);
+		if (succeeded == false)
+		{
+			const DWORD lastError = GetLastError();
+			// The writer closed its end, which is the end of the stream
+			if (lastError != ERROR_BROKEN_PIPE && lastError != ERROR_HANDLE_EOF)
+				throw Error::Win32Error(__FUNCSIG__ ": ReadFile() failed", lastError);
+			m_ended = true;
+			return;
+		}
+		// A pipe only ends when the writer closes its end, which fails the
+		// read; a file ends when a read succeeds with nothing
+		if (bytesRead == 0 && m_isPipe == false)
+			m_ended = true;
+		m_end += bytesRead;
+		m_bytesRead += bytesRead;
+	}
+}
@@ -0,0 +1,100 @@
+#include "pch.hpp"
+#include "include/Async/Pipes/HybridPipeTransport.hpp"
+#include "include/Async/Pipes/HybridPipeMessage.hpp"
+
+namespace Boring32::Async
+{
+	HybridPipeMessage::~HybridPipeMessage()
+	{
+		Release();
+	}
+
+	HybridPipeMessage::HybridPipeMessage()
+	:	m_transport(nullptr),
+		m_firstSlab(0),
+		m_slabCount(0),
+		m_isValid(false)
+	{ }
+
+	HybridPipeMessage::HybridPipeMessage(PipeFrame frame, const std::span<const std::byte> data)
+	:	m_frame(std::move(frame)),
+		m_transport(nullptr),
+		m_firstSlab(0),
+		m_slabCount(0),
+		m_data(data),
+		m_isValid(true)
+	{ }
+
+	HybridPipeMessage::HybridPipeMessage(
+		HybridPipeTransport& transport,
+		const UINT32 firstSlab,
+		const UINT32 slabCount,
+		const std::span<const std::byte> data
+	)
+	:	m_transport(&transport),
+		m_firstSlab(firstSlab),
+		m_slabCount(slabCount),
+		m_data(data),
+		m_isValid(true)
+	{ }
+
+	HybridPipeMessage::HybridPipeMessage(HybridPipeMessage&& other) noexcept
+	:	HybridPipeMessage()
+	{
+		Move(other);
+	}
+
+	HybridPipeMessage& HybridPipeMessage::operator=(HybridPipeMessage&& other) noexcept
+	{
+		Move(other);
+		return *this;
+	}
+
+	void HybridPipeMessage::Move(HybridPipeMessage& other) noexcept
+	{
+		if (this == &other)
+			return;
+		Release();
+		m_frame = std::move(other.m_frame);
+		m_transport = other.m_transport;
+		m_firstSlab = other.m_firstSlab;
+		m_slabCount = other.m_slabCount;
+		m_data = other.m_data;
+		m_isValid = other.m_isValid;
+		other.m_transport = nullptr;
+		other.m_data = {};
+		other.m_isValid = false;
+	}
+
+	std::span<const std::byte> HybridPipeMessage::GetData() const noexcept
+	{
+		return m_data;
+	}
+
+	size_t HybridPipeMessage::GetSize() const noexcept
+	{
+		return m_data.size();
+	}
+
+	bool HybridPipeMessage::IsValid() const noexcept
+	{
+		return m_isValid;
+	}
+
+	bool HybridPipeMessage::IsShared() const noexcept
+	{
+		return m_transport != nullptr;
+	}
+
+	void HybridPipeMessage::Release() noexcept
+	{
+		if (m_transport != nullptr)
+		{
+			m_transport->ReturnSlabs(m_firstSlab, m_slabCount, std::nothrow);
+			m_transport = nullptr;
+		}
+		m_frame.Release();
+		m_data = {};
+		m_isValid = false;
+	}
+}
@@ -0,0 +1,386 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <cstring>
+#include "include/Async/CriticalSectionLock.hpp"
+#include "include/Async/Pipes/HybridPipeTransport.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		constexpr UINT64 NoDeadline = MAXUINT64;
+		// How long a sender waiting for slabs sleeps before checking again
+		constexpr DWORD SlabWaitMillis = 50;
+
+		UINT64 ToDeadline(const DWORD timeoutMillis)
+		{
+			return timeoutMillis == INFINITE
+				? NoDeadline
+				: GetTickCount64() + timeoutMillis;
+		}
+
+		DWORD RemainingMillis(const UINT64 deadline)
+		{
+			if (deadline == NoDeadline)
+				return INFINITE;
+			const UINT64 now = GetTickCount64();
+			return deadline > now ? (DWORD)(deadline - now) : 0;
+		}
+	}
+
+	HybridPipeTransport::~HybridPipeTransport()
+	{
+		DeleteCriticalSection(&m_sendCs);
+		DeleteCriticalSection(&m_receiveCs);
+		DeleteCriticalSection(&m_slabCs);
+	}
+
+	HybridPipeTransport::HybridPipeTransport(NamedPipeServerBase& server, const std::wstring& sharedMemoryName)
+	:	HybridPipeTransport(server, sharedMemoryName, HybridPipeTransportSettings{})
+	{ }
+
+	HybridPipeTransport::HybridPipeTransport(
+		NamedPipeServerBase& server,
+		const std::wstring& sharedMemoryName,
+		const HybridPipeTransportSettings& settings
+	)
+	:	m_settings(settings),
+		m_channel(server, ToChannelSettings(settings)),
+		m_slabCount(0),
+		m_freeSlabs(0),
+		m_nextSlab(0),
+		m_slabsFreed(false, false, false)
+	{
+		Create(sharedMemoryName, true);
+	}
+
+	HybridPipeTransport::HybridPipeTransport(NamedPipeClientBase& client, const std::wstring& sharedMemoryName)
+	:	HybridPipeTransport(client, sharedMemoryName, HybridPipeTransportSettings{})
+	{ }
+
+	HybridPipeTransport::HybridPipeTransport(
+		NamedPipeClientBase& client,
+		const std::wstring& sharedMemoryName,
+		const HybridPipeTransportSettings& settings
+	)
+	:	m_settings(settings),
+		m_channel(client, ToChannelSettings(settings)),
+		m_slabCount(0),
+		m_freeSlabs(0),
+		m_nextSlab(0),
+		m_slabsFreed(false, false, false)
+	{
+		Create(sharedMemoryName, false);
+	}
+
+	PipeFrameChannelSettings HybridPipeTransport::ToChannelSettings(const HybridPipeTransportSettings& settings)
+	{
+		// An inline frame must fit within one receive buffer, with room to
+		// read the frames behind it
+		const DWORD frameSize = settings.InlineThreshold + sizeof(FrameHeader) + PipeFrameChannel::HeaderSize;
+		return PipeFrameChannelSettings{
+			.BufferSize = (std::max)((DWORD)64 * 1024, frameSize * 2),
+			.MaxBuffers = 16
+		};
+	}
+
+	void HybridPipeTransport::Create(const std::wstring& sharedMemoryName, const bool isServer)
+	{
+		if (sharedMemoryName.empty())
+			throw std::invalid_argument(__FUNCSIG__ ": sharedMemoryName must be specified");
+		if (m_settings.SlabSize == 0 || m_settings.SharedMemorySize < m_settings.SlabSize)
+			throw std::invalid_argument(__FUNCSIG__ ": SharedMemorySize must hold at least one slab");
+
+		InitializeCriticalSection(&m_sendCs);
+		InitializeCriticalSection(&m_receiveCs);
+		InitializeCriticalSection(&m_slabCs);
+		try
+		{
+			// The server creates both regions; each end writes to its
+			// outbound region and only reads its inbound one
+			const std::wstring serverToClient = sharedMemoryName + L".ServerToClient";
+			const std::wstring clientToServer = sharedMemoryName + L".ClientToServer";
+			if (isServer)
+			{
+				m_outbound = MemoryMappedFile(serverToClient, m_settings.SharedMemorySize, false);
+				m_inbound = MemoryMappedFile(clientToServer, m_settings.SharedMemorySize, false);
+			}
+			else
+			{
+				m_outbound = MemoryMappedFile(clientToServer, m_settings.SharedMemorySize, false, FILE_MAP_ALL_ACCESS);
+				m_inbound = MemoryMappedFile(serverToClient, m_settings.SharedMemorySize, false, FILE_MAP_READ);
+			}
+		}
+		catch (...)
+		{
+			DeleteCriticalSection(&m_sendCs);
+			DeleteCriticalSection(&m_receiveCs);
+			DeleteCriticalSection(&m_slabCs);
+			throw;
+		}
+
+		m_slabCount = m_settings.SharedMemorySize / m_settings.SlabSize;
+		m_slabInUse.resize(m_slabCount, false);
+		m_freeSlabs = m_slabCount;
+	}
+
+	void HybridPipeTransport::Send(const std::span<const std::byte> data)
+	{
+		if (data.size() <= m_settings.InlineThreshold)
+		{
+			SendFrame(FrameHeader{ .Type = FrameType::Inline, .Length = data.size() }, data);
+			return;
+		}
+
+		const UINT64 slabsNeeded = (data.size() + m_settings.SlabSize - 1) / m_settings.SlabSize;
+		if (slabsNeeded > m_slabCount)
+			throw std::invalid_argument(__FUNCSIG__ ": the payload is larger than the shared memory");
+		const UINT32 count = (UINT32)slabsNeeded;
+		const UINT32 firstSlab = AcquireSlabs(count);
+		try
+		{
+			std::byte* destination =
+				static_cast<std::byte*>(m_outbound.GetViewPointer())
+				+ (size_t)firstSlab * m_settings.SlabSize;
+			memcpy(destination, data.data(), data.size());
+			SendFrame(
+				FrameHeader{
+					.Type = FrameType::Shared,
+					.FirstSlab = firstSlab,
+					.SlabCount = count,
+					.Length = data.size()
+				},
+				{}
+			);
+		}
+		catch (...)
+		{
+			FreeSlabs(firstSlab, count);
+			throw;
+		}
+	}
+
+	bool HybridPipeTransport::Send(const std::span<const std::byte> data, std::nothrow_t) noexcept
+	{
+		try
+		{
+			Send(data);
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Send() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	HybridPipeMessage HybridPipeTransport::Receive(const DWORD timeoutMillis)
+	{
+		CriticalSectionLock cs(m_receiveCs);
+		const UINT64 deadline = ToDeadline(timeoutMillis);
+		while (m_pending.empty())
+		{
+			if (ReceiveFrame(RemainingMillis(deadline)) == false)
+				return HybridPipeMessage();
+			// Only slabs were returned, and there's no time left to wait
+			if (m_pending.empty() && RemainingMillis(deadline) == 0)
+				return HybridPipeMessage();
+		}
+
+		PipeFrame frame = std::move(m_pending.front());
+		m_pending.pop_front();
+		return ToMessage(std::move(frame));
+	}
+
+	bool HybridPipeTransport::IsConnected() const noexcept
+	{
+		return m_channel.IsConnected();
+	}
+
+	const HybridPipeTransportSettings& HybridPipeTransport::GetSettings() const noexcept
+	{
+		return m_settings;
+	}
+
+	UINT32 HybridPipeTransport::GetSlabCount() const noexcept
+	{
+		return m_slabCount;
+	}
+
+	UINT32 HybridPipeTransport::GetFreeSlabCount()
+	{
+		CriticalSectionLock cs(m_slabCs);
+		return m_freeSlabs;
+	}
+
+	UINT32 HybridPipeTransport::AcquireSlabs(const UINT32 count)
+	{
+		UINT32 firstSlab = 0;
+		while (TryAcquireSlabs(count, firstSlab) == false)
+		{
+			if (m_channel.IsConnected() == false)
+				throw std::runtime_error(__FUNCSIG__ ": the pipe was closed");
+
+			// Slabs are returned over the pipe. If no Receive() is reading
+			// it, read it here, holding any messages for Receive().
+			if (TryEnterCriticalSection(&m_receiveCs))
+			{
+				try
+				{
+					ReceiveFrame(SlabWaitMillis);
+				}
+				catch (...)
+				{
+					LeaveCriticalSection(&m_receiveCs);
+					throw;
+				}
+				LeaveCriticalSection(&m_receiveCs);
+			}
+			else
+			{
+				m_slabsFreed.WaitOnEvent(SlabWaitMillis, false);
+			}
+		}
+		return firstSlab;
+	}
+
+	bool HybridPipeTransport::TryAcquireSlabs(const UINT32 count, UINT32& firstSlab)
+	{
+		CriticalSectionLock cs(m_slabCs);
+		if (m_freeSlabs < count)
+			return false;
+
+		auto findRun = [this, count](const UINT32 from, UINT32& found)
+		{
+			UINT32 run = 0;
+			for (UINT32 i = from; i < m_slabCount; i++)
+			{
+				run = m_slabInUse[i] ? 0 : run + 1;
+				if (run == count)
+				{
+					found = i + 1 - count;
+					return true;
+				}
+			}
+			return false;
+		};
+		// Continuing from the last allocation uses the region as a ring,
+		// which suits a stream of messages released in order
+		if (findRun(m_nextSlab, firstSlab) == false && findRun(0, firstSlab) == false)
+			return false;
+
+		for (UINT32 i = firstSlab; i < firstSlab + count; i++)
+			m_slabInUse[i] = true;
+		m_freeSlabs -= count;
+		m_nextSlab = (firstSlab + count) % m_slabCount;
+		return true;
+	}
+
+	void HybridPipeTransport::FreeSlabs(const UINT32 firstSlab, const UINT32 count)
+	{
+		{
+			CriticalSectionLock cs(m_slabCs);
+			if (firstSlab >= m_slabCount || count > m_slabCount - firstSlab)
+				throw std::runtime_error(__FUNCSIG__ ": slab range is out of bounds");
+			for (UINT32 i = firstSlab; i < firstSlab + count; i++)
+			{
+				if (m_slabInUse[i] == false)
+					continue;
+				m_slabInUse[i] = false;
+				m_freeSlabs++;
+			}
+		}
+		m_slabsFreed.Signal();
+	}
+
+	bool HybridPipeTransport::ReturnSlabs(const UINT32 firstSlab, const UINT32 count, std::nothrow_t) noexcept
+	{
+		// The sender has gone, so there is nothing to return the slabs to
+		if (m_channel.IsConnected() == false)
+			return false;
+
+		try
+		{
+			SendFrame(
+				FrameHeader{
+					.Type = FrameType::Release,
+					.FirstSlab = firstSlab,
+					.SlabCount = count
+				},
+				{}
+			);
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": SendFrame() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	void HybridPipeTransport::SendFrame(const FrameHeader& header, const std::span<const std::byte> payload)
+	{
+		CriticalSectionLock cs(m_sendCs);
+		m_sendBuffer.resize(sizeof(header) + payload.size());
+		memcpy(m_sendBuffer.data(), &header, sizeof(header));
+		if (payload.empty() == false)
+			memcpy(m_sendBuffer.data() + sizeof(header), payload.data(), payload.size());
+		m_channel.Send(m_sendBuffer);
+	}
+
+	bool HybridPipeTransport::ReceiveFrame(const DWORD timeoutMillis)
+	{
+		PipeFrame frame = m_channel.Receive(timeoutMillis);
+		if (frame.IsValid() == false)
+			return false;
+		if (frame.GetSize() < sizeof(FrameHeader))
+			throw std::runtime_error(__FUNCSIG__ ": received a malformed frame");
+
+		FrameHeader header;
+		memcpy(&header, frame.GetData().data(), sizeof(header));
+		if (header.Type == FrameType::Release)
+		{
+			FreeSlabs(header.FirstSlab, header.SlabCount);
+			return true;
+		}
+		m_pending.push_back(std::move(frame));
+		return true;
+	}
+
+	HybridPipeMessage HybridPipeTransport::ToMessage(PipeFrame frame)
+	{
+		FrameHeader header;
+		memcpy(&header, frame.GetData().data(), sizeof(header));
+		if (header.Type == FrameType::Inline)
+		{
+			const std::span<const std::byte> payload = frame.GetData().subspan(sizeof(header));
+			return HybridPipeMessage(std::move(frame), payload);
+		}
+
+		const bool isValid =
+			header.Type == FrameType::Shared
+			&& header.FirstSlab < m_slabCount
+			&& header.SlabCount <= m_slabCount - header.FirstSlab
+			&& header.Length <= (UINT64)header.SlabCount * m_settings.SlabSize;
+		if (isValid == false)
+			throw std::runtime_error(__FUNCSIG__ ": received a malformed frame");
+
+		const std::byte* data =
+			static_cast<const std::byte*>(m_inbound.GetViewPointer())
+			+ (size_t)header.FirstSlab * m_settings.SlabSize;
+		return HybridPipeMessage(
+			*this,
+			header.FirstSlab,
+			header.SlabCount,
+			std::span<const std::byte>(data, (size_t)header.Length)
+		);
+	}
+}
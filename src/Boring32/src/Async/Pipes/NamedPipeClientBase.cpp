@@ -36,6 +36,7 @@ namespace Boring32::Async
 		m_handle = other.m_handle;
 		m_pipeName = other.m_pipeName;
 		m_fileAttributes = other.m_fileAttributes;
+		m_vectoredIoTraits = other.m_vectoredIoTraits;
 	}
 
 	NamedPipeClientBase::NamedPipeClientBase(NamedPipeClientBase&& other) noexcept
@@ -54,6 +55,8 @@ namespace Boring32::Async
 		m_handle = std::move(other.m_handle);
 		m_pipeName = std::move(other.m_pipeName);
 		m_fileAttributes = other.m_fileAttributes;
+		m_vectoredIoTraits = std::move(other.m_vectoredIoTraits);
+		other.m_vectoredIoTraits.reset();
 	}
 
 	void NamedPipeClientBase::Connect(const DWORD timeout)
@@ -77,6 +80,8 @@ namespace Boring32::Async
 			if (WaitNamedPipeW(m_pipeName.c_str(), timeout) == false)
 				throw Error::Win32Error("Failed to connect client pipe: timeout", GetLastError());
 		}
+		if (m_handle.IsValidValue())
+			m_vectoredIoTraits = GetVectoredIoTraits(m_handle.GetHandle());
 	}
 
 	bool NamedPipeClientBase::Connect(const DWORD timeout, std::nothrow_t)
@@ -107,11 +112,14 @@ namespace Boring32::Async
 			nullptr);    // don't set maximum time 
 		if (fSuccess == false)
 			throw Error::Win32Error("Failed to SetNamedPipeHandleState", GetLastError());
+		// The read mode is one of the traits
+		m_vectoredIoTraits = GetVectoredIoTraits(m_handle.GetHandle());
 	}
 
 	void NamedPipeClientBase::Close()
 	{
 		m_handle.Close();
+		m_vectoredIoTraits.reset();
 	}
 
 	DWORD NamedPipeClientBase::UnreadCharactersRemaining() const
@@ -141,6 +149,29 @@ namespace Boring32::Async
 			throw Error::Win32Error("NamedPipeClientBase::Flush() failed", GetLastError());
 	}
 
+	Raii::Win32Handle& NamedPipeClientBase::GetInternalHandle()
+	{
+		return m_handle;
+	}
+
+	UINT64 NamedPipeClientBase::WriteGather(const std::span<const std::span<const std::byte>> pieces)
+	{
+		if (m_handle == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": pipe is nullptr");
+		return m_vectoredIoTraits
+			? Async::WriteGather(m_handle.GetHandle(), *m_vectoredIoTraits, pieces)
+			: Async::WriteGather(m_handle.GetHandle(), pieces);
+	}
+
+	ScatterReadResult NamedPipeClientBase::ReadScatter(const std::span<const std::span<std::byte>> pieces)
+	{
+		if (m_handle == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": pipe is nullptr");
+		return m_vectoredIoTraits
+			? Async::ReadScatter(m_handle.GetHandle(), *m_vectoredIoTraits, pieces)
+			: Async::ReadScatter(m_handle.GetHandle(), pieces);
+	}
+
 	void NamedPipeClientBase::CancelCurrentThreadIo()
 	{
 		if (m_handle == nullptr)
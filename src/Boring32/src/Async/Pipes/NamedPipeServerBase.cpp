@@ -14,6 +14,7 @@ namespace Boring32::Async
     {
         Disconnect();
         m_pipe.Close();
+        m_vectoredIoTraits.reset();
     }
 
     NamedPipeServerBase::NamedPipeServerBase()
@@ -106,6 +107,7 @@ namespace Boring32::Async
             LocalFree(sa.lpSecurityDescriptor);
         if (m_pipe == nullptr)
             throw Error::Win32Error("Failed to create named pipe", GetLastError());
+        m_vectoredIoTraits = GetVectoredIoTraits(m_pipe.GetHandle());
     }
 
     NamedPipeServerBase::NamedPipeServerBase(const NamedPipeServerBase& other)
@@ -129,6 +131,7 @@ namespace Boring32::Async
         m_sid = other.m_sid;
         m_openMode = other.m_openMode;
         m_pipeMode = other.m_pipeMode;
+        m_vectoredIoTraits = other.m_vectoredIoTraits;
     }
 
     NamedPipeServerBase::NamedPipeServerBase(NamedPipeServerBase&& other) noexcept
@@ -152,7 +155,11 @@ namespace Boring32::Async
         m_openMode = other.m_openMode;
         m_pipeMode = other.m_pipeMode;
         if (other.m_pipe != nullptr)
+        {
             m_pipe = std::move(other.m_pipe);
+            m_vectoredIoTraits = std::move(other.m_vectoredIoTraits);
+            other.m_vectoredIoTraits.reset();
+        }
     }
 
     void NamedPipeServerBase::Disconnect()
@@ -166,6 +173,24 @@ namespace Boring32::Async
         return m_pipe;
     }
 
+    UINT64 NamedPipeServerBase::WriteGather(const std::span<const std::span<const std::byte>> pieces)
+    {
+        if (m_pipe == nullptr)
+            throw std::runtime_error(__FUNCSIG__ ": pipe is nullptr");
+        return m_vectoredIoTraits
+            ? Async::WriteGather(m_pipe.GetHandle(), *m_vectoredIoTraits, pieces)
+            : Async::WriteGather(m_pipe.GetHandle(), pieces);
+    }
+
+    ScatterReadResult NamedPipeServerBase::ReadScatter(const std::span<const std::span<std::byte>> pieces)
+    {
+        if (m_pipe == nullptr)
+            throw std::runtime_error(__FUNCSIG__ ": pipe is nullptr");
+        return m_vectoredIoTraits
+            ? Async::ReadScatter(m_pipe.GetHandle(), *m_vectoredIoTraits, pieces)
+            : Async::ReadScatter(m_pipe.GetHandle(), pieces);
+    }
+
     std::wstring NamedPipeServerBase::GetName() const
     {
         return m_pipeName;
@@ -123,4 +123,82 @@ namespace Boring32::Async
 						oio.LastError()
 					);
 	}
+
+	void OverlappedNamedPipeClient::Write(const std::wstring& msg, OverlappedLease& lease)
+	{
+		if (m_handle == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": no pipe to write to");
+		lease.Reset();
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-writefile
+		const bool succeeded = WriteFile(
+			m_handle.GetHandle(),
+			msg.c_str(),
+			(DWORD)(msg.size() * sizeof(wchar_t)),
+			nullptr,
+			lease.GetOverlapped()
+		);
+		lease.LastError(GetLastError());
+		if (succeeded == false && lease.LastError() != ERROR_IO_PENDING)
+			throw Error::Win32Error(__FUNCSIG__ ": WriteFile() failed", lease.LastError());
+	}
+
+	bool OverlappedNamedPipeClient::Write(const std::wstring& msg, OverlappedLease& lease, std::nothrow_t) noexcept
+	{
+		try
+		{
+			Write(msg, lease);
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Write() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	void OverlappedNamedPipeClient::Read(std::wstring& buffer, OverlappedLease& lease)
+	{
+		if (m_handle == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": no pipe to read from");
+		lease.Reset();
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-readfile
+		const bool succeeded = ReadFile(
+			m_handle.GetHandle(),
+			buffer.data(),
+			(DWORD)(buffer.size() * sizeof(wchar_t)),
+			nullptr,
+			lease.GetOverlapped()
+		);
+		lease.LastError(GetLastError());
+		if (
+			succeeded == false
+			&& lease.LastError() != ERROR_IO_PENDING
+			&& lease.LastError() != ERROR_MORE_DATA
+		)
+		{
+			throw Error::Win32Error(__FUNCSIG__ ": ReadFile() failed", lease.LastError());
+		}
+	}
+
+	bool OverlappedNamedPipeClient::Read(std::wstring& buffer, OverlappedLease& lease, std::nothrow_t) noexcept
+	{
+		try
+		{
+			Read(buffer, lease);
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Read() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
 }
\ No newline at end of file
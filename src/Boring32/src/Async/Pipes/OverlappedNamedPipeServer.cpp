@@ -84,11 +84,6 @@ namespace Boring32::Async
         Move(other);
     }
 
-    void NTAPI Poop(void* data, BYTE timedOut)
-    {
-        int i = 0;
-    }
-
     bool OverlappedNamedPipeServer::Connect(OverlappedOp& op, std::nothrow_t) noexcept
     {
         try
@@ -112,18 +107,6 @@ namespace Boring32::Async
         oio.LastError(GetLastError());
         if (succeeded == false && oio.LastError() != ERROR_IO_PENDING)
             throw Error::Win32Error("OverlappedNamedPipeServer::Connect(): ConnectNamedPipe() failed", oio.LastError());
-        
-        /*
-        HANDLE out = nullptr;
-        RegisterWaitForSingleObject(
-            &out,
-            oio.GetWaitableHandle(),
-            Poop,//[](void* data, BYTE timedOut)->void {},
-            this, 
-            INFINITE, 
-            WT_EXECUTEDEFAULT
-        );
-        */
     }
 
     void OverlappedNamedPipeServer::Write(const std::wstring& msg, OverlappedIo& oio)
@@ -212,4 +195,116 @@ namespace Boring32::Async
             throw Error::Win32Error("OverlappedNamedPipeServer::Read(): ReadFile() failed", oio.LastError());
         }
     }
-}
+
+    void OverlappedNamedPipeServer::Connect(OverlappedLease& lease)
+    {
+        if (m_pipe == nullptr)
+            throw std::runtime_error(__FUNCSIG__ ": no valid pipe handle to connect");
+        lease.Reset();
+        const bool succeeded = ConnectNamedPipe(m_pipe.GetHandle(), lease.GetOverlapped());
+        lease.LastError(GetLastError());
+        // A client that connected before this call completes the connect
+        // without the system signalling the event, so signal it here
+        if (succeeded == false && lease.LastError() == ERROR_PIPE_CONNECTED)
+        {
+            lease.SetEvent(true);
+            return;
+        }
+        if (succeeded == false && lease.LastError() != ERROR_IO_PENDING)
+            throw Error::Win32Error(__FUNCSIG__ ": ConnectNamedPipe() failed", lease.LastError());
+    }
+
+    bool OverlappedNamedPipeServer::Connect(OverlappedLease& lease, std::nothrow_t) noexcept
+    {
+        try
+        {
+            Connect(lease);
+            return true;
+        }
+        catch (const std::exception& ex)
+        {
+            std::wcerr
+                << __FUNCSIG__
+                << L": Connect() failed: "
+                << ex.what()
+                << std::endl;
+            return false;
+        }
+    }
+
+    void OverlappedNamedPipeServer::Write(const std::wstring& msg, OverlappedLease& lease)
+    {
+        if (m_pipe == nullptr)
+            throw std::runtime_error(__FUNCSIG__ ": no pipe to write to");
+        lease.Reset();
+        const bool succeeded = WriteFile(
+            m_pipe.GetHandle(),
+            msg.c_str(),
+            (DWORD)(msg.size() * sizeof(wchar_t)),
+            nullptr,
+            lease.GetOverlapped()
+        );
+        lease.LastError(GetLastError());
+        if (succeeded == false && lease.LastError() != ERROR_IO_PENDING)
+            throw Error::Win32Error(__FUNCSIG__ ": WriteFile() failed", lease.LastError());
+    }
+
+    bool OverlappedNamedPipeServer::Write(const std::wstring& msg, OverlappedLease& lease, std::nothrow_t) noexcept
+    {
+        try
+        {
+            Write(msg, lease);
+            return true;
+        }
+        catch (const std::exception& ex)
+        {
+            std::wcerr
+                << __FUNCSIG__
+                << L": Write() failed: "
+                << ex.what()
+                << std::endl;
+            return false;
+        }
+    }
+
+    void OverlappedNamedPipeServer::Read(std::wstring& buffer, OverlappedLease& lease)
+    {
+        if (m_pipe == nullptr)
+            throw std::runtime_error(__FUNCSIG__ ": no pipe to read from");
+        lease.Reset();
+        const bool succeeded = ReadFile(
+            m_pipe.GetHandle(),
+            buffer.data(),
+            (DWORD)(buffer.size() * sizeof(wchar_t)),
+            nullptr,
+            lease.GetOverlapped()
+        );
+        lease.LastError(GetLastError());
+        if (
+            succeeded == false
+            && lease.LastError() != ERROR_IO_PENDING
+            && lease.LastError() != ERROR_MORE_DATA
+        )
+        {
+            throw Error::Win32Error(__FUNCSIG__ ": ReadFile() failed", lease.LastError());
+        }
+    }
+
+    bool OverlappedNamedPipeServer::Read(std::wstring& buffer, OverlappedLease& lease, std::nothrow_t) noexcept
+    {
+        try
+        {
+            Read(buffer, lease);
+            return true;
+        }
+        catch (const std::exception& ex)
+        {
+            std::wcerr
+                << __FUNCSIG__
+                << L": Read() failed: "
+                << ex.what()
+                << std::endl;
+            return false;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "pch.hpp"
+#include "include/Async/Pipes/PipeFrame.hpp"
+
+namespace Boring32::Async
+{
+	PipeFrame::~PipeFrame()
+	{
+		Release();
+	}
+
+	PipeFrame::PipeFrame() { }
+
+	PipeFrame::PipeFrame(std::shared_ptr<std::byte> buffer, const std::span<const std::byte> data)
+	:	m_buffer(std::move(buffer)),
+		m_data(data)
+	{ }
+
+	PipeFrame::PipeFrame(PipeFrame&& other) noexcept
+	{
+		Move(other);
+	}
+
+	PipeFrame& PipeFrame::operator=(PipeFrame&& other) noexcept
+	{
+		Move(other);
+		return *this;
+	}
+
+	void PipeFrame::Move(PipeFrame& other) noexcept
+	{
+		m_buffer = std::move(other.m_buffer);
+		m_data = other.m_data;
+		other.m_data = {};
+	}
+
+	std::span<const std::byte> PipeFrame::GetData() const noexcept
+	{
+		return m_data;
+	}
+
+	size_t PipeFrame::GetSize() const noexcept
+	{
+		return m_data.size();
+	}
+
+	bool PipeFrame::IsValid() const noexcept
+	{
+		return m_buffer != nullptr;
+	}
+
+	void PipeFrame::Release() noexcept
+	{
+		m_buffer = nullptr;
+		m_data = {};
+	}
+}
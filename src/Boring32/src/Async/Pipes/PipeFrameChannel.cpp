@@ -0,0 +1,572 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/CriticalSectionLock.hpp"
+#include "include/Async/Pipes/PipeFrameChannel.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		constexpr UINT64 NoDeadline = MAXUINT64;
+
+		UINT64 ToDeadline(const DWORD timeoutMillis)
+		{
+			return timeoutMillis == INFINITE
+				? NoDeadline
+				: GetTickCount64() + timeoutMillis;
+		}
+
+		DWORD RemainingMillis(const UINT64 deadline)
+		{
+			if (deadline == NoDeadline)
+				return INFINITE;
+			const UINT64 now = GetTickCount64();
+			return deadline > now ? (DWORD)(deadline - now) : 0;
+		}
+	}
+
+	PipeFrameChannel::~PipeFrameChannel()
+	{
+		if (m_flushTimer != nullptr)
+		{
+			// A callback already running could otherwise re-arm the timer
+			// after it is cancelled
+			{
+				CriticalSectionLock cs(m_sendCs);
+				m_stopping = true;
+			}
+			SetThreadpoolTimer(m_flushTimer, nullptr, 0, 0);
+			WaitForThreadpoolTimerCallbacks(m_flushTimer, true);
+			CloseThreadpoolTimer(m_flushTimer);
+		}
+		Flush(std::nothrow);
+		// The timer's write must land before its buffer is freed, even if
+		// Flush() failed
+		CompletePendingFlush(true);
+		DeleteCriticalSection(&m_sendCs);
+	}
+
+	PipeFrameChannel::PipeFrameChannel(NamedPipeServerBase& server)
+	:	PipeFrameChannel(server.GetInternalHandle().GetHandle(), PipeFrameChannelSettings{})
+	{ }
+
+	PipeFrameChannel::PipeFrameChannel(NamedPipeServerBase& server, const PipeFrameChannelSettings& settings)
+	:	PipeFrameChannel(server.GetInternalHandle().GetHandle(), settings)
+	{ }
+
+	PipeFrameChannel::PipeFrameChannel(NamedPipeClientBase& client)
+	:	PipeFrameChannel(client.GetInternalHandle().GetHandle(), PipeFrameChannelSettings{})
+	{ }
+
+	PipeFrameChannel::PipeFrameChannel(NamedPipeClientBase& client, const PipeFrameChannelSettings& settings)
+	:	PipeFrameChannel(client.GetInternalHandle().GetHandle(), settings)
+	{ }
+
+	PipeFrameChannel::PipeFrameChannel(const HANDLE pipe, const PipeFrameChannelSettings& settings)
+	:	m_pipe(pipe),
+		m_settings(settings),
+		m_readPosition(0),
+		m_writePosition(0),
+		m_readDone(false, true, false),
+		m_writeDone(false, true, false),
+		m_readOverlapped{ 0 },
+		m_writeOverlapped{ 0 },
+		m_connected(true),
+		m_framesSent(0),
+		m_writeCalls(0),
+		m_batchStarted{ 0 },
+		m_frequency{ 0 },
+		m_flushTimer(nullptr),
+		m_flushTimerArmed(false),
+		m_stopping(false),
+		m_flushDone(false, true, false),
+		m_flushOverlapped{ 0 },
+		m_flushPending(false)
+	{
+		if (m_pipe == nullptr || m_pipe == INVALID_HANDLE_VALUE)
+			throw std::invalid_argument(__FUNCSIG__ ": the pipe is not open");
+		if (m_settings.BufferSize <= HeaderSize)
+			throw std::invalid_argument(__FUNCSIG__ ": BufferSize must be larger than the frame header");
+		if (m_settings.BatchSize > 0 && m_settings.BatchSize <= HeaderSize)
+			throw std::invalid_argument(__FUNCSIG__ ": BatchSize must be larger than the frame header");
+		m_pool = std::make_shared<ByteBufferPool>(m_settings.BufferSize, m_settings.MaxBuffers);
+		m_sendBuffer.reserve((size_t)HeaderSize + m_settings.CoalesceLimit);
+		m_batch.reserve(m_settings.BatchSize);
+		m_flushBatch.reserve(m_settings.BatchSize);
+		QueryPerformanceFrequency(&m_frequency);
+
+		InitializeCriticalSection(&m_sendCs);
+		if (m_settings.BatchSize > 0 && m_settings.BatchDelayMicroseconds > 0)
+		{
+			// https://docs.microsoft.com/en-us/windows/win32/api/threadpoolapiset/nf-threadpoolapiset-createthreadpooltimer
+			m_flushTimer = CreateThreadpoolTimer(FlushTimerCallback, this, nullptr);
+			if (m_flushTimer == nullptr)
+			{
+				const DWORD lastError = GetLastError();
+				DeleteCriticalSection(&m_sendCs);
+				throw Error::Win32Error(__FUNCSIG__ ": CreateThreadpoolTimer() failed", lastError);
+			}
+		}
+	}
+
+	void PipeFrameChannel::Send(const std::span<const std::byte> data)
+	{
+		if (data.size() > GetMaxFrameSize())
+			throw std::invalid_argument(__FUNCSIG__ ": data exceeds the maximum frame size");
+
+		CriticalSectionLock cs(m_sendCs);
+		// Only reports a finished write here, as this frame may not need
+		// to wait for it
+		CompletePendingFlush(false);
+		ThrowIfFlushFailed();
+		if (m_settings.BatchSize > 0 && HeaderSize + data.size() <= m_settings.BatchSize)
+		{
+			Batch(data);
+			m_framesSent++;
+			return;
+		}
+		// Frames already batched, or being written by the timer, go
+		// first, to keep frames in order
+		FlushBatch();
+
+		const UINT32 length = (UINT32)data.size();
+		if (data.size() <= m_settings.CoalesceLimit)
+		{
+			m_sendBuffer.resize(HeaderSize + data.size());
+			memcpy(m_sendBuffer.data(), &length, HeaderSize);
+			if (data.empty() == false)
+				memcpy(m_sendBuffer.data() + HeaderSize, data.data(), data.size());
+			WriteAll(m_sendBuffer.data(), (DWORD)m_sendBuffer.size());
+		}
+		else
+		{
+			// Copying a large payload would cost more than the extra write
+			WriteAll(reinterpret_cast<const std::byte*>(&length), HeaderSize);
+			WriteAll(data.data(), (DWORD)data.size());
+		}
+		m_framesSent++;
+	}
+
+	bool PipeFrameChannel::Send(const std::span<const std::byte> data, std::nothrow_t) noexcept
+	{
+		try
+		{
+			Send(data);
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Send() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	void PipeFrameChannel::Flush()
+	{
+		CriticalSectionLock cs(m_sendCs);
+		CompletePendingFlush(true);
+		ThrowIfFlushFailed();
+		FlushBatch();
+	}
+
+	bool PipeFrameChannel::Flush(std::nothrow_t) noexcept
+	{
+		try
+		{
+			Flush();
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Flush() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	PipeFrame PipeFrameChannel::Receive(const DWORD timeoutMillis)
+	{
+		const UINT64 deadline = ToDeadline(timeoutMillis);
+		PipeFrame frame;
+		while (true)
+		{
+			if (TryTakeFrame(frame))
+				return frame;
+			if (m_connected == false)
+				return frame;
+
+			// The next frame must be contiguous, so make sure it fits
+			DWORD required = HeaderSize;
+			if (m_writePosition - m_readPosition >= HeaderSize)
+			{
+				UINT32 length = 0;
+				memcpy(&length, m_receiveBuffer.get() + m_readPosition, HeaderSize);
+				required += length;
+			}
+			if (MakeRoom(required, deadline) == false)
+				return frame;
+			if (ReadMore(deadline) == false)
+				return frame;
+		}
+	}
+
+	bool PipeFrameChannel::IsConnected() const noexcept
+	{
+		return m_connected;
+	}
+
+	DWORD PipeFrameChannel::GetMaxFrameSize() const noexcept
+	{
+		return m_settings.BufferSize - HeaderSize;
+	}
+
+	const PipeFrameChannelSettings& PipeFrameChannel::GetSettings() const noexcept
+	{
+		return m_settings;
+	}
+
+	UINT64 PipeFrameChannel::GetFramesSent() const noexcept
+	{
+		return m_framesSent;
+	}
+
+	UINT64 PipeFrameChannel::GetWriteCalls() const noexcept
+	{
+		return m_writeCalls;
+	}
+
+	bool PipeFrameChannel::TryTakeFrame(PipeFrame& frame)
+	{
+		const DWORD available = m_writePosition - m_readPosition;
+		if (available < HeaderSize)
+			return false;
+
+		const std::byte* start = m_receiveBuffer.get() + m_readPosition;
+		UINT32 length = 0;
+		memcpy(&length, start, HeaderSize);
+		if (length > GetMaxFrameSize())
+			throw std::runtime_error(__FUNCSIG__ ": received a frame larger than the maximum frame size");
+		if (available - HeaderSize < length)
+			return false;
+
+		frame = PipeFrame(
+			m_receiveBuffer,
+			std::span<const std::byte>(start + HeaderSize, length)
+		);
+		m_readPosition += HeaderSize + length;
+		return true;
+	}
+
+	bool PipeFrameChannel::MakeRoom(const DWORD required, const UINT64 deadline)
+	{
+		const DWORD unconsumed = m_writePosition - m_readPosition;
+		if (m_receiveBuffer != nullptr)
+		{
+			// With no frames referring to the buffer, the unconsumed bytes
+			// can be moved to the front rather than to a new buffer
+			if (m_receiveBuffer.use_count() == 1 && m_readPosition > 0)
+			{
+				memmove(m_receiveBuffer.get(), m_receiveBuffer.get() + m_readPosition, unconsumed);
+				m_readPosition = 0;
+				m_writePosition = unconsumed;
+			}
+			if (m_readPosition + required <= m_settings.BufferSize && m_writePosition < m_settings.BufferSize)
+				return true;
+		}
+
+		std::byte* acquired = m_pool->Acquire(RemainingMillis(deadline));
+		if (acquired == nullptr)
+			return false;
+		// The last frame to be released returns the buffer to the pool
+		std::shared_ptr<std::byte> buffer(
+			acquired,
+			[pool = m_pool](std::byte* released) { pool->Release(released); }
+		);
+		if (unconsumed > 0)
+			memcpy(buffer.get(), m_receiveBuffer.get() + m_readPosition, unconsumed);
+		m_receiveBuffer = std::move(buffer);
+		m_readPosition = 0;
+		m_writePosition = unconsumed;
+		return true;
+	}
+
+	bool PipeFrameChannel::ReadMore(const UINT64 deadline)
+	{
+		m_readOverlapped = OVERLAPPED{ 0 };
+		m_readOverlapped.hEvent = m_readDone.GetHandle();
+
+		// Read as much as is available, so that small frames sent in quick
+		// succession are picked up together
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-readfile
+		const bool succeeded = ReadFile(
+			m_pipe,
+			m_receiveBuffer.get() + m_writePosition,
+			m_settings.BufferSize - m_writePosition,
+			nullptr,
+			&m_readOverlapped
+		);
+		DWORD lastError = succeeded ? ERROR_SUCCESS : GetLastError();
+
+		bool timedOut = false;
+		if (lastError == ERROR_IO_PENDING)
+		{
+			const DWORD result = WaitForSingleObject(m_readDone.GetHandle(), RemainingMillis(deadline));
+			if (result != WAIT_OBJECT_0)
+			{
+				const DWORD waitError = GetLastError();
+				// The read must not outlive this call, so cancel it and
+				// let GetOverlappedResult() below wait for it to land
+				CancelIoEx(m_pipe, &m_readOverlapped);
+				if (result != WAIT_TIMEOUT)
+				{
+					DWORD ignored = 0;
+					GetOverlappedResult(m_pipe, &m_readOverlapped, &ignored, true);
+					throw Error::Win32Error(__FUNCSIG__ ": WaitForSingleObject() failed", waitError);
+				}
+				timedOut = true;
+			}
+		}
+
+		if (lastError == ERROR_SUCCESS || lastError == ERROR_IO_PENDING || lastError == ERROR_MORE_DATA)
+		{
+			// A cancelled read may still have transferred some bytes
+			DWORD bytesRead = 0;
+			// https://docs.microsoft.com/en-us/windows/win32/api/ioapiset/nf-ioapiset-getoverlappedresult
+			lastError = GetOverlappedResult(m_pipe, &m_readOverlapped, &bytesRead, true)
+				? ERROR_SUCCESS
+				: GetLastError();
+			m_writePosition += bytesRead;
+		}
+
+		switch (lastError)
+		{
+			case ERROR_SUCCESS:
+			// Message-mode pipes report messages larger than the space left
+			// this way; the rest of the message is picked up by the next read
+			case ERROR_MORE_DATA:
+				return true;
+
+			case ERROR_OPERATION_ABORTED:
+				if (timedOut)
+					return false;
+				throw Error::Win32Error(__FUNCSIG__ ": the read was cancelled", lastError);
+
+			case ERROR_BROKEN_PIPE:
+			case ERROR_PIPE_NOT_CONNECTED:
+				m_connected = false;
+				return false;
+
+			default:
+				throw Error::Win32Error(__FUNCSIG__ ": ReadFile() failed", lastError);
+		}
+	}
+
+	void PipeFrameChannel::WriteAll(const std::byte* data, const DWORD size)
+	{
+		const std::byte* next = data;
+		DWORD remaining = size;
+		while (remaining > 0)
+		{
+			m_writeOverlapped = OVERLAPPED{ 0 };
+			m_writeOverlapped.hEvent = m_writeDone.GetHandle();
+			// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-writefile
+			const bool succeeded = WriteFile(m_pipe, next, remaining, nullptr, &m_writeOverlapped);
+			m_writeCalls++;
+			if (succeeded == false && GetLastError() != ERROR_IO_PENDING)
+				throw Error::Win32Error(__FUNCSIG__ ": WriteFile() failed", GetLastError());
+
+			DWORD bytesWritten = 0;
+			if (GetOverlappedResult(m_pipe, &m_writeOverlapped, &bytesWritten, true) == false)
+				throw Error::Win32Error(__FUNCSIG__ ": GetOverlappedResult() failed", GetLastError());
+			if (bytesWritten == 0)
+				throw std::runtime_error(__FUNCSIG__ ": WriteFile() made no progress");
+			next += bytesWritten;
+			remaining -= bytesWritten;
+		}
+	}
+
+	void PipeFrameChannel::Batch(const std::span<const std::byte> data)
+	{
+		const size_t frameSize = HeaderSize + data.size();
+		if (m_batch.size() + frameSize > m_settings.BatchSize)
+			FlushBatch();
+		if (m_batch.empty())
+			QueryPerformanceCounter(&m_batchStarted);
+
+		const UINT32 length = (UINT32)data.size();
+		const size_t offset = m_batch.size();
+		m_batch.resize(offset + frameSize);
+		memcpy(m_batch.data() + offset, &length, HeaderSize);
+		if (data.empty() == false)
+			memcpy(m_batch.data() + offset + HeaderSize, data.data(), data.size());
+
+		// Send the batch once no other frame could fit or once its first
+		// frame has waited long enough, and otherwise leave it to the timer
+		const UINT64 delay = m_settings.BatchDelayMicroseconds;
+		if (m_batch.size() + HeaderSize >= m_settings.BatchSize)
+		{
+			FlushBatch();
+		}
+		else if (delay > 0)
+		{
+			const UINT64 age = GetBatchAgeMicroseconds();
+			if (age >= delay)
+				FlushBatch();
+			else if (m_flushTimerArmed == false)
+				ArmFlushTimer(delay - age);
+		}
+	}
+
+	void PipeFrameChannel::FlushBatch()
+	{
+		CompletePendingFlush(true);
+		ThrowIfFlushFailed();
+		if (m_batch.empty())
+			return;
+		try
+		{
+			WriteAll(m_batch.data(), (DWORD)m_batch.size());
+		}
+		catch (...)
+		{
+			// A partly written batch can't be resent without corrupting
+			// the stream, so it is dropped along with the error
+			m_batch.clear();
+			throw;
+		}
+		m_batch.clear();
+	}
+
+	void PipeFrameChannel::ArmFlushTimer(const UINT64 dueMicroseconds)
+	{
+		if (m_stopping)
+			return;
+		// Negative due times are relative, in 100-nanosecond units
+		ULARGE_INTEGER dueTime{ 0 };
+		dueTime.QuadPart = (ULONGLONG)(-(LONGLONG)(dueMicroseconds * 10));
+		FILETIME due{
+			.dwLowDateTime = dueTime.LowPart,
+			.dwHighDateTime = dueTime.HighPart
+		};
+		// https://docs.microsoft.com/en-us/windows/win32/api/threadpoolapiset/nf-threadpoolapiset-setthreadpooltimer
+		SetThreadpoolTimer(m_flushTimer, &due, 0, 0);
+		m_flushTimerArmed = true;
+	}
+
+	void PipeFrameChannel::OnFlushTimer()
+	{
+		CriticalSectionLock cs(m_sendCs);
+		m_flushTimerArmed = false;
+		if (m_stopping || m_batch.empty())
+			return;
+
+		// The batch the timer was armed for may have been sent already,
+		// in which case this one is younger and gets the rest of its time
+		const UINT64 age = GetBatchAgeMicroseconds();
+		if (age < m_settings.BatchDelayMicroseconds)
+		{
+			ArmFlushTimer(m_settings.BatchDelayMicroseconds - age);
+			return;
+		}
+
+		// The thread pool thread must not wait on the pipe while holding
+		// the lock, so if the last batch it started is still being
+		// written, it tries again later
+		if (CompletePendingFlush(false) == false)
+		{
+			ArmFlushTimer(m_settings.BatchDelayMicroseconds);
+			return;
+		}
+		StartFlush();
+	}
+
+	void PipeFrameChannel::StartFlush()
+	{
+		// The batch is kept alive until the write completes, and the
+		// buffer it swaps with is reused for the next batch
+		m_flushBatch.swap(m_batch);
+		m_batch.clear();
+		m_flushOverlapped = OVERLAPPED{ 0 };
+		m_flushOverlapped.hEvent = m_flushDone.GetHandle();
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-writefile
+		const bool succeeded = WriteFile(
+			m_pipe,
+			m_flushBatch.data(),
+			(DWORD)m_flushBatch.size(),
+			nullptr,
+			&m_flushOverlapped
+		);
+		m_writeCalls++;
+		if (succeeded == false && GetLastError() != ERROR_IO_PENDING)
+		{
+			// As with FlushBatch(), the batch is dropped with the error
+			if (m_flushError.empty())
+				m_flushError = Error::Win32Error(__FUNCSIG__ ": WriteFile() failed", GetLastError()).what();
+			m_flushBatch.clear();
+			return;
+		}
+		m_flushPending = true;
+	}
+
+	bool PipeFrameChannel::CompletePendingFlush(const bool wait)
+	{
+		if (m_flushPending == false)
+			return true;
+		// https://docs.microsoft.com/en-us/windows/win32/api/minwinbase/nf-minwinbase-hasoverlappediocompleted
+		if (wait == false && HasOverlappedIoCompleted(&m_flushOverlapped) == false)
+			return false;
+
+		m_flushPending = false;
+		try
+		{
+			DWORD bytesWritten = 0;
+			// https://docs.microsoft.com/en-us/windows/win32/api/ioapiset/nf-ioapiset-getoverlappedresult
+			if (GetOverlappedResult(m_pipe, &m_flushOverlapped, &bytesWritten, true) == false)
+				throw Error::Win32Error(__FUNCSIG__ ": WriteFile() failed", GetLastError());
+			// Pipe writes complete in full, but a partial write would
+			// otherwise corrupt the stream
+			if (bytesWritten < m_flushBatch.size())
+				WriteAll(m_flushBatch.data() + bytesWritten, (DWORD)(m_flushBatch.size() - bytesWritten));
+		}
+		catch (const std::exception& ex)
+		{
+			if (m_flushError.empty())
+				m_flushError = ex.what();
+		}
+		m_flushBatch.clear();
+		return true;
+	}
+
+	void PipeFrameChannel::ThrowIfFlushFailed()
+	{
+		if (m_flushError.empty())
+			return;
+		const std::string error = std::move(m_flushError);
+		m_flushError.clear();
+		throw std::runtime_error(__FUNCSIG__ ": a batch failed to send: " + error);
+	}
+
+	UINT64 PipeFrameChannel::GetBatchAgeMicroseconds() const noexcept
+	{
+		LARGE_INTEGER now{ 0 };
+		QueryPerformanceCounter(&now);
+		return (UINT64)(now.QuadPart - m_batchStarted.QuadPart) * 1000000 / m_frequency.QuadPart;
+	}
+
+	void CALLBACK PipeFrameChannel::FlushTimerCallback(
+		PTP_CALLBACK_INSTANCE instance,
+		void* context,
+		PTP_TIMER timer
+	)
+	{
+		static_cast<PipeFrameChannel*>(context)->OnFlushTimer();
+	}
+}
\ No newline at end of file
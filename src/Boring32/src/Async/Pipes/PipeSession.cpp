@@ -0,0 +1,253 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/CriticalSectionLock.hpp"
+#include "include/Async/Pipes/PipeSession.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		// Completed writes keep their buffers for reuse, up to this many
+		constexpr size_t MaxSpareBuffers = 4;
+	}
+
+	PipeSession::~PipeSession()
+	{
+		DeleteCriticalSection(&m_cs);
+	}
+
+	PipeSession::PipeSession(
+		std::unique_ptr<OverlappedNamedPipeServer> pipe,
+		const UINT64 id,
+		const DWORD bufferSize,
+		const FlowControlSettings& writeLimits,
+		std::function<void(PipeSession& session)> onWritable
+	)
+	:	m_pipe(std::move(pipe)),
+		m_id(id),
+		m_connectContext{ { 0 }, Operation::Connect, this },
+		m_readContext{ { 0 }, Operation::Read, this },
+		m_writeContext{ { 0 }, Operation::Write, this },
+		m_receiveBuffer(bufferSize),
+		m_received(0),
+		m_onWritable(std::move(onWritable)),
+		m_writeCredit(writeLimits, [this]() { if (m_onWritable) m_onWritable(*this); }),
+		m_pendingOps(0),
+		m_connected(false),
+		m_closing(false)
+	{
+		InitializeCriticalSection(&m_cs);
+	}
+
+	UINT64 PipeSession::GetId() const noexcept
+	{
+		return m_id;
+	}
+
+	DWORD PipeSession::GetClientProcessId()
+	{
+		CriticalSectionLock cs(m_cs);
+		if (m_pipe == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": the session has ended");
+		ULONG processId = 0;
+		// https://docs.microsoft.com/en-us/windows/win32/api/winbase/nf-winbase-getnamedpipeclientprocessid
+		if (GetNamedPipeClientProcessId(GetPipeHandle(), &processId) == false)
+			throw Error::Win32Error(__FUNCSIG__ ": GetNamedPipeClientProcessId() failed", GetLastError());
+		return processId;
+	}
+
+	bool PipeSession::IsConnected()
+	{
+		CriticalSectionLock cs(m_cs);
+		return m_connected && m_closing == false;
+	}
+
+	void PipeSession::Write(const std::span<const std::byte> message)
+	{
+		Write(message, INFINITE);
+	}
+
+	bool PipeSession::Write(const std::span<const std::byte> message, const DWORD timeoutMillis)
+	{
+		// Credit is waited for outside the lock, as it's returned by write
+		// completions, which take the lock
+		if (m_writeCredit.Acquire(message.size(), timeoutMillis) == false)
+		{
+			if (m_writeCredit.IsCancelled())
+				throw std::runtime_error(__FUNCSIG__ ": the session is not connected");
+			return false;
+		}
+		Enqueue(message);
+		return true;
+	}
+
+	bool PipeSession::TryWrite(const std::span<const std::byte> message)
+	{
+		if (m_writeCredit.TryAcquire(message.size()) == false)
+		{
+			if (m_writeCredit.IsCancelled())
+				throw std::runtime_error(__FUNCSIG__ ": the session is not connected");
+			return false;
+		}
+		Enqueue(message);
+		return true;
+	}
+
+	FlowControlStats PipeSession::GetWriteStats()
+	{
+		return m_writeCredit.GetStats();
+	}
+
+	UINT64 PipeSession::GetQueuedBytes()
+	{
+		return m_writeCredit.GetBytesInFlight();
+	}
+
+	void PipeSession::Enqueue(const std::span<const std::byte> message)
+	{
+		CriticalSectionLock cs(m_cs);
+		if (m_connected == false || m_closing)
+		{
+			m_writeCredit.Release(message.size());
+			throw std::runtime_error(__FUNCSIG__ ": the session is not connected");
+		}
+
+		std::vector<std::byte> buffer;
+		if (m_spareBuffers.empty() == false)
+		{
+			buffer = std::move(m_spareBuffers.back());
+			m_spareBuffers.pop_back();
+		}
+		buffer.assign(message.begin(), message.end());
+		m_writeQueue.push_back(std::move(buffer));
+
+		// Only one write is outstanding at a time; the rest are issued
+		// as each one completes
+		if (m_writeQueue.size() == 1 && IssueWrite() == false)
+			throw Error::Win32Error(__FUNCSIG__ ": WriteFile() failed", GetLastError());
+	}
+
+	bool PipeSession::Write(const std::span<const std::byte> message, std::nothrow_t) noexcept
+	{
+		try
+		{
+			Write(message);
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Write() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	void PipeSession::Close()
+	{
+		CriticalSectionLock cs(m_cs);
+		BeginClose();
+	}
+
+	HANDLE PipeSession::GetPipeHandle() const noexcept
+	{
+		return m_pipe->GetInternalHandle().GetHandle();
+	}
+
+	void PipeSession::IssueRead()
+	{
+		if (m_closing)
+			return;
+
+		m_readContext.Overlapped = OVERLAPPED{ 0 };
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-readfile
+		const bool succeeded = ReadFile(
+			GetPipeHandle(),
+			m_receiveBuffer.data() + m_received,
+			(DWORD)(m_receiveBuffer.size() - m_received),
+			nullptr,
+			&m_readContext.Overlapped
+		);
+		const DWORD lastError = succeeded ? ERROR_SUCCESS : GetLastError();
+		// Reads that complete immediately still queue a completion
+		if (succeeded || lastError == ERROR_IO_PENDING || lastError == ERROR_MORE_DATA)
+		{
+			m_pendingOps++;
+			return;
+		}
+		BeginClose();
+	}
+
+	bool PipeSession::IssueWrite()
+	{
+		const std::vector<std::byte>& message = m_writeQueue.front();
+		m_writeContext.Overlapped = OVERLAPPED{ 0 };
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-writefile
+		const bool succeeded = WriteFile(
+			GetPipeHandle(),
+			message.data(),
+			(DWORD)message.size(),
+			nullptr,
+			&m_writeContext.Overlapped
+		);
+		if (succeeded || GetLastError() == ERROR_IO_PENDING)
+		{
+			m_pendingOps++;
+			return true;
+		}
+		const DWORD lastError = GetLastError();
+		BeginClose();
+		ClearWriteQueue();
+		SetLastError(lastError);
+		return false;
+	}
+
+	void PipeSession::BeginClose()
+	{
+		if (m_closing)
+			return;
+		m_closing = true;
+		// Writers waiting for credit fail rather than wait for writes that
+		// won't complete
+		m_writeCredit.Cancel();
+		// Outstanding operations complete with ERROR_OPERATION_ABORTED, and
+		// the last one to complete hands the pipe instance back to the server
+		if (m_pipe != nullptr)
+			CancelIoEx(GetPipeHandle(), nullptr);
+	}
+
+	void PipeSession::ClearWriteQueue()
+	{
+		for (const std::vector<std::byte>& message : m_writeQueue)
+			m_writeCredit.Release(message.size());
+		m_writeQueue.clear();
+	}
+
+	void PipeSession::CompleteWrite(const DWORD error)
+	{
+		size_t completedSize = 0;
+		{
+			CriticalSectionLock cs(m_cs);
+			if (error != ERROR_SUCCESS)
+			{
+				BeginClose();
+				ClearWriteQueue();
+				return;
+			}
+			if (m_writeQueue.empty())
+				return;
+
+			completedSize = m_writeQueue.front().size();
+			if (m_spareBuffers.size() < MaxSpareBuffers)
+				m_spareBuffers.push_back(std::move(m_writeQueue.front()));
+			m_writeQueue.pop_front();
+			if (m_writeQueue.empty() == false && m_closing == false)
+				IssueWrite();
+		}
+		// Outside the lock, as this may invoke OnWritable
+		m_writeCredit.Release(completedSize);
+	}
+}
@@ -0,0 +1,460 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/CriticalSectionLock.hpp"
+#include "include/Async/Pipes/PooledNamedPipeServer.hpp"
+
+namespace Boring32::Async
+{
+	PooledNamedPipeServer::~PooledNamedPipeServer()
+	{
+		Close();
+		DeleteCriticalSection(&m_cs);
+	}
+
+	PooledNamedPipeServer::PooledNamedPipeServer(
+		const std::wstring& pipeName,
+		const PooledNamedPipeServerSettings& settings,
+		const PipeSessionHandlers& handlers
+	)
+	:	m_pipeName(pipeName),
+		m_settings(settings),
+		m_handlers(handlers),
+		m_nextId(0),
+		m_pendingCount(0),
+		m_instanceCount(0),
+		m_startingCount(0),
+		m_connectedCount(0),
+		m_stopping(false),
+		m_drained(false, true, false)
+	{
+		if (m_settings.PendingInstances == 0)
+			throw std::invalid_argument(__FUNCSIG__ ": PendingInstances must be greater than 0");
+		if (m_settings.WorkerThreads == 0)
+			throw std::invalid_argument(__FUNCSIG__ ": WorkerThreads must be greater than 0");
+		if (m_settings.MaxInstances == 0 || m_settings.MaxInstances > PIPE_UNLIMITED_INSTANCES)
+			throw std::invalid_argument(__FUNCSIG__ ": MaxInstances must be between 1 and PIPE_UNLIMITED_INSTANCES");
+		if (m_settings.MaxInstances != PIPE_UNLIMITED_INSTANCES && m_settings.PendingInstances > m_settings.MaxInstances)
+			throw std::invalid_argument(__FUNCSIG__ ": PendingInstances cannot exceed MaxInstances");
+		if (m_pipeName.starts_with(L"\\\\.\\pipe\\") == false)
+			m_pipeName = L"\\\\.\\pipe\\" + m_pipeName;
+
+		InitializeCriticalSection(&m_cs);
+		try
+		{
+			// https://docs.microsoft.com/en-us/windows/win32/fileio/createiocompletionport
+			m_port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, m_settings.WorkerThreads);
+			if (m_port == nullptr)
+				throw Error::Win32Error(__FUNCSIG__ ": CreateIoCompletionPort() failed", GetLastError());
+			for (DWORD i = 0; i < m_settings.WorkerThreads; i++)
+			{
+				m_workers.push_back(std::make_unique<Thread>());
+				m_workers.back()->Start([this](void*) -> int { return (int)WorkerLoop(); });
+			}
+
+			// The first instance fails if the name is already taken, which
+			// is reported here rather than swallowed by ReplenishPending()
+			m_pendingCount = 1;
+			m_instanceCount = 1;
+			StartAccept(CreateInstance(true));
+			ReplenishPending();
+		}
+		catch (...)
+		{
+			Close();
+			DeleteCriticalSection(&m_cs);
+			throw;
+		}
+	}
+
+	void PooledNamedPipeServer::Close()
+	{
+		std::vector<std::shared_ptr<PipeSession>> sessions;
+		bool drained = true;
+		{
+			CriticalSectionLock cs(m_cs);
+			if (m_stopping)
+				return;
+			m_stopping = true;
+			sessions.reserve(m_sessions.size());
+			for (auto& [id, session] : m_sessions)
+				sessions.push_back(session);
+			drained = m_sessions.empty() && m_startingCount == 0;
+		}
+
+		for (std::shared_ptr<PipeSession>& session : sessions)
+			session->Close();
+		// Sessions leave the map as their cancelled operations complete.
+		// Sessions still being started see m_stopping once they are in
+		// the map and close themselves.
+		if (drained == false)
+			m_drained.WaitOnEvent(INFINITE, false);
+
+		for (size_t i = 0; i < m_workers.size(); i++)
+			PostQueuedCompletionStatus(m_port.GetHandle(), 0, ShutdownKey, nullptr);
+		for (std::unique_ptr<Thread>& worker : m_workers)
+			worker->Join(INFINITE);
+		m_workers.clear();
+		m_port.Close();
+	}
+
+	std::wstring PooledNamedPipeServer::GetName() const
+	{
+		return m_pipeName;
+	}
+
+	const PooledNamedPipeServerSettings& PooledNamedPipeServer::GetSettings() const noexcept
+	{
+		return m_settings;
+	}
+
+	size_t PooledNamedPipeServer::GetConnectedCount() const noexcept
+	{
+		return m_connectedCount;
+	}
+
+	size_t PooledNamedPipeServer::GetPendingCount()
+	{
+		CriticalSectionLock cs(m_cs);
+		return m_pendingCount;
+	}
+
+	size_t PooledNamedPipeServer::GetInstanceCount()
+	{
+		CriticalSectionLock cs(m_cs);
+		return m_instanceCount;
+	}
+
+	std::unique_ptr<OverlappedNamedPipeServer> PooledNamedPipeServer::CreateInstance(const bool isFirst)
+	{
+		auto pipe = std::make_unique<OverlappedNamedPipeServer>(
+			m_pipeName,
+			m_settings.BufferSize,
+			m_settings.MaxInstances,
+			m_settings.Sid,
+			false,
+			PIPE_ACCESS_DUPLEX
+				// Stops another process from creating the pipe first
+				| (isFirst ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0),
+			PIPE_TYPE_MESSAGE
+				| PIPE_READMODE_MESSAGE
+				| PIPE_WAIT
+				| (m_settings.IsLocalPipe
+					? PIPE_REJECT_REMOTE_CLIENTS
+					: PIPE_ACCEPT_REMOTE_CLIENTS)
+		);
+		const HANDLE pipeHandle = pipe->GetInternalHandle().GetHandle();
+		if (CreateIoCompletionPort(pipeHandle, m_port.GetHandle(), 0, 0) == nullptr)
+			throw Error::Win32Error(__FUNCSIG__ ": CreateIoCompletionPort() failed", GetLastError());
+		return pipe;
+	}
+
+	template<typename TFunc>
+	void PooledNamedPipeServer::InvokeHandler(PipeSession& session, const TFunc& invoke)
+	{
+		// An exception escaping a worker thread would end the process, so
+		// a failing handler ends its session instead
+		try
+		{
+			invoke(session.shared_from_this());
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": session handler failed: "
+				<< ex.what()
+				<< std::endl;
+			session.Close();
+		}
+	}
+
+	void PooledNamedPipeServer::StartAccept(std::unique_ptr<OverlappedNamedPipeServer> pipe)
+	{
+		std::shared_ptr<PipeSession> session;
+		{
+			CriticalSectionLock cs(m_cs);
+			session = std::shared_ptr<PipeSession>(
+				new PipeSession(
+					std::move(pipe),
+					m_nextId++,
+					m_settings.BufferSize,
+					m_settings.WriteLimits,
+					[this](PipeSession& writable)
+					{
+						if (m_handlers.OnWritable)
+							InvokeHandler(writable, [this](const std::shared_ptr<PipeSession>& shared) { m_handlers.OnWritable(shared); });
+					}
+				)
+			);
+		}
+
+		// The session's lock is held until the connect is issued so that
+		// Close() cannot cancel it before it starts
+		CriticalSectionLock sessionCs(session->m_cs);
+		{
+			CriticalSectionLock cs(m_cs);
+			m_sessions.emplace(session->GetId(), session);
+		}
+
+		OVERLAPPED* overlapped = &session->m_connectContext.Overlapped;
+		const HANDLE pipeHandle = session->GetPipeHandle();
+		// https://docs.microsoft.com/en-us/windows/win32/api/namedpipeapi/nf-namedpipeapi-connectnamedpipe
+		bool succeeded = ConnectNamedPipe(pipeHandle, overlapped);
+		DWORD lastError = succeeded ? ERROR_SUCCESS : GetLastError();
+		// A client connected and went away while the instance was being
+		// recycled, so clear it out and wait for the next one
+		if (lastError == ERROR_NO_DATA && DisconnectNamedPipe(pipeHandle))
+		{
+			succeeded = ConnectNamedPipe(pipeHandle, overlapped);
+			lastError = succeeded ? ERROR_SUCCESS : GetLastError();
+		}
+		// A client that connected before ConnectNamedPipe() was called
+		// doesn't queue a completion, so queue one ourselves
+		if (lastError == ERROR_SUCCESS || lastError == ERROR_PIPE_CONNECTED)
+		{
+			lastError = PostQueuedCompletionStatus(m_port.GetHandle(), 0, 0, overlapped)
+				? ERROR_IO_PENDING
+				: GetLastError();
+		}
+		if (lastError != ERROR_IO_PENDING)
+		{
+			CriticalSectionLock cs(m_cs);
+			m_sessions.erase(session->GetId());
+			throw Error::Win32Error(__FUNCSIG__ ": failed to wait for a client", lastError);
+		}
+		session->m_pendingOps++;
+
+		if (m_stopping)
+			session->BeginClose();
+	}
+
+	void PooledNamedPipeServer::ReplenishPending()
+	{
+		while (true)
+		{
+			{
+				CriticalSectionLock cs(m_cs);
+				if (m_stopping || m_pendingCount >= m_settings.PendingInstances)
+					return;
+				if (m_settings.MaxInstances != PIPE_UNLIMITED_INSTANCES && m_instanceCount >= m_settings.MaxInstances)
+					return;
+				m_pendingCount++;
+				m_instanceCount++;
+				m_startingCount++;
+			}
+
+			try
+			{
+				StartAccept(CreateInstance(false));
+				FinishStarting();
+			}
+			catch (const std::exception& ex)
+			{
+				// Another attempt is made when the next client connects
+				{
+					CriticalSectionLock cs(m_cs);
+					m_pendingCount--;
+					m_instanceCount--;
+				}
+				FinishStarting();
+				std::wcerr
+					<< __FUNCSIG__
+					<< L": failed to add a pipe instance: "
+					<< ex.what()
+					<< std::endl;
+				return;
+			}
+		}
+	}
+
+	UINT PooledNamedPipeServer::WorkerLoop()
+	{
+		while (true)
+		{
+			DWORD bytesTransferred = 0;
+			ULONG_PTR key = 0;
+			OVERLAPPED* overlapped = nullptr;
+			// https://docs.microsoft.com/en-us/windows/win32/api/ioapiset/nf-ioapiset-getqueuedcompletionstatus
+			const bool succeeded = GetQueuedCompletionStatus(
+				m_port.GetHandle(),
+				&bytesTransferred,
+				&key,
+				&overlapped,
+				INFINITE
+			);
+			if (overlapped == nullptr)
+			{
+				if (key == ShutdownKey)
+					return 0;
+				std::wcerr
+					<< __FUNCSIG__
+					<< L": GetQueuedCompletionStatus() failed: "
+					<< GetLastError()
+					<< std::endl;
+				return 1;
+			}
+
+			const DWORD error = succeeded ? ERROR_SUCCESS : GetLastError();
+			PipeSession::IoContext* context = CONTAINING_RECORD(overlapped, PipeSession::IoContext, Overlapped);
+			PipeSession& session = *context->Session;
+			switch (context->Type)
+			{
+				case PipeSession::Operation::Connect:
+					CompleteConnect(session, error);
+					break;
+				case PipeSession::Operation::Read:
+					CompleteRead(session, bytesTransferred, error);
+					break;
+				case PipeSession::Operation::Write:
+					session.CompleteWrite(error);
+					break;
+			}
+			ReleaseOp(session);
+		}
+	}
+
+	void PooledNamedPipeServer::CompleteConnect(PipeSession& session, const DWORD error)
+	{
+		{
+			CriticalSectionLock cs(m_cs);
+			m_pendingCount--;
+		}
+		{
+			CriticalSectionLock cs(session.m_cs);
+			if (error != ERROR_SUCCESS && error != ERROR_PIPE_CONNECTED)
+			{
+				session.BeginClose();
+				return;
+			}
+			if (session.m_closing)
+				return;
+			session.m_connected = true;
+		}
+		m_connectedCount++;
+		ReplenishPending();
+
+		if (m_handlers.OnConnected)
+			InvokeHandler(session, [this](const std::shared_ptr<PipeSession>& shared) { m_handlers.OnConnected(shared); });
+
+		CriticalSectionLock cs(session.m_cs);
+		session.IssueRead();
+	}
+
+	void PooledNamedPipeServer::CompleteRead(PipeSession& session, const DWORD bytesRead, const DWORD error)
+	{
+		if (error != ERROR_SUCCESS && error != ERROR_MORE_DATA)
+		{
+			// Includes the client disconnecting
+			CriticalSectionLock cs(session.m_cs);
+			session.BeginClose();
+			return;
+		}
+
+		session.m_received += bytesRead;
+		if (error == ERROR_MORE_DATA)
+		{
+			// Grow the buffer to fit the rest of the message
+			DWORD bytesLeft = 0;
+			const HANDLE pipe = session.GetPipeHandle();
+			if (PeekNamedPipe(pipe, nullptr, 0, nullptr, nullptr, &bytesLeft) == false || bytesLeft == 0)
+				bytesLeft = m_settings.BufferSize;
+			session.m_receiveBuffer.resize((size_t)session.m_received + bytesLeft);
+		}
+		else
+		{
+			const std::span<const std::byte> message(session.m_receiveBuffer.data(), session.m_received);
+			if (m_handlers.OnMessage)
+				InvokeHandler(session, [this, message](const std::shared_ptr<PipeSession>& shared) { m_handlers.OnMessage(shared, message); });
+			session.m_received = 0;
+		}
+
+		CriticalSectionLock cs(session.m_cs);
+		session.IssueRead();
+	}
+
+	void PooledNamedPipeServer::ReleaseOp(PipeSession& session)
+	{
+		bool finished = false;
+		{
+			CriticalSectionLock cs(session.m_cs);
+			session.m_pendingOps--;
+			finished = session.m_closing && session.m_pendingOps == 0;
+		}
+		if (finished)
+			Recycle(session);
+	}
+
+	void PooledNamedPipeServer::Recycle(PipeSession& session)
+	{
+		// Keep the session alive until this returns, as the map holds the
+		// only other reference
+		std::shared_ptr<PipeSession> shared = session.shared_from_this();
+		bool wasConnected = false;
+		std::unique_ptr<OverlappedNamedPipeServer> pipe;
+		{
+			CriticalSectionLock cs(session.m_cs);
+			wasConnected = session.m_connected;
+			session.m_connected = false;
+			session.m_writeQueue.clear();
+			pipe = std::move(session.m_pipe);
+		}
+		if (wasConnected)
+		{
+			m_connectedCount--;
+			if (m_handlers.OnDisconnected)
+				InvokeHandler(session, [this](const std::shared_ptr<PipeSession>& shared) { m_handlers.OnDisconnected(shared); });
+		}
+
+		bool reuse = false;
+		{
+			CriticalSectionLock cs(m_cs);
+			m_sessions.erase(session.GetId());
+			// Counted as starting under the same lock as the decision, so
+			// Close() can't see the server as drained in the meantime
+			if (m_stopping == false && m_pendingCount < m_settings.PendingInstances)
+			{
+				reuse = true;
+				m_pendingCount++;
+				m_startingCount++;
+			}
+			else
+			{
+				m_instanceCount--;
+			}
+			if (m_stopping && m_sessions.empty() && m_startingCount == 0)
+				m_drained.Signal();
+		}
+		if (reuse == false)
+			return;
+
+		try
+		{
+			pipe->Disconnect();
+			StartAccept(std::move(pipe));
+			FinishStarting();
+		}
+		catch (const std::exception& ex)
+		{
+			{
+				CriticalSectionLock cs(m_cs);
+				m_pendingCount--;
+				m_instanceCount--;
+			}
+			FinishStarting();
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": failed to reuse a pipe instance: "
+				<< ex.what()
+				<< std::endl;
+		}
+	}
+
+	void PooledNamedPipeServer::FinishStarting()
+	{
+		CriticalSectionLock cs(m_cs);
+		m_startingCount--;
+		if (m_stopping && m_sessions.empty() && m_startingCount == 0)
+			m_drained.Signal();
+	}
+}
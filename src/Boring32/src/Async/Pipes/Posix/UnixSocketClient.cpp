@@ -0,0 +1,74 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+#include <iostream>
+#include "include/Async/Pipes/UnixSocketClient.hpp"
+
+namespace Boring32::Async
+{
+	UnixSocketClient::~UnixSocketClient() { }
+
+	UnixSocketClient::UnixSocketClient() { }
+
+	UnixSocketClient::UnixSocketClient(const std::wstring& path)
+	:	UnixSocketConnection(path)
+	{ }
+
+	UnixSocketClient::UnixSocketClient(UnixSocketClient&& other) noexcept
+	:	UnixSocketConnection(std::move(other))
+	{ }
+
+	UnixSocketClient& UnixSocketClient::operator=(UnixSocketClient&& other) noexcept
+	{
+		Close();
+		Move(other);
+		return *this;
+	}
+
+	void UnixSocketClient::Connect()
+	{
+		if (m_socket != InvalidSocket)
+			throw std::runtime_error("UnixSocketClient::Connect(): already connected");
+
+		sockaddr_un address;
+		ToAddress(m_path, address);
+		const int s = CreateSocket();
+		// https://man7.org/linux/man-pages/man2/connect.2.html
+		if (connect(s, (const sockaddr*)&address, sizeof(address)) == -1)
+		{
+			const int lastError = errno;
+			close(s);
+			throw std::system_error(lastError, std::system_category(), "UnixSocketClient::Connect(): connect() failed");
+		}
+		m_socket = s;
+		try
+		{
+			WatchSocket();
+		}
+		catch (...)
+		{
+			Close();
+			throw;
+		}
+	}
+
+	bool UnixSocketClient::Connect(std::nothrow_t) noexcept
+	{
+		try
+		{
+			Connect();
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< L"UnixSocketClient::Connect(): Connect() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+}
@@ -0,0 +1,430 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <algorithm>
+#include <iostream>
+#include "include/Async/Pipes/UnixSocketConnection.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		std::system_error LastError(const char* msg)
+		{
+			return std::system_error(errno, std::system_category(), msg);
+		}
+
+		// wchar_t holds UTF-32 on Linux
+		std::string ToUtf8(const std::wstring& str)
+		{
+			std::string utf8;
+			for (const wchar_t c : str)
+			{
+				const std::uint32_t codePoint = static_cast<std::uint32_t>(c);
+				if (codePoint < 0x80)
+				{
+					utf8 += (char)codePoint;
+				}
+				else if (codePoint < 0x800)
+				{
+					utf8 += (char)(0xC0 | (codePoint >> 6));
+					utf8 += (char)(0x80 | (codePoint & 0x3F));
+				}
+				else if (codePoint < 0x10000)
+				{
+					utf8 += (char)(0xE0 | (codePoint >> 12));
+					utf8 += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+					utf8 += (char)(0x80 | (codePoint & 0x3F));
+				}
+				else if (codePoint < 0x110000)
+				{
+					utf8 += (char)(0xF0 | (codePoint >> 18));
+					utf8 += (char)(0x80 | ((codePoint >> 12) & 0x3F));
+					utf8 += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+					utf8 += (char)(0x80 | (codePoint & 0x3F));
+				}
+				else
+				{
+					throw std::invalid_argument("ToUtf8(): the string is not valid UTF-32");
+				}
+			}
+			return utf8;
+		}
+
+		// An iovec for the length prefix followed by one for each non-empty
+		// piece, held inline unless there are many pieces
+		struct IoVectors
+		{
+			template<typename TByte>
+			IoVectors(std::uint32_t& header, const std::span<const std::span<TByte>> pieces)
+			{
+				if (pieces.size() >= IOV_MAX)
+					throw std::invalid_argument("UnixSocketConnection: too many pieces");
+				if (pieces.size() + 1 > std::size(Inline))
+				{
+					Heap.resize(pieces.size() + 1);
+					Buffers = Heap.data();
+				}
+				Buffers[Count++] = { .iov_base = &header, .iov_len = UnixSocketConnection::HeaderSize };
+				for (const std::span<TByte> piece : pieces)
+				{
+					if (piece.empty() == false)
+						Buffers[Count++] = { .iov_base = (void*)piece.data(), .iov_len = piece.size() };
+				}
+			}
+
+			iovec Inline[8];
+			std::vector<iovec> Heap;
+			iovec* Buffers = Inline;
+			size_t Count = 0;
+		};
+
+		// Returns the number of bytes received, retrying if interrupted
+		ssize_t Receive(const int socket, msghdr& message, const int flags)
+		{
+			while (true)
+			{
+				// https://man7.org/linux/man-pages/man2/recvmsg.2.html
+				const ssize_t bytesRead = recvmsg(socket, &message, flags);
+				if (bytesRead >= 0)
+					return bytesRead;
+				if (errno != EINTR)
+					throw LastError("UnixSocketConnection: recvmsg() failed");
+			}
+		}
+	}
+
+	UnixSocketConnection::~UnixSocketConnection()
+	{
+		Close();
+	}
+
+	UnixSocketConnection::UnixSocketConnection()
+	:	m_socket(InvalidSocket),
+		m_maxMessageSize(DefaultMaxMessageSize),
+		m_epoll(-1)
+	{ }
+
+	UnixSocketConnection::UnixSocketConnection(const std::wstring& path)
+	:	m_path(path),
+		m_socket(InvalidSocket),
+		m_maxMessageSize(DefaultMaxMessageSize),
+		m_epoll(-1)
+	{ }
+
+	UnixSocketConnection::UnixSocketConnection(UnixSocketConnection&& other) noexcept
+	:	m_socket(InvalidSocket),
+		m_maxMessageSize(DefaultMaxMessageSize),
+		m_epoll(-1)
+	{
+		Move(other);
+	}
+
+	UnixSocketConnection& UnixSocketConnection::operator=(UnixSocketConnection&& other) noexcept
+	{
+		Close();
+		Move(other);
+		return *this;
+	}
+
+	void UnixSocketConnection::Move(UnixSocketConnection& other) noexcept
+	{
+		m_path = std::move(other.m_path);
+		m_socket = other.m_socket;
+		other.m_socket = InvalidSocket;
+		m_maxMessageSize = other.m_maxMessageSize;
+		m_epoll = other.m_epoll;
+		other.m_epoll = -1;
+	}
+
+	void UnixSocketConnection::Write(const std::wstring& msg)
+	{
+		SendFrame(msg.data(), msg.size() * sizeof(wchar_t));
+	}
+
+	bool UnixSocketConnection::Write(const std::wstring& msg, std::nothrow_t) noexcept
+	{
+		try
+		{
+			Write(msg);
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< L"UnixSocketConnection::Write(): Write() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	void UnixSocketConnection::Write(const std::span<const std::byte> data)
+	{
+		SendFrame(data.data(), data.size());
+	}
+
+	bool UnixSocketConnection::Write(const std::span<const std::byte> data, std::nothrow_t) noexcept
+	{
+		try
+		{
+			Write(data);
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< L"UnixSocketConnection::Write(): Write() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	void UnixSocketConnection::WriteGather(const std::span<const std::span<const std::byte>> pieces)
+	{
+		SendFrame(pieces);
+	}
+
+	std::wstring UnixSocketConnection::Read()
+	{
+		const std::uint32_t size = ReceiveHeader();
+		// The message is read before being rejected, so the next one
+		// can still be read
+		std::wstring msg((size + sizeof(wchar_t) - 1) / sizeof(wchar_t), L'\0');
+		ReceiveExact(msg.data(), size);
+		if (size % sizeof(wchar_t) != 0)
+			throw std::runtime_error("UnixSocketConnection::Read(): message is not a wide string");
+		return msg;
+	}
+
+	bool UnixSocketConnection::Read(std::wstring& out, std::nothrow_t) noexcept
+	{
+		try
+		{
+			out = Read();
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< L"UnixSocketConnection::Read(): Read() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	std::vector<std::byte> UnixSocketConnection::ReadBytes()
+	{
+		std::vector<std::byte> msg(ReceiveHeader());
+		ReceiveExact(msg.data(), msg.size());
+		return msg;
+	}
+
+	size_t UnixSocketConnection::ReadScatter(const std::span<const std::span<std::byte>> pieces)
+	{
+		if (m_socket == InvalidSocket)
+			throw std::runtime_error("UnixSocketConnection::ReadScatter(): not connected");
+
+		// The prefix and pieces are filled by one call, so unlike Read()
+		// there is no need to peek at the size first
+		std::uint32_t header = 0;
+		IoVectors buffers(header, pieces);
+		msghdr message{};
+		message.msg_iov = buffers.Buffers;
+		message.msg_iovlen = buffers.Count;
+		const ssize_t bytesRead = Receive(m_socket, message, 0);
+		if (bytesRead == 0)
+			throw std::runtime_error("UnixSocketConnection::ReadScatter(): the connection was closed");
+		// The kernel discards the rest of a packet that doesn't fit
+		if (message.msg_flags & MSG_TRUNC)
+			throw std::runtime_error("UnixSocketConnection::ReadScatter(): message is larger than the pieces");
+		if ((size_t)bytesRead < HeaderSize || header != (size_t)bytesRead - HeaderSize)
+			throw std::runtime_error("UnixSocketConnection::ReadScatter(): the message is malformed");
+		return header;
+	}
+
+	bool UnixSocketConnection::WaitForRead(const std::uint32_t timeoutMillis)
+	{
+		if (m_socket == InvalidSocket)
+			throw std::runtime_error("UnixSocketConnection::WaitForRead(): not connected");
+
+		const int timeout = timeoutMillis == Infinite
+			? -1
+			: (int)(std::min)(timeoutMillis, (std::uint32_t)INT_MAX);
+		epoll_event event{};
+		while (true)
+		{
+			// https://man7.org/linux/man-pages/man2/epoll_wait.2.html
+			const int result = epoll_wait(m_epoll, &event, 1, timeout);
+			// A closed connection is reported as EPOLLRDHUP, which also
+			// makes the next Read() return promptly, with an error
+			if (result >= 0)
+				return result > 0;
+			if (errno != EINTR)
+				throw LastError("UnixSocketConnection::WaitForRead(): epoll_wait() failed");
+		}
+	}
+
+	void UnixSocketConnection::Close()
+	{
+		if (m_socket != InvalidSocket)
+		{
+			close(m_socket);
+			m_socket = InvalidSocket;
+		}
+		if (m_epoll != -1)
+		{
+			close(m_epoll);
+			m_epoll = -1;
+		}
+	}
+
+	bool UnixSocketConnection::IsConnected() const noexcept
+	{
+		return m_socket != InvalidSocket;
+	}
+
+	const std::wstring& UnixSocketConnection::GetPath() const noexcept
+	{
+		return m_path;
+	}
+
+	UnixSocketHandle UnixSocketConnection::GetSocket() const noexcept
+	{
+		return m_socket;
+	}
+
+	void UnixSocketConnection::SetMaxMessageSize(const std::uint32_t maxMessageSize)
+	{
+		m_maxMessageSize = maxMessageSize;
+	}
+
+	std::uint32_t UnixSocketConnection::GetMaxMessageSize() const noexcept
+	{
+		return m_maxMessageSize;
+	}
+
+	void UnixSocketConnection::SendFrame(const void* data, const size_t size)
+	{
+		const std::span<const std::byte> piece(static_cast<const std::byte*>(data), size);
+		SendFrame(std::span<const std::span<const std::byte>>(&piece, 1));
+	}
+
+	void UnixSocketConnection::SendFrame(const std::span<const std::span<const std::byte>> pieces)
+	{
+		if (m_socket == InvalidSocket)
+			throw std::runtime_error("UnixSocketConnection::SendFrame(): not connected");
+		size_t size = 0;
+		for (const std::span<const std::byte> piece : pieces)
+			size += piece.size();
+		if (size > UINT32_MAX)
+			throw std::invalid_argument("UnixSocketConnection::SendFrame(): message is too large");
+
+		// The prefix and pieces go out as one packet, without being
+		// copied, and a packet is sent whole or not at all
+		std::uint32_t header = (std::uint32_t)size;
+		IoVectors buffers(header, pieces);
+		msghdr message{};
+		message.msg_iov = buffers.Buffers;
+		message.msg_iovlen = buffers.Count;
+		// https://man7.org/linux/man-pages/man2/sendmsg.2.html
+		// MSG_NOSIGNAL reports a closed connection as EPIPE, not SIGPIPE
+		while (sendmsg(m_socket, &message, MSG_NOSIGNAL) == -1)
+		{
+			if (errno != EINTR)
+				throw LastError("UnixSocketConnection::SendFrame(): sendmsg() failed");
+		}
+	}
+
+	std::uint32_t UnixSocketConnection::ReceiveHeader()
+	{
+		if (m_socket == InvalidSocket)
+			throw std::runtime_error("UnixSocketConnection::ReceiveHeader(): not connected");
+
+		// Peeking leaves the packet queued for ReceiveExact()
+		std::uint32_t header = 0;
+		iovec buffer{ .iov_base = &header, .iov_len = HeaderSize };
+		msghdr message{};
+		message.msg_iov = &buffer;
+		message.msg_iovlen = 1;
+		const ssize_t bytesRead = Receive(m_socket, message, MSG_PEEK);
+		if (bytesRead == 0)
+			throw std::runtime_error("UnixSocketConnection::ReceiveHeader(): the connection was closed");
+		if (bytesRead == HeaderSize && header <= m_maxMessageSize)
+			return header;
+
+		// Receiving into the header alone discards the rest of the packet
+		Receive(m_socket, message, 0);
+		if (bytesRead != HeaderSize)
+			throw std::runtime_error("UnixSocketConnection::ReceiveHeader(): the message has no header");
+		throw std::runtime_error("UnixSocketConnection::ReceiveHeader(): message exceeds the maximum message size");
+	}
+
+	void UnixSocketConnection::ReceiveExact(void* buffer, const size_t size)
+	{
+		if (m_socket == InvalidSocket)
+			throw std::runtime_error("UnixSocketConnection::ReceiveExact(): not connected");
+
+		std::uint32_t header = 0;
+		iovec buffers[] = {
+			{ .iov_base = &header, .iov_len = HeaderSize },
+			{ .iov_base = buffer, .iov_len = size }
+		};
+		msghdr message{};
+		message.msg_iov = buffers;
+		message.msg_iovlen = 2;
+		const ssize_t bytesRead = Receive(m_socket, message, 0);
+		if (bytesRead == 0)
+			throw std::runtime_error("UnixSocketConnection::ReceiveExact(): the connection was closed");
+		if ((message.msg_flags & MSG_TRUNC) || header != size || (size_t)bytesRead != HeaderSize + size)
+			throw std::runtime_error("UnixSocketConnection::ReceiveExact(): the message is malformed");
+	}
+
+	void UnixSocketConnection::WatchSocket()
+	{
+		if (m_epoll == -1)
+		{
+			// https://man7.org/linux/man-pages/man2/epoll_create.2.html
+			m_epoll = epoll_create1(EPOLL_CLOEXEC);
+			if (m_epoll == -1)
+				throw LastError("UnixSocketConnection::WatchSocket(): epoll_create1() failed");
+		}
+		epoll_event event{};
+		event.events = EPOLLIN | EPOLLRDHUP;
+		// https://man7.org/linux/man-pages/man2/epoll_ctl.2.html
+		if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_socket, &event) == -1)
+			throw LastError("UnixSocketConnection::WatchSocket(): epoll_ctl() failed");
+	}
+
+	UnixSocketHandle UnixSocketConnection::CreateSocket()
+	{
+		// Unlike on Windows, SOCK_SEQPACKET keeps message boundaries
+		// https://man7.org/linux/man-pages/man7/unix.7.html
+		const int s = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+		if (s == -1)
+			throw LastError("UnixSocketConnection::CreateSocket(): socket() failed");
+		return s;
+	}
+
+	void UnixSocketConnection::ToAddress(const std::wstring& path, sockaddr_un& address)
+	{
+		if (path.empty())
+			throw std::invalid_argument("UnixSocketConnection::ToAddress(): path must be specified");
+
+		const std::string utf8 = ToUtf8(path);
+		// Leave room for the null terminator
+		address = sockaddr_un{};
+		if (utf8.size() > sizeof(address.sun_path) - 1)
+			throw std::invalid_argument("UnixSocketConnection::ToAddress(): path is too long");
+		address.sun_family = AF_UNIX;
+		memcpy(address.sun_path, utf8.data(), utf8.size());
+	}
+}
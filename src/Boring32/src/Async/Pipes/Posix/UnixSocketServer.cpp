@@ -0,0 +1,203 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <climits>
+#include <chrono>
+#include <stdexcept>
+#include <system_error>
+#include <algorithm>
+#include "include/Async/Pipes/UnixSocketServer.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		std::system_error LastError(const char* msg)
+		{
+			return std::system_error(errno, std::system_category(), msg);
+		}
+	}
+
+	UnixSocketServer::Listener::~Listener()
+	{
+		if (Socket != InvalidSocket)
+			close(Socket);
+		if (Epoll != -1)
+			close(Epoll);
+		// The socket file outlives its socket. The path was checked when
+		// the listener was bound, so this won't throw.
+		if (Path.empty() == false)
+		{
+			sockaddr_un address;
+			ToAddress(Path, address);
+			unlink(address.sun_path);
+		}
+	}
+
+	UnixSocketServer::~UnixSocketServer()
+	{
+		Close();
+	}
+
+	UnixSocketServer::UnixSocketServer() { }
+
+	UnixSocketServer::UnixSocketServer(const std::wstring& path, const std::uint32_t maxInstances)
+	:	UnixSocketConnection(path)
+	{
+		if (maxInstances == 0)
+			throw std::invalid_argument("UnixSocketServer::UnixSocketServer(): maxInstances must be greater than 0");
+
+		sockaddr_un address;
+		ToAddress(path, address);
+		auto listener = std::make_shared<Listener>();
+		listener->Socket = CreateSocket();
+		listener->MaxInstances = maxInstances;
+
+		// A stale file from a server that exited without cleaning up
+		// would otherwise make bind() fail
+		unlink(address.sun_path);
+		// https://man7.org/linux/man-pages/man2/bind.2.html
+		if (bind(listener->Socket, (const sockaddr*)&address, sizeof(address)) == -1)
+			throw LastError("UnixSocketServer::UnixSocketServer(): bind() failed");
+		listener->Path = path;
+
+		// https://man7.org/linux/man-pages/man2/listen.2.html
+		if (listen(listener->Socket, (int)(std::min)(maxInstances, (std::uint32_t)SOMAXCONN)) == -1)
+			throw LastError("UnixSocketServer::UnixSocketServer(): listen() failed");
+
+		// Instances share the listener, so several can be waiting in
+		// Connect() at once. Making it non-blocking lets the ones that
+		// lose the race for a client go back to waiting.
+		const int flags = fcntl(listener->Socket, F_GETFL);
+		if (flags == -1 || fcntl(listener->Socket, F_SETFL, flags | O_NONBLOCK) == -1)
+			throw LastError("UnixSocketServer::UnixSocketServer(): fcntl() failed");
+
+		listener->Epoll = epoll_create1(EPOLL_CLOEXEC);
+		if (listener->Epoll == -1)
+			throw LastError("UnixSocketServer::UnixSocketServer(): epoll_create1() failed");
+		epoll_event event{};
+		event.events = EPOLLIN;
+		if (epoll_ctl(listener->Epoll, EPOLL_CTL_ADD, listener->Socket, &event) == -1)
+			throw LastError("UnixSocketServer::UnixSocketServer(): epoll_ctl() failed");
+
+		listener->Instances = 1;
+		m_listener = std::move(listener);
+	}
+
+	UnixSocketServer::UnixSocketServer(std::shared_ptr<Listener> listener)
+	:	UnixSocketConnection(listener->Path),
+		m_listener(std::move(listener))
+	{ }
+
+	UnixSocketServer::UnixSocketServer(UnixSocketServer&& other) noexcept
+	:	UnixSocketConnection(std::move(other)),
+		m_listener(std::move(other.m_listener))
+	{ }
+
+	UnixSocketServer& UnixSocketServer::operator=(UnixSocketServer&& other) noexcept
+	{
+		Close();
+		Move(other);
+		m_listener = std::move(other.m_listener);
+		return *this;
+	}
+
+	UnixSocketServer UnixSocketServer::CreateInstance()
+	{
+		if (m_listener == nullptr)
+			throw std::runtime_error("UnixSocketServer::CreateInstance(): the server is closed");
+
+		std::uint32_t instances = m_listener->Instances;
+		do
+		{
+			if (instances >= m_listener->MaxInstances)
+				throw std::runtime_error("UnixSocketServer::CreateInstance(): the maximum number of instances already exist");
+		} while (m_listener->Instances.compare_exchange_weak(instances, instances + 1) == false);
+
+		UnixSocketServer instance(m_listener);
+		instance.m_maxMessageSize = m_maxMessageSize;
+		return instance;
+	}
+
+	void UnixSocketServer::Connect()
+	{
+		Connect(Infinite);
+	}
+
+	bool UnixSocketServer::Connect(const std::uint32_t timeoutMillis)
+	{
+		if (m_listener == nullptr)
+			throw std::runtime_error("UnixSocketServer::Connect(): the server is closed");
+		if (m_socket != InvalidSocket)
+			throw std::runtime_error("UnixSocketServer::Connect(): already connected");
+
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMillis);
+		while (true)
+		{
+			// https://man7.org/linux/man-pages/man2/accept.2.html
+			// Unlike on Windows, the accepted socket is blocking whatever
+			// the listener's mode
+			const int client = accept4(m_listener->Socket, nullptr, nullptr, SOCK_CLOEXEC);
+			if (client != -1)
+			{
+				m_socket = client;
+				try
+				{
+					WatchSocket();
+				}
+				catch (...)
+				{
+					UnixSocketConnection::Close();
+					throw;
+				}
+				return true;
+			}
+			// The client may have given up before being accepted
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED)
+				throw LastError("UnixSocketServer::Connect(): accept4() failed");
+
+			int timeout = -1;
+			if (timeoutMillis != Infinite)
+			{
+				const auto now = std::chrono::steady_clock::now();
+				if (now >= deadline)
+					return false;
+				const std::int64_t remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count();
+				timeout = (int)(std::min)(remaining, (std::int64_t)INT_MAX);
+			}
+			// The listener is level-triggered, so an instance woken for a
+			// client another one accepted just waits again
+			epoll_event event{};
+			if (epoll_wait(m_listener->Epoll, &event, 1, timeout) == -1 && errno != EINTR)
+				throw LastError("UnixSocketServer::Connect(): epoll_wait() failed");
+		}
+	}
+
+	void UnixSocketServer::Disconnect()
+	{
+		UnixSocketConnection::Close();
+	}
+
+	void UnixSocketServer::Close()
+	{
+		Disconnect();
+		if (m_listener != nullptr)
+		{
+			m_listener->Instances--;
+			m_listener = nullptr;
+		}
+	}
+
+	std::uint32_t UnixSocketServer::GetMaxInstances() const noexcept
+	{
+		return m_listener != nullptr ? m_listener->MaxInstances : 0;
+	}
+
+	std::uint32_t UnixSocketServer::GetInstanceCount() const noexcept
+	{
+		return m_listener != nullptr ? m_listener->Instances.load() : 0;
+	}
+}
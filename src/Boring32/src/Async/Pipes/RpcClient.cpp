@@ -0,0 +1,243 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <cstring>
+#include "include/Async/CriticalSectionLock.hpp"
+#include "include/Async/Pipes/RpcClient.hpp"
+
+namespace Boring32::Async
+{
+	RpcClient::~RpcClient()
+	{
+		Close();
+		DeleteCriticalSection(&m_sendCs);
+		DeleteCriticalSection(&m_cs);
+	}
+
+	RpcClient::RpcClient(NamedPipeClientBase& client)
+	:	RpcClient(client, RpcClientSettings{})
+	{ }
+
+	RpcClient::RpcClient(NamedPipeClientBase& client, const RpcClientSettings& settings)
+	:	m_settings(settings),
+		m_channel(client, settings.Channel),
+		m_nextId(1),
+		m_stopping(false),
+		m_open(true)
+	{
+		if (m_settings.TimerResolutionMillis == 0 || m_settings.TimerResolutionMillis == INFINITE)
+			throw std::invalid_argument(__FUNCSIG__ ": TimerResolutionMillis must be finite and greater than 0");
+		InitializeCriticalSection(&m_cs);
+		InitializeCriticalSection(&m_sendCs);
+		try
+		{
+			m_receiver.Start([this](void*) -> int { return (int)ReceiveLoop(); });
+		}
+		catch (...)
+		{
+			DeleteCriticalSection(&m_sendCs);
+			DeleteCriticalSection(&m_cs);
+			throw;
+		}
+	}
+
+	RpcCall RpcClient::Call(const UINT32 method, const std::span<const std::byte> request)
+	{
+		return Call(method, request, m_settings.TimeoutMillis);
+	}
+
+	RpcCall RpcClient::Call(
+		const UINT32 method,
+		const std::span<const std::byte> request,
+		const DWORD timeoutMillis
+	)
+	{
+		if (request.size() > GetMaxRequestSize())
+			throw std::invalid_argument(__FUNCSIG__ ": request is larger than a frame");
+
+		RpcCall call{ .Id = m_nextId++ };
+		{
+			CriticalSectionLock cs(m_cs);
+			if (m_open == false)
+				throw RpcError(RpcErrorCode::Disconnected, __FUNCSIG__ ": the client is closed");
+			PendingCall& pending = m_pending[call.Id];
+			pending.Deadline = timeoutMillis == INFINITE ? MAXUINT64 : GetTickCount64() + timeoutMillis;
+			call.Result = pending.Promise.get_future();
+		}
+
+		try
+		{
+			Send({ .CorrelationId = call.Id, .Method = method, .Kind = RpcMessageKind::Request }, request);
+		}
+		catch (...)
+		{
+			CriticalSectionLock cs(m_cs);
+			m_pending.erase(call.Id);
+			throw;
+		}
+		return call;
+	}
+
+	bool RpcClient::Cancel(const UINT64 id)
+	{
+		PendingCall call;
+		{
+			CriticalSectionLock cs(m_cs);
+			const auto it = m_pending.find(id);
+			if (it == m_pending.end())
+				return false;
+			call = std::move(it->second);
+			m_pending.erase(it);
+		}
+		call.Promise.set_exception(
+			std::make_exception_ptr(RpcError(RpcErrorCode::Cancelled, __FUNCSIG__ ": the call was cancelled"))
+		);
+
+		// The call has already failed, so telling the server is best effort
+		try
+		{
+			Send({ .CorrelationId = id, .Kind = RpcMessageKind::Cancel }, {});
+		}
+		catch (const std::exception&) { }
+		return true;
+	}
+
+	void RpcClient::Close()
+	{
+		m_stopping = true;
+		if (m_receiver.GetStatus() != ThreadStatus::Ready)
+			m_receiver.Join(INFINITE);
+		FailAll(RpcErrorCode::Cancelled, __FUNCSIG__ ": the client was closed");
+	}
+
+	bool RpcClient::IsConnected() const noexcept
+	{
+		return m_channel.IsConnected();
+	}
+
+	size_t RpcClient::GetPendingCount()
+	{
+		CriticalSectionLock cs(m_cs);
+		return m_pending.size();
+	}
+
+	size_t RpcClient::GetMaxRequestSize() const noexcept
+	{
+		return m_channel.GetMaxFrameSize() - sizeof(RpcHeader);
+	}
+
+	const RpcClientSettings& RpcClient::GetSettings() const noexcept
+	{
+		return m_settings;
+	}
+
+	UINT RpcClient::ReceiveLoop()
+	{
+		try
+		{
+			UINT64 nextExpiry = GetTickCount64() + m_settings.TimerResolutionMillis;
+			while (m_stopping == false)
+			{
+				const PipeFrame frame = m_channel.Receive(m_settings.TimerResolutionMillis);
+				if (frame.IsValid())
+				{
+					Complete(frame);
+				}
+				else if (m_channel.IsConnected() == false)
+				{
+					FailAll(RpcErrorCode::Disconnected, __FUNCSIG__ ": the server closed the pipe");
+					return 0;
+				}
+
+				// Expiry is checked on a schedule rather than per frame, so
+				// a busy connection does not scan the calls constantly
+				if (GetTickCount64() >= nextExpiry)
+				{
+					ExpireCalls();
+					nextExpiry = GetTickCount64() + m_settings.TimerResolutionMillis;
+				}
+			}
+			return 0;
+		}
+		catch (const std::exception& ex)
+		{
+			FailAll(RpcErrorCode::Disconnected, ex.what());
+			return 1;
+		}
+	}
+
+	void RpcClient::Complete(const PipeFrame& frame)
+	{
+		// Frames too short to be responses are not from an RpcServer
+		if (frame.GetSize() < sizeof(RpcHeader))
+			return;
+		RpcHeader header;
+		std::memcpy(&header, frame.GetData().data(), sizeof(header));
+
+		PendingCall call;
+		{
+			CriticalSectionLock cs(m_cs);
+			const auto it = m_pending.find(header.CorrelationId);
+			// Responses to calls that timed out or were cancelled are dropped
+			if (it == m_pending.end())
+				return;
+			call = std::move(it->second);
+			m_pending.erase(it);
+		}
+
+		const std::span<const std::byte> payload = frame.GetData().subspan(sizeof(RpcHeader));
+		if (header.Kind == RpcMessageKind::Error)
+		{
+			const std::string message(reinterpret_cast<const char*>(payload.data()), payload.size());
+			call.Promise.set_exception(std::make_exception_ptr(RpcError(RpcErrorCode::Remote, message)));
+			return;
+		}
+		call.Promise.set_value(std::vector<std::byte>(payload.begin(), payload.end()));
+	}
+
+	void RpcClient::ExpireCalls()
+	{
+		const UINT64 now = GetTickCount64();
+		std::vector<PendingCall> expired;
+		{
+			CriticalSectionLock cs(m_cs);
+			for (auto it = m_pending.begin(); it != m_pending.end();)
+			{
+				if (it->second.Deadline > now)
+				{
+					++it;
+					continue;
+				}
+				expired.push_back(std::move(it->second));
+				it = m_pending.erase(it);
+			}
+		}
+		for (PendingCall& call : expired)
+			call.Promise.set_exception(
+				std::make_exception_ptr(RpcError(RpcErrorCode::Timeout, __FUNCSIG__ ": the call timed out"))
+			);
+	}
+
+	void RpcClient::FailAll(const RpcErrorCode code, const std::string& message)
+	{
+		std::unordered_map<UINT64, PendingCall> pending;
+		{
+			CriticalSectionLock cs(m_cs);
+			m_open = false;
+			pending.swap(m_pending);
+		}
+		for (auto& [id, call] : pending)
+			call.Promise.set_exception(std::make_exception_ptr(RpcError(code, message)));
+	}
+
+	void RpcClient::Send(const RpcHeader& header, const std::span<const std::byte> payload)
+	{
+		// Requests are small and a frame must be contiguous, so the header
+		// and payload are joined in a buffer reused across calls
+		CriticalSectionLock cs(m_sendCs);
+		m_sendBuffer.resize(sizeof(RpcHeader) + payload.size());
+		std::memcpy(m_sendBuffer.data(), &header, sizeof(RpcHeader));
+		if (!payload.empty())
+			std::memcpy(m_sendBuffer.data() + sizeof(RpcHeader), payload.data(), payload.size());
+		m_channel.Send(m_sendBuffer);
+	}
+}
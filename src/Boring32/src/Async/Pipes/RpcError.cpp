@@ -0,0 +1,17 @@
+#include "pch.hpp"
+#include "include/Async/Pipes/RpcError.hpp"
+
+namespace Boring32::Async
+{
+	RpcError::~RpcError() { }
+
+	RpcError::RpcError(const RpcErrorCode code, const std::string& message)
+	:	std::runtime_error(message),
+		m_code(code)
+	{ }
+
+	RpcErrorCode RpcError::GetCode() const noexcept
+	{
+		return m_code;
+	}
+}
@@ -0,0 +1,242 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <iostream>
+#include <cstring>
+#include <string_view>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/CriticalSectionLock.hpp"
+#include "include/Async/Pipes/RpcServer.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		// How often the receiving thread checks whether to stop
+		constexpr DWORD StopCheckMillis = 50;
+	}
+
+	RpcServer::~RpcServer()
+	{
+		Close();
+		DeleteCriticalSection(&m_sendCs);
+		DeleteCriticalSection(&m_cs);
+	}
+
+	RpcServer::RpcServer(NamedPipeServerBase& server, RpcHandler handler)
+	:	RpcServer(server, std::move(handler), RpcServerSettings{})
+	{ }
+
+	RpcServer::RpcServer(NamedPipeServerBase& server, RpcHandler handler, const RpcServerSettings& settings)
+	:	m_settings(settings),
+		m_handler(std::move(handler)),
+		m_channel(server, settings.Channel),
+		m_requestCount(0),
+		m_stopping(false),
+		m_closed(false)
+	{
+		if (m_handler == nullptr)
+			throw std::invalid_argument(__FUNCSIG__ ": handler is nullptr");
+		if (m_settings.WorkerThreads == 0)
+			throw std::invalid_argument(__FUNCSIG__ ": WorkerThreads must be greater than 0");
+
+		InitializeCriticalSection(&m_cs);
+		InitializeCriticalSection(&m_sendCs);
+		try
+		{
+			// The port is used as a queue of received requests
+			// https://docs.microsoft.com/en-us/windows/win32/fileio/createiocompletionport
+			m_port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, m_settings.WorkerThreads);
+			if (m_port == nullptr)
+				throw Error::Win32Error(__FUNCSIG__ ": CreateIoCompletionPort() failed", GetLastError());
+			for (DWORD i = 0; i < m_settings.WorkerThreads; i++)
+			{
+				m_workers.push_back(std::make_unique<Thread>());
+				m_workers.back()->Start([this](void*) -> int { return (int)WorkerLoop(); });
+			}
+			m_receiver.Start([this](void*) -> int { return (int)ReceiveLoop(); });
+		}
+		catch (...)
+		{
+			Close();
+			DeleteCriticalSection(&m_sendCs);
+			DeleteCriticalSection(&m_cs);
+			throw;
+		}
+	}
+
+	void RpcServer::Close()
+	{
+		{
+			CriticalSectionLock cs(m_cs);
+			if (m_closed)
+				return;
+			m_closed = true;
+		}
+
+		m_stopping = true;
+		if (m_receiver.GetStatus() != ThreadStatus::Ready)
+			m_receiver.Join(INFINITE);
+		// The port is first in, first out, so the workers handle every
+		// queued request before they reach a shutdown packet
+		for (size_t i = 0; i < m_workers.size(); i++)
+			PostQueuedCompletionStatus(m_port.GetHandle(), 0, ShutdownKey, nullptr);
+		for (std::unique_ptr<Thread>& worker : m_workers)
+			worker->Join(INFINITE);
+		m_workers.clear();
+		m_port.Close();
+	}
+
+	bool RpcServer::IsConnected() const noexcept
+	{
+		return m_channel.IsConnected();
+	}
+
+	UINT64 RpcServer::GetRequestCount() const noexcept
+	{
+		return m_requestCount;
+	}
+
+	const RpcServerSettings& RpcServer::GetSettings() const noexcept
+	{
+		return m_settings;
+	}
+
+	UINT RpcServer::ReceiveLoop()
+	{
+		try
+		{
+			while (m_stopping == false)
+			{
+				PipeFrame frame = m_channel.Receive(StopCheckMillis);
+				if (frame.IsValid())
+					Dispatch(std::move(frame));
+				else if (m_channel.IsConnected() == false)
+					return 0;
+			}
+			return 0;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": receiving failed: "
+				<< ex.what()
+				<< std::endl;
+			return 1;
+		}
+	}
+
+	void RpcServer::Dispatch(PipeFrame frame)
+	{
+		// Frames too short to be requests are not from an RpcClient
+		if (frame.GetSize() < sizeof(RpcHeader))
+			return;
+		RpcHeader header;
+		std::memcpy(&header, frame.GetData().data(), sizeof(header));
+
+		if (header.Kind == RpcMessageKind::Cancel)
+		{
+			CriticalSectionLock cs(m_cs);
+			if (m_inFlight.contains(header.CorrelationId))
+				m_cancelled.insert(header.CorrelationId);
+			return;
+		}
+		if (header.Kind != RpcMessageKind::Request)
+			return;
+
+		// The frame keeps its receive buffer until the request is handled,
+		// so requests are not copied
+		auto request = std::make_unique<PendingRequest>(PendingRequest{ header, std::move(frame) });
+		{
+			CriticalSectionLock cs(m_cs);
+			m_inFlight.insert(header.CorrelationId);
+		}
+		// https://docs.microsoft.com/en-us/windows/win32/fileio/postqueuedcompletionstatus
+		if (!PostQueuedCompletionStatus(m_port.GetHandle(), 0, 0, reinterpret_cast<OVERLAPPED*>(request.get())))
+		{
+			const DWORD lastError = GetLastError();
+			CriticalSectionLock cs(m_cs);
+			m_inFlight.erase(header.CorrelationId);
+			throw Error::Win32Error(__FUNCSIG__ ": PostQueuedCompletionStatus() failed", lastError);
+		}
+		request.release();
+	}
+
+	UINT RpcServer::WorkerLoop()
+	{
+		while (true)
+		{
+			DWORD bytes = 0;
+			ULONG_PTR key = 0;
+			OVERLAPPED* overlapped = nullptr;
+			// https://docs.microsoft.com/en-us/windows/win32/api/ioapiset/nf-ioapiset-getqueuedcompletionstatus
+			if (!GetQueuedCompletionStatus(m_port.GetHandle(), &bytes, &key, &overlapped, INFINITE))
+				return 1;
+			if (key == ShutdownKey)
+				return 0;
+
+			std::unique_ptr<PendingRequest> request(reinterpret_cast<PendingRequest*>(overlapped));
+			bool cancelled = false;
+			{
+				CriticalSectionLock cs(m_cs);
+				m_inFlight.erase(request->Header.CorrelationId);
+				cancelled = m_cancelled.erase(request->Header.CorrelationId) > 0;
+			}
+			if (cancelled == false)
+				Handle(*request);
+		}
+	}
+
+	void RpcServer::Handle(PendingRequest& request)
+	{
+		RpcHeader header = request.Header;
+		std::vector<std::byte> response;
+		try
+		{
+			response = m_handler(header.Method, request.Frame.GetData().subspan(sizeof(RpcHeader)));
+			header.Kind = RpcMessageKind::Response;
+		}
+		catch (const std::exception& ex)
+		{
+			const std::string_view message = ex.what();
+			const std::span<const std::byte> bytes = std::as_bytes(std::span(message));
+			response.assign(bytes.begin(), bytes.end());
+			header.Kind = RpcMessageKind::Error;
+		}
+		request.Frame.Release();
+		m_requestCount++;
+
+		if (response.size() > m_channel.GetMaxFrameSize() - sizeof(RpcHeader))
+		{
+			const std::string_view message = __FUNCSIG__ ": the response is larger than a frame";
+			const std::span<const std::byte> bytes = std::as_bytes(std::span(message));
+			response.assign(bytes.begin(), bytes.end());
+			header.Kind = RpcMessageKind::Error;
+		}
+		// A client that has gone has no use for the response
+		if (m_channel.IsConnected() == false)
+			return;
+		try
+		{
+			Send(header, response);
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Send() failed: "
+				<< ex.what()
+				<< std::endl;
+		}
+	}
+
+	void RpcServer::Send(const RpcHeader& header, const std::span<const std::byte> payload)
+	{
+		CriticalSectionLock cs(m_sendCs);
+		m_sendBuffer.resize(sizeof(RpcHeader) + payload.size());
+		std::memcpy(m_sendBuffer.data(), &header, sizeof(RpcHeader));
+		if (!payload.empty())
+			std::memcpy(m_sendBuffer.data() + sizeof(RpcHeader), payload.data(), payload.size());
+		m_channel.Send(m_sendBuffer);
+	}
+}
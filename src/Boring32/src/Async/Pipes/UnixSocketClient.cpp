@@ -0,0 +1,64 @@
+#include "pch.hpp"
+#include <winsock2.h>
+#include <afunix.h>
+#include <stdexcept>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/Pipes/UnixSocketClient.hpp"
+
+namespace Boring32::Async
+{
+	UnixSocketClient::~UnixSocketClient() { }
+
+	UnixSocketClient::UnixSocketClient() { }
+
+	UnixSocketClient::UnixSocketClient(const std::wstring& path)
+	:	UnixSocketConnection(path)
+	{ }
+
+	UnixSocketClient::UnixSocketClient(UnixSocketClient&& other) noexcept
+	:	UnixSocketConnection(std::move(other))
+	{ }
+
+	UnixSocketClient& UnixSocketClient::operator=(UnixSocketClient&& other) noexcept
+	{
+		Close();
+		Move(other);
+		return *this;
+	}
+
+	void UnixSocketClient::Connect()
+	{
+		if (m_socket != INVALID_SOCKET)
+			throw std::runtime_error(__FUNCSIG__ ": already connected");
+
+		sockaddr_un address;
+		ToAddress(m_path, address);
+		const SOCKET s = CreateSocket();
+		// https://docs.microsoft.com/en-us/windows/win32/api/winsock2/nf-winsock2-connect
+		if (connect(s, (const sockaddr*)&address, sizeof(address)) == SOCKET_ERROR)
+		{
+			const int lastError = WSAGetLastError();
+			closesocket(s);
+			throw Error::Win32Error(__FUNCSIG__ ": connect() failed", lastError);
+		}
+		m_socket = s;
+	}
+
+	bool UnixSocketClient::Connect(std::nothrow_t) noexcept
+	{
+		try
+		{
+			Connect();
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Connect() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+}
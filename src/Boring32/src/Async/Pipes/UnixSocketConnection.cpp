@@ -0,0 +1,367 @@
+#include "pch.hpp"
+#include <winsock2.h>
+#include <afunix.h>
+#include <stdexcept>
+#include <climits>
+#include <algorithm>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/Pipes/UnixSocketConnection.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		struct WinsockSession
+		{
+			WinsockSession()
+			{
+				WSADATA data{ 0 };
+				// https://docs.microsoft.com/en-us/windows/win32/api/winsock/nf-winsock-wsastartup
+				Status = WSAStartup(MAKEWORD(2, 2), &data);
+			}
+
+			~WinsockSession()
+			{
+				if (Status == 0)
+					WSACleanup();
+			}
+
+			int Status;
+		};
+	}
+
+	UnixSocketConnection::~UnixSocketConnection()
+	{
+		Close();
+	}
+
+	UnixSocketConnection::UnixSocketConnection()
+	:	m_socket(INVALID_SOCKET),
+		m_maxMessageSize(DefaultMaxMessageSize)
+	{ }
+
+	UnixSocketConnection::UnixSocketConnection(const std::wstring& path)
+	:	m_path(path),
+		m_socket(INVALID_SOCKET),
+		m_maxMessageSize(DefaultMaxMessageSize)
+	{ }
+
+	UnixSocketConnection::UnixSocketConnection(UnixSocketConnection&& other) noexcept
+	:	m_socket(INVALID_SOCKET),
+		m_maxMessageSize(DefaultMaxMessageSize)
+	{
+		Move(other);
+	}
+
+	UnixSocketConnection& UnixSocketConnection::operator=(UnixSocketConnection&& other) noexcept
+	{
+		Close();
+		Move(other);
+		return *this;
+	}
+
+	void UnixSocketConnection::Move(UnixSocketConnection& other) noexcept
+	{
+		m_path = std::move(other.m_path);
+		m_socket = other.m_socket;
+		other.m_socket = INVALID_SOCKET;
+		m_maxMessageSize = other.m_maxMessageSize;
+	}
+
+	void UnixSocketConnection::Write(const std::wstring& msg)
+	{
+		SendFrame(msg.data(), msg.size() * sizeof(wchar_t));
+	}
+
+	bool UnixSocketConnection::Write(const std::wstring& msg, std::nothrow_t) noexcept
+	{
+		try
+		{
+			Write(msg);
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Write() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	void UnixSocketConnection::Write(const std::span<const std::byte> data)
+	{
+		SendFrame(data.data(), data.size());
+	}
+
+	bool UnixSocketConnection::Write(const std::span<const std::byte> data, std::nothrow_t) noexcept
+	{
+		try
+		{
+			Write(data);
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Write() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	void UnixSocketConnection::WriteGather(const std::span<const std::span<const std::byte>> pieces)
+	{
+		SendFrame(pieces);
+	}
+
+	std::wstring UnixSocketConnection::Read()
+	{
+		const std::uint32_t size = ReceiveHeader();
+		// The message is read before being rejected, so the next one
+		// can still be read
+		std::wstring msg((size + sizeof(wchar_t) - 1) / sizeof(wchar_t), L'\0');
+		ReceiveExact(msg.data(), size);
+		if (size % sizeof(wchar_t) != 0)
+			throw std::runtime_error(__FUNCSIG__ ": message is not a wide string");
+		return msg;
+	}
+
+	bool UnixSocketConnection::Read(std::wstring& out, std::nothrow_t) noexcept
+	{
+		try
+		{
+			out = Read();
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Read() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	std::vector<std::byte> UnixSocketConnection::ReadBytes()
+	{
+		std::vector<std::byte> msg(ReceiveHeader());
+		ReceiveExact(msg.data(), msg.size());
+		return msg;
+	}
+
+	size_t UnixSocketConnection::ReadScatter(const std::span<const std::span<std::byte>> pieces)
+	{
+		std::uint32_t size = 0;
+		ReceiveExact(&size, HeaderSize);
+		size_t remaining = size;
+		for (const std::span<std::byte> piece : pieces)
+		{
+			const size_t toRead = (std::min)(remaining, piece.size());
+			ReceiveExact(piece.data(), toRead);
+			remaining -= toRead;
+		}
+		if (remaining == 0)
+			return size;
+
+		// Drain the rest of the message so the next one can still be read
+		std::byte discard[4096];
+		while (remaining > 0)
+		{
+			const size_t toRead = (std::min)(remaining, sizeof(discard));
+			ReceiveExact(discard, toRead);
+			remaining -= toRead;
+		}
+		throw std::runtime_error(__FUNCSIG__ ": message is larger than the pieces");
+	}
+
+	bool UnixSocketConnection::WaitForRead(const std::uint32_t timeoutMillis)
+	{
+		if (m_socket == INVALID_SOCKET)
+			throw std::runtime_error(__FUNCSIG__ ": not connected");
+
+		WSAPOLLFD fd{ .fd = m_socket, .events = POLLRDNORM };
+		// https://docs.microsoft.com/en-us/windows/win32/api/winsock2/nf-winsock2-wsapoll
+		const int result = WSAPoll(&fd, 1, timeoutMillis == Infinite ? -1 : (INT)timeoutMillis);
+		if (result == SOCKET_ERROR)
+			throw Error::Win32Error(__FUNCSIG__ ": WSAPoll() failed", WSAGetLastError());
+		// A closed connection is reported as POLLHUP, which also makes the
+		// next Read() return promptly, with an error
+		return result > 0;
+	}
+
+	void UnixSocketConnection::Close()
+	{
+		if (m_socket != INVALID_SOCKET)
+		{
+			// https://docs.microsoft.com/en-us/windows/win32/api/winsock/nf-winsock-closesocket
+			closesocket(m_socket);
+			m_socket = INVALID_SOCKET;
+		}
+	}
+
+	bool UnixSocketConnection::IsConnected() const noexcept
+	{
+		return m_socket != INVALID_SOCKET;
+	}
+
+	const std::wstring& UnixSocketConnection::GetPath() const noexcept
+	{
+		return m_path;
+	}
+
+	UnixSocketHandle UnixSocketConnection::GetSocket() const noexcept
+	{
+		return m_socket;
+	}
+
+	void UnixSocketConnection::SetMaxMessageSize(const std::uint32_t maxMessageSize)
+	{
+		m_maxMessageSize = maxMessageSize;
+	}
+
+	std::uint32_t UnixSocketConnection::GetMaxMessageSize() const noexcept
+	{
+		return m_maxMessageSize;
+	}
+
+	void UnixSocketConnection::SendFrame(const void* data, const size_t size)
+	{
+		const std::span<const std::byte> piece(static_cast<const std::byte*>(data), size);
+		SendFrame(std::span<const std::span<const std::byte>>(&piece, 1));
+	}
+
+	void UnixSocketConnection::SendFrame(const std::span<const std::span<const std::byte>> pieces)
+	{
+		if (m_socket == INVALID_SOCKET)
+			throw std::runtime_error(__FUNCSIG__ ": not connected");
+		size_t size = 0;
+		for (const std::span<const std::byte> piece : pieces)
+			size += piece.size();
+		if (size > MAXUINT32)
+			throw std::invalid_argument(__FUNCSIG__ ": message is too large");
+
+		// The prefix and pieces go out in one call, without being copied.
+		// A few pieces fit in inline buffers without allocating.
+		UINT32 header = (UINT32)size;
+		WSABUF inlineBuffers[8];
+		std::vector<WSABUF> heapBuffers;
+		WSABUF* buffers = inlineBuffers;
+		if (pieces.size() + 1 > std::size(inlineBuffers))
+		{
+			heapBuffers.resize(pieces.size() + 1);
+			buffers = heapBuffers.data();
+		}
+		DWORD count = 0;
+		buffers[count++] = { .len = HeaderSize, .buf = reinterpret_cast<char*>(&header) };
+		for (const std::span<const std::byte> piece : pieces)
+		{
+			if (piece.empty() == false)
+				buffers[count++] = { .len = (ULONG)piece.size(), .buf = (char*)piece.data() };
+		}
+
+		WSABUF* next = buffers;
+		while (count > 0)
+		{
+			DWORD bytesSent = 0;
+			// https://docs.microsoft.com/en-us/windows/win32/api/winsock2/nf-winsock2-wsasend
+			if (WSASend(m_socket, next, count, &bytesSent, 0, nullptr, nullptr) == SOCKET_ERROR)
+				throw Error::Win32Error(__FUNCSIG__ ": WSASend() failed", WSAGetLastError());
+
+			// Blocking sends normally complete in full, but stream sockets
+			// may return early, so resume after whatever was sent
+			while (count > 0 && bytesSent >= next->len)
+			{
+				bytesSent -= next->len;
+				next++;
+				count--;
+			}
+			if (count > 0)
+			{
+				next->buf += bytesSent;
+				next->len -= bytesSent;
+			}
+		}
+	}
+
+	std::uint32_t UnixSocketConnection::ReceiveHeader()
+	{
+		std::uint32_t header = 0;
+		ReceiveExact(&header, HeaderSize);
+		if (header > m_maxMessageSize)
+		{
+			// The stream can't be resynchronised without reading the
+			// message, so the connection is given up instead
+			Close();
+			throw std::runtime_error(__FUNCSIG__ ": message exceeds the maximum message size");
+		}
+		return header;
+	}
+
+	void UnixSocketConnection::ReceiveExact(void* buffer, const size_t size)
+	{
+		if (m_socket == INVALID_SOCKET)
+			throw std::runtime_error(__FUNCSIG__ ": not connected");
+
+		char* position = static_cast<char*>(buffer);
+		size_t remaining = size;
+		while (remaining > 0)
+		{
+			const int toRead = (int)(std::min)(remaining, (size_t)INT_MAX);
+			// https://docs.microsoft.com/en-us/windows/win32/api/winsock/nf-winsock-recv
+			const int bytesRead = recv(m_socket, position, toRead, MSG_WAITALL);
+			if (bytesRead == SOCKET_ERROR)
+				throw Error::Win32Error(__FUNCSIG__ ": recv() failed", WSAGetLastError());
+			if (bytesRead == 0)
+				throw std::runtime_error(__FUNCSIG__ ": the connection was closed");
+			position += bytesRead;
+			remaining -= bytesRead;
+		}
+	}
+
+	void UnixSocketConnection::Startup()
+	{
+		static WinsockSession session;
+		if (session.Status != 0)
+			throw Error::Win32Error(__FUNCSIG__ ": WSAStartup() failed", session.Status);
+	}
+
+	UnixSocketHandle UnixSocketConnection::CreateSocket()
+	{
+		Startup();
+		// Windows supports AF_UNIX from Windows 10 1803, for SOCK_STREAM only
+		// https://docs.microsoft.com/en-us/windows/win32/api/winsock2/nf-winsock2-socket
+		const SOCKET s = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (s == INVALID_SOCKET)
+			throw Error::Win32Error(__FUNCSIG__ ": socket() failed", WSAGetLastError());
+		return s;
+	}
+
+	void UnixSocketConnection::ToAddress(const std::wstring& path, sockaddr_un& address)
+	{
+		if (path.empty())
+			throw std::invalid_argument(__FUNCSIG__ ": path must be specified");
+
+		address = sockaddr_un{ 0 };
+		address.sun_family = AF_UNIX;
+		// Leave room for the null terminator
+		const int length = WideCharToMultiByte(
+			CP_UTF8,
+			0,
+			path.c_str(),
+			(int)path.size(),
+			address.sun_path,
+			sizeof(address.sun_path) - 1,
+			nullptr,
+			nullptr
+		);
+		if (length == 0)
+			throw Error::Win32Error(__FUNCSIG__ ": path is too long or invalid", GetLastError());
+	}
+}
@@ -0,0 +1,173 @@
+#include "pch.hpp"
+#include <winsock2.h>
+#include <afunix.h>
+#include <stdexcept>
+#include <algorithm>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/Pipes/UnixSocketServer.hpp"
+
+namespace Boring32::Async
+{
+	UnixSocketServer::Listener::~Listener()
+	{
+		if (Socket != INVALID_SOCKET)
+			closesocket(Socket);
+		// Unlike named pipes, the socket file outlives its socket
+		if (Path.empty() == false)
+			DeleteFileW(Path.c_str());
+	}
+
+	UnixSocketServer::~UnixSocketServer()
+	{
+		Close();
+	}
+
+	UnixSocketServer::UnixSocketServer() { }
+
+	UnixSocketServer::UnixSocketServer(const std::wstring& path, const std::uint32_t maxInstances)
+	:	UnixSocketConnection(path)
+	{
+		if (maxInstances == 0)
+			throw std::invalid_argument(__FUNCSIG__ ": maxInstances must be greater than 0");
+
+		sockaddr_un address;
+		ToAddress(path, address);
+		auto listener = std::make_shared<Listener>();
+		listener->Socket = CreateSocket();
+		listener->MaxInstances = maxInstances;
+
+		// A stale file from a server that exited without cleaning up
+		// would otherwise make bind() fail
+		DeleteFileW(path.c_str());
+		// https://docs.microsoft.com/en-us/windows/win32/api/winsock/nf-winsock-bind
+		if (bind(listener->Socket, (const sockaddr*)&address, sizeof(address)) == SOCKET_ERROR)
+			throw Error::Win32Error(__FUNCSIG__ ": bind() failed", WSAGetLastError());
+		listener->Path = path;
+
+		// https://docs.microsoft.com/en-us/windows/win32/api/winsock2/nf-winsock2-listen
+		if (listen(listener->Socket, (int)(std::min)(maxInstances, (std::uint32_t)SOMAXCONN)) == SOCKET_ERROR)
+			throw Error::Win32Error(__FUNCSIG__ ": listen() failed", WSAGetLastError());
+
+		// Instances share the listener, so several can be waiting in
+		// Connect() at once. Making it non-blocking lets the ones that
+		// lose the race for a client go back to waiting.
+		u_long nonBlocking = 1;
+		// https://docs.microsoft.com/en-us/windows/win32/api/winsock/nf-winsock-ioctlsocket
+		if (ioctlsocket(listener->Socket, FIONBIO, &nonBlocking) == SOCKET_ERROR)
+			throw Error::Win32Error(__FUNCSIG__ ": ioctlsocket() failed", WSAGetLastError());
+
+		listener->Instances = 1;
+		m_listener = std::move(listener);
+	}
+
+	UnixSocketServer::UnixSocketServer(std::shared_ptr<Listener> listener)
+	:	UnixSocketConnection(listener->Path),
+		m_listener(std::move(listener))
+	{ }
+
+	UnixSocketServer::UnixSocketServer(UnixSocketServer&& other) noexcept
+	:	UnixSocketConnection(std::move(other)),
+		m_listener(std::move(other.m_listener))
+	{ }
+
+	UnixSocketServer& UnixSocketServer::operator=(UnixSocketServer&& other) noexcept
+	{
+		Close();
+		Move(other);
+		m_listener = std::move(other.m_listener);
+		return *this;
+	}
+
+	UnixSocketServer UnixSocketServer::CreateInstance()
+	{
+		if (m_listener == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": the server is closed");
+
+		std::uint32_t instances = m_listener->Instances;
+		do
+		{
+			if (instances >= m_listener->MaxInstances)
+				throw std::runtime_error(__FUNCSIG__ ": the maximum number of instances already exist");
+		} while (m_listener->Instances.compare_exchange_weak(instances, instances + 1) == false);
+
+		UnixSocketServer instance(m_listener);
+		instance.m_maxMessageSize = m_maxMessageSize;
+		return instance;
+	}
+
+	void UnixSocketServer::Connect()
+	{
+		Connect(INFINITE);
+	}
+
+	bool UnixSocketServer::Connect(const std::uint32_t timeoutMillis)
+	{
+		if (m_listener == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": the server is closed");
+		if (m_socket != INVALID_SOCKET)
+			throw std::runtime_error(__FUNCSIG__ ": already connected");
+
+		const UINT64 deadline = timeoutMillis == Infinite
+			? MAXUINT64
+			: GetTickCount64() + timeoutMillis;
+		while (true)
+		{
+			// https://docs.microsoft.com/en-us/windows/win32/api/winsock2/nf-winsock2-accept
+			const SOCKET client = accept(m_listener->Socket, nullptr, nullptr);
+			if (client != INVALID_SOCKET)
+			{
+				// Accepted sockets inherit the listener's non-blocking mode
+				u_long nonBlocking = 0;
+				if (ioctlsocket(client, FIONBIO, &nonBlocking) == SOCKET_ERROR)
+				{
+					const int lastError = WSAGetLastError();
+					closesocket(client);
+					throw Error::Win32Error(__FUNCSIG__ ": ioctlsocket() failed", lastError);
+				}
+				m_socket = client;
+				return true;
+			}
+
+			const int lastError = WSAGetLastError();
+			if (lastError != WSAEWOULDBLOCK)
+				throw Error::Win32Error(__FUNCSIG__ ": accept() failed", lastError);
+
+			INT timeout = -1;
+			if (deadline != MAXUINT64)
+			{
+				const UINT64 now = GetTickCount64();
+				if (now >= deadline)
+					return false;
+				timeout = (INT)(deadline - now);
+			}
+			WSAPOLLFD fd{ .fd = m_listener->Socket, .events = POLLRDNORM };
+			if (WSAPoll(&fd, 1, timeout) == SOCKET_ERROR)
+				throw Error::Win32Error(__FUNCSIG__ ": WSAPoll() failed", WSAGetLastError());
+		}
+	}
+
+	void UnixSocketServer::Disconnect()
+	{
+		UnixSocketConnection::Close();
+	}
+
+	void UnixSocketServer::Close()
+	{
+		Disconnect();
+		if (m_listener != nullptr)
+		{
+			m_listener->Instances--;
+			m_listener = nullptr;
+		}
+	}
+
+	std::uint32_t UnixSocketServer::GetMaxInstances() const noexcept
+	{
+		return m_listener != nullptr ? m_listener->MaxInstances : 0;
+	}
+
+	std::uint32_t UnixSocketServer::GetInstanceCount() const noexcept
+	{
+		return m_listener != nullptr ? m_listener->Instances.load() : 0;
+	}
+}
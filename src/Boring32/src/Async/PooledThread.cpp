@@ -0,0 +1,167 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/CriticalSectionLock.hpp"
+#include "include/Async/PooledThread.hpp"
+
+namespace Boring32::Async
+{
+	PooledThread::~PooledThread()
+	{
+		Close();
+	}
+
+	void PooledThread::Close()
+	{
+		// The job is shared with the worker, so it is safe to let go of
+		// it even if the function is still running
+		m_job = nullptr;
+		Thread::Close();
+	}
+
+	PooledThread::PooledThread(ThreadCache& cache)
+	:	Thread(),
+		m_cache(&cache)
+	{ }
+
+	PooledThread::PooledThread(ThreadCache& cache, void* param)
+	:	Thread(param),
+		m_cache(&cache)
+	{ }
+
+	PooledThread::PooledThread(PooledThread&& other) noexcept
+	:	m_cache(nullptr)
+	{
+		Move(other);
+	}
+
+	PooledThread& PooledThread::operator=(PooledThread&& other) noexcept
+	{
+		Move(other);
+		return *this;
+	}
+
+	void PooledThread::Move(PooledThread& other) noexcept
+	{
+		Thread::Move(other);
+		m_cache = other.m_cache;
+		m_job = std::move(other.m_job);
+	}
+
+	bool PooledThread::operator==(const ThreadStatus status) const noexcept
+	{
+		return GetStatus() == status;
+	}
+
+	void PooledThread::InternalStart()
+	{
+		if (m_cache == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": no ThreadCache to start from");
+		if (m_job != nullptr && m_job->Status == ThreadStatus::Running)
+			throw std::runtime_error(__FUNCSIG__ ": thread is already running");
+
+		auto job = std::make_shared<PooledThreadJob>(m_func, m_threadParam);
+		m_cache->Submit(job);
+		m_job = std::move(job);
+	}
+
+	void PooledThread::Terminate(const DWORD exitCode)
+	{
+		if (m_job == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": thread has not been started");
+		if (m_cache == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": no ThreadCache to terminate in");
+		m_cache->Terminate(m_job, exitCode);
+	}
+
+	void PooledThread::Suspend()
+	{
+		if (m_job == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": thread has not been started");
+		// The worker takes this lock to finish the job, so it cannot be
+		// suspended after moving on to other work
+		CriticalSectionLock jobLock(m_job->Lock);
+		const std::shared_ptr<const Raii::Win32Handle> thread = GetRunningThread();
+		if (SuspendThread(thread->GetHandle()) == (DWORD)-1)
+			throw Error::Win32Error(__FUNCSIG__ ": SuspendThread() failed", GetLastError());
+		m_job->Status = ThreadStatus::Suspended;
+	}
+
+	void PooledThread::Resume()
+	{
+		if (m_job == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": thread was not suspended when request to resume occurred.");
+		CriticalSectionLock jobLock(m_job->Lock);
+		if (m_job->Status != ThreadStatus::Suspended)
+			throw std::runtime_error(__FUNCSIG__ ": thread was not suspended when request to resume occurred.");
+		const std::shared_ptr<const Raii::Win32Handle> thread = m_job->Thread.load();
+		if (thread == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": no thread handle to resume");
+		if (ResumeThread(thread->GetHandle()) == (DWORD)-1)
+			throw Error::Win32Error(__FUNCSIG__ ": ResumeThread() failed", GetLastError());
+		m_job->Status = ThreadStatus::Running;
+	}
+
+	bool PooledThread::Join(const DWORD waitTime)
+	{
+		if (m_job == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": thread has not been started");
+		return m_job->Finished.WaitOnEvent(waitTime, false);
+	}
+
+	ThreadStatus PooledThread::GetStatus() const noexcept
+	{
+		return m_job == nullptr ? ThreadStatus::Ready : m_job->Status.load();
+	}
+
+	UINT PooledThread::GetExitCode() const
+	{
+		if (m_job == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": thread has not been started");
+		// Mirrors GetExitCodeThread(), which reports STILL_ACTIVE until the thread exits
+		const ThreadStatus status = m_job->Status;
+		if (status == ThreadStatus::Finished || status == ThreadStatus::Terminated)
+			return m_job->ExitCode;
+		return STILL_ACTIVE;
+	}
+
+	Raii::Win32Handle PooledThread::GetHandle() noexcept
+	{
+		if (m_job == nullptr)
+			return nullptr;
+		const std::shared_ptr<const Raii::Win32Handle> thread = m_job->Thread.load();
+		if (thread == nullptr)
+			return nullptr;
+		HANDLE duplicate = nullptr;
+		// https://docs.microsoft.com/en-us/windows/win32/api/handleapi/nf-handleapi-duplicatehandle
+		const bool succeeded = DuplicateHandle(
+			GetCurrentProcess(),
+			thread->GetHandle(),
+			GetCurrentProcess(),
+			&duplicate,
+			0,
+			false,
+			DUPLICATE_SAME_ACCESS
+		);
+		return succeeded ? duplicate : nullptr;
+	}
+
+	bool PooledThread::WaitToStart(const DWORD millis)
+	{
+		if (m_job == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": thread has not been started");
+		return m_job->Started.WaitOnEvent(millis, true);
+	}
+
+	std::shared_ptr<const Raii::Win32Handle> PooledThread::GetRunningThread() const
+	{
+		if (m_job == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": thread has not been started");
+		if (m_job->Status != ThreadStatus::Running)
+			throw std::runtime_error(__FUNCSIG__ ": thread is not running");
+		const std::shared_ptr<const Raii::Win32Handle> thread = m_job->Thread.load();
+		if (thread == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": thread is not running");
+		return thread;
+	}
+}
@@ -0,0 +1,182 @@
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+#include "include/Async/FileMapping.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		std::system_error LastError(const char* msg)
+		{
+			return std::system_error(errno, std::system_category(), msg);
+		}
+
+		// wchar_t holds UTF-32 on Linux
+		std::string ToUtf8(const std::wstring& str)
+		{
+			std::string utf8;
+			for (const wchar_t c : str)
+			{
+				const std::uint32_t codePoint = static_cast<std::uint32_t>(c);
+				if (codePoint < 0x80)
+				{
+					utf8 += (char)codePoint;
+				}
+				else if (codePoint < 0x800)
+				{
+					utf8 += (char)(0xC0 | (codePoint >> 6));
+					utf8 += (char)(0x80 | (codePoint & 0x3F));
+				}
+				else if (codePoint < 0x10000)
+				{
+					utf8 += (char)(0xE0 | (codePoint >> 12));
+					utf8 += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+					utf8 += (char)(0x80 | (codePoint & 0x3F));
+				}
+				else if (codePoint < 0x110000)
+				{
+					utf8 += (char)(0xF0 | (codePoint >> 18));
+					utf8 += (char)(0x80 | ((codePoint >> 12) & 0x3F));
+					utf8 += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+					utf8 += (char)(0x80 | (codePoint & 0x3F));
+				}
+				else
+				{
+					throw std::invalid_argument("ToUtf8(): the string is not valid UTF-32");
+				}
+			}
+			return utf8;
+		}
+	}
+
+	FileMapping::~FileMapping()
+	{
+		Close();
+	}
+
+	FileMapping::FileMapping()
+	:	m_file(-1),
+		m_size(0),
+		m_writable(false)
+	{ }
+
+	FileMapping::FileMapping(const std::wstring& path, const bool writable)
+	:	FileMapping(path, writable, 0)
+	{ }
+
+	FileMapping::FileMapping(const std::wstring& path, const bool writable, const std::uint64_t size)
+	:	m_path(path),
+		m_file(-1),
+		m_size(0),
+		m_writable(writable)
+	{
+		if (m_path.empty())
+			throw std::invalid_argument("FileMapping::FileMapping(): path cannot be empty");
+
+		// https://man7.org/linux/man-pages/man2/open.2.html
+		m_file = open(
+			ToUtf8(m_path).c_str(),
+			m_writable ? O_RDWR | O_CREAT | O_CLOEXEC : O_RDONLY | O_CLOEXEC,
+			0666
+		);
+		if (m_file == -1)
+			throw LastError("FileMapping::FileMapping(): open() failed");
+
+		try
+		{
+			// https://man7.org/linux/man-pages/man2/fstat.2.html
+			struct stat status{};
+			if (fstat(m_file, &status) == -1)
+				throw LastError("FileMapping::FileMapping(): fstat() failed");
+			m_size = status.st_size;
+			if (size > m_size)
+			{
+				if (!m_writable)
+					throw std::invalid_argument("FileMapping::FileMapping(): a read-only file cannot be extended");
+				// Windows extends the file when the section is created.
+				// Views here map the file directly, so it is extended now.
+				// https://man7.org/linux/man-pages/man2/ftruncate.2.html
+				if (ftruncate(m_file, static_cast<off_t>(size)) == -1)
+					throw LastError("FileMapping::FileMapping(): ftruncate() failed");
+				m_size = size;
+			}
+		}
+		catch (...)
+		{
+			Close();
+			throw;
+		}
+	}
+
+	FileMapping::FileMapping(FileMapping&& other) noexcept
+	:	m_file(-1),
+		m_size(0),
+		m_writable(false)
+	{
+		Move(other);
+	}
+
+	FileMapping& FileMapping::operator=(FileMapping&& other) noexcept
+	{
+		Move(other);
+		return *this;
+	}
+
+	void FileMapping::Move(FileMapping& other) noexcept
+	{
+		Close();
+		m_path = std::move(other.m_path);
+		m_file = other.m_file;
+		m_size = other.m_size;
+		m_writable = other.m_writable;
+		other.m_file = -1;
+		other.m_size = 0;
+	}
+
+	FileMappingView FileMapping::MapView(const std::uint64_t offset, const size_t length) const
+	{
+		return FileMappingView(*this, offset, length);
+	}
+
+	void FileMapping::Close()
+	{
+		if (m_file != -1)
+		{
+			close(m_file);
+			m_file = -1;
+		}
+		m_size = 0;
+	}
+
+	std::uint64_t FileMapping::GetSize() const noexcept
+	{
+		return m_size;
+	}
+
+	bool FileMapping::IsWritable() const noexcept
+	{
+		return m_writable;
+	}
+
+	const std::wstring& FileMapping::GetPath() const noexcept
+	{
+		return m_path;
+	}
+
+	int FileMapping::GetFileDescriptor() const noexcept
+	{
+		return m_file;
+	}
+
+	std::uint32_t FileMapping::GetAllocationGranularity() noexcept
+	{
+		// mmap() offsets only need to be page aligned
+		// https://man7.org/linux/man-pages/man3/sysconf.3.html
+		static const std::uint32_t granularity = static_cast<std::uint32_t>(sysconf(_SC_PAGESIZE));
+		return granularity;
+	}
+}
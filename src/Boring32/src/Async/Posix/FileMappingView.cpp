@@ -0,0 +1,196 @@
+#include <sys/mman.h>
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+#include <iostream>
+#include "include/Async/FileMapping.hpp"
+#include "include/Async/FileMappingView.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		std::system_error LastError(const char* msg)
+		{
+			return std::system_error(errno, std::system_category(), msg);
+		}
+	}
+
+	FileMappingView::~FileMappingView()
+	{
+		Close();
+	}
+
+	FileMappingView::FileMappingView()
+	:	m_base(nullptr),
+		m_data(nullptr),
+		m_offset(0),
+		m_size(0),
+		m_mappedSize(0)
+	{ }
+
+	FileMappingView::FileMappingView(
+		const FileMapping& mapping,
+		const std::uint64_t offset,
+		const size_t length
+	)
+	:	m_base(nullptr),
+		m_data(nullptr),
+		m_offset(offset),
+		m_size(length),
+		m_mappedSize(0)
+	{
+		if (mapping.GetFileDescriptor() == -1)
+			throw std::runtime_error("FileMappingView::FileMappingView(): mapping is not open");
+		if (offset >= mapping.GetSize())
+			throw std::out_of_range("FileMappingView::FileMappingView(): offset is beyond the end of the mapping");
+		const std::uint64_t available = mapping.GetSize() - offset;
+		if (m_size > available)
+			throw std::out_of_range("FileMappingView::FileMappingView(): range is beyond the end of the mapping");
+		if (m_size == 0)
+		{
+			// On 32-bit builds the remainder of a large file may not
+			// fit in the address space
+			if (available > SIZE_MAX)
+				throw std::out_of_range("FileMappingView::FileMappingView(): remainder of the mapping is too large to view");
+			m_size = static_cast<size_t>(available);
+		}
+
+		// mmap() offsets must be a multiple of the page size
+		const std::uint64_t alignedOffset = offset - (offset % FileMapping::GetAllocationGranularity());
+		const size_t slack = static_cast<size_t>(offset - alignedOffset);
+		if (m_size > SIZE_MAX - slack)
+			throw std::out_of_range("FileMappingView::FileMappingView(): range is too large to view");
+		m_mappedSize = slack + m_size;
+
+		// MAP_SHARED writes changes through to the file, as a view of a
+		// file-backed section does on Windows
+		// https://man7.org/linux/man-pages/man2/mmap.2.html
+		void* base = mmap(
+			nullptr,
+			m_mappedSize,
+			mapping.IsWritable() ? PROT_READ | PROT_WRITE : PROT_READ,
+			MAP_SHARED,
+			mapping.GetFileDescriptor(),
+			static_cast<off_t>(alignedOffset)
+		);
+		if (base == MAP_FAILED)
+			throw LastError("FileMappingView::FileMappingView(): mmap() failed");
+		m_base = base;
+		m_data = static_cast<std::byte*>(m_base) + slack;
+	}
+
+	FileMappingView::FileMappingView(FileMappingView&& other) noexcept
+	:	m_base(nullptr),
+		m_data(nullptr),
+		m_offset(0),
+		m_size(0),
+		m_mappedSize(0)
+	{
+		Move(other);
+	}
+
+	FileMappingView& FileMappingView::operator=(FileMappingView&& other) noexcept
+	{
+		Move(other);
+		return *this;
+	}
+
+	void FileMappingView::Move(FileMappingView& other) noexcept
+	{
+		Close();
+		m_base = other.m_base;
+		m_data = other.m_data;
+		m_offset = other.m_offset;
+		m_size = other.m_size;
+		m_mappedSize = other.m_mappedSize;
+		other.m_base = nullptr;
+		other.m_data = nullptr;
+		other.m_offset = 0;
+		other.m_size = 0;
+		other.m_mappedSize = 0;
+	}
+
+	std::span<std::byte> FileMappingView::GetData() const noexcept
+	{
+		return { m_data, m_data ? m_size : 0 };
+	}
+
+	std::uint64_t FileMappingView::GetOffset() const noexcept
+	{
+		return m_offset;
+	}
+
+	size_t FileMappingView::GetSize() const noexcept
+	{
+		return m_size;
+	}
+
+	size_t FileMappingView::GetMappedSize() const noexcept
+	{
+		return m_mappedSize;
+	}
+
+	bool FileMappingView::Contains(const std::uint64_t offset, const size_t length) const noexcept
+	{
+		return m_base
+			&& offset >= m_offset
+			&& offset - m_offset <= m_size
+			&& length <= m_size - (offset - m_offset);
+	}
+
+	bool FileMappingView::IsValid() const noexcept
+	{
+		return m_base != nullptr;
+	}
+
+	void FileMappingView::Flush()
+	{
+		if (!m_base)
+			throw std::runtime_error("FileMappingView::Flush(): view is not mapped");
+		// MS_SYNC waits for the pages to be written, as FlushViewOfFile()
+		// does
+		// https://man7.org/linux/man-pages/man2/msync.2.html
+		if (msync(m_base, m_mappedSize, MS_SYNC) == -1)
+			throw LastError("FileMappingView::Flush(): msync() failed");
+	}
+
+	void FileMappingView::Prefetch()
+	{
+		if (!m_base)
+			throw std::runtime_error("FileMappingView::Prefetch(): view is not mapped");
+		// madvise() needs a page-aligned address, so this covers the
+		// slack before the requested offset too
+		// https://man7.org/linux/man-pages/man2/madvise.2.html
+		if (madvise(m_base, m_mappedSize, MADV_WILLNEED) == -1)
+			throw LastError("FileMappingView::Prefetch(): madvise() failed");
+	}
+
+	bool FileMappingView::Prefetch(std::nothrow_t) noexcept
+	{
+		try
+		{
+			Prefetch();
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< L"FileMappingView::Prefetch(): Prefetch() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	void FileMappingView::Close() noexcept
+	{
+		if (m_base)
+		{
+			munmap(m_base, m_mappedSize);
+			m_base = nullptr;
+			m_data = nullptr;
+		}
+	}
+}
@@ -0,0 +1,395 @@
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+#include <iostream>
+#include "include/Async/ProcessPool.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+		constexpr Clock::time_point NoDeadline = Clock::time_point::max();
+		// How often CreateWorker() checks whether a starting worker exited
+		constexpr std::uint32_t StartupPollMillis = 100;
+
+		std::system_error LastError(const char* msg)
+		{
+			return std::system_error(errno, std::system_category(), msg);
+		}
+
+		Clock::time_point ToDeadline(const std::uint32_t timeoutMillis)
+		{
+			return timeoutMillis == ProcessPool::Infinite
+				? NoDeadline
+				: Clock::now() + std::chrono::milliseconds(timeoutMillis);
+		}
+
+		std::uint32_t RemainingMillis(const Clock::time_point deadline)
+		{
+			if (deadline == NoDeadline)
+				return ProcessPool::Infinite;
+			const Clock::time_point now = Clock::now();
+			if (deadline <= now)
+				return 0;
+			// Rounding up stops a wait returning just before the deadline
+			const std::int64_t remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count();
+			return (std::uint32_t)(std::min)(remaining, (std::int64_t)ProcessPool::Infinite - 1);
+		}
+
+		// wchar_t holds UTF-32 on Linux
+		std::string ToUtf8(const std::wstring& str)
+		{
+			std::string utf8;
+			for (const wchar_t c : str)
+			{
+				const std::uint32_t codePoint = static_cast<std::uint32_t>(c);
+				if (codePoint < 0x80)
+				{
+					utf8 += (char)codePoint;
+				}
+				else if (codePoint < 0x800)
+				{
+					utf8 += (char)(0xC0 | (codePoint >> 6));
+					utf8 += (char)(0x80 | (codePoint & 0x3F));
+				}
+				else if (codePoint < 0x10000)
+				{
+					utf8 += (char)(0xE0 | (codePoint >> 12));
+					utf8 += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+					utf8 += (char)(0x80 | (codePoint & 0x3F));
+				}
+				else if (codePoint < 0x110000)
+				{
+					utf8 += (char)(0xF0 | (codePoint >> 18));
+					utf8 += (char)(0x80 | ((codePoint >> 12) & 0x3F));
+					utf8 += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+					utf8 += (char)(0x80 | (codePoint & 0x3F));
+				}
+				else
+				{
+					throw std::invalid_argument("ToUtf8(): the string is not valid UTF-32");
+				}
+			}
+			return utf8;
+		}
+
+		bool HasExited(const pid_t processId)
+		{
+			// WNOWAIT leaves the process to be reaped by KillProcess(), so
+			// its ID can't be reused in the meantime
+			// https://man7.org/linux/man-pages/man2/waitid.2.html
+			siginfo_t info{};
+			while (waitid(P_PID, processId, &info, WEXITED | WNOHANG | WNOWAIT) == -1)
+			{
+				if (errno != EINTR)
+					throw LastError("ProcessPool::CreateWorker(): waitid() failed");
+			}
+			return info.si_pid == processId;
+		}
+	}
+
+	ProcessPool::~ProcessPool()
+	{
+		KillAll();
+	}
+
+	ProcessPool::ProcessPool(
+		std::wstring executablePath,
+		std::wstring commandLine,
+		std::wstring startingDirectory,
+		const std::uint32_t workerCount,
+		const std::uint32_t maxJobsPerWorker
+	)
+	:	m_executablePath(std::move(executablePath)),
+		m_commandLine(std::move(commandLine)),
+		m_startingDirectory(std::move(startingDirectory)),
+		m_workerCount(workerCount),
+		m_maxJobsPerWorker(maxJobsPerWorker),
+		m_available(workerCount),
+		m_spawnCount(0)
+	{
+		try
+		{
+			Create();
+		}
+		catch (...)
+		{
+			KillAll();
+			throw;
+		}
+	}
+
+	void ProcessPool::Create()
+	{
+		m_idle.reserve(m_workerCount);
+		for (std::uint32_t i = 0; i < m_workerCount; i++)
+			m_idle.push_back(CreateWorker());
+	}
+
+	std::wstring ProcessPool::Submit(const std::wstring& request, const std::uint32_t timeoutMillis)
+	{
+		std::unique_ptr<Worker> worker = AcquireWorker(timeoutMillis);
+		std::wstring response;
+		try
+		{
+			response = Exchange(*worker, request, timeoutMillis);
+		}
+		catch (...)
+		{
+			// The worker is in an unknown state, so don't reuse it
+			KillWorker(std::move(worker));
+			throw;
+		}
+
+		worker->JobsCompleted++;
+		// Dropping the worker closes its channel, which tells it to exit;
+		// it is reaped later, and its replacement is started the next
+		// time the slot is acquired
+		if (m_maxJobsPerWorker > 0 && worker->JobsCompleted >= m_maxJobsPerWorker)
+		{
+			std::scoped_lock lock(m_mutex);
+			m_exiting.push_back(worker->ProcessId);
+			worker = nullptr;
+		}
+		ReleaseWorker(std::move(worker));
+		return response;
+	}
+
+	bool ProcessPool::Submit(
+		const std::wstring& request,
+		const std::uint32_t timeoutMillis,
+		std::wstring& response,
+		std::nothrow_t
+	) noexcept
+	{
+		try
+		{
+			response = Submit(request, timeoutMillis);
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< L"ProcessPool::Submit(): Submit() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	std::uint32_t ProcessPool::GetWorkerCount() const noexcept
+	{
+		return m_workerCount;
+	}
+
+	std::uint32_t ProcessPool::GetMaxJobsPerWorker() const noexcept
+	{
+		return m_maxJobsPerWorker;
+	}
+
+	size_t ProcessPool::GetIdleCount()
+	{
+		std::scoped_lock lock(m_mutex);
+		return m_idle.size();
+	}
+
+	std::uint64_t ProcessPool::GetSpawnCount() const noexcept
+	{
+		return m_spawnCount;
+	}
+
+	std::unique_ptr<ProcessPool::Worker> ProcessPool::CreateWorker()
+	{
+		ReapExited();
+
+		static std::atomic<std::uint64_t> channelCounter = 0;
+		const std::wstring channelPath =
+			L"/tmp/Boring32.ProcessPool."
+			+ std::to_wstring(getpid())
+			+ L"."
+			+ std::to_wstring(channelCounter++);
+
+		auto worker = std::make_unique<Worker>();
+		worker->Channel = std::make_unique<UnixSocketServer>(channelPath, 1);
+		worker->ProcessId = StartProcess(channelPath);
+		m_spawnCount++;
+		try
+		{
+			// Waiting in slices notices a worker that exits, for example
+			// because execv() failed, without waiting out the timeout
+			const Clock::time_point deadline = ToDeadline(StartupTimeoutMillis);
+			while (worker->Channel->Connect((std::min)(RemainingMillis(deadline), StartupPollMillis)) == false)
+			{
+				if (HasExited(worker->ProcessId))
+					throw std::runtime_error("ProcessPool::CreateWorker(): the worker process exited");
+				if (RemainingMillis(deadline) == 0)
+					throw std::runtime_error("ProcessPool::CreateWorker(): timed out waiting for the worker");
+			}
+		}
+		catch (...)
+		{
+			KillProcess(worker->ProcessId);
+			throw;
+		}
+		return worker;
+	}
+
+	std::unique_ptr<ProcessPool::Worker> ProcessPool::AcquireWorker(const std::uint32_t timeoutMillis)
+	{
+		if (timeoutMillis == Infinite)
+			m_available.acquire();
+		else if (m_available.try_acquire_for(std::chrono::milliseconds(timeoutMillis)) == false)
+			throw std::runtime_error("ProcessPool::AcquireWorker(): timed out waiting for an idle worker");
+
+		{
+			std::scoped_lock lock(m_mutex);
+			if (m_idle.empty() == false)
+			{
+				std::unique_ptr<Worker> worker = std::move(m_idle.back());
+				m_idle.pop_back();
+				return worker;
+			}
+		}
+
+		// This slot's worker was recycled or killed, so start its replacement
+		try
+		{
+			return CreateWorker();
+		}
+		catch (...)
+		{
+			m_available.release();
+			throw;
+		}
+	}
+
+	void ProcessPool::ReleaseWorker(std::unique_ptr<Worker> worker)
+	{
+		if (worker != nullptr)
+		{
+			std::scoped_lock lock(m_mutex);
+			m_idle.push_back(std::move(worker));
+		}
+		m_available.release();
+	}
+
+	void ProcessPool::KillWorker(std::unique_ptr<Worker> worker)
+	{
+		KillProcess(worker->ProcessId);
+		worker = nullptr;
+		ReleaseWorker(nullptr);
+	}
+
+	std::wstring ProcessPool::Exchange(
+		Worker& worker,
+		const std::wstring& request,
+		const std::uint32_t timeoutMillis
+	)
+	{
+		const Clock::time_point deadline = ToDeadline(timeoutMillis);
+
+		// A worker that stops reading would otherwise block the write
+		// once the socket buffer is full. A zero timeval is no timeout.
+		timeval sendTimeout{};
+		const std::uint32_t remaining = RemainingMillis(deadline);
+		if (remaining != Infinite)
+		{
+			sendTimeout.tv_sec = remaining / 1000;
+			sendTimeout.tv_usec = (remaining % 1000) * 1000;
+			if (remaining == 0)
+				sendTimeout.tv_usec = 1;
+		}
+		// https://man7.org/linux/man-pages/man7/socket.7.html
+		if (setsockopt(worker.Channel->GetSocket(), SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout)) == -1)
+			throw LastError("ProcessPool::Exchange(): setsockopt() failed");
+		worker.Channel->Write(request);
+
+		// A worker that exits closes its end, which ends the wait and
+		// makes Read() throw
+		if (worker.Channel->WaitForRead(RemainingMillis(deadline)) == false)
+			throw std::runtime_error("ProcessPool::Exchange(): timed out waiting for the worker");
+		return worker.Channel->Read();
+	}
+
+	pid_t ProcessPool::StartProcess(const std::wstring& channelPath)
+	{
+		// Only async-signal-safe functions can be called between fork()
+		// and execv() in a multithreaded process, so everything the child
+		// needs is prepared first
+		const std::string executablePath = ToUtf8(m_executablePath);
+		const std::string startingDirectory = ToUtf8(m_startingDirectory);
+		std::vector<std::string> arguments;
+		for (const char c : ToUtf8(m_commandLine))
+		{
+			if (c == ' ' || c == '\t')
+			{
+				if (arguments.empty() == false && arguments.back().empty() == false)
+					arguments.emplace_back();
+				continue;
+			}
+			if (arguments.empty())
+				arguments.emplace_back();
+			arguments.back() += c;
+		}
+		if (arguments.empty() == false && arguments.back().empty())
+			arguments.pop_back();
+		if (arguments.empty())
+			arguments.push_back(executablePath);
+		arguments.push_back(ToUtf8(channelPath));
+
+		std::vector<char*> argv;
+		for (std::string& argument : arguments)
+			argv.push_back(argument.data());
+		argv.push_back(nullptr);
+
+		// https://man7.org/linux/man-pages/man2/fork.2.html
+		const pid_t processId = fork();
+		if (processId == -1)
+			throw LastError("ProcessPool::StartProcess(): fork() failed");
+		if (processId > 0)
+			return processId;
+
+		// https://man7.org/linux/man-pages/man2/chdir.2.html
+		if (startingDirectory.empty() == false && chdir(startingDirectory.c_str()) == -1)
+			_exit(127);
+		// https://man7.org/linux/man-pages/man3/exec.3.html
+		execv(executablePath.c_str(), argv.data());
+		_exit(127);
+	}
+
+	void ProcessPool::KillProcess(const pid_t processId) noexcept
+	{
+		// https://man7.org/linux/man-pages/man2/kill.2.html
+		kill(processId, SIGKILL);
+		// https://man7.org/linux/man-pages/man2/waitpid.2.html
+		while (waitpid(processId, nullptr, 0) == -1 && errno == EINTR);
+	}
+
+	void ProcessPool::ReapExited()
+	{
+		std::scoped_lock lock(m_mutex);
+		std::erase_if(
+			m_exiting,
+			[](const pid_t processId) { return waitpid(processId, nullptr, WNOHANG) != 0; }
+		);
+	}
+
+	void ProcessPool::KillAll() noexcept
+	{
+		std::scoped_lock lock(m_mutex);
+		for (const std::unique_ptr<Worker>& worker : m_idle)
+			KillProcess(worker->ProcessId);
+		m_idle.clear();
+		for (const pid_t processId : m_exiting)
+			KillProcess(processId);
+		m_exiting.clear();
+	}
+}
@@ -0,0 +1,65 @@
+#include <sys/socket.h>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+#include "include/Async/ProcessPoolWorker.hpp"
+
+namespace Boring32::Async
+{
+	ProcessPoolWorker::~ProcessPoolWorker()
+	{
+		m_channel.Close();
+	}
+
+	ProcessPoolWorker::ProcessPoolWorker(std::wstring pipeName)
+	:	m_pipeName(std::move(pipeName)),
+		m_channel(m_pipeName)
+	{ }
+
+	void ProcessPoolWorker::Run(const std::function<std::wstring(const std::wstring&)>& handler)
+	{
+		if (handler == nullptr)
+			throw std::invalid_argument("ProcessPoolWorker::Run(): handler is nullptr");
+
+		Connect();
+		std::wstring request;
+		while (ReadRequest(request))
+			WriteResponse(handler(request));
+		m_channel.Close();
+	}
+
+	const std::wstring& ProcessPoolWorker::GetPipeName() const noexcept
+	{
+		return m_pipeName;
+	}
+
+	void ProcessPoolWorker::Connect()
+	{
+		m_channel.Connect();
+	}
+
+	bool ProcessPoolWorker::ReadRequest(std::wstring& request)
+	{
+		// Peeking at the next packet tells the pool closing the channel
+		// apart from a failed read, which Read() reports the same way
+		char next = 0;
+		while (true)
+		{
+			// https://man7.org/linux/man-pages/man2/recv.2.html
+			const ssize_t bytesRead = recv(m_channel.GetSocket(), &next, sizeof(next), MSG_PEEK);
+			if (bytesRead == 0)
+				return false;
+			if (bytesRead > 0)
+				break;
+			if (errno != EINTR)
+				throw std::system_error(errno, std::system_category(), "ProcessPoolWorker::ReadRequest(): recv() failed");
+		}
+		request = m_channel.Read();
+		return true;
+	}
+
+	void ProcessPoolWorker::WriteResponse(const std::wstring& response)
+	{
+		m_channel.Write(response);
+	}
+}
@@ -0,0 +1,434 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <utility>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/CriticalSectionLock.hpp"
+#include "include/Async/ProcessOutputCapture.hpp"
+
+namespace Boring32::Async
+{
+	ProcessOutputCapture::~ProcessOutputCapture()
+	{
+		m_stop.Signal(std::nothrow);
+		if (m_started)
+			m_reader.Join(INFINITE);
+		DeleteCriticalSection(&m_cs);
+	}
+
+	ProcessOutputCapture::ProcessOutputCapture()
+	:	ProcessOutputCapture(ProcessOutputCaptureSettings{})
+	{ }
+
+	ProcessOutputCapture::ProcessOutputCapture(const ProcessOutputCaptureSettings& settings)
+	:	m_settings(settings),
+		m_pool(settings.BufferSize, settings.MaxBuffers),
+		m_chunksReady(false, true, false),
+		m_stop(false, true, false),
+		m_started(false),
+		m_readerDone(false)
+	{
+		if (settings.MaxLineLength == 0)
+			throw std::invalid_argument(__FUNCSIG__ ": MaxLineLength must be greater than 0");
+		InitializeCriticalSection(&m_cs);
+		try
+		{
+			CreateStreamPipe(GetState(OutputStream::StdOut), L"out");
+			CreateStreamPipe(GetState(OutputStream::StdErr), L"err");
+		}
+		catch (...)
+		{
+			DeleteCriticalSection(&m_cs);
+			throw;
+		}
+		m_ready.reserve(settings.MaxBuffers + 2);
+		m_pumping.reserve(settings.MaxBuffers + 2);
+	}
+
+	void ProcessOutputCapture::CreateStreamPipe(StreamState& state, const std::wstring& suffix)
+	{
+		static std::atomic<UINT64> pipeCounter = 0;
+		const std::wstring pipeName =
+			L"\\\\.\\pipe\\Boring32.ProcessOutputCapture."
+			+ std::to_wstring(GetCurrentProcessId())
+			+ L"."
+			+ std::to_wstring(pipeCounter++)
+			+ L"."
+			+ suffix;
+
+		// Anonymous pipes don't support overlapped reads, so use a named
+		// pipe that only this process can connect to
+		// https://docs.microsoft.com/en-us/windows/win32/api/winbase/nf-winbase-createnamedpipew
+		state.Read = CreateNamedPipeW(
+			pipeName.c_str(),
+			PIPE_ACCESS_INBOUND | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+			PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+			1,
+			m_settings.BufferSize,
+			m_settings.BufferSize,
+			0,
+			nullptr
+		);
+		if (state.Read == nullptr)
+			throw Error::Win32Error(__FUNCSIG__ ": CreateNamedPipeW() failed", GetLastError());
+
+		SECURITY_ATTRIBUTES sa{ 0 };
+		sa.nLength = sizeof(sa);
+		sa.bInheritHandle = true;
+		state.ChildWrite = CreateFileW(
+			pipeName.c_str(),
+			GENERIC_WRITE,
+			0,
+			&sa,
+			OPEN_EXISTING,
+			0,
+			nullptr
+		);
+		if (state.ChildWrite == nullptr)
+			throw Error::Win32Error(__FUNCSIG__ ": CreateFileW() failed", GetLastError());
+
+		if (m_settings.Backpressure == OutputBackpressure::Drop)
+			state.Discard = std::make_unique<std::byte[]>(m_settings.BufferSize);
+	}
+
+	STARTUPINFO ProcessOutputCapture::GetStartupInfo() const noexcept
+	{
+		STARTUPINFO startupInfo{ 0 };
+		startupInfo.cb = sizeof(startupInfo);
+		startupInfo.dwFlags = STARTF_USESTDHANDLES;
+		startupInfo.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+		startupInfo.hStdOutput = m_streams[(int)OutputStream::StdOut].ChildWrite.GetHandle();
+		startupInfo.hStdError = m_streams[(int)OutputStream::StdErr].ChildWrite.GetHandle();
+		return startupInfo;
+	}
+
+	void ProcessOutputCapture::Start()
+	{
+		if (m_started)
+			throw std::runtime_error(__FUNCSIG__ ": capture has already started");
+
+		// Once the child holds the only write handles, the reads complete
+		// with ERROR_BROKEN_PIPE when it exits
+		for (StreamState& state : m_streams)
+			state.ChildWrite.Close();
+		m_reader.Start([this](void*) -> int { return (int)ReaderLoop(); });
+		m_started = true;
+	}
+
+	bool ProcessOutputCapture::Pump(const LineHandler& handler, const DWORD timeoutMillis)
+	{
+		if (handler == nullptr)
+			throw std::invalid_argument(__FUNCSIG__ ": handler is nullptr");
+		if (m_started == false)
+			throw std::runtime_error(__FUNCSIG__ ": capture has not been started");
+		if (GetState(OutputStream::StdOut).ConsumerEnded && GetState(OutputStream::StdErr).ConsumerEnded)
+			return false;
+
+		m_chunksReady.WaitOnEvent(timeoutMillis, false);
+		bool readerDone = false;
+		std::string readerError;
+		{
+			CriticalSectionLock cs(m_cs);
+			m_pumping.swap(m_ready);
+			readerDone = m_readerDone;
+			readerError = m_readerError;
+			if (readerDone == false)
+				m_chunksReady.Reset();
+		}
+
+		for (size_t i = 0; i < m_pumping.size(); i++)
+		{
+			try
+			{
+				SplitLines(m_pumping[i], handler);
+			}
+			catch (...)
+			{
+				for (size_t j = i; j < m_pumping.size(); j++)
+					ReleaseChunk(m_pumping[j]);
+				m_pumping.clear();
+				throw;
+			}
+			ReleaseChunk(m_pumping[i]);
+		}
+		m_pumping.clear();
+
+		if (readerError.empty() == false)
+			throw std::runtime_error(__FUNCSIG__ ": reading output failed: " + readerError);
+		if (GetState(OutputStream::StdOut).ConsumerEnded && GetState(OutputStream::StdErr).ConsumerEnded)
+			return false;
+		// The reader stopped early, so no more output will arrive
+		return readerDone == false;
+	}
+
+	void ProcessOutputCapture::Run(const LineHandler& handler)
+	{
+		while (Pump(handler, INFINITE));
+	}
+
+	UINT64 ProcessOutputCapture::GetBytesRead(const OutputStream stream) const noexcept
+	{
+		return m_streams[(int)stream].BytesRead;
+	}
+
+	UINT64 ProcessOutputCapture::GetDroppedBytes(const OutputStream stream) const noexcept
+	{
+		return m_streams[(int)stream].DroppedBytes;
+	}
+
+	void ProcessOutputCapture::SplitLines(const Chunk& chunk, const LineHandler& handler)
+	{
+		StreamState& state = GetState(chunk.Stream);
+		if (chunk.FollowsGap)
+			state.Carry.clear();
+		if (chunk.EndOfStream)
+		{
+			state.ConsumerEnded = true;
+			if (state.Carry.empty())
+				return;
+			std::string_view line(state.Carry);
+			if (line.back() == '\r')
+				line.remove_suffix(1);
+			DeliverLine(chunk.Stream, line, handler);
+			state.Carry.clear();
+			return;
+		}
+
+		const char* begin = reinterpret_cast<const char*>(chunk.Buffer);
+		const char* const end = begin + chunk.Length;
+		while (true)
+		{
+			// memchr() is vectorised by the CRT, which makes this much
+			// faster than scanning byte by byte
+			const char* newline = static_cast<const char*>(
+				std::memchr(begin, '\n', end - begin)
+			);
+			if (newline == nullptr)
+				break;
+
+			// Only lines that straddle two reads are copied
+			std::string_view line(begin, newline - begin);
+			if (state.Carry.empty() == false)
+			{
+				AppendCarry(state, chunk.Stream, line, handler);
+				line = state.Carry;
+			}
+			if (line.empty() == false && line.back() == '\r')
+				line.remove_suffix(1);
+			DeliverLine(chunk.Stream, line, handler);
+			state.Carry.clear();
+			begin = newline + 1;
+		}
+		AppendCarry(state, chunk.Stream, std::string_view(begin, end - begin), handler);
+	}
+
+	void ProcessOutputCapture::DeliverLine(
+		const OutputStream stream,
+		std::string_view line,
+		const LineHandler& handler
+	)
+	{
+		while (line.size() > m_settings.MaxLineLength)
+		{
+			handler(stream, line.substr(0, m_settings.MaxLineLength));
+			line.remove_prefix(m_settings.MaxLineLength);
+		}
+		handler(stream, line);
+	}
+
+	void ProcessOutputCapture::AppendCarry(
+		StreamState& state,
+		const OutputStream stream,
+		const std::string_view data,
+		const LineHandler& handler
+	)
+	{
+		state.Carry.append(data);
+		// Keep up to MaxLineLength bytes, so the rest of the line, when
+		// it arrives, completes a final piece that is never empty
+		if (state.Carry.size() <= m_settings.MaxLineLength)
+			return;
+		const size_t keep = (state.Carry.size() - 1) % m_settings.MaxLineLength + 1;
+		const std::string_view full(state.Carry.data(), state.Carry.size() - keep);
+		for (size_t offset = 0; offset < full.size(); offset += m_settings.MaxLineLength)
+			handler(stream, full.substr(offset, m_settings.MaxLineLength));
+		state.Carry.erase(0, full.size());
+	}
+
+	UINT ProcessOutputCapture::ReaderLoop()
+	{
+		try
+		{
+			bool stopped = IssueRead(OutputStream::StdOut) == false
+				|| IssueRead(OutputStream::StdErr) == false;
+			while (stopped == false)
+			{
+				HANDLE handles[3] = { m_stop.GetHandle() };
+				DWORD count = 1;
+				for (StreamState& state : m_streams)
+					if (state.Ended == false)
+						handles[count++] = state.ReadDone.GetHandle();
+				if (count == 1)
+					break;
+
+				const DWORD result = WaitForMultipleObjects(count, handles, false, INFINITE);
+				if (result == WAIT_OBJECT_0)
+					break;
+				if (result == WAIT_FAILED)
+					throw Error::Win32Error(__FUNCSIG__ ": WaitForMultipleObjects() failed", GetLastError());
+
+				// Check both streams, so a busy stdout can't starve stderr
+				for (const OutputStream stream : { OutputStream::StdOut, OutputStream::StdErr })
+				{
+					StreamState& state = GetState(stream);
+					if (state.Ended || WaitForSingleObject(state.ReadDone.GetHandle(), 0) != WAIT_OBJECT_0)
+						continue;
+					CompleteRead(stream);
+					if (state.Ended == false && IssueRead(stream) == false)
+					{
+						stopped = true;
+						break;
+					}
+				}
+			}
+		}
+		catch (const std::exception& ex)
+		{
+			CriticalSectionLock cs(m_cs);
+			m_readerError = ex.what();
+		}
+
+		// Make sure the kernel is done with our buffers before returning
+		for (StreamState& state : m_streams)
+		{
+			if (state.ReadPending == false)
+				continue;
+			DWORD bytesTransferred = 0;
+			CancelIoEx(state.Read.GetHandle(), &state.Overlapped);
+			GetOverlappedResult(state.Read.GetHandle(), &state.Overlapped, &bytesTransferred, true);
+			state.ReadPending = false;
+			if (state.IsDiscarding == false)
+				m_pool.Release(state.Buffer);
+		}
+
+		CriticalSectionLock cs(m_cs);
+		m_readerDone = true;
+		m_chunksReady.Signal();
+		return 0;
+	}
+
+	bool ProcessOutputCapture::IssueRead(const OutputStream stream)
+	{
+		StreamState& state = GetState(stream);
+		std::byte* buffer = m_pool.Acquire(0);
+		while (buffer == nullptr && m_settings.Backpressure == OutputBackpressure::Block)
+		{
+			// Every buffer is waiting to be pumped; stop reading until one
+			// comes back, which in turn stalls the child on a full pipe
+			const HANDLE handles[] = { m_stop.GetHandle(), m_pool.GetReleasedHandle() };
+			const DWORD result = WaitForMultipleObjects(2, handles, false, INFINITE);
+			if (result == WAIT_OBJECT_0)
+				return false;
+			if (result == WAIT_FAILED)
+				throw Error::Win32Error(__FUNCSIG__ ": WaitForMultipleObjects() failed", GetLastError());
+			buffer = m_pool.Acquire(0);
+		}
+		state.IsDiscarding = buffer == nullptr;
+		state.Buffer = state.IsDiscarding ? state.Discard.get() : buffer;
+
+		state.ReadDone.Reset();
+		state.Overlapped = OVERLAPPED{ 0 };
+		state.Overlapped.hEvent = state.ReadDone.GetHandle();
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-readfile
+		const bool succeeded = ReadFile(
+			state.Read.GetHandle(),
+			state.Buffer,
+			m_settings.BufferSize,
+			nullptr,
+			&state.Overlapped
+		);
+		const DWORD lastError = GetLastError();
+		// Reads that complete immediately still signal the event
+		if (succeeded || lastError == ERROR_IO_PENDING)
+		{
+			state.ReadPending = true;
+			return true;
+		}
+
+		if (state.IsDiscarding == false)
+			m_pool.Release(state.Buffer);
+		if (lastError != ERROR_BROKEN_PIPE)
+			throw Error::Win32Error(__FUNCSIG__ ": ReadFile() failed", lastError);
+		EndStream(stream);
+		return true;
+	}
+
+	void ProcessOutputCapture::CompleteRead(const OutputStream stream)
+	{
+		StreamState& state = GetState(stream);
+		state.ReadPending = false;
+		DWORD bytesRead = 0;
+		if (GetOverlappedResult(state.Read.GetHandle(), &state.Overlapped, &bytesRead, false) == false)
+		{
+			const DWORD lastError = GetLastError();
+			if (state.IsDiscarding == false)
+				m_pool.Release(state.Buffer);
+			if (lastError != ERROR_BROKEN_PIPE)
+				throw Error::Win32Error(__FUNCSIG__ ": GetOverlappedResult() failed", lastError);
+			EndStream(stream);
+			return;
+		}
+
+		state.BytesRead += bytesRead;
+		if (state.IsDiscarding)
+		{
+			state.DroppedBytes += bytesRead;
+			state.GapPending = state.GapPending || bytesRead > 0;
+			return;
+		}
+		if (bytesRead == 0)
+		{
+			m_pool.Release(state.Buffer);
+			return;
+		}
+
+		Enqueue(Chunk{
+			.Stream = stream,
+			.Buffer = state.Buffer,
+			.Length = bytesRead,
+			.FollowsGap = std::exchange(state.GapPending, false),
+			.EndOfStream = false
+		});
+	}
+
+	void ProcessOutputCapture::EndStream(const OutputStream stream)
+	{
+		StreamState& state = GetState(stream);
+		state.Ended = true;
+		Enqueue(Chunk{
+			.Stream = stream,
+			.Buffer = nullptr,
+			.Length = 0,
+			.FollowsGap = std::exchange(state.GapPending, false),
+			.EndOfStream = true
+		});
+	}
+
+	void ProcessOutputCapture::Enqueue(const Chunk& chunk)
+	{
+		CriticalSectionLock cs(m_cs);
+		m_ready.push_back(chunk);
+		m_chunksReady.Signal();
+	}
+
+	void ProcessOutputCapture::ReleaseChunk(const Chunk& chunk)
+	{
+		if (chunk.Buffer != nullptr)
+			m_pool.Release(chunk.Buffer);
+	}
+
+	ProcessOutputCapture::StreamState& ProcessOutputCapture::GetState(const OutputStream stream) noexcept
+	{
+		return m_streams[(int)stream];
+	}
+}
@@ -0,0 +1,340 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/CriticalSectionLock.hpp"
+#include "include/Async/ProcessPool.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		constexpr UINT64 NoDeadline = MAXUINT64;
+
+		UINT64 ToDeadline(const DWORD timeoutMillis)
+		{
+			return timeoutMillis == INFINITE
+				? NoDeadline
+				: GetTickCount64() + timeoutMillis;
+		}
+	}
+
+	ProcessPool::~ProcessPool()
+	{
+		{
+			CriticalSectionLock cs(m_cs);
+			// Closing the channels lets idle workers exit cleanly;
+			// closing the Job then kills anything left over
+			m_idle.clear();
+		}
+		m_job.Close();
+		DeleteCriticalSection(&m_cs);
+	}
+
+	ProcessPool::ProcessPool(
+		std::wstring executablePath,
+		std::wstring commandLine,
+		std::wstring startingDirectory,
+		const std::uint32_t workerCount,
+		const std::uint32_t maxJobsPerWorker
+	)
+	:	ProcessPool(
+			std::move(executablePath),
+			std::move(commandLine),
+			std::move(startingDirectory),
+			workerCount,
+			maxJobsPerWorker,
+			0,
+			JOBOBJECT_EXTENDED_LIMIT_INFORMATION{ 0 }
+		)
+	{ }
+
+	ProcessPool::ProcessPool(
+		std::wstring executablePath,
+		std::wstring commandLine,
+		std::wstring startingDirectory,
+		const std::uint32_t workerCount,
+		const std::uint32_t maxJobsPerWorker,
+		const DWORD creationFlags,
+		const JOBOBJECT_EXTENDED_LIMIT_INFORMATION& limits
+	)
+	:	m_executablePath(std::move(executablePath)),
+		m_commandLine(std::move(commandLine)),
+		m_startingDirectory(std::move(startingDirectory)),
+		m_workerCount(workerCount),
+		m_maxJobsPerWorker(maxJobsPerWorker),
+		m_creationFlags(creationFlags),
+		m_job(false),
+		m_available(L"", false, workerCount, workerCount),
+		m_spawnCount(0)
+	{
+		InitializeCriticalSection(&m_cs);
+		try
+		{
+			Create(limits);
+		}
+		catch (...)
+		{
+			m_idle.clear();
+			DeleteCriticalSection(&m_cs);
+			throw;
+		}
+	}
+
+	void ProcessPool::Create(const JOBOBJECT_EXTENDED_LIMIT_INFORMATION& limits)
+	{
+		JOBOBJECT_EXTENDED_LIMIT_INFORMATION jeli = limits;
+		jeli.BasicLimitInformation.LimitFlags |= JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+		m_job.SetInformation(jeli);
+
+		m_idle.reserve(m_workerCount);
+		for (std::uint32_t i = 0; i < m_workerCount; i++)
+			m_idle.push_back(CreateWorker());
+	}
+
+	std::wstring ProcessPool::Submit(const std::wstring& request, const std::uint32_t timeoutMillis)
+	{
+		std::unique_ptr<Worker> worker = AcquireWorker(timeoutMillis);
+		std::wstring response;
+		try
+		{
+			response = Exchange(*worker, request, timeoutMillis);
+		}
+		catch (...)
+		{
+			// The worker is in an unknown state, so don't reuse it
+			KillWorker(std::move(worker));
+			throw;
+		}
+
+		worker->JobsCompleted++;
+		// Dropping the worker closes its channel, which tells it to exit;
+		// its replacement is started the next time the slot is acquired
+		if (m_maxJobsPerWorker > 0 && worker->JobsCompleted >= m_maxJobsPerWorker)
+			worker = nullptr;
+		ReleaseWorker(std::move(worker));
+		return response;
+	}
+
+	bool ProcessPool::Submit(
+		const std::wstring& request,
+		const std::uint32_t timeoutMillis,
+		std::wstring& response,
+		std::nothrow_t
+	) noexcept
+	{
+		try
+		{
+			response = Submit(request, timeoutMillis);
+			return true;
+		}
+		catch (const std::exception& ex)
+		{
+			std::wcerr
+				<< __FUNCSIG__
+				<< L": Submit() failed: "
+				<< ex.what()
+				<< std::endl;
+			return false;
+		}
+	}
+
+	std::uint32_t ProcessPool::GetWorkerCount() const noexcept
+	{
+		return m_workerCount;
+	}
+
+	std::uint32_t ProcessPool::GetMaxJobsPerWorker() const noexcept
+	{
+		return m_maxJobsPerWorker;
+	}
+
+	size_t ProcessPool::GetIdleCount()
+	{
+		CriticalSectionLock cs(m_cs);
+		return m_idle.size();
+	}
+
+	std::uint64_t ProcessPool::GetSpawnCount() const noexcept
+	{
+		return m_spawnCount;
+	}
+
+	Job& ProcessPool::GetJob() noexcept
+	{
+		return m_job;
+	}
+
+	std::unique_ptr<ProcessPool::Worker> ProcessPool::CreateWorker()
+	{
+		static std::atomic<UINT64> pipeCounter = 0;
+		const std::wstring pipeName =
+			L"\\\\.\\pipe\\Boring32.ProcessPool."
+			+ std::to_wstring(GetCurrentProcessId())
+			+ L"."
+			+ std::to_wstring(pipeCounter++);
+
+		auto worker = std::make_unique<Worker>();
+		worker->Pipe = std::make_unique<OverlappedNamedPipeServer>(
+			pipeName,
+			PipeBufferSize,
+			1,
+			L"",
+			false,
+			true
+		);
+		OverlappedOp connectOp;
+		worker->Pipe->Connect(connectOp);
+
+		bool started = false;
+		try
+		{
+			// Start suspended so the worker is in the Job before it runs
+			STARTUPINFO startupInfo{ 0 };
+			worker->WorkerProcess = Process(
+				m_executablePath,
+				m_commandLine + L" " + pipeName,
+				m_startingDirectory,
+				false,
+				m_creationFlags | CREATE_SUSPENDED,
+				startupInfo
+			);
+			worker->WorkerProcess.Start();
+			started = true;
+			m_spawnCount++;
+			m_job.AssignProcessToThisJob(worker->WorkerProcess.GetProcessHandle());
+			if (ResumeThread(worker->WorkerProcess.GetThreadHandle()) == (DWORD)-1)
+				throw Error::Win32Error(__FUNCSIG__ ": ResumeThread() failed", GetLastError());
+			// ERROR_PIPE_CONNECTED means the worker connected before we waited
+			if (connectOp.LastError() != ERROR_PIPE_CONNECTED)
+				WaitForIo(*worker, connectOp, ToDeadline(StartupTimeoutMillis));
+		}
+		catch (...)
+		{
+			// connectOp's OVERLAPPED goes out of scope before the pipe is
+			// closed, so the connect must not be left pending on it
+			CancelIo(*worker, connectOp);
+			if (started)
+				TerminateProcess(worker->WorkerProcess.GetProcessHandle(), 1);
+			throw;
+		}
+		// Only the process handle is needed from here on
+		worker->WorkerProcess.CloseThreadHandle();
+		return worker;
+	}
+
+	std::unique_ptr<ProcessPool::Worker> ProcessPool::AcquireWorker(const std::uint32_t timeoutMillis)
+	{
+		if (m_available.Acquire(timeoutMillis) == false)
+			throw std::runtime_error(__FUNCSIG__ ": timed out waiting for an idle worker");
+
+		{
+			CriticalSectionLock cs(m_cs);
+			if (m_idle.empty() == false)
+			{
+				std::unique_ptr<Worker> worker = std::move(m_idle.back());
+				m_idle.pop_back();
+				return worker;
+			}
+		}
+
+		// This slot's worker was recycled or killed, so start its replacement
+		try
+		{
+			return CreateWorker();
+		}
+		catch (...)
+		{
+			m_available.Release();
+			throw;
+		}
+	}
+
+	void ProcessPool::ReleaseWorker(std::unique_ptr<Worker> worker)
+	{
+		if (worker != nullptr)
+		{
+			CriticalSectionLock cs(m_cs);
+			m_idle.push_back(std::move(worker));
+		}
+		m_available.Release();
+	}
+
+	void ProcessPool::KillWorker(std::unique_ptr<Worker> worker)
+	{
+		TerminateProcess(worker->WorkerProcess.GetProcessHandle(), 1);
+		worker = nullptr;
+		ReleaseWorker(nullptr);
+	}
+
+	std::wstring ProcessPool::Exchange(
+		Worker& worker,
+		const std::wstring& request,
+		const std::uint32_t timeoutMillis
+	)
+	{
+		const UINT64 deadline = ToDeadline(timeoutMillis);
+
+		OverlappedIo writeOp;
+		worker.Pipe->Write(request, writeOp);
+		WaitForIo(worker, writeOp, deadline);
+		if (writeOp.IsSuccessful() == false)
+			throw std::runtime_error(__FUNCSIG__ ": failed to write request to worker");
+
+		// Responses larger than the pipe buffer arrive in several parts
+		std::wstring response;
+		while (true)
+		{
+			OverlappedIo readOp;
+			worker.Pipe->Read(PipeBufferSize / sizeof(wchar_t), readOp);
+			WaitForIo(worker, readOp, deadline);
+			if (readOp.IsSuccessful() == false && readOp.IsPartial() == false)
+				throw std::runtime_error(__FUNCSIG__ ": failed to read response from worker");
+			response.append(
+				readOp.IoBuffer.c_str(),
+				readOp.GetBytesTransferred() / sizeof(wchar_t)
+			);
+			if (readOp.IsSuccessful())
+				return response;
+		}
+	}
+
+	void ProcessPool::WaitForIo(Worker& worker, OverlappedOp& op, const UINT64 deadline)
+	{
+		const UINT64 now = GetTickCount64();
+		DWORD timeout = INFINITE;
+		if (deadline != NoDeadline)
+			timeout = deadline > now ? (DWORD)(deadline - now) : 0;
+
+		// The I/O comes first, so a response written just before the
+		// worker exited is still picked up
+		const HANDLE handles[] = {
+			op.GetWaitableHandle(),
+			worker.WorkerProcess.GetProcessHandle()
+		};
+		// https://docs.microsoft.com/en-us/windows/win32/api/synchapi/nf-synchapi-waitformultipleobjects
+		const DWORD result = WaitForMultipleObjects(2, handles, false, timeout);
+		if (result == WAIT_OBJECT_0)
+			return;
+		const DWORD lastError = GetLastError();
+
+		CancelIo(worker, op);
+		if (result == WAIT_OBJECT_0 + 1)
+			throw std::runtime_error(__FUNCSIG__ ": the worker process exited");
+		if (result == WAIT_TIMEOUT)
+			throw std::runtime_error(__FUNCSIG__ ": timed out waiting for the worker");
+		throw Error::Win32Error(__FUNCSIG__ ": WaitForMultipleObjects() failed", lastError);
+	}
+
+	void ProcessPool::CancelIo(Worker& worker, OverlappedOp& op) noexcept
+	{
+		// Cancel the operation if it is still outstanding, and wait for
+		// the cancellation to land before the OVERLAPPED can be released.
+		// An operation that never went pending has nothing to wait for.
+		if (op.LastError() != ERROR_IO_PENDING)
+			return;
+		const HANDLE pipe = worker.Pipe->GetInternalHandle().GetHandle();
+		CancelIoEx(pipe, op.GetOverlapped());
+		DWORD bytesTransferred = 0;
+		GetOverlappedResult(pipe, op.GetOverlapped(), &bytesTransferred, true);
+	}
+}
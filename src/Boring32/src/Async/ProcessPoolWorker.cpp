@@ -0,0 +1,99 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/ProcessPoolWorker.hpp"
+
+namespace Boring32::Async
+{
+	ProcessPoolWorker::~ProcessPoolWorker()
+	{
+		m_pipe.Close();
+	}
+
+	ProcessPoolWorker::ProcessPoolWorker(std::wstring pipeName)
+	:	m_pipeName(std::move(pipeName))
+	{
+		m_buffer.resize(1024);
+	}
+
+	void ProcessPoolWorker::Run(const std::function<std::wstring(const std::wstring&)>& handler)
+	{
+		if (handler == nullptr)
+			throw std::invalid_argument(__FUNCSIG__ ": handler is nullptr");
+
+		Connect();
+		std::wstring request;
+		while (ReadRequest(request))
+			WriteResponse(handler(request));
+		m_pipe.Close();
+	}
+
+	const std::wstring& ProcessPoolWorker::GetPipeName() const noexcept
+	{
+		return m_pipeName;
+	}
+
+	void ProcessPoolWorker::Connect()
+	{
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-createfilew
+		const HANDLE pipe = CreateFileW(
+			m_pipeName.c_str(),
+			GENERIC_READ | GENERIC_WRITE,
+			0,
+			nullptr,
+			OPEN_EXISTING,
+			0,
+			nullptr
+		);
+		if (pipe == INVALID_HANDLE_VALUE)
+			throw Error::Win32Error(__FUNCSIG__ ": CreateFileW() failed", GetLastError());
+		m_pipe = pipe;
+
+		// Clients always open pipes in byte-read mode
+		DWORD mode = PIPE_READMODE_MESSAGE;
+		if (SetNamedPipeHandleState(m_pipe.GetHandle(), &mode, nullptr, nullptr) == false)
+			throw Error::Win32Error(__FUNCSIG__ ": SetNamedPipeHandleState() failed", GetLastError());
+	}
+
+	bool ProcessPoolWorker::ReadRequest(std::wstring& request)
+	{
+		request.clear();
+		while (true)
+		{
+			DWORD bytesRead = 0;
+			// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-readfile
+			const bool succeeded = ReadFile(
+				m_pipe.GetHandle(),
+				&m_buffer[0],
+				(DWORD)(m_buffer.size() * sizeof(wchar_t)),
+				&bytesRead,
+				nullptr
+			);
+			const DWORD lastError = GetLastError();
+			request.append(m_buffer.c_str(), bytesRead / sizeof(wchar_t));
+			if (succeeded)
+				return true;
+			if (lastError == ERROR_MORE_DATA)
+				continue;
+			// The pool closed the channel
+			if (lastError == ERROR_BROKEN_PIPE || lastError == ERROR_PIPE_NOT_CONNECTED)
+				return false;
+			throw Error::Win32Error(__FUNCSIG__ ": ReadFile() failed", lastError);
+		}
+	}
+
+	void ProcessPoolWorker::WriteResponse(const std::wstring& response)
+	{
+		DWORD bytesWritten = 0;
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-writefile
+		const bool succeeded = WriteFile(
+			m_pipe.GetHandle(),
+			response.c_str(),
+			(DWORD)(response.size() * sizeof(wchar_t)),
+			&bytesWritten,
+			nullptr
+		);
+		if (succeeded == false)
+			throw Error::Win32Error(__FUNCSIG__ ": WriteFile() failed", GetLastError());
+	}
+}
@@ -0,0 +1,261 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cstddef>
+#include <winternl.h>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/ProcessSnapshot.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		// From ntstatus.h, which conflicts with Windows.h
+		constexpr NTSTATUS StatusInfoLengthMismatch = (NTSTATUS)0xC0000004L;
+
+		// winternl.h leaves the process's times in Reserved1, which holds
+		// WorkingSetPrivateSize, HardFaultCount, NumberOfThreadsHighWatermark
+		// and CycleTime, followed by CreateTime. Reading it here saves
+		// opening every process to call GetProcessTimes().
+		// https://docs.microsoft.com/en-us/windows/win32/api/winternl/nf-winternl-ntquerysysteminformation
+		constexpr size_t CreateTimeOffset = 24;
+		static_assert(sizeof(SYSTEM_PROCESS_INFORMATION::Reserved1) >= CreateTimeOffset + sizeof(LARGE_INTEGER));
+
+		UINT64 GetCreationTime(const SYSTEM_PROCESS_INFORMATION* info) noexcept
+		{
+			LARGE_INTEGER createTime{ 0 };
+			std::memcpy(&createTime, info->Reserved1 + CreateTimeOffset, sizeof(createTime));
+			return createTime.QuadPart;
+		}
+	}
+
+	ProcessSnapshot::~ProcessSnapshot() { }
+
+	ProcessSnapshot::ProcessSnapshot()
+	:	m_generation(0)
+	{
+		Refresh();
+	}
+
+	ProcessSnapshot::ProcessSnapshot(const ProcessSnapshot& other)
+	:	m_generation(0)
+	{
+		Copy(other);
+	}
+
+	ProcessSnapshot& ProcessSnapshot::operator=(const ProcessSnapshot& other)
+	{
+		Copy(other);
+		return *this;
+	}
+
+	ProcessSnapshot::ProcessSnapshot(ProcessSnapshot&& other) noexcept
+	:	m_generation(0)
+	{
+		Move(other);
+	}
+
+	ProcessSnapshot& ProcessSnapshot::operator=(ProcessSnapshot&& other) noexcept
+	{
+		Move(other);
+		return *this;
+	}
+
+	void ProcessSnapshot::Copy(const ProcessSnapshot& other)
+	{
+		m_entries = other.m_entries;
+		m_byName = other.m_byName;
+		m_generation = other.m_generation;
+	}
+
+	void ProcessSnapshot::Move(ProcessSnapshot& other) noexcept
+	{
+		m_entries = std::move(other.m_entries);
+		m_byName = std::move(other.m_byName);
+		m_buffer = std::move(other.m_buffer);
+		m_generation = other.m_generation;
+	}
+
+	void ProcessSnapshot::Refresh()
+	{
+		QueryProcesses();
+		m_generation++;
+
+		const std::byte* current = m_buffer.data();
+		while (true)
+		{
+			const auto info = reinterpret_cast<const SYSTEM_PROCESS_INFORMATION*>(current);
+			const DWORD processId = (DWORD)(ULONG_PTR)info->UniqueProcessId;
+			const std::wstring_view name(
+				info->ImageName.Buffer,
+				info->ImageName.Length / sizeof(wchar_t)
+			);
+
+			// An existing entry is reused unless its ID was recycled by a
+			// newer process, which may have the same name
+			const UINT64 creationTime = GetCreationTime(info);
+			auto iter = m_entries.find(processId);
+			if (iter != m_entries.end()
+				&& (iter->second.Entry.CreationTime != creationTime || iter->second.Entry.Name != name))
+			{
+				RemoveFromIndex(iter->second.Entry);
+				m_entries.erase(iter);
+				iter = m_entries.end();
+			}
+			if (iter == m_entries.end())
+			{
+				ProcessEntry entry{
+					.ProcessId = processId,
+					.SessionId = info->SessionId,
+					.CreationTime = creationTime,
+					.Name = std::wstring(name),
+					.NormalisedName = Normalise(std::wstring(name))
+				};
+				AddToIndex(entry);
+				iter = m_entries.emplace(processId, TrackedEntry{ std::move(entry), 0 }).first;
+			}
+			iter->second.Generation = m_generation;
+
+			if (info->NextEntryOffset == 0)
+				break;
+			current += info->NextEntryOffset;
+		}
+
+		// Anything not seen in this pass has exited
+		for (auto iter = m_entries.begin(); iter != m_entries.end();)
+		{
+			if (iter->second.Generation == m_generation)
+			{
+				iter++;
+				continue;
+			}
+			RemoveFromIndex(iter->second.Entry);
+			iter = m_entries.erase(iter);
+		}
+	}
+
+	std::vector<DWORD> ProcessSnapshot::FindByName(const std::wstring& name) const
+	{
+		std::vector<DWORD> processIds;
+		auto iter = m_byName.find(Normalise(name));
+		if (iter == m_byName.end())
+			return processIds;
+		processIds.reserve(iter->second.size());
+		for (const IndexedProcess& process : iter->second)
+			processIds.push_back(process.ProcessId);
+		return processIds;
+	}
+
+	std::vector<DWORD> ProcessSnapshot::FindByName(const std::wstring& name, const DWORD sessionId) const
+	{
+		std::vector<DWORD> processIds;
+		auto iter = m_byName.find(Normalise(name));
+		if (iter == m_byName.end())
+			return processIds;
+		for (const IndexedProcess& process : iter->second)
+			if (process.SessionId == sessionId)
+				processIds.push_back(process.ProcessId);
+		return processIds;
+	}
+
+	std::unordered_map<std::wstring, std::vector<DWORD>> ProcessSnapshot::FindByNames(
+		const std::vector<std::wstring>& names
+	) const
+	{
+		std::unordered_map<std::wstring, std::vector<DWORD>> results;
+		results.reserve(names.size());
+		for (const std::wstring& name : names)
+			results.emplace(name, FindByName(name));
+		return results;
+	}
+
+	bool ProcessSnapshot::GetProcessIdByName(
+		const std::wstring& name,
+		const int sessionIdToMatch,
+		DWORD& outResult
+	) const
+	{
+		auto iter = m_byName.find(Normalise(name));
+		if (iter == m_byName.end())
+			return false;
+		for (const IndexedProcess& process : iter->second)
+		{
+			if (sessionIdToMatch < 0 || process.SessionId == (DWORD)sessionIdToMatch)
+			{
+				outResult = process.ProcessId;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	const ProcessEntry* ProcessSnapshot::GetById(const DWORD processId) const
+	{
+		auto iter = m_entries.find(processId);
+		return iter == m_entries.end() ? nullptr : &iter->second.Entry;
+	}
+
+	size_t ProcessSnapshot::GetCount() const noexcept
+	{
+		return m_entries.size();
+	}
+
+	void ProcessSnapshot::QueryProcesses()
+	{
+		// The buffer is kept between refreshes, so it only grows when the
+		// process table does
+		if (m_buffer.empty())
+			m_buffer.resize(256 * 1024);
+
+		while (true)
+		{
+			ULONG requiredSize = 0;
+			// https://docs.microsoft.com/en-us/windows/win32/api/winternl/nf-winternl-ntquerysysteminformation
+			const NTSTATUS status = NtQuerySystemInformation(
+				SystemProcessInformation,
+				m_buffer.data(),
+				(ULONG)m_buffer.size(),
+				&requiredSize
+			);
+			if (status >= 0)
+				return;
+			if (status != StatusInfoLengthMismatch)
+				throw Error::Win32Error(
+					__FUNCSIG__ ": NtQuerySystemInformation() failed",
+					RtlNtStatusToDosError(status)
+				);
+			// Leave room for processes started since the size was reported
+			m_buffer.resize(requiredSize + 64 * 1024);
+		}
+	}
+
+	void ProcessSnapshot::AddToIndex(const ProcessEntry& entry)
+	{
+		m_byName[entry.NormalisedName].push_back(
+			IndexedProcess{ entry.ProcessId, entry.SessionId }
+		);
+	}
+
+	void ProcessSnapshot::RemoveFromIndex(const ProcessEntry& entry)
+	{
+		auto iter = m_byName.find(entry.NormalisedName);
+		if (iter == m_byName.end())
+			return;
+		std::vector<IndexedProcess>& processes = iter->second;
+		std::erase_if(
+			processes,
+			[&entry](const IndexedProcess& process) { return process.ProcessId == entry.ProcessId; }
+		);
+		if (processes.empty())
+			m_byName.erase(iter);
+	}
+
+	std::wstring ProcessSnapshot::Normalise(std::wstring name)
+	{
+		if (name.empty())
+			return name;
+		// https://docs.microsoft.com/en-us/windows/win32/api/winuser/nf-winuser-charlowerbuffw
+		CharLowerBuffW(name.data(), (DWORD)name.size());
+		return name;
+	}
+}
@@ -0,0 +1,229 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/RateLimiter.hpp"
+
+// The limiter uses the generic cell rate algorithm, which is equivalent to a
+// token bucket but needs only a single atomic to track the bucket's state.
+// https://en.wikipedia.org/wiki/Generic_cell_rate_algorithm
+namespace Boring32::Async
+{
+	RateLimiter::~RateLimiter() { }
+
+	RateLimiter::RateLimiter(const double tokensPerSecond, const UINT burst)
+	:	m_tokensPerSecond(tokensPerSecond),
+		m_burst(burst),
+		m_frequency(0),
+		m_epoch(0),
+		m_interval(0),
+		m_tolerance(0),
+		m_theoreticalArrival(0)
+	{
+		if (tokensPerSecond <= 0)
+			throw std::invalid_argument(__FUNCSIG__ ": tokensPerSecond must be greater than zero");
+		if (burst == 0)
+			throw std::invalid_argument(__FUNCSIG__ ": burst must be greater than zero");
+
+		LARGE_INTEGER value{ 0 };
+		// https://docs.microsoft.com/en-us/windows/win32/api/profileapi/nf-profileapi-queryperformancefrequency
+		QueryPerformanceFrequency(&value);
+		m_frequency = value.QuadPart;
+		QueryPerformanceCounter(&value);
+		m_epoch = value.QuadPart;
+
+		m_interval = static_cast<int64_t>(
+			static_cast<double>(m_frequency << FractionalBits) / tokensPerSecond
+		);
+		if (m_interval <= 0)
+			throw std::invalid_argument(__FUNCSIG__ ": tokensPerSecond exceeds the timer resolution");
+		m_tolerance = m_interval * burst;
+	}
+
+	bool RateLimiter::TryAcquire(const UINT tokens) noexcept
+	{
+		int64_t wait = 0;
+		return InternalReserve(tokens, 0, wait);
+	}
+
+	bool RateLimiter::Acquire(const UINT tokens, const DWORD millis)
+	{
+		ValidateTokens(tokens);
+
+		const int64_t maxWait = millis == INFINITE
+			? INT64_MAX
+			: ((static_cast<int64_t>(millis) * m_frequency) / 1000) << FractionalBits;
+		int64_t wait = 0;
+		if (InternalReserve(tokens, maxWait, wait) == false)
+			return false;
+		if (wait == 0)
+			return true;
+
+		WaitableTimer timer(L"", false, true);
+		timer.SetTimerInNanos(-ToHundredNanoseconds(wait), 0, nullptr, nullptr);
+		timer.WaitOnTimer(INFINITE);
+		return true;
+	}
+
+	int64_t RateLimiter::Reserve(const UINT tokens)
+	{
+		ValidateTokens(tokens);
+
+		int64_t wait = 0;
+		InternalReserve(tokens, INT64_MAX, wait);
+		return ToHundredNanoseconds(wait);
+	}
+
+	RateLimiter::Awaitable RateLimiter::AcquireAsync(const UINT tokens)
+	{
+		ValidateTokens(tokens);
+		return Awaitable(*this, tokens);
+	}
+
+	UINT RateLimiter::GetAvailableTokens() const noexcept
+	{
+		const int64_t now = Now();
+		const int64_t arrival = (std::max)(m_theoreticalArrival.load(std::memory_order_relaxed), now);
+		const int64_t headroom = m_tolerance - (arrival - now);
+		return headroom > 0 ? static_cast<UINT>(headroom / m_interval) : 0;
+	}
+
+	double RateLimiter::GetTokensPerSecond() const noexcept
+	{
+		return m_tokensPerSecond;
+	}
+
+	UINT RateLimiter::GetBurst() const noexcept
+	{
+		return m_burst;
+	}
+
+	int64_t RateLimiter::Now() const noexcept
+	{
+		LARGE_INTEGER counter{ 0 };
+		QueryPerformanceCounter(&counter);
+		return (counter.QuadPart - m_epoch) << FractionalBits;
+	}
+
+	void RateLimiter::ValidateTokens(const UINT tokens) const
+	{
+		if (tokens == 0)
+			throw std::invalid_argument(__FUNCSIG__ ": tokens must be greater than zero");
+		if (tokens > m_burst)
+			throw std::invalid_argument(__FUNCSIG__ ": tokens exceeds the burst size and can never be acquired");
+	}
+
+	bool RateLimiter::InternalReserve(
+		const UINT tokens,
+		const int64_t maxWait,
+		int64_t& outWait
+	) noexcept
+	{
+		if (tokens == 0 || tokens > m_burst)
+			return false;
+
+		const int64_t now = Now();
+		const int64_t cost = m_interval * tokens;
+		int64_t arrival = m_theoreticalArrival.load(std::memory_order_relaxed);
+		while (true)
+		{
+			const int64_t newArrival = (std::max)(arrival, now) + cost;
+			const int64_t wait = newArrival - now - m_tolerance;
+			if (wait > maxWait)
+				return false;
+			// On failure, arrival is refreshed with the value another thread stored
+			if (m_theoreticalArrival.compare_exchange_weak(
+				arrival,
+				newArrival,
+				std::memory_order_acq_rel,
+				std::memory_order_relaxed
+			))
+			{
+				outWait = wait > 0 ? wait : 0;
+				return true;
+			}
+		}
+	}
+
+	void RateLimiter::InternalRelease(const UINT tokens) noexcept
+	{
+		m_theoreticalArrival.fetch_sub(m_interval * tokens, std::memory_order_acq_rel);
+	}
+
+	int64_t RateLimiter::ToHundredNanoseconds(const int64_t ticks) const noexcept
+	{
+		if (ticks <= 0)
+			return 0;
+		// Round up so that a waiter never wakes before its tokens are due
+		const int64_t wholeTicks = (ticks >> FractionalBits) + 1;
+		return (wholeTicks * 10000000) / m_frequency + 1;
+	}
+
+	RateLimiter::Awaitable::~Awaitable()
+	{
+		// The wait is registered with WT_EXECUTEONLYONCE and its callback
+		// has run by now, but this may be destroyed on the callback's
+		// thread, so the unregistration must not wait for it
+		// https://docs.microsoft.com/en-us/windows/win32/sync/unregisterwaitex
+		if (m_wait != nullptr)
+			UnregisterWaitEx(m_wait, nullptr);
+	}
+
+	RateLimiter::Awaitable::Awaitable(RateLimiter& limiter, const UINT tokens)
+	:	m_limiter(limiter),
+		m_tokens(tokens),
+		m_wait(nullptr),
+		m_arrivals(0)
+	{ }
+
+	bool RateLimiter::Awaitable::await_ready()
+	{
+		return m_limiter.TryAcquire(m_tokens);
+	}
+
+	bool RateLimiter::Awaitable::await_suspend(std::coroutine_handle<> handle)
+	{
+		m_handle = handle;
+		const int64_t wait = m_limiter.Reserve(m_tokens);
+
+		try
+		{
+			m_timer = WaitableTimer(L"", false, true);
+			// A zero due time signals the timer immediately
+			m_timer.SetTimerInNanos(-wait, 0, nullptr, nullptr);
+			// https://docs.microsoft.com/en-us/windows/win32/api/winbase/nf-winbase-registerwaitforsingleobject
+			HANDLE registeredWait = nullptr;
+			const bool succeeded = RegisterWaitForSingleObject(
+				&registeredWait,
+				m_timer.GetHandle(),
+				OnTimer,
+				this,
+				INFINITE,
+				WT_EXECUTEONLYONCE
+			);
+			if (succeeded == false)
+				throw Error::Win32Error(__FUNCSIG__ ": RegisterWaitForSingleObject() failed", GetLastError());
+			m_wait = registeredWait;
+		}
+		catch (...)
+		{
+			m_limiter.InternalRelease(m_tokens);
+			throw;
+		}
+
+		// The callback can run before RegisterWaitForSingleObject() returns;
+		// if it already has, continue without suspending
+		return m_arrivals.fetch_add(1, std::memory_order_acq_rel) == 0;
+	}
+
+	void RateLimiter::Awaitable::await_resume() const noexcept { }
+
+	void RateLimiter::Awaitable::OnTimer(void* param, BOOLEAN timedOut)
+	{
+		// Resuming the coroutine may destroy the awaitable, so it is not
+		// touched after this
+		Awaitable* awaitable = static_cast<Awaitable*>(param);
+		if (awaitable->m_arrivals.fetch_add(1, std::memory_order_acq_rel) == 1)
+			awaitable->m_handle.resume();
+	}
+}
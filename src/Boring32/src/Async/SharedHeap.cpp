@@ -0,0 +1,327 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <atomic>
+#include <bit>
+#include <new>
+#include "include/Async/SharedHeap.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		constexpr UINT32 Magic = 0x48534232; // "2BSH"
+		// Held in the magic field while a creator sets the header up
+		constexpr UINT32 Initialising = 1;
+		constexpr UINT32 Version = 1;
+
+		// Requests up to LinearLimit use classes 16 bytes apart, requests
+		// up to SmallLimit use four classes per doubling, which bounds
+		// internal fragmentation at 25%, and larger requests use powers
+		// of two.
+		constexpr size_t MinBlockSize = 16;
+		constexpr size_t LinearLimit = 128;
+		constexpr size_t SmallLimit = 256 * 1024;
+		constexpr UINT32 LinearClasses = LinearLimit / MinBlockSize;
+		constexpr UINT32 SmallClasses = LinearClasses
+			+ 4 * (std::bit_width(SmallLimit) - std::bit_width(LinearLimit));
+		constexpr UINT32 FirstLargeShift = std::bit_width(SmallLimit);
+		constexpr UINT32 ClassCount = SmallClasses + (32 - FirstLargeShift);
+
+		// Blocks are carved from the unused part of the heap a chunk at a
+		// time, starting on a MaxAlignment boundary
+		constexpr size_t ChunkSize = 64 * 1024;
+		constexpr UINT64 DataStart = SharedHeap::MaxAlignment;
+
+		UINT32 GetSizeClass(size_t size, const size_t alignment)
+		{
+			if (alignment == 0 || !std::has_single_bit(alignment) || alignment > SharedHeap::MaxAlignment)
+				throw std::invalid_argument(__FUNCSIG__ ": alignment must be a power of two no greater than MaxAlignment");
+			size = (std::max)(size, size_t(1));
+			// Power of two blocks are aligned to their size, or to
+			// MaxAlignment if larger, within their chunk
+			if (alignment > MinBlockSize)
+				size = std::bit_ceil((std::max)(size, alignment));
+
+			if (size <= LinearLimit)
+				return static_cast<UINT32>((size + MinBlockSize - 1) / MinBlockSize - 1);
+			if (size <= SmallLimit)
+			{
+				const UINT32 shift = std::bit_width(size - 1) - 1;
+				return LinearClasses
+					+ (shift - (std::bit_width(LinearLimit) - 1)) * 4
+					+ static_cast<UINT32>((size - 1) >> (shift - 2)) - 4;
+			}
+			const UINT32 sizeClass = SmallClasses + std::bit_width(size - 1) - FirstLargeShift;
+			if (sizeClass >= ClassCount)
+				throw std::bad_alloc();
+			return sizeClass;
+		}
+
+		size_t GetClassSize(const UINT32 sizeClass) noexcept
+		{
+			if (sizeClass < LinearClasses)
+				return (sizeClass + 1) * MinBlockSize;
+			if (sizeClass < SmallClasses)
+			{
+				const UINT32 shift = std::bit_width(LinearLimit) - 1 + (sizeClass - LinearClasses) / 4;
+				const size_t step = (sizeClass - LinearClasses) % 4 + 1;
+				return (size_t(1) << shift) + step * (size_t(1) << (shift - 2));
+			}
+			return size_t(1) << (FirstLargeShift + sizeClass - SmallClasses);
+		}
+
+		UINT32 GetHeadOffset(const UINT64 head) noexcept
+		{
+			return static_cast<UINT32>(head);
+		}
+
+		UINT64 MakeHead(const UINT64 previous, const UINT32 offset) noexcept
+		{
+			return (((previous >> 32) + 1) << 32) | offset;
+		}
+	}
+
+	struct SharedHeapHeader
+	{
+		UINT32 Magic;
+		UINT32 Version;
+		UINT64 Size;
+		// The start of the part of the heap not yet carved into blocks
+		UINT64 Bump;
+		UINT64 Roots[SharedHeap::RootCount];
+		// Each head holds the offset of the first free block in its low
+		// 32 bits, and a counter incremented on every change in its high
+		// 32 bits, so that a pop fails if the list changed and changed
+		// back while it was in progress. The first 4 bytes of each free
+		// block hold the offset of the next.
+		UINT64 FreeLists[ClassCount];
+	};
+	static_assert(sizeof(SharedHeapHeader) <= DataStart);
+
+	SharedHeap::~SharedHeap() { }
+
+	SharedHeap::SharedHeap(std::wstring name, const UINT size, const bool create)
+	:	SharedHeap(std::move(name), size, create, SharedHeapSettings{})
+	{ }
+
+	SharedHeap::SharedHeap(
+		std::wstring name,
+		const UINT size,
+		const bool create,
+		const SharedHeapSettings& settings
+	)
+	:	m_name(std::move(name)),
+		m_base(nullptr)
+	{
+		if (m_name.empty())
+			throw std::invalid_argument(__FUNCSIG__ ": name cannot be empty");
+		if (size <= DataStart)
+			throw std::invalid_argument(__FUNCSIG__ ": size is too small");
+
+		m_memory = create
+			? MemoryMappedFile(m_name, size, false, settings.Mapping)
+			: MemoryMappedFile(m_name, size, false, FILE_MAP_ALL_ACCESS, settings.Mapping);
+		m_base = static_cast<std::byte*>(m_memory.GetViewPointer());
+
+		// A new section is zero-filled. Only the creator that moves the
+		// magic field from 0 to Initialising sets the header up; every
+		// other creator attaches, so one can't reset the heap after
+		// another has started allocating from it.
+		SharedHeapHeader* header = GetHeader();
+		std::atomic_ref magic(header->Magic);
+		UINT32 expected = 0;
+		if (create && magic.compare_exchange_strong(expected, Initialising, std::memory_order_acquire))
+		{
+			header->Version = Version;
+			header->Size = m_memory.GetSize();
+			header->Bump = DataStart;
+			magic.store(Magic, std::memory_order_release);
+		}
+		else
+		{
+			const UINT64 deadline = GetTickCount64() + settings.InitialiseTimeout;
+			while (magic.load(std::memory_order_acquire) == Initialising)
+			{
+				if (GetTickCount64() >= deadline)
+					throw std::runtime_error(__FUNCSIG__ ": timed out waiting for the heap to be initialised");
+				Sleep(1);
+			}
+		}
+		if (magic.load(std::memory_order_acquire) != Magic)
+			throw std::runtime_error(__FUNCSIG__ ": the heap has not been initialised");
+		if (header->Version != Version)
+			throw std::runtime_error(__FUNCSIG__ ": the heap has an unsupported version");
+		// Offsets are handed out up to the creator's size, so a smaller
+		// view would let this process access memory it has not mapped
+		if (header->Size > m_memory.GetSize())
+			throw std::runtime_error(__FUNCSIG__ ": the heap is larger than the size passed to attach to it");
+	}
+
+	SharedHeap::SharedHeap(SharedHeap&& other) noexcept
+	:	m_name(std::move(other.m_name)),
+		m_memory(std::move(other.m_memory)),
+		m_base(other.m_base)
+	{
+		other.m_base = nullptr;
+	}
+
+	SharedHeap& SharedHeap::operator=(SharedHeap&& other) noexcept
+	{
+		m_name = std::move(other.m_name);
+		m_memory = std::move(other.m_memory);
+		m_base = other.m_base;
+		other.m_base = nullptr;
+		return *this;
+	}
+
+	SharedHeap::Offset SharedHeap::Allocate(const size_t size)
+	{
+		return Allocate(size, alignof(std::max_align_t));
+	}
+
+	SharedHeap::Offset SharedHeap::Allocate(const size_t size, const size_t alignment)
+	{
+		const UINT32 sizeClass = GetSizeClass(size, alignment);
+		Offset offset = Pop(sizeClass);
+		if (offset == 0)
+			offset = Refill(sizeClass);
+		if (offset == 0)
+			throw std::bad_alloc();
+		return offset;
+	}
+
+	void SharedHeap::Deallocate(const Offset offset, const size_t size)
+	{
+		Deallocate(offset, size, alignof(std::max_align_t));
+	}
+
+	void SharedHeap::Deallocate(const Offset offset, const size_t size, const size_t alignment)
+	{
+		if (offset == 0)
+			return;
+		if (offset < DataStart || offset >= GetHeader()->Size)
+			throw std::invalid_argument(__FUNCSIG__ ": offset is not in the heap");
+		const UINT32 sizeClass = GetSizeClass(size, alignment);
+		Push(sizeClass, offset, offset);
+	}
+
+	void* SharedHeap::GetPointer(const Offset offset) const noexcept
+	{
+		return offset ? m_base + offset : nullptr;
+	}
+
+	SharedHeap::Offset SharedHeap::GetOffset(const void* pointer) const noexcept
+	{
+		return pointer
+			? static_cast<Offset>(static_cast<const std::byte*>(pointer) - m_base)
+			: 0;
+	}
+
+	void SharedHeap::SetRoot(const UINT32 index, const Offset offset)
+	{
+		if (index >= RootCount)
+			throw std::out_of_range(__FUNCSIG__ ": index is out of range");
+		std::atomic_ref(GetHeader()->Roots[index]).store(offset, std::memory_order_release);
+	}
+
+	SharedHeap::Offset SharedHeap::GetRoot(const UINT32 index) const
+	{
+		if (index >= RootCount)
+			throw std::out_of_range(__FUNCSIG__ ": index is out of range");
+		return static_cast<Offset>(
+			std::atomic_ref(GetHeader()->Roots[index]).load(std::memory_order_acquire)
+		);
+	}
+
+	size_t SharedHeap::GetReservedBytes() const noexcept
+	{
+		return static_cast<size_t>(
+			std::atomic_ref(GetHeader()->Bump).load(std::memory_order_relaxed) - DataStart
+		);
+	}
+
+	size_t SharedHeap::GetSize() const noexcept
+	{
+		return static_cast<size_t>(GetHeader()->Size);
+	}
+
+	const std::wstring& SharedHeap::GetName() const noexcept
+	{
+		return m_name;
+	}
+
+	size_t SharedHeap::GetBlockSize(const size_t size, const size_t alignment)
+	{
+		return GetClassSize(GetSizeClass(size, alignment));
+	}
+
+	SharedHeap::Offset SharedHeap::Pop(const UINT32 sizeClass) noexcept
+	{
+		std::atomic_ref head(GetHeader()->FreeLists[sizeClass]);
+		UINT64 current = head.load(std::memory_order_acquire);
+		while (GetHeadOffset(current) != 0)
+		{
+			// The block may be popped and overwritten by another thread
+			// before the exchange, in which case next is garbage, but the
+			// head's counter will have changed and the exchange fails
+			const Offset offset = GetHeadOffset(current);
+			const Offset next = std::atomic_ref(*reinterpret_cast<Offset*>(m_base + offset))
+				.load(std::memory_order_relaxed);
+			if (head.compare_exchange_weak(current, MakeHead(current, next), std::memory_order_acquire))
+				return offset;
+		}
+		return 0;
+	}
+
+	void SharedHeap::Push(const UINT32 sizeClass, const Offset first, const Offset last) noexcept
+	{
+		std::atomic_ref head(GetHeader()->FreeLists[sizeClass]);
+		std::atomic_ref lastNext(*reinterpret_cast<Offset*>(m_base + last));
+		UINT64 current = head.load(std::memory_order_relaxed);
+		do
+		{
+			lastNext.store(GetHeadOffset(current), std::memory_order_relaxed);
+		} while (!head.compare_exchange_weak(current, MakeHead(current, first), std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	SharedHeap::Offset SharedHeap::Refill(const UINT32 sizeClass)
+	{
+		const UINT64 blockSize = GetClassSize(sizeClass);
+		const UINT64 heapSize = GetHeader()->Size;
+		std::atomic_ref bump(GetHeader()->Bump);
+
+		UINT64 start = 0;
+		UINT64 chunkSize = 0;
+		UINT64 current = bump.load(std::memory_order_relaxed);
+		do
+		{
+			start = (current + MaxAlignment - 1) / MaxAlignment * MaxAlignment;
+			chunkSize = blockSize >= ChunkSize ? blockSize : ChunkSize / blockSize * blockSize;
+			// Near the end of the heap, take as many blocks as still fit
+			if (start + chunkSize > heapSize)
+				chunkSize = start < heapSize ? (heapSize - start) / blockSize * blockSize : 0;
+			if (chunkSize == 0)
+				return 0;
+		} while (!bump.compare_exchange_weak(current, start + chunkSize, std::memory_order_relaxed));
+
+		// Keep the first block and free the rest as a single chain
+		const UINT64 blockCount = chunkSize / blockSize;
+		if (blockCount > 1)
+		{
+			for (UINT64 i = 1; i < blockCount - 1; i++)
+				*reinterpret_cast<Offset*>(m_base + start + i * blockSize) =
+					static_cast<Offset>(start + (i + 1) * blockSize);
+			Push(
+				sizeClass,
+				static_cast<Offset>(start + blockSize),
+				static_cast<Offset>(start + (blockCount - 1) * blockSize)
+			);
+		}
+		return static_cast<Offset>(start);
+	}
+
+	SharedHeapHeader* SharedHeap::GetHeader() const noexcept
+	{
+		return reinterpret_cast<SharedHeapHeader*>(m_base);
+	}
+}
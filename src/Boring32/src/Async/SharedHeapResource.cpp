@@ -0,0 +1,32 @@
+#include "pch.hpp"
+#include "include/Async/SharedHeapResource.hpp"
+
+namespace Boring32::Async
+{
+	SharedHeapResource::~SharedHeapResource() { }
+
+	SharedHeapResource::SharedHeapResource(SharedHeap& heap)
+	:	m_heap(&heap)
+	{ }
+
+	SharedHeap& SharedHeapResource::GetHeap() const noexcept
+	{
+		return *m_heap;
+	}
+
+	void* SharedHeapResource::do_allocate(const size_t bytes, const size_t alignment)
+	{
+		return m_heap->GetPointer(m_heap->Allocate(bytes, alignment));
+	}
+
+	void SharedHeapResource::do_deallocate(void* pointer, const size_t bytes, const size_t alignment)
+	{
+		m_heap->Deallocate(m_heap->GetOffset(pointer), bytes, alignment);
+	}
+
+	bool SharedHeapResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+	{
+		const SharedHeapResource* resource = dynamic_cast<const SharedHeapResource*>(&other);
+		return resource && resource->m_heap == m_heap;
+	}
+}
@@ -0,0 +1,184 @@
+// Shared by the Windows and Linux builds, so this does not use the
+// precompiled header
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include "include/Async/SlidingFileView.hpp"
+
+namespace Boring32::Async
+{
+	SlidingFileView::~SlidingFileView()
+	{
+		Release();
+	}
+
+	SlidingFileView::SlidingFileView(const FileMapping& mapping)
+	:	SlidingFileView(mapping, SlidingFileViewSettings{})
+	{ }
+
+	SlidingFileView::SlidingFileView(const FileMapping& mapping, const SlidingFileViewSettings& settings)
+	:	m_mapping(&mapping),
+		m_settings(settings),
+		m_residentBytes(0),
+		m_useCounter(0)
+	{
+		if (m_settings.WindowSize == 0)
+			throw std::invalid_argument("SlidingFileView::SlidingFileView(): WindowSize must be greater than 0");
+		if (m_settings.MaxResidentBytes < m_settings.WindowSize)
+			throw std::invalid_argument("SlidingFileView::SlidingFileView(): MaxResidentBytes must be at least WindowSize");
+	}
+
+	SlidingFileView::SlidingFileView(SlidingFileView&& other) noexcept
+	:	m_mapping(other.m_mapping),
+		m_settings(other.m_settings),
+		m_windows(std::move(other.m_windows)),
+		m_residentBytes(other.m_residentBytes),
+		m_useCounter(other.m_useCounter)
+	{
+		other.m_windows.clear();
+		other.m_residentBytes = 0;
+	}
+
+	SlidingFileView& SlidingFileView::operator=(SlidingFileView&& other) noexcept
+	{
+		Release();
+		m_mapping = other.m_mapping;
+		m_settings = other.m_settings;
+		m_windows = std::move(other.m_windows);
+		m_residentBytes = other.m_residentBytes;
+		m_useCounter = other.m_useCounter;
+		other.m_windows.clear();
+		other.m_residentBytes = 0;
+		return *this;
+	}
+
+	std::span<std::byte> SlidingFileView::At(const std::uint64_t offset, const size_t length)
+	{
+		if (offset > m_mapping->GetSize() || length > m_mapping->GetSize() - offset)
+			throw std::out_of_range("SlidingFileView::At(): range is beyond the end of the mapping");
+		if (length == 0)
+			return {};
+
+		size_t index = FindWindow(offset, length);
+		if (index == m_windows.size())
+			index = MapWindow(offset, length, nullptr);
+		Window& window = m_windows[index];
+		window.LastUse = ++m_useCounter;
+		const std::span<std::byte> data = window.View.GetData().subspan(
+			static_cast<size_t>(offset - window.View.GetOffset()),
+			length
+		);
+
+		// Read ahead once the scan is past the middle of the window
+		if (m_settings.PrefetchNext
+			&& !window.NextPrefetched
+			&& offset - window.View.GetOffset() >= window.View.GetSize() / 2)
+		{
+			window.NextPrefetched = true;
+			PrefetchAfter(index);
+		}
+		return data;
+	}
+
+	void SlidingFileView::Prefetch(const std::uint64_t offset)
+	{
+		if (offset >= m_mapping->GetSize())
+			throw std::out_of_range("SlidingFileView::Prefetch(): offset is beyond the end of the mapping");
+		size_t index = FindWindow(offset, 1);
+		if (index == m_windows.size())
+			index = MapWindow(offset, 1, nullptr);
+		m_windows[index].LastUse = ++m_useCounter;
+		m_windows[index].View.Prefetch(std::nothrow);
+	}
+
+	void SlidingFileView::Flush()
+	{
+		for (Window& window : m_windows)
+			window.View.Flush();
+	}
+
+	void SlidingFileView::Release() noexcept
+	{
+		m_windows.clear();
+		m_residentBytes = 0;
+	}
+
+	size_t SlidingFileView::GetMappedWindowCount() const noexcept
+	{
+		return m_windows.size();
+	}
+
+	size_t SlidingFileView::GetResidentBytes() const noexcept
+	{
+		return m_residentBytes;
+	}
+
+	const SlidingFileViewSettings& SlidingFileView::GetSettings() const noexcept
+	{
+		return m_settings;
+	}
+
+	size_t SlidingFileView::FindWindow(const std::uint64_t offset, const size_t length) const noexcept
+	{
+		for (size_t i = 0; i < m_windows.size(); i++)
+			if (m_windows[i].View.Contains(offset, length))
+				return i;
+		return m_windows.size();
+	}
+
+	size_t SlidingFileView::MapWindow(const std::uint64_t offset, const size_t length, const std::byte* pinned)
+	{
+		// Start windows on an allocation granularity boundary so that no
+		// address space is spent on slack before the window.
+		const std::uint64_t start = offset - (offset % FileMapping::GetAllocationGranularity());
+		const std::uint64_t needed = offset - start + length;
+		const std::uint64_t windowSize = (std::min)(
+			(std::max)(static_cast<std::uint64_t>(m_settings.WindowSize), needed),
+			m_mapping->GetSize() - start
+		);
+
+		EvictFor(static_cast<size_t>(windowSize), pinned);
+		m_windows.push_back(Window{
+			.View = m_mapping->MapView(start, static_cast<size_t>(windowSize))
+		});
+		m_residentBytes += m_windows.back().View.GetMappedSize();
+		return m_windows.size() - 1;
+	}
+
+	void SlidingFileView::EvictFor(const size_t bytes, const std::byte* pinned) noexcept
+	{
+		while (!m_windows.empty() && m_residentBytes + bytes > m_settings.MaxResidentBytes)
+		{
+			auto oldest = m_windows.end();
+			for (auto it = m_windows.begin(); it != m_windows.end(); it++)
+			{
+				if (it->View.GetData().data() == pinned)
+					continue;
+				if (oldest == m_windows.end() || it->LastUse < oldest->LastUse)
+					oldest = it;
+			}
+			if (oldest == m_windows.end())
+				return;
+			m_residentBytes -= oldest->View.GetMappedSize();
+			m_windows.erase(oldest);
+		}
+	}
+
+	void SlidingFileView::PrefetchAfter(const size_t index)
+	{
+		const FileMappingView& current = m_windows[index].View;
+		const std::uint64_t next = current.GetOffset() + current.GetSize();
+		if (next >= m_mapping->GetSize())
+			return;
+		// The current window cannot be evicted to make room
+		if (current.GetMappedSize() + m_settings.WindowSize > m_settings.MaxResidentBytes)
+			return;
+
+		size_t nextIndex = FindWindow(next, 1);
+		if (nextIndex == m_windows.size())
+			nextIndex = MapWindow(next, 1, current.GetData().data());
+		// Keep the prefetched window from being the next one evicted
+		m_windows[nextIndex].LastUse = ++m_useCounter;
+		m_windows[nextIndex].View.Prefetch(std::nothrow);
+	}
+}
@@ -0,0 +1,287 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/CriticalSectionLock.hpp"
+#include "include/Async/ThreadCache.hpp"
+
+namespace Boring32::Async
+{
+	PooledThreadJob::~PooledThreadJob()
+	{
+		DeleteCriticalSection(&Lock);
+	}
+
+	PooledThreadJob::PooledThreadJob(std::function<int(void*)> func, void* param)
+	:	Func(std::move(func)),
+		Param(param),
+		Status(ThreadStatus::Ready),
+		ExitCode(STILL_ACTIVE),
+		Started(false, true, false),
+		Finished(false, true, false)
+	{
+		InitializeCriticalSection(&Lock);
+	}
+
+	ThreadCache::Worker::Worker(ThreadCache& cache)
+	:	Cache(cache),
+		Wake(false, false, false),
+		Exit(false)
+	{ }
+
+	ThreadCache::~ThreadCache()
+	{
+		std::vector<std::shared_ptr<Worker>> workers;
+		{
+			CriticalSectionLock cs(m_cs);
+			m_shuttingDown = true;
+			workers = m_all;
+			for (std::shared_ptr<Worker>& worker : m_idle)
+			{
+				worker->Exit = true;
+				worker->Wake.Signal(std::nothrow);
+			}
+			m_idle.clear();
+		}
+
+		// Busy workers see m_shuttingDown when they finish their job and exit
+		for (std::shared_ptr<Worker>& worker : workers)
+			WaitForSingleObject(worker->Handle.GetHandle(), INFINITE);
+
+		m_all.clear();
+		DeleteCriticalSection(&m_cs);
+	}
+
+	ThreadCache::ThreadCache(const DWORD maxIdleThreads, const DWORD idleTimeoutMillis)
+	:	m_maxIdleThreads(maxIdleThreads),
+		m_idleTimeout(idleTimeoutMillis),
+		m_shuttingDown(false)
+	{
+		InitializeCriticalSection(&m_cs);
+	}
+
+	void ThreadCache::Prespawn(const DWORD count)
+	{
+		const DWORD target = (std::min)(count, m_maxIdleThreads);
+		while (GetIdleCount() < target)
+		{
+			std::shared_ptr<Worker> worker = CreateWorker();
+			if (ReturnWorker(worker) == false)
+			{
+				worker->Exit = true;
+				worker->Wake.Signal();
+				break;
+			}
+		}
+	}
+
+	void ThreadCache::Submit(const std::shared_ptr<PooledThreadJob>& job)
+	{
+		if (job == nullptr)
+			throw std::invalid_argument(__FUNCSIG__ ": job is nullptr");
+
+		std::shared_ptr<Worker> worker;
+		{
+			CriticalSectionLock cs(m_cs);
+			if (m_shuttingDown)
+				throw std::runtime_error(__FUNCSIG__ ": the cache is shutting down");
+			if (m_idle.empty() == false)
+			{
+				// Most recently used first, as its stack is most likely to be warm
+				worker = std::move(m_idle.back());
+				m_idle.pop_back();
+			}
+		}
+		if (worker == nullptr)
+			worker = CreateWorker();
+
+		job->Thread = std::shared_ptr<const Raii::Win32Handle>(worker, &worker->Handle);
+		worker->Job = job;
+		worker->Wake.Signal();
+	}
+
+	void ThreadCache::Terminate(const std::shared_ptr<PooledThreadJob>& job, const DWORD exitCode)
+	{
+		if (job == nullptr)
+			throw std::invalid_argument(__FUNCSIG__ ": job is nullptr");
+
+		// Holding the job's lock keeps its worker from finishing the job
+		// and moving on, so the thread terminated is the one running it
+		CriticalSectionLock jobLock(job->Lock);
+		const ThreadStatus status = job->Status;
+		if (status != ThreadStatus::Running && status != ThreadStatus::Suspended)
+			throw std::runtime_error(__FUNCSIG__ ": thread is not running");
+		const std::shared_ptr<const Raii::Win32Handle> thread = job->Thread.load();
+		if (thread == nullptr)
+			throw std::runtime_error(__FUNCSIG__ ": thread is not running");
+
+		// A running worker is never idle, so it only needs removing from
+		// m_all, which the destructor waits on
+		std::shared_ptr<Worker> worker;
+		{
+			CriticalSectionLock cs(m_cs);
+			auto iter = std::find_if(
+				m_all.begin(),
+				m_all.end(),
+				[&thread](const std::shared_ptr<Worker>& candidate) { return &candidate->Handle == thread.get(); }
+			);
+			if (iter != m_all.end())
+			{
+				worker = std::move(*iter);
+				m_all.erase(iter);
+			}
+		}
+
+		if (TerminateThread(thread->GetHandle(), exitCode) == false)
+		{
+			const DWORD lastError = GetLastError();
+			if (worker != nullptr)
+			{
+				CriticalSectionLock cs(m_cs);
+				m_all.push_back(std::move(worker));
+			}
+			throw Error::Win32Error(__FUNCSIG__ ": TerminateThread() failed", lastError);
+		}
+		job->ExitCode = exitCode;
+		job->Status = ThreadStatus::Terminated;
+		job->Thread = nullptr;
+		job->Finished.Signal();
+	}
+
+	size_t ThreadCache::GetIdleCount()
+	{
+		CriticalSectionLock cs(m_cs);
+		return m_idle.size();
+	}
+
+	size_t ThreadCache::GetThreadCount()
+	{
+		CriticalSectionLock cs(m_cs);
+		return m_all.size();
+	}
+
+	DWORD ThreadCache::GetMaxIdleThreads() const noexcept
+	{
+		return m_maxIdleThreads;
+	}
+
+	DWORD ThreadCache::GetIdleTimeout() const noexcept
+	{
+		return m_idleTimeout;
+	}
+
+	std::shared_ptr<ThreadCache::Worker> ThreadCache::CreateWorker()
+	{
+		std::shared_ptr<Worker> worker = std::make_shared<Worker>(*this);
+		// The new thread owns a reference to its worker for its lifetime
+		auto threadRef = new std::shared_ptr<Worker>(worker);
+		// Start suspended so the handle is assigned before the thread can use it
+		// https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/beginthread-beginthreadex?view=vs-2019
+		worker->Handle = (HANDLE)_beginthreadex(
+			0,
+			0,
+			ThreadCache::WorkerProc,
+			threadRef,
+			CREATE_SUSPENDED,
+			nullptr
+		);
+		if (worker->Handle == nullptr)
+		{
+			delete threadRef;
+			int errorCode = 0;
+			std::string errorMessage = __FUNCSIG__ ": _beginthreadex() failed";
+			// https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/get-errno?view=msvc-160
+			errorMessage += _get_errno(&errorCode) == 0
+				? "; error code: " + std::to_string(errorCode)
+				: ", but could not determine the error code";
+			throw std::runtime_error(errorMessage);
+		}
+
+		{
+			CriticalSectionLock cs(m_cs);
+			m_all.push_back(worker);
+		}
+		ResumeThread(worker->Handle.GetHandle());
+		return worker;
+	}
+
+	void ThreadCache::RunJob(Worker& worker)
+	{
+		PooledThreadJob& job = *worker.Job;
+		job.Status = ThreadStatus::Running;
+		job.Started.Signal();
+		try
+		{
+			job.ExitCode = job.Func(job.Param);
+		}
+		catch (const std::exception& ex)
+		{
+			// An exception escaping a plain Thread would terminate the process;
+			// here it would also strand the cached thread, so log and fail the job
+			std::wcerr << __FUNCSIG__ << L": unhandled exception: " << ex.what() << std::endl;
+			job.ExitCode = 1;
+		}
+		{
+			// Waits out a Terminate() or Suspend() acting on this thread
+			CriticalSectionLock jobLock(job.Lock);
+			job.Status = ThreadStatus::Finished;
+			job.Thread = nullptr;
+		}
+		// Drop our reference before signalling so the job's owner sees the
+		// final state and can immediately reuse or free it
+		std::shared_ptr<PooledThreadJob> finished = std::move(worker.Job);
+		finished->Finished.Signal();
+	}
+
+	bool ThreadCache::ReturnWorker(const std::shared_ptr<Worker>& worker)
+	{
+		CriticalSectionLock cs(m_cs);
+		if (m_shuttingDown || m_idle.size() >= m_maxIdleThreads)
+		{
+			m_all.erase(std::find(m_all.begin(), m_all.end(), worker));
+			return false;
+		}
+		m_idle.push_back(worker);
+		return true;
+	}
+
+	bool ThreadCache::RetireWorker(const std::shared_ptr<Worker>& worker)
+	{
+		CriticalSectionLock cs(m_cs);
+		auto iter = std::find(m_idle.begin(), m_idle.end(), worker);
+		// Not idle means the worker was handed a job just as it timed out
+		if (iter == m_idle.end())
+			return false;
+		m_idle.erase(iter);
+		m_all.erase(std::find(m_all.begin(), m_all.end(), worker));
+		return true;
+	}
+
+	UINT ThreadCache::WorkerProc(void* param)
+	{
+		std::unique_ptr<std::shared_ptr<Worker>> threadRef(
+			static_cast<std::shared_ptr<Worker>*>(param)
+		);
+		std::shared_ptr<Worker> worker = *threadRef;
+		ThreadCache& cache = worker->Cache;
+
+		while (true)
+		{
+			if (worker->Wake.WaitOnEvent(cache.m_idleTimeout, false) == false)
+			{
+				if (cache.RetireWorker(worker))
+					return 0;
+				continue;
+			}
+			if (worker->Exit)
+				return 0;
+			if (worker->Job == nullptr)
+				continue;
+
+			cache.RunJob(*worker);
+			// After this returns false, the cache may be destroyed at any time
+			if (cache.ReturnWorker(worker) == false)
+				return 0;
+		}
+	}
+}
@@ -0,0 +1,248 @@
+#include "pch.hpp"
+#include <stdexcept>
+#include <vector>
+#include <winternl.h>
+#include "include/Error/Win32Error.hpp"
+#include "include/Async/OverlappedPool.hpp"
+#include "include/Async/VectoredIo.hpp"
+
+namespace Boring32::Async
+{
+	namespace
+	{
+		// Pieces smaller than this are copied together rather than each
+		// costing a system call
+		constexpr size_t CoalesceLimit = 4096;
+		// FileModeInformation, which winternl.h doesn't declare
+		constexpr FILE_INFORMATION_CLASS FileModeInformationClass = (FILE_INFORMATION_CLASS)16;
+
+		OverlappedPool& GetOverlappedPool()
+		{
+			static OverlappedPool pool;
+			return pool;
+		}
+
+		std::vector<std::byte>& GetStagingBuffer()
+		{
+			thread_local std::vector<std::byte> staging;
+			return staging;
+		}
+
+		// Returns the result of the transfer as a Win32 error code
+		DWORD Transfer(
+			const HANDLE handle,
+			const VectoredIoTraits& traits,
+			const bool isWrite,
+			std::byte* buffer,
+			const DWORD size,
+			DWORD& bytesTransferred
+		)
+		{
+			bytesTransferred = 0;
+			if (traits.IsOverlapped == false)
+			{
+				const bool succeeded = isWrite
+					? WriteFile(handle, buffer, size, &bytesTransferred, nullptr)
+					: ReadFile(handle, buffer, size, &bytesTransferred, nullptr);
+				return succeeded ? ERROR_SUCCESS : GetLastError();
+			}
+
+			OverlappedLease lease = GetOverlappedPool().Acquire();
+			const bool succeeded = isWrite
+				? WriteFile(handle, buffer, size, nullptr, lease.GetOverlapped())
+				: ReadFile(handle, buffer, size, nullptr, lease.GetOverlapped());
+			const DWORD lastError = succeeded ? ERROR_SUCCESS : GetLastError();
+			if (lastError != ERROR_SUCCESS && lastError != ERROR_IO_PENDING && lastError != ERROR_MORE_DATA)
+				return lastError;
+			// https://docs.microsoft.com/en-us/windows/win32/api/ioapiset/nf-ioapiset-getoverlappedresult
+			return GetOverlappedResult(handle, lease.GetOverlapped(), &bytesTransferred, true)
+				? ERROR_SUCCESS
+				: GetLastError();
+		}
+
+		void WriteAll(const HANDLE handle, const VectoredIoTraits& traits, const std::byte* data, const size_t size)
+		{
+			size_t written = 0;
+			while (written < size)
+			{
+				const DWORD chunk = (DWORD)(std::min)(size - written, (size_t)MAXDWORD);
+				DWORD bytesWritten = 0;
+				const DWORD result = Transfer(
+					handle,
+					traits,
+					true,
+					const_cast<std::byte*>(data + written),
+					chunk,
+					bytesWritten
+				);
+				if (result != ERROR_SUCCESS)
+					throw Error::Win32Error(__FUNCSIG__ ": WriteFile() failed", result);
+				if (bytesWritten == 0)
+					throw std::runtime_error(__FUNCSIG__ ": WriteFile() made no progress");
+				written += bytesWritten;
+			}
+		}
+	}
+
+	VectoredIoTraits GetVectoredIoTraits(const HANDLE handle)
+	{
+		if (handle == nullptr || handle == INVALID_HANDLE_VALUE)
+			throw std::invalid_argument(__FUNCSIG__ ": handle is not valid");
+
+		VectoredIoTraits traits;
+		// https://docs.microsoft.com/en-us/windows/win32/api/fileapi/nf-fileapi-getfiletype
+		traits.IsPipe = GetFileType(handle) == FILE_TYPE_PIPE;
+		if (traits.IsPipe)
+		{
+			// https://docs.microsoft.com/en-us/windows/win32/api/namedpipeapi/nf-namedpipeapi-getnamedpipeinfo
+			// A write-only handle needs FILE_READ_ATTRIBUTES for this to
+			// succeed. If it fails, writes are made as one WriteFile(),
+			// which is correct for either type of pipe.
+			DWORD flags = 0;
+			traits.IsMessagePipe = GetNamedPipeInfo(handle, &flags, nullptr, nullptr, nullptr)
+				? (flags & PIPE_TYPE_MESSAGE) != 0
+				: true;
+			DWORD state = 0;
+			if (GetNamedPipeHandleStateW(handle, &state, nullptr, nullptr, nullptr, nullptr, 0))
+				traits.IsMessageReadMode = state & PIPE_READMODE_MESSAGE;
+		}
+
+		// A handle is overlapped if it was opened without either of the
+		// synchronous I/O modes
+		IO_STATUS_BLOCK status{ 0 };
+		ULONG mode = 0;
+		const NTSTATUS result = NtQueryInformationFile(
+			handle,
+			&status,
+			&mode,
+			sizeof(mode),
+			FileModeInformationClass
+		);
+		if (result < 0)
+			throw Error::Win32Error(__FUNCSIG__ ": NtQueryInformationFile() failed", RtlNtStatusToDosError(result));
+		traits.IsOverlapped = (mode & (FILE_SYNCHRONOUS_IO_ALERT | FILE_SYNCHRONOUS_IO_NONALERT)) == 0;
+		if (traits.IsOverlapped && traits.IsPipe == false)
+			throw std::invalid_argument(__FUNCSIG__ ": overlapped file handles are not supported");
+		return traits;
+	}
+
+	UINT64 WriteGather(const HANDLE handle, const std::span<const std::span<const std::byte>> pieces)
+	{
+		return WriteGather(handle, GetVectoredIoTraits(handle), pieces);
+	}
+
+	UINT64 WriteGather(
+		const HANDLE handle,
+		const VectoredIoTraits& traits,
+		const std::span<const std::span<const std::byte>> pieces
+	)
+	{
+		if (handle == nullptr || handle == INVALID_HANDLE_VALUE)
+			throw std::invalid_argument(__FUNCSIG__ ": handle is not valid");
+		UINT64 total = 0;
+		for (const std::span<const std::byte>& piece : pieces)
+			total += piece.size();
+		if (total == 0)
+			return 0;
+
+		std::vector<std::byte>& staging = GetStagingBuffer();
+		if (traits.IsMessagePipe)
+		{
+			if (total > MAXDWORD)
+				throw std::invalid_argument(__FUNCSIG__ ": the message is too large");
+			// A single piece needs no staging
+			if (pieces.size() == 1)
+			{
+				WriteAll(handle, traits, pieces[0].data(), pieces[0].size());
+				return total;
+			}
+			staging.clear();
+			for (const std::span<const std::byte>& piece : pieces)
+				staging.insert(staging.end(), piece.begin(), piece.end());
+			WriteAll(handle, traits, staging.data(), staging.size());
+			return total;
+		}
+
+		staging.clear();
+		for (const std::span<const std::byte>& piece : pieces)
+		{
+			if (piece.size() < CoalesceLimit)
+			{
+				staging.insert(staging.end(), piece.begin(), piece.end());
+				if (staging.size() >= CoalesceLimit)
+				{
+					WriteAll(handle, traits, staging.data(), staging.size());
+					staging.clear();
+				}
+				continue;
+			}
+			// Large pieces go straight from the caller's memory, after
+			// anything staged ahead of them
+			if (staging.empty() == false)
+			{
+				WriteAll(handle, traits, staging.data(), staging.size());
+				staging.clear();
+			}
+			WriteAll(handle, traits, piece.data(), piece.size());
+		}
+		if (staging.empty() == false)
+			WriteAll(handle, traits, staging.data(), staging.size());
+		return total;
+	}
+
+	ScatterReadResult ReadScatter(const HANDLE handle, const std::span<const std::span<std::byte>> pieces)
+	{
+		return ReadScatter(handle, GetVectoredIoTraits(handle), pieces);
+	}
+
+	ScatterReadResult ReadScatter(
+		const HANDLE handle,
+		const VectoredIoTraits& traits,
+		const std::span<const std::span<std::byte>> pieces
+	)
+	{
+		if (handle == nullptr || handle == INVALID_HANDLE_VALUE)
+			throw std::invalid_argument(__FUNCSIG__ ": handle is not valid");
+		ScatterReadResult result;
+		for (const std::span<std::byte>& piece : pieces)
+		{
+			size_t filled = 0;
+			while (filled < piece.size())
+			{
+				const DWORD chunk = (DWORD)(std::min)(piece.size() - filled, (size_t)MAXDWORD);
+				DWORD bytesRead = 0;
+				const DWORD error = Transfer(handle, traits, false, piece.data() + filled, chunk, bytesRead);
+				filled += bytesRead;
+				result.BytesRead += bytesRead;
+
+				switch (error)
+				{
+					case ERROR_SUCCESS:
+						// The message was read to its end
+						if (traits.IsMessageReadMode)
+						{
+							result.MoreData = false;
+							return result;
+						}
+						// The end of the file
+						if (bytesRead == 0)
+							return result;
+						break;
+
+					// The message continues into the next piece
+					case ERROR_MORE_DATA:
+						result.MoreData = true;
+						break;
+
+					case ERROR_BROKEN_PIPE:
+					case ERROR_HANDLE_EOF:
+						return result;
+
+					default:
+						throw Error::Win32Error(__FUNCSIG__ ": ReadFile() failed", error);
+				}
+			}
+		}
+		return result;
+	}
+}
@@ -1,12 +1,34 @@
 #include "pch.hpp"
 #include <stdexcept>
 #include <chrono>
+#include <array>
 #include "include/Error/Win32Error.hpp"
 #include "include/Error/ComError.hpp"
 #include "include/Util/Util.hpp"
 
 namespace Boring32::Util
 {
+    namespace
+    {
+        // Reflected form of the Castagnoli polynomial 0x1EDC6F41
+        constexpr UINT32 Crc32cPolynomial = 0x82F63B78;
+
+        constexpr std::array<UINT32, 256> MakeCrc32cTable() noexcept
+        {
+            std::array<UINT32, 256> table{};
+            for (UINT32 i = 0; i < 256; i++)
+            {
+                UINT32 crc = i;
+                for (int bit = 0; bit < 8; bit++)
+                    crc = (crc >> 1) ^ ((crc & 1) ? Crc32cPolynomial : 0);
+                table[i] = crc;
+            }
+            return table;
+        }
+
+        constexpr std::array<UINT32, 256> Crc32cTable = MakeCrc32cTable();
+    }
+
     std::wstring GetCurrentExecutableDirectory()
     {
         constexpr size_t blockSize = 2048;
@@ -81,4 +103,17 @@ namespace Boring32::Util
     {
         return { (std::byte*)&str[0], (std::byte*)&str[0] + str.size() * sizeof(char) };
     }
+
+    UINT32 Crc32c(const std::span<const std::byte> data) noexcept
+    {
+        return Crc32c(data, 0);
+    }
+
+    UINT32 Crc32c(const std::span<const std::byte> data, const UINT32 previous) noexcept
+    {
+        UINT32 crc = ~previous;
+        for (const std::byte b : data)
+            crc = Crc32cTable[(crc ^ static_cast<UINT32>(b)) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
 }
@@ -24,3 +24,5 @@
 #pragma comment(lib, "taskschd.lib")
 #pragma comment(lib, "Cryptui.lib")
 #pragma comment(lib, "Shlwapi.lib")
+#pragma comment(lib, "ntdll.lib")
+#pragma comment(lib, "Ws2_32.lib")
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <Windows.h>
 #include <string>
+#include <vector>
 #include "../Boring32/include/Boring32.hpp"
 
 int MainAnon(int argc, char** args)
@@ -57,6 +58,192 @@ int MainOverlapped(int argc, char** args)
     return 0;
 }
 
+int MainPoolWorker(int argc, char** args)
+{
+    if (argc != 3)
+        throw std::runtime_error("MainPoolWorker(): required arguments missing");
+
+    // Echoes each request back to the pool. "crash" exits without
+    // responding and "sleep:N" waits N ms first, to exercise the pool's
+    // failure handling.
+    Boring32::Async::ProcessPoolWorker worker(Boring32::Strings::ToWideString(args[2]));
+    worker.Run(
+        [](const std::wstring& request)
+        {
+            if (request == L"crash")
+                ExitProcess(3);
+            if (request.starts_with(L"sleep:"))
+                Sleep(std::stoul(request.substr(6)));
+            return request;
+        });
+    return 0;
+}
+
+int MainEmitOutput(int argc, char** args)
+{
+    if (argc != 3)
+        throw std::runtime_error("MainEmitOutput(): required arguments missing");
+
+    // Writes the requested number of megabytes of 100 byte lines to stdout
+    const unsigned long long totalBytes = std::stoull(args[2]) * 1024 * 1024;
+    std::string line(99, 'x');
+    line += '\n';
+    std::vector<char> block;
+    while (block.size() + line.size() <= 64 * 1024)
+        block.insert(block.end(), line.begin(), line.end());
+
+    HANDLE stdOut = GetStdHandle(STD_OUTPUT_HANDLE);
+    for (unsigned long long written = 0; written < totalBytes; written += block.size())
+    {
+        DWORD bytesWritten = 0;
+        if (WriteFile(stdOut, block.data(), (DWORD)block.size(), &bytesWritten, nullptr) == false)
+            throw std::runtime_error("MainEmitOutput(): WriteFile() failed");
+    }
+    std::cerr << "Finished emitting output" << std::endl;
+    return 0;
+}
+
+// Echoes every message back to the benchmark that started it, over the
+// transport named by args[2], until the transport fails or it is killed
+int MainIpcPeer(int argc, char** args)
+{
+    if (argc < 4)
+        throw std::runtime_error("MainIpcPeer(): required arguments missing");
+
+    const std::string transport(args[2]);
+    if (transport == "anon")
+    {
+        if (argc != 5)
+            throw std::runtime_error("MainIpcPeer(): required arguments missing");
+        Boring32::Async::AnonymousPipe pipe(
+            1024 * 1024,
+            L"||",
+            (HANDLE)std::stoull(args[3]),
+            (HANDLE)std::stoull(args[4])
+        );
+        Boring32::Async::DelimitedStreamReader reader(pipe);
+        std::wstring_view msg;
+        while (reader.Next(msg))
+            pipe.DelimitedWrite(std::wstring(msg));
+        return 0;
+    }
+
+    if (transport == "blocking")
+    {
+        Boring32::Async::BlockingNamedPipeClient pipe(Boring32::Strings::ToWideString(args[3]));
+        pipe.Connect(0);
+        pipe.SetMode(PIPE_READMODE_MESSAGE);
+        while (true)
+            pipe.Write(pipe.Read());
+    }
+
+    if (transport == "overlapped")
+    {
+        Boring32::Async::OverlappedNamedPipeClient pipe(Boring32::Strings::ToWideString(args[3]));
+        pipe.Connect(0);
+        pipe.SetMode(PIPE_READMODE_MESSAGE);
+        while (true)
+        {
+            Boring32::Async::OverlappedIo readOp;
+            pipe.Read(64 * 1024, readOp);
+            readOp.WaitForCompletion(INFINITE);
+            if (readOp.IsSuccessful() == false)
+                throw std::runtime_error("MainIpcPeer(): read failed");
+            Boring32::Async::OverlappedIo writeOp;
+            pipe.Write(readOp.IoBuffer, writeOp);
+            writeOp.WaitForCompletion(INFINITE);
+        }
+    }
+
+    if (transport == "mmf")
+    {
+        if (argc != 5)
+            throw std::runtime_error("MainIpcPeer(): required arguments missing");
+        // The message length is at the start of the view and the message
+        // follows at offset 8
+        const std::wstring name = Boring32::Strings::ToWideString(args[3]);
+        Boring32::Async::MemoryMappedFile shared(name, (UINT)std::stoul(args[4]), false, FILE_MAP_ALL_ACCESS);
+        Boring32::Async::Event request(false, false, name + L".Request", EVENT_ALL_ACCESS);
+        Boring32::Async::Event response(false, false, name + L".Response", EVENT_ALL_ACCESS);
+        std::byte* view = static_cast<std::byte*>(shared.GetViewPointer());
+        while (true)
+        {
+            request.WaitOnEvent();
+            UINT32 length = 0;
+            memcpy(&length, view, sizeof(length));
+            std::wstring msg(length / sizeof(wchar_t), L'\0');
+            memcpy(msg.data(), view + 8, length);
+            memcpy(view + 8, msg.data(), length);
+            response.Signal();
+        }
+    }
+
+    throw std::runtime_error("MainIpcPeer(): unknown transport");
+}
+
+// Appends args[4] records of 64 bytes to the journal or file at args[3]
+// once the event named args[5] is signalled, for the journal benchmark
+int MainAppender(int argc, char** args)
+{
+    if (argc != 6)
+        throw std::runtime_error("MainAppender(): required arguments missing");
+
+    const std::string target(args[2]);
+    const std::wstring path = Boring32::Strings::ToWideString(args[3]);
+    const int count = std::stoi(args[4]);
+    const std::vector<std::byte> record(64, std::byte{ 0x4A });
+    Boring32::Async::Event start(false, true, Boring32::Strings::ToWideString(args[5]), SYNCHRONIZE);
+
+    if (target == "journal")
+    {
+        Boring32::Async::MappedJournalWriter writer(path);
+        start.WaitOnEvent();
+        for (int i = 0; i < count; i++)
+            writer.Append(record);
+        return 0;
+    }
+
+    if (target == "writefile")
+    {
+        Boring32::Raii::Win32Handle file = CreateFileW(
+            path.c_str(),
+            FILE_APPEND_DATA,
+            FILE_SHARE_READ | FILE_SHARE_WRITE,
+            nullptr,
+            OPEN_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL,
+            nullptr
+        );
+        start.WaitOnEvent();
+        for (int i = 0; i < count; i++)
+        {
+            DWORD bytesWritten = 0;
+            if (!WriteFile(file.GetHandle(), record.data(), (DWORD)record.size(), &bytesWritten, nullptr))
+                throw std::runtime_error("MainAppender(): WriteFile() failed");
+        }
+        return 0;
+    }
+
+    throw std::runtime_error("MainAppender(): unknown target");
+}
+
+// Enqueues records of args[3] bytes to the durable queue in args[2]
+// until the process is terminated, for the crash recovery benchmark
+int MainQueueProducer(int argc, char** args)
+{
+    if (argc != 4)
+        throw std::runtime_error("MainQueueProducer(): required arguments missing");
+
+    const std::wstring directory = Boring32::Strings::ToWideString(args[2]);
+    const std::vector<std::byte> record(std::stoi(args[3]), std::byte{ 0x51 });
+    Boring32::Async::DurableQueueProducer producer(
+        directory,
+        Boring32::Async::DurableQueueSettings{ .Durability = Boring32::Async::DurableQueueDurability::None }
+    );
+    while (true)
+        producer.Enqueue(record);
+}
+
 int ConnectAndWriteToElevatedPipe()
 {
     Boring32::Async::OverlappedNamedPipeClient p(L"\\\\.\\pipe\\mynamedpipe");
@@ -104,6 +291,16 @@ int main(int argc, char** args)
             MainOverlapped(argc, args);
         if (testType == "3")
             MainAnon(argc, args);
+        if (testType == "4")
+            MainPoolWorker(argc, args);
+        if (testType == "5")
+            MainEmitOutput(argc, args);
+        if (testType == "6")
+            MainIpcPeer(argc, args);
+        if (testType == "7")
+            MainAppender(argc, args);
+        if (testType == "8")
+            MainQueueProducer(argc, args);
 
         //return ConnectToPrivateNamespace();
         //return ConnectAndWriteToElevatedPipe();